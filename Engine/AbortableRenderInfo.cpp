@@ -56,6 +56,9 @@ struct AbortableRenderInfoPrivate
     bool canAbort;
     QAtomicInt aborted;
     U64 age;
+    RenderPriorityEnum priority;
+    // Number of renderRoI calls of this render having images marked as being rendered in the trimap
+    QAtomicInt imagesBeingRendered;
     mutable QMutex threadsMutex;
     ThreadSet threadsForThisRender;
     mutable QMutex timerMutex;
@@ -70,6 +73,8 @@ struct AbortableRenderInfoPrivate
         , canAbort(canAbort)
         , aborted()
         , age(age)
+        , priority(eRenderPriorityBackground)
+        , imagesBeingRendered()
         , threadsMutex()
         , threadsForThisRender()
         , timerMutex()
@@ -78,6 +83,7 @@ struct AbortableRenderInfoPrivate
         , ownerThread( QThread::currentThread() )
     {
         aborted.fetchAndStoreAcquire(0);
+        imagesBeingRendered.fetchAndStoreAcquire(0);
 
         abortTimeoutTimer->setSingleShot(true);
         QObject::connect( abortTimeoutTimer, SIGNAL(timeout()), p, SLOT(onAbortTimerTimeout()) );
@@ -110,6 +116,38 @@ AbortableRenderInfo::getRenderAge() const
     return _imp->age;
 }
 
+void
+AbortableRenderInfo::setPriority(RenderPriorityEnum priority)
+{
+    _imp->priority = priority;
+}
+
+RenderPriorityEnum
+AbortableRenderInfo::getPriority() const
+{
+    return _imp->priority;
+}
+
+void
+AbortableRenderInfo::registerImagesBeingRendered()
+{
+    _imp->imagesBeingRendered.fetchAndAddOrdered(1);
+}
+
+void
+AbortableRenderInfo::unregisterImagesBeingRendered()
+{
+    int prev = _imp->imagesBeingRendered.fetchAndAddOrdered(-1);
+    assert(prev > 0);
+    Q_UNUSED(prev);
+}
+
+bool
+AbortableRenderInfo::hasImagesBeingRendered() const
+{
+    return (int)_imp->imagesBeingRendered > 0;
+}
+
 bool
 AbortableRenderInfo::canAbort() const
 {
@@ -120,6 +120,22 @@ public:
      **/
     U64 getRenderAge() const;
 
+    /**
+     * @brief The priority class of this render, used by the RenderPriorityScheduler to let the most urgent renders
+     * use the thread pool first. It should be set before the render starts. By default this is eRenderPriorityBackground.
+     **/
+    void setPriority(RenderPriorityEnum priority);
+    RenderPriorityEnum getPriority() const;
+
+    /**
+     * @brief Called when this render marks images as being rendered in the trimap and when it unmarks them.
+     * Other renders, possibly more urgent, may be waiting on the pixels of these images: while it has any,
+     * this render does not yield to more urgent renders. See AbortableRenderInfoImagesBeingRendered_RAII.
+     **/
+    void registerImagesBeingRendered();
+    void unregisterImagesBeingRendered();
+    bool hasImagesBeingRendered() const;
+
     /**
      * @brief Registers the thread as part of this render request. Whenever AbortableThread::setAbortInfo is called, the thread is automatically registered
      * in this class as to be part of this render. This is used to monitor running threads for a specific render and to know if a thread has stalled when
@@ -154,6 +170,31 @@ private:
     boost::scoped_ptr<AbortableRenderInfoPrivate> _imp;
 };
 
+/**
+ * @brief Registers images as being rendered by the given render for its lifetime
+ **/
+class AbortableRenderInfoImagesBeingRendered_RAII
+{
+    AbortableRenderInfoPtr _info;
+
+public:
+
+    AbortableRenderInfoImagesBeingRendered_RAII(const AbortableRenderInfoPtr& info)
+        : _info(info)
+    {
+        if (_info) {
+            _info->registerImagesBeingRendered();
+        }
+    }
+
+    ~AbortableRenderInfoImagesBeingRendered_RAII()
+    {
+        if (_info) {
+            _info->unregisterImagesBeingRendered();
+        }
+    }
+};
+
 NATRON_NAMESPACE_EXIT;
 
 #endif // ABORTABLERENDERINFO_H
@@ -31,6 +31,7 @@
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
+#include <QtCore/QFile>
 #include <QtCore/QTextStream>
 #include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
 #include <QtCore/QUrl>
@@ -47,6 +48,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #endif
 
+#include "Global/MemoryInfo.h"
 #include "Global/QtCompat.h" // removeFileExtension
 
 #include "Engine/BlockingBackgroundRender.h"
@@ -56,6 +58,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/GroupOutput.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/DiskCacheNode.h"
+#include "Engine/MultiProcessRender.h"
 #include "Engine/Node.h"
 #include "Engine/OfxHost.h"
 #include "Engine/OutputEffectInstance.h"
@@ -68,6 +71,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/RotoLayer.h"
 #include "Engine/SerializableWindow.h"
 #include "Engine/Settings.h"
+#include "Engine/SharedUpstreamImages.h"
 #include "Engine/PyPanelI.h"
 #include "Engine/TabWidgetI.h"
 #include "Engine/ViewerInstance.h"
@@ -284,6 +288,12 @@ public:
 
     void startRenderingFullSequence(bool blocking, const RenderQueueItem& writerWork);
 
+    /**
+     * @brief Renders the given items by splitting their frame range across several renderer processes.
+     * Items that cannot be split are left in the list to be rendered by this process.
+     **/
+    void startMultiProcessRendering(int nProcesses, std::list<RenderQueueItem>* items);
+
     void checkNumberOfNonFloatingPanes();
 
 };
@@ -1483,9 +1493,9 @@ AppInstance::questionDialog(const std::string & title,
 }
 
 void
-AppInstance::triggerAutoSave()
+AppInstance::triggerAutoSave(const NodePtr& changedNode)
 {
-    _imp->_currentProject->triggerAutoSave();
+    _imp->_currentProject->triggerAutoSave(changedNode);
 }
 
 void
@@ -1605,8 +1615,35 @@ AppInstance::startWritersRendering(bool doBlockingRender,
     }
 
     if (appPTR->isBackground() || doBlockingRender) {
+        int nRenderProcesses = appPTR->getRenderProcessesCount();
+        if ( appPTR->isBackground() && (nRenderProcesses > 1) ) {
+            _imp->startMultiProcessRendering(nRenderProcesses, &itemsToQueue);
+        }
+
+        // When several writers render together in this process, the images of the nodes upstream of more than one of them
+        // are kept until all the writers rendered the frame, so that they are rendered once and read from the cache by the others.
+        // At most half of the RAM allowed to the caches is held this way.
+        SharedUpstreamImagesPtr sharedImages;
+        if ( !renderInSeparateProcess && (itemsToQueue.size() > 1) ) {
+            std::size_t maxHeldBytes = (std::size_t)( appPTR->getCurrentSettings()->getRamMaximumPercent() * getSystemTotalRAM_conditionnally() / 2 );
+            sharedImages.reset( new SharedUpstreamImages(maxHeldBytes) );
+            // Each writer is registered with the range it renders, resolved by validateRenderOptions() above, and only if it renders
+            // in this process: the writers rendered by other processes are no longer in itemsToQueue
+            for (std::list<RenderQueueItem>::const_iterator it = itemsToQueue.begin(); it != itemsToQueue.end(); ++it) {
+                sharedImages->addWriter(it->work.writer->getNode(), it->work.firstFrame, it->work.lastFrame, it->work.frameStep);
+                it->work.writer->setSharedUpstreamImages(sharedImages);
+            }
+        }
+
         //blocking call, we don't want this function to return pre-maturely, in which case it would kill the app
         QtConcurrent::blockingMap( itemsToQueue, boost::bind(&AppInstancePrivate::startRenderingFullSequence, _imp.get(), true, _1) );
+
+        if (sharedImages) {
+            for (std::list<RenderQueueItem>::const_iterator it = itemsToQueue.begin(); it != itemsToQueue.end(); ++it) {
+                it->work.writer->setSharedUpstreamImages( SharedUpstreamImagesPtr() );
+            }
+            sharedImages->clear();
+        }
     } else {
         bool isQueuingEnabled = appPTR->getCurrentSettings()->isRenderQueuingEnabled();
         if (isQueuingEnabled) {
@@ -1692,6 +1729,44 @@ AppInstancePrivate::validateRenderOptions(const AppInstance::RenderWork& w,
     return true;
 }
 
+void
+AppInstancePrivate::startMultiProcessRendering(int nProcesses,
+                                               std::list<RenderQueueItem>* items)
+{
+    // The processes load the project from a file: save it with a name unique to this process
+    // since other renderers may be running on the same machine
+    QString savePath;
+    QString saveName = QString::fromUtf8("RENDER_SAVE_%1.ntp").arg( QCoreApplication::applicationPid() );
+    _publicInterface->getProject()->saveProject_imp(QString(), saveName, true, false, &savePath);
+    if ( savePath.isEmpty() ) {
+        return;
+    }
+
+    std::list<RenderQueueItem> localItems;
+    for (std::list<RenderQueueItem>::const_iterator it = items->begin(); it != items->end(); ++it) {
+        // A video can only be written by a single process
+        if ( it->work.writer->isVideoWriter() ) {
+            localItems.push_back(*it);
+            continue;
+        }
+
+        // The processes report to the event loop of the main-thread, hence writers are rendered one after another
+        MultiProcessRender render(savePath, it->work.writer, it->work.firstFrame, it->work.lastFrame, it->work.frameStep, nProcesses, it->work.useRenderStats);
+        int retCode = render.blockingRender();
+        if ( render.isAborted() ) {
+            // Do not start the processes of the remaining writers
+            localItems.clear();
+            break;
+        }
+        if (retCode != 0) {
+            std::cerr << tr("Rendering of %1 failed.").arg( QString::fromUtf8( it->work.writer->getScriptName_mt_safe().c_str() ) ).toStdString() << std::endl;
+        }
+    }
+    QFile::remove(savePath);
+
+    items->swap(localItems);
+}
+
 void
 AppInstancePrivate::startRenderingFullSequence(bool blocking,
                                                const RenderQueueItem& w)
@@ -497,7 +497,7 @@ public Q_SLOTS:
 
     virtual void redrawAllViewers() {}
 
-    void triggerAutoSave();
+    void triggerAutoSave(const NodePtr& changedNode = NodePtr());
 
     void clearOpenFXPluginsCaches();
 
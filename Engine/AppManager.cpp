@@ -90,6 +90,7 @@
 #include "Engine/GroupOutput.h"
 #include "Engine/LibraryBinary.h"
 #include "Engine/Log.h"
+#include "Engine/MetricsServer.h"
 #include "Engine/Node.h"
 #include "Engine/FileSystemModel.h"
 #include "Engine/JoinViewsNode.h"
@@ -101,6 +102,7 @@
 #include "Engine/OneViewNode.h"
 #include "Engine/ProcessHandler.h" // ProcessInputChannel
 #include "Engine/Project.h"
+#include "Engine/RenderProgressReporter.h"
 #include "Engine/PrecompNode.h"
 #include "Engine/ReadNode.h"
 #include "Engine/RotoPaint.h"
@@ -110,6 +112,7 @@
 #include "Engine/StubNode.h"
 #include "Engine/TrackerNode.h"
 #include "Engine/ThreadPool.h"
+#include "Engine/Timer.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/ViewerInstance.h" // RenderStatsMap
 #include "Engine/ViewerNode.h"
@@ -387,7 +390,24 @@ AppManager::AppManager()
 void
 AppManager::takeNatronGIL()
 {
+    if ( _imp->natronPythonGIL.tryLock() ) {
+        return;
+    }
+
+    // Another thread holds the GIL: measure how long we wait for it
+    TimeLapse timer;
     _imp->natronPythonGIL.lock();
+    double timeWaited = timer.getTimeSinceCreation();
+    QMutexLocker k(&_imp->gilWaitTimeMutex);
+    _imp->gilWaitTime += timeWaited;
+}
+
+double
+AppManager::getPythonGILWaitTime() const
+{
+    QMutexLocker k(&_imp->gilWaitTimeMutex);
+
+    return _imp->gilWaitTime;
 }
 
 void
@@ -601,6 +621,15 @@ AppManager::~AppManager()
     }
 
 
+    // The reporter may still write to the IPC channel
+    if (_imp->progressReporter) {
+        _imp->progressReporter->quitThread();
+        _imp->progressReporter.reset();
+    }
+    if (_imp->metricsServer) {
+        _imp->metricsServer->quitServer();
+        _imp->metricsServer.reset();
+    }
     _imp->_backgroundIPC.reset();
 
     try {
@@ -826,6 +855,22 @@ AppManager::loadInternal(const CLArgs& cl)
     // see http://doc.qt.io/qt-4.8/qcoreapplication.html#locale-settings
     setApplicationLocale();
     
+    if (cl.getNUMANode() != -1) {
+        // Bind before any thread gets created so that they all inherit the CPU affinity
+        if ( !ProcInfo::bindCurrentProcessToNUMANode( cl.getNUMANode() ) ) {
+            std::cerr << tr("WARNING: Could not bind the process to the NUMA node %1").arg( cl.getNUMANode() ).toStdString() << std::endl;
+        } else {
+            // Only the CPUs of the node may run our threads: do not size the thread pools from the whole machine
+            int nodeCPUsCount = ProcInfo::getNUMANodeCPUsCount( cl.getNUMANode() );
+            if ( (nodeCPUsCount > 0) && (nodeCPUsCount < _imp->idealThreadCount) ) {
+                _imp->idealThreadCount = nodeCPUsCount;
+                QThreadPool::globalInstance()->setMaxThreadCount(nodeCPUsCount);
+            }
+        }
+    }
+    _imp->renderProcessesCount = cl.getRenderProcessesCount();
+    _imp->diskCacheReadOnly = cl.isDiskCacheReadOnly();
+
     Log::instance(); //< enable logging
     bool mustSetSignalsHandlers = true;
 #ifdef NATRON_USE_BREAKPAD
@@ -1069,6 +1114,8 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
         _imp->_diskCache.reset( new ImageCache("DiskCache", NATRON_CACHE_VERSION, maxDiskCacheNode, 0.) );
         _imp->_viewerCache.reset( new FrameEntryCache("ViewerCache", NATRON_CACHE_VERSION, viewerCacheSize, 0.) );
         _imp->setViewerCacheTileSize();
+        setApplicationsCachesEvictionPolicy( _imp->_settings->getCacheEvictionPolicy() );
+        setApplicationsCachesStorageCompression( _imp->_settings->isDiskCacheCompressionEnabled() );
     } catch (std::logic_error) {
         // ignore
     }
@@ -1113,6 +1160,20 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
         _imp->initProcessInputChannel( cl.getIPCPipeName() );
     }
 
+    if ( isBackground() ) {
+        _imp->progressReporter.reset( new RenderProgressReporter( cl.getProgressInterval(),
+                                                                  cl.isProgressOutputJSON() ? RenderProgressReporter::eOutputFormatJSON : RenderProgressReporter::eOutputFormatText ) );
+        _imp->progressReporter->start();
+
+        if (cl.getMetricsPort() > 0) {
+            _imp->metricsServer.reset( new MetricsServer( (quint16)cl.getMetricsPort() ) );
+            if ( !_imp->metricsServer->startServer() ) {
+                std::cerr << tr("Could not serve the metrics on port %1").arg( cl.getMetricsPort() ).toStdString() << std::endl;
+                _imp->metricsServer.reset();
+            }
+        }
+    }
+
 
     if ( cl.isInterpreterMode() ) {
         _imp->_appType = eAppTypeInterpreter;
@@ -1205,7 +1266,8 @@ AppManagerPrivate::setViewerCacheTileSize()
     switch (viewerDepth) {
         case eImageBitDepthFloat:
         case eImageBitDepthHalf:
-            tileSize *= sizeof(float);
+            // Float textures may be stored as half-float in the cache, in which case they are converted when rendered and displayed
+            tileSize *= _settings->isViewerCacheHalfFloatEnabled() ? sizeof(unsigned short) : sizeof(float);
             break;
         default:
             break;
@@ -1450,6 +1512,42 @@ AppManager::isLoaded() const
     return _imp->_loaded;
 }
 
+int
+AppManager::getRenderProcessesCount() const
+{
+    return _imp->renderProcessesCount;
+}
+
+bool
+AppManager::isDiskCacheReadOnly() const
+{
+    return _imp->diskCacheReadOnly;
+}
+
+RenderProgressReporter*
+AppManager::getRenderProgressReporter() const
+{
+    return _imp->progressReporter.get();
+}
+
+MetricsServer*
+AppManager::getMetricsServer() const
+{
+    return _imp->metricsServer.get();
+}
+
+RenderPriorityScheduler*
+AppManager::getRenderPriorityScheduler() const
+{
+    return _imp->renderPriorityScheduler.get();
+}
+
+DirectoryScanner*
+AppManager::getDirectoryScanner() const
+{
+    return _imp->directoryScanner.get();
+}
+
 void
 AppManager::abortAnyProcessing()
 {
@@ -1462,6 +1560,8 @@ AppManager::abortAnyProcessing()
     for (AppInstanceVec::iterator it = copy.begin(); it != copy.end(); ++it) {
         (*it)->getProject()->quitAnyProcessingForAllNodes_non_blocking();
     }
+
+    Q_EMIT anyProcessingAborted();
 }
 
 bool
@@ -1504,6 +1604,22 @@ AppManager::setApplicationsCachesMaximumDiskSpace(unsigned long long size)
     _imp->_diskCache->setMaximumCacheSize(size);
 }
 
+void
+AppManager::setApplicationsCachesEvictionPolicy(CacheEvictionPolicyEnum policy)
+{
+    // The viewer cache does not know the render cost of its entries, it always evicts the least recently used ones
+    _imp->_nodeCache->setEvictionPolicy(policy);
+    _imp->_diskCache->setEvictionPolicy(policy);
+}
+
+void
+AppManager::setApplicationsCachesStorageCompression(bool enabled)
+{
+    // Only the DiskCache node images are stored in files of their own: the node cache lives in RAM and
+    // the viewer cache tiles have a fixed size
+    _imp->_diskCache->setStorageCompressionEnabled(enabled);
+}
+
 void
 AppManager::loadAllPlugins()
 {
@@ -2595,6 +2711,26 @@ AppManager::getImageOrCreate_diskCache(const ImageKey & key,
                                        const ImageParamsPtr& params,
                                        ImagePtr* returnValue) const
 {
+    if (_imp->diskCacheReadOnly) {
+        // The disk cache is shared with other processes: only use the images already there and
+        // render the others in RAM without caching them
+        std::list<ImagePtr> cachedImages;
+        if ( _imp->_diskCache->get(key, &cachedImages) ) {
+            for (std::list<ImagePtr>::iterator it = cachedImages.begin(); it != cachedImages.end(); ++it) {
+                if ( *(*it)->getParams() == *params ) {
+                    *returnValue = *it;
+
+                    return true;
+                }
+            }
+        }
+        ImageParamsPtr ramParams( new ImageParams(*params) );
+        ramParams->getStorageInfo().mode = eStorageModeRAM;
+        returnValue->reset( new Image(key, ramParams) );
+
+        return false;
+    }
+
     return _imp->_diskCache->getOrCreate(key, params, 0, returnValue);
 }
 
@@ -2637,6 +2773,28 @@ AppManager::getCachesTotalDiskSize() const
     return  _imp->_diskCache->getDiskCacheSize() + _imp->_viewerCache->getDiskCacheSize();
 }
 
+template <typename CacheType>
+static void
+appendCacheStatistics(const CacheType& cache,
+                      std::list<AppManager::CacheStatistics>* stats)
+{
+    AppManager::CacheStatistics s;
+
+    s.name = cache.cacheName();
+    s.memoryBytes = cache.getMemoryCacheSize();
+    s.diskBytes = cache.getDiskCacheSize();
+    cache.getLookupsCount(&s.hits, &s.misses);
+    stats->push_back(s);
+}
+
+void
+AppManager::getCachesStatistics(std::list<CacheStatistics>* stats) const
+{
+    appendCacheStatistics(*_imp->_nodeCache, stats);
+    appendCacheStatistics(*_imp->_diskCache, stats);
+    appendCacheStatistics(*_imp->_viewerCache, stats);
+}
+
 boost::shared_ptr<CacheSignalEmitter>
 AppManager::getOrActivateViewerCacheSignalEmitter() const
 {
@@ -3994,24 +4152,17 @@ NATRON_PYTHON_NAMESPACE::ensureScriptHasModuleImport(const std::string& moduleNa
 
 #endif
 
-bool
-NATRON_PYTHON_NAMESPACE::interpretPythonScript(const std::string& script,
-                                               std::string* error,
-                                               std::string* output)
+/**
+ * @brief Called after running Python code: in a Gui session, fetches what the code printed on stdout and stderr.
+ * Returns false if the code raised an error.
+ **/
+static bool
+catchPythonOutputAndErrors(const std::string& context,
+                           std::string* error,
+                           std::string* output)
 {
-#ifdef NATRON_RUN_WITHOUT_PYTHON
-
-    return true;
-#endif
-    PythonGILLocker pgl;
     PyObject* mainModule = NATRON_PYTHON_NAMESPACE::getMainModule();
-    PyObject* dict = PyModule_GetDict(mainModule);
 
-    ///This is faster than PyRun_SimpleString since is doesn't call PyImport_AddModule("__main__")
-    PyObject* v = PyRun_String(script.c_str(), Py_file_input, dict, 0);
-    if (v) {
-        Py_DECREF(v);
-    }
     if ( !appPTR->isBackground() ) {
         ///Gui session, do stdout, stderr redirection
         PyObject *errCatcher = 0;
@@ -4031,7 +4182,7 @@ NATRON_PYTHON_NAMESPACE::interpretPythonScript(const std::string& script,
         if (errCatcher && error) {
             errorObj = PyObject_GetAttrString(errCatcher, "value"); //get the  stderr from our catchErr object, new ref
             assert(errorObj);
-            *error = PyStringToStdString(errorObj);
+            *error = NATRON_PYTHON_NAMESPACE::PyStringToStdString(errorObj);
             PyObject* unicode = PyUnicode_FromString("");
             PyObject_SetAttrString(errCatcher, "value", unicode);
             Py_DECREF(errorObj);
@@ -4041,7 +4192,7 @@ NATRON_PYTHON_NAMESPACE::interpretPythonScript(const std::string& script,
         if (outCatcher && output) {
             outObj = PyObject_GetAttrString(outCatcher, "value"); //get the stdout from our catchOut object, new ref
             assert(outObj);
-            *output = PyStringToStdString(outObj);
+            *output = NATRON_PYTHON_NAMESPACE::PyStringToStdString(outObj);
             PyObject* unicode = PyUnicode_FromString("");
             PyObject_SetAttrString(outCatcher, "value", unicode);
             Py_DECREF(outObj);
@@ -4049,7 +4200,7 @@ NATRON_PYTHON_NAMESPACE::interpretPythonScript(const std::string& script,
         }
 
         if ( error && !error->empty() ) {
-            *error = "While executing script:\n" + script + "Python error:\n" + *error;
+            *error = context + "Python error:\n" + *error;
 
             return false;
         }
@@ -4064,8 +4215,50 @@ NATRON_PYTHON_NAMESPACE::interpretPythonScript(const std::string& script,
             return true;
         }
     }
+} // catchPythonOutputAndErrors
+
+bool
+NATRON_PYTHON_NAMESPACE::interpretPythonScript(const std::string& script,
+                                               std::string* error,
+                                               std::string* output)
+{
+#ifdef NATRON_RUN_WITHOUT_PYTHON
+
+    return true;
+#endif
+    PythonGILLocker pgl;
+    PyObject* mainModule = NATRON_PYTHON_NAMESPACE::getMainModule();
+    PyObject* dict = PyModule_GetDict(mainModule);
+
+    ///This is faster than PyRun_SimpleString since is doesn't call PyImport_AddModule("__main__")
+    PyObject* v = PyRun_String(script.c_str(), Py_file_input, dict, 0);
+    if (v) {
+        Py_DECREF(v);
+    }
+
+    return catchPythonOutputAndErrors("While executing script:\n" + script, error, output);
 } // NATRON_PYTHON_NAMESPACE::interpretPythonScript
 
+bool
+NATRON_PYTHON_NAMESPACE::callPythonFunction(PyObject* function,
+                                            PyObject* args,
+                                            const std::string& functionName,
+                                            std::string* error,
+                                            std::string* output)
+{
+#ifdef NATRON_RUN_WITHOUT_PYTHON
+
+    return true;
+#endif
+    PythonGILLocker pgl;
+    PyObject* v = PyObject_CallObject(function, args);
+    if (v) {
+        Py_DECREF(v);
+    }
+
+    return catchPythonOutputAndErrors("While calling " + functionName + ":\n", error, output);
+} // NATRON_PYTHON_NAMESPACE::callPythonFunction
+
 #if 0 // dead code
 void
 NATRON_PYTHON_NAMESPACE::compilePyScript(const std::string& script,
@@ -149,6 +149,37 @@ public:
 
     bool isLoaded() const;
 
+    /**
+     * @brief Returns the number of renderer processes background renders should be split across, 0 or 1 meaning
+     * that the render happens in this process.
+     **/
+    int getRenderProcessesCount() const;
+
+    /**
+     * @brief Returns true if the disk cache is shared with other processes: images are read from it but never written.
+     **/
+    bool isDiskCacheReadOnly() const;
+
+    /**
+     * @brief Returns the object reporting render progress to the standard output and the IPC pipe, only in background mode.
+     **/
+    RenderProgressReporter* getRenderProgressReporter() const;
+
+    /**
+     * @brief Returns the server exposing the render metrics over HTTP, or NULL if it was not enabled on the command line.
+     **/
+    MetricsServer* getMetricsServer() const;
+
+    /**
+     * @brief Returns the object sharing the thread pool between interactive renders, playback, analysis, renders on disk and previews.
+     **/
+    RenderPriorityScheduler* getRenderPriorityScheduler() const;
+
+    /**
+     * @brief Returns the object listing directories for the file dialogs and the readers, which keeps the last listed ones.
+     **/
+    DirectoryScanner* getDirectoryScanner() const;
+
     AppInstancePtr newAppInstance(const CLArgs& cl, bool makeEmptyInstance);
     AppInstancePtr newBackgroundInstance(const CLArgs& cl, bool makeEmptyInstance);
 
@@ -214,6 +245,20 @@ public:
 
     U64 getCachesTotalMemorySize() const;
     U64 getCachesTotalDiskSize() const;
+
+    struct CacheStatistics
+    {
+        std::string name;
+        U64 memoryBytes;
+        U64 diskBytes;
+        U64 hits;
+        U64 misses;
+    };
+
+    /**
+     * @brief Returns the size and the number of hits and misses of the node, disk and viewer caches
+     **/
+    void getCachesStatistics(std::list<CacheStatistics>* stats) const;
     boost::shared_ptr<CacheSignalEmitter> getOrActivateViewerCacheSignalEmitter() const;
 
     void setApplicationsCachesMaximumMemoryPercent(double p);
@@ -222,6 +267,10 @@ public:
 
     void setApplicationsCachesMaximumDiskSpace(unsigned long long size);
 
+    void setApplicationsCachesEvictionPolicy(CacheEvictionPolicyEnum policy);
+
+    void setApplicationsCachesStorageCompression(bool enabled);
+
     /**
      * @brief Removes from the node cache the given image.
      **/
@@ -311,6 +360,7 @@ public:
      * @brief Abort any processing on all AppInstance. It is called in some very rare cases
      * such as when changing the number of threads used by the application or when a background render
      * receives a message from the GUI application.
+     * The anyProcessingAborted signal is emitted so that renders running in other processes can be aborted too.
      **/
     void abortAnyProcessing();
 
@@ -498,6 +548,11 @@ public:
 
     void releaseNatronGIL();
 
+    /**
+     * @brief Returns the total time in seconds threads spent waiting for another thread to release the Python GIL
+     **/
+    double getPythonGILWaitTime() const;
+
 #ifdef __NATRON_WIN32__
     void registerUNCPath(const QString& path, const QChar& driveLetter);
     QString mapUNCPathToPathWithDriveLetter(const QString& uncPath) const;
@@ -665,6 +720,8 @@ Q_SIGNALS:
 
     void checkerboardSettingsChanged();
 
+    void anyProcessingAborted();
+
     void s_requestOFXDialogOnMainThread(OfxImageEffectInstance* instance, void* instanceData);
 
 protected:
@@ -808,6 +865,15 @@ PyObject* getMainModule();
  **/
 bool interpretPythonScript(const std::string& script, std::string* error, std::string* output);
 
+/**
+ * @brief Calls the given Python function with the tuple args (may be NULL if the function takes no argument).
+ * Unlike interpretPythonScript, no script is parsed. functionName is only used in the error message.
+ * @param error[out] Same as for interpretPythonScript
+ * @param output[out] Same as for interpretPythonScript
+ * @returns True on success, false if the function raised an error.
+ **/
+bool callPythonFunction(PyObject* function, PyObject* args, const std::string& functionName, std::string* error, std::string* output);
+
 
 //void compilePyScript(const std::string& script,PyObject** code);
 
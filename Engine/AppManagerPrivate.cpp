@@ -51,13 +51,17 @@
 
 #include "Engine/FStreamsSupport.h"
 #include "Engine/CLArgs.h"
+#include "Engine/DirectoryScanner.h"
 #include "Engine/ExistenceCheckThread.h"
 #include "Engine/Format.h"
 #include "Engine/FrameEntry.h"
 #include "Engine/Image.h"
+#include "Engine/MetricsServer.h"
 #include "Engine/OfxHost.h"
 #include "Engine/OSGLContext.h"
 #include "Engine/ProcessHandler.h" // ProcessInputChannel
+#include "Engine/RenderPriorityScheduler.h"
+#include "Engine/RenderProgressReporter.h"
 #include "Engine/StandardPaths.h"
 
 #include "Serialization/CacheSerialization.h"
@@ -89,6 +93,12 @@ AppManagerPrivate::AppManagerPrivate()
     , diskCachesLocationMutex()
     , diskCachesLocation()
     , _backgroundIPC()
+    , renderProcessesCount(0)
+    , diskCacheReadOnly(false)
+    , progressReporter()
+    , metricsServer()
+    , renderPriorityScheduler( new RenderPriorityScheduler() )
+    , directoryScanner( new DirectoryScanner() )
     , _loaded(false)
     , _binaryPath()
     , _nodesGlobalMemoryUse(0)
@@ -115,6 +125,8 @@ AppManagerPrivate::AppManagerPrivate()
     , breakpadAliveThread()
 #endif
     , natronPythonGIL(QMutex::Recursive)
+    , gilWaitTimeMutex()
+    , gilWaitTime(0.)
     , pluginsUseInputImageCopyToRender(false)
     , glRequirements()
     , glHasTextureFloat(false)
@@ -312,6 +324,10 @@ saveCache(const boost::shared_ptr<Cache<T> >& cache)
 void
 AppManagerPrivate::saveCaches()
 {
+    if (diskCacheReadOnly) {
+        // The caches are shared with other processes
+        return;
+    }
     saveCache<FrameEntry>( _viewerCache );
     saveCache<Image>( _diskCache );
 } // saveCaches
@@ -359,6 +375,9 @@ AppManagerPrivate::restoreCaches()
     if ( !appPTR->isBackground() ) {
         restoreCache<FrameEntry>( this, _viewerCache );
         restoreCache<Image>( this, _diskCache );
+    } else if ( diskCacheReadOnly && QFile::exists( QString::fromUtf8( _diskCache->getRestoreFilePath().c_str() ) ) ) {
+        // Renderer processes sharing the disk cache read the images rendered by DiskCache nodes
+        restoreCache<Image>( this, _diskCache );
     }
 } // restoreCaches
 
@@ -99,6 +99,12 @@ public:
     QString diskCachesLocation;
     boost::scoped_ptr<ProcessInputChannel> _backgroundIPC; //< object used to communicate with the main app
     //if this app is background, see the ProcessInputChannel def
+    int renderProcessesCount; //< number of renderer processes to split background renders across, see CLArgs
+    bool diskCacheReadOnly; //< if true, the disk cache is shared with other processes and never written to
+    boost::scoped_ptr<RenderProgressReporter> progressReporter; //< reports the progress of renders in background mode
+    boost::scoped_ptr<MetricsServer> metricsServer; //< serves the render metrics if --metrics-port was given
+    boost::scoped_ptr<RenderPriorityScheduler> renderPriorityScheduler; //< shares the thread pool between the render priority classes
+    boost::scoped_ptr<DirectoryScanner> directoryScanner; //< lists the directories of image sequences
     bool _loaded; //< true when the first instance is completly loaded.
     QString _binaryPath; //< the path to the application's binary
     U64 _nodesGlobalMemoryUse; //< how much memory all the nodes are using (besides the cache)
@@ -156,6 +162,10 @@ public:
 
     QMutex natronPythonGIL;
 
+    // Protects gilWaitTime
+    mutable QMutex gilWaitTimeMutex;
+    double gilWaitTime; // total time in seconds spent waiting for natronPythonGIL
+
 #ifdef Q_OS_WIN32
     //On Windows only, track the UNC path we came across because the WIN32 API does not provide any function to map
     //from UNC path to path with drive letter.
@@ -63,6 +63,12 @@ public:
     std::list<std::pair<int, std::pair<int, int> > > frameRanges;
     bool rangeSet;
     bool enableRenderStats;
+    int renderProcesses;
+    int numaNode;
+    bool diskCacheReadOnly;
+    int progressInterval;
+    bool progressJSON;
+    int metricsPort;
     bool isEmpty;
     mutable QString imageFilename;
     QString breakpadPipeFilePath;
@@ -87,6 +93,12 @@ public:
         , frameRanges()
         , rangeSet(false)
         , enableRenderStats(false)
+        , renderProcesses(0)
+        , numaNode(-1)
+        , diskCacheReadOnly(false)
+        , progressInterval(0)
+        , progressJSON(false)
+        , metricsPort(0)
         , isEmpty(true)
         , imageFilename()
         , breakpadPipeFilePath()
@@ -221,6 +233,12 @@ CLArgs::operator=(const CLArgs& other)
     _imp->frameRanges = other._imp->frameRanges;
     _imp->rangeSet = other._imp->rangeSet;
     _imp->enableRenderStats = other._imp->enableRenderStats;
+    _imp->renderProcesses = other._imp->renderProcesses;
+    _imp->numaNode = other._imp->numaNode;
+    _imp->diskCacheReadOnly = other._imp->diskCacheReadOnly;
+    _imp->progressInterval = other._imp->progressInterval;
+    _imp->progressJSON = other._imp->progressJSON;
+    _imp->metricsPort = other._imp->metricsPort;
     _imp->isEmpty = other._imp->isEmpty;
     _imp->imageFilename = other._imp->imageFilename;
     _imp->exportDocsPath = other._imp->exportDocsPath;
@@ -316,7 +334,32 @@ CLArgs::printUsage(const std::string& programName)
         "     breakdown contains informations about each nodes, render times etc...\n"
         "     This option is useful for debugging purposes or to control that a render\n"
         "     is working correctly.\n"
-        "     **Please note** that it does not work when writing video files."
+        "     **Please note** that it does not work when writing video files.\n"
+        "  --render-processes <N>\n"
+        "     Split the frame range of each Write node across N renderer processes.\n"
+        "     Frames are handed out in chunks to the processes as they become idle.\n"
+        "     On machines with several NUMA nodes, each process is bound to a node.\n"
+        "     The processes share the disk cache in read-only mode.\n"
+        "     This option is ignored for Write nodes writing video files.\n"
+        "  --numa-node <index>\n"
+        "     Bind the renderer process to the CPUs of the given NUMA node.\n"
+        "  --read-only-cache\n"
+        "     Read images from the disk cache but never write to it, so that several\n"
+        "     processes can share it.\n"
+        "  --progress-interval <ms>\n"
+        "     Print the render progress at most once every <ms> milliseconds for each\n"
+        "     Write node instead of once per frame.\n"
+        "  --progress-format <text|json>\n"
+        "     The format of the render progress printed on the standard output.\n"
+        "     With json, each progress update is printed as a JSON object on a single\n"
+        "     line with the writer, frame, framesRendered, framesTotal, progress, fps\n"
+        "     and timeRemaining (in seconds) keys.\n"
+        "  --metrics-port <port>\n"
+        "     Serve the render metrics of the renderer process on http://127.0.0.1:<port>.\n"
+        "     GET /metrics returns the render progress, the render time per node, the\n"
+        "     cache and thread pool statistics in the Prometheus text format.\n"
+        "     POST /abort aborts the renders and POST /priority?value=<nice> changes the\n"
+        "     scheduling priority of the process (-20 to 19).\n"
         "Sample uses:\n"
         "  %1 /Users/Me/MyNatronProjects/MyProject.ntp\n"
         "  %1 -b -w MyWriter /Users/Me/MyNatronProjects/MyProject.ntp\n"
@@ -474,6 +517,42 @@ CLArgs::areRenderStatsEnabled() const
     return _imp->enableRenderStats;
 }
 
+int
+CLArgs::getRenderProcessesCount() const
+{
+    return _imp->renderProcesses;
+}
+
+int
+CLArgs::getNUMANode() const
+{
+    return _imp->numaNode;
+}
+
+bool
+CLArgs::isDiskCacheReadOnly() const
+{
+    return _imp->diskCacheReadOnly;
+}
+
+int
+CLArgs::getProgressInterval() const
+{
+    return _imp->progressInterval;
+}
+
+bool
+CLArgs::isProgressOutputJSON() const
+{
+    return _imp->progressJSON;
+}
+
+int
+CLArgs::getMetricsPort() const
+{
+    return _imp->metricsPort;
+}
+
 bool
 CLArgs::isPythonScript() const
 {
@@ -851,6 +930,107 @@ CLArgsPrivate::parse()
         }
     }
 
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("render-processes"), QString() );
+        if ( it != args.end() ) {
+            ++it;
+            bool ok = false;
+            if ( it != args.end() ) {
+                renderProcesses = it->toInt(&ok);
+            }
+            if ( !ok || (renderProcesses < 1) ) {
+                std::cout << tr("You must specify a valid number of processes for the --render-processes option").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            args.erase(it);
+        }
+    }
+
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("numa-node"), QString() );
+        if ( it != args.end() ) {
+            ++it;
+            bool ok = false;
+            if ( it != args.end() ) {
+                numaNode = it->toInt(&ok);
+            }
+            if ( !ok || (numaNode < 0) ) {
+                std::cout << tr("You must specify a valid NUMA node index for the --numa-node option").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            args.erase(it);
+        }
+    }
+
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("read-only-cache"), QString() );
+        if ( it != args.end() ) {
+            diskCacheReadOnly = true;
+            args.erase(it);
+        }
+    }
+
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("progress-interval"), QString() );
+        if ( it != args.end() ) {
+            ++it;
+            bool ok = false;
+            if ( it != args.end() ) {
+                progressInterval = it->toInt(&ok);
+            }
+            if ( !ok || (progressInterval < 0) ) {
+                std::cout << tr("You must specify a valid interval in milliseconds for the --progress-interval option").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            args.erase(it);
+        }
+    }
+
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("progress-format"), QString() );
+        if ( it != args.end() ) {
+            ++it;
+            if ( it != args.end() ) {
+                if ( *it == QString::fromUtf8("json") ) {
+                    progressJSON = true;
+                } else if ( *it != QString::fromUtf8("text") ) {
+                    it = args.end();
+                }
+            }
+            if ( it == args.end() ) {
+                std::cout << tr("The --progress-format option must be either text or json").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            args.erase(it);
+        }
+    }
+
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("metrics-port"), QString() );
+        if ( it != args.end() ) {
+            ++it;
+            bool ok = false;
+            if ( it != args.end() ) {
+                metricsPort = it->toInt(&ok);
+            }
+            if ( !ok || (metricsPort <= 0) || (metricsPort > 65535) ) {
+                std::cout << tr("You must specify a valid port number for the --metrics-port option").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            args.erase(it);
+        }
+    }
+
     {
         QStringList::iterator it = hasToken( QString::fromUtf8("onload"), QString::fromUtf8("l") );
         if ( it != args.end() ) {
@@ -130,6 +130,33 @@ public:
 
     bool areRenderStatsEnabled() const;
 
+    /**
+     * @brief Number of renderer processes the frame range should be split across, 0 if not set
+     **/
+    int getRenderProcessesCount() const;
+
+    /**
+     * @brief The NUMA node the process should be bound to, -1 if not set
+     **/
+    int getNUMANode() const;
+
+    bool isDiskCacheReadOnly() const;
+
+    /**
+     * @brief Minimum interval in milliseconds between 2 progress updates of a writer printed to the standard output, 0 if every frame should be printed
+     **/
+    int getProgressInterval() const;
+
+    /**
+     * @brief If true, progress updates are printed to the standard output as JSON lines
+     **/
+    bool isProgressOutputJSON() const;
+
+    /**
+     * @brief The local port on which the metrics and control endpoint is served, 0 if it is disabled
+     **/
+    int getMetricsPort() const;
+
     const QString& getBreakpadProcessExecutableFilePath() const;
 
     qint64 getBreakpadProcessPID() const;
@@ -65,7 +65,7 @@ GCC_DIAG_ON(deprecated)
 #include "Engine/EngineFwd.h"
 
 
-//Beyond that percentage of occupation, the cache will start evicting LRU entries
+//Beyond that percentage of occupation, the cache will start evicting entries (see setEvictionPolicy())
 #define NATRON_CACHE_LIMIT_PERCENT 0.9
 
 #define NATRON_TILE_CACHE_FILE_SIZE_BYTES 2000000000
@@ -475,7 +475,9 @@ private:
      */
     mutable std::size_t _memoryCacheSize;     // current size of the cache in bytes
     mutable std::size_t _diskCacheSize;
-    mutable QMutex _sizeLock; // protects _memoryCacheSize & _diskCacheSize & _maximumInMemorySize & _maximumCacheSize
+    bool _compressStorage; // if true, entries are compressed when moved to the disk portion
+    mutable U64 _nHits, _nMisses; // number of lookups that found an entry or not
+    mutable QMutex _sizeLock; // protects _memoryCacheSize & _diskCacheSize & _maximumInMemorySize & _maximumCacheSize & _compressStorage & _nHits & _nMisses
     mutable QMutex _lock; //protects _memoryCache & _diskCache
     mutable QMutex _getLock;  //prevents get() and getOrCreate() to be called simultaneously
 
@@ -526,6 +528,9 @@ public:
         , _maximumCacheSize(maximumCacheSize)
         , _memoryCacheSize(0)
         , _diskCacheSize(0)
+        , _compressStorage(false)
+        , _nHits(0)
+        , _nMisses(0)
         , _sizeLock()
         , _lock()
         , _getLock()
@@ -608,8 +613,11 @@ public:
 
         ///lock the cache before reading it.
         QMutexLocker locker(&_lock);
+        bool found = getInternal(key, returnValue);
 
-        return getInternal(key, returnValue);
+        countLookup(found);
+
+        return found;
     } // get
 
 private:
@@ -989,12 +997,14 @@ public:
                 for (typename std::list<EntryTypePtr>::iterator it = entries.begin(); it != entries.end(); ++it) {
                     if (*(*it)->getParams() == *params) {
                         *returnValue = *it;
+                        countLookup(true);
 
                         return true;
                     }
                 }
             }
 
+            countLookup(false);
             createInternal(key, params, locker, returnValue);
 
             return false;
@@ -1370,6 +1380,46 @@ public:
         _signalEmitter->emitEntryStorageChanged(time, (int)oldStorage, (int)newStorage);
     }
 
+    virtual void notifyEntryDiskSizeChanged(std::size_t oldSize,
+                                            std::size_t newSize) const OVERRIDE FINAL
+    {
+        assert(!_isTiled);
+
+        if (_tearingDown) {
+            return;
+        }
+        QMutexLocker k(&_sizeLock);
+        qint64 diff = (qint64)newSize - (qint64)oldSize;
+
+        if (diff < 0) {
+            _diskCacheSize = -diff > (qint64)_diskCacheSize ? 0 : _diskCacheSize + diff;
+        } else {
+            _diskCacheSize += diff;
+        }
+#ifdef NATRON_DEBUG_CACHE
+        qDebug() << cacheName().c_str() << " disk size: " << printAsRAM(_diskCacheSize);
+#endif
+    }
+
+    virtual bool isStorageCompressionEnabled() const OVERRIDE FINAL
+    {
+        QMutexLocker k(&_sizeLock);
+
+        return _compressStorage && !_isTiled && !_tearingDown;
+    }
+
+    /**
+     * @brief If enabled, the entries moved to the disk portion of the cache are compressed with a lossless codec
+     * (@see CacheStorageCodec) and decompressed when they are fetched again. The size of the disk portion is then
+     * the size of the compressed files.
+     **/
+    void setStorageCompressionEnabled(bool enabled)
+    {
+        QMutexLocker k(&_sizeLock);
+
+        _compressStorage = enabled;
+    }
+
     virtual void backingFileClosed() const OVERRIDE FINAL
     {
         assert(!_isTiled);
@@ -1412,6 +1462,19 @@ public:
         return newCachePath.toStdString();
     }
 
+    /**
+     * @brief Selects which entries are evicted first when the cache is full.
+     * With eCacheEvictionPolicyCostAware, the entries that took the longest to render per byte
+     * are kept longer than cheap ones, e.g: a blur result is kept longer than the output of a Read node.
+     **/
+    void setEvictionPolicy(CacheEvictionPolicyEnum policy)
+    {
+        QMutexLocker locker(&_lock);
+
+        _memoryCache.setCostAwareEvictionEnabled(policy == eCacheEvictionPolicyCostAware);
+        _diskCache.setCostAwareEvictionEnabled(policy == eCacheEvictionPolicyCostAware);
+    }
+
     void setMaximumCacheSize(U64 newSize)
     {
         QMutexLocker k(&_sizeLock);
@@ -1454,6 +1517,18 @@ public:
         return _diskCacheSize;
     }
 
+    /**
+     * @brief Returns the number of calls to get() and getOrCreate() that found an entry (hits) or not (misses)
+     **/
+    void getLookupsCount(U64* hits,
+                         U64* misses) const
+    {
+        QMutexLocker k(&_sizeLock);
+
+        *hits = _nHits;
+        *misses = _nMisses;
+    }
+
     boost::shared_ptr<CacheSignalEmitter> activateSignalEmitter() const
     {
         return _signalEmitter;
@@ -1743,44 +1818,12 @@ private:
     virtual void removeAllEntriesForPluginPrivate(const std::string& pluginID, std::list<AbstractCacheEntryBasePtr> *removedEntriesList = 0) OVERRIDE FINAL
     {
         std::list<EntryTypePtr> toDelete;
-        CacheContainer newMemCache, newDiskCache;
         {
             QMutexLocker locker(&_lock);
 
-            for (CacheIterator memIt = _memoryCache.begin(); memIt != _memoryCache.end(); ++memIt) {
-                std::list<EntryTypePtr> & entries = getValueFromIterator(memIt);
-                if ( !entries.empty() ) {
-                    const EntryTypePtr & front = entries.front();
-
-                    if ( front->getKey().getHolderPluginID() == pluginID ) {
-                        for (typename std::list<EntryTypePtr>::iterator it = entries.begin(); it != entries.end(); ++it) {
-                            toDelete.push_back(*it);
-                        }
-                    } else {
-                        typename EntryType::hash_type hash = front->getHashKey();
-                        newMemCache.insert(hash, entries);
-                    }
-                }
-            }
-
-            for (CacheIterator dIt = _diskCache.begin(); dIt != _diskCache.end(); ++dIt) {
-                std::list<EntryTypePtr> & entries = getValueFromIterator(dIt);
-                if ( !entries.empty() ) {
-                    const EntryTypePtr & front = entries.front();
-
-                    if ( front->getKey().getHolderPluginID() == pluginID ) {
-                        for (typename std::list<EntryTypePtr>::iterator it = entries.begin(); it != entries.end(); ++it) {
-                            toDelete.push_back(*it);
-                        }
-                    } else {
-                        typename EntryType::hash_type hash = front->getHashKey();
-                        newDiskCache.insert(hash, entries);
-                    }
-                }
-            }
-
-            _memoryCache = newMemCache;
-            _diskCache = newDiskCache;
+            // Erase in place: the containers keep their eviction policy and the state of their cost index
+            removeAllEntriesForPluginFromContainer(pluginID, _memoryCache, &toDelete);
+            removeAllEntriesForPluginFromContainer(pluginID, _diskCache, &toDelete);
         } // QMutexLocker locker(&_lock);
 
         if ( !toDelete.empty() ) {
@@ -1798,6 +1841,37 @@ private:
         }
     } // removeAllEntriesWithDifferentNodeHashForHolderPrivate
 
+    static void removeAllEntriesForPluginFromContainer(const std::string& pluginID,
+                                                       CacheContainer& container,
+                                                       std::list<EntryTypePtr>* removedEntries)
+    {
+        CacheIterator it = container.begin();
+
+        while ( it != container.end() ) {
+            std::list<EntryTypePtr> & entries = getValueFromIterator(it);
+            if ( entries.empty() || (entries.front()->getKey().getHolderPluginID() != pluginID) ) {
+                ++it;
+                continue;
+            }
+            removedEntries->insert( removedEntries->end(), entries.begin(), entries.end() );
+            CacheIterator next = it;
+            ++next;
+            container.erase(it);
+            it = next;
+        }
+    }
+
+    void countLookup(bool found) const
+    {
+        QMutexLocker k(&_sizeLock);
+
+        if (found) {
+            ++_nHits;
+        } else {
+            ++_nMisses;
+        }
+    }
+
     bool getInternal(const typename EntryType::key_type & key,
                      std::list<EntryTypePtr>* returnValue) const
     {
@@ -49,10 +49,12 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
 #endif
+#include "Engine/CacheStorageCodec.h"
 #include "Engine/Hash64.h"
 #include "Engine/MemoryFile.h"
 #include "Engine/NonKeyParams.h"
 #include "Engine/Texture.h"
+#include "Engine/Timer.h"
 #include <SequenceParsing.h> // for removePath
 #include "Engine/EngineFwd.h"
 #include "Global/GlobalDefines.h"
@@ -244,6 +246,18 @@ public:
     virtual void notifyEntryStorageChanged(StorageModeEnum oldStorage, StorageModeEnum newStorage,
                                            double time, size_t size) const = 0;
 
+    /**
+     * @brief To be called by a CacheEntry whenever the size of its file on disk changes, i.e: when
+     * the file was compressed or decompressed.
+     **/
+    virtual void notifyEntryDiskSizeChanged(size_t oldSize, size_t newSize) const = 0;
+
+    /**
+     * @brief Returns true if the entries stored on disk should be compressed when their file is unmapped
+     * from memory. Only non-tiled caches support it.
+     **/
+    virtual bool isStorageCompressionEnabled() const = 0;
+
     /**
      * @brief Remove from the cache all entries that matches the pluginID.
      **/
@@ -397,6 +411,10 @@ public:
         , _cacheFile()
         , _cacheFileDataOffset(0)
         , _storageMode(eStorageModeRAM)
+        , _compressedFileSize(0)
+        , _hasDecodeInfos(false)
+        , _lastCompressionRatio(1.)
+        , _lastDecodeTime(0.)
     {
     }
 
@@ -564,11 +582,64 @@ public:
             _backingFile.reset();
             throw std::bad_alloc();
         }
+
+        // The file may have been compressed by compressBackingFile(), possibly in a previous session
+        if ( _backingFile->data() && CacheStorageCodec::getDecompressedSize( _backingFile->data(), _backingFile->size() ) ) {
+            decompressBackingFile();
+        }
+    }
+
+    /**
+     * @brief Replaces the content of the memory mapped file by its compressed version. This is to be called
+     * right before deallocate() when the entry goes back to the disk portion of the cache.
+     * @returns The size of the compressed file, or 0 if the data did not compress and the file was left untouched.
+     **/
+    std::size_t compressBackingFile(int elementSize,
+                                    int nComps)
+    {
+        if ( !_backingFile || !_backingFile->data() || (_storageMode != eStorageModeDisk) ) {
+            return 0;
+        }
+        std::vector<char> compressed;
+        if ( !CacheStorageCodec::compressBuffer(_backingFile->data(), _backingFile->size(), elementSize, nComps, &compressed) ) {
+            return 0;
+        }
+        _backingFile->resize( compressed.size() );
+        std::memcpy( _backingFile->data(), &compressed[0], compressed.size() );
+        _compressedFileSize = compressed.size();
+
+        return _compressedFileSize;
+    }
+
+    /**
+     * @brief Returns the size of the compressed file if the buffer is not mapped to memory and was compressed, 0 otherwise.
+     **/
+    std::size_t getCompressedFileSize() const
+    {
+        return _compressedFileSize;
+    }
+
+    /**
+     * @brief If the file was decompressed since the last call to this function, returns true and the compression ratio
+     * of the file and the time (in seconds) it took to decompress it.
+     **/
+    bool takeDecodeInfos(double* compressionRatio,
+                         double* decodeTime) const
+    {
+        if (!_hasDecodeInfos) {
+            return false;
+        }
+        _hasDecodeInfos = false;
+        *compressionRatio = _lastCompressionRatio;
+        *decodeTime = _lastDecodeTime;
+
+        return true;
     }
 
     void restoreBufferFromFile(const std::string & path, std::size_t dataOffset, AbstractCacheEntryBase* entry, bool isTileCache)
     {
         _entry = entry;
+        _compressedFileSize = 0;
         if (isTileCache) {
             _cacheFile = entry->getTileCacheFile(path, dataOffset);
             if (!_cacheFile) {
@@ -617,6 +688,7 @@ public:
     bool removeAnyBackingFile() const
     {
         if (_storageMode == eStorageModeDisk && !_cacheFile) {
+            _compressedFileSize = 0;
             if (_backingFile) {
                 _backingFile->remove();
                 _backingFile.reset();
@@ -729,6 +801,23 @@ public:
 
 private:
 
+    void decompressBackingFile() const
+    {
+        TimeLapse timer;
+        std::vector<char> compressed( _backingFile->data(), _backingFile->data() + _backingFile->size() );
+        std::size_t rawSize = CacheStorageCodec::getDecompressedSize( &compressed[0], compressed.size() );
+
+        _backingFile->resize(rawSize);
+        if ( !CacheStorageCodec::decompressBuffer( &compressed[0], compressed.size(), _backingFile->data(), rawSize ) ) {
+            _backingFile.reset();
+            throw std::runtime_error("Corrupted compressed cache file: " + _path);
+        }
+        _compressedFileSize = 0;
+        _hasDecodeInfos = true;
+        _lastCompressionRatio = (double)rawSize / compressed.size();
+        _lastDecodeTime = timer.getTimeSinceCreation();
+    }
+
     std::string _path;
     boost::scoped_ptr<RamBuffer<DataType> > _buffer;
 
@@ -744,6 +833,12 @@ private:
     // Used when we store images as OpenGL textures
     boost::scoped_ptr<Texture> _glTexture;
     StorageModeEnum _storageMode;
+
+    // Set when the backing file is compressed, mutable so reOpenFileMapping() can decompress it
+    mutable std::size_t _compressedFileSize;
+    mutable bool _hasDecodeInfos;
+    mutable double _lastCompressionRatio;
+    mutable double _lastDecodeTime;
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -780,6 +875,8 @@ public:
         , _cache()
         , _entryLock(QReadWriteLock::Recursive)
         , _removeBackingFileBeforeDestruction(false)
+        , _renderCostMutex()
+        , _renderCost(0.)
     {
     }
 
@@ -798,6 +895,8 @@ public:
         , _cache(cache)
         , _entryLock(QReadWriteLock::Recursive)
         , _removeBackingFileBeforeDestruction(false)
+        , _renderCostMutex()
+        , _renderCost(0.)
     {
     }
 
@@ -953,11 +1052,16 @@ public:
         if (_cache && _cache->isTileCache()) {
             return;
         }
+        std::size_t compressedFileSize;
         {
             QWriteLocker k(&_entryLock);
+            compressedFileSize = _data.getCompressedFileSize();
             _data.reOpenFileMapping();
         }
         if (_cache) {
+            if (compressedFileSize) {
+                _cache->notifyEntryDiskSizeChanged( compressedFileSize, dataSize() );
+            }
             _cache->notifyEntryStorageChanged( eStorageModeDisk, eStorageModeRAM, getTime(), size() );
         }
     }
@@ -970,9 +1074,16 @@ public:
         std::size_t sz = size();
         bool dataAllocated = _data.isAllocated();
         double time = getTime();
+        std::size_t fileSize = 0;
+        std::size_t compressedFileSize = 0;
         {
             QWriteLocker k(&_entryLock);
 
+            if ( dataAllocated && _cache && !_cache->isTileCache() && _cache->isStorageCompressionEnabled() ) {
+                const CacheEntryStorageInfo& info = _params->getStorageInfo();
+                fileSize = _data.size();
+                compressedFileSize = _data.compressBackingFile(info.dataTypeSize, info.numComponents);
+            }
             _data.deallocate();
         }
 
@@ -984,6 +1095,9 @@ public:
                          _cache->notifyEntryDestroyed(time, sz, eStorageModeDisk);
                     } else {
                         _cache->notifyEntryStorageChanged( eStorageModeRAM, eStorageModeDisk, time, sz );
+                        if (compressedFileSize) {
+                            _cache->notifyEntryDiskSizeChanged(fileSize, compressedFileSize);
+                        }
                     }
                 }
             } else if (info.mode == eStorageModeRAM) {
@@ -1059,6 +1173,7 @@ public:
         }
 
         bool isAlloc = _data.isAllocated();
+        std::size_t compressedFileSize = _data.getCompressedFileSize();
         bool hasRemovedFile;
         {
             QWriteLocker k(&_entryLock);
@@ -1072,7 +1187,7 @@ public:
             _cache->notifyEntryDestroyed(getTime(), getElementsCountFromParams(), eStorageModeRAM);
         } else {
             ///size() will return 0 at this point, we have to recompute it
-            _cache->notifyEntryDestroyed(getTime(), getElementsCountFromParams(), eStorageModeDisk);
+            _cache->notifyEntryDestroyed(getTime(), compressedFileSize ? compressedFileSize : getElementsCountFromParams(), eStorageModeDisk);
         }
     }
 
@@ -1101,6 +1216,36 @@ public:
         return getElementsCountFromParams() * sizeof(DataType);
     }
 
+    /**
+     * @brief Accumulates the time (in seconds) spent rendering this entry. Each rendered portion of the entry
+     * adds its own time. This is used by the cost aware eviction of the cache.
+     **/
+    void addRenderCost(double seconds)
+    {
+        QMutexLocker k(&_renderCostMutex);
+
+        _renderCost += seconds;
+    }
+
+    double getRenderCost() const
+    {
+        QMutexLocker k(&_renderCostMutex);
+
+        return _renderCost;
+    }
+
+    /**
+     * @brief If the entry was decompressed when it was last fetched from the disk portion of the cache, returns true
+     * and the compression ratio of its file and the time (in seconds) spent decompressing it. Only returns true once per decompression.
+     **/
+    bool takeStorageDecodeInfos(double* compressionRatio,
+                                double* decodeTime) const
+    {
+        QWriteLocker k(&_entryLock);
+
+        return _data.takeDecodeInfos(compressionRatio, decodeTime);
+    }
+
     virtual U64 getElementsCountFromParams() const OVERRIDE FINAL WARN_UNUSED_RETURN
     {
         const CacheEntryStorageInfo& info = _params->getStorageInfo();
@@ -1257,6 +1402,8 @@ protected:
     const CacheAPI* _cache;
     mutable QReadWriteLock _entryLock;
     bool _removeBackingFileBeforeDestruction;
+    mutable QMutex _renderCostMutex;
+    double _renderCost; // protected by _renderCostMutex
 };
 
 NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,611 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "CacheStorageCodec.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring> // for std::memcpy
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#endif
+
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
+
+#define NATRON_CACHE_CODEC_MAGIC "NATRONZ1"
+#define NATRON_CACHE_CODEC_MAGIC_SIZE 8
+
+// magic, raw size (64 bits), block size, element size, number of components, number of blocks (32 bits each)
+#define NATRON_CACHE_CODEC_HEADER_SIZE (NATRON_CACHE_CODEC_MAGIC_SIZE + 8 + 4 * 4)
+
+// compressed size, stored flag
+#define NATRON_CACHE_CODEC_BLOCK_INFO_SIZE 8
+
+// Hash table size of the LZ77 coder
+#define NATRON_CACHE_CODEC_HASH_LOG 14
+
+#define NATRON_CACHE_CODEC_MIN_MATCH 4
+
+#define NATRON_CACHE_CODEC_MAX_OFFSET 65535
+
+NATRON_NAMESPACE_ENTER;
+
+namespace CacheStorageCodec {
+namespace {
+typedef boost::uint32_t U32Int;
+typedef boost::uint64_t U64Int;
+
+inline U32Int
+readU32(const unsigned char* p)
+{
+    U32Int v;
+
+    std::memcpy(&v, p, sizeof(v));
+
+    return v;
+}
+
+inline void
+writeU32(unsigned char* p,
+         U32Int v)
+{
+    std::memcpy(p, &v, sizeof(v));
+}
+
+inline U32Int
+hashSequence(U32Int v)
+{
+    return (v * 2654435761U) >> (32 - NATRON_CACHE_CODEC_HASH_LOG);
+}
+
+// Writes the remainder of a length that did not fit in the 4 bits of the token
+inline bool
+writeExtendedLength(std::size_t length,
+                    unsigned char** op,
+                    const unsigned char* opEnd)
+{
+    while (length >= 255) {
+        if (*op >= opEnd) {
+            return false;
+        }
+        *(*op)++ = 255;
+        length -= 255;
+    }
+    if (*op >= opEnd) {
+        return false;
+    }
+    *(*op)++ = (unsigned char)length;
+
+    return true;
+}
+
+inline bool
+readExtendedLength(std::size_t* length,
+                   const unsigned char** ip,
+                   const unsigned char* ipEnd)
+{
+    unsigned char b;
+
+    do {
+        if (*ip >= ipEnd) {
+            return false;
+        }
+        b = *(*ip)++;
+        *length += b;
+    } while (b == 255);
+
+    return true;
+}
+
+/*
+ * Writes a sequence: a token (4 bits of literal length, 4 bits of match length), the literals,
+ * then if matchLength > 0 the offset of the match on 2 bytes.
+ */
+bool
+writeSequence(const unsigned char* literals,
+              std::size_t literalLength,
+              std::size_t matchLength,
+              std::size_t offset,
+              unsigned char** op,
+              const unsigned char* opEnd)
+{
+    if (*op >= opEnd) {
+        return false;
+    }
+    unsigned char* token = (*op)++;
+    std::size_t encodedMatchLength = matchLength > 0 ? matchLength - NATRON_CACHE_CODEC_MIN_MATCH : 0;
+    *token = (unsigned char)( ( (literalLength < 15 ? literalLength : 15) << 4 ) | (encodedMatchLength < 15 ? encodedMatchLength : 15) );
+    if ( (literalLength >= 15) && !writeExtendedLength(literalLength - 15, op, opEnd) ) {
+        return false;
+    }
+    if ( (std::size_t)(opEnd - *op) < literalLength ) {
+        return false;
+    }
+    std::memcpy(*op, literals, literalLength);
+    *op += literalLength;
+    if (matchLength == 0) {
+        return true;
+    }
+    if (opEnd - *op < 2) {
+        return false;
+    }
+    *(*op)++ = (unsigned char)(offset & 0xff);
+    *(*op)++ = (unsigned char)(offset >> 8);
+    if ( (encodedMatchLength >= 15) && !writeExtendedLength(encodedMatchLength - 15, op, opEnd) ) {
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Greedy LZ77 coder. The last sequence of a block only has literals.
+ * Returns the compressed size, or 0 if it is larger than dstCapacity.
+ */
+std::size_t
+lzCompress(const unsigned char* src,
+           std::size_t srcSize,
+           unsigned char* dst,
+           std::size_t dstCapacity)
+{
+    std::vector<U32Int> table(1 << NATRON_CACHE_CODEC_HASH_LOG, 0);
+    const unsigned char* ip = src;
+    const unsigned char* anchor = src;
+    const unsigned char* end = src + srcSize;
+    unsigned char* op = dst;
+    const unsigned char* opEnd = dst + dstCapacity;
+
+    while (ip + NATRON_CACHE_CODEC_MIN_MATCH <= end) {
+        U32Int sequence = readU32(ip);
+        U32Int h = hashSequence(sequence);
+        const unsigned char* ref = src + table[h];
+        table[h] = (U32Int)(ip - src);
+        if ( (ref < ip) && (ip - ref <= NATRON_CACHE_CODEC_MAX_OFFSET) && (readU32(ref) == sequence) ) {
+            const unsigned char* matchEnd = ip + NATRON_CACHE_CODEC_MIN_MATCH;
+            ref += NATRON_CACHE_CODEC_MIN_MATCH;
+            while (matchEnd < end && *matchEnd == *ref) {
+                ++matchEnd;
+                ++ref;
+            }
+            if ( !writeSequence(anchor, ip - anchor, matchEnd - ip, matchEnd - ref, &op, opEnd) ) {
+                return 0;
+            }
+            ip = matchEnd;
+            anchor = ip;
+        } else {
+            ++ip;
+        }
+    }
+    if ( !writeSequence(anchor, end - anchor, 0, 0, &op, opEnd) ) {
+        return 0;
+    }
+
+    return op - dst;
+}
+
+bool
+lzDecompress(const unsigned char* src,
+             std::size_t srcSize,
+             unsigned char* dst,
+             std::size_t dstSize)
+{
+    const unsigned char* ip = src;
+    const unsigned char* ipEnd = src + srcSize;
+    unsigned char* op = dst;
+    unsigned char* opEnd = dst + dstSize;
+
+    for (;;) {
+        if (ip >= ipEnd) {
+            return false;
+        }
+        unsigned char token = *ip++;
+        std::size_t literalLength = token >> 4;
+        if ( (literalLength == 15) && !readExtendedLength(&literalLength, &ip, ipEnd) ) {
+            return false;
+        }
+        if ( ( (std::size_t)(ipEnd - ip) < literalLength ) || ( (std::size_t)(opEnd - op) < literalLength ) ) {
+            return false;
+        }
+        std::memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+        if (op == opEnd) {
+            // last sequence
+            return ip == ipEnd;
+        }
+        if (ipEnd - ip < 2) {
+            return false;
+        }
+        std::size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        std::size_t matchLength = token & 15;
+        if ( (matchLength == 15) && !readExtendedLength(&matchLength, &ip, ipEnd) ) {
+            return false;
+        }
+        matchLength += NATRON_CACHE_CODEC_MIN_MATCH;
+        if ( (offset == 0) || ( (std::size_t)(op - dst) < offset ) || ( (std::size_t)(opEnd - op) < matchLength ) ) {
+            return false;
+        }
+        const unsigned char* ref = op - offset;
+        if (offset >= matchLength) {
+            std::memcpy(op, ref, matchLength);
+            op += matchLength;
+        } else {
+            // overlapping match, e.g: a run of the same byte
+            for (std::size_t i = 0; i < matchLength; ++i) {
+                *op++ = *ref++;
+            }
+        }
+    }
+}
+
+/*
+ * Byte-shuffles then delta-encodes size bytes of elements of elementSize bytes, with nComps elements per pixel.
+ * The trailing bytes that do not make a whole element are copied as is.
+ */
+void
+filterBlock(const unsigned char* src,
+            std::size_t size,
+            int elementSize,
+            int nComps,
+            unsigned char* dst)
+{
+    const std::size_t nElements = size / elementSize;
+
+    for (int k = 0; k < elementSize; ++k) {
+        unsigned char* plane = dst + k * nElements;
+        for (std::size_t i = 0; i < nElements; ++i) {
+            plane[i] = src[i * elementSize + k];
+        }
+        for (std::size_t i = nElements - 1; i >= (std::size_t)nComps && i < nElements; --i) {
+            plane[i] -= plane[i - nComps];
+        }
+    }
+    std::memcpy(dst + nElements * elementSize, src + nElements * elementSize, size - nElements * elementSize);
+}
+
+void
+unfilterBlock(unsigned char* src,
+              std::size_t size,
+              int elementSize,
+              int nComps,
+              unsigned char* dst)
+{
+    const std::size_t nElements = size / elementSize;
+
+    for (int k = 0; k < elementSize; ++k) {
+        unsigned char* plane = src + k * nElements;
+        for (std::size_t i = nComps; i < nElements; ++i) {
+            plane[i] += plane[i - nComps];
+        }
+        for (std::size_t i = 0; i < nElements; ++i) {
+            dst[i * elementSize + k] = plane[i];
+        }
+    }
+    std::memcpy(dst + nElements * elementSize, src + nElements * elementSize, size - nElements * elementSize);
+}
+
+struct BlockCodecArgs
+{
+    const unsigned char* src;
+    std::size_t srcSize;
+    unsigned char* dst;
+    std::size_t dstSize;
+    int elementSize;
+    int nComps;
+    bool stored;
+    bool ok;
+};
+
+void
+compressBlock(BlockCodecArgs& args)
+{
+    std::vector<unsigned char> filtered(args.srcSize);
+
+    filterBlock(args.src, args.srcSize, args.elementSize, args.nComps, &filtered[0]);
+    // dst has room for the raw block: if the compressed block does not fit, it is stored
+    std::size_t compressedSize = lzCompress(&filtered[0], args.srcSize, args.dst, args.srcSize - 1);
+    if (compressedSize == 0) {
+        std::memcpy(args.dst, args.src, args.srcSize);
+        args.dstSize = args.srcSize;
+        args.stored = true;
+    } else {
+        args.dstSize = compressedSize;
+        args.stored = false;
+    }
+    args.ok = true;
+}
+
+void
+decompressBlock(BlockCodecArgs& args)
+{
+    if (args.stored) {
+        args.ok = args.srcSize == args.dstSize;
+        if (args.ok) {
+            std::memcpy(args.dst, args.src, args.dstSize);
+        }
+
+        return;
+    }
+    std::vector<unsigned char> filtered(args.dstSize);
+    args.ok = lzDecompress(args.src, args.srcSize, &filtered[0], args.dstSize);
+    if (args.ok) {
+        unfilterBlock(&filtered[0], args.dstSize, args.elementSize, args.nComps, args.dst);
+    }
+}
+
+bool
+readHeader(const char* compressed,
+           std::size_t compressedSize,
+           U64Int* rawSize,
+           U32Int* blockSize,
+           U32Int* elementSize,
+           U32Int* nComps,
+           U32Int* nBlocks)
+{
+    if ( (compressedSize < NATRON_CACHE_CODEC_HEADER_SIZE) ||
+         (std::memcmp(compressed, NATRON_CACHE_CODEC_MAGIC, NATRON_CACHE_CODEC_MAGIC_SIZE) != 0) ) {
+        return false;
+    }
+    const unsigned char* p = (const unsigned char*)compressed + NATRON_CACHE_CODEC_MAGIC_SIZE;
+    std::memcpy(rawSize, p, sizeof(*rawSize));
+    p += sizeof(*rawSize);
+    *blockSize = readU32(p);
+    *elementSize = readU32(p + 4);
+    *nComps = readU32(p + 8);
+    *nBlocks = readU32(p + 12);
+    if ( (*blockSize == 0) || (*elementSize == 0) || (*nComps == 0) || (*nBlocks != (*rawSize + *blockSize - 1) / *blockSize) ) {
+        return false;
+    }
+
+    // The blocks must fill the rest of the buffer exactly
+    std::size_t tableSize = (std::size_t)*nBlocks * NATRON_CACHE_CODEC_BLOCK_INFO_SIZE;
+    if (compressedSize - NATRON_CACHE_CODEC_HEADER_SIZE < tableSize) {
+        return false;
+    }
+    const unsigned char* table = (const unsigned char*)compressed + NATRON_CACHE_CODEC_HEADER_SIZE;
+    std::size_t total = NATRON_CACHE_CODEC_HEADER_SIZE + tableSize;
+    for (U32Int i = 0; i < *nBlocks; ++i) {
+        total += readU32(table + i * NATRON_CACHE_CODEC_BLOCK_INFO_SIZE);
+    }
+
+    return total == compressedSize;
+}
+} // anon namespace
+
+unsigned short
+floatToHalf(float f)
+{
+    U32Int x;
+
+    std::memcpy(&x, &f, sizeof(x));
+
+    U32Int sign = (x >> 16) & 0x8000;
+    U32Int absx = x & 0x7fffffff;
+
+    if (absx >= 0x7f800000) {
+        // inf or NaN, keep NaNs quiet
+        return (unsigned short)( sign | 0x7c00 | ( absx > 0x7f800000 ? ( 0x200 | ( (absx >> 13) & 0x3ff ) ) : 0 ) );
+    }
+    if (absx >= 0x47800000) {
+        // overflow
+        return (unsigned short)(sign | 0x7c00);
+    }
+    if (absx < 0x38800000) {
+        // smaller than the smallest normalized half: 2^-14
+        if (absx < 0x33000000) {
+            // smaller than half of the smallest denormalized half: 2^-25
+            return (unsigned short)sign;
+        }
+        U32Int mantissa = (absx & 0x7fffff) | 0x800000;
+        U32Int shift = 126 - (absx >> 23);
+        U32Int h = mantissa >> shift;
+        U32Int remainder = mantissa & ( (1U << shift) - 1 );
+        U32Int halfway = 1U << (shift - 1);
+        if ( (remainder > halfway) || ( (remainder == halfway) && (h & 1) ) ) {
+            ++h;
+        }
+
+        return (unsigned short)(sign | h);
+    }
+
+    // rebias the exponent from 127 to 15, rounding may overflow to inf which is the correct result
+    U32Int h = (absx - 0x38000000) >> 13;
+    U32Int remainder = absx & 0x1fff;
+    if ( (remainder > 0x1000) || ( (remainder == 0x1000) && (h & 1) ) ) {
+        ++h;
+    }
+
+    return (unsigned short)(sign | h);
+} // floatToHalf
+
+float
+halfToFloat(unsigned short h)
+{
+    U32Int sign = (U32Int)(h & 0x8000) << 16;
+    U32Int exponent = (h >> 10) & 0x1f;
+    U32Int mantissa = h & 0x3ff;
+    U32Int x;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            x = sign;
+        } else {
+            // denormalized half: mantissa * 2^-24 is a normalized float
+            float f = mantissa * (1.f / 16777216.f);
+
+            return sign ? -f : f;
+        }
+    } else if (exponent == 31) {
+        x = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        x = sign | ( (exponent + 112) << 23 ) | (mantissa << 13);
+    }
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+
+    return f;
+}
+
+void
+floatToHalfRow(const float* from,
+               unsigned short* to,
+               std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        to[i] = floatToHalf(from[i]);
+    }
+}
+
+void
+halfToFloatRow(const unsigned short* from,
+               float* to,
+               std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        to[i] = halfToFloat(from[i]);
+    }
+}
+
+bool
+compressBuffer(const char* data,
+               std::size_t size,
+               int elementSize,
+               int nComps,
+               std::vector<char>* compressed)
+{
+    assert(elementSize > 0 && nComps > 0);
+    compressed->clear();
+
+    const std::size_t blockSize = (NATRON_CACHE_CODEC_BLOCK_SIZE / (elementSize * nComps)) * (elementSize * nComps);
+    const std::size_t nBlocks = (size + blockSize - 1) / blockSize;
+    if ( (nBlocks == 0) || (blockSize == 0) ) {
+        return false;
+    }
+
+    // Compress each block to its own portion of a buffer as large as the data, then pack them
+    std::vector<unsigned char> blocksData(size);
+    std::vector<BlockCodecArgs> blocks(nBlocks);
+    for (std::size_t i = 0; i < nBlocks; ++i) {
+        BlockCodecArgs& args = blocks[i];
+        args.src = (const unsigned char*)data + i * blockSize;
+        args.srcSize = std::min(blockSize, size - i * blockSize);
+        args.dst = &blocksData[0] + i * blockSize;
+        args.dstSize = 0;
+        args.elementSize = elementSize;
+        args.nComps = nComps;
+        args.stored = false;
+        args.ok = false;
+    }
+    QtConcurrent::blockingMap( blocks, boost::bind(&compressBlock, _1) );
+
+    std::size_t compressedSize = NATRON_CACHE_CODEC_HEADER_SIZE + nBlocks * NATRON_CACHE_CODEC_BLOCK_INFO_SIZE;
+    for (std::size_t i = 0; i < nBlocks; ++i) {
+        compressedSize += blocks[i].dstSize;
+    }
+    if (compressedSize >= size) {
+        return false;
+    }
+
+    compressed->resize(compressedSize);
+    unsigned char* p = (unsigned char*)&(*compressed)[0];
+    std::memcpy(p, NATRON_CACHE_CODEC_MAGIC, NATRON_CACHE_CODEC_MAGIC_SIZE);
+    p += NATRON_CACHE_CODEC_MAGIC_SIZE;
+    U64Int rawSize = size;
+    std::memcpy(p, &rawSize, sizeof(rawSize));
+    p += sizeof(rawSize);
+    writeU32(p, (U32Int)blockSize);
+    writeU32(p + 4, (U32Int)elementSize);
+    writeU32(p + 8, (U32Int)nComps);
+    writeU32(p + 12, (U32Int)nBlocks);
+    p += 16;
+    for (std::size_t i = 0; i < nBlocks; ++i, p += NATRON_CACHE_CODEC_BLOCK_INFO_SIZE) {
+        writeU32(p, (U32Int)blocks[i].dstSize);
+        writeU32(p + 4, blocks[i].stored ? 1 : 0);
+    }
+    for (std::size_t i = 0; i < nBlocks; ++i) {
+        std::memcpy(p, blocks[i].dst, blocks[i].dstSize);
+        p += blocks[i].dstSize;
+    }
+
+    return true;
+} // compressBuffer
+
+std::size_t
+getDecompressedSize(const char* compressed,
+                    std::size_t compressedSize)
+{
+    U64Int rawSize;
+    U32Int blockSize, elementSize, nComps, nBlocks;
+
+    if ( !readHeader(compressed, compressedSize, &rawSize, &blockSize, &elementSize, &nComps, &nBlocks) ) {
+        return 0;
+    }
+
+    return (std::size_t)rawSize;
+}
+
+bool
+decompressBuffer(const char* compressed,
+                 std::size_t compressedSize,
+                 char* data,
+                 std::size_t size)
+{
+    U64Int rawSize;
+    U32Int blockSize, elementSize, nComps, nBlocks;
+
+    if ( !readHeader(compressed, compressedSize, &rawSize, &blockSize, &elementSize, &nComps, &nBlocks) || (rawSize != size) ) {
+        return false;
+    }
+
+    const unsigned char* table = (const unsigned char*)compressed + NATRON_CACHE_CODEC_HEADER_SIZE;
+    const unsigned char* src = table + (std::size_t)nBlocks * NATRON_CACHE_CODEC_BLOCK_INFO_SIZE;
+    std::vector<BlockCodecArgs> blocks(nBlocks);
+    for (U32Int i = 0; i < nBlocks; ++i) {
+        BlockCodecArgs& args = blocks[i];
+        args.src = src;
+        args.srcSize = readU32(table + i * NATRON_CACHE_CODEC_BLOCK_INFO_SIZE);
+        args.stored = readU32(table + i * NATRON_CACHE_CODEC_BLOCK_INFO_SIZE + 4) != 0;
+        args.dst = (unsigned char*)data + (std::size_t)i * blockSize;
+        args.dstSize = std::min( (std::size_t)blockSize, size - (std::size_t)i * blockSize );
+        args.elementSize = (int)elementSize;
+        args.nComps = (int)nComps;
+        args.ok = false;
+        src += args.srcSize;
+    }
+    QtConcurrent::blockingMap( blocks, boost::bind(&decompressBlock, _1) );
+
+    for (U32Int i = 0; i < nBlocks; ++i) {
+        if (!blocks[i].ok) {
+            return false;
+        }
+    }
+
+    return true;
+}
+} // namespace CacheStorageCodec
+
+NATRON_NAMESPACE_EXIT;
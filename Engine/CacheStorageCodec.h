@@ -0,0 +1,79 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_CACHESTORAGECODEC_H
+#define NATRON_ENGINE_CACHESTORAGECODEC_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * Codecs used to reduce the storage of the cache entries.
+ *
+ * - Half-float: 32-bit floats are rounded to the nearest 16-bit float (round half to even). This is lossy and only
+ *   used for entries that are only displayed, i.e. the float textures of the viewer cache.
+ *
+ * - Lossless block compression: the buffer is cut in blocks of NATRON_CACHE_CODEC_BLOCK_SIZE bytes which are
+ *   compressed independently, so that they can be compressed and decompressed in parallel.
+ *   Each block is byte-shuffled (byte k of every element is stored in plane k), delta-encoded against the
+ *   same channel of the previous pixel and compressed with a LZ77 coder. Blocks that do not compress are stored as is.
+ *   The compressed buffer starts with a header (magic number, sizes and table of the blocks) so that it can be
+ *   recognized when a cache file is re-opened.
+ */
+#define NATRON_CACHE_CODEC_BLOCK_SIZE (256 * 1024)
+
+NATRON_NAMESPACE_ENTER;
+
+namespace CacheStorageCodec {
+unsigned short floatToHalf(float f);
+float halfToFloat(unsigned short h);
+
+void floatToHalfRow(const float* from, unsigned short* to, std::size_t n);
+void halfToFloatRow(const unsigned short* from, float* to, std::size_t n);
+
+/**
+ * @brief Compresses size bytes of data made of pixels of nComps elements of elementSize bytes each.
+ * @returns False if the compressed buffer would not be smaller than the data, in which case compressed is left empty.
+ **/
+bool compressBuffer(const char* data, std::size_t size, int elementSize, int nComps, std::vector<char>* compressed);
+
+/**
+ * @brief Returns the size of the data encoded in a buffer produced by compressBuffer(), or 0 if the given buffer
+ * is not a valid compressed buffer.
+ **/
+std::size_t getDecompressedSize(const char* compressed, std::size_t compressedSize);
+
+/**
+ * @brief Decodes a buffer produced by compressBuffer() to data, which must be getDecompressedSize() bytes large.
+ * The blocks are decompressed in parallel.
+ * @returns False if the compressed buffer is corrupted.
+ **/
+bool decompressBuffer(const char* compressed, std::size_t compressedSize, char* data, std::size_t size);
+} // namespace CacheStorageCodec
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_CACHESTORAGECODEC_H
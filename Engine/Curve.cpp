@@ -198,6 +198,45 @@ KeyFrame::getRightDerivative() const
     return _rightDerivative;
 }
 
+/************************************KEYFRAMESSNAPSHOT************************************/
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Compares the keyframes with a time directly, the range bounds may be infinite
+struct KeyFrameTimeLess
+{
+    bool operator() (const KeyFrame & key,
+                     double time) const
+    {
+        return key.getTime() < time;
+    }
+
+    bool operator() (double time,
+                     const KeyFrame & key) const
+    {
+        return time < key.getTime();
+    }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+KeyFramesSnapshot::KeyFramesSnapshot(U64 version,
+                                     const KeyFrameSet& keys)
+    : _version(version)
+    , _keys( keys.begin(), keys.end() )
+{
+}
+
+void
+KeyFramesSnapshot::getKeyFramesInRange(double from,
+                                       double to,
+                                       const_iterator* first,
+                                       const_iterator* last) const
+{
+    *first = std::lower_bound( _keys.begin(), _keys.end(), from, KeyFrameTimeLess() );
+    *last = std::upper_bound( *first, _keys.end(), to, KeyFrameTimeLess() );
+}
+
 /************************************CURVEPATH************************************/
 
 Curve::Curve()
@@ -273,6 +312,7 @@ Curve::setPeriodic(bool periodic)
     QMutexLocker k(&_imp->_lock);
     _imp->isPeriodic = periodic;
     _imp->keyFrames.clear();
+    _imp->onKeyFramesChanged();
 }
 
 bool
@@ -293,6 +333,7 @@ Curve::clearKeyFrames()
     QMutexLocker l(&_imp->_lock);
 
     _imp->keyFrames.clear();
+    _imp->onKeyFramesChanged();
 }
 
 bool
@@ -411,6 +452,7 @@ Curve::addKeyFrame(KeyFrame key)
 std::pair<KeyFrameSet::iterator, bool> Curve::addKeyFrameNoUpdate(const KeyFrame & cp)
 {
     // PRIVATE - should not lock
+    _imp->onKeyFramesChanged();
     if (!_imp->isParametric) { //< if keyframes are clamped to integers
         std::pair<KeyFrameSet::iterator, bool> newKey = _imp->keyFrames.insert(cp);
         // keyframe at this time exists, erase and insert again
@@ -1240,6 +1282,26 @@ Curve::getKeyFrames_mt_safe() const
     return _imp->keyFrames;
 }
 
+KeyFramesSnapshotPtr
+Curve::getKeyFramesSnapshot() const
+{
+    QMutexLocker l(&_imp->_lock);
+
+    if (!_imp->keyFramesSnapshot) {
+        _imp->keyFramesSnapshot.reset( new KeyFramesSnapshot(_imp->keyFramesVersion, _imp->keyFrames) );
+    }
+
+    return _imp->keyFramesSnapshot;
+}
+
+U64
+Curve::getKeyFramesVersion() const
+{
+    QMutexLocker l(&_imp->_lock);
+
+    return _imp->keyFramesVersion;
+}
+
 KeyFrameSet::iterator
 Curve::setKeyFrameValueAndTimeNoUpdate(double value,
                                        double time,
@@ -1252,6 +1314,7 @@ Curve::setKeyFrameValueAndTimeNoUpdate(double value,
     newKey.setTime(time);
     newKey.setValue(value);
     _imp->keyFrames.erase(k);
+    _imp->onKeyFramesChanged();
 
     return addKeyFrameNoUpdate(newKey).first;
 }
@@ -1612,6 +1675,7 @@ Curve::refreshDerivatives(Curve::CurveChangedReasonEnum reason,
     newKey.setLeftDerivative(vcurDerivLeft);
     newKey.setRightDerivative(vcurDerivRight);
 
+    _imp->onKeyFramesChanged();
     std::pair<KeyFrameSet::iterator, bool> newKeyIt = _imp->keyFrames.insert(newKey);
 
     // keyframe at this time exists, erase and insert again
@@ -1796,6 +1860,7 @@ Curve::onCurveChanged()
     if (owner) {
         owner->clearExpressionsResults(_imp->dimensionInOwner);
     }
+    _imp->onKeyFramesChanged();
 #ifdef NATRON_CURVE_USE_CACHE
     _imp->resultCache.clear();
 #endif
@@ -1810,6 +1875,7 @@ Curve::fromSerialization(const SERIALIZATION_NAMESPACE::SerializationObjectBase&
     }
     QMutexLocker l(&_imp->_lock);
     _imp->keyFrames.clear();
+    _imp->onKeyFramesChanged();
     for (std::list<SERIALIZATION_NAMESPACE::KeyFrameSerialization>::const_iterator it = s->keys.begin(); it != s->keys.end(); ++it) {
         KeyFrame k;
         k.setTime(it->time);
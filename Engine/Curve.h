@@ -128,6 +128,58 @@ struct KeyFrame_compare_time
 
 typedef std::set<KeyFrame, KeyFrame_compare_time> KeyFrameSet;
 
+/**
+ * @brief An immutable copy of the keyframes of a curve at a given version, stored contiguously and sorted by time.
+ * It is shared by all the readers until the curve changes, so that drawing code does not copy the keyframes
+ * at each redraw. Two snapshots of the same curve with the same version hold the same keyframes.
+ **/
+class KeyFramesSnapshot
+{
+public:
+
+    typedef std::vector<KeyFrame>::const_iterator const_iterator;
+
+    KeyFramesSnapshot(U64 version,
+                      const KeyFrameSet& keys);
+
+    U64 getVersion() const
+    {
+        return _version;
+    }
+
+    const std::vector<KeyFrame>& getKeyFrames() const
+    {
+        return _keys;
+    }
+
+    bool empty() const
+    {
+        return _keys.empty();
+    }
+
+    const_iterator begin() const
+    {
+        return _keys.begin();
+    }
+
+    const_iterator end() const
+    {
+        return _keys.end();
+    }
+
+    /**
+     * @brief Returns in [*first,*last[ the keyframes whose time is in [from,to], in O(log(n))
+     **/
+    void getKeyFramesInRange(double from, double to, const_iterator* first, const_iterator* last) const;
+
+private:
+
+    U64 _version;
+    std::vector<KeyFrame> _keys;
+};
+
+typedef boost::shared_ptr<const KeyFramesSnapshot> KeyFramesSnapshotPtr;
+
 
 struct CurvePrivate;
 
@@ -266,6 +318,17 @@ public:
 
     KeyFrameSet getKeyFrames_mt_safe() const WARN_UNUSED_RETURN;
 
+    /**
+     * @brief Returns a snapshot of the keyframes, which is only rebuilt after the curve changed:
+     * until then all callers share the same snapshot.
+     **/
+    KeyFramesSnapshotPtr getKeyFramesSnapshot() const WARN_UNUSED_RETURN;
+
+    /**
+     * @brief Returns a number which is incremented each time the keyframes of the curve change
+     **/
+    U64 getKeyFramesVersion() const WARN_UNUSED_RETURN;
+
     void clearKeyFrames();
 
     /**
@@ -27,6 +27,8 @@
 
 #include "Global/Macros.h"
 
+#include <algorithm>
+
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
 #endif
@@ -57,6 +59,12 @@ struct CurvePrivate
 
     KeyFrameSet keyFrames;
 
+    // Incremented each time keyFrames changes
+    U64 keyFramesVersion;
+
+    // Built lazily by getKeyFramesSnapshot() and reset when keyFrames changes
+    mutable KeyFramesSnapshotPtr keyFramesSnapshot;
+
 #ifdef NATRON_CURVE_USE_CACHE
     std::map<double, double> resultCache; //< a cache for interpolations
 #endif
@@ -72,6 +80,8 @@ struct CurvePrivate
 
     CurvePrivate()
         : keyFrames()
+        , keyFramesVersion(0)
+        , keyFramesSnapshot()
 #ifdef NATRON_CURVE_USE_CACHE
         , resultCache()
 #endif
@@ -89,7 +99,8 @@ struct CurvePrivate
     }
 
     CurvePrivate(const CurvePrivate & other)
-        : _lock(QMutex::Recursive)
+        : keyFramesVersion(0)
+        , _lock(QMutex::Recursive)
     {
         *this = other;
     }
@@ -97,6 +108,9 @@ struct CurvePrivate
     void operator=(const CurvePrivate & other)
     {
         keyFrames = other.keyFrames;
+        // Never go back to a version this curve already had
+        keyFramesVersion = std::max(keyFramesVersion, other.keyFramesVersion) + 1;
+        keyFramesSnapshot.reset();
         owner = other.owner;
         dimensionInOwner = other.dimensionInOwner;
         isParametric = other.isParametric;
@@ -108,7 +122,12 @@ struct CurvePrivate
         isPeriodic = other.isPeriodic;
     }
 
-    
+    // PRIVATE - should be called with _lock held whenever keyFrames is modified
+    void onKeyFramesChanged()
+    {
+        ++keyFramesVersion;
+        keyFramesSnapshot.reset();
+    }
 };
 
 NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,446 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "DirectoryScanner.h"
+
+#include <algorithm> // sort, lower_bound
+#include <map>
+#include <utility>
+
+#ifdef __NATRON_WIN32__
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#include <QtCore/QDateTime>
+#include <QtCore/QMutex>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/unordered_map.hpp>
+#endif
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+char
+toLowerAscii(char c)
+{
+    return ( (c >= 'A') && (c <= 'Z') ) ? (char)(c - 'A' + 'a') : c;
+}
+
+// Compares the first n characters of a and b case-insensitively, n being at most the length of both strings
+int
+compareCaseInsensitive(const std::string& a,
+                       const std::string& b,
+                       std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        char ca = toLowerAscii(a[i]);
+        char cb = toLowerAscii(b[i]);
+        if (ca != cb) {
+            return (unsigned char)ca < (unsigned char)cb ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+// Sorts by name case-insensitively, as QDir::IgnoreCase does, names differing only by their case being sorted case-sensitively
+struct EntryNameLess
+{
+    bool operator() (const DirectoryContent::Entry& a,
+                     const DirectoryContent::Entry& b) const
+    {
+        int c = compareCaseInsensitive( a.name, b.name, std::min( a.name.size(), b.name.size() ) );
+
+        if (c != 0) {
+            return c < 0;
+        }
+        if ( a.name.size() != b.name.size() ) {
+            return a.name.size() < b.name.size();
+        }
+
+        return a.name < b.name;
+    }
+};
+
+// True if the name of the entry is before the given prefix, case-insensitively
+struct EntryBeforePrefix
+{
+    bool operator() (const DirectoryContent::Entry& entry,
+                     const std::string& prefix) const
+    {
+        std::size_t n = std::min( entry.name.size(), prefix.size() );
+        int c = compareCaseInsensitive(entry.name, prefix, n);
+
+        return (c < 0) || ( (c == 0) && (entry.name.size() < prefix.size()) );
+    }
+};
+
+// Removes the trailing separators, so that "/a/b/" and "/a/b" are the same directory, but not those of "/" nor "C:/"
+std::string
+normalizeDirectoryPath(const std::string& path)
+{
+    if ( path.empty() ) {
+        return std::string(".");
+    }
+    std::string ret = path;
+    while ( (ret.size() > 1) && ( (ret[ret.size() - 1] == '/') || (ret[ret.size() - 1] == '\\') ) && (ret[ret.size() - 2] != ':') ) {
+        ret.erase(ret.size() - 1);
+    }
+
+    return ret;
+}
+
+bool
+getDirectoryModificationTime(const std::string& path,
+                             U64* time)
+{
+#ifdef __NATRON_WIN32__
+    QFileInfo info( QString::fromUtf8( path.c_str() ) );
+    if ( !info.isDir() ) {
+        return false;
+    }
+    *time = (U64)info.lastModified().toMSecsSinceEpoch() * 1000000;
+#else
+    struct stat st;
+    if ( (stat(path.c_str(), &st) != 0) || !S_ISDIR(st.st_mode) ) {
+        return false;
+    }
+#ifdef __NATRON_OSX__
+    *time = (U64)st.st_mtimespec.tv_sec * 1000000000 + (U64)st.st_mtimespec.tv_nsec;
+#else
+    *time = (U64)st.st_mtim.tv_sec * 1000000000 + (U64)st.st_mtim.tv_nsec;
+#endif
+#endif
+
+    return true;
+}
+
+bool
+readDirectoryEntries(const std::string& path,
+                     std::vector<DirectoryContent::Entry>* entries)
+{
+#ifdef __NATRON_WIN32__
+    // On Windows, QDir gets the attributes of the entries along with their names
+    QDir dir( QString::fromUtf8( path.c_str() ) );
+    if ( !dir.exists() ) {
+        return false;
+    }
+    QFileInfoList infos = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden, QDir::NoSort);
+    entries->reserve( infos.size() );
+    for (QFileInfoList::const_iterator it = infos.begin(); it != infos.end(); ++it) {
+        DirectoryContent::Entry entry;
+        entry.name = it->fileName().toStdString();
+        entry.isDir = it->isDir();
+        entry.isHidden = it->isHidden();
+        entries->push_back(entry);
+    }
+#else
+    DIR* dir = opendir( path.c_str() );
+    if (!dir) {
+        return false;
+    }
+    std::string childPrefix = path;
+    if (childPrefix[childPrefix.size() - 1] != '/') {
+        childPrefix.push_back('/');
+    }
+    while (struct dirent* ent = readdir(dir)) {
+        const char* name = ent->d_name;
+        if ( (name[0] == '.') && ( (name[1] == 0) || ( (name[1] == '.') && (name[2] == 0) ) ) ) {
+            continue;
+        }
+        DirectoryContent::Entry entry;
+        entry.name = name;
+        entry.isHidden = name[0] == '.';
+        switch (ent->d_type) {
+        case DT_DIR:
+            entry.isDir = true;
+            break;
+        case DT_REG:
+            entry.isDir = false;
+            break;
+        default: {
+            // Symbolic links are followed, as QDir does, and the file systems which do not give the type are asked for it.
+            // Broken links and other special files are skipped, as QDir does without QDir::System.
+            struct stat st;
+            if ( stat( (childPrefix + entry.name).c_str(), &st ) != 0 ) {
+                continue;
+            }
+            if ( S_ISDIR(st.st_mode) ) {
+                entry.isDir = true;
+            } else if ( S_ISREG(st.st_mode) ) {
+                entry.isDir = false;
+            } else {
+                continue;
+            }
+            break;
+        }
+        }
+        entries->push_back(entry);
+    }
+    closedir(dir);
+#endif // ifdef __NATRON_WIN32__
+
+    return true;
+} // readDirectoryEntries
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+struct DirectoryContentPrivate
+{
+    std::string path;
+    U64 modificationTime;
+    U64 scanTime;
+    std::vector<DirectoryContent::Entry> entries;
+    std::vector<std::vector<std::size_t> > fileGroups;
+
+    DirectoryContentPrivate(const std::string& path,
+                            U64 modificationTime,
+                            U64 scanTime)
+        : path(path)
+        , modificationTime(modificationTime)
+        , scanTime(scanTime)
+        , entries()
+        , fileGroups()
+    {
+    }
+
+    void groupFiles()
+    {
+        // One pass over the files: each file goes to the group of its signature
+        typedef boost::unordered_map<std::string, std::size_t> GroupsMap;
+        GroupsMap groupIndexes;
+
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].isDir) {
+                continue;
+            }
+            std::pair<GroupsMap::iterator, bool> ret = groupIndexes.insert( std::make_pair(DirectoryScanner::getFilePatternSignature(entries[i].name), fileGroups.size()) );
+            if (ret.second) {
+                fileGroups.push_back( std::vector<std::size_t>() );
+            }
+            fileGroups[ret.first->second].push_back(i);
+        }
+    }
+};
+
+DirectoryContent::DirectoryContent(const std::string& path,
+                                   U64 modificationTime,
+                                   U64 scanTime,
+                                   std::vector<Entry>* entries)
+    : _imp( new DirectoryContentPrivate(path, modificationTime, scanTime) )
+{
+    _imp->entries.swap(*entries);
+    std::sort( _imp->entries.begin(), _imp->entries.end(), EntryNameLess() );
+    _imp->groupFiles();
+}
+
+DirectoryContent::~DirectoryContent()
+{
+}
+
+const std::string&
+DirectoryContent::getPath() const
+{
+    return _imp->path;
+}
+
+U64
+DirectoryContent::getModificationTime() const
+{
+    return _imp->modificationTime;
+}
+
+U64
+DirectoryContent::getScanTime() const
+{
+    return _imp->scanTime;
+}
+
+const std::vector<DirectoryContent::Entry>&
+DirectoryContent::getEntries() const
+{
+    return _imp->entries;
+}
+
+const std::vector<std::vector<std::size_t> >&
+DirectoryContent::getFileGroups() const
+{
+    return _imp->fileGroups;
+}
+
+void
+DirectoryContent::getFilesStartingWith(const std::string& prefix,
+                                       std::vector<std::string>* files) const
+{
+    std::vector<Entry>::const_iterator it = std::lower_bound( _imp->entries.begin(), _imp->entries.end(), prefix, EntryBeforePrefix() );
+
+    for (; it != _imp->entries.end(); ++it) {
+        if ( (it->name.size() < prefix.size()) || (compareCaseInsensitive( it->name, prefix, prefix.size() ) != 0) ) {
+            break;
+        }
+        if (!it->isDir && !it->isHidden) {
+            files->push_back(it->name);
+        }
+    }
+}
+
+struct DirectoryScannerPrivate
+{
+    struct CachedContent
+    {
+        DirectoryContentPtr content;
+        U64 lastUse;
+    };
+
+    typedef std::map<std::string, CachedContent> ContentsMap;
+
+    QMutex lock;
+    ContentsMap contents;
+
+    // Incremented each time a directory is requested, to find the least recently used one
+    U64 useCounter;
+
+    DirectoryScannerPrivate()
+        : lock()
+        , contents()
+        , useCounter(0)
+    {
+    }
+};
+
+DirectoryScanner::DirectoryScanner()
+    : _imp( new DirectoryScannerPrivate() )
+{
+}
+
+DirectoryScanner::~DirectoryScanner()
+{
+}
+
+DirectoryContentPtr
+DirectoryScanner::getDirectoryContent(const std::string& path)
+{
+    std::string dirPath = normalizeDirectoryPath(path);
+    U64 modificationTime;
+
+    if ( !getDirectoryModificationTime(dirPath, &modificationTime) ) {
+        return DirectoryContentPtr();
+    }
+
+    {
+        QMutexLocker k(&_imp->lock);
+        DirectoryScannerPrivate::ContentsMap::iterator found = _imp->contents.find(dirPath);
+        if ( found != _imp->contents.end() ) {
+            const DirectoryContentPtr& content = found->second.content;
+            // The listing is valid if the directory was not modified since, and if it was not listed right after a modification
+            if ( ( content->getModificationTime() == modificationTime ) &&
+                 ( content->getScanTime() >= modificationTime / 1000000 + NATRON_DIRECTORY_SCANNER_RACY_DELAY_MS ) ) {
+                found->second.lastUse = ++_imp->useCounter;
+
+                return content;
+            }
+        }
+    }
+
+    // The directory is listed without holding the lock, so that listing a large directory does not block the other ones
+    DirectoryContentPtr content = scanDirectory(dirPath);
+    if (!content) {
+        return content;
+    }
+
+    QMutexLocker k(&_imp->lock);
+    DirectoryScannerPrivate::CachedContent& cached = _imp->contents[dirPath];
+    cached.content = content;
+    cached.lastUse = ++_imp->useCounter;
+    if ( (int)_imp->contents.size() > NATRON_DIRECTORY_SCANNER_MAX_CACHED_DIRECTORIES ) {
+        DirectoryScannerPrivate::ContentsMap::iterator leastRecentlyUsed = _imp->contents.begin();
+        for (DirectoryScannerPrivate::ContentsMap::iterator it = _imp->contents.begin(); it != _imp->contents.end(); ++it) {
+            if (it->second.lastUse < leastRecentlyUsed->second.lastUse) {
+                leastRecentlyUsed = it;
+            }
+        }
+        _imp->contents.erase(leastRecentlyUsed);
+    }
+
+    return content;
+}
+
+void
+DirectoryScanner::clear()
+{
+    QMutexLocker k(&_imp->lock);
+
+    _imp->contents.clear();
+}
+
+DirectoryContentPtr
+DirectoryScanner::scanDirectory(const std::string& path)
+{
+    std::string dirPath = normalizeDirectoryPath(path);
+    U64 modificationTime;
+
+    // The modification time is read before the entries, so that a modification made while listing invalidates the listing
+    if ( !getDirectoryModificationTime(dirPath, &modificationTime) ) {
+        return DirectoryContentPtr();
+    }
+    U64 scanTime = (U64)QDateTime::currentMSecsSinceEpoch();
+    std::vector<DirectoryContent::Entry> entries;
+    if ( !readDirectoryEntries(dirPath, &entries) ) {
+        return DirectoryContentPtr();
+    }
+
+    return DirectoryContentPtr( new DirectoryContent(dirPath, modificationTime, scanTime, &entries) );
+}
+
+std::string
+DirectoryScanner::getFilePatternSignature(const std::string& filename)
+{
+    std::string ret;
+
+    ret.reserve( filename.size() );
+    bool inDigits = false;
+    for (std::size_t i = 0; i < filename.size(); ++i) {
+        char c = filename[i];
+        if ( (c >= '0') && (c <= '9') ) {
+            if (!inDigits) {
+                ret.push_back('/');
+                inDigits = true;
+            }
+        } else {
+            ret.push_back(c);
+            inDigits = false;
+        }
+    }
+
+    return ret;
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,162 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_DIRECTORYSCANNER_H
+#define NATRON_ENGINE_DIRECTORYSCANNER_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <string>
+#include <vector>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#endif
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+// Number of directories whose content is kept by a DirectoryScanner
+#define NATRON_DIRECTORY_SCANNER_MAX_CACHED_DIRECTORIES 32
+
+// A directory listed less than this many milliseconds after it was last modified is listed again on the next request:
+// its modification time may not change if it is modified again within the resolution of the file system timestamps.
+#define NATRON_DIRECTORY_SCANNER_RACY_DELAY_MS 2000
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief The names of the entries of a directory, as listed by DirectoryScanner.
+ * The entries are sorted by name, case-insensitively. A DirectoryContent never changes once created:
+ * it can be read from several threads without locking.
+ **/
+struct DirectoryContentPrivate;
+class DirectoryContent
+{
+public:
+
+    struct Entry
+    {
+        std::string name;
+        bool isDir;
+
+        // Names starting with a dot on Unix, entries with the hidden attribute on Windows
+        bool isHidden;
+    };
+
+    /**
+     * @brief Sorts the entries and groups the files by pattern. The entries are taken from the vector.
+     **/
+    DirectoryContent(const std::string& path,
+                     U64 modificationTime,
+                     U64 scanTime,
+                     std::vector<Entry>* entries);
+
+    ~DirectoryContent();
+
+    const std::string& getPath() const;
+
+    /**
+     * @brief The modification time of the directory when it was listed, in nanoseconds
+     **/
+    U64 getModificationTime() const;
+
+    /**
+     * @brief When the directory was listed, in milliseconds since the epoch
+     **/
+    U64 getScanTime() const;
+
+    const std::vector<Entry>& getEntries() const;
+
+    /**
+     * @brief The files of the directory, as indexes in getEntries(), grouped by the pattern of their name
+     * (see DirectoryScanner::getFilePatternSignature()): the files of a sequence are all in the same group,
+     * so a file only needs to be compared with the files of its own group to find its sequence.
+     * The groups are in the order of their first file, and the files of a group are sorted by name.
+     **/
+    const std::vector<std::vector<std::size_t> >& getFileGroups() const;
+
+    /**
+     * @brief Appends to files the names of the files which are not hidden and start with prefix, case-insensitively.
+     * This is a binary search in the sorted entries.
+     **/
+    void getFilesStartingWith(const std::string& prefix, std::vector<std::string>* files) const;
+
+private:
+
+    boost::scoped_ptr<DirectoryContentPrivate> _imp;
+};
+
+typedef boost::shared_ptr<const DirectoryContent> DirectoryContentPtr;
+
+/**
+ * @brief Lists the content of directories without reading the attributes of their entries, unlike QDir::entryInfoList()
+ * which reads those of every file: on Unix the directory is read with readdir() and only symbolic links are resolved.
+ * The content of the last listed directories is kept and reused until their modification time changes,
+ * so that the file dialog and the readers looking for the frame range of a sequence share the same listing
+ * of directories holding hundreds of thousands of frames.
+ * This class is MT-safe.
+ **/
+struct DirectoryScannerPrivate;
+class DirectoryScanner
+{
+public:
+
+    DirectoryScanner();
+
+    ~DirectoryScanner();
+
+    /**
+     * @brief Returns the content of the directory, listing it only if it was modified since it was last listed.
+     * Returns NULL if the directory cannot be read.
+     **/
+    DirectoryContentPtr getDirectoryContent(const std::string& path);
+
+    /**
+     * @brief Forgets the content of all directories
+     **/
+    void clear();
+
+    /**
+     * @brief Lists the directory, without using any cache. Returns NULL if the directory cannot be read.
+     **/
+    static DirectoryContentPtr scanDirectory(const std::string& path);
+
+    /**
+     * @brief Returns the name with each run of digits replaced by a single '/', which cannot be part of a file name:
+     * e.g. "plate_v2.0001.exr" and "plate_v2.1234.exr" both give "plate_v/./.exr".
+     * Two files of the same sequence differ only by their frame number, hence have the same signature.
+     **/
+    static std::string getFilePatternSignature(const std::string& filename);
+
+private:
+
+    boost::scoped_ptr<DirectoryScannerPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_DIRECTORYSCANNER_H
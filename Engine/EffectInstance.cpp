@@ -63,6 +63,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/KnobFile.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/Log.h"
+#include "Engine/MetricsServer.h"
 #include "Engine/Node.h"
 #include "Engine/OfxEffectInstance.h"
 #include "Engine/OfxEffectInstance.h"
@@ -73,6 +74,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/OutputSchedulerThread.h"
 #include "Engine/PluginMemory.h"
 #include "Engine/Project.h"
+#include "Engine/RenderPriorityScheduler.h"
 #include "Engine/RenderStats.h"
 #include "Engine/RotoContext.h"
 #include "Engine/RotoDrawableItem.h"
@@ -239,8 +241,10 @@ EffectInstance::setParallelRenderArgsTLS(const SetParallelRenderTLSArgsPtr& inAr
     args->currentOpenglSupport = inArgs->currentOpenGLSupport;
     args->doNansHandling = inArgs->isAnalysis ? false : inArgs->doNanHandling;
     args->draftMode = inArgs->draftMode;
+    args->viewsRenderedConcurrently = inArgs->viewsRenderedConcurrently;
     args->tilesSupported = getNode()->getCurrentSupportTiles();
     args->stats = inArgs->stats;
+    args->knobValues = inArgs->knobValues;
     args->openGLContext = inArgs->glContext;
     args->cpuOpenGLContext = inArgs->cpuGlContext;
     argsList.push_back(args);
@@ -696,6 +700,7 @@ EffectInstance::getImage(int inputNb,
 
         // Keep it out of scope otherwise it will get destroyed as nobody holds a shared ref to it except here
         renderInfo = AbortableRenderInfo::create(false, 0);
+        renderInfo->setPriority(eRenderPriorityAnalysis);
         const bool isRenderUserInteraction = true;
         const bool isSequentialRender = false;
         AbortableThread* isAbortable = dynamic_cast<AbortableThread*>( QThread::currentThread() );
@@ -718,6 +723,7 @@ EffectInstance::getImage(int inputNb,
         tlsArgs->isDoingRotoNeatRender = false;
         tlsArgs->isAnalysis = true;
         tlsArgs->draftMode = false;
+        tlsArgs->viewsRenderedConcurrently = false;
         tlsArgs->stats = RenderStatsPtr();
         try {
             tlsSetter.reset( new ParallelRenderArgsSetter(tlsArgs) );
@@ -1630,7 +1636,8 @@ static ImagePtr ensureImageScale(unsigned int mipMapLevel,
                                             dstRoi,
                                             imageToConvert->getMipMapLevel(), img->getMipMapLevel(),
                                             imageToConvert->usesBitMap(),
-                                            img.get() );
+                                            img.get(),
+                                            appPTR->getCurrentSettings()->getMipMapFilter() );
         } else {
             img->pasteFrom(*imageToConvert, imgToConvertBounds);
         }
@@ -1829,6 +1836,10 @@ EffectInstance::getImageFromCacheAndConvertIfNeeded(bool /*useCache*/,
             //assert(imageToConvert->getBounds().contains(bounds));
             if ( stats && stats->isInDepthProfilingEnabled() ) {
                 stats->addCacheInfosForNode(getNode(), false, true);
+                double compressionRatio, decodeTime;
+                if ( imageToConvert->takeStorageDecodeInfos(&compressionRatio, &decodeTime) ) {
+                    stats->addCacheDecodeInfosForNode(getNode(), compressionRatio, decodeTime);
+                }
             }
         } else if (*image) { //  else if (imageToConvert && !*image)
             ///Ensure the image is allocated
@@ -1858,6 +1869,10 @@ EffectInstance::getImageFromCacheAndConvertIfNeeded(bool /*useCache*/,
 
             if ( stats && stats->isInDepthProfilingEnabled() ) {
                 stats->addCacheInfosForNode(getNode(), false, false);
+                double compressionRatio, decodeTime;
+                if ( (*image)->takeStorageDecodeInfos(&compressionRatio, &decodeTime) ) {
+                    stats->addCacheDecodeInfosForNode(getNode(), compressionRatio, decodeTime);
+                }
             }
         } else {
             if ( stats && stats->isInDepthProfilingEnabled() ) {
@@ -2235,7 +2250,7 @@ static void tryShrinkRenderWindow(const EffectInstance::EffectDataTLSPtr &tls,
             RectI initialRenderRect = renderMappedRectToRender;
 
 #if NATRON_ENABLE_TRIMAP
-            if ( frameArgs->isCurrentFrameRenderNotAbortable() ) {
+            if ( frameArgs->isTrimapEnabled() ) {
                 *bitmapMarkedForRendering = true;
                 renderMappedRectToRender = firstPlaneToRender.renderMappedImage->getMinimalRectAndMarkForRendering_trimap(renderMappedRectToRender, isBeingRenderedElseWhere);
             } else {
@@ -2262,7 +2277,7 @@ static void tryShrinkRenderWindow(const EffectInstance::EffectDataTLSPtr &tls,
             //The downscaled image is cached, read bitmap from it
 #if NATRON_ENABLE_TRIMAP
             RectI rectToRenderMinimal;
-            if ( frameArgs->isCurrentFrameRenderNotAbortable() ) {
+            if ( frameArgs->isTrimapEnabled() ) {
                 *bitmapMarkedForRendering = true;
                 rectToRenderMinimal = firstPlaneToRender.downscaleImage->getMinimalRectAndMarkForRendering_trimap(renderMappedRectToRender, isBeingRenderedElseWhere);
             } else {
@@ -2341,6 +2356,15 @@ EffectInstance::Implementation::tiledRenderingFunctor(const RectToRender & rectT
 
     assert( !rectToRender.rect.isNull() );
 
+    // Tile boundaries are the preemption points of the renders: let the more urgent renders use the thread pool first
+    AbortableRenderInfoPtr abortInfo = tls->frameArgs.back()->abortInfo.lock();
+    RenderPriorityScheduler* priorityScheduler = abortInfo ? appPTR->getRenderPriorityScheduler() : 0;
+    RenderPriorityEnum priority = abortInfo ? abortInfo->getPriority() : eRenderPriorityBackground;
+    if ( priorityScheduler && (priorityScheduler->yieldToMoreUrgentRenders(priority, abortInfo) > 0) && _publicInterface->aborted() ) {
+        return eRenderingFunctorRetAborted;
+    }
+    RenderPrioritySchedulerTile_RAII tileCounter(priorityScheduler, priority);
+
     // renderMappedRectToRender is in the mapped mipmap level, i.e the expected mipmap level of the render action of the plug-in
     // downscaledRectToRender is in the mipMapLevel
     RectI renderMappedRectToRender, downscaledRectToRender;
@@ -2585,7 +2609,7 @@ static void setupGLForRender(const ImagePtr& image,
     } else {
         viewportBounds = roi;
         assert(image->getStorageMode() == eStorageModeDisk || image->getStorageMode() == eStorageModeRAM);
-        Image::WriteAccess outputWriteAccess(image.get());
+        Image::WriteAccess outputWriteAccess(image.get(), roi);
         unsigned char* data = outputWriteAccess.pixelAt(roi.x1, roi.y1);
         assert(data);
 
@@ -2674,7 +2698,7 @@ EffectInstance::Implementation::renderHandlerInternal(const EffectDataTLSPtr& tl
     }
 
 #if NATRON_ENABLE_TRIMAP
-    if ( !bitmapMarkedForRendering && frameArgs->isCurrentFrameRenderNotAbortable() ) {
+    if ( !bitmapMarkedForRendering && frameArgs->isTrimapEnabled() ) {
         for (std::map<ImageComponents, EffectInstance::PlaneToRender>::iterator it = tls->currentRenderArgs.outputPlanes.begin(); it != tls->currentRenderArgs.outputPlanes.end(); ++it) {
             it->second.renderMappedImage->markForRendering(actionArgs.roi);
         }
@@ -2738,7 +2762,7 @@ EffectInstance::Implementation::renderHandlerInternal(const EffectDataTLSPtr& tl
 
         if ( (st != eStatusOK) || renderAborted ) {
 #if NATRON_ENABLE_TRIMAP
-            if ( frameArgs->isCurrentFrameRenderNotAbortable() ) {
+            if ( frameArgs->isTrimapEnabled() ) {
                 /*
                  At this point, another thread might have already gotten this image from the cache and could end-up
                  using it while it has still pixels marked to PIXEL_UNAVAILABLE, hence clear the bitmap
@@ -2818,21 +2842,18 @@ EffectInstance::Implementation::renderHandlerPostProcess(const EffectDataTLSPtr&
     for (std::map<ImageComponents, EffectInstance::PlaneToRender>::const_iterator it = outputPlanes.begin(); it != outputPlanes.end(); ++it) {
         bool unPremultRequired = unPremultIfNeeded && it->second.tmpImage->getComponentsCount() == 4 && it->second.renderMappedImage->getComponentsCount() == 3;
 
-        if ( frameArgs->doNansHandling && it->second.tmpImage->checkForNaNs(actionArgs.roi) ) {
-            QString warning = QString::fromUtf8( _publicInterface->getNode()->getScriptName_mt_safe().c_str() );
-            warning.append( QString::fromUtf8(": ") );
-            warning.append( tr("rendered rectangle (") );
-            warning.append( QString::number(actionArgs.roi.x1) );
-            warning.append( QChar::fromLatin1(',') );
-            warning.append( QString::number(actionArgs.roi.y1) );
-            warning.append( QString::fromUtf8(")-(") );
-            warning.append( QString::number(actionArgs.roi.x2) );
-            warning.append( QChar::fromLatin1(',') );
-            warning.append( QString::number(actionArgs.roi.y2) );
-            warning.append( QString::fromUtf8(") ") );
-            warning.append( tr("contains NaN values. They have been converted to 1.") );
-            _publicInterface->setPersistentMessage( eMessageTypeWarning, warning.toStdString() );
+        // The NaN and infinite values must be replaced before the mask/mix: NaN * 0 is still NaN and would become 1
+        // where the original image should have been restored.
+        // When the rendered image goes through copyUnProcessedChannelsAndApplyMaskMix() before any conversion,
+        // they are replaced in the same pass over the pixels, each row being sanitized before it is copied and mixed
+        int nbNonFiniteValues = 0;
+        bool sanitizeInPostRenderPass = frameArgs->doNansHandling && !it->second.isAllocatedOnTheFly &&
+                                        ( renderFullScaleThenDownscale ? (bool)originalInputImage : (it->second.tmpImage == it->second.downscaleImage) );
+        if (frameArgs->doNansHandling && !sanitizeInPostRenderPass) {
+            nbNonFiniteValues = it->second.tmpImage->sanitizeNonFiniteValues(actionArgs.roi);
         }
+        int* postRenderNonFiniteValues = sanitizeInPostRenderPass ? &nbNonFiniteValues : 0;
+
         if (it->second.isAllocatedOnTheFly) {
             ///Plane allocated on the fly only have a temp image if using the cache and it is defined over the render window only
             if (it->second.tmpImage != it->second.renderMappedImage) {
@@ -2886,10 +2907,8 @@ EffectInstance::Implementation::renderHandlerPostProcess(const EffectDataTLSPtr&
                 }
 
                 if (mappedOriginalInputImage) {
-                    it->second.tmpImage->copyUnProcessedChannels(actionArgs.roi, planes.outputPremult, originalImagePremultiplication, processChannels, mappedOriginalInputImage, true);
-                    if (useMaskMix) {
-                        it->second.tmpImage->applyMaskMix(actionArgs.roi, maskImage.get(), mappedOriginalInputImage.get(), doMask, false, mix);
-                    }
+                    it->second.tmpImage->copyUnProcessedChannelsAndApplyMaskMix(actionArgs.roi, planes.outputPremult, originalImagePremultiplication, processChannels, mappedOriginalInputImage, true,
+                                                                                useMaskMix, maskImage.get(), doMask, false, mix, postRenderNonFiniteValues);
                 }
                 if ( ( it->second.fullscaleImage->getComponents() != it->second.tmpImage->getComponents() ) ||
                     ( it->second.fullscaleImage->getBitDepth() != it->second.tmpImage->getBitDepth() ) ) {
@@ -2911,14 +2930,16 @@ EffectInstance::Implementation::renderHandlerPostProcess(const EffectDataTLSPtr&
                                                          _publicInterface->getApp()->getDefaultColorSpaceForBitDepth( it->second.fullscaleImage->getBitDepth() ),
                                                          -1, false, unPremultRequired, tmp.get() );
                     tmp->downscaleMipMap( it->second.tmpImage->getRoD(),
-                                         actionArgs.roi, 0, mipMapLevel, false, it->second.downscaleImage.get() );
+                                         actionArgs.roi, 0, mipMapLevel, false, it->second.downscaleImage.get(),
+                                         appPTR->getCurrentSettings()->getMipMapFilter() );
                     it->second.fullscaleImage->pasteFrom(*tmp, actionArgs.roi, false);
                 } else {
                     /*
                      *  Downscaling required only
                      */
                     it->second.tmpImage->downscaleMipMap( it->second.tmpImage->getRoD(),
-                                                         actionArgs.roi, 0, mipMapLevel, false, it->second.downscaleImage.get() );
+                                                         actionArgs.roi, 0, mipMapLevel, false, it->second.downscaleImage.get(),
+                                                         appPTR->getCurrentSettings()->getMipMapFilter() );
                     it->second.fullscaleImage->pasteFrom(*(it->second.tmpImage), actionArgs.roi, false);
                 }
 
@@ -2950,19 +2971,47 @@ EffectInstance::Implementation::renderHandlerPostProcess(const EffectDataTLSPtr&
                     }
                 }
 
-                it->second.downscaleImage->copyUnProcessedChannels(actionArgs.roi, planes.outputPremult, originalImagePremultiplication, processChannels, originalInputImage, true, glContext);
-                if (useMaskMix) {
-                    it->second.downscaleImage->applyMaskMix(actionArgs.roi, maskImage.get(), originalInputImage.get(), doMask, false, mix, glContext);
-                }
+                it->second.downscaleImage->copyUnProcessedChannelsAndApplyMaskMix(actionArgs.roi, planes.outputPremult, originalImagePremultiplication, processChannels, originalInputImage, true,
+                                                                                  useMaskMix, maskImage.get(), doMask, false, mix, postRenderNonFiniteValues, glContext);
                 it->second.downscaleImage->markForRendered(downscaledRectToRender);
             } // if (renderFullScaleThenDownscale) {
         } // if (it->second.isAllocatedOnTheFly) {
 
+        if (nbNonFiniteValues > 0) {
+            QString warning = QString::fromUtf8( _publicInterface->getNode()->getScriptName_mt_safe().c_str() );
+            warning.append( QString::fromUtf8(": ") );
+            warning.append( tr("rendered rectangle (") );
+            warning.append( QString::number(actionArgs.roi.x1) );
+            warning.append( QChar::fromLatin1(',') );
+            warning.append( QString::number(actionArgs.roi.y1) );
+            warning.append( QString::fromUtf8(")-(") );
+            warning.append( QString::number(actionArgs.roi.x2) );
+            warning.append( QChar::fromLatin1(',') );
+            warning.append( QString::number(actionArgs.roi.y2) );
+            warning.append( QString::fromUtf8(") ") );
+            warning.append( tr("contains NaN or infinite values. NaN values have been converted to 1 and infinite values clamped to the largest finite value.") );
+            _publicInterface->setPersistentMessage( eMessageTypeWarning, warning.toStdString() );
+            if (frameArgs->stats) {
+                frameArgs->stats->addNonFiniteValuesForNode(_publicInterface->getNode(), nbNonFiniteValues);
+            }
+        }
+
+        double timeSpent = timeRecorder->getTimeSinceCreation();
+        it->second.downscaleImage->addRenderCost(timeSpent);
+        if (it->second.fullscaleImage != it->second.downscaleImage) {
+            it->second.fullscaleImage->addRenderCost(timeSpent);
+        }
+
         if ( frameArgs->stats && frameArgs->stats->isInDepthProfilingEnabled() ) {
-            frameArgs->stats->addRenderInfosForNode( _publicInterface->getNode(),  NodePtr(), it->first.getComponentsGlobalName(), actionArgs.roi, timeRecorder->getTimeSinceCreation() );
+            frameArgs->stats->addRenderInfosForNode( _publicInterface->getNode(),  NodePtr(), it->first.getComponentsGlobalName(), actionArgs.roi, timeSpent );
         }
     } // for (std::map<ImageComponents,PlaneToRender>::const_iterator it = outputPlanes.begin(); it != outputPlanes.end(); ++it) {
 
+    MetricsServer* metrics = appPTR->getMetricsServer();
+    if (metrics) {
+        metrics->addNodeRenderTime( _publicInterface->getNode(), timeRecorder->getTimeSinceCreation() );
+    }
+
 } // EffectInstance::Implementation::renderHandlerPostProcess
 
 
@@ -2982,9 +3031,8 @@ EffectInstance::Implementation::setupRenderArgs(const EffectDataTLSPtr& tls,
 {
     const ParallelRenderArgsPtr& frameArgs = tls->frameArgs.back();
 
-    if (frameArgs->stats) {
-        timeRecorder->reset( new TimeLapse() );
-    }
+    // Always measured: the cache uses the render time of the images for its eviction policy
+    timeRecorder->reset( new TimeLapse() );
 
     const EffectInstance::PlaneToRender & firstPlane = planes.planes.begin()->second;
     const double time = tls->currentRenderArgs.time;
@@ -3138,7 +3186,7 @@ EffectInstance::onSignificantEvaluateAboutToBeCalled(const KnobIPtr& knob, Value
     bool isMT = QThread::currentThread() == qApp->thread();
 
     if ( isMT && ( !knob || knob->getEvaluateOnChange() ) ) {
-        getApp()->triggerAutoSave();
+        getApp()->triggerAutoSave(node);
     }
 
 
@@ -5323,6 +5371,9 @@ EffectInstance::abortAnyEvaluation(bool keepOldestRender)
         }
     }
     for (std::list<OutputEffectInstancePtr>::const_iterator it = outputNodes.begin(); it != outputNodes.end(); ++it) {
+        // The frames rendered speculatively around the playhead are no longer valid
+        (*it)->getRenderEngine()->abortPrefetch();
+
         //Abort and allow playback to restart but do not block, when this function returns any ongoing render may very
         //well not be finished
         if (keepOldestRender) {
@@ -5403,6 +5454,21 @@ EffectInstance::getCurrentTimeView(double* time, ViewIdx* view) const
     *view = getCurrentViewInternal(tls->currentRenderArgs, tls->frameArgs);
 }
 
+KnobValuesSnapshotPtr
+EffectInstance::getKnobValuesSnapshotTLS(double* time,
+                                         ViewIdx* view) const
+{
+    EffectDataTLSPtr tls = _imp->tlsData->getTLSData();
+
+    if ( !tls || tls->frameArgs.empty() || !tls->frameArgs.back()->knobValues ) {
+        return KnobValuesSnapshotPtr();
+    }
+    *time = getCurrentTimeInternal( tls->currentRenderArgs, tls->frameArgs, getApp() );
+    *view = getCurrentViewInternal(tls->currentRenderArgs, tls->frameArgs);
+
+    return tls->frameArgs.back()->knobValues;
+}
+
 SequenceTime
 EffectInstance::getFrameRenderArgsCurrentTime() const
 {
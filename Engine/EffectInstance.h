@@ -603,7 +603,9 @@ public:
         PluginOpenGLRenderSupport currentOpenGLSupport;
         bool doNanHandling;
         bool draftMode;
+        bool viewsRenderedConcurrently;
         RenderStatsPtr stats;
+        KnobValuesSnapshotPtr knobValues;
     };
 
     typedef boost::shared_ptr<SetParallelRenderTLSArgs> SetParallelRenderTLSArgsPtr;
@@ -800,6 +802,7 @@ public:
     virtual double getCurrentTime() const OVERRIDE WARN_UNUSED_RETURN;
     virtual ViewIdx getCurrentView() const OVERRIDE WARN_UNUSED_RETURN;
     void getCurrentTimeView(double* time, ViewIdx* view) const;
+    virtual KnobValuesSnapshotPtr getKnobValuesSnapshotTLS(double* time, ViewIdx* view) const OVERRIDE FINAL WARN_UNUSED_RETURN;
 
     virtual bool getCanTransform() const
     {
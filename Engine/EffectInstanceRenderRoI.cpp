@@ -53,6 +53,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Global/MemoryInfo.h"
 #include "Global/QtCompat.h"
 
+#include "Engine/AbortableRenderInfo.h"
 #include "Engine/AppInstance.h"
 #include "Engine/AppManager.h"
 #include "Engine/BlockingBackgroundRender.h"
@@ -73,10 +74,12 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/GPUContextPool.h"
 #include "Engine/PluginMemory.h"
 #include "Engine/Project.h"
+#include "Engine/RenderPriorityScheduler.h"
 #include "Engine/RenderStats.h"
 #include "Engine/RotoContext.h"
 #include "Engine/RotoDrawableItem.h"
 #include "Engine/Settings.h"
+#include "Engine/SharedUpstreamImages.h"
 #include "Engine/Timer.h"
 #include "Engine/Transform.h"
 #include "Engine/ThreadPool.h"
@@ -309,7 +312,7 @@ EffectInstance::Implementation::determineRectsToRender(ImagePtr& isPlaneCached,
         if (isPlaneCached->usesBitMap()) {
 
 #if NATRON_ENABLE_TRIMAP
-            if ( frameArgs->isCurrentFrameRenderNotAbortable() ) {
+            if ( frameArgs->isTrimapEnabled() ) {
 #ifndef DEBUG
                 isPlaneCached->getRestToRender_trimap(roi, rectsLeftToRender, &planesToRender->isBeingRenderedElsewhere);
 #else
@@ -1677,7 +1680,8 @@ EffectInstance::Implementation::renderRoIAllocateOutputPlanes(const RenderRoIArg
                                                            fieldingOrder,
                                                            true) );
 
-                it->second.fullscaleImage->downscaleMipMap( rod, it->second.fullscaleImage->getBounds(), 0, args.mipMapLevel, true, it->second.downscaleImage.get() );
+                it->second.fullscaleImage->downscaleMipMap( rod, it->second.fullscaleImage->getBounds(), 0, args.mipMapLevel, true, it->second.downscaleImage.get(),
+                                                            appPTR->getCurrentSettings()->getMipMapFilter() );
             }
         }
 
@@ -1726,8 +1730,12 @@ EffectInstance::Implementation::renderRoILaunchInternalRender(const RenderRoIArg
         assert( !planesToRender->planes.empty() );
 
 #if NATRON_ENABLE_TRIMAP
-        ///Only use trimap system if the render cannot be aborted.
-        if ( frameArgs->isCurrentFrameRenderNotAbortable() ) {
+        // Other renders may wait on the images marked below: do not yield to more urgent renders until they are unmarked,
+        // the render waiting could be the more urgent one
+        boost::scoped_ptr<AbortableRenderInfoImagesBeingRendered_RAII> imagesBeingRenderedRegistration;
+        ///Only use trimap system if the render cannot be aborted independently of the other threads using the image.
+        if ( frameArgs->isTrimapEnabled() ) {
+            imagesBeingRenderedRegistration.reset( new AbortableRenderInfoImagesBeingRendered_RAII( frameArgs->abortInfo.lock() ) );
             for (std::map<ImageComponents, EffectInstance::PlaneToRender>::iterator it = planesToRender->planes.begin(); it != planesToRender->planes.end(); ++it) {
                 markImageAsBeingRendered(renderFullScaleThenDownscale ? it->second.fullscaleImage : it->second.downscaleImage);
             }
@@ -1845,8 +1853,8 @@ EffectInstance::Implementation::renderRoILaunchInternalRender(const RenderRoIArg
         *renderAborted = _publicInterface->aborted();
 #if NATRON_ENABLE_TRIMAP
 
-        if ( frameArgs->isCurrentFrameRenderNotAbortable() ) {
-            ///Only use trimap system if the render cannot be aborted.
+        if ( frameArgs->isTrimapEnabled() ) {
+            ///Only use trimap system if the render cannot be aborted independently of the other threads using the image.
             ///If we were aborted after all (because the node got deleted) then return a NULL image and empty the cache
             ///of this image
             for (std::map<ImageComponents, EffectInstance::PlaneToRender>::iterator it = planesToRender->planes.begin(); it != planesToRender->planes.end(); ++it) {
@@ -1865,6 +1873,7 @@ EffectInstance::Implementation::renderRoILaunchInternalRender(const RenderRoIArg
                 }
             }
         }
+        imagesBeingRenderedRegistration.reset();
 #endif
     } // if (!hasSomethingToRender && !planesToRender->isBeingRenderedElsewhere) {
     return renderRetCode;
@@ -1913,10 +1922,10 @@ EffectInstance::Implementation::renderRoITermination(const RenderRoIArgs & args,
             }
             /*
              We cannot assert that the bitmap is empty because another thread might have started rendering the same image again but
-             needed a different portion of the image. The trimap system does not work for abortable renders
+             needed a different portion of the image. The trimap system does not work for renders aborted independently
              */
 
-            if ( frameArgs->isCurrentFrameRenderNotAbortable() ) {
+            if ( frameArgs->isTrimapEnabled() ) {
                 if ( !restToRender.empty() ) {
                     it->second.downscaleImage->printUnrenderedPixels(roi);
                 }
@@ -1977,7 +1986,8 @@ EffectInstance::Implementation::renderRoITermination(const RenderRoIArgs & args,
                 it->second.downscaleImage->setKey(it->second.fullscaleImage->getKey());
             }
 
-            it->second.fullscaleImage->downscaleMipMap( it->second.fullscaleImage->getRoD(), originalRoI, 0, args.mipMapLevel, false, it->second.downscaleImage.get() );
+            it->second.fullscaleImage->downscaleMipMap( it->second.fullscaleImage->getRoD(), originalRoI, 0, args.mipMapLevel, false, it->second.downscaleImage.get(),
+                                                        appPTR->getCurrentSettings()->getMipMapFilter() );
         }
 
         const ImageComponents* comp = 0;
@@ -2263,6 +2273,23 @@ EffectInstance::renderRoI(const RenderRoIArgs & args,
     ////////////////////////////// Termination /////////////////////////////////////////////////////////////////////////////
     _imp->renderRoITermination(args, frameArgs, abortInfo, planesToRender, glGpuContext, hasSomethingToRender, rod, roi, downscaledImageBounds, originalRoI, par, renderFullScaleThenDownscale, renderAborted, renderRetCode, outputPlanes, &glContextLocker);
 
+    // Other writers rendering the same frame read these images from the cache: keep them until they are done.
+    // Images that are not in the cache cannot be found by the other writers, and OpenGL textures must not be
+    // released later by another thread: only cached RAM images are held.
+    if (frameArgs->sharedUpstreamImages) {
+        for (std::map<ImageComponents, EffectInstance::PlaneToRender>::iterator it = planesToRender->planes.begin(); it != planesToRender->planes.end(); ++it) {
+            const ImagePtr& image = renderFullScaleThenDownscale ? it->second.fullscaleImage : it->second.downscaleImage;
+            if ( image && image->getCacheAPI() && (image->getStorageMode() == eStorageModeRAM) ) {
+                frameArgs->sharedUpstreamImages->holdImage(frameArgs->time, image);
+            }
+        }
+    }
+
+    // Compared with the memory predicted by the request pass
+    if (frameArgs->stats) {
+        frameArgs->stats->addImagesMemoryForNode(getNode(), *outputPlanes);
+    }
+
     return eRenderRoIRetCodeOk;
 } // renderRoI
 
@@ -2340,10 +2367,14 @@ EffectInstance::renderRoIInternal(const EffectInstancePtr& self,
     if (safety == eRenderSafetyFullySafeFrame) {
         ///If the plug-in is eRenderSafetyFullySafeFrame that means it wants the host to perform SMP aka slice up the RoI into chunks
         ///but if the effect doesn't support tiles it won't work.
-        ///Also check that the number of threads indicating by the settings are appropriate for this render mode.
+        ///Also check that the number of threads indicating by the settings are appropriate for this render mode
+        ///and that the priority class of the render does not already use its share of the thread pool.
+        AbortableRenderInfoPtr abortInfo = frameArgs->abortInfo.lock();
+        RenderPriorityScheduler* priorityScheduler = appPTR->getRenderPriorityScheduler();
         if ( !frameArgs->tilesSupported || (nbThreads == -1) || (nbThreads == 1) ||
             ( (nbThreads == 0) && (appPTR->getHardwareIdealThreadCount() == 1) ) ||
             ( QThreadPool::globalInstance()->activeThreadCount() >= QThreadPool::globalInstance()->maxThreadCount() ) ||
+            ( abortInfo && priorityScheduler && !priorityScheduler->canRenderTilesInParallel( abortInfo->getPriority() ) ) ||
             self->isRotoPaintNode() ) {
             safety = eRenderSafetyFullySafe;
         }
@@ -68,6 +68,9 @@ INCLUDEPATH += $$PWD/../google-breakpad/src
 # hoedown
 INCLUDEPATH += $$PWD/../libs/hoedown/src
 
+# qhttpserver
+INCLUDEPATH += $$PWD/../libs/qhttpserver/src
+
 #To overcome wrongly generated #include <...> by shiboken
 INCLUDEPATH += $$PWD
 INCLUDEPATH += $$PWD/NatronEngine
@@ -84,11 +87,13 @@ SOURCES += \
     BezierCP.cpp \
     BlockingBackgroundRender.cpp \
     Cache.cpp \
+    CacheStorageCodec.cpp \
     CLArgs.cpp \
     CoonsRegularization.cpp \
     ColorParser.cpp \
     CreateNodeArgs.cpp \
     Curve.cpp \
+    DirectoryScanner.cpp \
     DiskCacheNode.cpp \
     Dot.cpp \
     EffectInstance.cpp \
@@ -116,19 +121,27 @@ SOURCES += \
     ImageConvert.cpp \
     ImageCopyChannels.cpp \
     ImageComponents.cpp \
+    ImageKernels.cpp \
     ImageKey.cpp \
     ImageMaskMix.cpp \
+    ImageMipMap.cpp \
+    ImageRegionLock.cpp \
     Interpolation.cpp \
     JoinViewsNode.cpp \
     Knob.cpp \
     KnobFactory.cpp \
     KnobFile.cpp \
     KnobTypes.cpp \
+    KnobValuesSnapshot.cpp \
     LibraryBinary.cpp \
     Log.cpp \
     Lut.cpp \
+    LutKernels.cpp \
     Markdown.cpp \
     MemoryFile.cpp \
+    MetricsServer.cpp \
+    MultiProcessRender.cpp \
+    MultiThreadTeam.cpp \
     Node.cpp \
     NodePrivate.cpp \
     NodeGroup.cpp \
@@ -169,10 +182,13 @@ SOURCES += \
     PyParameter.cpp \
     PyRoto.cpp \
     PySideCompat.cpp \
+    PythonCallback.cpp \
     PyTracker.cpp \
     ReadNode.cpp \
     RectD.cpp \
     RectI.cpp \
+    RenderPriorityScheduler.cpp \
+    RenderProgressReporter.cpp \
     RenderStats.cpp \
     RotoBezierTriangulation.cpp \
     RotoContext.cpp \
@@ -190,6 +206,7 @@ SOURCES += \
     ScriptObject.cpp \
     Settings.cpp \
     SerializableWindow.cpp \
+    SharedUpstreamImages.cpp \
     SplitterI.cpp \
     Smooth1D.cpp \
     StandardPaths.cpp \
@@ -213,6 +230,7 @@ SOURCES += \
     Utils.cpp \
     ViewerInstance.cpp \
     ViewerNode.cpp \
+    ViewerPrefetcher.cpp \
     WriteNode.cpp \
     ../Global/glad_source.c \
     ../Global/ProcInfo.cpp \
@@ -284,6 +302,7 @@ HEADERS += \
     CLArgs.h \
     Cache.h \
     CacheEntry.h \
+    CacheStorageCodec.h \
     CoonsRegularization.h \
     ColorParser.h \
     CreateNodeArgs.h \
@@ -291,6 +310,7 @@ HEADERS += \
     CurvePrivate.h \
     DockablePanelI.h \
     Dot.h \
+    DirectoryScanner.h \
     DiskCacheNode.h \
     EffectInstance.h \
     EffectInstancePrivate.h \
@@ -319,9 +339,11 @@ HEADERS += \
     HostOverlaySupport.h \
     Image.h \
     ImageComponents.h \
+    ImageKernels.h \
     ImageKey.h \
     ImageLocker.h \
     ImageParams.h \
+    ImageRegionLock.h \
     Interpolation.h \
     JoinViewsNode.h \
     KeyHelper.h \
@@ -331,14 +353,19 @@ HEADERS += \
     KnobFactory.h \
     KnobFile.h \
     KnobTypes.h \
+    KnobValuesSnapshot.h \
     LibraryBinary.h \
     Log.h \
     LogEntry.h \
     LRUHashTable.h \
     Lut.h \
+    LutKernels.h \
     Markdown.h \
     MemoryFile.h \
+    MetricsServer.h \
     MergingEnum.h \
+    MultiProcessRender.h \
+    MultiThreadTeam.h \
     Node.h \
     NodePrivate.h \
     Noise.h \
@@ -386,10 +413,13 @@ HEADERS += \
     PyRoto.h \
     PyTracker.h \
     Pyside_Engine_Python.h \
+    PythonCallback.h \
     PyPanelI.h \
     ReadNode.h \
     RectD.h \
     RectI.h \
+    RenderPriorityScheduler.h \
+    RenderProgressReporter.h \
     RenderStats.h \
     RotoBezierTriangulation.h \
     RotoContext.h \
@@ -410,6 +440,7 @@ HEADERS += \
     ScriptObject.h \
     Settings.h \
     SerializableWindow.h \
+    SharedUpstreamImages.h \
     Singleton.h \
     SplitterI.h \
     StandardPaths.h \
@@ -440,6 +471,7 @@ HEADERS += \
     ViewerInstance.h \
     ViewerInstancePrivate.h \
     ViewerNode.h \
+    ViewerPrefetcher.h \
     ViewIdx.h \
     WriteNode.h \
     ../Global/Enums.h \
@@ -120,6 +120,8 @@ class CacheSignalEmitter;
 class CreateNodeArgs;
 class Curve;
 class Dimension;
+class DirectoryContent;
+class DirectoryScanner;
 class DiskCacheNode;
 class DockablePanelI;
 class Dot;
@@ -174,8 +176,11 @@ class KnobPath;
 class KnobSeparator;
 class KnobString;
 class KnobTable;
+class KnobValuesSnapshot;
 class LibraryBinary;
 class LogEntry;
+class MetricsServer;
+class MultiProcessRender;
 class NamedKnobHolder;
 class Node;
 class NodeCollection;
@@ -217,6 +222,9 @@ class ReadNode;
 class RectD;
 class RectI;
 class RenderEngine;
+class RenderPriorityScheduler;
+class RenderPriorityScheduler_RAII;
+class RenderProgressReporter;
 class RenderStats;
 class RenderingFlagSetter;
 class RotoContext;
@@ -231,6 +239,7 @@ class RotoShapeRenderNodeOpenGLData;
 class RotoStrokeItem;
 class SerializableWindow;
 class Settings;
+class SharedUpstreamImages;
 class SplitterI;
 class StringAnimationManager;
 class StubNode;
@@ -253,7 +262,9 @@ class ViewIdx;
 class ViewerCurrentFrameRequestSchedulerStartArgs;
 class ViewerInstance;
 class ViewerNode;
+class ViewerPrefetcher;
 class WriteNode;
+struct RenderProgressRecord;
 
 namespace Color {
 class Lut;
@@ -318,6 +329,7 @@ typedef boost::shared_ptr<KnobParametric> KnobParametricPtr;
 typedef boost::shared_ptr<KnobSeparator> KnobSeparatorPtr;
 typedef boost::shared_ptr<KnobString> KnobStringPtr;
 typedef boost::shared_ptr<KnobTable> KnobTablePtr;
+typedef boost::shared_ptr<const KnobValuesSnapshot> KnobValuesSnapshotPtr;
 typedef boost::shared_ptr<LibraryBinary> LibraryBinaryPtr;
 typedef boost::shared_ptr<NamedKnobHolder> NamedKnobHolderPtr;
 typedef boost::shared_ptr<NoOpBase> NoOpBasePtr;
@@ -355,6 +367,7 @@ typedef boost::shared_ptr<RotoPaintInteract> RotoPaintInteractPtr;
 typedef boost::shared_ptr<RotoShapeRenderNodeOpenGLData> RotoShapeRenderNodeOpenGLDataPtr;
 typedef boost::shared_ptr<RotoStrokeItem> RotoStrokeItemPtr;
 typedef boost::shared_ptr<Settings> SettingsPtr;
+typedef boost::shared_ptr<SharedUpstreamImages> SharedUpstreamImagesPtr;
 typedef boost::shared_ptr<StubNode> StubNodePtr;
 typedef boost::shared_ptr<Texture> GLTexturePtr;
 typedef boost::shared_ptr<TimeLapse> TimeLapsePtr;
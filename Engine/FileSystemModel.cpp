@@ -24,6 +24,7 @@
 
 #include "FileSystemModel.h"
 
+#include <algorithm> // stable_sort, reverse
 #include <vector>
 #include <cassert>
 #include <stdexcept>
@@ -50,6 +51,8 @@ CLANG_DIAG_ON(uninitialized)
 
 #include <SequenceParsing.h>
 
+#include "Engine/AppManager.h"
+#include "Engine/DirectoryScanner.h"
 
 NATRON_NAMESPACE_ENTER;
 
@@ -1545,18 +1548,45 @@ isVideoFileExtension(const std::string& ext)
     return false;
 }
 
-typedef std::list< std::pair< SequenceParsing::SequenceFromFilesPtr, QFileInfo > > FileSequences;
+typedef std::pair< SequenceParsing::SequenceFromFilesPtr, QFileInfo > FileSequence;
+typedef std::vector<FileSequence> FileSequences;
 
-#define KERNEL_INCR() \
-    switch (viewOrder) \
-    { \
-    case Qt::AscendingOrder: \
-        ++i; \
-        break; \
-    case Qt::DescendingOrder: \
-        --i; \
-        break; \
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Sorts the directories first, then as QDir::entryInfoList() sorts with the given flags. The entries are already sorted by name.
+struct FileSequenceLess
+{
+    QDir::SortFlags sort;
+
+    FileSequenceLess(QDir::SortFlags sort)
+        : sort(sort)
+    {
+    }
+
+    bool operator() (const FileSequence& a,
+                     const FileSequence& b) const
+    {
+        bool aIsDir = !a.first && a.second.isDir();
+        bool bIsDir = !b.first && b.second.isDir();
+
+        if (aIsDir != bIsDir) {
+            return aIsDir;
+        }
+        if (sort & QDir::Size) {
+            // Largest first
+            return a.second.size() > b.second.size();
+        } else if (sort & QDir::Time) {
+            // Most recent first
+            return a.second.lastModified() > b.second.lastModified();
+        } else if (sort & QDir::Type) {
+            return a.second.suffix().compare(b.second.suffix(), Qt::CaseInsensitive) < 0;
+        }
+
+        return false;
     }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
 
 void
 FileGathererThread::gatheringKernel(const FileSystemItemPtr& item)
@@ -1564,7 +1594,6 @@ FileGathererThread::gatheringKernel(const FileSystemItemPtr& item)
     if (!item) {
         return;
     }
-    QDir dir( item->absoluteFilePath() );
     FileSystemModelPtr model = _imp->getModel();
     if (!model) {
         return;
@@ -1589,75 +1618,93 @@ FileGathererThread::gatheringKernel(const FileSystemItemPtr& item)
     default:
         break;
     }
-    sort |= QDir::IgnoreCase;
-    sort |= QDir::DirsFirst;
 
-    ///All entries in the directory
-    QFileInfoList all = dir.entryInfoList(model->filter(), sort);
+    ///All entries in the directory, sorted by name, without their attributes: only the files shown in the view are read
+    DirectoryContentPtr content = appPTR->getDirectoryScanner()->getDirectoryContent( item->absoluteFilePath().toStdString() );
+    if (!content) {
+        Q_EMIT directoryLoaded( item->absoluteFilePath() );
+
+        return;
+    }
+    const std::vector<DirectoryContent::Entry>& entries = content->getEntries();
+    QDir::Filters filters = model->filter();
+    bool showHidden = filters & QDir::Hidden;
 
     ///List of all possible file sequences in the directory or directories
     FileSequences sequences;
-    int start = 0;
-    int end = 0;
-    switch (viewOrder) {
-    case Qt::AscendingOrder:
-        start = 0;
-        end = all.size();
-        break;
-    case Qt::DescendingOrder:
-        start = all.size() - 1;
-        end = -1;
-        break;
-    }
 
-    int i = start;
-    while (i != end) {
-        ///If we must abort we do it now
-        if ( _imp->checkForAbort() ) {
-            return;
+    if ( filters & (QDir::Dirs | QDir::AllDirs) ) {
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if ( entries[i].isDir && ( showHidden || !entries[i].isHidden ) ) {
+                QString filename = QString::fromUtf8( entries[i].name.c_str() );
+                sequences.push_back( std::make_pair( SequenceParsing::SequenceFromFilesPtr(), QFileInfo( generateChildAbsoluteName(item.get(), filename) ) ) );
+            }
         }
+    }
 
-        if ( all[i].isDir() ) {
-            ///This is a directory
-            sequences.push_back( std::make_pair(SequenceParsing::SequenceFromFilesPtr(), all[i]) );
-        } else {
-            QString filename = all[i].fileName();
-            /// If the item does not match the filter regexp set by the user, discard it
-            if ( !model->isAcceptedByRegexps(filename) ) {
-                KERNEL_INCR();
-                continue;
-            }
+    if (filters & QDir::Files) {
+        bool sequenceMode = model->isSequenceModeEnabled();
+        // A file can only belong to a sequence of its group, which usually holds a single sequence
+        const std::vector<std::vector<std::size_t> >& groups = content->getFileGroups();
+        for (std::size_t g = 0; g < groups.size(); ++g) {
+            std::vector<SequenceParsing::SequenceFromFilesPtr> groupSequences;
+            for (std::size_t f = 0; f < groups[g].size(); ++f) {
+                ///If we must abort we do it now
+                if ( _imp->checkForAbort() ) {
+                    return;
+                }
 
-            /// If file sequence fetching is disabled, accept it
-            if ( !model->isSequenceModeEnabled() ) {
-                sequences.push_back( std::make_pair(SequenceParsing::SequenceFromFilesPtr(), all[i]) );
-                KERNEL_INCR();
-                continue;
-            }
+                const DirectoryContent::Entry& entry = entries[groups[g][f]];
+                if ( entry.isHidden && !showHidden ) {
+                    continue;
+                }
 
-            std::string absoluteFilePath = generateChildAbsoluteName(item.get(), filename).toStdString();
-            bool foundMatchingSequence = false;
+                QString filename = QString::fromUtf8( entry.name.c_str() );
+                /// If the item does not match the filter regexp set by the user, discard it
+                if ( !model->isAcceptedByRegexps(filename) ) {
+                    continue;
+                }
 
-            /// If we reach here, this is a valid file and we need to determine if it belongs to another sequence or we need
-            /// to create a new one
-            SequenceParsing::FileNameContent fileContent(absoluteFilePath);
+                QString absoluteFilePath = generateChildAbsoluteName(item.get(), filename);
 
-            if ( !isVideoFileExtension( fileContent.getExtension() ) ) {
-                ///Note that we use a reverse iterator because we have more chance to find a match in the last recently added entries
-                for (FileSequences::reverse_iterator it = sequences.rbegin(); it != sequences.rend(); ++it) {
-                    if ( it->first && it->first->tryInsertFile(fileContent, false) ) {
-                        foundMatchingSequence = true;
-                        break;
+                /// If file sequence fetching is disabled, accept it
+                if (!sequenceMode) {
+                    sequences.push_back( std::make_pair( SequenceParsing::SequenceFromFilesPtr(), QFileInfo(absoluteFilePath) ) );
+                    continue;
+                }
+
+                bool foundMatchingSequence = false;
+
+                /// If we reach here, this is a valid file and we need to determine if it belongs to another sequence or we need
+                /// to create a new one
+                SequenceParsing::FileNameContent fileContent( absoluteFilePath.toStdString() );
+
+                if ( !isVideoFileExtension( fileContent.getExtension() ) ) {
+                    ///Note that we use a reverse iterator because we have more chance to find a match in the last recently added entries
+                    for (std::vector<SequenceParsing::SequenceFromFilesPtr>::reverse_iterator it = groupSequences.rbegin(); it != groupSequences.rend(); ++it) {
+                        if ( (*it)->tryInsertFile(fileContent, false) ) {
+                            foundMatchingSequence = true;
+                            break;
+                        }
                     }
                 }
-            }
 
-            if (!foundMatchingSequence) {
-                SequenceParsing::SequenceFromFilesPtr newSequence( new SequenceParsing::SequenceFromFiles(fileContent, true) );
-                sequences.push_back( std::make_pair(newSequence, all[i]) );
+                if (!foundMatchingSequence) {
+                    SequenceParsing::SequenceFromFilesPtr newSequence( new SequenceParsing::SequenceFromFiles(fileContent, true) );
+                    groupSequences.push_back(newSequence);
+                    // Only the first file of a sequence is read, for the date and type columns
+                    sequences.push_back( std::make_pair( newSequence, QFileInfo(absoluteFilePath) ) );
+                }
             }
         }
-        KERNEL_INCR();
+    }
+
+    // The directories come first, then the files in the order of their group, which is the order of their names
+    if (sort != QDir::Name) {
+        std::stable_sort( sequences.begin(), sequences.end(), FileSequenceLess(sort) );
+    }
+    if (viewOrder == Qt::DescendingOrder) {
+        std::reverse( sequences.begin(), sequences.end() );
     }
 
     ///Now iterate through the sequences and create the children as necessary
@@ -1692,17 +1739,18 @@ FileSystemModel::filesListFromPattern(const std::string& pattern, SequenceParsin
     std::string patternCpy = pattern;
     std::string patternPath = SequenceParsing::removePath(patternCpy);
 
-    QDir dir(QString::fromUtf8(patternPath.c_str()));
-    if (!dir.exists()) {
+    DirectoryContentPtr content = appPTR ? appPTR->getDirectoryScanner()->getDirectoryContent(patternPath) : DirectoryScanner::scanDirectory(patternPath);
+    if (!content) {
         return false;
     }
 
-    QStringList files = dir.entryList(QDir::Files | QDir::NoDotAndDotDot);
+    // Only the files starting with the characters before the first frame number or view can match the pattern:
+    // in a directory holding many sequences, the others are not parsed
+    std::string prefix = patternCpy.substr( 0, patternCpy.find_first_of("#%@") );
+    std::vector<std::string> files;
+    content->getFilesStartingWith(prefix, &files);
+    StringList filesList( files.begin(), files.end() );
 
-    StringList filesList;
-    for (QStringList::iterator it = files.begin(); it!=files.end(); ++it) {
-        filesList.push_back(it->toStdString());
-    }
     return SequenceParsing::filesListFromPattern_fast(pattern, filesList, sequence);
 }
 
@@ -43,10 +43,7 @@ FrameEntry::pixelAt(int x,
         return 0;
     }
     std::size_t rowSize = bounds.width();
-    unsigned int srcPixelSize = 4;
-    if ( (ImageBitDepthEnum)_key.getBitDepth() == eImageBitDepthFloat ) {
-        srcPixelSize *= sizeof(float);
-    }
+    std::size_t srcPixelSize = getPixelSizeInBytes();
     rowSize *= srcPixelSize;
 
     return data() +  (y - bounds.y1) * rowSize + (x - bounds.x1) * srcPixelSize;
@@ -69,23 +66,18 @@ FrameEntry::copy(const FrameEntry& other)
     const TextureRect& srcBounds = other.getKey().getTexRect();
     const TextureRect& dstBounds = _key.getTexRect();
     std::size_t srcRowSize = srcBounds.width();
-    unsigned int srcPixelSize = 4;
-    if ( (ImageBitDepthEnum)other.getKey().getBitDepth() == eImageBitDepthFloat ) {
-        srcPixelSize *= sizeof(float);
-    }
+    std::size_t srcPixelSize = other.getPixelSizeInBytes();
     srcRowSize *= srcPixelSize;
 
     std::size_t dstRowSize = srcBounds.width();
-    unsigned int dstPixelSize = 4;
-    if ( (ImageBitDepthEnum)_key.getBitDepth() == eImageBitDepthFloat ) {
-        dstPixelSize *= sizeof(float);
-    }
+    std::size_t dstPixelSize = getPixelSizeInBytes();
     dstRowSize *= dstPixelSize;
 
     // Fill with black and transparent because src might be smaller
     if ( !srcPixels ||
          !srcBounds.contains(dstBounds) ||
-         other.getKey().getBitDepth() != _key.getBitDepth() ) {
+         other.getKey().getBitDepth() != _key.getBitDepth() ||
+         srcPixelSize != dstPixelSize ) {
         std::memset( dstPixels, 0, dstRowSize * dstBounds.height() );
 
         return;
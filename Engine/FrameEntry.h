@@ -75,6 +75,23 @@ public:
 
     const U8* pixelAt(int x, int y ) const WARN_UNUSED_RETURN;
 
+    /**
+     * @brief Returns true if the key is a 32bits floating-point texture but the entry stores half-floats.
+     * The data must then be converted with CacheStorageCodec::halfToFloatRow() to be displayed.
+     **/
+    bool isStoredAsHalfFloat() const
+    {
+        return (ImageBitDepthEnum)_key.getBitDepth() == eImageBitDepthFloat && _params->getStorageInfo().dataTypeSize == sizeof(unsigned short);
+    }
+
+    /**
+     * @brief Returns the number of bytes of a RGBA pixel of the data
+     **/
+    std::size_t getPixelSizeInBytes() const
+    {
+        return _params->getStorageInfo().dataTypeSize * 4;
+    }
+
     void copy(const FrameEntry& other);
 
 
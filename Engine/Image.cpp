@@ -34,6 +34,7 @@
 #include "Engine/AppManager.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/GPUContextPool.h"
+#include "Engine/ImageKernels.h"
 #include "Engine/OSGLContext.h"
 
 NATRON_NAMESPACE_ENTER;
@@ -610,7 +611,7 @@ Image::printUnrenderedPixels(const RectI& roi) const
     if (!_useBitmap) {
         return;
     }
-    QReadLocker k(&_entryLock);
+    RegionLocker k(this, roi, false);
     const char* bm = _bitmap.getBitmapAt(roi.x1, roi.y1);
     int roiw = roi.x2 - roi.x1;
     int boundsW = _bitmap.getBounds().width();
@@ -851,10 +852,11 @@ Image::pasteFromForDepth(const Image & srcImg,
     assert( (getBitDepth() == eImageBitDepthByte && sizeof(PIX) == 1) || (getBitDepth() == eImageBitDepthShort && sizeof(PIX) == 2) || (getBitDepth() == eImageBitDepthFloat && sizeof(PIX) == 4) );
     // NOTE: before removing the following asserts, please explain why an empty image may happen
 
-    QWriteLocker k(&_entryLock);
-    boost::shared_ptr<QReadLocker> k2;
+    // Only the pixels of srcRoi are locked, so that the tiles of the same image can be copied concurrently
+    RegionLocker k(this, srcRoi, true);
+    boost::shared_ptr<RegionLocker> k2;
     if (takeSrcLock) {
-        k2.reset( new QReadLocker(&srcImg._entryLock) );
+        k2.reset( new RegionLocker(&srcImg, srcRoi, false) );
     }
 
     const RectI & bounds = _bounds;
@@ -1264,7 +1266,8 @@ Image::copyAndResizeIfNeeded(const RectI& newBounds,
     }
     assert(output);
 
-    QReadLocker k(&_entryLock);
+    // Waits for the threads writing the pixels to be copied
+    ReadAccess k(this);
     RectI merge = newBounds;
     merge.merge(_bounds);
 
@@ -1459,7 +1462,7 @@ Image::fill(const RectI & roi,
             float a,
             const OSGLContextPtr& glContext)
 {
-    QWriteLocker k(&_entryLock);
+    RegionLocker k(this, roi, true);
 
     if (getStorageMode() == eStorageModeGLTex) {
         if (glContext->isGPUContext()) {
@@ -1498,7 +1501,7 @@ Image::fillZero(const RectI& roi,
         return;
     }
 
-    QWriteLocker k(&_entryLock);
+    RegionLocker k(this, roi, true);
     RectI intersection;
 
     if ( !roi.intersect(_bounds, &intersection) ) {
@@ -1544,7 +1547,7 @@ Image::fillBoundsZero(const OSGLContextPtr& glContext)
         return;
     }
 
-    QWriteLocker k(&_entryLock);
+    WriteAccess k(this);
     std::size_t rowSize =  (std::size_t)_nbComponents;
 
     switch ( getBitDepth() ) {
@@ -1758,503 +1761,31 @@ Image::getRowElements() const
     return getComponentsCount() * _bounds.width();
 }
 
-// code proofread and fixed by @devernay on 4/12/2014
-template <typename PIX, int maxValue>
-void
-Image::halveRoIForDepth(const RectI & roi,
-                        bool copyBitMap,
-                        Image* output) const
-{
-    assert( (getBitDepth() == eImageBitDepthByte && sizeof(PIX) == 1) ||
-            (getBitDepth() == eImageBitDepthShort && sizeof(PIX) == 2) ||
-            (getBitDepth() == eImageBitDepthFloat && sizeof(PIX) == 4) );
-
-    ///handle case where there is only 1 column/row
-    if ( (roi.width() == 1) || (roi.height() == 1) ) {
-        assert( !(roi.width() == 1 && roi.height() == 1) ); /// can't be 1x1
-        halve1DImage(roi, output);
-
-        return;
-    }
-
-    /// Take the lock for both bitmaps since we're about to read/write from them!
-    QWriteLocker k1(&output->_entryLock);
-    QReadLocker k2(&_entryLock);
-
-    ///The source rectangle, intersected to this image region of definition in pixels
-    const RectI &srcBounds = _bounds;
-    const RectI &dstBounds = output->_bounds;
-    const RectI &srcBmBounds = _bitmap.getBounds();
-    const RectI &dstBmBounds = output->_bitmap.getBounds();
-    assert( !copyBitMap || usesBitMap() );
-    assert( !usesBitMap() || (srcBmBounds == srcBounds && dstBmBounds == dstBounds) );
-
-    // the srcRoD of the output should be enclosed in half the roi.
-    // It does not have to be exactly half of the input.
-    //    assert(dstRoD.x1*2 >= roi.x1 &&
-    //           dstRoD.x2*2 <= roi.x2 &&
-    //           dstRoD.y1*2 >= roi.y1 &&
-    //           dstRoD.y2*2 <= roi.y2 &&
-    //           dstRoD.width()*2 <= roi.width() &&
-    //           dstRoD.height()*2 <= roi.height());
-    assert( getComponents() == output->getComponents() );
-
-    RectI dstRoI;
-    RectI srcRoI = roi;
-    srcRoI.intersect(srcBounds, &srcRoI); // intersect srcRoI with the region of definition
-
-    dstRoI.x1 = std::floor(srcRoI.x1 / 2.);
-    dstRoI.y1 = std::floor(srcRoI.y1 / 2.);
-    dstRoI.x2 = std::ceil(srcRoI.x2 / 2.);
-    dstRoI.y2 = std::ceil(srcRoI.y2 / 2.);
-
-
-    const PIX* const srcPixels      = (const PIX*)pixelAt(srcBounds.x1,   srcBounds.y1);
-    const char* const srcBmPixels   = _bitmap.getBitmapAt(srcBmBounds.x1, srcBmBounds.y1);
-    PIX* const dstPixels          = (PIX*)output->pixelAt(dstBounds.x1,   dstBounds.y1);
-    char* const dstBmPixels = output->_bitmap.getBitmapAt(dstBmBounds.x1, dstBmBounds.y1);
-    int srcRowSize = srcBounds.width() * _nbComponents;
-    int dstRowSize = dstBounds.width() * _nbComponents;
-
-    // offset pointers so that srcData and dstData correspond to pixel (0,0)
-    const PIX* const srcData = srcPixels - (srcBounds.x1 * _nbComponents + srcRowSize * srcBounds.y1);
-    PIX* const dstData       = dstPixels - (dstBounds.x1 * _nbComponents + dstRowSize * dstBounds.y1);
-    const int srcBmRowSize = srcBmBounds.width();
-    const int dstBmRowSize = dstBmBounds.width();
-    const char* const srcBmData = srcBmPixels - (srcBmBounds.x1 + srcBmRowSize * srcBmBounds.y1);
-    char* const dstBmData       = dstBmPixels - (dstBmBounds.x1 + dstBmRowSize * dstBmBounds.y1);
-
-    for (int y = dstRoI.y1; y < dstRoI.y2; ++y) {
-        const PIX* const srcLineStart    = srcData + y * 2 * srcRowSize;
-        PIX* const dstLineStart          = dstData + y     * dstRowSize;
-        const char* const srcBmLineStart = srcBmData + y * 2 * srcBmRowSize;
-        char* const dstBmLineStart       = dstBmData + y     * dstBmRowSize;
-
-        // The current dst row, at y, covers the src rows y*2 (thisRow) and y*2+1 (nextRow).
-        // Check that if are within srcBounds.
-        int srcy = y * 2;
-        bool pickThisRow = srcBounds.y1 <= (srcy + 0) && (srcy + 0) < srcBounds.y2;
-        bool pickNextRow = srcBounds.y1 <= (srcy + 1) && (srcy + 1) < srcBounds.y2;
-        int sumH = (int)pickNextRow + (int)pickThisRow;
-        assert(sumH == 1 || sumH == 2);
-
-        for (int x = dstRoI.x1; x < dstRoI.x2; ++x) {
-            const PIX* const srcPixStart    = srcLineStart   + x * 2 * _nbComponents;
-            const char* const srcBmPixStart = srcBmLineStart + x * 2;
-            PIX* const dstPixStart          = dstLineStart   + x * _nbComponents;
-            char* const dstBmPixStart       = dstBmLineStart + x;
-
-            // The current dst col, at y, covers the src cols x*2 (thisCol) and x*2+1 (nextCol).
-            // Check that if are within srcBounds.
-            int srcx = x * 2;
-            bool pickThisCol = srcBounds.x1 <= (srcx + 0) && (srcx + 0) < srcBounds.x2;
-            bool pickNextCol = srcBounds.x1 <= (srcx + 1) && (srcx + 1) < srcBounds.x2;
-            int sumW = (int)pickThisCol + (int)pickNextCol;
-            assert(sumW == 1 || sumW == 2);
-            const int sum = sumW * sumH;
-            assert(0 < sum && sum <= 4);
-
-            if (sum == 0) { // never happens
-                for (int k = 0; k < _nbComponents; ++k) {
-                    dstPixStart[k] = 0;
-                }
-                if (copyBitMap) {
-                    dstBmPixStart[0] = 0;
-                }
-                continue;
-            }
-
-            for (int k = 0; k < _nbComponents; ++k) {
-                ///a b
-                ///c d
-
-                const PIX a = (pickThisCol && pickThisRow) ? *(srcPixStart + k) : 0;
-                const PIX b = (pickNextCol && pickThisRow) ? *(srcPixStart + k + _nbComponents) : 0;
-                const PIX c = (pickThisCol && pickNextRow) ? *(srcPixStart + k + srcRowSize) : 0;
-                const PIX d = (pickNextCol && pickNextRow) ? *(srcPixStart + k + srcRowSize  + _nbComponents)  : 0;
-
-                assert( sumW == 2 || ( sumW == 1 && ( (a == 0 && c == 0) || (b == 0 && d == 0) ) ) );
-                assert( sumH == 2 || ( sumH == 1 && ( (a == 0 && b == 0) || (c == 0 && d == 0) ) ) );
-                dstPixStart[k] = (a + b + c + d) / sum;
-            }
-
-            if (copyBitMap) {
-                ///a b
-                ///c d
-
-                char a = (pickThisCol && pickThisRow) ? *(srcBmPixStart) : 0;
-                char b = (pickNextCol && pickThisRow) ? *(srcBmPixStart + 1) : 0;
-                char c = (pickThisCol && pickNextRow) ? *(srcBmPixStart + srcBmRowSize) : 0;
-                char d = (pickNextCol && pickNextRow) ? *(srcBmPixStart + srcBmRowSize  + 1)  : 0;
-#if NATRON_ENABLE_TRIMAP
-                /*
-                   The only correct solution is to convert pixels being rendered to 0 otherwise the caller
-                   would have to wait for the original fullscale image render to be finished and then re-downscale again.
-                 */
-                if (a == PIXEL_UNAVAILABLE) {
-                    a = 0;
-                }
-                if (b == PIXEL_UNAVAILABLE) {
-                    b = 0;
-                }
-                if (c == PIXEL_UNAVAILABLE) {
-                    c = 0;
-                }
-                if (d == PIXEL_UNAVAILABLE) {
-                    d = 0;
-                }
-#endif
-                assert( sumW == 2 || ( sumW == 1 && ( (a == 0 && c == 0) || (b == 0 && d == 0) ) ) );
-                assert( sumH == 2 || ( sumH == 1 && ( (a == 0 && b == 0) || (c == 0 && d == 0) ) ) );
-                assert(a + b + c + d <= sum); // bitmaps are 0 or 1
-                // the following is an integer division, the result can be 0 or 1
-                dstBmPixStart[0] = (a + b + c + d) / sum;
-                assert(dstBmPixStart[0] == 0 || dstBmPixStart[0] == 1);
-            }
-        }
-    }
-} // halveRoIForDepth
-
-// code proofread and fixed by @devernay on 8/8/2014
-void
-Image::halveRoI(const RectI & roi,
-                bool copyBitMap,
-                Image* output) const
-{
-    switch ( getBitDepth() ) {
-    case eImageBitDepthByte:
-        halveRoIForDepth<unsigned char, 255>(roi, copyBitMap,  output);
-        break;
-    case eImageBitDepthShort:
-        halveRoIForDepth<unsigned short, 65535>(roi, copyBitMap, output);
-        break;
-    case eImageBitDepthHalf:
-        assert(false);
-        break;
-    case eImageBitDepthFloat:
-        halveRoIForDepth<float, 1>(roi, copyBitMap, output);
-        break;
-    case eImageBitDepthNone:
-        break;
-    }
-}
-
-// code proofread and fixed by @devernay on 8/8/2014
-template <typename PIX, int maxValue>
-void
-Image::halve1DImageForDepth(const RectI & roi,
-                            Image* output) const
-{
-    int width = roi.width();
-    int height = roi.height();
-
-    assert(width == 1 || height == 1); /// must be 1D
-    assert( output->getComponents() == getComponents() );
-
-    /// Take the lock for both bitmaps since we're about to read/write from them!
-    QWriteLocker k1(&output->_entryLock);
-    QReadLocker k2(&_entryLock);
-    const RectI & srcBounds = _bounds;
-    const RectI & dstBounds = output->_bounds;
-//    assert(dstBounds.x1 * 2 == roi.x1 &&
-//           dstBounds.y1 * 2 == roi.y1 &&
-//           (
-//               dstBounds.x2 * 2 == roi.x2 || // we halve in only 1 dimension
-//               dstBounds.y2 * 2 == roi.y2)
-//           );
-    int halfWidth = width / 2;
-    int halfHeight = height / 2;
-    if (height == 1) { //1 row
-        assert(width != 1); /// widthxheight can't be 1x1
-
-        const PIX* src = (const PIX*)pixelAt(roi.x1, roi.y1);
-        PIX* dst = (PIX*)output->pixelAt(dstBounds.x1, dstBounds.y1);
-        assert(src && dst);
-        for (int x = 0; x < halfWidth; ++x) {
-            for (int k = 0; k < _nbComponents; ++k) {
-                *dst++ = PIX( (float)( *src + *(src + _nbComponents) ) / 2. );
-                ++src;
-            }
-            src += _nbComponents;
-        }
-    } else if (width == 1) {
-        int rowSize = srcBounds.width() * _nbComponents;
-        const PIX* src = (const PIX*)pixelAt(roi.x1, roi.y1);
-        PIX* dst = (PIX*)output->pixelAt(dstBounds.x1, dstBounds.y1);
-        assert(src && dst);
-        for (int y = 0; y < halfHeight; ++y) {
-            for (int k = 0; k < _nbComponents; ++k) {
-                *dst++ = PIX( (float)( *src + (*src + rowSize) ) / 2. );
-                ++src;
-            }
-            src += rowSize;
-        }
-    }
-}
-
-// code proofread and fixed by @devernay on 8/8/2014
-void
-Image::halve1DImage(const RectI & roi,
-                    Image* output) const
-{
-    switch ( getBitDepth() ) {
-    case eImageBitDepthByte:
-        halve1DImageForDepth<unsigned char, 255>(roi, output);
-        break;
-    case eImageBitDepthShort:
-        halve1DImageForDepth<unsigned short, 65535>(roi, output);
-        break;
-    case eImageBitDepthHalf:
-        assert(false);
-        break;
-    case eImageBitDepthFloat:
-        halve1DImageForDepth<float, 1>(roi, output);
-        break;
-    case eImageBitDepthNone:
-        break;
-    }
-}
-
-// code proofread and fixed by @devernay on 8/8/2014
-void
-Image::downscaleMipMap(const RectD& dstRod,
-                       const RectI & roi,
-                       unsigned int fromLevel,
-                       unsigned int toLevel,
-                       bool copyBitMap,
-                       Image* output) const
-{
-    assert(getStorageMode() != eStorageModeGLTex);
-
-    ///You should not call this function with a level equal to 0.
-    assert(toLevel >  fromLevel);
-
-    assert(_bounds.x1 <= roi.x1 && roi.x2 <= _bounds.x2 &&
-           _bounds.y1 <= roi.y1 && roi.y2 <= _bounds.y2);
-    double par = getPixelAspectRatio();
-//    RectD roiCanonical;
-//    roi.toCanonical(fromLevel, par , dstRod, &roiCanonical);
-//    RectI dstRoI;
-//    roiCanonical.toPixelEnclosing(toLevel, par , &dstRoI);
-    unsigned int downscaleLvls = toLevel - fromLevel;
-
-    assert( !copyBitMap || _bitmap.getBitmap() );
-
-    RectI dstRoI  = roi.downscalePowerOfTwoSmallestEnclosing(downscaleLvls);
-    ImagePtr tmpImg( new Image( getComponents(), dstRod, dstRoI, toLevel, par, getBitDepth(), getPremultiplication(), getFieldingOrder(), true) );
-
-    buildMipMapLevel( dstRod, roi, downscaleLvls, copyBitMap, tmpImg.get() );
-
-    // check that the downscaled mipmap is inside the output image (it may not be equal to it)
-    assert(dstRoI.x1 >= output->_bounds.x1);
-    assert(dstRoI.x2 <= output->_bounds.x2);
-    assert(dstRoI.y1 >= output->_bounds.y1);
-    assert(dstRoI.y2 <= output->_bounds.y2);
-
-    ///Now copy the result of tmpImg into the output image
-    output->pasteFrom(*tmpImg, dstRoI, copyBitMap);
-}
-
-bool
-Image::checkForNaNs(const RectI& roi)
+int
+Image::sanitizeNonFiniteValues(const RectI& roi)
 {
     if (getBitDepth() != eImageBitDepthFloat) {
-        return false;
+        return 0;
     }
     if (getStorageMode() == eStorageModeGLTex) {
-        return false;
+        return 0;
     }
 
-    QWriteLocker k(&_entryLock);
-    unsigned int compsCount = getComponentsCount();
-    bool hasnan = false;
-    for (int y = roi.y1; y < roi.y2; ++y) {
-        float* pix = (float*)pixelAt(roi.x1, y);
-        float* const end = pix +  compsCount * roi.width();
-
-        for (; pix < end; ++pix) {
-            // we remove NaNs, but infinity values should pose no problem
-            // (if they do, please explain here which ones)
-            if (*pix != *pix) { // check for NaN
-                *pix = 1.;
-                hasnan = true;
-            }
-        }
-    }
-
-    return hasnan;
-}
-
-// code proofread and fixed by @devernay on 8/8/2014
-template <typename PIX, int maxValue>
-void
-Image::upscaleMipMapForDepth(const RectI & roi,
-                             unsigned int fromLevel,
-                             unsigned int toLevel,
-                             Image* output) const
-{
-    assert( getBitDepth() == output->getBitDepth() );
-    assert( (getBitDepth() == eImageBitDepthByte && sizeof(PIX) == 1) || (getBitDepth() == eImageBitDepthShort && sizeof(PIX) == 2) || (getBitDepth() == eImageBitDepthFloat && sizeof(PIX) == 4) );
-
-    ///You should not call this function with a level equal to 0.
-    assert(fromLevel > toLevel);
-
-    assert(roi.x1 <= _bounds.x1 && _bounds.x2 <= roi.x2 &&
-           roi.y1 <= _bounds.y1 && _bounds.y2 <= roi.y2);
-
-    ///The source rectangle, intersected to this image region of definition in pixels
-    RectD roiCanonical;
-    roi.toCanonical(fromLevel, _par, getRoD(), &roiCanonical);
-    RectI dstRoi;
-    roiCanonical.toPixelEnclosing(toLevel, _par, &dstRoi);
-
-    const RectI & srcRoi = roi;
-
-    dstRoi.intersect(output->_bounds, &dstRoi); //output may be a bit smaller than the upscaled RoI
-    int scale = 1 << (fromLevel - toLevel);
-
-    assert( output->getComponents() == getComponents() );
-
-    if (_nbComponents == 0) {
-        return;
+    // Only roi is locked, so that the tiles of the same image rendered concurrently are not serialized here
+    RegionLocker k(this, roi, true);
+    RectI realRoI;
+    if ( !roi.intersect(_bounds, &realRoI) ) {
+        return 0;
     }
-
-    QWriteLocker k1(&output->_entryLock);
-    QReadLocker k2(&_entryLock);
-    int srcRowSize = _bounds.width() * _nbComponents;
-    int dstRowSize = output->_bounds.width() * _nbComponents;
-    const PIX *src = (const PIX*)pixelAt(srcRoi.x1, srcRoi.y1);
-    PIX* dst = (PIX*)output->pixelAt(dstRoi.x1, dstRoi.y1);
-    assert(src && dst);
-
-    // algorithm: fill the first line of output, and replicate it as many times as necessary
-    // works even if dstRoi is not exactly a multiple of srcRoi (first/last column/line may not be complete)
-    int yi = srcRoi.y1;
-    int ycount; // how many lines should be filled
-    for (int yo = dstRoi.y1; yo < dstRoi.y2; ++yi, src += srcRowSize, yo += ycount, dst += ycount * dstRowSize) {
-        const PIX * const srcLineStart = src;
-        PIX * const dstLineBatchStart = dst;
-        ycount = scale - ((yo - dstRoi.y1) - (yi - srcRoi.y1) * scale); // how many lines should be filled
-        ycount = std::min(ycount, dstRoi.y2 - yo);
-        assert(0 < ycount && ycount <= scale);
-        int xi = srcRoi.x1;
-        int xcount = 0; // how many pixels should be filled
-        const PIX * srcPix = srcLineStart;
-        PIX * dstPixFirst = dstLineBatchStart;
-        // fill the first line
-        for (int xo = dstRoi.x1; xo < dstRoi.x2; ++xi, srcPix += _nbComponents, xo += xcount, dstPixFirst += xcount * _nbComponents) {
-            xcount = scale - ((xo - dstRoi.x1) - (xi - srcRoi.x1) * scale);
-            xcount = std::min(xcount, dstRoi.x2 - xo);
-            //assert(0 < xcount && xcount <= scale);
-            // replicate srcPix as many times as necessary
-            PIX * dstPix = dstPixFirst;
-            //assert((srcPix-(PIX*)pixelAt(srcRoi.x1, srcRoi.y1)) % components == 0);
-            for (int i = 0; i < xcount; ++i, dstPix += _nbComponents) {
-                assert( ( dstPix - (PIX*)output->pixelAt(dstRoi.x1, dstRoi.y1) ) % _nbComponents == 0 );
-                assert(dstPix >= (PIX*)output->pixelAt(xo, yo) && dstPix < (PIX*)output->pixelAt(xo, yo) + xcount * _nbComponents);
-                for (int c = 0; c < _nbComponents; ++c) {
-                    dstPix[c] = srcPix[c];
-                }
-            }
-            //assert(dstPix == dstPixFirst + xcount*components);
-        }
-        PIX * dstLineStart = dstLineBatchStart + dstRowSize; // first line was filled already
-        // now replicate the line as many times as necessary
-        for (int i = 1; i < ycount; ++i, dstLineStart += dstRowSize) {
-            std::copy(dstLineBatchStart, dstLineBatchStart + dstRowSize, dstLineStart);
-        }
+    int rowSize = (int)getComponentsCount() * realRoI.width();
+    int count = 0;
+    for (int y = realRoI.y1; y < realRoI.y2; ++y) {
+        count += ImageKernels::sanitizeNonFiniteRow( (float*)pixelAt(realRoI.x1, y), rowSize );
     }
-} // upscaleMipMapForDepth
-
-// code proofread and fixed by @devernay on 8/8/2014
-void
-Image::upscaleMipMap(const RectI & roi,
-                     unsigned int fromLevel,
-                     unsigned int toLevel,
-                     Image* output) const
-{
-    assert(getStorageMode() != eStorageModeGLTex);
 
-    switch ( getBitDepth() ) {
-    case eImageBitDepthByte:
-        upscaleMipMapForDepth<unsigned char, 255>(roi, fromLevel, toLevel, output);
-        break;
-    case eImageBitDepthShort:
-        upscaleMipMapForDepth<unsigned short, 65535>(roi, fromLevel, toLevel, output);
-        break;
-    case eImageBitDepthHalf:
-        assert(false);
-        break;
-    case eImageBitDepthFloat:
-        upscaleMipMapForDepth<float, 1>(roi, fromLevel, toLevel, output);
-        break;
-    case eImageBitDepthNone:
-        break;
-    }
+    return count;
 }
 
-// code proofread and fixed by @devernay on 8/8/2014
-void
-Image::buildMipMapLevel(const RectD& dstRoD,
-                        const RectI & roi,
-                        unsigned int level,
-                        bool copyBitMap,
-                        Image* output) const
-{
-    ///The last mip map level we will make with closestPo2
-    RectI lastLevelRoI = roi.downscalePowerOfTwoSmallestEnclosing(level);
-
-    ///The output image must contain the last level roi
-    assert( output->getBounds().contains(lastLevelRoI) );
-
-    assert( output->getComponents() == getComponents() );
-
-    if (level == 0) {
-        ///Just copy the roi and return
-        output->pasteFrom(*this, roi, copyBitMap);
-
-        return;
-    }
-
-    const Image* srcImg = this;
-    Image* dstImg = NULL;
-    bool mustFreeSrc = false;
-    RectI previousRoI = roi;
-    ///Build all the mipmap levels until we reach the one we are interested in
-    for (unsigned int i = 1; i <= level; ++i) {
-        ///Halve the smallest enclosing po2 rect as we need to render a minimum of the renderWindow
-        RectI halvedRoI = previousRoI.downscalePowerOfTwoSmallestEnclosing(1);
-
-        ///Allocate an image with half the size of the source image
-        dstImg = new Image( getComponents(), dstRoD, halvedRoI, getMipMapLevel() + i, getPixelAspectRatio(), getBitDepth(), getPremultiplication(), getFieldingOrder(), true);
-
-        ///Half the source image into dstImg.
-        ///We pass the closestPo2 roi which might not be the entire size of the source image
-        ///If the source image'sroi was originally a po2.
-        srcImg->halveRoI(previousRoI, copyBitMap, dstImg);
-
-        ///Clean-up, we should use shared_ptrs for safety
-        if (mustFreeSrc) {
-            delete srcImg;
-        }
-
-        ///Switch for next pass
-        previousRoI = halvedRoI;
-        srcImg = dstImg;
-        mustFreeSrc = true;
-    }
-
-    assert(srcImg->getBounds() == lastLevelRoI);
-
-    ///Finally copy the last mipmap level into output.
-    output->pasteFrom( *srcImg, srcImg->getBounds(), copyBitMap);
-
-    ///Clean-up, we should use shared_ptrs for safety
-    if (mustFreeSrc) {
-        delete srcImg;
-    }
-} // buildMipMapLevel
-
 double
 Image::getScaleFromMipMapLevel(unsigned int level)
 {
@@ -2344,19 +1875,17 @@ Image::premultInternal(const RectI& roi)
 
     assert(getComponentsCount() == 4);
 
+    if ( renderWindow.isNull() ) {
+        return;
+    }
     int srcRowElements = 4 * _bounds.width();
+    int rowPixels = renderWindow.x2 - renderWindow.x1;
     PIX* dstPix = (PIX*)acc.pixelAt(renderWindow.x1, renderWindow.y1);
-    for ( int y = renderWindow.y1; y < renderWindow.y2; ++y, dstPix += (srcRowElements - (renderWindow.x2 - renderWindow.x1) * 4) ) {
-        for (int x = renderWindow.x1; x < renderWindow.x2; ++x, dstPix += 4) {
-            for (int c = 0; c < 3; ++c) {
-                if (doPremult) {
-                    dstPix[c] = PIX(float(dstPix[c]) * dstPix[3]);
-                } else {
-                    if (dstPix[3] != 0) {
-                        dstPix[c] = PIX( dstPix[c] / float(dstPix[3]) );
-                    }
-                }
-            }
+    for (int y = renderWindow.y1; y < renderWindow.y2; ++y, dstPix += srcRowElements) {
+        if (doPremult) {
+            ImageKernels::premultRow(dstPix, rowPixels);
+        } else {
+            ImageKernels::unpremultRow(dstPix, rowPixels);
         }
     }
 }
@@ -42,6 +42,7 @@ CLANG_DIAG_ON(deprecated)
 #include "Engine/ImageKey.h"
 #include "Engine/ImageComponents.h"
 #include "Engine/ImageParams.h"
+#include "Engine/ImageRegionLock.h"
 #include "Engine/CacheEntry.h"
 #include "Engine/OutputSchedulerThread.h"
 #include "Engine/RectD.h"
@@ -415,36 +416,61 @@ public:
      * @brief Lock the image for reading, while this object is living, the image buffer can't be written to.
      * You must ensure that the image will live as long as this object lives otherwise the pointer will be invalidated.
      * You may no longer use the pointer returned by pixelAt once this object dies.
+     * When a region is given, only the pixels of this region can't be written to: the other threads may keep on
+     * writing the rest of the image meanwhile.
      **/
     class ReadAccess
         : public GenericAccess
     {
         const Image* img;
+        RectI region;
+        U64 regionId;
 
 public:
 
         ReadAccess(const Image* img)
             : GenericAccess()
             , img(img)
+            , region()
+            , regionId(0)
         {
             if (img) {
                 img->lockForRead();
+                region = img->_bounds;
+                regionId = img->_regionLock.lockForRead(region);
+            }
+        }
+
+        ReadAccess(const Image* img,
+                   const RectI& region)
+            : GenericAccess()
+            , img(img)
+            , region(region)
+            , regionId(0)
+        {
+            if (img) {
+                img->lockForRead();
+                regionId = img->_regionLock.lockForRead(region);
             }
         }
 
         ReadAccess(const ReadAccess& other)
             : GenericAccess()
             , img(other.img)
+            , region(other.region)
+            , regionId(0)
         {
             //This is a recursive lock so it doesn't matter if we take it twice
             if (img) {
                 img->lockForRead();
+                regionId = img->_regionLock.lockForRead(region);
             }
         }
 
         virtual ~ReadAccess()
         {
             if (img) {
+                img->_regionLock.unlock(regionId);
                 img->unlock();
             }
         }
@@ -470,34 +496,57 @@ public:
     };
 
     /**
-     * @brief Lock the image for writing, while this object is living, the image buffer can't be read.
+     * @brief Lock the image for writing, while this object is living, the image buffer can't be read nor written by other threads.
      * You must ensure that the image will live as long as this object lives otherwise the pointer will be invalidated.
      * You may no longer use the pointer returned by pixelAt once this object dies.
+     * When a region is given, only the pixels of this region are locked: the other threads rendering disjoint tiles
+     * of the same image do not wait for this one.
      **/
     class WriteAccess
         : public GenericAccess
     {
         Image* img;
+        RectI region;
+        U64 regionId;
 
 public:
 
         WriteAccess(Image* img)
             : GenericAccess()
             , img(img)
+            , region()
+            , regionId(0)
         {
-            img->lockForWrite();
+            img->lockForRead();
+            region = img->_bounds;
+            regionId = img->_regionLock.lockForWrite(region);
+        }
+
+        WriteAccess(Image* img,
+                    const RectI& region)
+            : GenericAccess()
+            , img(img)
+            , region(region)
+            , regionId(0)
+        {
+            img->lockForRead();
+            regionId = img->_regionLock.lockForWrite(region);
         }
 
         WriteAccess(const WriteAccess& other)
             : GenericAccess()
             , img(other.img)
+            , region(other.region)
+            , regionId(0)
         {
             //This is a recursive lock so it doesn't matter if we take it twice
-            img->lockForWrite();
+            img->lockForRead();
+            regionId = img->_regionLock.lockForWrite(region);
         }
 
         virtual ~WriteAccess()
         {
+            img->_regionLock.unlock(regionId);
             img->unlock();
         }
 
@@ -596,6 +645,40 @@ private:
         _entryLock.unlock();
     }
 
+    /**
+     * @brief Locks a region of the pixels and of the bitmap of an image while this object is living.
+     * The image lock is taken for reading only, to prevent the buffer from being reallocated meanwhile:
+     * the threads writing disjoint regions of the same image do not wait for each other.
+     * The image may be NULL, in which case nothing is locked.
+     **/
+    class RegionLocker
+    {
+        const Image* _img;
+        U64 _regionId;
+
+public:
+
+        RegionLocker(const Image* img,
+                     const RectI& region,
+                     bool write)
+            : _img(img)
+            , _regionId(0)
+        {
+            if (_img) {
+                _img->lockForRead();
+                _regionId = write ? _img->_regionLock.lockForWrite(region) : _img->_regionLock.lockForRead(region);
+            }
+        }
+
+        ~RegionLocker()
+        {
+            if (_img) {
+                _img->_regionLock.unlock(_regionId);
+                _img->unlock();
+            }
+        }
+    };
+
     template <typename SRCPIX, typename DSTPIX, int srcMaxValue, int dstMaxValue>
     static void convertToFormatInternal_sameComps(const RectI & renderWindow,
                                                   const Image & srcImg,
@@ -672,7 +755,7 @@ public:
         if (!_useBitmap) {
             return;
         }
-        QReadLocker locker(&_entryLock);
+        RegionLocker locker(this, regionOfInterest, false);
         _bitmap.minimalNonMarkedRects_trimap(regionOfInterest, ret, isBeingRenderedElsewhere);
     }
 
@@ -683,7 +766,7 @@ public:
         if (!_useBitmap) {
             return;
         }
-        QReadLocker locker(&_entryLock);
+        RegionLocker locker(this, regionOfInterest, false);
         _bitmap.minimalNonMarkedRects(regionOfInterest, ret);
     }
 
@@ -694,7 +777,7 @@ public:
         if (!_useBitmap) {
             return regionOfInterest;
         }
-        QReadLocker locker(&_entryLock);
+        RegionLocker locker(this, regionOfInterest, false);
 
         return _bitmap.minimalNonMarkedBbox_trimap(regionOfInterest, isBeingRenderedElsewhere);
     }
@@ -705,7 +788,7 @@ public:
         if (!_useBitmap) {
             return regionOfInterest;
         }
-        QReadLocker locker(&_entryLock);
+        RegionLocker locker(this, regionOfInterest, false);
 
         return _bitmap.minimalNonMarkedBbox(regionOfInterest);
     }
@@ -719,7 +802,7 @@ public:
         }
         RectI ret;
         {
-            QReadLocker locker(&_entryLock);
+            RegionLocker locker(this, regionOfInterest, false);
             ret = _bitmap.minimalNonMarkedBbox_trimap(regionOfInterest, isBeingRenderedElsewhere);
         }
         markForRendering(ret);
@@ -734,7 +817,7 @@ public:
         if (!_useBitmap) {
             return;
         }
-        QWriteLocker locker(&_entryLock);
+        RegionLocker locker(this, roi, true);
         RectI intersection;
         _bounds.intersect(roi, &intersection);
         _bitmap.markForRendered(intersection);
@@ -747,7 +830,7 @@ public:
         if (!_useBitmap) {
             return;
         }
-        QWriteLocker locker(&_entryLock);
+        RegionLocker locker(this, roi, true);
         RectI intersection;
         _bounds.intersect(roi, &intersection);
         _bitmap.markForRendering(intersection);
@@ -760,7 +843,7 @@ public:
         if (!_useBitmap) {
             return;
         }
-        QWriteLocker locker(&_entryLock);
+        RegionLocker locker(this, roi, true);
         RectI intersection;
         _bounds.intersect(roi, &intersection);
         _bitmap.clear(intersection);
@@ -806,12 +889,17 @@ public:
      * This function will adjust roi to the largest enclosed rectangle for the
      * given mipmap level,
      * and then computes the mipmap of the given level of that rectangle.
+     * All the levels are built in a single pass over strips of rows, split across the global thread pool
+     * when it has idle threads. The intermediate levels of a strip are never allocated as images.
+     * With eMipMapFilterTent, the pixels around roi that the filter needs are read too when the bitmap tells they are
+     * rendered, so that tiles downscaled separately match. Otherwise the filter weights are renormalized at the edges of roi.
      **/
     void downscaleMipMap(const RectD& rod,
                          const RectI & roi,
                          unsigned int fromLevel, unsigned int toLevel,
                          bool copyBitMap,
-                         Image* output) const;
+                         Image* output,
+                         MipMapFilterEnum filter = eMipMapFilterBox) const;
 
     /**
      * @brief Upscales a portion of this image into output.
@@ -927,10 +1015,31 @@ public:
                        const OSGLContextPtr& glContext = OSGLContextPtr() );
 
     /**
-     * @brief Eeturns true if image contains NaNs or infinite values, and fix them.
-     * Currently, no OpenGL implementation is provided.
+     * @brief Same as copyUnProcessedChannels() followed by applyMaskMix() (if doMaskMix is true) with the same original image.
+     * For images in RAM, both are applied in a single pass over the pixels.
+     * If nbNonFiniteValues is not NULL, the NaN and infinite values are also replaced in that pass as with sanitizeNonFiniteValues()
+     * called before the copy and the mix, and their number is returned in nbNonFiniteValues.
+     **/
+    void copyUnProcessedChannelsAndApplyMaskMix( const RectI& roi,
+                                                 ImagePremultiplicationEnum outputPremult,
+                                                 ImagePremultiplicationEnum originalImagePremult,
+                                                 std::bitset<4> processChannels,
+                                                 const ImagePtr& originalImage,
+                                                 bool ignorePremult,
+                                                 bool doMaskMix,
+                                                 const Image* maskImg,
+                                                 bool masked,
+                                                 bool maskInvert,
+                                                 float mix,
+                                                 int* nbNonFiniteValues,
+                                                 const OSGLContextPtr& glContext = OSGLContextPtr() );
+
+    /**
+     * @brief Replaces the NaN values in roi by 1 and the infinite values by the largest finite float of the same sign.
+     * Only float images in RAM are handled, other images are left untouched.
+     * @returns The number of values replaced
      */
-    bool checkForNaNs(const RectI& roi) WARN_UNUSED_RETURN;
+    int sanitizeNonFiniteValues(const RectI& roi) WARN_UNUSED_RETURN;
 
     void copyBitmapRowPortion(int x1, int x2, int y, const Image& other);
 
@@ -948,121 +1057,45 @@ public:
 
 private:
 
-    template<int srcNComps, int dstNComps, typename PIX, int maxValue, bool masked, bool maskInvert>
-    void applyMaskMixForMaskInvert(const RectI& roi,
-                                   const Image* maskImg,
-                                   const Image* originalImg,
-                                   float mix);
-
-
-    template<int srcNComps, int dstNComps, typename PIX, int maxValue, bool masked>
-    void applyMaskMixForMasked(const RectI& roi,
-                               const Image* maskImg,
-                               const Image* originalImg,
-                               bool maskInvert,
-                               float mix);
-
-    template<int srcNComps, int dstNComps, typename PIX, int maxValue>
-    void applyMaskMixForDepth(const RectI& roi,
-                              const Image* maskImg,
-                              const Image* originalImg,
-                              bool masked,
-                              bool maskInvert,
-                              float mix);
-
-
-    template<int srcNComps, int dstNComps>
-    void applyMaskMixForDstComponents(const RectI& roi,
-                                      const Image* maskImg,
-                                      const Image* originalImg,
-                                      bool masked,
-                                      bool maskInvert,
-                                      float mix);
-
-    template<int srcNComps>
-    void applyMaskMixForSrcComponents(const RectI& roi,
-                                      const Image* maskImg,
-                                      const Image* originalImg,
-                                      bool masked,
-                                      bool maskInvert,
-                                      float mix);
-
-    template <typename PIX, int maxValue, int srcNComps, int dstNComps, bool doR, bool doG, bool doB, bool doA, bool premult, bool originalPremult, bool ignorePremult>
-    void copyUnProcessedChannelsForPremult(std::bitset<4> processChannels,
-                                           const RectI& roi,
-                                           const ImagePtr& originalImage);
-
-    template <typename PIX, int maxValue, int srcNComps, int dstNComps, bool ignorePremult>
-    void copyUnProcessedChannelsForPremult(bool premult, bool originalPremult,
-                                           std::bitset<4> processChannels,
-                                           const RectI& roi,
-                                           const ImagePtr& originalImage);
-
-    template <typename PIX, int maxValue, int srcNComps, int dstNComps, bool doR, bool doG, bool doB, bool doA>
-    void copyUnProcessedChannelsForChannels(const std::bitset<4> processChannels,
-                                            const bool premult,
-                                            const RectI& roi,
-                                            const ImagePtr& originalImage,
-                                            const bool originalPremult,
-                                            const bool ignorePremult);
-
-    template <typename PIX, int maxValue, int srcNComps, int dstNComps>
-    void copyUnProcessedChannelsForChannels(const std::bitset<4> processChannels,
-                                            const bool premult,
-                                            const RectI& roi,
-                                            const ImagePtr& originalImage,
-                                            const bool originalPremult,
-                                            const bool ignorePremult);
-
-
-    template <typename PIX, int maxValue, int srcNComps, int dstNComps>
-    void copyUnProcessedChannelsForComponents(bool premult,
-                                              const RectI& roi,
-                                              const std::bitset<4> processChannels,
-                                              const ImagePtr& originalImage,
-                                              const bool originalPremult,
-                                              const bool ignorePremult);
-
-    template <typename PIX, int maxValue>
-    void copyUnProcessedChannelsForDepth(bool premult,
-                                         const RectI& roi,
-                                         std::bitset<4> processChannels,
-                                         const ImagePtr& originalImage,
-                                         bool originalPremult,
-                                         bool ignorePremult);
-
-
     /**
-     * @brief Given the output buffer,the region of interest and the mip map level, this
-     * function computes the mip map of this image in the given roi.
-     * If roi is NOT a power of 2, then it will be rounded to the closest power of 2.
+     * @brief Copies the channels of originalImg that are not marked in processChannels (if doCopy) then masks and
+     * mixes with originalImg (if doMaskMix), one row at a time. The caller must lock the images.
+     * If nbNonFiniteValues is not NULL, the NaN and infinite values of each row are then replaced and added to it.
      **/
-    void buildMipMapLevel(const RectD& dstRoD, const RectI & roiCanonical, unsigned int level, bool copyBitMap,
-                          Image* output) const;
+    void copyChannelsAndMaskMixRows(const RectI& roi,
+                                    const Image* originalImg,
+                                    bool doCopy,
+                                    std::bitset<4> processChannels,
+                                    bool doMaskMix,
+                                    const Image* maskImg,
+                                    bool masked,
+                                    bool maskInvert,
+                                    float mix,
+                                    int* nbNonFiniteValues);
 
-
-    /**
-     * @brief Halve the given roi of this image into output.
-     * If the RoI bounds are odd, the largest enclosing RoI with even bounds will be considered.
-     **/
-    void halveRoI(const RectI & roi, bool copyBitMap,
-                  Image* output) const;
+    template <typename PIX>
+    void copyChannelsAndMaskMixForDepth(const RectI& roi,
+                                        const Image* originalImg,
+                                        bool doCopy,
+                                        std::bitset<4> processChannels,
+                                        bool doMaskMix,
+                                        const Image* maskImg,
+                                        bool masked,
+                                        bool maskInvert,
+                                        float mix,
+                                        int* nbNonFiniteValues);
 
 
-    template <typename PIX, int maxValue>
-    void halveRoIForDepth(const RectI & roi,
-                          bool copyBitMap,
-                          Image* output) const;
+    template <typename PIX>
+    void downscaleMipMapForDepth(const RectI & roi, unsigned int levels, bool copyBitMap, MipMapFilterEnum filter, Image* output) const;
 
     /**
-     * @brief Same as halveRoI but for 1D only (either width == 1 or height == 1)
+     * @brief Returns the source pixels read by the tent filter to downscale roi by the given number of levels:
+     * roi, extended on each side by the neighbour pixels that the filter needs if they are all rendered.
      **/
-    void halve1DImage(const RectI & roi, Image* output) const;
+    RectI getTentSampleBounds(const RectI& roi, unsigned int levels) const;
 
-    template <typename PIX, int maxValue>
-    void halve1DImageForDepth(const RectI & roi, Image* output) const;
-
-    template <typename PIX, int maxValue>
+    template <typename PIX>
     void upscaleMipMapForDepth(const RectI & roi, unsigned int fromLevel, unsigned int toLevel, Image* output) const;
 
     template<typename PIX>
@@ -1088,6 +1121,9 @@ private:
     ImagePremultiplicationEnum _premult;
     bool _useBitmap;
     int _nbComponents;
+
+    // Synchronizes the accesses to the pixels and the bitmap, see RegionLocker
+    mutable ImageRegionLock _regionLock;
 };
 
 //template <> inline unsigned char clamp(unsigned char v) { return v; }
@@ -27,6 +27,7 @@
 #include <algorithm> // min, max
 #include <cassert>
 #include <stdexcept>
+#include <vector>
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
@@ -132,6 +133,25 @@ lutFromColorspace(ViewerColorSpaceEnum cs)
     return lut;
 }
 
+/**
+ * @brief Converts in place n color values to linear from srcLut, then from linear to dstLut.
+ * The source values must be floats. This uses the row functions of the luts which are much faster
+ * than converting values one by one.
+ **/
+static void
+convertFloatRowForColorSpace(float* values,
+                             int n,
+                             const Color::Lut* srcLut,
+                             const Color::Lut* dstLut)
+{
+    if (srcLut) {
+        srcLut->fromColorSpaceFloatToLinearFloat(values, values, n);
+    }
+    if (dstLut) {
+        dstLut->toColorSpaceFloatFromLinearFloat(values, values, n);
+    }
+}
+
 ///Fast version when components are the same
 template <typename SRCPIX, typename DSTPIX, int srcMaxValue, int dstMaxValue>
 void
@@ -162,6 +182,48 @@ Image::convertToFormatInternal_sameComps(const RectI & renderWindow,
     if ( intersection.isNull() ) {
         return;
     }
+
+    if ( (dstMaxValue == 1) && (srcLut || dstLut) ) {
+        // Float output: there is no error diffusion, convert the color channels of each row at once.
+        // Alpha is linear and is converted separately.
+        const int nColorComps = nComp == 4 ? 3 : nComp;
+        const int width = intersection.width();
+        std::vector<float> rowBuffer(width * nColorComps);
+        for (int y = 0; y < intersection.height(); ++y) {
+            const SRCPIX* srcPixels = (const SRCPIX*)srcImg.pixelAt(intersection.x1, intersection.y1 + y);
+            DSTPIX* dstPixels = (DSTPIX*)dstImg.pixelAt(intersection.x1, intersection.y1 + y);
+            float* buf = &rowBuffer.front();
+            for (int x = 0; x < width; ++x) {
+                for (int k = 0; k < nColorComps; ++k, ++buf) {
+                    const SRCPIX pix = srcPixels[x * nComp + k];
+                    if (srcLut && (srcMaxValue == 255)) {
+                        *buf = srcLut->fromColorSpaceUint8ToLinearFloatFast(pix);
+                    } else if (srcLut && (srcMaxValue == 65535)) {
+                        *buf = srcLut->fromColorSpaceUint16ToLinearFloatFast(pix);
+                    } else {
+                        *buf = convertPixelDepth<SRCPIX, float>(pix);
+                    }
+                }
+            }
+            // Integer sources were already converted to linear with the tables
+            convertFloatRowForColorSpace(&rowBuffer.front(), (int)rowBuffer.size(), srcMaxValue == 1 ? srcLut : 0, dstLut);
+            buf = &rowBuffer.front();
+            for (int x = 0; x < width; ++x) {
+                for (int k = 0; k < nColorComps; ++k, ++buf) {
+                    dstPixels[x * nComp + k] = convertPixelDepth<float, DSTPIX>(*buf);
+                }
+                if (nComp == 4) {
+                    dstPixels[x * nComp + 3] = convertPixelDepth<SRCPIX, DSTPIX>(srcPixels[x * nComp + 3]);
+                }
+            }
+            if (copyBitmap) {
+                dstImg.copyBitmapRowPortion(intersection.x1, intersection.x2, intersection.y1 + y, srcImg);
+            }
+        }
+
+        return;
+    }
+
     for (int y = 0; y < intersection.height(); ++y) {
         // coverity[dont_call]
         int start = rand() % intersection.width();
@@ -306,6 +368,55 @@ Image::convertToFormatInternalForColorSpace(const RectI & renderWindow,
     const Color::Lut* const srcLut = useColorspaces ? lutFromColorspace( (ViewerColorSpaceEnum)srcColorSpace ) : 0;
     const Color::Lut* const dstLut = useColorspaces ? lutFromColorspace( (ViewerColorSpaceEnum)dstColorSpace ) : 0;
 
+    if ( (dstMaxValue == 1) && (dstNComps > 1) && (srcNComps > 1) && (srcLut || dstLut) ) {
+        // Float output: there is no error diffusion, convert the color channels of each row at once
+        const int nColorComps = std::min(3, dstNComps);
+        const int width = renderWindow.width();
+        // Floats that need the srcLut to be applied (unpremultiplied or float sources) are converted with the row function
+        const bool srcLutOnRow = requiresUnpremult || (srcMaxValue == 1);
+        std::vector<float> rowBuffer(width * nColorComps);
+        for (int y = 0; y < renderWindow.height(); ++y) {
+            const SRCPIX* srcPixels = (const SRCPIX*)srcImg.pixelAt(renderWindow.x1, renderWindow.y1 + y);
+            DSTPIX* dstPixels = (DSTPIX*)dstImg.pixelAt(renderWindow.x1, renderWindow.y1 + y);
+            float* buf = &rowBuffer.front();
+            for (int x = 0; x < width; ++x) {
+                const SRCPIX* srcPix = srcPixels + x * srcNComps;
+                const float alphaForUnPremult = requiresUnpremult ? convertPixelDepth<SRCPIX, float>(srcPix[srcNComps - 1]) : 1.f;
+                for (int k = 0; k < nColorComps; ++k, ++buf) {
+                    // XY sources have no third channel
+                    const SRCPIX sourcePixel = k < srcNComps ? srcPix[k] : 0;
+                    if (requiresUnpremult) {
+                        float pixFloat = convertPixelDepth<SRCPIX, float>(sourcePixel);
+                        *buf = alphaForUnPremult == 0.f ? 0. : pixFloat / alphaForUnPremult;
+                    } else if (srcLut && (srcMaxValue == 255)) {
+                        *buf = srcLut->fromColorSpaceUint8ToLinearFloatFast(sourcePixel);
+                    } else if (srcLut && (srcMaxValue == 65535)) {
+                        *buf = srcLut->fromColorSpaceUint16ToLinearFloatFast(sourcePixel);
+                    } else {
+                        *buf = convertPixelDepth<SRCPIX, float>(sourcePixel);
+                    }
+                }
+            }
+            convertFloatRowForColorSpace(&rowBuffer.front(), (int)rowBuffer.size(), srcLutOnRow ? srcLut : 0, dstLut);
+            buf = &rowBuffer.front();
+            for (int x = 0; x < width; ++x) {
+                DSTPIX* dstPix = dstPixels + x * dstNComps;
+                for (int k = 0; k < nColorComps; ++k, ++buf) {
+                    dstPix[k] = convertPixelDepth<float, DSTPIX>(*buf);
+                }
+                if (dstNComps == 4) {
+                    // For alpha channel, fill with 1, we reach here only if converting RGB-->RGBA or XY--->RGBA
+                    dstPix[3] = convertPixelDepth<float, DSTPIX>(useAlpha0 ? 0.f : 1.f);
+                }
+            }
+        }
+        if (copyBitmap) {
+            dstImg.copyBitmapPortion(renderWindow, srcImg);
+        }
+
+        return;
+    }
+
     for (int y = 0; y < renderWindow.height(); ++y) {
         ///Start of the line for error diffusion
         // coverity[dont_call]
@@ -674,8 +785,8 @@ Image::convertToFormatCommon(const RectI & renderWindow,
                              bool requiresUnpremult,
                              Image* dstImg) const
 {
-    QWriteLocker k(&dstImg->_entryLock);
-    QReadLocker k2(&_entryLock);
+    RegionLocker k(dstImg, renderWindow, true);
+    RegionLocker k2(this, renderWindow, false);
 
     assert( _bounds.contains(renderWindow) &&  dstImg->_bounds.contains(renderWindow) );
 
@@ -0,0 +1,678 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "ImageKernels.h"
+
+#include <algorithm> // min, max
+#include <cfloat> // FLT_MAX
+#include <cstring> // for std::memcpy, std::memset
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NATRON_IMAGE_KERNELS_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+NATRON_NAMESPACE_ENTER;
+
+namespace ImageKernels {
+namespace {
+/*
+ * Conversions between the pixel types and floats. Integer values are clamped then truncated, as Image::clampIfInt does.
+ * With SSE2, 4 values are converted at once.
+ */
+template <typename PIX>
+struct PixelTraits;
+
+template <>
+struct PixelTraits<float>
+{
+    static float maxValue() { return 1.f; }
+
+    static float fromFloat(float v) { return v; }
+
+#ifdef NATRON_IMAGE_KERNELS_USE_SSE2
+    static __m128 load4(const float* p) { return _mm_loadu_ps(p); }
+
+    static void store4(float* p,
+                       __m128 v) { _mm_storeu_ps(p, v); }
+
+    // Lane mask selecting the channels of one RGBA pixel, repeated over 16 bytes
+    static __m128i channelsMask(bool r,
+                                bool g,
+                                bool b,
+                                bool a)
+    {
+        return _mm_set_epi32(a ? -1 : 0, b ? -1 : 0, g ? -1 : 0, r ? -1 : 0);
+    }
+
+#endif
+};
+
+template <>
+struct PixelTraits<unsigned short>
+{
+    static float maxValue() { return 65535.f; }
+
+    static unsigned short fromFloat(float v) { return (unsigned short)std::min(std::max(0.f, v), 65535.f); }
+
+#ifdef NATRON_IMAGE_KERNELS_USE_SSE2
+    static __m128 load4(const unsigned short* p)
+    {
+        __m128i i = _mm_loadl_epi64( (const __m128i*)p );
+
+        return _mm_cvtepi32_ps( _mm_unpacklo_epi16( i, _mm_setzero_si128() ) );
+    }
+
+    static void store4(unsigned short* p,
+                       __m128 v)
+    {
+        v = _mm_min_ps( _mm_max_ps( v, _mm_setzero_ps() ), _mm_set1_ps(65535.f) );
+        // SSE2 only has a signed saturating pack: shift to the signed range and back
+        __m128i i = _mm_sub_epi32( _mm_cvttps_epi32(v), _mm_set1_epi32(32768) );
+        i = _mm_xor_si128( _mm_packs_epi32(i, i), _mm_set1_epi16( (short)0x8000 ) );
+        _mm_storel_epi64( (__m128i*)p, i );
+    }
+
+    static __m128i channelsMask(bool r,
+                                bool g,
+                                bool b,
+                                bool a)
+    {
+        short sr = r ? -1 : 0, sg = g ? -1 : 0, sb = b ? -1 : 0, sa = a ? -1 : 0;
+
+        return _mm_set_epi16(sa, sb, sg, sr, sa, sb, sg, sr);
+    }
+
+#endif
+};
+
+template <>
+struct PixelTraits<unsigned char>
+{
+    static float maxValue() { return 255.f; }
+
+    static unsigned char fromFloat(float v) { return (unsigned char)std::min(std::max(0.f, v), 255.f); }
+
+#ifdef NATRON_IMAGE_KERNELS_USE_SSE2
+    static __m128 load4(const unsigned char* p)
+    {
+        int bits;
+
+        std::memcpy( &bits, p, sizeof(int) );
+        __m128i i = _mm_unpacklo_epi8( _mm_cvtsi32_si128(bits), _mm_setzero_si128() );
+
+        return _mm_cvtepi32_ps( _mm_unpacklo_epi16( i, _mm_setzero_si128() ) );
+    }
+
+    static void store4(unsigned char* p,
+                       __m128 v)
+    {
+        v = _mm_min_ps( _mm_max_ps( v, _mm_setzero_ps() ), _mm_set1_ps(255.f) );
+        __m128i i = _mm_cvttps_epi32(v);
+        i = _mm_packs_epi32(i, i);
+        i = _mm_packus_epi16(i, i);
+        int bits = _mm_cvtsi128_si32(i);
+        std::memcpy( p, &bits, sizeof(int) );
+    }
+
+    static __m128i channelsMask(bool r,
+                                bool g,
+                                bool b,
+                                bool a)
+    {
+        char cr = r ? -1 : 0, cg = g ? -1 : 0, cb = b ? -1 : 0, ca = a ? -1 : 0;
+
+        return _mm_set_epi8(ca, cb, cg, cr, ca, cb, cg, cr, ca, cb, cg, cr, ca, cb, cg, cr);
+    }
+
+#endif
+};
+
+#ifdef NATRON_IMAGE_KERNELS_USE_SSE2
+template <int k>
+inline __m128
+broadcastLane(__m128 v)
+{
+    return _mm_shuffle_ps( v, v, _MM_SHUFFLE(k, k, k, k) );
+}
+
+// Mixes one RGBA pixel with a = alpha and b = 1 - alpha in all the lanes
+template <typename PIX>
+inline void
+maskMixPixel4(PIX* dst,
+              const PIX* src,
+              __m128 a,
+              __m128 b)
+{
+    __m128 v = _mm_mul_ps(PixelTraits<PIX>::load4(dst), a);
+
+    if (src) {
+        v = _mm_add_ps( v, _mm_mul_ps( b, PixelTraits<PIX>::load4(src) ) );
+    }
+    PixelTraits<PIX>::store4(dst, v);
+}
+
+#endif
+
+template <typename PIX>
+void
+maskMixRowScalar(PIX* dst,
+                 int dstNComps,
+                 const PIX* src,
+                 int srcNComps,
+                 const PIX* mask,
+                 bool masked,
+                 bool maskInvert,
+                 float mix,
+                 int n)
+{
+    int nMixed = src ? std::min(dstNComps, srcNComps) : dstNComps;
+
+    for (int i = 0; i < n; ++i, dst += dstNComps) {
+        float alpha = mix;
+        if (masked) {
+            float maskScale;
+            if (!mask) {
+                maskScale = maskInvert ? 1.f : 0.f;
+            } else {
+                maskScale = mask[i] / PixelTraits<PIX>::maxValue();
+                if (maskInvert) {
+                    maskScale = 1.f - maskScale;
+                }
+            }
+            alpha = mix * maskScale;
+        }
+        if (src) {
+            for (int c = 0; c < nMixed; ++c) {
+                float v = float(dst[c]) * alpha + (1.f - alpha) * float(src[c]);
+                dst[c] = PixelTraits<PIX>::fromFloat(v);
+            }
+            src += srcNComps;
+        } else {
+            for (int c = 0; c < nMixed; ++c) {
+                float v = float(dst[c]) * alpha;
+                dst[c] = PixelTraits<PIX>::fromFloat(v);
+            }
+        }
+    }
+}
+
+template <typename PIX>
+void
+maskMixRowImpl(PIX* dst,
+               int dstNComps,
+               const PIX* src,
+               int srcNComps,
+               const PIX* mask,
+               bool masked,
+               bool maskInvert,
+               float mix,
+               int n)
+{
+    int i = 0;
+
+#ifdef NATRON_IMAGE_KERNELS_USE_SSE2
+    const __m128 one = _mm_set1_ps(1.f);
+    bool sameLayout = !src || (srcNComps == dstNComps);
+    if ( (!masked || !mask) && sameLayout ) {
+        // The same alpha for all pixels: process the channels as a flat array
+        float alpha = masked ? mix * (maskInvert ? 1.f : 0.f) : mix;
+        __m128 a = _mm_set1_ps(alpha);
+        __m128 b = _mm_set1_ps(1.f - alpha);
+        int nElements = n * dstNComps;
+        int e = 0;
+        for (; e + 4 <= nElements; e += 4) {
+            maskMixPixel4(dst + e, src ? src + e : 0, a, b);
+        }
+        for (; e < nElements; ++e) {
+            float v = float(dst[e]) * alpha;
+            if (src) {
+                v += (1.f - alpha) * float(src[e]);
+            }
+            dst[e] = PixelTraits<PIX>::fromFloat(v);
+        }
+
+        return;
+    }
+    if ( masked && mask && sameLayout && ( (dstNComps == 4) || (dstNComps == 1) ) ) {
+        // 4 pixels at once: compute their 4 alphas in a vector
+        const __m128 mixV = _mm_set1_ps(mix);
+        const __m128 maxV = _mm_set1_ps( PixelTraits<PIX>::maxValue() );
+        for (; i + 4 <= n; i += 4) {
+            __m128 maskScale = _mm_div_ps(PixelTraits<PIX>::load4(mask + i), maxV);
+            if (maskInvert) {
+                maskScale = _mm_sub_ps(one, maskScale);
+            }
+            __m128 alpha = _mm_mul_ps(mixV, maskScale);
+            __m128 oneMinusAlpha = _mm_sub_ps(one, alpha);
+            if (dstNComps == 1) {
+                maskMixPixel4(dst + i, src ? src + i : 0, alpha, oneMinusAlpha);
+            } else {
+                PIX* d = dst + i * 4;
+                const PIX* s = src ? src + i * 4 : 0;
+                maskMixPixel4( d, s, broadcastLane<0>(alpha), broadcastLane<0>(oneMinusAlpha) );
+                maskMixPixel4( d + 4, s ? s + 4 : 0, broadcastLane<1>(alpha), broadcastLane<1>(oneMinusAlpha) );
+                maskMixPixel4( d + 8, s ? s + 8 : 0, broadcastLane<2>(alpha), broadcastLane<2>(oneMinusAlpha) );
+                maskMixPixel4( d + 12, s ? s + 12 : 0, broadcastLane<3>(alpha), broadcastLane<3>(oneMinusAlpha) );
+            }
+        }
+    }
+#endif // NATRON_IMAGE_KERNELS_USE_SSE2
+
+    maskMixRowScalar(dst + i * dstNComps, dstNComps, src ? src + i * srcNComps : 0, srcNComps, mask ? mask + i : 0, masked, maskInvert, mix, n - i);
+} // maskMixRowImpl
+
+template <typename PIX>
+void
+copyChannelsRowImpl(PIX* dst,
+                    int dstNComps,
+                    const PIX* src,
+                    int srcNComps,
+                    bool doR,
+                    bool doG,
+                    bool doB,
+                    bool doA,
+                    int n)
+{
+    doR = doR && (dstNComps >= 2);
+    doG = doG && (dstNComps >= 2);
+    doB = doB && (dstNComps >= 3);
+    doA = doA && (dstNComps == 1 || dstNComps == 4);
+    if ( (dstNComps == 1) && ( !src || (srcNComps == 1) ) ) {
+        if (doA) {
+            if (src) {
+                std::memcpy( dst, src, n * sizeof(PIX) );
+            } else {
+                std::memset( dst, 0, n * sizeof(PIX) );
+            }
+        }
+
+        return;
+    }
+
+    int i = 0;
+#ifdef NATRON_IMAGE_KERNELS_USE_SSE2
+    if ( (dstNComps == 4) && ( !src || (srcNComps == 4) ) ) {
+        // Select the copied channels of 16 bytes of pixels at once
+        const int pixelsPerVector = 16 / ( 4 * sizeof(PIX) );
+        const __m128i channels = PixelTraits<PIX>::channelsMask(doR, doG, doB, doA);
+        for (; i + pixelsPerVector <= n; i += pixelsPerVector) {
+            __m128i* d = (__m128i*)(dst + i * 4);
+            __m128i v = _mm_andnot_si128( channels, _mm_loadu_si128(d) );
+            if (src) {
+                v = _mm_or_si128( v, _mm_and_si128( channels, _mm_loadu_si128( (const __m128i*)(src + i * 4) ) ) );
+            }
+            _mm_storeu_si128(d, v);
+        }
+    }
+#endif
+
+    dst += i * dstNComps;
+    if (src) {
+        src += i * srcNComps;
+    }
+    // be opaque for anything that doesn't contain alpha
+    const bool srcHasAlpha = (srcNComps == 1) || (srcNComps == 4);
+    const PIX opaque = (PIX)PixelTraits<PIX>::maxValue();
+    for (; i < n; ++i, dst += dstNComps) {
+        PIX srcA = src ? (srcHasAlpha ? src[srcNComps - 1] : opaque) : PIX(0);
+        if (doR) {
+            dst[0] = (!src || 0 >= srcNComps) ? PIX(0) : src[0];
+        }
+        if (doG) {
+            dst[1] = (!src || 1 >= srcNComps) ? PIX(0) : src[1];
+        }
+        if (doB) {
+            dst[2] = (!src || 2 >= srcNComps) ? PIX(0) : src[2];
+        }
+        if (doA) {
+            dst[dstNComps - 1] = srcA;
+        }
+        if (src) {
+            src += srcNComps;
+        }
+    }
+} // copyChannelsRowImpl
+
+template <typename PIX>
+void
+premultRowScalar(PIX* pix,
+                 int n)
+{
+    for (int i = 0; i < n; ++i, pix += 4) {
+        for (int c = 0; c < 3; ++c) {
+            pix[c] = PIX(float(pix[c]) * pix[3]);
+        }
+    }
+}
+
+template <typename PIX>
+void
+unpremultRowScalar(PIX* pix,
+                   int n)
+{
+    for (int i = 0; i < n; ++i, pix += 4) {
+        if (pix[3] != 0) {
+            for (int c = 0; c < 3; ++c) {
+                pix[c] = PIX( pix[c] / float(pix[3]) );
+            }
+        }
+    }
+}
+
+template <typename PIX>
+void
+halveRowBoxScalar(PIX* dst,
+                  const PIX* row0,
+                  const PIX* row1,
+                  int nComps,
+                  int n)
+{
+    // The sums are computed in the same order as (a + b + c + d) / sum in the per-pixel halving,
+    // with int promotion for the integer types
+    if (row1) {
+        for (int i = 0; i < n; ++i, dst += nComps, row0 += 2 * nComps, row1 += 2 * nComps) {
+            for (int c = 0; c < nComps; ++c) {
+                dst[c] = PIX( (row0[c] + row0[c + nComps] + row1[c] + row1[c + nComps]) / 4 );
+            }
+        }
+    } else {
+        for (int i = 0; i < n; ++i, dst += nComps, row0 += 2 * nComps) {
+            for (int c = 0; c < nComps; ++c) {
+                dst[c] = PIX( (row0[c] + row0[c + nComps]) / 2 );
+            }
+        }
+    }
+}
+
+int
+sanitizeNonFiniteRowScalar(float* pix,
+                           int n)
+{
+    int count = 0;
+
+    for (int i = 0; i < n; ++i) {
+        float v = pix[i];
+        if (v != v) { // check for NaN
+            pix[i] = 1.f;
+            ++count;
+        } else if (v > FLT_MAX) {
+            pix[i] = FLT_MAX;
+            ++count;
+        } else if (v < -FLT_MAX) {
+            pix[i] = -FLT_MAX;
+            ++count;
+        }
+    }
+
+    return count;
+}
+} // anon namespace
+
+void
+maskMixRow(float* dst,
+           int dstNComps,
+           const float* src,
+           int srcNComps,
+           const float* mask,
+           bool masked,
+           bool maskInvert,
+           float mix,
+           int n)
+{
+    maskMixRowImpl(dst, dstNComps, src, srcNComps, mask, masked, maskInvert, mix, n);
+}
+
+void
+maskMixRow(unsigned short* dst,
+           int dstNComps,
+           const unsigned short* src,
+           int srcNComps,
+           const unsigned short* mask,
+           bool masked,
+           bool maskInvert,
+           float mix,
+           int n)
+{
+    maskMixRowImpl(dst, dstNComps, src, srcNComps, mask, masked, maskInvert, mix, n);
+}
+
+void
+maskMixRow(unsigned char* dst,
+           int dstNComps,
+           const unsigned char* src,
+           int srcNComps,
+           const unsigned char* mask,
+           bool masked,
+           bool maskInvert,
+           float mix,
+           int n)
+{
+    maskMixRowImpl(dst, dstNComps, src, srcNComps, mask, masked, maskInvert, mix, n);
+}
+
+void
+copyChannelsRow(float* dst,
+                int dstNComps,
+                const float* src,
+                int srcNComps,
+                bool doR,
+                bool doG,
+                bool doB,
+                bool doA,
+                int n)
+{
+    copyChannelsRowImpl(dst, dstNComps, src, srcNComps, doR, doG, doB, doA, n);
+}
+
+void
+copyChannelsRow(unsigned short* dst,
+                int dstNComps,
+                const unsigned short* src,
+                int srcNComps,
+                bool doR,
+                bool doG,
+                bool doB,
+                bool doA,
+                int n)
+{
+    copyChannelsRowImpl(dst, dstNComps, src, srcNComps, doR, doG, doB, doA, n);
+}
+
+void
+copyChannelsRow(unsigned char* dst,
+                int dstNComps,
+                const unsigned char* src,
+                int srcNComps,
+                bool doR,
+                bool doG,
+                bool doB,
+                bool doA,
+                int n)
+{
+    copyChannelsRowImpl(dst, dstNComps, src, srcNComps, doR, doG, doB, doA, n);
+}
+
+void
+premultRow(float* pix,
+           int n)
+{
+    int i = 0;
+
+#ifdef NATRON_IMAGE_KERNELS_USE_SSE2
+    const __m128 rgb = _mm_castsi128_ps( _mm_set_epi32(0, -1, -1, -1) );
+    for (; i < n; ++i, pix += 4) {
+        __m128 v = _mm_loadu_ps(pix);
+        __m128 premult = _mm_mul_ps( v, broadcastLane<3>(v) );
+        _mm_storeu_ps( pix, _mm_or_ps( _mm_and_ps(rgb, premult), _mm_andnot_ps(rgb, v) ) );
+    }
+#endif
+    premultRowScalar(pix, n - i);
+}
+
+void
+premultRow(unsigned short* pix,
+           int n)
+{
+    premultRowScalar(pix, n);
+}
+
+void
+premultRow(unsigned char* pix,
+           int n)
+{
+    premultRowScalar(pix, n);
+}
+
+void
+unpremultRow(float* pix,
+             int n)
+{
+    int i = 0;
+
+#ifdef NATRON_IMAGE_KERNELS_USE_SSE2
+    const __m128 rgb = _mm_castsi128_ps( _mm_set_epi32(0, -1, -1, -1) );
+    for (; i < n; ++i, pix += 4) {
+        __m128 v = _mm_loadu_ps(pix);
+        __m128 alpha = broadcastLane<3>(v);
+        // Pixels with a 0 alpha are left untouched
+        __m128 divided = _mm_and_ps( rgb, _mm_cmpneq_ps( alpha, _mm_setzero_ps() ) );
+        __m128 unpremult = _mm_div_ps(v, alpha);
+        _mm_storeu_ps( pix, _mm_or_ps( _mm_and_ps(divided, unpremult), _mm_andnot_ps(divided, v) ) );
+    }
+#endif
+    unpremultRowScalar(pix, n - i);
+}
+
+void
+unpremultRow(unsigned short* pix,
+             int n)
+{
+    unpremultRowScalar(pix, n);
+}
+
+void
+unpremultRow(unsigned char* pix,
+             int n)
+{
+    unpremultRowScalar(pix, n);
+}
+
+void
+halveRowBox(float* dst,
+            const float* row0,
+            const float* row1,
+            int nComps,
+            int n)
+{
+    int i = 0;
+
+#ifdef NATRON_IMAGE_KERNELS_USE_SSE2
+    // Dividing by a power of 2 or multiplying by its inverse gives the same result
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    if (nComps == 4) {
+        for (; i < n; ++i, dst += 4, row0 += 8) {
+            __m128 sum = _mm_add_ps( _mm_loadu_ps(row0), _mm_loadu_ps(row0 + 4) );
+            if (row1) {
+                sum = _mm_add_ps( _mm_add_ps( sum, _mm_loadu_ps(row1) ), _mm_loadu_ps(row1 + 4) );
+                row1 += 8;
+                _mm_storeu_ps( dst, _mm_mul_ps(sum, quarter) );
+            } else {
+                _mm_storeu_ps( dst, _mm_mul_ps(sum, half) );
+            }
+        }
+
+        return;
+    } else if (nComps == 1) {
+        // 8 consecutive values are 4 pairs: separate the left and right pixels of the pairs
+        for (; i + 4 <= n; i += 4, dst += 4, row0 += 8) {
+            __m128 v0 = _mm_loadu_ps(row0);
+            __m128 v1 = _mm_loadu_ps(row0 + 4);
+            __m128 sum = _mm_add_ps( _mm_shuffle_ps( v0, v1, _MM_SHUFFLE(2, 0, 2, 0) ), _mm_shuffle_ps( v0, v1, _MM_SHUFFLE(3, 1, 3, 1) ) );
+            if (row1) {
+                __m128 w0 = _mm_loadu_ps(row1);
+                __m128 w1 = _mm_loadu_ps(row1 + 4);
+                sum = _mm_add_ps( _mm_add_ps( sum, _mm_shuffle_ps( w0, w1, _MM_SHUFFLE(2, 0, 2, 0) ) ), _mm_shuffle_ps( w0, w1, _MM_SHUFFLE(3, 1, 3, 1) ) );
+                row1 += 8;
+                _mm_storeu_ps( dst, _mm_mul_ps(sum, quarter) );
+            } else {
+                _mm_storeu_ps( dst, _mm_mul_ps(sum, half) );
+            }
+        }
+    }
+#endif
+    halveRowBoxScalar(dst, row0, row1, nComps, n - i);
+}
+
+void
+halveRowBox(unsigned short* dst,
+            const unsigned short* row0,
+            const unsigned short* row1,
+            int nComps,
+            int n)
+{
+    halveRowBoxScalar(dst, row0, row1, nComps, n);
+}
+
+void
+halveRowBox(unsigned char* dst,
+            const unsigned char* row0,
+            const unsigned char* row1,
+            int nComps,
+            int n)
+{
+    halveRowBoxScalar(dst, row0, row1, nComps, n);
+}
+
+int
+sanitizeNonFiniteRow(float* pix,
+                     int n)
+{
+    int i = 0;
+    int count = 0;
+
+#ifdef NATRON_IMAGE_KERNELS_USE_SSE2
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 maxV = _mm_set1_ps(FLT_MAX);
+    const __m128 minV = _mm_set1_ps(-FLT_MAX);
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(pix + i);
+        // Infinite values are clamped, NaN values are unordered with themselves
+        __m128 clamped = _mm_min_ps( _mm_max_ps(v, minV), maxV );
+        __m128 isNaN = _mm_cmpunord_ps(v, v);
+        // Both NaN and clamped values compare different
+        int replaced = _mm_movemask_ps( _mm_cmpneq_ps(clamped, v) );
+        if (replaced) {
+            _mm_storeu_ps( pix + i, _mm_or_ps( _mm_and_ps(isNaN, one), _mm_andnot_ps(isNaN, clamped) ) );
+            count += (replaced & 1) + ( (replaced >> 1) & 1 ) + ( (replaced >> 2) & 1 ) + ( (replaced >> 3) & 1 );
+        }
+    }
+#endif
+
+    return count + sanitizeNonFiniteRowScalar(pix + i, n - i);
+}
+} // namespace ImageKernels
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,114 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_IMAGEKERNELS_H
+#define NATRON_ENGINE_IMAGEKERNELS_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+/*
+ * Row versions of the pointwise operations applied to the output of a render by the host:
+ * mask/mix with the source image, copy of the channels the effect did not process, (un)premultiplication
+ * and replacement of the NaN and infinite values, and of the 2x2 halving used to build the mipmap levels.
+ *
+ * Each kernel processes a run of n contiguous pixels of a row. The caller cuts each row in runs where the
+ * pixels of the other images (source, mask) are either all available or all unavailable, see getRunEnd(),
+ * so that the kernels do not test the bounds of the other images at each pixel.
+ * The common layouts (RGBA or alpha with a source of the same components) are processed 4 floats at once with SSE2 on x86,
+ * the others with a scalar loop. Both paths produce exactly the same values as the per-pixel functions they replace:
+ * the same float operations are applied in the same order, and integer results are clamped then truncated.
+ */
+
+NATRON_NAMESPACE_ENTER;
+
+namespace ImageKernels {
+/**
+ * @brief Returns the end of the run of pixels starting at x (and ending at most at xEnd) whose availability
+ * in an image spanning the columns [boundsX1, boundsX2) is the same as the availability of x.
+ **/
+inline int
+getRunEnd(int x,
+          int xEnd,
+          int boundsX1,
+          int boundsX2)
+{
+    if (x < boundsX1) {
+        return boundsX1 < xEnd ? boundsX1 : xEnd;
+    } else if (x < boundsX2) {
+        return boundsX2 < xEnd ? boundsX2 : xEnd;
+    }
+
+    return xEnd;
+}
+
+/**
+ * @brief Mixes n pixels of dst with the corresponding pixels of src: dst = dst * alpha + src * (1 - alpha)
+ * where alpha = mix, multiplied by the value of the mask (or its complement if maskInvert is true) if masked is true.
+ * If src is NULL, dst = dst * alpha on all the channels, otherwise only the first srcNComps channels are mixed.
+ * If masked is true and mask is NULL, the pixels are considered outside of the mask.
+ * The mask has a single channel.
+ **/
+void maskMixRow(float* dst, int dstNComps, const float* src, int srcNComps, const float* mask, bool masked, bool maskInvert, float mix, int n);
+void maskMixRow(unsigned short* dst, int dstNComps, const unsigned short* src, int srcNComps, const unsigned short* mask, bool masked, bool maskInvert, float mix, int n);
+void maskMixRow(unsigned char* dst, int dstNComps, const unsigned char* src, int srcNComps, const unsigned char* mask, bool masked, bool maskInvert, float mix, int n);
+
+/**
+ * @brief Copies the channels of src for which doR, doG, doB and doA are true to n pixels of dst.
+ * Channels that src does not have are set to 0 and the alpha channel to opaque if src has no alpha.
+ * If src is NULL, the copied channels are set to 0.
+ **/
+void copyChannelsRow(float* dst, int dstNComps, const float* src, int srcNComps, bool doR, bool doG, bool doB, bool doA, int n);
+void copyChannelsRow(unsigned short* dst, int dstNComps, const unsigned short* src, int srcNComps, bool doR, bool doG, bool doB, bool doA, int n);
+void copyChannelsRow(unsigned char* dst, int dstNComps, const unsigned char* src, int srcNComps, bool doR, bool doG, bool doB, bool doA, int n);
+
+/**
+ * @brief Multiplies (or divides, unless alpha is 0) the RGB channels of n RGBA pixels by their alpha channel
+ **/
+void premultRow(float* pix, int n);
+void premultRow(unsigned short* pix, int n);
+void premultRow(unsigned char* pix, int n);
+void unpremultRow(float* pix, int n);
+void unpremultRow(unsigned short* pix, int n);
+void unpremultRow(unsigned char* pix, int n);
+
+/**
+ * @brief Halves n pixels with a 2x2 box filter: dst[x] = (a + b + c + d) / 4, where a and b are the pixels 2x and 2x + 1 of row0
+ * and c and d the same pixels of row1. If row1 is NULL (the row below is outside of the source), dst[x] = (a + b) / 2.
+ * Integer results are truncated, as with an integer division.
+ **/
+void halveRowBox(float* dst, const float* row0, const float* row1, int nComps, int n);
+void halveRowBox(unsigned short* dst, const unsigned short* row0, const unsigned short* row1, int nComps, int n);
+void halveRowBox(unsigned char* dst, const unsigned char* row0, const unsigned char* row1, int nComps, int n);
+
+/**
+ * @brief Replaces the NaN values of the n floats of pix by 1 and the infinite values by the largest finite float of the same sign.
+ * Values are only written if they are replaced, so that a clean row is only read.
+ * @returns The number of values replaced
+ **/
+int sanitizeNonFiniteRow(float* pix, int n);
+} // namespace ImageKernels
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_IMAGEKERNELS_H
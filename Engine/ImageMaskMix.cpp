@@ -26,123 +26,115 @@
 
 #include <cassert>
 #include <stdexcept>
+#include "Engine/ImageKernels.h"
 #include "Engine/OSGLContext.h"
 
 NATRON_NAMESPACE_ENTER;
 
-template<int srcNComps, int dstNComps, typename PIX, int maxValue, bool masked, bool maskInvert>
-void
-Image::applyMaskMixForMaskInvert(const RectI& roi,
-                                 const Image* maskImg,
-                                 const Image* originalImg,
-                                 float mix)
+namespace {
+// Only float images can hold NaN or infinite values
+inline int
+sanitizeNonFiniteRowForDepth(float* pix,
+                             int n)
 {
-    PIX* dst_pixels = (PIX*)pixelAt(roi.x1, roi.y1);
-    unsigned int dstRowElements = _bounds.width() * getComponentsCount();
-
-    for ( int y = roi.y1; y < roi.y2; ++y,
-          dst_pixels += (dstRowElements - (roi.x2 - roi.x1) * dstNComps) ) { // 1 row stride minus what was done at previous iteration
-        for (int x = roi.x1; x < roi.x2; ++x,
-             dst_pixels += dstNComps) {
-            const PIX* src_pixels = originalImg ? (const PIX*)originalImg->pixelAt(x, y) : 0;
-            float maskScale = 1.f;
-            if (!masked) {
-                // just mix
-                float alpha = mix;
-                if (src_pixels) {
-                    for (int c = 0; c < dstNComps; ++c) {
-                        if (c < srcNComps) {
-                            float v = float(dst_pixels[c]) * alpha + (1.f - alpha) * float(src_pixels[c]);
-                            dst_pixels[c] = clampIfInt<PIX>(v);
-                        }
-                    }
-                } else {
-                    for (int c = 0; c < dstNComps; ++c) {
-                        float v = float(dst_pixels[c]) * alpha;
-                        dst_pixels[c] = clampIfInt<PIX>(v);
-                    }
-                }
-            } else {
-                const PIX* maskPixels = maskImg ? (const PIX*)maskImg->pixelAt(x, y) : 0;
-                // figure the scale factor from that pixel
-                if (maskPixels == 0) {
-                    maskScale = maskInvert ? 1.f : 0.f;
-                } else {
-                    maskScale = *maskPixels / float(maxValue);
-                    if (maskInvert) {
-                        maskScale = 1.f - maskScale;
-                    }
-                }
-                float alpha = mix * maskScale;
-                if (src_pixels) {
-                    for (int c = 0; c < dstNComps; ++c) {
-                        if (c < srcNComps) {
-                            float v = float(dst_pixels[c]) * alpha + (1.f - alpha) * float(src_pixels[c]);
-                            dst_pixels[c] = clampIfInt<PIX>(v);
-                        }
-                    }
-                } else {
-                    for (int c = 0; c < dstNComps; ++c) {
-                        float v = float(dst_pixels[c]) * alpha;
-                        dst_pixels[c] = clampIfInt<PIX>(v);
-                    }
-                }
-            }
-        }
-    }
-} // Image::applyMaskMixForMaskInvert
+    return ImageKernels::sanitizeNonFiniteRow(pix, n);
+}
 
-template<int srcNComps, int dstNComps, typename PIX, int maxValue, bool masked>
-void
-Image::applyMaskMixForMasked(const RectI& roi,
-                             const Image* maskImg,
-                             const Image* originalImg,
-                             bool maskInvert,
-                             float mix)
+inline int
+sanitizeNonFiniteRowForDepth(unsigned short* /*pix*/,
+                             int /*n*/)
 {
-    if (maskInvert) {
-        applyMaskMixForMaskInvert<srcNComps, dstNComps, PIX, maxValue, masked, true>(roi, maskImg, originalImg, mix);
-    } else {
-        applyMaskMixForMaskInvert<srcNComps, dstNComps, PIX, maxValue, masked, false>(roi, maskImg, originalImg, mix);
-    }
+    return 0;
 }
 
-template<int srcNComps, int dstNComps, typename PIX, int maxValue>
+inline int
+sanitizeNonFiniteRowForDepth(unsigned char* /*pix*/,
+                             int /*n*/)
+{
+    return 0;
+}
+} // anon namespace
+
+template <typename PIX>
 void
-Image::applyMaskMixForDepth(const RectI& roi,
-                            const Image* maskImg,
-                            const Image* originalImg,
-                            bool masked,
-                            bool maskInvert,
-                            float mix)
+Image::copyChannelsAndMaskMixForDepth(const RectI& roi,
+                                      const Image* originalImg,
+                                      bool doCopy,
+                                      std::bitset<4> processChannels,
+                                      bool doMaskMix,
+                                      const Image* maskImg,
+                                      bool masked,
+                                      bool maskInvert,
+                                      float mix,
+                                      int* nbNonFiniteValues)
 {
-    if (masked) {
-        applyMaskMixForMasked<srcNComps, dstNComps, PIX, maxValue, true>(roi, maskImg, originalImg, maskInvert, mix);
-    } else {
-        applyMaskMixForMasked<srcNComps, dstNComps, PIX, maxValue, false>(roi, maskImg, originalImg, maskInvert, mix);
+    int dstNComps = getComponentsCount();
+    int srcNComps = originalImg ? (int)originalImg->getComponentsCount() : 0;
+    const bool doR = !processChannels[0];
+    const bool doG = !processChannels[1];
+    const bool doB = !processChannels[2];
+    const bool doA = !processChannels[3];
+    const bool useMask = doMaskMix && masked && maskImg;
+
+    for (int y = roi.y1; y < roi.y2; ++y) {
+        bool srcRow = originalImg && (y >= originalImg->_bounds.y1) && (y < originalImg->_bounds.y2);
+        bool maskRow = useMask && (y >= maskImg->_bounds.y1) && (y < maskImg->_bounds.y2);
+        PIX* const dst_row = (PIX*)pixelAt(roi.x1, y);
+        PIX* dst_pixels = dst_row;
+        assert(dst_pixels);
+        // Replace the NaN and infinite values rendered while the row is in the cache, before they are mixed:
+        // with a mix or mask of 0 the original pixels must be restored, but NaN * 0 would still be NaN
+        if (nbNonFiniteValues) {
+            *nbNonFiniteValues += sanitizeNonFiniteRowForDepth(dst_row, roi.width() * dstNComps);
+        }
+        int x = roi.x1;
+        while (x < roi.x2) {
+            // Cut the row in runs where the pixels of the original image and of the mask are either all available or not
+            int xEnd = roi.x2;
+            if (srcRow) {
+                xEnd = ImageKernels::getRunEnd(x, xEnd, originalImg->_bounds.x1, originalImg->_bounds.x2);
+            }
+            if (maskRow) {
+                xEnd = ImageKernels::getRunEnd(x, xEnd, maskImg->_bounds.x1, maskImg->_bounds.x2);
+            }
+            const PIX* src_pixels = srcRow ? (const PIX*)originalImg->pixelAt(x, y) : 0;
+            const PIX* maskPixels = maskRow ? (const PIX*)maskImg->pixelAt(x, y) : 0;
+            int n = xEnd - x;
+            if (doCopy) {
+                ImageKernels::copyChannelsRow(dst_pixels, dstNComps, src_pixels, srcNComps, doR, doG, doB, doA, n);
+            }
+            if (doMaskMix) {
+                ImageKernels::maskMixRow(dst_pixels, dstNComps, src_pixels, srcNComps, maskPixels, masked, maskInvert, mix, n);
+            }
+            dst_pixels += n * dstNComps;
+            x = xEnd;
+        }
     }
-}
+} // Image::copyChannelsAndMaskMixForDepth
 
-template<int srcNComps, int dstNComps>
 void
-Image::applyMaskMixForDstComponents(const RectI& roi,
-                                    const Image* maskImg,
-                                    const Image* originalImg,
-                                    bool masked,
-                                    bool maskInvert,
-                                    float mix)
+Image::copyChannelsAndMaskMixRows(const RectI& roi,
+                                  const Image* originalImg,
+                                  bool doCopy,
+                                  std::bitset<4> processChannels,
+                                  bool doMaskMix,
+                                  const Image* maskImg,
+                                  bool masked,
+                                  bool maskInvert,
+                                  float mix,
+                                  int* nbNonFiniteValues)
 {
-    ImageBitDepthEnum depth = getBitDepth();
+    assert( !originalImg || getBitDepth() == originalImg->getBitDepth() );
 
-    switch (depth) {
+    switch ( getBitDepth() ) {
     case eImageBitDepthByte:
-        applyMaskMixForDepth<srcNComps, dstNComps, unsigned char, 255>(roi, maskImg, originalImg, masked, maskInvert, mix);
+        copyChannelsAndMaskMixForDepth<unsigned char>(roi, originalImg, doCopy, processChannels, doMaskMix, maskImg, masked, maskInvert, mix, nbNonFiniteValues);
         break;
     case eImageBitDepthShort:
-        applyMaskMixForDepth<srcNComps, dstNComps, unsigned short, 65535>(roi, maskImg, originalImg, masked, maskInvert, mix);
+        copyChannelsAndMaskMixForDepth<unsigned short>(roi, originalImg, doCopy, processChannels, doMaskMix, maskImg, masked, maskInvert, mix, nbNonFiniteValues);
         break;
     case eImageBitDepthFloat:
-        applyMaskMixForDepth<srcNComps, dstNComps, float, 1>(roi, maskImg, originalImg, masked, maskInvert, mix);
+        copyChannelsAndMaskMixForDepth<float>(roi, originalImg, doCopy, processChannels, doMaskMix, maskImg, masked, maskInvert, mix, nbNonFiniteValues);
         break;
     default:
         assert(false);
@@ -150,39 +142,6 @@ Image::applyMaskMixForDstComponents(const RectI& roi,
     }
 }
 
-template<int srcNComps>
-void
-Image::applyMaskMixForSrcComponents(const RectI& roi,
-                                    const Image* maskImg,
-                                    const Image* originalImg,
-                                    bool masked,
-                                    bool maskInvert,
-                                    float mix)
-{
-    int dstNComps = getComponentsCount();
-
-    assert(0 < dstNComps && dstNComps <= 4);
-    switch (dstNComps) {
-    //case 0:
-    //    applyMaskMixForDstComponents<srcNComps,0>(roi, maskImg, originalImg, masked, maskInvert, mix);
-    //    break;
-    case 1:
-        applyMaskMixForDstComponents<srcNComps, 1>(roi, maskImg, originalImg, masked, maskInvert, mix);
-        break;
-    case 2:
-        applyMaskMixForDstComponents<srcNComps, 2>(roi, maskImg, originalImg, masked, maskInvert, mix);
-        break;
-    case 3:
-        applyMaskMixForDstComponents<srcNComps, 3>(roi, maskImg, originalImg, masked, maskInvert, mix);
-        break;
-    case 4:
-        applyMaskMixForDstComponents<srcNComps, 4>(roi, maskImg, originalImg, masked, maskInvert, mix);
-        break;
-    default:
-        break;
-    }
-}
-
 template <typename GL>
 void applyMaskMixGL(const Image* maskImg,
                     const Image* originalImg,
@@ -268,15 +227,9 @@ Image::applyMaskMix(const RectI& roi,
         return;
     }
 
-    QWriteLocker k(&_entryLock);
-    boost::shared_ptr<QReadLocker> originalLock;
-    boost::shared_ptr<QReadLocker> maskLock;
-    if (originalImg) {
-        originalLock.reset( new QReadLocker(&originalImg->_entryLock) );
-    }
-    if (maskImg) {
-        maskLock.reset( new QReadLocker(&maskImg->_entryLock) );
-    }
+    RegionLocker k(this, roi, true);
+    RegionLocker originalLock(originalImg, roi, false);
+    RegionLocker maskLock(maskImg, roi, false);
     RectI realRoI;
     roi.intersect(_bounds, &realRoI);
 
@@ -296,27 +249,11 @@ Image::applyMaskMix(const RectI& roi,
         return;
     }
 
-    int srcNComps = originalImg ? (int)originalImg->getComponentsCount() : 0;
-    //assert(0 < srcNComps && srcNComps <= 4);
-    switch (srcNComps) {
-    //case 0:
-    //    applyMaskMixForSrcComponents<0>(realRoI, maskImg, originalImg, masked, maskInvert, mix);
-    //    break;
-    case 1:
-        applyMaskMixForSrcComponents<1>(realRoI, maskImg, originalImg, masked, maskInvert, mix);
-        break;
-    case 2:
-        applyMaskMixForSrcComponents<2>(realRoI, maskImg, originalImg, masked, maskInvert, mix);
-        break;
-    case 3:
-        applyMaskMixForSrcComponents<3>(realRoI, maskImg, originalImg, masked, maskInvert, mix);
-        break;
-    case 4:
-        applyMaskMixForSrcComponents<4>(realRoI, maskImg, originalImg, masked, maskInvert, mix);
-        break;
-    default:
-        break;
+    // Without the original image there is nothing to mix with
+    if (!originalImg) {
+        return;
     }
+    copyChannelsAndMaskMixRows(realRoI, originalImg, false, std::bitset<4>(), true, maskImg, masked, maskInvert, mix, 0);
 } // applyMaskMix
 
 NATRON_NAMESPACE_EXIT;
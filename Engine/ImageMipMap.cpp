@@ -0,0 +1,667 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Image.h"
+
+#include <algorithm> // min, max
+#include <cassert>
+#include <cstring> // for std::memcpy
+#include <vector>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/bind.hpp>
+#endif
+
+#include <QtCore/QThreadPool>
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
+
+#include "Engine/ImageKernels.h"
+
+// Number of rows of the source image processed by each task of a downscale.
+// The intermediate levels of a strip are small enough to stay in the CPU caches.
+#define NATRON_MIPMAP_STRIP_SOURCE_ROWS 128
+
+// Below this number of pixels per thread, a downscale or upscale is not split across threads
+#define NATRON_MIPMAP_MIN_PIXELS_PER_THREAD (256 * 256)
+
+NATRON_NAMESPACE_ENTER;
+
+namespace {
+/*
+ * A packed plane of pixels (or of bitmap values, with nComps = 1) whose pixel (bounds.x1, bounds.y1) is at data.
+ * T is const for the planes that are only read.
+ */
+template <typename T>
+struct PlaneView
+{
+    T* data;
+    RectI bounds;
+    int nComps;
+    int rowElements;
+
+    PlaneView()
+        : data(0)
+        , bounds()
+        , nComps(0)
+        , rowElements(0)
+    {
+    }
+
+    PlaneView(T* data,
+              const RectI& bounds,
+              int nComps)
+        : data(data)
+        , bounds(bounds)
+        , nComps(nComps)
+        , rowElements( bounds.width() * nComps )
+    {
+    }
+
+    template <typename U>
+    PlaneView(const PlaneView<U>& other)
+        : data(other.data)
+        , bounds(other.bounds)
+        , nComps(other.nComps)
+        , rowElements(other.rowElements)
+    {
+    }
+
+    T* at(int x,
+          int y) const
+    {
+        assert( bounds.contains(x, y) );
+
+        return data + (std::size_t)(y - bounds.y1) * rowElements + (x - bounds.x1) * nComps;
+    }
+};
+
+// The rows of the last level produced by one task
+struct MipMapStrip
+{
+    int y1, y2;
+};
+
+template <typename PIX>
+struct DownscaleArgs
+{
+    PlaneView<const PIX> src;
+    PlaneView<const char> srcBitmap; // data is NULL if the bitmap is not downscaled
+    PlaneView<PIX> dst;
+    PlaneView<char> dstBitmap;
+    MipMapFilterEnum filter;
+
+    // levelRoI[i] is the portion of level i that is built, levelRoI[0] is the roi of the source.
+    // Each level reads only the pixels of the previous level that are within sampleBounds[i - 1]:
+    // - box filter: the bounds of the source image for level 0, levelRoI[i - 1] for the others.
+    // - tent filter: the roi of the source and its valid neighbour pixels for level 0 (see getTentSampleBounds),
+    // then the pixels of each level that can be computed from them, so that a tile is filtered with
+    // its neighbours' pixels and tiles downscaled separately do not have seams.
+    std::vector<RectI> levelRoI;
+    std::vector<RectI> sampleBounds;
+};
+
+inline bool
+isInRange(int v,
+          int v1,
+          int v2)
+{
+    return v1 <= v && v < v2;
+}
+
+/*
+ * Builds the pixels of dstRect in dst, each one being the average of the 2x2 pixels of src under it,
+ * ignoring the pixels that are outside of sampleBounds.
+ * This gives exactly the same values as the per-pixel halving that was applied level by level.
+ */
+template <typename PIX>
+void
+halveLevelBox(const PlaneView<const PIX>& src,
+              const RectI& sampleBounds,
+              const PlaneView<PIX>& dst,
+              const RectI& dstRect)
+{
+    const int nComps = src.nComps;
+    // The columns [xa, xb) have their 2 source columns within sampleBounds, the others only one
+    const int xa = std::min( std::max(dstRect.x1, (sampleBounds.x1 + 1) >> 1), dstRect.x2 );
+    const int xb = std::min( std::max(xa, sampleBounds.x2 >> 1), dstRect.x2 );
+
+    for (int y = dstRect.y1; y < dstRect.y2; ++y) {
+        const bool pickThisRow = isInRange(2 * y, sampleBounds.y1, sampleBounds.y2);
+        const bool pickNextRow = isInRange(2 * y + 1, sampleBounds.y1, sampleBounds.y2);
+        assert(pickThisRow || pickNextRow);
+        const int srcy = pickThisRow ? 2 * y : 2 * y + 1;
+        const bool twoRows = pickThisRow && pickNextRow;
+
+        if (xa < xb) {
+            ImageKernels::halveRowBox(dst.at(xa, y), src.at(2 * xa, srcy), twoRows ? src.at(2 * xa, srcy + 1) : 0, nComps, xb - xa);
+        }
+        for (int x = dstRect.x1; x < dstRect.x2; ++x) {
+            if (x == xa) {
+                x = xb;
+                if (x >= dstRect.x2) {
+                    break;
+                }
+            }
+            const int srcx = isInRange(2 * x, sampleBounds.x1, sampleBounds.x2) ? 2 * x : 2 * x + 1;
+            const PIX* p0 = src.at(srcx, srcy);
+            PIX* d = dst.at(x, y);
+            if (twoRows) {
+                const PIX* p1 = src.at(srcx, srcy + 1);
+                for (int c = 0; c < nComps; ++c) {
+                    d[c] = PIX( (p0[c] + p1[c]) / 2 );
+                }
+            } else {
+                for (int c = 0; c < nComps; ++c) {
+                    d[c] = p0[c];
+                }
+            }
+        }
+    }
+} // halveLevelBox
+
+/*
+ * Same as halveLevelBox for the bitmap: a pixel is marked as rendered only if all the source pixels under it are.
+ * Pixels being rendered by another thread are considered not rendered, otherwise the caller
+ * would have to wait for the fullscale image render to be finished and then downscale again.
+ */
+void
+halveBitmapLevel(const PlaneView<const char>& src,
+                 const RectI& sampleBounds,
+                 const PlaneView<char>& dst,
+                 const RectI& dstRect)
+{
+    for (int y = dstRect.y1; y < dstRect.y2; ++y) {
+        const bool pickThisRow = isInRange(2 * y, sampleBounds.y1, sampleBounds.y2);
+        const bool pickNextRow = isInRange(2 * y + 1, sampleBounds.y1, sampleBounds.y2);
+        const char* const thisRow = pickThisRow ? src.at(sampleBounds.x1, 2 * y) : 0;
+        const char* const nextRow = pickNextRow ? src.at(sampleBounds.x1, 2 * y + 1) : 0;
+        char* d = dst.at(dstRect.x1, y);
+        for (int x = dstRect.x1; x < dstRect.x2; ++x, ++d) {
+            // offsets of the 2 source columns from sampleBounds.x1
+            const int thisCol = 2 * x - sampleBounds.x1;
+            const int nextCol = thisCol + 1;
+            const bool pickThisCol = isInRange(2 * x, sampleBounds.x1, sampleBounds.x2);
+            const bool pickNextCol = isInRange(2 * x + 1, sampleBounds.x1, sampleBounds.x2);
+            bool rendered = true;
+            if (thisRow) {
+                rendered = rendered && (!pickThisCol || thisRow[thisCol] == 1) && (!pickNextCol || thisRow[nextCol] == 1);
+            }
+            if (nextRow) {
+                rendered = rendered && (!pickThisCol || nextRow[thisCol] == 1) && (!pickNextCol || nextRow[nextCol] == 1);
+            }
+            *d = rendered ? 1 : 0;
+        }
+    }
+}
+
+template <typename PIX>
+PIX
+fromFilteredValue(float v)
+{
+    // The filtered values are weighted averages, within the range of PIX: round to the nearest integer
+    return PIX(v + 0.5f);
+}
+
+template <>
+float
+fromFilteredValue<float>(float v)
+{
+    return v;
+}
+
+/*
+ * Builds the pixels of dstRect in dst with the tent filter: the source pixels 2x - 1 to 2x + 2 (and the same rows)
+ * are weighted by 1 3 3 1. The weights of the pixels outside of sampleBounds are ignored and the others are normalized.
+ * The filter is separable: the source rows are first filtered horizontally in hBuffer.
+ */
+template <typename PIX>
+void
+halveLevelTent(const PlaneView<const PIX>& src,
+               const RectI& sampleBounds,
+               const PlaneView<PIX>& dst,
+               const RectI& dstRect,
+               std::vector<float>& hBuffer)
+{
+    static const float weights[4] = { 1.f, 3.f, 3.f, 1.f };
+    const int nComps = src.nComps;
+    const int hy1 = std::max(2 * dstRect.y1 - 1, sampleBounds.y1);
+    const int hy2 = std::min(2 * dstRect.y2 + 1, sampleBounds.y2);
+    const int hRowElements = dstRect.width() * nComps;
+
+    hBuffer.resize( (std::size_t)(hy2 - hy1) * hRowElements );
+
+    // The columns [xa, xb) have their 4 source columns within sampleBounds
+    const int xa = std::min( std::max(dstRect.x1, (sampleBounds.x1 + 2) >> 1), dstRect.x2 );
+    const int xb = std::min( std::max(xa, (sampleBounds.x2 - 1) >> 1), dstRect.x2 );
+    for (int sy = hy1; sy < hy2; ++sy) {
+        float* h = &hBuffer[(std::size_t)(sy - hy1) * hRowElements];
+        for (int x = dstRect.x1; x < dstRect.x2; ++x, h += nComps) {
+            if ( (xa <= x) && (x < xb) ) {
+                const PIX* p = src.at(2 * x - 1, sy);
+                for (int c = 0; c < nComps; ++c) {
+                    h[c] = (p[c] + 3.f * p[c + nComps] + 3.f * p[c + 2 * nComps] + p[c + 3 * nComps]) / 8.f;
+                }
+                continue;
+            }
+            float sumWeights = 0.f;
+            for (int c = 0; c < nComps; ++c) {
+                h[c] = 0.f;
+            }
+            for (int k = 0; k < 4; ++k) {
+                const int sx = 2 * x - 1 + k;
+                if ( !isInRange(sx, sampleBounds.x1, sampleBounds.x2) ) {
+                    continue;
+                }
+                const PIX* p = src.at(sx, sy);
+                for (int c = 0; c < nComps; ++c) {
+                    h[c] += weights[k] * p[c];
+                }
+                sumWeights += weights[k];
+            }
+            assert(sumWeights > 0);
+            for (int c = 0; c < nComps; ++c) {
+                h[c] /= sumWeights;
+            }
+        }
+    }
+
+    for (int y = dstRect.y1; y < dstRect.y2; ++y) {
+        const float* rows[4];
+        float rowWeights[4];
+        int nRows = 0;
+        float sumWeights = 0.f;
+        for (int k = 0; k < 4; ++k) {
+            const int sy = 2 * y - 1 + k;
+            if ( (sy < hy1) || (sy >= hy2) ) {
+                continue;
+            }
+            rows[nRows] = &hBuffer[(std::size_t)(sy - hy1) * hRowElements];
+            rowWeights[nRows] = weights[k];
+            sumWeights += weights[k];
+            ++nRows;
+        }
+        assert(nRows > 0);
+        for (int k = 0; k < nRows; ++k) {
+            rowWeights[k] /= sumWeights;
+        }
+        PIX* d = dst.at(dstRect.x1, y);
+        if (nRows == 4) {
+            for (int e = 0; e < hRowElements; ++e) {
+                d[e] = fromFilteredValue<PIX>(rowWeights[0] * rows[0][e] + rowWeights[1] * rows[1][e] + rowWeights[2] * rows[2][e] + rowWeights[3] * rows[3][e]);
+            }
+        } else {
+            for (int e = 0; e < hRowElements; ++e) {
+                float v = 0.f;
+                for (int k = 0; k < nRows; ++k) {
+                    v += rowWeights[k] * rows[k][e];
+                }
+                d[e] = fromFilteredValue<PIX>(v);
+            }
+        }
+    }
+} // halveLevelTent
+
+/*
+ * Builds the rows of strip at the last level. Each level of the strip only holds the rows needed by the next level,
+ * the strips do not share any intermediate data so that they can run concurrently.
+ */
+template <typename PIX>
+void
+downscaleStrip(const DownscaleArgs<PIX>* args,
+               const MipMapStrip& strip)
+{
+    const int levels = (int)args->levelRoI.size() - 1;
+    const int halo = (args->filter == eMipMapFilterTent) ? 1 : 0;
+    std::vector<RectI> rects(levels + 1);
+
+    rects[levels] = RectI(args->levelRoI[levels].x1, strip.y1, args->levelRoI[levels].x2, strip.y2);
+    for (int i = levels - 1; i >= 1; --i) {
+        const RectI& sample = args->sampleBounds[i];
+        rects[i].x1 = std::max(2 * rects[i + 1].x1 - halo, sample.x1);
+        rects[i].x2 = std::min(2 * rects[i + 1].x2 + halo, sample.x2);
+        rects[i].y1 = std::max(2 * rects[i + 1].y1 - halo, sample.y1);
+        rects[i].y2 = std::min(2 * rects[i + 1].y2 + halo, sample.y2);
+    }
+
+    // Consecutive levels alternate between 2 buffers
+    std::vector<PIX> buffers[2];
+    std::vector<char> bitmapBuffers[2];
+    std::vector<float> hBuffer;
+    PlaneView<const PIX> src = args->src;
+    PlaneView<const char> srcBitmap = args->srcBitmap;
+    for (int i = 1; i <= levels; ++i) {
+        PlaneView<PIX> dst = args->dst;
+        PlaneView<char> dstBitmap = args->dstBitmap;
+        if (i < levels) {
+            std::vector<PIX>& buffer = buffers[i & 1];
+            buffer.resize( rects[i].area() * src.nComps );
+            dst = PlaneView<PIX>(&buffer[0], rects[i], src.nComps);
+            if (srcBitmap.data) {
+                std::vector<char>& bitmapBuffer = bitmapBuffers[i & 1];
+                bitmapBuffer.resize( rects[i].area() );
+                dstBitmap = PlaneView<char>(&bitmapBuffer[0], rects[i], 1);
+            }
+        }
+        // The buffer of an intermediate level only holds the rows and columns needed by this strip
+        RectI sampleBounds;
+        args->sampleBounds[i - 1].intersect(src.bounds, &sampleBounds);
+        if (args->filter == eMipMapFilterTent) {
+            halveLevelTent(src, sampleBounds, dst, rects[i], hBuffer);
+        } else {
+            halveLevelBox(src, sampleBounds, dst, rects[i]);
+        }
+        if (srcBitmap.data) {
+            halveBitmapLevel(srcBitmap, sampleBounds, dstBitmap, rects[i]);
+        }
+        src = dst;
+        srcBitmap = dstBitmap;
+    }
+} // downscaleStrip
+
+template <typename PIX>
+struct UpscaleArgs
+{
+    PlaneView<const PIX> src;
+    PlaneView<PIX> dst;
+    RectI srcRoi, dstRoi;
+    int scale;
+};
+
+/*
+ * Replicates each pixel of the rows of strip of the source scale x scale times.
+ * The first pixel of the source roi is replicated from the first pixel of the destination roi, and the last
+ * row and column of the source are replicated up to the end of the destination roi.
+ */
+template <typename PIX>
+void
+upscaleStrip(const UpscaleArgs<PIX>* args,
+             const MipMapStrip& strip)
+{
+    const RectI& srcRoi = args->srcRoi;
+    const RectI& dstRoi = args->dstRoi;
+    const int scale = args->scale;
+    const int nComps = args->src.nComps;
+
+    for (int yi = strip.y1; yi < strip.y2; ++yi) {
+        const int yo1 = dstRoi.y1 + (yi - srcRoi.y1) * scale;
+        const int yo2 = (yi == srcRoi.y2 - 1) ? dstRoi.y2 : std::min(yo1 + scale, dstRoi.y2);
+        if (yo1 >= yo2) {
+            break;
+        }
+        // fill the first line
+        PIX* const dstLineStart = args->dst.at(dstRoi.x1, yo1);
+        const PIX* srcPix = args->src.at(srcRoi.x1, yi);
+        PIX* dstPix = dstLineStart;
+        for (int xi = srcRoi.x1; xi < srcRoi.x2; ++xi, srcPix += nComps) {
+            const int xo1 = dstRoi.x1 + (xi - srcRoi.x1) * scale;
+            const int xo2 = (xi == srcRoi.x2 - 1) ? dstRoi.x2 : std::min(xo1 + scale, dstRoi.x2);
+            for (int xo = xo1; xo < xo2; ++xo, dstPix += nComps) {
+                for (int c = 0; c < nComps; ++c) {
+                    dstPix[c] = srcPix[c];
+                }
+            }
+        }
+        // now replicate the line as many times as necessary
+        const std::size_t lineSize = dstRoi.width() * nComps * sizeof(PIX);
+        for (int yo = yo1 + 1; yo < yo2; ++yo) {
+            std::memcpy(args->dst.at(dstRoi.x1, yo), dstLineStart, lineSize);
+        }
+    }
+}
+
+/*
+ * Splits the rows [y1, y2) in strips of rowsPerStrip rows and processes them with func, on the global thread pool
+ * if it has idle threads and there are enough pixels for each thread.
+ */
+template <typename ARGS>
+void
+processStrips(void (*func)(const ARGS*, const MipMapStrip&),
+              const ARGS* args,
+              int y1,
+              int y2,
+              int rowsPerStrip,
+              std::size_t pixelsCount)
+{
+    std::vector<MipMapStrip> strips;
+
+    for (int y = y1; y < y2; y += rowsPerStrip) {
+        MipMapStrip s;
+        s.y1 = y;
+        s.y2 = std::min(y + rowsPerStrip, y2);
+        strips.push_back(s);
+    }
+
+    QThreadPool* tp = QThreadPool::globalInstance();
+    int nThreads = std::min( (int)strips.size(), tp->maxThreadCount() - tp->activeThreadCount() );
+    if ( (nThreads > 1) && (pixelsCount >= (std::size_t)nThreads * NATRON_MIPMAP_MIN_PIXELS_PER_THREAD) ) {
+        QtConcurrent::blockingMap( strips, boost::bind(func, args, _1) );
+    } else {
+        for (std::size_t i = 0; i < strips.size(); ++i) {
+            func(args, strips[i]);
+        }
+    }
+}
+} // anon namespace
+
+RectI
+Image::getTentSampleBounds(const RectI& roi,
+                           unsigned int levels) const
+{
+    // The pixels of the last level depend on the source pixels up to 2^levels - 1 around their footprint
+    const int halo = (1 << levels) - 1;
+    RectI maxBounds = roi.roundPowerOfTwoSmallestEnclosing(levels);
+
+    maxBounds.x1 -= halo;
+    maxBounds.y1 -= halo;
+    maxBounds.x2 += halo;
+    maxBounds.y2 += halo;
+    if ( !maxBounds.intersect(_bounds, &maxBounds) || !_useBitmap ) {
+        // Without a bitmap, only the pixels of the roi are known to be valid
+        return roi;
+    }
+
+    // Extend the roi on each side where all the pixels are rendered
+    RectI ret = roi;
+    if ( (maxBounds.x1 < roi.x1) && getMinimalRect( RectI(maxBounds.x1, maxBounds.y1, roi.x1, maxBounds.y2) ).isNull() ) {
+        ret.x1 = maxBounds.x1;
+    }
+    if ( (maxBounds.x2 > roi.x2) && getMinimalRect( RectI(roi.x2, maxBounds.y1, maxBounds.x2, maxBounds.y2) ).isNull() ) {
+        ret.x2 = maxBounds.x2;
+    }
+    if ( (maxBounds.y1 < roi.y1) && getMinimalRect( RectI(ret.x1, maxBounds.y1, ret.x2, roi.y1) ).isNull() ) {
+        ret.y1 = maxBounds.y1;
+    }
+    if ( (maxBounds.y2 > roi.y2) && getMinimalRect( RectI(ret.x1, roi.y2, ret.x2, maxBounds.y2) ).isNull() ) {
+        ret.y2 = maxBounds.y2;
+    }
+
+    return ret;
+}
+
+template <typename PIX>
+void
+Image::downscaleMipMapForDepth(const RectI & roi,
+                               unsigned int levels,
+                               bool copyBitMap,
+                               MipMapFilterEnum filter,
+                               Image* output) const
+{
+    assert( (getBitDepth() == eImageBitDepthByte && sizeof(PIX) == 1) ||
+            (getBitDepth() == eImageBitDepthShort && sizeof(PIX) == 2) ||
+            (getBitDepth() == eImageBitDepthFloat && sizeof(PIX) == 4) );
+    assert( getBitDepth() == output->getBitDepth() );
+    assert( getComponents() == output->getComponents() );
+
+    if ( roi.isNull() || (_nbComponents == 0) ) {
+        return;
+    }
+
+    DownscaleArgs<PIX> args;
+    args.filter = filter;
+    args.levelRoI.resize(levels + 1);
+    args.sampleBounds.resize(levels);
+    args.levelRoI[0] = roi;
+    // Computed before locking the regions below, it reads the bitmap
+    args.sampleBounds[0] = (filter == eMipMapFilterTent) ? getTentSampleBounds(roi, levels) : _bounds;
+    for (unsigned int i = 1; i <= levels; ++i) {
+        ///Halve the smallest enclosing po2 rect as we need to render a minimum of the renderWindow
+        args.levelRoI[i] = args.levelRoI[i - 1].downscalePowerOfTwoSmallestEnclosing(1);
+        if (i < levels) {
+            args.sampleBounds[i] = (filter == eMipMapFilterTent) ? args.sampleBounds[i - 1].downscalePowerOfTwoSmallestEnclosing(1) : args.levelRoI[i];
+        }
+    }
+    const RectI& lastLevelRoI = args.levelRoI[levels];
+
+    /// Take the lock for both bitmaps since we're about to read/write from them!
+    /// Only the pixels sampled and written are locked, so that the tiles of the same image can be downscaled concurrently.
+    RegionLocker k1(output, lastLevelRoI, true);
+    RegionLocker k2(this, (filter == eMipMapFilterTent) ? args.sampleBounds[0] : roi.roundPowerOfTwoSmallestEnclosing(levels), false);
+
+    // check that the downscaled mipmap is inside the output image (it may not be equal to it)
+    assert( output->_bounds.contains(lastLevelRoI) );
+
+    args.src = PlaneView<const PIX>( (const PIX*)pixelAt(_bounds.x1, _bounds.y1), _bounds, _nbComponents );
+    args.dst = PlaneView<PIX>( (PIX*)output->pixelAt(output->_bounds.x1, output->_bounds.y1), output->_bounds, _nbComponents );
+    if (copyBitMap) {
+        assert( usesBitMap() && output->usesBitMap() );
+        const RectI& srcBmBounds = _bitmap.getBounds();
+        const RectI& dstBmBounds = output->_bitmap.getBounds();
+        assert(srcBmBounds == _bounds && dstBmBounds == output->_bounds);
+        args.srcBitmap = PlaneView<const char>(_bitmap.getBitmapAt(srcBmBounds.x1, srcBmBounds.y1), srcBmBounds, 1);
+        args.dstBitmap = PlaneView<char>(output->_bitmap.getBitmapAt(dstBmBounds.x1, dstBmBounds.y1), dstBmBounds, 1);
+    }
+
+    const int rowsPerStrip = std::max(1, NATRON_MIPMAP_STRIP_SOURCE_ROWS >> levels);
+    processStrips( &downscaleStrip<PIX>, &args, lastLevelRoI.y1, lastLevelRoI.y2, rowsPerStrip, roi.area() );
+} // downscaleMipMapForDepth
+
+void
+Image::downscaleMipMap(const RectD& dstRod,
+                       const RectI & roi,
+                       unsigned int fromLevel,
+                       unsigned int toLevel,
+                       bool copyBitMap,
+                       Image* output,
+                       MipMapFilterEnum filter) const
+{
+    Q_UNUSED(dstRod);
+    assert(getStorageMode() != eStorageModeGLTex);
+
+    ///You should not call this function with a level equal to 0.
+    assert(toLevel >  fromLevel);
+
+    assert(_bounds.x1 <= roi.x1 && roi.x2 <= _bounds.x2 &&
+           _bounds.y1 <= roi.y1 && roi.y2 <= _bounds.y2);
+
+    assert( !copyBitMap || _bitmap.getBitmap() );
+
+    unsigned int downscaleLvls = toLevel - fromLevel;
+    switch ( getBitDepth() ) {
+    case eImageBitDepthByte:
+        downscaleMipMapForDepth<unsigned char>(roi, downscaleLvls, copyBitMap, filter, output);
+        break;
+    case eImageBitDepthShort:
+        downscaleMipMapForDepth<unsigned short>(roi, downscaleLvls, copyBitMap, filter, output);
+        break;
+    case eImageBitDepthHalf:
+        assert(false);
+        break;
+    case eImageBitDepthFloat:
+        downscaleMipMapForDepth<float>(roi, downscaleLvls, copyBitMap, filter, output);
+        break;
+    case eImageBitDepthNone:
+        break;
+    }
+}
+
+template <typename PIX>
+void
+Image::upscaleMipMapForDepth(const RectI & roi,
+                             unsigned int fromLevel,
+                             unsigned int toLevel,
+                             Image* output) const
+{
+    assert( getBitDepth() == output->getBitDepth() );
+    assert( (getBitDepth() == eImageBitDepthByte && sizeof(PIX) == 1) || (getBitDepth() == eImageBitDepthShort && sizeof(PIX) == 2) || (getBitDepth() == eImageBitDepthFloat && sizeof(PIX) == 4) );
+
+    ///You should not call this function with a level equal to 0.
+    assert(fromLevel > toLevel);
+
+    assert(roi.x1 <= _bounds.x1 && _bounds.x2 <= roi.x2 &&
+           roi.y1 <= _bounds.y1 && _bounds.y2 <= roi.y2);
+
+    ///The source rectangle, intersected to this image region of definition in pixels
+    RectD roiCanonical;
+    roi.toCanonical(fromLevel, _par, getRoD(), &roiCanonical);
+    RectI dstRoi;
+    roiCanonical.toPixelEnclosing(toLevel, _par, &dstRoi);
+
+    dstRoi.intersect(output->_bounds, &dstRoi); //output may be a bit smaller than the upscaled RoI
+
+    assert( output->getComponents() == getComponents() );
+
+    if ( (_nbComponents == 0) || roi.isNull() || dstRoi.isNull() ) {
+        return;
+    }
+
+    RegionLocker k1(output, dstRoi, true);
+    RegionLocker k2(this, roi, false);
+    UpscaleArgs<PIX> args;
+    args.src = PlaneView<const PIX>( (const PIX*)pixelAt(_bounds.x1, _bounds.y1), _bounds, _nbComponents );
+    args.dst = PlaneView<PIX>( (PIX*)output->pixelAt(output->_bounds.x1, output->_bounds.y1), output->_bounds, _nbComponents );
+    args.srcRoi = roi;
+    args.dstRoi = dstRoi;
+    args.scale = 1 << (fromLevel - toLevel);
+
+    const int rowsPerStrip = std::max(1, NATRON_MIPMAP_STRIP_SOURCE_ROWS / args.scale);
+    processStrips( &upscaleStrip<PIX>, &args, roi.y1, roi.y2, rowsPerStrip, dstRoi.area() );
+} // upscaleMipMapForDepth
+
+void
+Image::upscaleMipMap(const RectI & roi,
+                     unsigned int fromLevel,
+                     unsigned int toLevel,
+                     Image* output) const
+{
+    assert(getStorageMode() != eStorageModeGLTex);
+
+    switch ( getBitDepth() ) {
+    case eImageBitDepthByte:
+        upscaleMipMapForDepth<unsigned char>(roi, fromLevel, toLevel, output);
+        break;
+    case eImageBitDepthShort:
+        upscaleMipMapForDepth<unsigned short>(roi, fromLevel, toLevel, output);
+        break;
+    case eImageBitDepthHalf:
+        assert(false);
+        break;
+    case eImageBitDepthFloat:
+        upscaleMipMapForDepth<float>(roi, fromLevel, toLevel, output);
+        break;
+    case eImageBitDepthNone:
+        break;
+    }
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,155 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "ImageRegionLock.h"
+
+#include <cassert>
+#include <list>
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+NATRON_NAMESPACE_ENTER;
+
+struct LockedRegion
+{
+    U64 id;
+    RectI region;
+    bool write;
+
+    // The thread that locked the region: it never waits for its own regions
+    QThread* thread;
+};
+
+struct ImageRegionLockPrivate
+{
+    // Protects all the members below
+    mutable QMutex lock;
+
+    // Woken up each time a region is unlocked
+    QWaitCondition regionUnlocked;
+
+    // There are rarely more regions locked than threads rendering the image: a list is faster than any spatial structure
+    std::list<LockedRegion> lockedRegions;
+    U64 lastId;
+
+    ImageRegionLockPrivate()
+        : lock()
+        , regionUnlocked()
+        , lockedRegions()
+        , lastId(0)
+    {
+    }
+
+    bool isLockedByOtherThread(const RectI& region,
+                               bool write,
+                               QThread* thread) const
+    {
+        for (std::list<LockedRegion>::const_iterator it = lockedRegions.begin(); it != lockedRegions.end(); ++it) {
+            if ( (it->thread != thread) && (write || it->write) && it->region.intersects(region) ) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+ImageRegionLock::ImageRegionLock()
+    : _imp( new ImageRegionLockPrivate() )
+{
+}
+
+ImageRegionLock::~ImageRegionLock()
+{
+    assert( _imp->lockedRegions.empty() );
+}
+
+U64
+ImageRegionLock::lockForRead(const RectI& region)
+{
+    return lockInternal(region, false);
+}
+
+U64
+ImageRegionLock::lockForWrite(const RectI& region)
+{
+    return lockInternal(region, true);
+}
+
+U64
+ImageRegionLock::lockInternal(const RectI& region,
+                              bool write)
+{
+    if ( region.isNull() ) {
+        return 0;
+    }
+
+    QThread* thread = QThread::currentThread();
+    QMutexLocker k(&_imp->lock);
+
+    while ( _imp->isLockedByOtherThread(region, write, thread) ) {
+        _imp->regionUnlocked.wait(&_imp->lock);
+    }
+
+    LockedRegion r;
+    r.id = ++_imp->lastId;
+    r.region = region;
+    r.write = write;
+    r.thread = thread;
+    _imp->lockedRegions.push_back(r);
+
+    return r.id;
+}
+
+void
+ImageRegionLock::unlock(U64 id)
+{
+    if (id == 0) {
+        return;
+    }
+
+    QMutexLocker k(&_imp->lock);
+
+    for (std::list<LockedRegion>::iterator it = _imp->lockedRegions.begin(); it != _imp->lockedRegions.end(); ++it) {
+        if (it->id == id) {
+            _imp->lockedRegions.erase(it);
+            _imp->regionUnlocked.wakeAll();
+
+            return;
+        }
+    }
+    assert(false);
+}
+
+int
+ImageRegionLock::getLockedRegionsCount() const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return (int)_imp->lockedRegions.size();
+}
+
+NATRON_NAMESPACE_EXIT;
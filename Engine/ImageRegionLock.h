@@ -0,0 +1,92 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_IMAGEREGIONLOCK_H
+#define NATRON_ENGINE_IMAGEREGIONLOCK_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/RectI.h"
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Synchronizes the accesses to rectangles of the pixels of an image, so that the threads
+ * rendering disjoint tiles of the same image do not wait for each other.
+ * A region locked for writing excludes the intersecting regions of the other threads, a region locked
+ * for reading only excludes the intersecting regions locked for writing by the other threads.
+ * A thread never waits for the regions it holds itself: like the image lock, this is recursive.
+ *
+ * This does not prevent the buffer of the image from being reallocated: the image lock must be held
+ * for reading while a region is locked, and only resizing the image takes it for writing.
+ **/
+struct ImageRegionLockPrivate;
+class ImageRegionLock
+{
+public:
+
+    ImageRegionLock();
+
+    ~ImageRegionLock();
+
+    /**
+     * @brief Blocks until no other thread holds a region intersecting region for writing, then locks it for reading.
+     * Returns the identifier to pass to unlock(). Locking an empty region does not block and returns 0.
+     **/
+    U64 lockForRead(const RectI& region);
+
+    /**
+     * @brief Blocks until no other thread holds a region intersecting region, then locks it for writing.
+     * Returns the identifier to pass to unlock(). Locking an empty region does not block and returns 0.
+     **/
+    U64 lockForWrite(const RectI& region);
+
+    /**
+     * @brief Releases the region locked under the given identifier. The region may be released by another thread
+     * than the one that locked it.
+     **/
+    void unlock(U64 id);
+
+    /**
+     * @brief Returns the number of regions currently locked, by all threads.
+     **/
+    int getLockedRegionsCount() const;
+
+private:
+
+    U64 lockInternal(const RectI& region, bool write);
+
+    boost::scoped_ptr<ImageRegionLockPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_IMAGEREGIONLOCK_H
@@ -51,6 +51,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/Hash64.h"
 #include "Engine/KnobFile.h"
 #include "Engine/KnobTypes.h"
+#include "Engine/KnobValuesSnapshot.h"
 #include "Engine/LibraryBinary.h"
 #include "Engine/Node.h"
 #include "Engine/Project.h"
@@ -2960,6 +2961,31 @@ catchErrors(PyObject* mainModule,
     return true;
 }
 
+bool
+KnobHelper::getRenderSnapshotValue(bool useCurrentTime,
+                                   double* time,
+                                   int dimension,
+                                   ViewSpec view,
+                                   double* value) const
+{
+    KnobHolderPtr holder = getHolder();
+
+    if (!holder) {
+        return false;
+    }
+    double renderTime;
+    ViewIdx renderView;
+    KnobValuesSnapshotPtr snapshot = holder->getKnobValuesSnapshotTLS(&renderTime, &renderView);
+    if (!snapshot) {
+        return false;
+    }
+    if (useCurrentTime) {
+        *time = renderTime;
+    }
+
+    return snapshot->getValue( this, *time, view.isCurrent() ? renderView : ViewIdx( view.value() ), dimension, value );
+}
+
 bool
 KnobHelper::executeExpression(double time,
                               ViewIdx view,
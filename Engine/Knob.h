@@ -1611,6 +1611,13 @@ protected:
     ///The return value must be Py_DECRREF
     bool executeExpression(double time, ViewIdx view, int dimension, PyObject** ret, std::string* error) const;
 
+    /**
+     * @brief If the calling thread renders a frame with the holder of this knob, returns in value the value of the given dimension
+     * captured when the render started (see KnobValuesSnapshot). If useCurrentTime is true, the time being rendered is used
+     * and returned in time. Returns false if the value was not captured.
+     **/
+    bool getRenderSnapshotValue(bool useCurrentTime, double* time, int dimension, ViewSpec view, double* value) const;
+
 public:
 
     virtual std::pair<int, KnobIPtr > getMaster(int dimension) const OVERRIDE FINAL WARN_UNUSED_RETURN;
@@ -2111,6 +2118,8 @@ public:
 
     bool getValueFromCurve(double time, ViewSpec view, int dimension, bool useGuiCurve, bool byPassMaster, bool clamp, T* ret);
 
+    bool getValueFromRenderSnapshot(bool useCurrentTime, double time, int dimension, ViewSpec view, T* ret) const;
+
     virtual bool hasDefaultValueChanged(int dimension) const OVERRIDE FINAL;
 
 protected:
@@ -2713,6 +2722,16 @@ public:
         return ViewIdx(0);
     }
 
+    /**
+     * @brief If the calling thread renders a frame with this holder, returns the values of its knobs captured when
+     * the render started, along with the time and view being rendered. Returns NULL otherwise.
+     **/
+    virtual KnobValuesSnapshotPtr getKnobValuesSnapshotTLS(double* /*time*/,
+                                                           ViewIdx* /*view*/) const
+    {
+        return KnobValuesSnapshotPtr();
+    }
+
     int getPageIndex(const KnobPagePtr page) const;
 
 
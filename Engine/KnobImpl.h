@@ -693,6 +693,36 @@ Knob<T>::getValueFromMaster(ViewSpec view,
     return T();
 }
 
+template <typename T>
+bool
+Knob<T>::getValueFromRenderSnapshot(bool useCurrentTime,
+                                    double time,
+                                    int dimension,
+                                    ViewSpec view,
+                                    T* ret) const
+{
+    double value;
+
+    if ( !getRenderSnapshotValue(useCurrentTime, &time, dimension, view, &value) ) {
+        return false;
+    }
+    *ret = (T)value;
+
+    return true;
+}
+
+template <>
+bool
+KnobStringBase::getValueFromRenderSnapshot(bool /*useCurrentTime*/,
+                                           double /*time*/,
+                                           int /*dimension*/,
+                                           ViewSpec /*view*/,
+                                           std::string* /*ret*/) const
+{
+    // Strings are not captured
+    return false;
+}
+
 template <typename T>
 T
 Knob<T>::getValue(int dimension,
@@ -709,6 +739,15 @@ Knob<T>::getValue(int dimension,
     if ( ( dimension >= (int)_values.size() ) || (dimension < 0) ) {
         return T();
     }
+
+    // During a render, serve the value captured when the render started, without locking the knob
+    if (clamp) {
+        T ret;
+        if ( getValueFromRenderSnapshot(true, 0., dimension, view, &ret) ) {
+            return ret;
+        }
+    }
+
     std::string hasExpr = getExpression(dimension);
     if ( !hasExpr.empty() ) {
         T ret;
@@ -823,6 +862,15 @@ Knob<T>::getValueAtTime(double time,
     }
 
     bool useGuiValues = QThread::currentThread() == qApp->thread();
+
+    // During a render, serve the value captured when the render started, without locking the knob
+    if (!useGuiValues && clamp && !byPassMaster) {
+        T ret;
+        if ( getValueFromRenderSnapshot(false, time, dimension, view, &ret) ) {
+            return ret;
+        }
+    }
+
     std::string hasExpr = getExpression(dimension);
     if ( !hasExpr.empty() ) {
         T ret;
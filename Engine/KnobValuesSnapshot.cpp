@@ -0,0 +1,157 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "KnobValuesSnapshot.h"
+
+#include <map>
+
+#include "Engine/KnobTypes.h"
+
+NATRON_NAMESPACE_ENTER;
+
+struct KnobValuesSnapshotPrivate
+{
+    struct Key
+    {
+        const KnobI* knob;
+        double time;
+        int view;
+
+        bool operator<(const Key& other) const
+        {
+            if (knob != other.knob) {
+                return knob < other.knob;
+            }
+            if (time != other.time) {
+                return time < other.time;
+            }
+
+            return view < other.view;
+        }
+    };
+
+    // One value per dimension of the knob
+    typedef std::map<Key, std::vector<double> > ValuesMap;
+
+    ValuesMap values;
+
+    KnobValuesSnapshotPrivate()
+        : values()
+    {
+    }
+
+    static Key makeKey(const KnobI* knob,
+                       double time,
+                       ViewIdx view)
+    {
+        Key key;
+
+        key.knob = knob;
+        key.time = time;
+        key.view = view;
+
+        return key;
+    }
+};
+
+KnobValuesSnapshot::KnobValuesSnapshot()
+    : _imp( new KnobValuesSnapshotPrivate() )
+{
+}
+
+KnobValuesSnapshot::~KnobValuesSnapshot()
+{
+}
+
+void
+KnobValuesSnapshot::captureKnobs(const KnobsVec& knobs,
+                                 double time,
+                                 ViewIdx view)
+{
+    std::vector<double> values;
+
+    for (KnobsVec::const_iterator it = knobs.begin(); it != knobs.end(); ++it) {
+        KnobIntBasePtr isInt = toKnobIntBase(*it);
+        KnobBoolBasePtr isBool = toKnobBoolBase(*it);
+        KnobDoubleBasePtr isDouble = toKnobDoubleBase(*it);
+        if (!isInt && !isBool && !isDouble) {
+            continue;
+        }
+
+        int nDims = (*it)->getDimension();
+        bool hasExpression = false;
+        for (int i = 0; i < nDims && !hasExpression; ++i) {
+            hasExpression = !(*it)->getExpression(i).empty();
+        }
+        if (hasExpression) {
+            continue;
+        }
+
+        values.resize(nDims);
+        for (int i = 0; i < nDims; ++i) {
+            if (isInt) {
+                values[i] = isInt->getValueAtTime(time, i, view);
+            } else if (isBool) {
+                values[i] = isBool->getValueAtTime(time, i, view);
+            } else {
+                values[i] = isDouble->getValueAtTime(time, i, view);
+            }
+        }
+        setValues(it->get(), time, view, values);
+    }
+}
+
+void
+KnobValuesSnapshot::setValues(const KnobI* knob,
+                              double time,
+                              ViewIdx view,
+                              const std::vector<double>& values)
+{
+    _imp->values[KnobValuesSnapshotPrivate::makeKey(knob, time, view)] = values;
+}
+
+bool
+KnobValuesSnapshot::getValue(const KnobI* knob,
+                             double time,
+                             ViewIdx view,
+                             int dimension,
+                             double* value) const
+{
+    KnobValuesSnapshotPrivate::ValuesMap::const_iterator found = _imp->values.find( KnobValuesSnapshotPrivate::makeKey(knob, time, view) );
+
+    if ( ( found == _imp->values.end() ) || (dimension < 0) || ( dimension >= (int)found->second.size() ) ) {
+        return false;
+    }
+    *value = found->second[dimension];
+
+    return true;
+}
+
+std::size_t
+KnobValuesSnapshot::getNKnobValues() const
+{
+    return _imp->values.size();
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,91 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_KNOBVALUESSNAPSHOT_H
+#define NATRON_ENGINE_KNOBVALUESSNAPSHOT_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstddef>
+#include <vector>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Engine/ViewIdx.h"
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief The values of the int, bool and double knobs of an effect at the times and views it is rendered,
+ * captured by the ParallelRenderArgsSetter before the render of a frame starts.
+ * During the render, Knob::getValue() and Knob::getValueAtTime() return the captured values instead of reading
+ * the expression, master, curve and value of the knob under their locks: the plug-ins fetching the same parameters
+ * from each tile get them without contention, and a render sees the same values from start to end
+ * even if the user keeps dragging a slider.
+ * Knobs with an expression are not captured, since their values are already cached per time once evaluated.
+ *
+ * The snapshot is filled by the thread setting up the render, then shared read-only by the threads rendering the frame:
+ * it must not be modified once it is given to the ParallelRenderArgs.
+ **/
+struct KnobValuesSnapshotPrivate;
+class KnobValuesSnapshot
+{
+public:
+
+    KnobValuesSnapshot();
+
+    ~KnobValuesSnapshot();
+
+    /**
+     * @brief Captures the values of all the dimensions of the int, bool and double knobs without expression at the given time and view.
+     **/
+    void captureKnobs(const KnobsVec& knobs, double time, ViewIdx view);
+
+    /**
+     * @brief Sets the values of all the dimensions of a knob at the given time and view.
+     **/
+    void setValues(const KnobI* knob, double time, ViewIdx view, const std::vector<double>& values);
+
+    /**
+     * @brief Returns in value the captured value of the knob at the given time, view and dimension.
+     * Returns false if that value was not captured.
+     **/
+    bool getValue(const KnobI* knob, double time, ViewIdx view, int dimension, double* value) const;
+
+    /**
+     * @brief Returns the number of knob, time and view triplets captured
+     **/
+    std::size_t getNKnobValues() const;
+
+private:
+
+    boost::scoped_ptr<KnobValuesSnapshotPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_KNOBVALUESSNAPSHOT_H
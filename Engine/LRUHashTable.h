@@ -42,6 +42,9 @@
 //ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
 //OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <map>
 #include <list>
 #include <utility>
@@ -95,6 +98,184 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
  *
  **/
 
+/**
+ * @brief Greedy-Dual-Size-Frequency priorities of the keys of a cache container, used when
+ * the cost aware eviction is enabled on the container.
+ *
+ * Each key has a priority H = L + frequency * cost / size, where cost is the time it took to render
+ * the entries of the key (as recorded by addRenderCost()), size their size in bytes, and L the
+ * priority of the last evicted key, so that entries which were not accessed for a while age
+ * relatively to the new ones. The key with the lowest priority is evicted first: this is the one
+ * which is the cheapest to recompute per byte freed.
+ *
+ * The render cost of an entry is only known once it has been rendered, that is after it was inserted,
+ * and the Cache may add or remove values of a key directly: priorities are re-evaluated lazily when
+ * a key becomes an eviction candidate (see refresh()).
+ *
+ * Values must be pointers to objects implementing getRenderCost() and getSizeInBytesFromParams().
+ **/
+template <typename K>
+class CacheCostIndex
+{
+public:
+
+    // Keys sorted by increasing priority
+    typedef std::multimap<double, K> priority_map;
+    typedef typename priority_map::iterator iterator;
+
+private:
+
+    struct KeyInfo
+    {
+        iterator priorityIt;
+        double inflation; // value of L when the key was last accessed
+        double frequency;
+    };
+
+    typedef std::map<K, KeyInfo> key_map;
+
+public:
+
+    CacheCostIndex()
+        : _priorities()
+        , _keys()
+        , _inflation(0.)
+    {
+    }
+
+    template <typename LIST>
+    static double getCostPerByte(const LIST& values)
+    {
+        double cost = 0.;
+        double size = 0.;
+
+        for (typename LIST::const_iterator it = values.begin(); it != values.end(); ++it) {
+            cost += (*it)->getRenderCost();
+            size += (double)(*it)->getSizeInBytesFromParams();
+        }
+
+        return cost / std::max(size, 1.);
+    }
+
+    /**
+     * @brief To be called when a key is inserted or accessed
+     **/
+    template <typename LIST>
+    void touch(const K& k,
+               const LIST& values)
+    {
+        typename key_map::iterator found = _keys.find(k);
+
+        if ( found == _keys.end() ) {
+            KeyInfo info;
+            info.inflation = _inflation;
+            info.frequency = 1.;
+            info.priorityIt = _priorities.insert( std::make_pair(_inflation + getCostPerByte(values), k) );
+            _keys.insert( std::make_pair(k, info) );
+        } else {
+            found->second.inflation = _inflation;
+            found->second.frequency += 1.;
+            _priorities.erase(found->second.priorityIt);
+            found->second.priorityIt = _priorities.insert( std::make_pair(getPriority(found->second, values), k) );
+        }
+    }
+
+    /**
+     * @brief To be called when the values of a key changed without it being accessed
+     **/
+    template <typename LIST>
+    void update(const K& k,
+                const LIST& values)
+    {
+        typename key_map::iterator found = _keys.find(k);
+
+        if ( found == _keys.end() ) {
+            touch(k, values);
+
+            return;
+        }
+        _priorities.erase(found->second.priorityIt);
+        found->second.priorityIt = _priorities.insert( std::make_pair(getPriority(found->second, values), k) );
+    }
+
+    /**
+     * @brief Re-evaluates the priority of the key at the given position with its current values.
+     * If it changed, the key is moved and this returns true. The iterator to the next position to visit is
+     * returned in next either way: a key whose priority changed is visited again at its new position.
+     **/
+    template <typename LIST>
+    bool refresh(iterator it,
+                 const LIST& values,
+                 iterator* next)
+    {
+        typename key_map::iterator found = _keys.find(it->second);
+
+        assert( found != _keys.end() );
+        double priority = getPriority(found->second, values);
+        *next = it;
+        ++(*next);
+        if ( std::fabs(priority - it->first) <= 1e-9 * std::max( std::fabs(priority), std::fabs(it->first) ) ) {
+            return false;
+        }
+        _priorities.erase(it);
+        found->second.priorityIt = _priorities.insert( std::make_pair(priority, found->first) );
+        // If the priority decreased below the next position, the key must still be visited
+        if ( ( *next == _priorities.end() ) || ( priority < (*next)->first ) ) {
+            *next = found->second.priorityIt;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief To be called when the value at the given position was evicted: this ages all the keys
+     **/
+    void onEvicted(iterator it)
+    {
+        _inflation = std::max(_inflation, it->first);
+    }
+
+    void erase(const K& k)
+    {
+        typename key_map::iterator found = _keys.find(k);
+
+        if ( found != _keys.end() ) {
+            _priorities.erase(found->second.priorityIt);
+            _keys.erase(found);
+        }
+    }
+
+    void clear()
+    {
+        _priorities.clear();
+        _keys.clear();
+        _inflation = 0.;
+    }
+
+    iterator begin()
+    {
+        return _priorities.begin();
+    }
+
+    iterator end()
+    {
+        return _priorities.end();
+    }
+
+private:
+
+    template <typename LIST>
+    static double getPriority(const KeyInfo& info,
+                              const LIST& values)
+    {
+        return info.inflation + info.frequency * getCostPerByte(values);
+    }
+
+    priority_map _priorities;
+    key_map _keys;
+    double _inflation;
+};
+
 #ifdef USE_VARIADIC_TEMPLATES // c++11 is defined as well as unordered_map
 
 #  ifndef NATRON_CACHE_USE_BOOST
@@ -478,7 +659,24 @@ public:
     typedef boost::bimaps::bimap<boost::bimaps::unordered_set_of<key_type>, boost::bimaps::list_of<value_type> > container_type;
 
     BoostLRUHashTable()
+        : _container()
+        , _costIndex()
+        , _costAwareEviction(false)
+    {
+    }
+
+    /**
+     * @brief When enabled, evict() purges the entries with the lowest render cost per byte
+     * first (see CacheCostIndex) instead of the least recently used ones.
+     **/
+    void setCostAwareEvictionEnabled(bool enabled)
+    {
+        _costAwareEviction = enabled;
+    }
+
+    bool isCostAwareEvictionEnabled() const
     {
+        return _costAwareEviction;
     }
 
     typename container_type::left_iterator operator()(const key_type & k)
@@ -489,6 +687,7 @@ public:
             // We do have it:
             // Update the access record view.
             _container.right.relocate( _container.right.end(), _container.project_right(it) );
+            _costIndex.touch(k, it->second);
         }
 
         return it;
@@ -496,6 +695,7 @@ public:
 
     void erase(typename container_type::left_iterator it)
     {
+        _costIndex.erase(it->first);
         _container.left.erase(it);
     }
 
@@ -515,6 +715,7 @@ public:
                 const value_type& list)
     {
         _container.insert( typename container_type::value_type(k, list) );
+        _costIndex.touch(k, list);
     }
 
     void insert(const key_type & k,
@@ -526,29 +727,38 @@ public:
         typename container_type::left_iterator found = this->operator ()(k);
         if ( found != _container.left.end() ) {
             found->second.push_back(v);
+            _costIndex.update(k, found->second);
         } else {
             value_type list;
             list.push_back(v);
             _container.insert( typename container_type::value_type(k, list) );
+            _costIndex.touch(k, list);
         }
     }
 
     void clear()
     {
         _container.clear();
+        _costIndex.clear();
     }
 
     std::pair<key_type, V> evict()
     {
+        if (_costAwareEviction) {
+            return evictLowestCost();
+        }
+
         typename container_type::right_iterator it = _container.right.begin();
         while ( it != _container.right.end() ) {
             for (typename std::list<V>::iterator it2 = it->first.begin(); it2 != it->first.end(); ++it2) {
                 if (it2->use_count() == 1) {
                     std::pair<key_type, V> ret = std::make_pair(it->second, *it2);
                     if (it->first.size() == 1) {
+                        _costIndex.erase(it->second);
                         _container.right.erase(it);
                     } else {
                         it->first.erase(it2);
+                        _costIndex.update(it->second, it->first);
                     }
 
                     return ret;
@@ -566,7 +776,45 @@ public:
     }
 
 private:
+
+    // Purge the evictable value with the lowest Greedy-Dual-Size-Frequency priority
+    std::pair<key_type, V> evictLowestCost()
+    {
+        typename CacheCostIndex<key_type>::iterator it = _costIndex.begin();
+
+        while ( it != _costIndex.end() ) {
+            typename container_type::left_iterator found = _container.left.find(it->second);
+            assert( found != _container.left.end() );
+            typename CacheCostIndex<key_type>::iterator next;
+            if ( _costIndex.refresh(it, found->second, &next) ) {
+                // The priority was stale, e.g: the entry was rendered since it was inserted
+                it = next;
+                continue;
+            }
+            for (typename std::list<V>::iterator it2 = found->second.begin(); it2 != found->second.end(); ++it2) {
+                if (it2->use_count() == 1) {
+                    std::pair<key_type, V> ret = std::make_pair(found->first, *it2);
+                    _costIndex.onEvicted(it);
+                    if (found->second.size() == 1) {
+                        _costIndex.erase(found->first);
+                        _container.left.erase(found);
+                    } else {
+                        found->second.erase(it2);
+                        _costIndex.update(ret.first, found->second);
+                    }
+
+                    return ret;
+                }
+            }
+            it = next;
+        }
+
+        return std::make_pair( key_type(), V() );
+    }
+
     container_type _container;
+    CacheCostIndex<key_type> _costIndex;
+    bool _costAwareEviction;
 };
 
 #    else // !NATRON_CACHE_USE_HASH
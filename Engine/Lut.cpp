@@ -28,7 +28,9 @@
 #include <algorithm> // min, max
 #include <cassert>
 #include <stdexcept>
+#include <vector>
 
+#include "Engine/LutKernels.h"
 #include "Engine/RectI.h"
 
 /*
@@ -138,7 +140,9 @@ LutManager::LutManager()
 const Lut*
 LutManager::getLut(const std::string & name,
                    fromColorSpaceFunctionV1 fromFunc,
-                   toColorSpaceFunctionV1 toFunc)
+                   toColorSpaceFunctionV1 toFunc,
+                   fromColorSpaceRowFunction fromRowFunc,
+                   toColorSpaceRowFunction toRowFunc)
 {
     LutsMap::iterator found = LutManager::m_instance.luts.find(name);
 
@@ -146,7 +150,7 @@ LutManager::getLut(const std::string & name,
         return found->second;
     } else {
         std::pair<LutsMap::iterator, bool> ret =
-            LutManager::m_instance.luts.insert( std::make_pair( name, new Lut(name, fromFunc, toFunc) ) );
+            LutManager::m_instance.luts.insert( std::make_pair( name, new Lut(name, fromFunc, toFunc, fromRowFunc, toRowFunc) ) );
         assert(ret.second);
 
         return ret.first->second;
@@ -309,14 +313,44 @@ Lut::fromColorSpaceUint16ToLinearFloatFast(unsigned short v) const
     assert(init_);
     // the following is from ImageMagick's quantum.h
     unsigned char v8u_prev = ( v - (v >> 8) ) >> 8;
-    unsigned char v8u_next = v8u_prev + 1;
     unsigned short v16u_prev = (v8u_prev << 8) + v8u_prev;
-    unsigned short v16u_next = (v8u_next << 8) + v8u_next;
     float v32f_prev = fromColorSpaceUint8ToLinearFloatFast(v8u_prev);
-    float v32f_next = fromColorSpaceUint8ToLinearFloatFast(v8u_next);
+    if (v8u_prev == 255) {
+        // v == 65535
+        return v32f_prev;
+    }
+    float v32f_next = fromColorSpaceUint8ToLinearFloatFast(v8u_prev + 1);
 
-    // interpolate linearly
-    return v32f_prev + (v - v16u_prev) * (v32f_next - v32f_prev) / (v16u_next - v16u_prev);
+    // interpolate linearly: consecutive bytes are always 0x101 apart in 16 bits
+    return v32f_prev + (v - v16u_prev) * (v32f_next - v32f_prev) * (1.f / 0x101);
+}
+
+void
+Lut::fromColorSpaceFloatToLinearFloat(const float* from,
+                                      float* to,
+                                      int n) const
+{
+    if (_fromRowFunc) {
+        _fromRowFunc(from, to, n);
+    } else {
+        for (int i = 0; i < n; ++i) {
+            to[i] = _fromFunc(from[i]);
+        }
+    }
+}
+
+void
+Lut::toColorSpaceFloatFromLinearFloat(const float* from,
+                                      float* to,
+                                      int n) const
+{
+    if (_toRowFunc) {
+        _toRowFunc(from, to, n);
+    } else {
+        for (int i = 0; i < n; ++i) {
+            to[i] = _toFunc(from[i]);
+        }
+    }
 }
 
 void
@@ -421,7 +455,9 @@ Lut::to_float_planar(float* to,
                      int outDelta) const
 {
     validate();
-    if (!alpha) {
+    if ( !alpha && (inDelta == 1) && (outDelta == 1) ) {
+        toColorSpaceFloatFromLinearFloat(from, to, W);
+    } else if (!alpha) {
         for (int f = 0, t = 0; f < W; f += inDelta, t += outDelta) {
             to[t] = toColorSpaceFloatFromLinearFloat(from[f]);
         }
@@ -564,6 +600,8 @@ Lut::to_float_packed(float* to,
 
     validate();
 
+    // The RGB values of a row are converted at once by the row function of the lut
+    std::vector<float> rowBuffer( (rect.x2 - rect.x1) * 3 );
     for (int y = rect.y1; y < rect.y2; ++y) {
         int srcY = y;
         if (invertY) {
@@ -573,17 +611,25 @@ Lut::to_float_packed(float* to,
         int dstY = dstBounds.y2 - y - 1;
         const float *src_pixels = from + (srcY * (srcBounds.x2 - srcBounds.x1) * inPackingSize);
         float *dst_pixels = to + (dstY * (dstBounds.x2 - dstBounds.x1) * outPackingSize);
-        /* go fowards from starting point to end of line: */
-        for (int x = rect.x1; x < rect.x2; ++x) {
+        float* buf = &rowBuffer.front();
+        for (int x = rect.x1; x < rect.x2; ++x, buf += 3) {
+            int inCol = x * inPackingSize;
+            float a = (inputHasAlpha && premult) ? src_pixels[inCol + inAOffset] : 1.f;
+            buf[0] = src_pixels[inCol + inROffset] * a;
+            buf[1] = src_pixels[inCol + inGOffset] * a;
+            buf[2] = src_pixels[inCol + inBOffset] * a;
+        }
+        toColorSpaceFloatFromLinearFloat( &rowBuffer.front(), &rowBuffer.front(), (int)rowBuffer.size() );
+        buf = &rowBuffer.front();
+        for (int x = rect.x1; x < rect.x2; ++x, buf += 3) {
             int inCol = x * inPackingSize;
             int outCol = x * outPackingSize;
-            float a = (inputHasAlpha && premult) ? src_pixels[inCol + inAOffset] : 1.f;;
-            dst_pixels[outCol + outROffset] = toColorSpaceFloatFromLinearFloat(src_pixels[inCol + inROffset] * a);
-            dst_pixels[outCol + outGOffset] = toColorSpaceFloatFromLinearFloat(src_pixels[inCol + inGOffset] * a);
-            dst_pixels[outCol + outBOffset] = toColorSpaceFloatFromLinearFloat(src_pixels[inCol + inBOffset] * a);
+            dst_pixels[outCol + outROffset] = buf[0];
+            dst_pixels[outCol + outGOffset] = buf[1];
+            dst_pixels[outCol + outBOffset] = buf[2];
             if (outputHasAlpha) {
                 // alpha is linear and should not be dithered
-                dst_pixels[outCol + outAOffset] = a;
+                dst_pixels[outCol + outAOffset] = (inputHasAlpha && premult) ? src_pixels[inCol + inAOffset] : 1.f;
             }
         }
     }
@@ -629,7 +675,9 @@ Lut::from_float_planar(float* to,
                        int outDelta) const
 {
     validate();
-    if (!alpha) {
+    if ( !alpha && (inDelta == 1) && (outDelta == 1) ) {
+        fromColorSpaceFloatToLinearFloat(from, to, W);
+    } else if (!alpha) {
         for (int f = 0, t = 0; f < W; f += inDelta, t += outDelta) {
             to[t] = fromColorSpaceFloatToLinearFloat(from[f]);
         }
@@ -770,6 +818,8 @@ Lut::from_float_packed(float* to,
 
     validate();
 
+    // The RGB values of a row are converted at once by the row function of the lut
+    std::vector<float> rowBuffer( (rect.x2 - rect.x1) * 3 );
     for (int y = rect.y1; y < rect.y2; ++y) {
         int srcY = y;
         if (invertY) {
@@ -777,19 +827,29 @@ Lut::from_float_packed(float* to,
         }
         const float *src_pixels = from + (srcY * (srcBounds.x2 - srcBounds.x1) * inPackingSize);
         float *dst_pixels = to + (y * (dstBounds.x2 - dstBounds.x1) * outPackingSize);
-        for (int x = rect.x1; x < rect.x2; ++x) {
+        float* buf = &rowBuffer.front();
+        for (int x = rect.x1; x < rect.x2; ++x, buf += 3) {
             int inCol = x * inPackingSize;
-            int outCol = x * outPackingSize;
-            float a = (inputHasAlpha && premult) ? src_pixels[inCol + inAOffset] : 1.f;;
+            float a = (inputHasAlpha && premult) ? src_pixels[inCol + inAOffset] : 1.f;
             float rf = 0., gf = 0., bf = 0.;
             if (a > 0.) {
                 rf = src_pixels[inCol + inROffset] / a;
                 gf = src_pixels[inCol + inGOffset] / a;
                 bf = src_pixels[inCol + inBOffset] / a;
             }
-            dst_pixels[outCol + outROffset] = fromColorSpaceFloatToLinearFloat(rf) * a;
-            dst_pixels[outCol + outGOffset] = fromColorSpaceFloatToLinearFloat(gf) * a;
-            dst_pixels[outCol + outBOffset] = fromColorSpaceFloatToLinearFloat(bf) * a;
+            buf[0] = rf;
+            buf[1] = gf;
+            buf[2] = bf;
+        }
+        fromColorSpaceFloatToLinearFloat( &rowBuffer.front(), &rowBuffer.front(), (int)rowBuffer.size() );
+        buf = &rowBuffer.front();
+        for (int x = rect.x1; x < rect.x2; ++x, buf += 3) {
+            int inCol = x * inPackingSize;
+            int outCol = x * outPackingSize;
+            float a = (inputHasAlpha && premult) ? src_pixels[inCol + inAOffset] : 1.f;
+            dst_pixels[outCol + outROffset] = buf[0] * a;
+            dst_pixels[outCol + outGOffset] = buf[1] * a;
+            dst_pixels[outCol + outBOffset] = buf[2] * a;
             if (outputHasAlpha) {
                 // alpha is linear
                 dst_pixels[outCol + outAOffset] = a;
@@ -1289,7 +1349,7 @@ to_float_packed(float* to,
 const Lut*
 LutManager::sRGBLut()
 {
-    return LutManager::m_instance.getLut("sRGB", from_func_srgb, to_func_srgb);
+    return LutManager::m_instance.getLut("sRGB", from_func_srgb, to_func_srgb, from_func_srgb_row, to_func_srgb_row);
 }
 
 // Rec.709 and Rec.2020 share the same transfer function (and illuminant), except that
@@ -1329,7 +1389,7 @@ to_func_Rec709(float v)
 const Lut*
 LutManager::Rec709Lut()
 {
-    return LutManager::m_instance.getLut("Rec709", from_func_Rec709, to_func_Rec709);
+    return LutManager::m_instance.getLut("Rec709", from_func_Rec709, to_func_Rec709, from_func_Rec709_row, to_func_Rec709_row);
 }
 
 /*
@@ -1369,7 +1429,7 @@ to_func_Cineon(float v)
 const Lut*
 LutManager::CineonLut()
 {
-    return LutManager::m_instance.getLut("Cineon", from_func_Cineon, to_func_Cineon);
+    return LutManager::m_instance.getLut("Cineon", from_func_Cineon, to_func_Cineon, from_func_Cineon_row, to_func_Cineon_row);
 }
 
 /// from Gamma 1.8 to Linear Electro-Optical Transfer Function (EOTF)
@@ -1391,7 +1451,7 @@ to_func_Gamma1_8(float v)
 const Lut*
 LutManager::Gamma1_8Lut()
 {
-    return LutManager::m_instance.getLut("Gamma1_8", from_func_Gamma1_8, to_func_Gamma1_8);
+    return LutManager::m_instance.getLut("Gamma1_8", from_func_Gamma1_8, to_func_Gamma1_8, from_func_Gamma1_8_row, to_func_Gamma1_8_row);
 }
 
 /// from Gamma 2.2 to Linear Electro-Optical Transfer Function (EOTF)
@@ -1413,7 +1473,7 @@ to_func_Gamma2_2(float v)
 const Lut*
 LutManager::Gamma2_2Lut()
 {
-    return LutManager::m_instance.getLut("Gamma2_2", from_func_Gamma2_2, to_func_Gamma2_2);
+    return LutManager::m_instance.getLut("Gamma2_2", from_func_Gamma2_2, to_func_Gamma2_2, from_func_Gamma2_2_row, to_func_Gamma2_2_row);
 }
 
 /// from Panalog to Linear Electro-Optical Transfer Function (EOTF)
@@ -1435,7 +1495,7 @@ to_func_Panalog(float v)
 const Lut*
 LutManager::PanalogLut()
 {
-    return LutManager::m_instance.getLut("Panalog", from_func_Panalog, to_func_Panalog);
+    return LutManager::m_instance.getLut("Panalog", from_func_Panalog, to_func_Panalog, from_func_Panalog_row, to_func_Panalog_row);
 }
 
 /// from REDLog to Linear Electro-Optical Transfer Function (EOTF)
@@ -1457,7 +1517,7 @@ to_func_REDLog(float v)
 const Lut*
 LutManager::REDLogLut()
 {
-    return LutManager::m_instance.getLut("REDLog", from_func_REDLog, to_func_REDLog);
+    return LutManager::m_instance.getLut("REDLog", from_func_REDLog, to_func_REDLog, from_func_REDLog_row, to_func_REDLog_row);
 }
 
 /// from ViperLog to Linear Electro-Optical Transfer Function (EOTF)
@@ -1479,7 +1539,7 @@ to_func_ViperLog(float v)
 const Lut*
 LutManager::ViperLogLut()
 {
-    return LutManager::m_instance.getLut("ViperLog", from_func_ViperLog, to_func_ViperLog);
+    return LutManager::m_instance.getLut("ViperLog", from_func_ViperLog, to_func_ViperLog, from_func_ViperLog_row, to_func_ViperLog_row);
 }
 
 /// from AlexaV3LogC to Linear Electro-Optical Transfer Function (EOTF)
@@ -1503,7 +1563,7 @@ to_func_AlexaV3LogC(float v)
 const Lut*
 LutManager::AlexaV3LogCLut()
 {
-    return LutManager::m_instance.getLut("AlexaV3LogC", from_func_AlexaV3LogC, to_func_AlexaV3LogC);
+    return LutManager::m_instance.getLut("AlexaV3LogC", from_func_AlexaV3LogC, to_func_AlexaV3LogC, from_func_AlexaV3LogC_row, to_func_AlexaV3LogC_row);
 }
 
 /// from SLog1 to Linear Electro-Optical Transfer Function (EOTF)
@@ -1529,7 +1589,7 @@ to_func_SLog1(float v)
 const Lut*
 LutManager::SLog1Lut()
 {
-    return LutManager::m_instance.getLut("SLog1", from_func_SLog1, to_func_SLog1);
+    return LutManager::m_instance.getLut("SLog1", from_func_SLog1, to_func_SLog1, from_func_SLog1_row, to_func_SLog1_row);
 }
 
 /// from SLog2 to Linear Electro-Optical Transfer Function (EOTF)
@@ -1557,7 +1617,7 @@ to_func_SLog2(float v)
 const Lut*
 LutManager::SLog2Lut()
 {
-    return LutManager::m_instance.getLut("SLog2", from_func_SLog2, to_func_SLog2);
+    return LutManager::m_instance.getLut("SLog2", from_func_SLog2, to_func_SLog2, from_func_SLog2_row, to_func_SLog2_row);
 }
 
 
@@ -64,6 +64,12 @@ typedef float (*fromColorSpaceFunctionV1)(float v);
 /* @brief Converts a float ranging in [0 - 1.f] in  linear color-space to the desired color-space to also ranging in [0 - 1.f]*/
 typedef float (*toColorSpaceFunctionV1)(float v);
 
+/* @brief Same as fromColorSpaceFunctionV1 for n contiguous floats. from and to may be the same buffer.*/
+typedef void (*fromColorSpaceRowFunction)(const float* from, float* to, int n);
+
+/* @brief Same as toColorSpaceFunctionV1 for n contiguous floats. from and to may be the same buffer.*/
+typedef void (*toColorSpaceRowFunction)(const float* from, float* to, int n);
+
 
 // a Singleton that holds precomputed LUTs for the whole application.
 // The m_instance member is static and is thus built before the first call to Instance().
@@ -81,9 +87,14 @@ public:
     /**
      * @brief Returns a pointer to a lut with the given name and the given from and to functions.
      * If a lut with the same name didn't already exist, then it will create one.
+     * The row functions are optional faster versions of fromFunc and toFunc used to convert whole rows of floats.
      * WARNING : NOT THREAD-SAFE
      **/
-    static const Lut * getLut(const std::string & name, fromColorSpaceFunctionV1 fromFunc, toColorSpaceFunctionV1 toFunc);
+    static const Lut * getLut(const std::string & name,
+                              fromColorSpaceFunctionV1 fromFunc,
+                              toColorSpaceFunctionV1 toFunc,
+                              fromColorSpaceRowFunction fromRowFunc = NULL,
+                              toColorSpaceRowFunction toRowFunc = NULL);
 
     ///buit-ins color-spaces
     static const Lut* sRGBLut();
@@ -132,6 +143,8 @@ class Lut
     std::string _name;         ///< name of the lut
     fromColorSpaceFunctionV1 _fromFunc;
     toColorSpaceFunctionV1 _toFunc;
+    fromColorSpaceRowFunction _fromRowFunc; ///< may be NULL
+    toColorSpaceRowFunction _toRowFunc; ///< may be NULL
 
     /// the fast lookup tables are mutable, because they are automatically initialized post-construction,
     /// and never change afterwards
@@ -144,10 +157,14 @@ class Lut
     ///private constructor, used by LutManager
     Lut(const std::string & name,
         fromColorSpaceFunctionV1 fromFunc,
-        toColorSpaceFunctionV1 toFunc)
+        toColorSpaceFunctionV1 toFunc,
+        fromColorSpaceRowFunction fromRowFunc,
+        toColorSpaceRowFunction toRowFunc)
         : _name(name)
         , _fromFunc(fromFunc)
         , _toFunc(toFunc)
+        , _fromRowFunc(fromRowFunc)
+        , _toRowFunc(toRowFunc)
         , init_(false)
         , _lock()
     {
@@ -178,6 +195,16 @@ public:
         return _toFunc(v);
     }
 
+    /* @brief Same as fromColorSpaceFloatToLinearFloat(float) for n contiguous floats, using the vectorized
+     * row function of the lut if it has one. from and to may be the same buffer.
+     */
+    void fromColorSpaceFloatToLinearFloat(const float* from, float* to, int n) const;
+
+    /* @brief Same as toColorSpaceFloatFromLinearFloat(float) for n contiguous floats, using the vectorized
+     * row function of the lut if it has one. from and to may be the same buffer.
+     */
+    void toColorSpaceFloatFromLinearFloat(const float* from, float* to, int n) const;
+
     //Called by all public members
     void validate() const
     {
@@ -0,0 +1,697 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "LutKernels.h"
+
+#include <cfloat> // FLT_MIN, FLT_MAX
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NATRON_LUT_KERNELS_USE_SSE2
+#include <emmintrin.h>
+#else
+#include <cstring> // for std::memcpy
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/cstdint.hpp>
+#endif
+#endif
+
+NATRON_NAMESPACE_ENTER;
+
+namespace Color {
+namespace {
+/*
+ * 4 floats processed at once. With SSE2 (always available on x86-64) each operation is a single instruction,
+ * otherwise it is a loop over the 4 lanes.
+ * The compiler does not vectorize the loops below by itself: selects on floats are not if-converted
+ * unless floating-point exceptions are disabled (-fno-trapping-math), which we do not want to require.
+ */
+#ifdef NATRON_LUT_KERNELS_USE_SSE2
+
+struct Vec4f
+{
+    __m128 m;
+
+    Vec4f() {}
+
+    Vec4f(__m128 m_)
+        : m(m_) {}
+
+    Vec4f(float f)
+        : m( _mm_set1_ps(f) ) {}
+
+    static Vec4f load(const float* p) { return _mm_loadu_ps(p); }
+
+    void store(float* p) const { _mm_storeu_ps(p, m); }
+};
+
+inline Vec4f operator+(const Vec4f& a, const Vec4f& b) { return _mm_add_ps(a.m, b.m); }
+inline Vec4f operator-(const Vec4f& a, const Vec4f& b) { return _mm_sub_ps(a.m, b.m); }
+inline Vec4f operator*(const Vec4f& a, const Vec4f& b) { return _mm_mul_ps(a.m, b.m); }
+inline Vec4f operator/(const Vec4f& a, const Vec4f& b) { return _mm_div_ps(a.m, b.m); }
+inline Vec4f vmin(const Vec4f& a, const Vec4f& b) { return _mm_min_ps(a.m, b.m); }
+inline Vec4f vmax(const Vec4f& a, const Vec4f& b) { return _mm_max_ps(a.m, b.m); }
+
+// Comparisons return a mask: all bits set in the lanes where the comparison is true
+inline Vec4f operator<(const Vec4f& a, const Vec4f& b) { return _mm_cmplt_ps(a.m, b.m); }
+inline Vec4f operator<=(const Vec4f& a, const Vec4f& b) { return _mm_cmple_ps(a.m, b.m); }
+inline Vec4f operator>(const Vec4f& a, const Vec4f& b) { return _mm_cmpgt_ps(a.m, b.m); }
+inline Vec4f operator>=(const Vec4f& a, const Vec4f& b) { return _mm_cmpge_ps(a.m, b.m); }
+
+/// Mask of the NaN lanes
+inline Vec4f visnan(const Vec4f& a) { return _mm_cmpunord_ps(a.m, a.m); }
+
+/// mask ? a : b, lane by lane
+inline Vec4f
+vselect(const Vec4f& mask,
+        const Vec4f& a,
+        const Vec4f& b)
+{
+    return _mm_or_ps( _mm_and_ps(mask.m, a.m), _mm_andnot_ps(mask.m, b.m) );
+}
+
+/// Splits x > 0 in m * 2^e with m in [1,2)
+inline void
+vfrexp(const Vec4f& x,
+       Vec4f* m,
+       Vec4f* e)
+{
+    __m128i bits = _mm_castps_si128(x.m);
+    *e = _mm_cvtepi32_ps( _mm_sub_epi32( _mm_srli_epi32(bits, 23), _mm_set1_epi32(127) ) );
+    *m = _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( bits, _mm_set1_epi32(0x007fffff) ), _mm_set1_epi32(0x3f800000) ) );
+}
+
+/// Returns 2^n where n is the integer stored in the low bits of shifted = n + 1.5*2^23
+inline Vec4f
+vldexpShifted(const Vec4f& shifted)
+{
+    __m128i bits = _mm_sub_epi32( _mm_castps_si128(shifted.m), _mm_set1_epi32(0x4b400000 - 127) );
+
+    return _mm_castsi128_ps( _mm_slli_epi32(bits, 23) );
+}
+
+#else // !NATRON_LUT_KERNELS_USE_SSE2
+
+struct Vec4f
+{
+    float v[4];
+
+    Vec4f() {}
+
+    Vec4f(float f)
+    {
+        v[0] = v[1] = v[2] = v[3] = f;
+    }
+
+    static Vec4f load(const float* p)
+    {
+        Vec4f r;
+
+        for (int i = 0; i < 4; ++i) {
+            r.v[i] = p[i];
+        }
+
+        return r;
+    }
+
+    void store(float* p) const
+    {
+        for (int i = 0; i < 4; ++i) {
+            p[i] = v[i];
+        }
+    }
+};
+
+#define NATRON_LUT_KERNELS_LANES(expr) \
+    Vec4f r; \
+    for (int i = 0; i < 4; ++i) { \
+        r.v[i] = (expr); \
+    } \
+    return r;
+
+inline Vec4f operator+(const Vec4f& a, const Vec4f& b) { NATRON_LUT_KERNELS_LANES(a.v[i] + b.v[i]) }
+inline Vec4f operator-(const Vec4f& a, const Vec4f& b) { NATRON_LUT_KERNELS_LANES(a.v[i] - b.v[i]) }
+inline Vec4f operator*(const Vec4f& a, const Vec4f& b) { NATRON_LUT_KERNELS_LANES(a.v[i] * b.v[i]) }
+inline Vec4f operator/(const Vec4f& a, const Vec4f& b) { NATRON_LUT_KERNELS_LANES(a.v[i] / b.v[i]) }
+inline Vec4f vmin(const Vec4f& a, const Vec4f& b) { NATRON_LUT_KERNELS_LANES(a.v[i] < b.v[i] ? a.v[i] : b.v[i]) }
+inline Vec4f vmax(const Vec4f& a, const Vec4f& b) { NATRON_LUT_KERNELS_LANES(a.v[i] > b.v[i] ? a.v[i] : b.v[i]) }
+
+// Comparisons return 1 in the lanes where the comparison is true, 0 otherwise
+inline Vec4f operator<(const Vec4f& a, const Vec4f& b) { NATRON_LUT_KERNELS_LANES(a.v[i] < b.v[i] ? 1.f : 0.f) }
+inline Vec4f operator<=(const Vec4f& a, const Vec4f& b) { NATRON_LUT_KERNELS_LANES(a.v[i] <= b.v[i] ? 1.f : 0.f) }
+inline Vec4f operator>(const Vec4f& a, const Vec4f& b) { NATRON_LUT_KERNELS_LANES(a.v[i] > b.v[i] ? 1.f : 0.f) }
+inline Vec4f operator>=(const Vec4f& a, const Vec4f& b) { NATRON_LUT_KERNELS_LANES(a.v[i] >= b.v[i] ? 1.f : 0.f) }
+
+inline Vec4f visnan(const Vec4f& a) { NATRON_LUT_KERNELS_LANES(a.v[i] != a.v[i] ? 1.f : 0.f) }
+
+inline Vec4f vselect(const Vec4f& mask, const Vec4f& a, const Vec4f& b) { NATRON_LUT_KERNELS_LANES(mask.v[i] != 0.f ? a.v[i] : b.v[i]) }
+
+inline void
+vfrexp(const Vec4f& x,
+       Vec4f* m,
+       Vec4f* e)
+{
+    for (int i = 0; i < 4; ++i) {
+        boost::int32_t bits;
+        std::memcpy( &bits, &x.v[i], sizeof(float) );
+        e->v[i] = (float)( ( (bits >> 23) & 0xff ) - 127 );
+        bits = (bits & 0x007fffff) | 0x3f800000;
+        std::memcpy( &m->v[i], &bits, sizeof(float) );
+    }
+}
+
+inline Vec4f
+vldexpShifted(const Vec4f& shifted)
+{
+    Vec4f r;
+
+    for (int i = 0; i < 4; ++i) {
+        boost::int32_t bits;
+        std::memcpy( &bits, &shifted.v[i], sizeof(float) );
+        bits = (bits - (0x4b400000 - 127) ) << 23;
+        std::memcpy( &r.v[i], &bits, sizeof(float) );
+    }
+
+    return r;
+}
+
+#undef NATRON_LUT_KERNELS_LANES
+
+#endif // NATRON_LUT_KERNELS_USE_SSE2
+
+/// log2(x), with the special values of std::log2: NaN for x < 0 or NaN, -inf for 0, +inf for +inf
+inline Vec4f
+vlog2(const Vec4f& x)
+{
+    // Denormals are scaled by 2^23 to be split like normalized floats
+    Vec4f denormal = x < Vec4f(FLT_MIN);
+    Vec4f m, e;
+    vfrexp(vselect( denormal, vmax(x, 0.f) * 8388608.f, x ), &m, &e);
+    e = vselect(denormal, e - 23.f, e);
+
+    // bring the mantissa in [sqrt(1/2),sqrt(2)) so that t is in [-0.172,0.172)
+    Vec4f big = m > Vec4f(1.41421356f);
+    m = vselect(big, m * 0.5f, m);
+    e = vselect(big, e + 1.f, e);
+
+    // ln(m) = 2 atanh(t) = 2(t + t^3/3 + t^5/5 + ...), the first omitted term is below 1e-9
+    Vec4f t = (m - 1.f) / (m + 1.f);
+    Vec4f t2 = t * t;
+    Vec4f lnm = t * 2.f * ( t2 * ( t2 * ( t2 * ( t2 * (1.f / 9.f) + (1.f / 7.f) ) + (1.f / 5.f) ) + (1.f / 3.f) ) + 1.f );
+    Vec4f r = e + lnm * 1.44269504089f;
+
+    r = vselect( x > Vec4f(FLT_MAX), x, r );
+    r = vselect( x <= Vec4f(0.f), Vec4f( -std::numeric_limits<float>::infinity() ), r );
+    r = vselect( x < Vec4f(0.f), Vec4f( std::numeric_limits<float>::quiet_NaN() ), r );
+
+    // the comparisons are false for NaN
+    return vselect(visnan(x), x, r);
+}
+
+/// 2^f for f in [-0.5,0.5]
+inline Vec4f
+vexp2Reduced(const Vec4f& f)
+{
+    // Taylor expansion of exp(f ln2) of degree 7, the first omitted term is below 6e-9
+    return f * ( f * ( f * ( f * ( f * ( f * ( f * 1.52527338e-5f + 1.54035304e-4f ) + 0.00133335581f ) + 0.00961812911f ) + 0.0555041087f ) + 0.240226507f ) + 0.693147181f ) + 1.f;
+}
+
+/// v * 2^n where n is the integer stored in the low bits of shifted = n + 1.5*2^23, n in [-252,254].
+/// 2^n is applied in 2 steps whose exponents stay in the normalized range, so that the result
+/// overflows to inf and underflows to denormals and 0 like std::pow.
+inline Vec4f
+vscaleShifted(const Vec4f& v,
+              const Vec4f& shifted)
+{
+    Vec4f n = shifted - 12582912.f;
+    Vec4f shiftedHalf = n * 0.5f + 12582912.f; // n/2 rounded, in [-126,127]
+    Vec4f shiftedRest = ( n - (shiftedHalf - 12582912.f) ) + 12582912.f; // in [-126,127]
+
+    return v * vldexpShifted(shiftedHalf) * vldexpShifted(shiftedRest);
+}
+
+/// 2^x, +inf above 128 and 0 below -150, NaN gives NaN
+inline Vec4f
+vexp2(const Vec4f& x)
+{
+    Vec4f clamped = vmin(vmax(x, -252.f), 254.f);
+
+    // Round x to the nearest integer n by adding 1.5*2^23: the low bits of the sum are n.
+    Vec4f shifted = clamped + 12582912.f;
+    Vec4f f = clamped - (shifted - 12582912.f); // in [-0.5,0.5]
+
+    return vselect( visnan(x), x, vscaleShifted(vexp2Reduced(f), shifted) );
+}
+
+/// x^y for x > 0, 0 otherwise
+inline Vec4f
+vpow(const Vec4f& x,
+     float y)
+{
+    return vselect( x <= Vec4f(0.f), Vec4f(0.f), vexp2( vlog2(x) * y ) );
+}
+
+inline Vec4f
+vlog10(const Vec4f& x)
+{
+    return vlog2(x) * 0.301029995664f;
+}
+
+/// 10^x * k, +inf when the product overflows and 0 below 10^-45.9, NaN gives NaN.
+/// k is applied before the power of 2, so that the product does not overflow when 10^x alone would.
+/// Rounding x*log2(10) would lose the low bits of the fractional part for large x (the error grows with |x|),
+/// so x is reduced to x - n*log10(2) first with log10(2) split in 2 floats (Cody-Waite): n*kLog10_2Hi is exact for |n| < 2^11.
+inline Vec4f
+vexp10(const Vec4f& x,
+       float k = 1.f)
+{
+    const float kLog10_2Hi = 0.301025390625f; // 12 significant bits
+    const float kLog10_2Lo = 4.60503898119e-6f;
+    // keep n in the range of vscaleShifted
+    Vec4f clamped = vmin(vmax(x, -75.8f), 76.4f);
+    Vec4f shifted = clamped * 3.32192809489f + 12582912.f;
+    Vec4f n = shifted - 12582912.f;
+    Vec4f r = (clamped - n * kLog10_2Hi) - n * kLog10_2Lo; // in [-0.151,0.151]
+
+    return vselect( visnan(x), x, vscaleShifted(vexp2Reduced(r * 3.32192809489f) * k, shifted) );
+}
+
+/// Applies Curve::apply to n floats, 4 at a time
+template <typename Curve>
+void
+applyRow(const float* from,
+         float* to,
+         int n)
+{
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        Curve::apply( Vec4f::load(from + i) ).store(to + i);
+    }
+    if (i < n) {
+        // pad the remaining values
+        float tmp[4] = { 0.f, 0.f, 0.f, 0.f };
+        for (int j = 0; i + j < n; ++j) {
+            tmp[j] = from[i + j];
+        }
+        Curve::apply( Vec4f::load(tmp) ).store(tmp);
+        for (int j = 0; i + j < n; ++j) {
+            to[i + j] = tmp[j];
+        }
+    }
+}
+
+// Each curve mirrors the corresponding function of Lut.cpp
+
+struct FromSRGB
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        Vec4f lin = vselect( v < Vec4f(0.f), Vec4f(0.f), v * (1.0f / 12.92f) );
+
+        return vselect( v < Vec4f(0.04045f), lin, vpow( (v + 0.055f) * (1.0f / 1.055f), 2.4f ) );
+    }
+};
+
+struct ToSRGB
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        Vec4f lin = vselect( v < Vec4f(0.f), Vec4f(0.f), v * 12.92f );
+
+        return vselect( v < Vec4f(0.0031308f), lin, vpow(v, 1.0f / 2.4f) * 1.055f - 0.055f );
+    }
+};
+
+struct FromRec709
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        Vec4f lin = vselect( v < Vec4f(0.f), Vec4f(0.f), v * (1.0f / 4.5f) );
+
+        return vselect( v < Vec4f(0.08145f), lin, vpow( (v + 0.0993f) * (1.0f / 1.0993f), 1.0f / 0.45f ) );
+    }
+};
+
+struct ToRec709
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        Vec4f lin = vselect( v < Vec4f(0.f), Vec4f(0.f), v * 4.5f );
+
+        return vselect( v < Vec4f(0.0181f), lin, vpow(v, 0.45f) * 1.0993f - (1.0993f - 1.f) );
+    }
+};
+
+struct FromCineon
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        return ( vexp10( (v * 1023.f - 685.f) * 0.002f / Vec4f(0.6f) ) - 0.01079775161f ) * ( 1.f / ( 1.f - 0.01079775161f ) );
+    }
+};
+
+struct ToCineon
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        return ( vlog10( (v + 0.01079775161f) * (1.f - 0.01079775161f) ) * (0.6f / 0.002f) + 685.0f ) * (1.f / 1023.f);
+    }
+};
+
+struct FromGamma1_8
+{
+    static Vec4f apply(const Vec4f& v) { return vpow(v, 1.8f); }
+};
+
+struct ToGamma1_8
+{
+    static Vec4f apply(const Vec4f& v) { return vpow(v, 0.55f); }
+};
+
+struct FromGamma2_2
+{
+    static Vec4f apply(const Vec4f& v) { return vpow(v, 2.2f); }
+};
+
+struct ToGamma2_2
+{
+    static Vec4f apply(const Vec4f& v) { return vpow(v, 0.45f); }
+};
+
+struct FromPanalog
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        return ( vexp10( (v * 1023.f - 681.f) / Vec4f(444.f) ) - 0.0408f ) * ( 1.f / (1.0f - 0.0408f) );
+    }
+};
+
+struct ToPanalog
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        return ( vlog10( v * (1.0f - 0.0408f) + 0.0408f ) * 444.f + 681.f ) * (1.f / 1023.f);
+    }
+};
+
+struct FromREDLog
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        return ( vexp10( (v * 1023.f - 1023.f) / Vec4f(511.f) ) - 0.01f ) * ( 1.f / (1.0f - 0.01f) );
+    }
+};
+
+struct ToREDLog
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        return ( vlog10( v * (1.0f - 0.01f) + 0.01f ) * 511.f + 1023.f ) * (1.f / 1023.f);
+    }
+};
+
+struct FromViperLog
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        return vexp10( (v * 1023.f - 1023.f) / Vec4f(500.f) );
+    }
+};
+
+struct ToViperLog
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        return ( vlog10(v) * 500.f + 1023.f ) * (1.f / 1023.f);
+    }
+};
+
+struct FromAlexaV3LogC
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        Vec4f curve = vexp10( (v - 0.385537f) / Vec4f(0.2471896f) ) * 0.18f - 0.00937677f;
+        Vec4f lin = ( v * (1.f / 0.9661776f) - 0.04378604f ) * 0.18f - 0.00937677f;
+
+        return vselect(v > Vec4f(0.1496582f), curve, lin);
+    }
+};
+
+struct ToAlexaV3LogC
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        Vec4f curve = vlog10(v * 5.555556f + 0.052272f) * 0.247190f + 0.385537f;
+        Vec4f lin = v * 5.367655f + 0.092809f;
+
+        return vselect(v > Vec4f(0.010591f), curve, lin);
+    }
+};
+
+struct FromSLog1
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        Vec4f x = (v * 1023.f - 64.f) * ( 1.f / (940.f - 64.f) );
+        Vec4f curve = vexp10( (x - (0.616596f + 0.03f) ) * (1.f / 0.432699f), 0.9f ) - 0.037584f * 0.9f;
+        Vec4f lin = (x - 0.030001222851889303f) * (0.9f / 5.f);
+
+        return vselect(v >= Vec4f(90.f / 1023.f), curve, lin);
+    }
+};
+
+struct ToSLog1
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        Vec4f curve = ( ( vlog10( v * (1.f / 0.9f) + 0.037584f ) * 0.432699f + (0.616596f + 0.03f) ) * (940.f - 64.f) + 64.f ) * (1.f / 1023.f);
+        Vec4f lin = ( ( v * (5.f / 0.9f) + 0.030001222851889303f ) * (940.f - 64.f) + 64.f ) * (1.f / 1023.f);
+
+        return vselect(v >= Vec4f(-0.00008153227156f), curve, lin);
+    }
+};
+
+struct FromSLog2
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        Vec4f x = (v * 1023.f - 64.f) * ( 1.f / (940.f - 64.f) );
+        Vec4f curve = vexp10( (x - (0.616596f + 0.03f) ) * (1.f / 0.432699f), 219.f / 155.f * 0.9f ) - 0.037584f * (219.f / 155.f * 0.9f);
+        Vec4f lin = (x - 0.030001222851889303f) * (0.9f / 3.53881278538813f);
+
+        return vselect(v >= Vec4f(90.f / 1023.f), curve, lin);
+    }
+};
+
+struct ToSLog2
+{
+    static Vec4f apply(const Vec4f& v)
+    {
+        Vec4f curve = ( ( vlog10( v * (155.f / (0.9f * 219.f) ) + 0.037584f ) * 0.432699f + (0.616596f + 0.03f) ) * (940.f - 64.f) + 64.f ) * (1.f / 1023.f);
+        Vec4f lin = ( ( v * (3.53881278538813f / 0.9f) + 0.030001222851889303f ) * (940.f - 64.f) + 64.f ) * (1.f / 1023.f);
+
+        return vselect(v >= Vec4f(-0.00008153227156f), curve, lin);
+    }
+};
+} // anon namespace
+
+void
+from_func_srgb_row(const float* from,
+                   float* to,
+                   int n)
+{
+    applyRow<FromSRGB>(from, to, n);
+}
+
+void
+to_func_srgb_row(const float* from,
+                 float* to,
+                 int n)
+{
+    applyRow<ToSRGB>(from, to, n);
+}
+
+void
+from_func_Rec709_row(const float* from,
+                     float* to,
+                     int n)
+{
+    applyRow<FromRec709>(from, to, n);
+}
+
+void
+to_func_Rec709_row(const float* from,
+                   float* to,
+                   int n)
+{
+    applyRow<ToRec709>(from, to, n);
+}
+
+void
+from_func_Cineon_row(const float* from,
+                     float* to,
+                     int n)
+{
+    applyRow<FromCineon>(from, to, n);
+}
+
+void
+to_func_Cineon_row(const float* from,
+                   float* to,
+                   int n)
+{
+    applyRow<ToCineon>(from, to, n);
+}
+
+void
+from_func_Gamma1_8_row(const float* from,
+                       float* to,
+                       int n)
+{
+    applyRow<FromGamma1_8>(from, to, n);
+}
+
+void
+to_func_Gamma1_8_row(const float* from,
+                     float* to,
+                     int n)
+{
+    applyRow<ToGamma1_8>(from, to, n);
+}
+
+void
+from_func_Gamma2_2_row(const float* from,
+                       float* to,
+                       int n)
+{
+    applyRow<FromGamma2_2>(from, to, n);
+}
+
+void
+to_func_Gamma2_2_row(const float* from,
+                     float* to,
+                     int n)
+{
+    applyRow<ToGamma2_2>(from, to, n);
+}
+
+void
+from_func_Panalog_row(const float* from,
+                      float* to,
+                      int n)
+{
+    applyRow<FromPanalog>(from, to, n);
+}
+
+void
+to_func_Panalog_row(const float* from,
+                    float* to,
+                    int n)
+{
+    applyRow<ToPanalog>(from, to, n);
+}
+
+void
+from_func_REDLog_row(const float* from,
+                     float* to,
+                     int n)
+{
+    applyRow<FromREDLog>(from, to, n);
+}
+
+void
+to_func_REDLog_row(const float* from,
+                   float* to,
+                   int n)
+{
+    applyRow<ToREDLog>(from, to, n);
+}
+
+void
+from_func_ViperLog_row(const float* from,
+                       float* to,
+                       int n)
+{
+    applyRow<FromViperLog>(from, to, n);
+}
+
+void
+to_func_ViperLog_row(const float* from,
+                     float* to,
+                     int n)
+{
+    applyRow<ToViperLog>(from, to, n);
+}
+
+void
+from_func_AlexaV3LogC_row(const float* from,
+                          float* to,
+                          int n)
+{
+    applyRow<FromAlexaV3LogC>(from, to, n);
+}
+
+void
+to_func_AlexaV3LogC_row(const float* from,
+                        float* to,
+                        int n)
+{
+    applyRow<ToAlexaV3LogC>(from, to, n);
+}
+
+void
+from_func_SLog1_row(const float* from,
+                    float* to,
+                    int n)
+{
+    applyRow<FromSLog1>(from, to, n);
+}
+
+void
+to_func_SLog1_row(const float* from,
+                  float* to,
+                  int n)
+{
+    applyRow<ToSLog1>(from, to, n);
+}
+
+void
+from_func_SLog2_row(const float* from,
+                    float* to,
+                    int n)
+{
+    applyRow<FromSLog2>(from, to, n);
+}
+
+void
+to_func_SLog2_row(const float* from,
+                  float* to,
+                  int n)
+{
+    applyRow<ToSLog2>(from, to, n);
+}
+} // namespace Color
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,96 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_LUTKERNELS_H
+#define NATRON_ENGINE_LUTKERNELS_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+/*
+ * Row versions of the transfer functions of the built-in luts.
+ *
+ * Each kernel converts n contiguous floats and produces the same result as the corresponding
+ * from_func_X/to_func_X function of Lut.cpp, except that std::pow, std::log10 and the powers of 10
+ * are replaced by polynomial approximations of log2 and exp2 evaluated on 4 floats at once (SSE2 on x86).
+ *
+ * Accuracy: log2 is evaluated with the atanh series of the mantissa, exp2 with a degree 7 polynomial
+ * on [-0.5,0.5], both are accurate to a few ulps. 10^x reduces its argument with a 2 floats log10(2) so that
+ * its error does not grow with |x|, and the arguments of the powers of 10 are computed in the same order as
+ * the scalar functions. For inputs in [0,1], the error against the scalar functions |row - scalar| / max(1, |scalar|)
+ * is below NATRON_LUT_KERNELS_MAX_ERROR (checked by Tests/Lut_Test.cpp), which is well under the 16-bit quantization step.
+ * Above 1, the scalar SLog1 and SLog2 "from" functions compute the power of 10 in double precision whereas the kernels
+ * round its argument (up to ~9 for an input of 4) to a float: the error is then bounded by NATRON_LUT_KERNELS_MAX_ERROR_ABOVE_1
+ * for inputs up to 4. All other kernels remain below NATRON_LUT_KERNELS_MAX_ERROR there.
+ * For larger HDR inputs, the argument of exp2 in the powers grows as well and the error is bounded by NATRON_LUT_KERNELS_MAX_ERROR_HDR.
+ *
+ * Special values are the ones of the scalar functions: the log of 0 is -inf and the log of a negative number is NaN,
+ * powers overflow to +inf and underflow to denormals and 0, and NaN inputs give NaN.
+ * The only deviation is for SLog1 and SLog2, whose scalar functions compute in double precision: the kernels
+ * return inf where an intermediate float overflows, i.e for inputs beyond +-3e35 ("from") or above 3e38 ("to"),
+ * whereas the scalar functions return a finite value.
+ */
+#define NATRON_LUT_KERNELS_MAX_ERROR 1e-6f
+#define NATRON_LUT_KERNELS_MAX_ERROR_ABOVE_1 4e-6f
+#define NATRON_LUT_KERNELS_MAX_ERROR_HDR 2e-5f
+
+NATRON_NAMESPACE_ENTER;
+
+namespace Color {
+void from_func_srgb_row(const float* from, float* to, int n);
+void to_func_srgb_row(const float* from, float* to, int n);
+
+void from_func_Rec709_row(const float* from, float* to, int n);
+void to_func_Rec709_row(const float* from, float* to, int n);
+
+void from_func_Cineon_row(const float* from, float* to, int n);
+void to_func_Cineon_row(const float* from, float* to, int n);
+
+void from_func_Gamma1_8_row(const float* from, float* to, int n);
+void to_func_Gamma1_8_row(const float* from, float* to, int n);
+
+void from_func_Gamma2_2_row(const float* from, float* to, int n);
+void to_func_Gamma2_2_row(const float* from, float* to, int n);
+
+void from_func_Panalog_row(const float* from, float* to, int n);
+void to_func_Panalog_row(const float* from, float* to, int n);
+
+void from_func_REDLog_row(const float* from, float* to, int n);
+void to_func_REDLog_row(const float* from, float* to, int n);
+
+void from_func_ViperLog_row(const float* from, float* to, int n);
+void to_func_ViperLog_row(const float* from, float* to, int n);
+
+void from_func_AlexaV3LogC_row(const float* from, float* to, int n);
+void to_func_AlexaV3LogC_row(const float* from, float* to, int n);
+
+void from_func_SLog1_row(const float* from, float* to, int n);
+void to_func_SLog1_row(const float* from, float* to, int n);
+
+void from_func_SLog2_row(const float* from, float* to, int n);
+void to_func_SLog2_row(const float* from, float* to, int n);
+} // namespace Color
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_LUTKERNELS_H
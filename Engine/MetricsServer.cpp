@@ -0,0 +1,342 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "MetricsServer.h"
+
+#include <list>
+#include <map>
+#include <string>
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QMutex>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <QtCore/QThreadPool>
+#include <QtCore/QUrl>
+#include <QtCore/QWaitCondition>
+#include <QtNetwork/QHostAddress>
+CLANG_DIAG_ON(deprecated)
+
+#include "qhttpserver.h"
+#include "qhttprequest.h"
+#include "qhttpresponse.h"
+
+#include "Global/MemoryInfo.h"
+#include "Global/ProcInfo.h"
+
+#include "Engine/AppManager.h"
+#include "Engine/Node.h"
+#include "Engine/RenderProgressReporter.h"
+
+NATRON_NAMESPACE_ENTER;
+
+namespace {
+struct NodeRenderTime
+{
+    NodeWPtr node;
+    std::string name;
+    double timeSpent; // in seconds
+    U64 nRenders;
+};
+
+typedef std::map<const Node*, NodeRenderTime> NodeRenderTimeMap;
+typedef std::map<std::string, RenderProgressRecord> WriterProgressMap;
+
+// Escapes a label value of the Prometheus text format
+QString
+escapeLabel(const std::string& value)
+{
+    QString ret = QString::fromUtf8( value.c_str() );
+
+    ret.replace( QLatin1Char('\\'), QString::fromUtf8("\\\\") );
+    ret.replace( QLatin1Char('"'), QString::fromUtf8("\\\"") );
+    ret.replace( QLatin1Char('\n'), QString::fromUtf8("\\n") );
+
+    return ret;
+}
+
+void
+writeHelp(QTextStream& ts,
+          const char* name,
+          const char* type,
+          const char* help)
+{
+    ts << "# HELP " << name << ' ' << help << '\n';
+    ts << "# TYPE " << name << ' ' << type << '\n';
+}
+}
+
+struct MetricsServerPrivate
+{
+    quint16 port;
+
+    // Protects the fields below
+    mutable QMutex metricsMutex;
+    WriterProgressMap writers;
+    NodeRenderTimeMap nodes;
+
+    // Protects listenStatus
+    QMutex listenMutex;
+    QWaitCondition listenCond;
+    int listenStatus; // -1 while the server is starting, then 1 if it listens or 0 if it failed
+
+    MetricsServerPrivate(quint16 port)
+        : port(port)
+        , metricsMutex()
+        , writers()
+        , nodes()
+        , listenMutex()
+        , listenCond()
+        , listenStatus(-1)
+    {
+    }
+};
+
+MetricsServer::MetricsServer(quint16 port)
+    : QThread()
+    , _imp( new MetricsServerPrivate(port) )
+{
+    setObjectName( QString::fromUtf8("MetricsServer") );
+}
+
+MetricsServer::~MetricsServer()
+{
+}
+
+bool
+MetricsServer::startServer()
+{
+    start();
+
+    QMutexLocker k(&_imp->listenMutex);
+    while (_imp->listenStatus == -1) {
+        _imp->listenCond.wait(&_imp->listenMutex);
+    }
+
+    return _imp->listenStatus == 1;
+}
+
+void
+MetricsServer::quitServer()
+{
+    if ( !isRunning() ) {
+        return;
+    }
+    while ( !wait(50) ) {
+        quit();
+    }
+}
+
+void
+MetricsServer::run()
+{
+    // The server and its connections live in this thread
+    QHttpServer server;
+
+    QObject::connect( &server, SIGNAL(newRequest(QHttpRequest*,QHttpResponse*)), this, SLOT(onRequest(QHttpRequest*,QHttpResponse*)), Qt::DirectConnection );
+    bool ok = server.listen(QHostAddress::LocalHost, _imp->port);
+    {
+        QMutexLocker k(&_imp->listenMutex);
+        _imp->listenStatus = ok ? 1 : 0;
+        _imp->listenCond.wakeAll();
+    }
+    if (!ok) {
+        return;
+    }
+    exec();
+    server.close();
+}
+
+void
+MetricsServer::onFrameRendered(const RenderProgressRecord& record)
+{
+    QMutexLocker k(&_imp->metricsMutex);
+
+    _imp->writers[record.writerName] = record;
+}
+
+void
+MetricsServer::addNodeRenderTime(const NodePtr& node,
+                                 double timeSpent)
+{
+    QMutexLocker k(&_imp->metricsMutex);
+    NodeRenderTimeMap::iterator found = _imp->nodes.find( node.get() );
+
+    // The address of a deleted node may be re-used by another one
+    if ( ( found == _imp->nodes.end() ) || (found->second.node.lock() != node) ) {
+        NodeRenderTime& t = _imp->nodes[node.get()];
+        t.node = node;
+        t.name = node->getFullyQualifiedName();
+        t.timeSpent = timeSpent;
+        t.nRenders = 1;
+
+        return;
+    }
+    found->second.timeSpent += timeSpent;
+    ++found->second.nRenders;
+}
+
+QByteArray
+MetricsServer::getMetrics() const
+{
+    QString metrics;
+    QTextStream ts(&metrics);
+    {
+        QMutexLocker k(&_imp->metricsMutex);
+
+        writeHelp(ts, "natron_frames_rendered_total", "counter", "Number of frames rendered by the writer.");
+        for (WriterProgressMap::const_iterator it = _imp->writers.begin(); it != _imp->writers.end(); ++it) {
+            ts << "natron_frames_rendered_total{writer=\"" << escapeLabel(it->first) << "\"} " << it->second.nFramesRendered << '\n';
+        }
+        writeHelp(ts, "natron_frames", "gauge", "Number of frames the writer has to render.");
+        for (WriterProgressMap::const_iterator it = _imp->writers.begin(); it != _imp->writers.end(); ++it) {
+            ts << "natron_frames{writer=\"" << escapeLabel(it->first) << "\"} " << it->second.nFramesTotal << '\n';
+        }
+        writeHelp(ts, "natron_render_progress_ratio", "gauge", "Progress of the render of the writer, between 0 and 1.");
+        for (WriterProgressMap::const_iterator it = _imp->writers.begin(); it != _imp->writers.end(); ++it) {
+            ts << "natron_render_progress_ratio{writer=\"" << escapeLabel(it->first) << "\"} " << it->second.progress << '\n';
+        }
+        writeHelp(ts, "natron_render_fps", "gauge", "Frames rendered per second by the writer.");
+        for (WriterProgressMap::const_iterator it = _imp->writers.begin(); it != _imp->writers.end(); ++it) {
+            ts << "natron_render_fps{writer=\"" << escapeLabel(it->first) << "\"} " << it->second.fps << '\n';
+        }
+        writeHelp(ts, "natron_node_render_seconds_total", "counter", "Time spent rendering images of the node.");
+        for (NodeRenderTimeMap::const_iterator it = _imp->nodes.begin(); it != _imp->nodes.end(); ++it) {
+            ts << "natron_node_render_seconds_total{node=\"" << escapeLabel(it->second.name) << "\"} " << it->second.timeSpent << '\n';
+        }
+        writeHelp(ts, "natron_node_renders_total", "counter", "Number of images rendered by the node.");
+        for (NodeRenderTimeMap::const_iterator it = _imp->nodes.begin(); it != _imp->nodes.end(); ++it) {
+            ts << "natron_node_renders_total{node=\"" << escapeLabel(it->second.name) << "\"} " << it->second.nRenders << '\n';
+        }
+    }
+
+    std::list<AppManager::CacheStatistics> caches;
+    appPTR->getCachesStatistics(&caches);
+    writeHelp(ts, "natron_cache_memory_bytes", "gauge", "Size of the cache entries held in memory.");
+    for (std::list<AppManager::CacheStatistics>::const_iterator it = caches.begin(); it != caches.end(); ++it) {
+        ts << "natron_cache_memory_bytes{cache=\"" << escapeLabel(it->name) << "\"} " << it->memoryBytes << '\n';
+    }
+    writeHelp(ts, "natron_cache_disk_bytes", "gauge", "Size of the cache entries held on disk.");
+    for (std::list<AppManager::CacheStatistics>::const_iterator it = caches.begin(); it != caches.end(); ++it) {
+        ts << "natron_cache_disk_bytes{cache=\"" << escapeLabel(it->name) << "\"} " << it->diskBytes << '\n';
+    }
+    writeHelp(ts, "natron_cache_hits_total", "counter", "Number of cache lookups that found an entry.");
+    for (std::list<AppManager::CacheStatistics>::const_iterator it = caches.begin(); it != caches.end(); ++it) {
+        ts << "natron_cache_hits_total{cache=\"" << escapeLabel(it->name) << "\"} " << it->hits << '\n';
+    }
+    writeHelp(ts, "natron_cache_misses_total", "counter", "Number of cache lookups that did not find an entry.");
+    for (std::list<AppManager::CacheStatistics>::const_iterator it = caches.begin(); it != caches.end(); ++it) {
+        ts << "natron_cache_misses_total{cache=\"" << escapeLabel(it->name) << "\"} " << it->misses << '\n';
+    }
+
+    QThreadPool* pool = QThreadPool::globalInstance();
+    int activeThreads = pool->activeThreadCount();
+    int maxThreads = pool->maxThreadCount();
+    writeHelp(ts, "natron_thread_pool_active_threads", "gauge", "Number of threads of the global thread pool running a task.");
+    ts << "natron_thread_pool_active_threads " << activeThreads << '\n';
+    writeHelp(ts, "natron_thread_pool_max_threads", "gauge", "Maximum number of threads of the global thread pool.");
+    ts << "natron_thread_pool_max_threads " << maxThreads << '\n';
+    writeHelp(ts, "natron_thread_pool_utilization_ratio", "gauge", "Fraction of the threads of the global thread pool running a task.");
+    ts << "natron_thread_pool_utilization_ratio " << (maxThreads > 0 ? (double)activeThreads / maxThreads : 0.) << '\n';
+    writeHelp(ts, "natron_render_threads", "gauge", "Number of threads currently rendering.");
+    ts << "natron_render_threads " << appPTR->getNRunningThreads() << '\n';
+
+    writeHelp(ts, "natron_python_gil_wait_seconds_total", "counter", "Time threads spent waiting for the Python GIL.");
+    ts << "natron_python_gil_wait_seconds_total " << appPTR->getPythonGILWaitTime() << '\n';
+
+    writeHelp(ts, "natron_process_resident_memory_bytes", "gauge", "Resident memory size of the process.");
+    ts << "natron_process_resident_memory_bytes " << (qulonglong)getCurrentRSS() << '\n';
+    writeHelp(ts, "natron_process_priority", "gauge", "Scheduling priority (nice value) of the process.");
+    ts << "natron_process_priority " << ProcInfo::getCurrentProcessPriority() << '\n';
+
+    ts.flush();
+
+    return metrics.toUtf8();
+} // MetricsServer::getMetrics
+
+void
+MetricsServer::onRequest(QHttpRequest* req,
+                         QHttpResponse* resp)
+{
+    QString page = req->url().toString();
+
+    // get options
+    QString path = page;
+    QStringList options;
+    int queryIndex = page.indexOf( QLatin1Char('?') );
+    if (queryIndex != -1) {
+        path = page.left(queryIndex);
+        options = page.mid(queryIndex + 1).split( QLatin1Char('&') );
+    }
+
+    QHttpResponse::StatusCode status = QHttpResponse::STATUS_OK;
+    QByteArray body;
+    QString contentType = QString::fromUtf8("text/plain; charset=utf-8");
+
+    if ( path == QString::fromUtf8("/metrics") ) {
+        if (req->method() != QHttpRequest::HTTP_GET) {
+            status = QHttpResponse::STATUS_METHOD_NOT_ALLOWED;
+        } else {
+            body = getMetrics();
+            contentType = QString::fromUtf8("text/plain; version=0.0.4; charset=utf-8");
+        }
+    } else if ( path == QString::fromUtf8("/abort") ) {
+        if (req->method() != QHttpRequest::HTTP_POST) {
+            status = QHttpResponse::STATUS_METHOD_NOT_ALLOWED;
+        } else {
+            appPTR->abortAnyProcessing();
+            body = "Aborted\n";
+        }
+    } else if ( path == QString::fromUtf8("/priority") ) {
+        if (req->method() != QHttpRequest::HTTP_POST) {
+            status = QHttpResponse::STATUS_METHOD_NOT_ALLOWED;
+        } else {
+            bool ok = false;
+            int priority = 0;
+            for (QStringList::const_iterator it = options.begin(); it != options.end(); ++it) {
+                if ( it->startsWith( QString::fromUtf8("value=") ) ) {
+                    priority = it->mid(6).toInt(&ok);
+                }
+            }
+            if ( !ok || !ProcInfo::setCurrentProcessPriority(priority) ) {
+                status = QHttpResponse::STATUS_BAD_REQUEST;
+                body = "Invalid priority\n";
+            } else {
+                body = QString::fromUtf8("Priority set to %1\n").arg( ProcInfo::getCurrentProcessPriority() ).toUtf8();
+            }
+        }
+    } else {
+        status = QHttpResponse::STATUS_NOT_FOUND;
+    }
+
+    resp->setHeader( QString::fromUtf8("Content-Length"), QString::number( body.size() ) );
+    resp->setHeader( QString::fromUtf8("Content-Type"), contentType );
+    resp->writeHead(status);
+    resp->end(body);
+} // MetricsServer::onRequest
+
+NATRON_NAMESPACE_EXIT;
+
+NATRON_NAMESPACE_USING;
+#include "moc_MetricsServer.cpp"
@@ -0,0 +1,107 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_MetricsServer_h
+#define Engine_MetricsServer_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QByteArray>
+#include <QtCore/QThread>
+CLANG_DIAG_ON(deprecated)
+
+#include "Engine/EngineFwd.h"
+
+class QHttpServer;
+class QHttpRequest;
+class QHttpResponse;
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief A small HTTP server bound to the loopback interface of a renderer process, so that farm managers can
+ * monitor and steer it without parsing its standard output.
+ * The server runs its own event loop in this thread, so that requests are answered even while the main thread is busy.
+ *
+ * GET /metrics returns the metrics in the Prometheus text exposition format: the progress of each writer,
+ * the render time spent in each node, the cache sizes and hit rates, the thread pool utilization, the time spent waiting for
+ * the Python GIL and the resident memory of the process.
+ * POST /abort aborts all renders.
+ * POST /priority?value=N sets the scheduling priority of the process to the nice value N.
+ **/
+struct MetricsServerPrivate;
+class MetricsServer
+    : public QThread
+{
+GCC_DIAG_SUGGEST_OVERRIDE_OFF
+    Q_OBJECT
+GCC_DIAG_SUGGEST_OVERRIDE_ON
+
+public:
+
+    MetricsServer(quint16 port);
+
+    virtual ~MetricsServer();
+
+    /**
+     * @brief Starts the server thread and waits until it listens.
+     * @returns False if the port could not be bound.
+     **/
+    bool startServer();
+
+    void quitServer();
+
+    /**
+     * @brief Called by the RenderProgressReporter thread for each frame rendered by a writer
+     **/
+    void onFrameRendered(const RenderProgressRecord& record);
+
+    /**
+     * @brief Called by render threads when a node has rendered an image
+     **/
+    void addNodeRenderTime(const NodePtr& node, double timeSpent);
+
+    /**
+     * @brief Returns the current metrics in the Prometheus text exposition format
+     **/
+    QByteArray getMetrics() const;
+
+private Q_SLOTS:
+
+    void onRequest(QHttpRequest* req, QHttpResponse* resp);
+
+private:
+
+    virtual void run() OVERRIDE FINAL;
+    boost::scoped_ptr<MetricsServerPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_MetricsServer_h
@@ -0,0 +1,338 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "MultiProcessRender.h"
+
+#include <algorithm> // min, max
+#include <cassert>
+#include <cstring> // strncpy
+#include <iostream>
+#include <vector>
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QEventLoop>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+CLANG_DIAG_ON(deprecated)
+
+#include "Global/GlobalDefines.h"
+#include "Global/ProcInfo.h"
+
+#include "Engine/AppManager.h"
+#include "Engine/OutputEffectInstance.h"
+#include "Engine/ProcessHandler.h"
+#include "Engine/RenderProgressReporter.h"
+#include "Engine/Timer.h"
+
+// Frames are handed out by chunks of at least this size: each chunk costs a project load in the renderer process
+#define NATRON_MULTI_PROCESS_RENDER_MIN_CHUNK_SIZE 4
+
+NATRON_NAMESPACE_ENTER;
+
+struct RenderProcessSlot
+{
+    int numaNode; // -1 if the process is not bound to a NUMA node
+    ProcessHandler* process; // the process rendering a chunk, or NULL if idle
+
+    RenderProcessSlot()
+        : numaNode(-1)
+        , process(0)
+    {
+    }
+};
+
+struct MultiProcessRenderPrivate
+{
+    MultiProcessRender* _publicInterface;
+    QString projectPath;
+    OutputEffectInstancePtr writer;
+    int frameStep;
+    bool enableRenderStats;
+
+    // All frames to render, handed out in order
+    std::vector<int> frames;
+    std::size_t nextFrameIndex;
+    std::vector<RenderProcessSlot> processes;
+    int nFramesRendered;
+    int returnCode;
+    bool aborted;
+    QEventLoop loop;
+    boost::scoped_ptr<TimeLapse> renderTimer;
+
+    MultiProcessRenderPrivate(MultiProcessRender* publicInterface,
+                              const QString& projectPath,
+                              const OutputEffectInstancePtr& writer,
+                              int frameStep,
+                              bool enableRenderStats)
+        : _publicInterface(publicInterface)
+        , projectPath(projectPath)
+        , writer(writer)
+        , frameStep(frameStep)
+        , enableRenderStats(enableRenderStats)
+        , frames()
+        , nextFrameIndex(0)
+        , processes()
+        , nFramesRendered(0)
+        , returnCode(0)
+        , aborted(false)
+        , loop()
+        , renderTimer()
+    {
+    }
+
+    /**
+     * @brief Starts a new process on the given slot to render the next chunk of frames.
+     * Returns false if there is no frame left to render.
+     **/
+    bool startNextChunk(RenderProcessSlot* slot);
+
+    int getRunningProcessesCount() const;
+
+    void cancelRunningProcesses();
+};
+
+MultiProcessRender::MultiProcessRender(const QString& projectPath,
+                                       const OutputEffectInstancePtr& writer,
+                                       int firstFrame,
+                                       int lastFrame,
+                                       int frameStep,
+                                       int nProcesses,
+                                       bool enableRenderStats)
+    : QObject()
+    , _imp( new MultiProcessRenderPrivate(this, projectPath, writer, std::max(1, frameStep), enableRenderStats) )
+{
+    for (int i = firstFrame; i <= lastFrame; i += _imp->frameStep) {
+        _imp->frames.push_back(i);
+    }
+
+    int nNUMANodes = ProcInfo::getNUMANodesCount();
+    _imp->processes.resize( std::max(1, nProcesses) );
+    for (std::size_t i = 0; i < _imp->processes.size(); ++i) {
+        if (nNUMANodes > 1) {
+            _imp->processes[i].numaNode = (int)i % nNUMANodes;
+        }
+    }
+
+    // abortAnyProcessing may be called from any thread: the connection is queued to the event loop of blockingRender
+    QObject::connect( appPTR, SIGNAL(anyProcessingAborted()), this, SLOT(onAbortRequested()) );
+}
+
+MultiProcessRender::~MultiProcessRender()
+{
+    for (std::size_t i = 0; i < _imp->processes.size(); ++i) {
+        delete _imp->processes[i].process;
+    }
+}
+
+bool
+MultiProcessRenderPrivate::startNextChunk(RenderProcessSlot* slot)
+{
+    assert(!slot->process);
+    std::size_t nRemaining = frames.size() - nextFrameIndex;
+    if (nRemaining == 0) {
+        return false;
+    }
+
+    // Guided scheduling: large chunks first, then smaller ones so that processes finish at about the same time
+    std::size_t chunkSize = std::max<std::size_t>( NATRON_MULTI_PROCESS_RENDER_MIN_CHUNK_SIZE, nRemaining / (2 * processes.size()) );
+    chunkSize = std::min(chunkSize, nRemaining);
+    int firstFrame = frames[nextFrameIndex];
+    int lastFrame = frames[nextFrameIndex + chunkSize - 1];
+    nextFrameIndex += chunkSize;
+
+    QStringList args;
+    args << QString::fromUtf8("%1-%2:%3").arg(firstFrame).arg(lastFrame).arg(frameStep);
+    // Processes may not write concurrently to the disk cache
+    args << QString::fromUtf8("--read-only-cache");
+    if (slot->numaNode != -1) {
+        args << QString::fromUtf8("--numa-node") << QString::number(slot->numaNode);
+    }
+    if (enableRenderStats) {
+        args << QString::fromUtf8("--render-stats");
+    }
+
+    slot->process = new ProcessHandler(projectPath, writer, args);
+    QObject::connect( slot->process, SIGNAL(frameRendered(int,double)), _publicInterface, SLOT(onProcessFrameRendered(int,double)) );
+    QObject::connect( slot->process, SIGNAL(processFinished(int)), _publicInterface, SLOT(onProcessFinished(int)) );
+    slot->process->startProcess();
+
+    return true;
+}
+
+int
+MultiProcessRenderPrivate::getRunningProcessesCount() const
+{
+    int ret = 0;
+
+    for (std::size_t i = 0; i < processes.size(); ++i) {
+        if (processes[i].process) {
+            ++ret;
+        }
+    }
+
+    return ret;
+}
+
+void
+MultiProcessRenderPrivate::cancelRunningProcesses()
+{
+    for (std::size_t i = 0; i < processes.size(); ++i) {
+        if (processes[i].process) {
+            processes[i].process->onProcessCanceled();
+        }
+    }
+}
+
+int
+MultiProcessRender::blockingRender()
+{
+    if ( _imp->frames.empty() ) {
+        return 0;
+    }
+
+    _imp->renderTimer.reset(new TimeLapse);
+    for (std::size_t i = 0; i < _imp->processes.size(); ++i) {
+        if ( !_imp->startNextChunk(&_imp->processes[i]) ) {
+            break;
+        }
+    }
+
+    // The processes report through the event loop
+    if (_imp->getRunningProcessesCount() > 0) {
+        _imp->loop.exec();
+    }
+
+    // Report all frames before the end of the render
+    RenderProgressReporter* reporter = appPTR->getRenderProgressReporter();
+    if (reporter) {
+        reporter->flush();
+    }
+
+    return _imp->returnCode;
+}
+
+void
+MultiProcessRender::onProcessFrameRendered(int frame,
+                                           double /*progress*/)
+{
+    ++_imp->nFramesRendered;
+
+    double nbTotalFrames = (double)_imp->frames.size();
+    double percentage = std::min(1., _imp->nFramesRendered / nbTotalFrames);
+    double timeSpentSinceStartSec = _imp->renderTimer->getTimeSinceCreation();
+    double estimatedFps = (double)_imp->nFramesRendered / timeSpentSinceStartSec;
+    double timeRemaining = timeSpentSinceStartSec * (1. - percentage) / percentage;
+
+    // Report the merged progress of all processes as if it was a single render. Going through the
+    // reporter honours the progress format and interval and feeds the metrics endpoint.
+    RenderProgressReporter* reporter = appPTR->getRenderProgressReporter();
+    if (reporter) {
+        RenderProgressRecord record;
+        std::strncpy(record.writerName, _imp->writer->getScriptName_mt_safe().c_str(), NATRON_RENDER_PROGRESS_WRITER_NAME_SIZE - 1);
+        record.writerName[NATRON_RENDER_PROGRESS_WRITER_NAME_SIZE - 1] = '\0';
+        record.frame = frame;
+        record.nFramesRendered = (unsigned int)_imp->nFramesRendered;
+        record.nFramesTotal = (unsigned int)_imp->frames.size();
+        record.progress = percentage;
+        record.fps = estimatedFps;
+        record.timeRemaining = timeRemaining;
+        reporter->postFrameRendered(record);
+
+        return;
+    }
+
+    QString longMessage;
+    QTextStream ts(&longMessage);
+    QString frameStr = QString::number(frame);
+    ts << _imp->writer->getScriptName_mt_safe().c_str() << tr(" ==> Frame: ");
+    ts << frameStr << tr(", Progress: ") << QString::number(percentage * 100, 'f', 1) << "%, " << QString::number(estimatedFps, 'f', 1);
+    ts << tr(" Fps, Time Remaining: ") << Timer::printAsTime(timeRemaining, true);
+    ts.flush();
+
+    QString shortMessage = QString::fromUtf8(kFrameRenderedStringShort) + frameStr + QString::fromUtf8(kProgressChangedStringShort) + QString::number(percentage);
+    appPTR->writeToOutputPipe(longMessage, shortMessage, true);
+}
+
+void
+MultiProcessRender::onProcessFinished(int retCode)
+{
+    ProcessHandler* process = qobject_cast<ProcessHandler*>( sender() );
+    RenderProcessSlot* slot = 0;
+
+    for (std::size_t i = 0; i < _imp->processes.size(); ++i) {
+        if (_imp->processes[i].process == process) {
+            slot = &_imp->processes[i];
+            break;
+        }
+    }
+    if (!slot) {
+        return;
+    }
+
+    slot->process = 0;
+    // We are in a slot of the process, it cannot be deleted right away
+    process->deleteLater();
+
+    // Once aborted, canceled processes are not reported as failures and no new chunk is started
+    if (!_imp->aborted) {
+        if ( (retCode != 0) && (_imp->returnCode == 0) ) {
+            _imp->returnCode = retCode;
+            std::cerr << tr("A render process failed, aborting the render. Log of the process:").toStdString() << std::endl;
+            std::cerr << process->getProcessLog().toStdString() << std::endl;
+
+            // Abort the other processes, the render is failed anyway
+            _imp->cancelRunningProcesses();
+        } else if (_imp->returnCode == 0) {
+            _imp->startNextChunk(slot);
+        }
+    }
+
+    if (_imp->getRunningProcessesCount() == 0) {
+        _imp->loop.quit();
+    }
+}
+
+bool
+MultiProcessRender::isAborted() const
+{
+    return _imp->aborted;
+}
+
+void
+MultiProcessRender::onAbortRequested()
+{
+    if (_imp->aborted) {
+        return;
+    }
+    _imp->aborted = true;
+    if (_imp->returnCode == 0) {
+        _imp->returnCode = 1;
+    }
+    _imp->cancelRunningProcesses();
+}
+
+NATRON_NAMESPACE_EXIT;
+
+NATRON_NAMESPACE_USING;
+#include "moc_MultiProcessRender.cpp"
@@ -0,0 +1,101 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef MULTIPROCESSRENDER_H
+#define MULTIPROCESSRENDER_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QObject>
+#include <QtCore/QString>
+CLANG_DIAG_ON(deprecated)
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Renders the frame range of a writer with several renderer processes, each one started with a ProcessHandler.
+ * The frame range is split in chunks handed out to the processes as soon as they are idle: chunks get smaller as
+ * the render progresses so that all processes finish at about the same time.
+ * On machines with several NUMA nodes, processes are bound to the nodes in a round-robin fashion so that each
+ * process only accesses memory local to its node.
+ * The progress of all processes is merged and reported as if a single process was rendering.
+ * When the processing of this process is aborted (see AppManager::abortAnyProcessing) the abort is
+ * forwarded to all render processes.
+ **/
+struct MultiProcessRenderPrivate;
+class MultiProcessRender
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief The project at projectPath must contain the writer, it is loaded by each process.
+     **/
+    MultiProcessRender(const QString& projectPath,
+                       const OutputEffectInstancePtr& writer,
+                       int firstFrame,
+                       int lastFrame,
+                       int frameStep,
+                       int nProcesses,
+                       bool enableRenderStats);
+
+    virtual ~MultiProcessRender();
+
+    /**
+     * @brief Renders all frames and returns once all processes are finished.
+     * Returns 0 on success, or the return code of the first process that failed
+     * (see ProcessHandler::processFinished), or 1 if the render was aborted.
+     **/
+    int blockingRender();
+
+    /**
+     * @brief Returns true if the render was aborted by a call to AppManager::abortAnyProcessing
+     **/
+    bool isAborted() const;
+
+public Q_SLOTS:
+
+    void onProcessFrameRendered(int frame, double progress);
+
+    void onProcessFinished(int retCode);
+
+    void onAbortRequested();
+
+private:
+
+    boost::scoped_ptr<MultiProcessRenderPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // MULTIPROCESSRENDER_H
@@ -0,0 +1,420 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "MultiThreadTeam.h"
+
+#include <algorithm> // min
+#include <cassert>
+#include <list>
+#include <vector>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include "Engine/ThreadPool.h"
+
+NATRON_NAMESPACE_ENTER;
+
+namespace {
+// Returns true if the spin started with timer lasted NATRON_MULTI_THREAD_TEAM_SPIN_US.
+// The clock is only read every few iterations, reading it costs more than checking the atomic flags.
+inline bool
+isSpinOver(const QElapsedTimer& timer,
+           int iteration)
+{
+    return ( (iteration & 15) == 15 ) && ( timer.nsecsElapsed() >= (qint64)NATRON_MULTI_THREAD_TEAM_SPIN_US * 1000 );
+}
+} // anon namespace
+
+class MultiThreadTeamThread;
+
+struct MultiThreadTeamPrivate
+{
+    std::vector<MultiThreadTeamThread*> threads;
+
+    // Set while a job runs, so that a job calling run() again runs its tasks in the calling thread
+    QAtomicInt running;
+
+    // The job being run. They are only written by the thread calling run() before the job is given to the threads.
+    MultiThreadTeamJob* job;
+    unsigned int nTasks;
+
+    // Index of the next task to run
+    QAtomicInt nextTask;
+
+    // Number of threads of the team which did not finish the job yet
+    QAtomicInt pendingThreads;
+
+    // Set while the thread calling run() sleeps waiting for the other threads
+    QAtomicInt callerParked;
+
+    // Set when the team is destroyed
+    QAtomicInt quit;
+
+    // Protects the sleeping threads from missing a wake-up
+    QMutex parkMutex;
+    QWaitCondition jobFinishedCond;
+
+    MultiThreadTeamPrivate()
+        : threads()
+        , running()
+        , job(0)
+        , nTasks(0)
+        , nextTask()
+        , pendingThreads()
+        , callerParked()
+        , quit()
+        , parkMutex()
+        , jobFinishedCond()
+    {
+    }
+
+    void runTasks()
+    {
+        for (;;) {
+            int task = nextTask.fetchAndAddRelaxed(1);
+            if ( task >= (int)nTasks ) {
+                return;
+            }
+            job->runTask( (unsigned int)task, nTasks );
+        }
+    }
+
+    void postJob(MultiThreadTeamThread* thread);
+
+    void onThreadFinishedJob()
+    {
+        // The job must not be accessed past this point: the caller may already be posting the next one
+        if (pendingThreads.fetchAndAddOrdered(-1) == 1) {
+            if ( callerParked.fetchAndAddOrdered(0) ) {
+                QMutexLocker k(&parkMutex);
+                jobFinishedCond.wakeAll();
+            }
+        }
+    }
+
+    void waitForThreads()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; !isSpinOver(timer, i); ++i) {
+            if (pendingThreads.fetchAndAddAcquire(0) == 0) {
+                return;
+            }
+        }
+
+        QMutexLocker k(&parkMutex);
+        callerParked.fetchAndStoreOrdered(1);
+        while (pendingThreads.fetchAndAddOrdered(0) != 0) {
+            jobFinishedCond.wait(&parkMutex);
+        }
+        callerParked.fetchAndStoreOrdered(0);
+    }
+};
+
+class MultiThreadTeamThread
+    : public QThread
+      , public AbortableThread
+{
+public:
+
+    MultiThreadTeamThread(MultiThreadTeamPrivate* team)
+        : QThread()
+        , AbortableThread(this)
+        , jobPosted()
+        , parked()
+        , jobPostedCond()
+        , _team(team)
+    {
+        setThreadName("Multi-thread team");
+    }
+
+    virtual ~MultiThreadTeamThread()
+    {
+    }
+
+    // Set by the thread calling run() when it gives a job to this thread, and back by this thread when it takes it
+    QAtomicInt jobPosted;
+
+    // Set while this thread sleeps waiting for a job
+    QAtomicInt parked;
+    QWaitCondition jobPostedCond;
+
+private:
+
+    virtual void run() OVERRIDE FINAL
+    {
+        while ( waitForJob() ) {
+            _team->runTasks();
+            _team->job->finishThread();
+            _team->onThreadFinishedJob();
+        }
+    }
+
+    /*
+     * Returns true when a job was posted, false when the team is destroyed
+     */
+    bool waitForJob()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; !isSpinOver(timer, i); ++i) {
+            if ( jobPosted.testAndSetAcquire(1, 0) ) {
+                return true;
+            }
+            if ( _team->quit.fetchAndAddRelaxed(0) ) {
+                return false;
+            }
+        }
+
+        QMutexLocker k(&_team->parkMutex);
+        parked.fetchAndStoreOrdered(1);
+        while ( !jobPosted.testAndSetOrdered(1, 0) ) {
+            if ( _team->quit.fetchAndAddRelaxed(0) ) {
+                parked.fetchAndStoreOrdered(0);
+
+                return false;
+            }
+            jobPostedCond.wait(&_team->parkMutex);
+        }
+        parked.fetchAndStoreOrdered(0);
+
+        return true;
+    }
+
+    MultiThreadTeamPrivate* _team;
+};
+
+void
+MultiThreadTeamPrivate::postJob(MultiThreadTeamThread* thread)
+{
+    // Either the thread sees the job before going to sleep, or we see that it sleeps and wake it up
+    thread->jobPosted.fetchAndStoreOrdered(1);
+    if ( thread->parked.fetchAndAddOrdered(0) ) {
+        QMutexLocker k(&parkMutex);
+        thread->jobPostedCond.wakeOne();
+    }
+}
+
+MultiThreadTeam::MultiThreadTeam(unsigned int nThreads)
+    : _imp( new MultiThreadTeamPrivate() )
+{
+    for (unsigned int i = 1; i < nThreads; ++i) {
+        MultiThreadTeamThread* thread = new MultiThreadTeamThread( _imp.get() );
+        _imp->threads.push_back(thread);
+        thread->start();
+    }
+}
+
+MultiThreadTeam::~MultiThreadTeam()
+{
+    assert( !_imp->running.fetchAndAddRelaxed(0) );
+    {
+        QMutexLocker k(&_imp->parkMutex);
+        _imp->quit.fetchAndStoreOrdered(1);
+        for (std::size_t i = 0; i < _imp->threads.size(); ++i) {
+            _imp->threads[i]->jobPostedCond.wakeOne();
+        }
+    }
+    for (std::size_t i = 0; i < _imp->threads.size(); ++i) {
+        _imp->threads[i]->wait();
+        delete _imp->threads[i];
+    }
+}
+
+unsigned int
+MultiThreadTeam::getNThreads() const
+{
+    return (unsigned int)_imp->threads.size() + 1;
+}
+
+void
+MultiThreadTeam::run(MultiThreadTeamJob* job,
+                     unsigned int nTasks,
+                     unsigned int nThreads)
+{
+    assert(job);
+    unsigned int nTeamThreads = std::min( std::min(nThreads, nTasks), getNThreads() );
+
+    // A task calling run() again would wait for threads which are all busy: run its tasks in its own thread instead
+    if ( (nTeamThreads <= 1) || !_imp->running.testAndSetAcquire(0, 1) ) {
+        for (unsigned int i = 0; i < nTasks; ++i) {
+            job->runTask(i, nTasks);
+        }
+
+        return;
+    }
+
+    _imp->job = job;
+    _imp->nTasks = nTasks;
+    _imp->nextTask.fetchAndStoreRelaxed(0);
+    _imp->pendingThreads.fetchAndStoreOrdered(nTeamThreads - 1);
+
+    // Only the first threads of the team are given the job, the others keep sleeping
+    for (unsigned int i = 0; i < nTeamThreads - 1; ++i) {
+        job->prepareThread(_imp->threads[i]);
+        _imp->postJob(_imp->threads[i]);
+    }
+
+    _imp->runTasks();
+    _imp->waitForThreads();
+
+    _imp->job = 0;
+    _imp->running.fetchAndStoreRelease(0);
+}
+
+bool
+MultiThreadTeam::isTeamThread()
+{
+    return dynamic_cast<MultiThreadTeamThread*>( QThread::currentThread() ) != 0;
+}
+
+struct MultiThreadTeamPoolPrivate
+{
+    mutable QMutex lock;
+    std::list<MultiThreadTeamPtr> idleTeams;
+
+    // Bound on nThreads
+    int maxThreads;
+
+    // Number of threads started by the teams handed out or idle
+    int nThreads;
+
+    MultiThreadTeamPoolPrivate(int maxThreads)
+        : lock()
+        , idleTeams()
+        , maxThreads(maxThreads)
+        , nThreads(0)
+    {
+    }
+
+    /*
+     * Removes the team from the idle teams and moves it to evicted, which must be destroyed outside of the lock
+     */
+    void evictTeam(std::list<MultiThreadTeamPtr>::iterator it,
+                   std::list<MultiThreadTeamPtr>* evicted)
+    {
+        nThreads -= (int)(*it)->getNThreads() - 1;
+        assert(nThreads >= 0);
+        evicted->push_back(*it);
+        idleTeams.erase(it);
+    }
+};
+
+MultiThreadTeamPool::MultiThreadTeamPool(int maxThreads)
+    : _imp( new MultiThreadTeamPoolPrivate( (maxThreads > 0) ? maxThreads : NATRON_MULTI_THREAD_TEAM_MAX_THREADS_PER_CPU * std::max(1, QThread::idealThreadCount() ) ) )
+{
+}
+
+MultiThreadTeamPool::~MultiThreadTeamPool()
+{
+}
+
+MultiThreadTeamPtr
+MultiThreadTeamPool::acquireTeam(unsigned int nThreads)
+{
+    // The threads of the evicted teams are stopped outside of the lock
+    std::list<MultiThreadTeamPtr> evicted;
+    int teamThreads;
+    {
+        QMutexLocker k(&_imp->lock);
+        // Take the smallest team which is large enough, so that the larger ones are kept for the effects which need them
+        std::list<MultiThreadTeamPtr>::iterator found = _imp->idleTeams.end();
+        for (std::list<MultiThreadTeamPtr>::iterator it = _imp->idleTeams.begin(); it != _imp->idleTeams.end(); ++it) {
+            if ( ( (*it)->getNThreads() >= nThreads ) &&
+                 ( ( found == _imp->idleTeams.end() ) || ( (*it)->getNThreads() < (*found)->getNThreads() ) ) ) {
+                found = it;
+            }
+        }
+        if ( found != _imp->idleTeams.end() ) {
+            MultiThreadTeamPtr ret = *found;
+            _imp->idleTeams.erase(found);
+
+            return ret;
+        }
+
+        // The idle teams are all too small: stop them, the largest first, if the new team does not fit in the bound
+        int neededThreads = (int)std::max(1u, nThreads) - 1;
+        while ( (_imp->nThreads + neededThreads > _imp->maxThreads) && !_imp->idleTeams.empty() ) {
+            std::list<MultiThreadTeamPtr>::iterator largest = _imp->idleTeams.begin();
+            for (std::list<MultiThreadTeamPtr>::iterator it = _imp->idleTeams.begin(); it != _imp->idleTeams.end(); ++it) {
+                if ( (*it)->getNThreads() > (*largest)->getNThreads() ) {
+                    largest = it;
+                }
+            }
+            _imp->evictTeam(largest, &evicted);
+        }
+        teamThreads = std::min( neededThreads, std::max(0, _imp->maxThreads - _imp->nThreads) );
+        _imp->nThreads += teamThreads;
+    }
+
+    // A team of a single thread starts no thread: its jobs run in the calling thread
+    return MultiThreadTeamPtr( new MultiThreadTeam(teamThreads + 1) );
+}
+
+void
+MultiThreadTeamPool::releaseTeam(const MultiThreadTeamPtr& team)
+{
+    assert(team);
+    // The threads of the evicted team are stopped outside of the lock
+    std::list<MultiThreadTeamPtr> evicted;
+    {
+        QMutexLocker k(&_imp->lock);
+        _imp->idleTeams.push_back(team);
+        if ( (int)_imp->idleTeams.size() > NATRON_MULTI_THREAD_TEAM_MAX_IDLE_TEAMS ) {
+            std::list<MultiThreadTeamPtr>::iterator smallest = _imp->idleTeams.begin();
+            for (std::list<MultiThreadTeamPtr>::iterator it = _imp->idleTeams.begin(); it != _imp->idleTeams.end(); ++it) {
+                if ( (*it)->getNThreads() < (*smallest)->getNThreads() ) {
+                    smallest = it;
+                }
+            }
+            _imp->evictTeam(smallest, &evicted);
+        }
+    }
+}
+
+int
+MultiThreadTeamPool::getNThreads() const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return _imp->nThreads;
+}
+
+void
+MultiThreadTeamPool::clear()
+{
+    std::list<MultiThreadTeamPtr> evicted;
+    {
+        QMutexLocker k(&_imp->lock);
+        while ( !_imp->idleTeams.empty() ) {
+            _imp->evictTeam(_imp->idleTeams.begin(), &evicted);
+        }
+    }
+}
+
+NATRON_NAMESPACE_EXIT;
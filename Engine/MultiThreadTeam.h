@@ -0,0 +1,173 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_MULTITHREADTEAM_H
+#define NATRON_ENGINE_MULTITHREADTEAM_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#endif
+
+#include "Engine/EngineFwd.h"
+
+// Time in microseconds during which a thread of a team checks for a new job, or the caller for the end of the job,
+// before going to sleep. It only covers back to back jobs: longer spins would steal the CPU from the other renders.
+#define NATRON_MULTI_THREAD_TEAM_SPIN_US 5
+
+// Number of teams kept alive by a MultiThreadTeamPool while no one uses them
+#define NATRON_MULTI_THREAD_TEAM_MAX_IDLE_TEAMS 4
+
+// Default bound on the number of threads started by all the teams of a MultiThreadTeamPool, per CPU
+#define NATRON_MULTI_THREAD_TEAM_MAX_THREADS_PER_CPU 2
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief The work given to a MultiThreadTeam: nTasks tasks, each of them run exactly once by one of the threads of the team.
+ **/
+class MultiThreadTeamJob
+{
+public:
+
+    MultiThreadTeamJob() {}
+
+    virtual ~MultiThreadTeamJob() {}
+
+    /**
+     * @brief Called by the thread calling MultiThreadTeam::run() for each thread of the team taking part in the job,
+     * before the job is given to it, e.g. to copy the thread local storage of the caller to that thread.
+     **/
+    virtual void prepareThread(QThread* /*thread*/) {}
+
+    /**
+     * @brief Runs the task of the given index. This is called concurrently from several threads and must not throw.
+     **/
+    virtual void runTask(unsigned int taskIndex, unsigned int nTasks) = 0;
+
+    /**
+     * @brief Called by each thread of the team taking part in the job once it ran its last task, but not by the
+     * thread calling MultiThreadTeam::run().
+     **/
+    virtual void finishThread() {}
+};
+
+/**
+ * @brief A team of persistent threads running fork-join jobs, for the callers which split the same work over
+ * a few threads many times in a row, such as the multi-thread suite of OpenFX.
+ * Unlike a thread pool, the threads are not shared between jobs: each thread keeps the same index in the team,
+ * and a job only wakes up the threads it needs. After a job, the threads spin for a few microseconds
+ * (NATRON_MULTI_THREAD_TEAM_SPIN_US) waiting for the next one before going to sleep, and the caller, which
+ * runs tasks itself, spins the same way before waiting for the other threads to finish.
+ *
+ * A team runs a single job at a time: use a MultiThreadTeamPool to share teams between threads.
+ * A job which calls run() again on the same team from one of its threads has its tasks run in that thread.
+ **/
+struct MultiThreadTeamPrivate;
+class MultiThreadTeam
+{
+public:
+
+    /**
+     * @brief Creates a team which can run a job on nThreads threads: nThreads - 1 threads are started,
+     * the calling thread being the last one.
+     **/
+    explicit MultiThreadTeam(unsigned int nThreads);
+
+    ~MultiThreadTeam();
+
+    unsigned int getNThreads() const;
+
+    /**
+     * @brief Runs the nTasks tasks of the job on at most nThreads threads of the team, including the calling thread,
+     * and returns when they are all done.
+     **/
+    void run(MultiThreadTeamJob* job, unsigned int nTasks, unsigned int nThreads);
+
+    /**
+     * @brief Returns true if the calling thread is one of the threads started by a team
+     **/
+    static bool isTeamThread();
+
+private:
+
+    boost::scoped_ptr<MultiThreadTeamPrivate> _imp;
+};
+
+typedef boost::shared_ptr<MultiThreadTeam> MultiThreadTeamPtr;
+
+/**
+ * @brief Hands out the teams to the threads which need one, so that concurrent renders each get their own team,
+ * and keeps a few of them alive between the jobs.
+ * The threads of the teams are not part of the global thread pool: the number of threads started by all the teams
+ * of the pool, used or idle, is bounded. When the bound is reached the idle teams are stopped to make room,
+ * and then the teams handed out are smaller than requested.
+ * This class is MT-safe.
+ **/
+struct MultiThreadTeamPoolPrivate;
+class MultiThreadTeamPool
+{
+public:
+
+    /**
+     * @brief maxThreads is the bound on the number of threads started by the teams, 0 meaning
+     * NATRON_MULTI_THREAD_TEAM_MAX_THREADS_PER_CPU threads per CPU.
+     **/
+    explicit MultiThreadTeamPool(int maxThreads = 0);
+
+    ~MultiThreadTeamPool();
+
+    /**
+     * @brief Returns a team of nThreads threads, or less if the bound on the number of threads is reached,
+     * which no other thread uses until it is given back with releaseTeam().
+     * Idle teams of more than nThreads threads may be returned.
+     **/
+    MultiThreadTeamPtr acquireTeam(unsigned int nThreads);
+
+    /**
+     * @brief Gives back a team returned by acquireTeam(). Every team must be given back: its threads are accounted
+     * in the bound until then.
+     **/
+    void releaseTeam(const MultiThreadTeamPtr& team);
+
+    /**
+     * @brief Returns the number of threads started by the teams of the pool, used or idle
+     **/
+    int getNThreads() const;
+
+    /**
+     * @brief Stops the threads of the teams which are not used
+     **/
+    void clear();
+
+private:
+
+    boost::scoped_ptr<MultiThreadTeamPoolPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_MULTITHREADTEAM_H
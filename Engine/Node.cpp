@@ -30,6 +30,7 @@
 #include <bitset>
 #include <cassert>
 #include <stdexcept>
+#include <vector>
 
 #include "Global/Macros.h"
 
@@ -74,6 +75,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/GenericSchedulerThreadWatcher.h"
 #include "Engine/Hash64.h"
 #include "Engine/Image.h"
+#include "Engine/ImageKey.h"
 #include "Engine/ImageParams.h"
 #include "Engine/Knob.h"
 #include "Engine/KnobTypes.h"
@@ -1755,15 +1757,21 @@ Node::loadKnobsFromSerialization(const SERIALIZATION_NAMESPACE::NodeSerializatio
     }
 
     // now restore the roto context if the node has a roto context
-    if (serialization._rotoContext && _imp->rotoContext) {
-        _imp->rotoContext->resetToDefault();
-        _imp->rotoContext->fromSerialization(*serialization._rotoContext);
+    if (_imp->rotoContext) {
+        boost::shared_ptr<SERIALIZATION_NAMESPACE::RotoContextSerialization> rotoSerialization = serialization.getRotoContext();
+        if (rotoSerialization) {
+            _imp->rotoContext->resetToDefault();
+            _imp->rotoContext->fromSerialization(*rotoSerialization);
+        }
     }
 
     // same for tracker context
-    if (serialization._trackerContext && _imp->trackContext) {
-        _imp->trackContext->clearMarkers();
-        _imp->trackContext->fromSerialization(*serialization._trackerContext);
+    if (_imp->trackContext) {
+        boost::shared_ptr<SERIALIZATION_NAMESPACE::TrackerContextSerialization> trackerSerialization = serialization.getTrackerContext();
+        if (trackerSerialization) {
+            _imp->trackContext->clearMarkers();
+            _imp->trackContext->fromSerialization(*trackerSerialization);
+        }
     }
 
     {
@@ -6392,6 +6400,16 @@ renderPreview(const Image & srcImg,
 
     Image::ReadAccess acc = srcImg.getReadRights();
 
+    // The horizontal source index only depends on the destination column: compute it once
+    // for the whole preview instead of once per pixel. A negative index means out of bounds.
+    std::vector<int> srcColumns(*dstWidth);
+    for (int j = 0; j < *dstWidth; ++j) {
+        // bilinear interpolation is pointless when downscaling a lot, and this is a preview anyway.
+        // just use nearest neighbor
+        double x = (j - *dstWidth / 2.) / zoomFactor + (srcBounds.x1 + srcBounds.x2) / 2.;
+        int xi = std::floor(x + 0.5) - srcBounds.x1;     // round to nearest
+        srcColumns[j] = ( (xi < 0) || ( xi >= (srcBounds.x2 - srcBounds.x1) ) ) ? -1 : xi * srcNComps;
+    }
 
     for (int i = 0; i < *dstHeight; ++i) {
         double y = (i - *dstHeight / 2.) / zoomFactor + (srcBounds.y1 + srcBounds.y2) / 2.;
@@ -6409,20 +6427,17 @@ renderPreview(const Image & srcImg,
             }
         } else {
             for (int j = 0; j < *dstWidth; ++j) {
-                // bilinear interpolation is pointless when downscaling a lot, and this is a preview anyway.
-                // just use nearest neighbor
-                double x = (j - *dstWidth / 2.) / zoomFactor + (srcBounds.x1 + srcBounds.x2) / 2.;
-                int xi = std::floor(x + 0.5) - srcBounds.x1;     // round to nearest
-                if ( (xi < 0) || ( xi >= (srcBounds.x2 - srcBounds.x1) ) ) {
+                const int srcIndex = srcColumns[j];
+                if (srcIndex < 0) {
 #ifndef __NATRON_WIN32__
                     dst_pixels[j] = toBGRA(0, 0, 0, 0);
 #else
                     dst_pixels[j] = toBGRA(0, 0, 0, 255);
 #endif
                 } else {
-                    float rFilt = src_pixels[xi * srcNComps] / (float)maxValue;
-                    float gFilt = srcNComps < 2 ? 0 : src_pixels[xi * srcNComps + 1] / (float)maxValue;
-                    float bFilt = srcNComps < 3 ? 0 : src_pixels[xi * srcNComps + 2] / (float)maxValue;
+                    float rFilt = src_pixels[srcIndex] / (float)maxValue;
+                    float gFilt = srcNComps < 2 ? 0 : src_pixels[srcIndex + 1] / (float)maxValue;
+                    float bFilt = srcNComps < 3 ? 0 : src_pixels[srcIndex + 2] / (float)maxValue;
                     if (srcNComps == 1) {
                         gFilt = bFilt = rFilt;
                     }
@@ -6467,6 +6482,97 @@ renderPreviewForDepth(const Image & srcImg,
     }
 }     // renderPreviewForDepth
 
+///output is always RGBA with alpha = 255
+void
+renderPreviewForImage(const Image & srcImg,
+                      bool convertToSrgb,
+                      int *dstWidth,
+                      int *dstHeight,
+                      unsigned int* dstPixels)
+{
+    int elemCount = srcImg.getComponents().getNumComponents();
+
+    switch ( srcImg.getBitDepth() ) {
+    case eImageBitDepthByte: {
+        renderPreviewForDepth<unsigned char, 255>(srcImg, elemCount, dstWidth, dstHeight, convertToSrgb, dstPixels);
+        break;
+    }
+    case eImageBitDepthShort: {
+        renderPreviewForDepth<unsigned short, 65535>(srcImg, elemCount, dstWidth, dstHeight, convertToSrgb, dstPixels);
+        break;
+    }
+    case eImageBitDepthHalf:
+        break;
+    case eImageBitDepthFloat: {
+        renderPreviewForDepth<float, 1>(srcImg, elemCount, dstWidth, dstHeight, convertToSrgb, dstPixels);
+        break;
+    }
+    case eImageBitDepthNone:
+        break;
+    }
+}
+
+/**
+ * @brief Look in the cache for an image of the node at the given frame that was already rendered,
+ * e.g by the Viewer or by a previous preview. Any mipmap level is accepted: we prefer the lowest
+ * resolution that is still at least as large as what the preview needs, otherwise the closest
+ * coarser level. Only images that are fully rendered are considered.
+ * The image key does not encode the layer nor the bit depth: images of other planes (e.g the alpha
+ * or a motion vectors layer) are rejected by comparing with the output components and bit depth of the effect.
+ * Images that were rendered for a smaller window than the region of definition (e.g a zoomed-in Viewer)
+ * are rejected as well, otherwise part of the preview would be black.
+ **/
+ImagePtr
+findCachedPreviewSource(const std::string& pluginID,
+                        U64 nodeHash,
+                        double time,
+                        unsigned int previewMipMapLevel,
+                        const RectD& rod,
+                        double par,
+                        const ImageComponents& outputComponents,
+                        ImageBitDepthEnum outputDepth)
+{
+    std::list<ImagePtr> cachedImages;
+    for (int draft = 0; draft < 2; ++draft) {
+        ImageKey key(pluginID, nodeHash, time, ViewIdx(0), draft == 1);
+        appPTR->getImage(key, &cachedImages);
+    }
+
+    ImagePtr finer, coarser;
+    for (std::list<ImagePtr>::const_iterator it = cachedImages.begin(); it != cachedImages.end(); ++it) {
+        const ImagePtr& img = *it;
+        if ( (img->getStorageMode() != eStorageModeRAM) || (img->getBitDepth() != outputDepth) ) {
+            continue;
+        }
+        if ( img->getComponents() != outputComponents ) {
+            continue;
+        }
+        const RectI bounds = img->getBounds();
+        if ( bounds.isNull() || !img->getMinimalRect(bounds).isNull() ) {
+            // Partially rendered
+            continue;
+        }
+        unsigned int level = img->getMipMapLevel();
+        RectI rodPixel;
+        rod.toPixelEnclosing(level, par, &rodPixel);
+        if ( !bounds.contains(rodPixel) ) {
+            // Rendered for a window smaller than the region of definition
+            continue;
+        }
+        if (level <= previewMipMapLevel) {
+            if ( !finer || (level > finer->getMipMapLevel()) ) {
+                finer = img;
+            }
+        } else {
+            if ( !coarser || (level < coarser->getMipMapLevel()) ) {
+                coarser = img;
+            }
+        }
+    }
+
+    return finer ? finer : coarser;
+} // findCachedPreviewSource
+
 NATRON_NAMESPACE_ANONYMOUS_EXIT
 
 
@@ -6474,8 +6580,12 @@ bool
 Node::makePreviewImage(SequenceTime time,
                        int *width,
                        int *height,
-                       unsigned int* buf)
+                       unsigned int* buf,
+                       bool* renderedFromCache)
 {
+    if (renderedFromCache) {
+        *renderedFromCache = false;
+    }
     if (!isNodeCreated()) {
         return false;
     }
@@ -6501,7 +6611,7 @@ Node::makePreviewImage(SequenceTime time,
     if (isGroup) {
         NodePtr outputNode = isGroup->getOutputNodeInput(false);
         if (outputNode) {
-            return outputNode->makePreviewImage(time, width, height, buf);
+            return outputNode->makePreviewImage(time, width, height, buf, renderedFromCache);
         }
         return false;
     } else {
@@ -6524,6 +6634,7 @@ Node::makePreviewImage(SequenceTime time,
 
     {
         AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
+        abortInfo->setPriority(eRenderPriorityPreview);
         const bool isRenderUserInteraction = true;
         const bool isSequentialRender = false;
         AbortableThread* isAbortable = dynamic_cast<AbortableThread*>( QThread::currentThread() );
@@ -6546,6 +6657,7 @@ Node::makePreviewImage(SequenceTime time,
         tlsArgs->isDoingRotoNeatRender = false;
         tlsArgs->isAnalysis = false;
         tlsArgs->draftMode = true;
+        tlsArgs->viewsRenderedConcurrently = false;
         tlsArgs->stats = RenderStatsPtr();
 
         boost::shared_ptr<ParallelRenderArgsSetter> frameRenderArgs;
@@ -6578,6 +6690,33 @@ Node::makePreviewImage(SequenceTime time,
         scale.y = scale.x;
 
 
+        std::list<ImageComponents> requestedComps;
+        ImageBitDepthEnum depth = effect->getBitDepth(-1);
+        requestedComps.push_back( effect->getComponents(-1) );
+
+        ImagePtr cachedImage;
+        if ( (depth != eImageBitDepthHalf) && (depth != eImageBitDepthNone) ) {
+            const int nComps = requestedComps.front().getNumComponents();
+            if ( (nComps >= 1) && (nComps <= 4) ) {
+                cachedImage = findCachedPreviewSource(getPluginID(), nodeHash, time, mipMapLevel, rod, par, requestedComps.front(), depth);
+            }
+        }
+        if (cachedImage) {
+            // The node was already rendered at this frame (by the Viewer or by a previous preview):
+            // downscale what's in the cache rather than launching a new render of the tree.
+            ///we convert only when input is Linear.
+            //Rec709 and srGB is acceptable for preview
+            bool convertToSrgb = getApp()->getDefaultColorSpaceForBitDepth( cachedImage->getBitDepth() ) == eViewerColorSpaceLinear;
+            renderPreviewForImage(*cachedImage, convertToSrgb, width, height, buf);
+            if (renderedFromCache) {
+                *renderedFromCache = true;
+            }
+            frameRenderArgs.reset();
+            appPTR->getAppTLS()->cleanupTLSForThread();
+
+            return true;
+        }
+
         RectI renderWindow;
         rod.toPixelEnclosing(mipMapLevel, par, &renderWindow);
 
@@ -6586,10 +6725,6 @@ Node::makePreviewImage(SequenceTime time,
             return false;
         }
 
-        std::list<ImageComponents> requestedComps;
-        ImageBitDepthEnum depth = effect->getBitDepth(-1);
-        requestedComps.push_back( effect->getComponents(-1) );
-
 
         // Exceptions are caught because the program can run without a preview,
         // but any exception in renderROI is probably fatal.
@@ -6622,31 +6757,11 @@ Node::makePreviewImage(SequenceTime time,
         }
 
         const ImagePtr& img = planes.begin()->second;
-        const ImageComponents& components = img->getComponents();
-        int elemCount = components.getNumComponents();
 
         ///we convert only when input is Linear.
         //Rec709 and srGB is acceptable for preview
         bool convertToSrgb = getApp()->getDefaultColorSpaceForBitDepth( img->getBitDepth() ) == eViewerColorSpaceLinear;
-
-        switch ( img->getBitDepth() ) {
-        case eImageBitDepthByte: {
-            renderPreviewForDepth<unsigned char, 255>(*img, elemCount, width, height, convertToSrgb, buf);
-            break;
-        }
-        case eImageBitDepthShort: {
-            renderPreviewForDepth<unsigned short, 65535>(*img, elemCount, width, height, convertToSrgb, buf);
-            break;
-        }
-        case eImageBitDepthHalf:
-            break;
-        case eImageBitDepthFloat: {
-            renderPreviewForDepth<float, 1>(*img, elemCount, width, height, convertToSrgb, buf);
-            break;
-        }
-        case eImageBitDepthNone:
-            break;
-        }
+        renderPreviewForImage(*img, convertToSrgb, width, height, buf);
     } // ParallelRenderArgsSetter
 
     ///Exit of the thread
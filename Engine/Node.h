@@ -921,8 +921,12 @@ public:
      *
      * The width and height might be modified by the function, so their value can
      * be queried at the end of the function
+     *
+     * If an image of the node at the given time is already in the cache (at any mipmap level)
+     * it is downscaled instead of rendering the tree. If renderedFromCache is non null it is set
+     * to true in that case.
      **/
-    bool makePreviewImage(SequenceTime time, int *width, int *height, unsigned int* buf);
+    bool makePreviewImage(SequenceTime time, int *width, int *height, unsigned int* buf, bool* renderedFromCache = 0);
 
     /**
      * @brief Returns true if the node is currently rendering a preview image.
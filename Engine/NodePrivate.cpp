@@ -28,6 +28,7 @@
 #include "Engine/KnobTypes.h"
 #include "Engine/ImageComponents.h"
 #include "Engine/Project.h"
+#include "Engine/PythonCallback.h"
 #include "Engine/Timer.h"
 
 NATRON_NAMESPACE_ENTER
@@ -148,6 +149,10 @@ NodePrivate::NodePrivate(Node* publicInterface,
 , isLoadingPreset(false)
 , presetKnobs()
 , hostChannelSelectorEnabled(false)
+, paramChangedPythonCallback("param changed", "thisParam, thisNode, thisGroup, app, userEdited")
+, paramChangedPythonCallbackKnobValue()
+, inputChangedPythonCallback("input changed", "inputIndex, thisNode, thisGroup, app")
+, inputChangedPythonCallbackKnobValue()
 {
     nodePositionCoords[0] = nodePositionCoords[1] = INT_MIN;
     nodeSize[0] = nodeSize[1] = -1;
@@ -694,71 +699,84 @@ NodePrivate::runOnNodeCreatedCB(bool userEdited)
 }
 
 
-void
-NodePrivate::runInputChangedCallback(int index,
-                                              const std::string& cb)
+bool
+NodePrivate::setPythonCallback(PythonCallback& callback,
+                               std::string* callbackKnobValue,
+                               const std::string& cb,
+                               const std::string& callbackName)
 {
-    std::vector<std::string> args;
-    std::string error;
-
+    // Only look for the function in the PyPlug module again if the knob changed
     std::string callbackFunction;
-    if (!figureOutCallbackName(cb, &callbackFunction)) {
-        return;
+    if ( (cb == *callbackKnobValue) && !callback.getFunctionName().empty() ) {
+        callbackFunction = callback.getFunctionName();
+    } else if ( !figureOutCallbackName(cb, &callbackFunction) ) {
+        return false;
     }
 
-    try {
-        NATRON_PYTHON_NAMESPACE::getFunctionArguments(callbackFunction, &error, &args);
-    } catch (const std::exception& e) {
-        _publicInterface->getApp()->appendToScriptEditor( std::string("Failed to run onInputChanged callback: ")
-                                                         + e.what() );
+    std::string error;
+    if ( !callback.setFunction(callbackFunction, &error) ) {
+        callbackKnobValue->clear();
+        _publicInterface->getApp()->appendToScriptEditor( tr("Failed to run %1 callback: %2").arg( QString::fromUtf8( callbackName.c_str() ) ).arg( QString::fromUtf8( error.c_str() ) ).toStdString() );
 
-        return;
+        return false;
     }
+    *callbackKnobValue = cb;
 
-    if ( !error.empty() ) {
-        _publicInterface->getApp()->appendToScriptEditor("Failed to run onInputChanged callback: " + error);
+    return true;
+}
 
-        return;
-    }
+PyObject*
+NodePrivate::getThisGroupVariable(const std::string& appID)
+{
+    NodeCollectionPtr collection = _publicInterface->getGroup();
 
-    std::string signatureError;
-    signatureError.append("The on input changed callback supports the following signature(s):\n");
-    signatureError.append("- callback(inputIndex,thisNode,thisGroup,app)");
-    if (args.size() != 4) {
-        _publicInterface->getApp()->appendToScriptEditor("Failed to run onInputChanged callback: " + signatureError);
+    assert(collection);
+    if (!collection) {
+        return 0;
+    }
 
-        return;
+    NodeGroupPtr isParentGrp = toNodeGroup(collection);
+    if (isParentGrp) {
+        return PythonCallback::getVariable( appID + "." + isParentGrp->getNode()->getFullyQualifiedName() );
+    } else {
+        return PythonCallback::getVariable(appID);
     }
+}
 
-    if ( (args[0] != "inputIndex") || (args[1] != "thisNode") || (args[2] != "thisGroup") || (args[3] != "app") ) {
-        _publicInterface->getApp()->appendToScriptEditor("Failed to run onInputChanged callback: " + signatureError);
+void
+NodePrivate::runInputChangedCallback(int index,
+                                     const std::string& cb)
+{
+    PythonGILLocker pgl;
 
+    if ( !setPythonCallback(inputChangedPythonCallback, &inputChangedPythonCallbackKnobValue, cb, "onInputChanged") ) {
         return;
     }
 
     std::string appID = _publicInterface->getApp()->getAppIDString();
-    NodeCollectionPtr collection = _publicInterface->getGroup();
-    assert(collection);
-    if (!collection) {
-        return;
-    }
+    PyObject* thisNode = PythonCallback::getVariable( appID + "." + _publicInterface->getFullyQualifiedName() );
+    PyObject* thisGroup = getThisGroupVariable(appID);
+    PyObject* app = PythonCallback::getVariable(appID);
+    if (!thisNode || !thisGroup || !app) {
+        Py_XDECREF(thisNode);
+        Py_XDECREF(thisGroup);
+        Py_XDECREF(app);
 
-    std::string thisGroupVar;
-    NodeGroupPtr isParentGrp = toNodeGroup(collection);
-    if (isParentGrp) {
-        std::string nodeName = isParentGrp->getNode()->getFullyQualifiedName();
-        std::string nodeFullName = appID + "." + nodeName;
-        thisGroupVar = nodeFullName;
-    } else {
-        thisGroupVar = appID;
+        return;
     }
 
-    std::stringstream ss;
-    ss << callbackFunction << "(" << index << "," << appID << "." << _publicInterface->getFullyQualifiedName() << "," << thisGroupVar << "," << appID << ")\n";
+    // The tuple steals the references
+    PyObject* args = PyTuple_New(4);
+    PyTuple_SET_ITEM( args, 0, PythonCallback::makeIntArgument(index) );
+    PyTuple_SET_ITEM(args, 1, thisNode);
+    PyTuple_SET_ITEM(args, 2, thisGroup);
+    PyTuple_SET_ITEM(args, 3, app);
 
-    std::string script = ss.str();
+    std::string error;
     std::string output;
-    if ( !NATRON_PYTHON_NAMESPACE::interpretPythonScript(script, &error, &output) ) {
+    bool ok = inputChangedPythonCallback.call(args, &error, &output);
+    Py_DECREF(args);
+    if (!ok) {
         _publicInterface->getApp()->appendToScriptEditor( tr("Failed to execute callback: %1").arg( QString::fromUtf8( error.c_str() ) ).toStdString() );
     } else {
         if ( !output.empty() ) {
@@ -770,93 +788,47 @@ NodePrivate::runInputChangedCallback(int index,
 void
 NodePrivate::runChangedParamCallback(const std::string& cb, const KnobIPtr& k, bool userEdited)
 {
-    std::vector<std::string> args;
-    std::string error;
-
     if ( !k || (k->getName() == "onParamChanged") ) {
         return;
     }
 
-    std::string callbackFunction;
-    if (!figureOutCallbackName(cb, &callbackFunction)) {
-        return;
-    }
-
-    try {
-        NATRON_PYTHON_NAMESPACE::getFunctionArguments(callbackFunction, &error, &args);
-    } catch (const std::exception& e) {
-        _publicInterface->getApp()->appendToScriptEditor( tr("Failed to run onParamChanged callback: %1").arg( QString::fromUtf8( e.what() ) ).toStdString() );
-
-        return;
-    }
-
-    if ( !error.empty() ) {
-        _publicInterface->getApp()->appendToScriptEditor( tr("Failed to run onParamChanged callback: %1").arg( QString::fromUtf8( error.c_str() ) ).toStdString() );
-
-        return;
-    }
-
-    std::string signatureError;
-    signatureError.append( tr("The param changed callback supports the following signature(s):").toStdString() );
-    signatureError.append("\n- callback(thisParam,thisNode,thisGroup,app,userEdited)");
-    if (args.size() != 5) {
-        _publicInterface->getApp()->appendToScriptEditor( tr("Failed to run onParamChanged callback: %1").arg( QString::fromUtf8( signatureError.c_str() ) ).toStdString() );
-
-        return;
-    }
-
-    if ( ( (args[0] != "thisParam") || (args[1] != "thisNode") || (args[2] != "thisGroup") || (args[3] != "app") || (args[4] != "userEdited") ) ) {
-        _publicInterface->getApp()->appendToScriptEditor( tr("Failed to run onParamChanged callback: %1").arg( QString::fromUtf8( signatureError.c_str() ) ).toStdString() );
+    PythonGILLocker pgl;
 
+    if ( !setPythonCallback(paramChangedPythonCallback, &paramChangedPythonCallbackKnobValue, cb, "onParamChanged") ) {
         return;
     }
 
     std::string appID = _publicInterface->getApp()->getAppIDString();
-
-    assert(k);
     std::string thisNodeVar = appID + ".";
     thisNodeVar.append( _publicInterface->getFullyQualifiedName() );
 
-    NodeCollectionPtr collection = _publicInterface->getGroup();
-    assert(collection);
-    if (!collection) {
-        return;
-    }
-
-    std::string thisGroupVar;
-    NodeGroupPtr isParentGrp = toNodeGroup(collection);
-    if (isParentGrp) {
-        std::string nodeName = isParentGrp->getNode()->getFullyQualifiedName();
-        std::string nodeFullName = appID + "." + nodeName;
-        thisGroupVar = nodeFullName;
-    } else {
-        thisGroupVar = appID;
-    }
+    // The param may not be exposed to Python
+    PyObject* thisParam = PythonCallback::getVariable( thisNodeVar + "." + k->getName() );
+    PyObject* thisNode = PythonCallback::getVariable(thisNodeVar);
+    PyObject* thisGroup = getThisGroupVariable(appID);
+    PyObject* app = PythonCallback::getVariable(appID);
+    if (!thisParam || !thisNode || !thisGroup || !app) {
+        Py_XDECREF(thisParam);
+        Py_XDECREF(thisNode);
+        Py_XDECREF(thisGroup);
+        Py_XDECREF(app);
 
-    bool alreadyDefined = false;
-    PyObject* nodeObj = NATRON_PYTHON_NAMESPACE::getAttrRecursive(thisNodeVar, NATRON_PYTHON_NAMESPACE::getMainModule(), &alreadyDefined);
-    if (!nodeObj || !alreadyDefined) {
         return;
     }
 
-    if (!PyObject_HasAttrString( nodeObj, k->getName().c_str() ) ) {
-        return;
-    }
+    // The tuple steals the references
+    PyObject* args = PyTuple_New(5);
+    PyTuple_SET_ITEM(args, 0, thisParam);
+    PyTuple_SET_ITEM(args, 1, thisNode);
+    PyTuple_SET_ITEM(args, 2, thisGroup);
+    PyTuple_SET_ITEM(args, 3, app);
+    PyTuple_SET_ITEM( args, 4, PyBool_FromLong(userEdited) );
 
-    std::stringstream ss;
-    ss << callbackFunction << "(" << thisNodeVar << "." << k->getName() << "," << thisNodeVar << "," << thisGroupVar << "," << appID
-    << ",";
-    if (userEdited) {
-        ss << "True";
-    } else {
-        ss << "False";
-    }
-    ss << ")\n";
-
-    std::string script = ss.str();
     std::string err;
     std::string output;
-    if ( !NATRON_PYTHON_NAMESPACE::interpretPythonScript(script, &err, &output) ) {
+    bool ok = paramChangedPythonCallback.call(args, &err, &output);
+    Py_DECREF(args);
+    if (!ok) {
         _publicInterface->getApp()->appendToScriptEditor( tr("Failed to execute onParamChanged callback: %1").arg( QString::fromUtf8( err.c_str() ) ).toStdString() );
     } else {
         if ( !output.empty() ) {
@@ -32,6 +32,7 @@
 #include "Engine/EffectInstance.h"
 #include "Engine/Node.h"
 #include "Engine/GenericSchedulerThreadWatcher.h"
+#include "Engine/PythonCallback.h"
 
 
 #include <QtCore/QCoreApplication>
@@ -162,6 +163,17 @@ public:
 
     void runInputChangedCallback(int index, const std::string& script);
 
+    /**
+     * @brief Sets the function of the callback from the value of its knob, cb. Returns false if it could not be set: the error
+     * is reported with callbackName. callbackKnobValue is the knob value the function was last set from.
+     **/
+    bool setPythonCallback(PythonCallback& callback, std::string* callbackKnobValue, const std::string& cb, const std::string& callbackName);
+
+    /**
+     * @brief Returns a new reference on the thisGroup argument of the callbacks
+     **/
+    PyObject* getThisGroupVariable(const std::string& appID);
+
     void createChannelSelector(int inputNb, const std::string & inputName, bool isOutput, const KnobPagePtr& page, KnobIPtr* lastKnobBeforeAdvancedOption);
 
     void onLayerChanged(bool isOutput);
@@ -384,6 +396,13 @@ public:
     std::list<KnobIWPtr> presetKnobs;
 
     bool hostChannelSelectorEnabled;
+
+    // The Python callbacks run for each param and input change: looked up once, then called directly.
+    // Protected by the Python GIL
+    PythonCallback paramChangedPythonCallback;
+    std::string paramChangedPythonCallbackKnobValue;
+    PythonCallback inputChangedPythonCallback;
+    std::string inputChangedPythonCallbackKnobValue;
 };
 
 class RefreshingInputData_RAII
@@ -34,6 +34,7 @@
 #include <algorithm> // transform, min, max
 #include <string>
 #include <cstring> // for std::memcpy, std::memset, std::strcmp
+#include <vector>
 
 CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
@@ -52,12 +53,6 @@ CLANG_DIAG_ON(uninitialized)
 #ifdef OFX_SUPPORTS_MULTITHREAD
 #include <QtCore/QThread>
 #include <QtCore/QThreadStorage>
-#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
-
-GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
-// /usr/local/include/boost/bind/arg.hpp:37:9: warning: unused typedef 'boost_static_assert_typedef_37' [-Wunused-local-typedef]
-#include <boost/bind.hpp>
-GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #endif // OFX_SUPPORTS_MULTITHREAD
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
@@ -97,6 +92,7 @@ CLANG_DIAG_ON(unknown-pragmas)
 #include "Engine/CreateNodeArgs.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/LibraryBinary.h"
+#include "Engine/MultiThreadTeam.h"
 #include "Engine/Node.h"
 #include "Engine/FStreamsSupport.h"
 #include "Engine/OfxEffectInstance.h"
@@ -162,6 +158,9 @@ struct OfxHostPrivate
     int loadingPluginVersionMajor;
     int loadingPluginVersionMinor;
 
+    // The teams of threads running the functions given to the multi-thread suite
+    MultiThreadTeamPool multiThreadTeams;
+
     OfxHostPrivate()
         : imageEffectPluginCache()
         , tlsData( new TLSHolder<OfxHost::OfxHostTLSData>() )
@@ -172,6 +171,7 @@ struct OfxHostPrivate
         , loadingPluginID()
         , loadingPluginVersionMajor(0)
         , loadingPluginVersionMinor(0)
+        , multiThreadTeams()
     {
     }
 };
@@ -1152,45 +1152,78 @@ OfxHost::setThreadAsActionCaller(OfxImageEffectInstance* instance,
 
 NATRON_NAMESPACE_ANONYMOUS_ENTER
 
-///Using QtConcurrent doesn't work with The Foundry Furnace plug-ins because they expect fresh threads
-///to be created. As QtConcurrent's thread-pool recycles thread, it seems to make Furnace crash.
+///Using the thread pool doesn't work with The Foundry Furnace plug-ins because they expect fresh threads
+///to be created. As the teams of threads recycle threads, it seems to make Furnace crash.
 ///We think this is because Furnace must keep an internal thread-local state that becomes then dirty
 ///if we re-use the same thread.
 
-static OfxStatus
-threadFunctionWrapper(OfxThreadFunctionV1 func,
-                      unsigned int threadIndex,
-                      unsigned int threadMax,
-                      QThread* spawnerThread,
-                      void *customArg)
+// Runs the function given to multiThread on a MultiThreadTeam. Unlike QtConcurrent, which ran each call of the
+// function as a separate task, the thread local storage of the spawner thread is given to the threads of the team
+// once per multiThread call.
+class OfxMultiThreadJob
+    : public MultiThreadTeamJob
 {
-    assert(threadIndex < threadMax);
-    OfxHost::OfxHostDataTLSPtr tls = appPTR->getOFXHost()->getTLSData();
-    tls->threadIndexes.push_back( (int)threadIndex );
+public:
 
-    QThread* spawnedThread = QThread::currentThread();
-    if (spawnedThread != spawnerThread) {
-        appPTR->getAppTLS()->softCopy(spawnerThread, spawnedThread);
+    OfxMultiThreadJob(OfxThreadFunctionV1 func,
+                      unsigned int nThreads,
+                      QThread* spawnerThread,
+                      void *customArg)
+        : MultiThreadTeamJob()
+        , _func(func)
+        , _spawnerThread(spawnerThread)
+        , _customArg(customArg)
+        , _status(nThreads, kOfxStatOK)
+    {
     }
 
-    OfxStatus ret = kOfxStatOK;
-    try {
-        func(threadIndex, threadMax, customArg);
-    } catch (const std::bad_alloc & ba) {
-        ret =  kOfxStatErrMemory;
-    } catch (...) {
-        ret =  kOfxStatFailed;
+    virtual void prepareThread(QThread* thread) OVERRIDE FINAL
+    {
+        appPTR->getAppTLS()->softCopy(_spawnerThread, thread);
     }
 
-    ///reset back the index otherwise it could mess up the indexes if the same thread is re-used
-    tls->threadIndexes.pop_back();
+    virtual void runTask(unsigned int threadIndex,
+                         unsigned int threadMax) OVERRIDE FINAL
+    {
+        assert( threadIndex < _status.size() );
+        OfxHost::OfxHostDataTLSPtr tls = appPTR->getOFXHost()->getTLSData();
+        tls->threadIndexes.push_back( (int)threadIndex );
+
+        try {
+            _func(threadIndex, threadMax, _customArg);
+        } catch (const std::bad_alloc & ba) {
+            _status[threadIndex] = kOfxStatErrMemory;
+        } catch (...) {
+            _status[threadIndex] = kOfxStatFailed;
+        }
 
-    if (spawnedThread != spawnerThread) {
+        ///reset back the index otherwise it could mess up the indexes if the same thread is re-used
+        tls->threadIndexes.pop_back();
+    }
+
+    virtual void finishThread() OVERRIDE FINAL
+    {
         appPTR->getAppTLS()->cleanupTLSForThread();
     }
 
-    return ret;
-}
+    // Returns the first error returned by a thread
+    OfxStatus getStatus() const
+    {
+        for (std::vector<OfxStatus>::const_iterator it = _status.begin(); it != _status.end(); ++it) {
+            if (*it != kOfxStatOK) {
+                return *it;
+            }
+        }
+
+        return kOfxStatOK;
+    }
+
+private:
+    OfxThreadFunctionV1 *_func;
+    QThread* _spawnerThread;
+    void *_customArg;
+    std::vector<OfxStatus> _status;
+};
 
 class OfxThread
     : public QThread
@@ -1277,7 +1310,13 @@ OfxHost::multiThread(OfxThreadFunctionV1 func,
     // "nThreads can be more than the value returned by multiThreadNumCPUs, however
     // the threads will be limitted to the number of CPUs returned by multiThreadNumCPUs."
 
-    if ( (nThreads == 1) || (maxConcurrentThread <= 1) || (appPTR->getCurrentSettings()->getNumberOfThreads() == -1) ) {
+    QThread* spawnerThread = QThread::currentThread();
+    bool useThreadPool = appPTR->getUseThreadPool();
+
+    // A spawned thread calling multiThread again runs the function itself: the other threads are already busy
+    // with the outer call, and waiting for them could deadlock
+    if ( (nThreads == 1) || (maxConcurrentThread <= 1) || (appPTR->getCurrentSettings()->getNumberOfThreads() == -1) ||
+         ( useThreadPool && multiThreadIsSpawnedThread() ) ) {
         try {
             for (unsigned int i = 0; i < nThreads; ++i) {
                 func(i, nThreads, customArg);
@@ -1289,27 +1328,23 @@ OfxHost::multiThread(OfxThreadFunctionV1 func,
         }
     }
 
-    QThread* spawnerThread = QThread::currentThread();
-    bool useThreadPool = appPTR->getUseThreadPool();
-
     if (useThreadPool) {
-        std::vector<unsigned int> threadIndexes(nThreads);
-        for (unsigned int i = 0; i < nThreads; ++i) {
-            threadIndexes[i] = i;
-        }
-
-        /// DON'T set the maximum thread count, this is a global application setting, and see the documentation excerpt above
-        //QThreadPool::globalInstance()->setMaxThreadCount(nThreads);
-        QFuture<OfxStatus> future = QtConcurrent::mapped( threadIndexes, boost::bind(threadFunctionWrapper, func, _1, nThreads, spawnerThread, customArg) );
-        future.waitForFinished();
-        ///DON'T reset back to the original value the maximum thread count
-        //QThreadPool::globalInstance()->setMaxThreadCount(QThread::idealThreadCount());
-
-        for (QFuture<OfxStatus>::const_iterator it = future.begin(); it != future.end(); ++it) {
-            OfxStatus stat = *it;
-            if (stat != kOfxStatOK) {
-                return stat;
-            }
+        // The threads are limited to the number of CPUs: the team runs the nThreads calls of the function on at most maxConcurrentThread threads
+        unsigned int nTeamThreads = std::min(nThreads, maxConcurrentThread);
+        MultiThreadTeamPtr team = _imp->multiThreadTeams.acquireTeam(nTeamThreads);
+        // The team may be smaller if the teams of the concurrent renders already started too many threads
+        nTeamThreads = std::min( nTeamThreads, team->getNThreads() );
+        OfxMultiThreadJob job(func, nThreads, spawnerThread, customArg);
+
+        ///We are going to use nTeamThreads - 1 threads besides this one
+        appPTR->fetchAndAddNRunningThreads(nTeamThreads - 1);
+        team->run(&job, nThreads, nTeamThreads);
+        appPTR->fetchAndAddNRunningThreads( -(int)(nTeamThreads - 1) );
+        _imp->multiThreadTeams.releaseTeam(team);
+
+        OfxStatus stat = job.getStatus();
+        if (stat != kOfxStatOK) {
+            return stat;
         }
     } else {
         QVector<OfxStatus> status(nThreads); // vector for the return status of each thread
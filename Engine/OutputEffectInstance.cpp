@@ -87,6 +87,7 @@ OutputEffectInstance::OutputEffectInstance(const NodePtr& node)
     , _outputEffectDataLock()
     , _renderSequenceRequests()
     , _engine()
+    , _sharedUpstreamImages()
 {
 }
 
@@ -95,6 +96,7 @@ OutputEffectInstance::OutputEffectInstance(const OutputEffectInstance& other)
 , _outputEffectDataLock()
 , _renderSequenceRequests()
 , _engine(other._engine)
+, _sharedUpstreamImages()
 {
 }
 
@@ -389,6 +391,22 @@ OutputEffectInstance::isDoingSequentialRender() const
     return _engine ? _engine->isDoingSequentialRender() : false;
 }
 
+void
+OutputEffectInstance::setSharedUpstreamImages(const SharedUpstreamImagesPtr& images)
+{
+    QMutexLocker k(&_outputEffectDataLock);
+
+    _sharedUpstreamImages = images;
+}
+
+SharedUpstreamImagesPtr
+OutputEffectInstance::getSharedUpstreamImages() const
+{
+    QMutexLocker k(&_outputEffectDataLock);
+
+    return _sharedUpstreamImages;
+}
+
 void
 OutputEffectInstance::initializeDataAfterCreate()
 {
@@ -444,6 +462,13 @@ OutputEffectInstance::reportStats(int time,
     }
 
     ofile << "Time spent to render frame (wall clock time): " << Timer::printAsTime(wallTime, false).toStdString() << std::endl;
+    U64 predictedImageMemory = 0, imageMemory = 0;
+    for (std::map<NodePtr, NodeRenderStats >::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+        predictedImageMemory += it->second.getPredictedImageMemory();
+        imageMemory += it->second.getImageMemory();
+    }
+    ofile << "Images memory predicted by the request pass: " << printAsRAM(predictedImageMemory).toStdString() << std::endl;
+    ofile << "Images memory used: " << printAsRAM(imageMemory).toStdString() << std::endl;
     for (std::map<NodePtr, NodeRenderStats >::const_iterator it = stats.begin(); it != stats.end(); ++it) {
         ofile << "------------------------------- " << it->first->getScriptName_mt_safe() << "------------------------------- " << std::endl;
         ofile << "Time spent rendering: " << Timer::printAsTime(it->second.getTotalTimeSpentRendering(), false).toStdString() << std::endl;
@@ -511,6 +536,20 @@ OutputEffectInstance::reportStats(int time,
         ofile << "Nb cache hit: " << nbCacheMiss << std::endl;
         ofile << "Nb cache miss: " << nbCacheMiss << std::endl;
         ofile << "Nb cache hit requiring mipmap downscaling: " << nbCacheHitButDownscaled << std::endl;
+        int nbCacheDecodes;
+        double cacheCompressionRatio, cacheDecodeTime;
+        it->second.getCacheDecodeInfos(&nbCacheDecodes, &cacheCompressionRatio, &cacheDecodeTime);
+        ofile << "Nb cache hit requiring decompression: " << nbCacheDecodes << std::endl;
+        if (nbCacheDecodes > 0) {
+            ofile << "Cache compression ratio: " << cacheCompressionRatio << std::endl;
+            ofile << "Time spent decompressing cached images: " << Timer::printAsTime(cacheDecodeTime, false).toStdString() << std::endl;
+        }
+        int nbNonFiniteValues = it->second.getNonFiniteValuesCount();
+        if (nbNonFiniteValues > 0) {
+            ofile << "NaN or infinite values replaced: " << nbNonFiniteValues << std::endl;
+        }
+        ofile << "Images memory predicted: " << printAsRAM( it->second.getPredictedImageMemory() ).toStdString() << std::endl;
+        ofile << "Images memory used: " << printAsRAM( it->second.getImageMemory() ).toStdString() << std::endl;
 
         const std::set<std::string> & planes = it->second.getPlanesRendered();
         ofile << "Plane(s) rendered: ";
@@ -67,6 +67,7 @@ private:
     mutable QMutex _outputEffectDataLock;
     std::list<RenderSequenceArgs> _renderSequenceRequests;
     RenderEnginePtr _engine;
+    SharedUpstreamImagesPtr _sharedUpstreamImages;
 
 protected: // derives from EffectInstance, parent of AbstractOfxEffectInstance, OfxEffectInstance, DiskCacheNode, NodeGroup, NoOpBase, ViewerInstance
     // TODO: enable_shared_from_this
@@ -108,6 +109,13 @@ public:
 
     void notifyRenderFinished();
 
+    /**
+     * @brief Set when this writer renders together with other writers sharing some of its upstream nodes, or NULL.
+     **/
+    void setSharedUpstreamImages(const SharedUpstreamImagesPtr& images);
+
+    SharedUpstreamImagesPtr getSharedUpstreamImages() const;
+
     void renderCurrentFrame(bool canAbort);
     void renderCurrentFrameNow(bool canAbort);
 
@@ -29,6 +29,7 @@
 #include <list>
 #include <algorithm> // min, max
 #include <cassert>
+#include <cstring> // strncpy, memcpy
 #include <stdexcept>
 
 #include <boost/scoped_ptr.hpp>
@@ -43,6 +44,8 @@
 #include <QtCore/QDebug>
 #include <QtCore/QTextStream>
 #include <QtCore/QRunnable>
+#include <QtCore/QFuture>
+#include <QtConcurrentRun> // QtCore on Qt4, QtConcurrent on Qt5
 
 #include "Global/MemoryInfo.h"
 
@@ -56,9 +59,12 @@
 #include "Engine/OpenGLViewerI.h"
 #include "Engine/GenericSchedulerThreadWatcher.h"
 #include "Engine/Project.h"
+#include "Engine/PythonCallback.h"
+#include "Engine/RenderProgressReporter.h"
 #include "Engine/RenderStats.h"
 #include "Engine/RotoContext.h"
 #include "Engine/Settings.h"
+#include "Engine/SharedUpstreamImages.h"
 #include "Engine/Timer.h"
 #include "Engine/TimeLine.h"
 #include "Engine/TLSHolder.h"
@@ -66,6 +72,7 @@
 #include "Engine/UpdateViewerParams.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/ViewerInstance.h"
+#include "Engine/ViewerPrefetcher.h"
 #include "Engine/WriteNode.h"
 
 #ifdef DEBUG
@@ -195,6 +202,9 @@ struct OutputSchedulerThreadPrivate
     U64 nFramesRendered;
     bool renderFinished; //< set to true when nFramesRendered = runArgs->lastFrame - runArgs->firstFrame + 1
 
+    // The memory of the images of the last frame rendered, predicted by its request pass. Protected by renderFinishedMutex
+    U64 frameImagesMemory;
+
     // Pointer to the args used in threadLoopOnce(), only usable from the scheduler thread
     boost::weak_ptr<OutputSchedulerThreadStartArgs> runArgs;
     mutable QMutex lastRunArgsMutex;
@@ -236,8 +246,15 @@ struct OutputSchedulerThreadPrivate
 
 #endif
 
-    QMutex bufferedOutputMutex;
-    int lastBufferedOutputSize;
+    // Name of the output effect reported with the progress, copied once per render so that reporting a frame does not allocate
+    char progressWriterName[NATRON_RENDER_PROGRESS_WRITER_NAME_SIZE];
+
+    // The Python callbacks of the output node and their thisNode and app arguments, resolved once per render.
+    // Protected by the Python GIL.
+    PythonCallback beforeRenderCallback, beforeFrameRenderCallback, afterFrameRenderCallback, afterRenderCallback;
+    std::string callbackNodeName;
+    PyObject* callbackNode;
+    PyObject* callbackApp;
 
 
     OutputSchedulerThreadPrivate(RenderEngine* engine,
@@ -252,6 +269,7 @@ struct OutputSchedulerThreadPrivate
         , renderFinishedMutex()
         , nFramesRendered(0)
         , renderFinished(false)
+        , frameImagesMemory(0)
         , runArgs()
         , lastRunArgsMutex()
         , lastPlaybackViewsToRender()
@@ -276,11 +294,92 @@ struct OutputSchedulerThreadPrivate
         , lastRecordedFPSMutex()
         , lastRecordedFPS(0.)
 #endif
-        , bufferedOutputMutex()
-        , lastBufferedOutputSize(0)
+        , beforeRenderCallback("before render", "thisNode, app")
+        , beforeFrameRenderCallback("before frame render", "frame, thisNode, app")
+        , afterFrameRenderCallback("after frame render", "frame, thisNode, app")
+        , afterRenderCallback("after render", "aborted, thisNode, app")
+        , callbackNodeName()
+        , callbackNode(0)
+        , callbackApp(0)
+    {
+        progressWriterName[0] = '\0';
+    }
+
+    ~OutputSchedulerThreadPrivate()
     {
+        // Python may already be finalized when the application quits
+        if ( Py_IsInitialized() ) {
+            releaseCallbackArguments();
+        }
+    }
+
+    void releaseCallbackArguments()
+    {
+        PythonGILLocker pgl;
+
+        Py_XDECREF(callbackNode);
+        callbackNode = 0;
+        Py_XDECREF(callbackApp);
+        callbackApp = 0;
+        callbackNodeName.clear();
     }
 
+    /**
+     * @brief Calls the callback with firstArg, if not NULL, followed by thisNode and app. firstArg is a new reference stolen by this function.
+     **/
+    void runCallback(PythonCallback& callback,
+                     const std::string& function,
+                     PyObject* firstArg)
+    {
+        OutputEffectInstancePtr effect = outputEffect.lock();
+        PythonGILLocker pgl;
+        std::string error;
+
+        if ( !callback.setFunction(function, &error) ) {
+            Py_XDECREF(firstArg);
+            effect->getApp()->appendToScriptEditor("Failed to run " + callback.getCallbackLabel() + " callback: " + error);
+
+            return;
+        }
+
+        // The node may have been renamed since the last call
+        std::string appID = effect->getApp()->getAppIDString();
+        std::string nodeName = appID + "." + effect->getNode()->getFullyQualifiedName();
+        if ( !callbackNode || (nodeName != callbackNodeName) ) {
+            releaseCallbackArguments();
+            callbackNode = PythonCallback::getVariable(nodeName);
+            callbackApp = PythonCallback::getVariable(appID);
+            if (!callbackNode || !callbackApp) {
+                releaseCallbackArguments();
+                Py_XDECREF(firstArg);
+                effect->getApp()->appendToScriptEditor("Failed to run " + callback.getCallbackLabel() + " callback: " + nodeName + " is not defined");
+
+                return;
+            }
+            callbackNodeName = nodeName;
+        }
+
+        int nArgs = firstArg ? 3 : 2;
+        PyObject* args = PyTuple_New(nArgs);
+        if (firstArg) {
+            PyTuple_SET_ITEM(args, 0, firstArg);
+        }
+        Py_INCREF(callbackNode);
+        PyTuple_SET_ITEM(args, nArgs - 2, callbackNode);
+        Py_INCREF(callbackApp);
+        PyTuple_SET_ITEM(args, nArgs - 1, callbackApp);
+
+        std::string output;
+        bool ok = callback.call(args, &error, &output);
+        Py_DECREF(args);
+        if (!ok) {
+            effect->getApp()->appendToScriptEditor("Failed to run callback: " + error);
+            throw std::runtime_error(error);
+        } else if ( !output.empty() ) {
+            effect->getApp()->appendToScriptEditor(output);
+        }
+    } // runCallback
+
     void appendBufferedFrame(double time,
                              ViewIdx view,
                              const RenderStatsPtr& stats,
@@ -1031,6 +1130,12 @@ OutputSchedulerThread::startRender()
     // Start measuring
     _imp->renderTimer.reset(new TimeLapse);
 
+    if ( appPTR->isBackground() ) {
+        OutputEffectInstancePtr effect = _imp->outputEffect.lock();
+        std::strncpy(_imp->progressWriterName, effect->getScriptName_mt_safe().c_str(), NATRON_RENDER_PROGRESS_WRITER_NAME_SIZE - 1);
+        _imp->progressWriterName[NATRON_RENDER_PROGRESS_WRITER_NAME_SIZE - 1] = '\0';
+    }
+
     ///We will push frame to renders starting at startingFrame.
     ///They will be in the range determined by firstFrame-lastFrame
     int startingFrame;
@@ -1490,6 +1595,18 @@ OutputSchedulerThread::executeOnMainThread(const ExecOnMTArgsPtr& inArgs)
     processFrame(args->frames);
 }
 
+int
+OutputSchedulerThread::getMaxParallelRendersForMemory(int optimalNThreads,
+                                                      double cacheMemory,
+                                                      U64 frameImagesMemory)
+{
+    if (frameImagesMemory == 0) {
+        return optimalNThreads;
+    }
+
+    return std::max( 1, (int)std::min( (double)optimalNThreads, cacheMemory / frameImagesMemory ) );
+}
+
 #ifndef NATRON_PLAYBACK_USES_THREAD_POOL
 void
 OutputSchedulerThread::adjustNumberOfThreads(int* newNThreads,
@@ -1519,15 +1636,25 @@ OutputSchedulerThread::adjustNumberOfThreads(int* newNThreads,
     }
     optimalNThreads = std::max(1, optimalNThreads);
 
+    ///The images of all the frames rendered in parallel must fit in the cache at the same time, otherwise
+    ///the cache evicts images still needed by the other frames. Use the memory predicted for the last frame rendered.
+    U64 frameImagesMemory;
+    {
+        QMutexLocker k(&_imp->renderFinishedMutex);
+        frameImagesMemory = _imp->frameImagesMemory;
+    }
+    double cacheMemory = appPTR->getCurrentSettings()->getRamMaximumPercent() * getSystemTotalRAM_conditionnally();
+    int maxNThreadsForMemory = getMaxParallelRendersForMemory(optimalNThreads, cacheMemory, frameImagesMemory);
+
 
-    if ( ( (runningThreads < optimalNThreads) && (currentParallelRenders < optimalNThreads) ) || (currentParallelRenders == 0) ) {
+    if ( ( (runningThreads < optimalNThreads) && (currentParallelRenders < maxNThreadsForMemory) ) || (currentParallelRenders == 0) ) {
         ////////
         ///Launch 1 thread
         QMutexLocker l(&_imp->renderThreadsMutex);
 
         _imp->appendRunnable( createRunnable() );
         *newNThreads = currentParallelRenders +  1;
-    } else if ( (runningThreads > optimalNThreads) && (currentParallelRenders > optimalNThreads) ) {
+    } else if ( ( (runningThreads > optimalNThreads) && (currentParallelRenders > optimalNThreads) ) || (currentParallelRenders > maxNThreadsForMemory) ) {
         ////////
         ///Stop 1 thread
         stopRenderThreads(1);
@@ -1560,6 +1687,25 @@ OutputSchedulerThread::notifyFrameRendered(int frame,
         if ( !statResults.empty() ) {
             effect->reportStats(frame, viewIndex, timeSpentForFrame, statResults);
         }
+
+        // Tell which node produced the NaN or infinite values, the warning set on each node is easily missed on long renders
+        int nbNonFiniteValues;
+        NodePtr nonFiniteNode = stats->getFirstNodeWithNonFiniteValues(&nbNonFiniteValues);
+        if (nonFiniteNode) {
+            QString message = tr("Frame %1: %2 NaN or infinite values were replaced, first produced by %3")
+                              .arg(frame)
+                              .arg(nbNonFiniteValues)
+                              .arg( QString::fromUtf8( nonFiniteNode->getScriptName_mt_safe().c_str() ) );
+            effect->getApp()->appendToScriptEditor( message.toStdString() );
+        }
+
+        // The views of the frame share the same stats: wait for the last one to get the memory of the whole frame
+        U64 predictedImagesMemory, imagesMemory;
+        stats->getImagesMemory(&predictedImagesMemory, &imagesMemory);
+        if (isLastView && predictedImagesMemory > 0) {
+            QMutexLocker k(&_imp->renderFinishedMutex);
+            _imp->frameImagesMemory = predictedImagesMemory;
+        }
     }
 
 
@@ -1625,41 +1771,22 @@ OutputSchedulerThread::notifyFrameRendered(int frame,
     }
     assert(_imp->renderTimer);
     double timeSpentSinceStartSec = _imp->renderTimer->getTimeSinceCreation();
-    double estimatedFps = (double)nbFramesRendered / timeSpentSinceStartSec;
+    double estimatedFps = timeSpentSinceStartSec > 0 ? (double)nbFramesRendered / timeSpentSinceStartSec : 0.;
     double timeRemaining = timeSpentSinceStartSec * (1. - percentage);
 
-    // If running in background, notify to the pipe that we rendered a frame
-    if (isBackground) {
-        QString longMessage;
-        QTextStream ts(&longMessage);
-        QString frameStr = QString::number(frame);
-        QString fpsStr = QString::number(estimatedFps, 'f', 1);
-        QString percentageStr = QString::number(percentage * 100, 'f', 1);
-        QString timeRemainingStr = Timer::printAsTime(timeRemaining, true);
-
-        ts << effect->getScriptName_mt_safe().c_str() << tr(" ==> Frame: ");
-        ts << frameStr << tr(", Progress: ") << percentageStr << "%, " << fpsStr << tr(" Fps, Time Remaining: ") << timeRemainingStr;
-
-        QString shortMessage = QString::fromUtf8(kFrameRenderedStringShort) + frameStr + QString::fromUtf8(kProgressChangedStringShort) + QString::number(percentage);
-        {
-            QMutexLocker l(&_imp->bufferedOutputMutex);
-            std::string toPrint = longMessage.toStdString();
-            if ( (_imp->lastBufferedOutputSize != 0) && ( _imp->lastBufferedOutputSize > longMessage.size() ) ) {
-                int nSpacesToAppend = _imp->lastBufferedOutputSize - longMessage.size();
-                toPrint.append(nSpacesToAppend, ' ');
-            }
-            //std::cout << '\r';
-            std::cout << toPrint;
-            std::cout << std::endl;
-
-            /*std::cout.flush();
-               if (renderingIsFinished) {
-                std::cout << std::endl;
-               }*/
-            _imp->lastBufferedOutputSize = longMessage.size();
-        }
-
-        appPTR->writeToOutputPipe(longMessage, shortMessage, false);
+    // If running in background, notify to the pipe that we rendered a frame.
+    // Formatting and writing is done by the reporter thread, we only post a record here.
+    RenderProgressReporter* reporter = isBackground ? appPTR->getRenderProgressReporter() : 0;
+    if (reporter) {
+        RenderProgressRecord record;
+        std::memcpy( record.writerName, _imp->progressWriterName, sizeof(record.writerName) );
+        record.frame = frame;
+        record.nFramesRendered = (unsigned int)nbFramesRendered;
+        record.nFramesTotal = (unsigned int)nbTotalFrames;
+        record.progress = percentage;
+        record.fps = estimatedFps;
+        record.timeRemaining = timeRemaining;
+        reporter->postFrameRendered(record);
     }
 
     // Notify we rendered a frame
@@ -1669,53 +1796,10 @@ OutputSchedulerThread::notifyFrameRendered(int frame,
 
     // Call Python after frame ranedered callback
     if ( isLastView && effect->isWriter() ) {
-        std::string cb = effect->getNode()->getAfterFrameRenderCallback();
-        if ( !cb.empty() ) {
-            std::vector<std::string> args;
-            std::string error;
-            try {
-                NATRON_PYTHON_NAMESPACE::getFunctionArguments(cb, &error, &args);
-            } catch (const std::exception& e) {
-                effect->getApp()->appendToScriptEditor( std::string("Failed to run onFrameRendered callback: ")
-                                                        + e.what() );
-
-                return;
-            }
-
-            if ( !error.empty() ) {
-                effect->getApp()->appendToScriptEditor("Failed to run after frame render callback: " + error);
-
-                return;
-            }
-
-            std::string signatureError;
-            signatureError.append("The after frame render callback supports the following signature(s):\n");
-            signatureError.append("- callback(frame, thisNode, app)");
-            if (args.size() != 3) {
-                effect->getApp()->appendToScriptEditor("Failed to run after frame render callback: " + signatureError);
-
-                return;
-            }
-
-            if ( (args[0] != "frame") || (args[1] != "thisNode") || (args[2] != "app") ) {
-                effect->getApp()->appendToScriptEditor("Failed to run after frame render callback: " + signatureError);
-
-                return;
-            }
-
-            std::stringstream ss;
-            std::string appStr = effect->getApp()->getAppIDString();
-            std::string outputNodeName = appStr + "." + effect->getNode()->getFullyQualifiedName();
-            ss << cb << "(" << frame << ", ";
-            ss << outputNodeName << ", " << appStr << ")";
-            std::string script = ss.str();
-            try {
-                runCallbackWithVariables( QString::fromUtf8( script.c_str() ) );
-            } catch (const std::exception& e) {
-                notifyRenderFailure( e.what() );
-
-                return;
-            }
+        try {
+            runAfterFrameRenderCallback(frame);
+        } catch (const std::exception& e) {
+            notifyRenderFailure( e.what() );
         }
     }
 } // OutputSchedulerThread::notifyFrameRendered
@@ -1830,8 +1914,12 @@ OutputSchedulerThread::renderFrameRange(bool isBlocking,
         QMutexLocker k(&_imp->renderFinishedMutex);
         _imp->nFramesRendered = 0;
         _imp->renderFinished = false;
+        _imp->frameImagesMemory = 0;
     }
 
+    // The node and app passed to the Python callbacks are looked up again for this render
+    _imp->releaseCallbackArguments();
+
     startTask(args);
 }
 
@@ -1938,26 +2026,46 @@ OutputSchedulerThread::getEngine() const
 }
 
 void
-OutputSchedulerThread::runCallbackWithVariables(const QString& callback)
+OutputSchedulerThread::runBeforeRenderCallback()
 {
-    if ( !callback.isEmpty() ) {
-        OutputEffectInstancePtr effect = _imp->outputEffect.lock();
-        QString script = callback;
-        std::string appID = effect->getApp()->getAppIDString();
-        std::string nodeName = effect->getNode()->getFullyQualifiedName();
-        std::string nodeFullName = appID + "." + nodeName;
-        script.append( QString::fromUtf8( nodeFullName.c_str() ) );
-        script.append( QLatin1Char(',') );
-        script.append( QString::fromUtf8( appID.c_str() ) );
-        script.append( QString::fromUtf8(")\n") );
-
-        std::string err, output;
-        if ( !NATRON_PYTHON_NAMESPACE::interpretPythonScript(callback.toStdString(), &err, &output) ) {
-            effect->getApp()->appendToScriptEditor("Failed to run callback: " + err);
-            throw std::runtime_error(err);
-        } else if ( !output.empty() ) {
-            effect->getApp()->appendToScriptEditor(output);
-        }
+    OutputEffectInstancePtr effect = _imp->outputEffect.lock();
+    std::string cb = effect->getNode()->getBeforeRenderCallback();
+
+    if ( !cb.empty() ) {
+        _imp->runCallback(_imp->beforeRenderCallback, cb, 0);
+    }
+}
+
+void
+OutputSchedulerThread::runBeforeFrameRenderCallback(int frame)
+{
+    OutputEffectInstancePtr effect = _imp->outputEffect.lock();
+    std::string cb = effect->getNode()->getBeforeFrameRenderCallback();
+
+    if ( !cb.empty() ) {
+        _imp->runCallback( _imp->beforeFrameRenderCallback, cb, PythonCallback::makeIntArgument(frame) );
+    }
+}
+
+void
+OutputSchedulerThread::runAfterFrameRenderCallback(int frame)
+{
+    OutputEffectInstancePtr effect = _imp->outputEffect.lock();
+    std::string cb = effect->getNode()->getAfterFrameRenderCallback();
+
+    if ( !cb.empty() ) {
+        _imp->runCallback( _imp->afterFrameRenderCallback, cb, PythonCallback::makeIntArgument(frame) );
+    }
+}
+
+void
+OutputSchedulerThread::runAfterRenderCallback(bool aborted)
+{
+    OutputEffectInstancePtr effect = _imp->outputEffect.lock();
+    std::string cb = effect->getNode()->getAfterRenderCallback();
+
+    if ( !cb.empty() ) {
+        _imp->runCallback( _imp->afterRenderCallback, cb, PyBool_FromLong(aborted) );
     }
 }
 
@@ -2168,84 +2276,46 @@ public:
 
 private:
 
-    void runBeforeFrameRenderCallback(int frame, const NodePtr& outputNode)
+    // Shared by all the views of a frame
+    struct RenderViewArgs
     {
-        std::string cb = outputNode->getBeforeFrameRenderCallback();
-        if ( cb.empty() ) {
-            return;
-        }
-        std::vector<std::string> args;
-        std::string error;
-        try {
-            NATRON_PYTHON_NAMESPACE::getFunctionArguments(cb, &error, &args);
-        } catch (const std::exception& e) {
-            outputNode->getApp()->appendToScriptEditor( std::string("Failed to run beforeFrameRendered callback: ")
-                                                   + e.what() );
-
-            return;
-        }
-
-        if ( !error.empty() ) {
-            outputNode->getApp()->appendToScriptEditor("Failed to run before frame render callback: " + error);
-
-            return;
-        }
-
-        std::string signatureError;
-        signatureError.append("The before frame render callback supports the following signature(s):\n");
-        signatureError.append("- callback(frame, thisNode, app)");
-        if (args.size() != 3) {
-            outputNode->getApp()->appendToScriptEditor("Failed to run before frame render callback: " + signatureError);
-
-            return;
-        }
-
-        if ( (args[0] != "frame") || (args[1] != "thisNode") || (args[2] != "app") ) {
-            outputNode->getApp()->appendToScriptEditor("Failed to run before frame render callback: " + signatureError);
-
-            return;
-        }
+        int time;
+        AbortableRenderInfoPtr abortInfo;
+        EffectInstancePtr activeInputToRender;
+        bool viewsRenderedConcurrently;
+        RenderStatsPtr stats;
+        QThread* renderFrameThread; // the thread of renderFrame()
+    };
 
-        std::stringstream ss;
-        std::string appStr = outputNode->getApp()->getAppIDString();
-        std::string outputNodeName = appStr + "." + outputNode->getFullyQualifiedName();
-        ss << cb << "(" << frame << ", " << outputNodeName << ", " << appStr << ")";
-        std::string script = ss.str();
-        try {
-            _imp->scheduler->runCallbackWithVariables( QString::fromUtf8( script.c_str() ) );
-        } catch (const std::exception &e) {
-            _imp->scheduler->notifyRenderFailure( e.what() );
+    /**
+     * @brief Renders one view of the frame with the active input of the output.
+     * Returns an empty string on success, or the failure to report to the scheduler.
+     * The views of a frame may be rendered concurrently: this is called from a thread of the global pool for all but the first view.
+     **/
+    std::string renderView(const RenderViewArgs& args,
+                           ViewIdx view)
+    {
+        std::string ret = renderViewInternal(args, view);
 
-            return;
+        // The TLS of the nodes rendered by a thread of the global pool would otherwise be kept until the thread is reused
+        if (QThread::currentThread() != args.renderFrameThread) {
+            appPTR->getAppTLS()->cleanupTLSForThread();
         }
 
-
+        return ret;
     }
 
-
-    virtual void renderFrame(int time,
-                             const std::vector<ViewIdx>& viewsToRender,
-                             bool enableRenderStats)
+    std::string renderViewInternal(const RenderViewArgs& args,
+                                   ViewIdx view)
     {
+        const int time = args.time;
+        const EffectInstancePtr& activeInputToRender = args.activeInputToRender;
         OutputEffectInstancePtr output = _imp->output.lock();
 
         if (!output) {
-            _imp->scheduler->notifyRenderFailure("");
-
-            return;
+            return std::string("Render aborted");
         }
 
-        AbortableThread* isAbortableThread = dynamic_cast<AbortableThread*>( QThread::currentThread() );
-
-        // Even if enableRenderStats is false, we at least profile the time spent rendering the frame when rendering with a Write node.
-        // Though we don't enable render stats for sequential renders (e.g: WriteFFMPEG) since this is 1 file.
-        RenderStatsPtr stats( new RenderStats(enableRenderStats) );
-
-        NodePtr outputNode = output->getNode();
-
-        // Notify we start rendering a frame to Python
-        runBeforeFrameRenderCallback(time, outputNode);
-
         try {
             // Writers always render at scale 1 (for now)
             int mipMapLevel = 0;
@@ -2253,143 +2323,207 @@ private:
 
             RectD rod;
 
-            EffectInstancePtr activeInputToRender = output;
-
-            // If the output is a Write node, actually write is the internal write node encoder
-            WriteNodePtr isWrite = toWriteNode(output);
-            if (isWrite) {
-                NodePtr embeddedWriter = isWrite->getEmbeddedWriter();
-                if (embeddedWriter) {
-                    activeInputToRender = embeddedWriter->getEffectInstance();
-                }
-            }
-            assert(activeInputToRender);
-
             NodePtr activeInputNode = activeInputToRender->getNode();
             const double par = activeInputToRender->getAspectRatio(-1);
             const bool isRenderDueToRenderInteraction = false;
             const bool isSequentialRender = true;
 
-            for (std::size_t view = 0; view < viewsToRender.size(); ++view) {
+            // Setup frame TLS args
+            ParallelRenderArgsSetter::CtorArgsPtr tlsArgs(new ParallelRenderArgsSetter::CtorArgs);
+            tlsArgs->time = time;
+            tlsArgs->view = view;
+            tlsArgs->isRenderUserInteraction = isRenderDueToRenderInteraction;
+            tlsArgs->isSequential = isSequentialRender;
+            tlsArgs->abortInfo = args.abortInfo;
+            tlsArgs->treeRoot = activeInputNode;
+            tlsArgs->textureIndex = 0;
+            tlsArgs->timeline = output->getApp()->getTimeLine();
+            tlsArgs->activeRotoPaintNode = NodePtr();
+            tlsArgs->activeRotoDrawableItem = RotoDrawableItemPtr();
+            tlsArgs->isDoingRotoNeatRender = false;
+            tlsArgs->isAnalysis = false;
+            tlsArgs->draftMode = false;
+            tlsArgs->viewsRenderedConcurrently = args.viewsRenderedConcurrently;
+            // The stats also get the memory predicted for the images of the frame by the request pass, and the memory actually used
+            tlsArgs->stats = args.stats;
+            boost::shared_ptr<ParallelRenderArgsSetter> frameRenderArgs;
+            try {
+                frameRenderArgs.reset(new ParallelRenderArgsSetter(tlsArgs));
+            } catch (...) {
+                return std::string("Error caught while rendering");
+            }
 
+            // The images of the nodes shared with other writers rendering together are kept until all of them rendered the frame
+            SharedUpstreamImagesPtr sharedImages = output->getSharedUpstreamImages();
+            if (sharedImages) {
+                frameRenderArgs->setSharedUpstreamImages(sharedImages);
+            }
 
-                // Setup frame TLS args
-                AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
-                if (isAbortableThread) {
-                    isAbortableThread->setAbortInfo(isRenderDueToRenderInteraction, abortInfo, activeInputToRender);
-                }
+            // Get the hash now that we applied TLS
+            U64 activeInputHash;
+            bool gotHash = activeInputToRender->getRenderHash(time, view, &activeInputHash);
+            assert(gotHash);
+            (void)gotHash;
 
-                ParallelRenderArgsSetter::CtorArgsPtr tlsArgs(new ParallelRenderArgsSetter::CtorArgs);
-                tlsArgs->time = time;
-                tlsArgs->view = viewsToRender[view];
-                tlsArgs->isRenderUserInteraction = isRenderDueToRenderInteraction;
-                tlsArgs->isSequential = isSequentialRender;
-                tlsArgs->abortInfo = abortInfo;
-                tlsArgs->treeRoot = activeInputNode;
-                tlsArgs->textureIndex = 0;
-                tlsArgs->timeline = output->getApp()->getTimeLine();
-                tlsArgs->activeRotoPaintNode = NodePtr();
-                tlsArgs->activeRotoDrawableItem = RotoDrawableItemPtr();
-                tlsArgs->isDoingRotoNeatRender = false;
-                tlsArgs->isAnalysis = false;
-                tlsArgs->draftMode = false;
-                tlsArgs->stats = RenderStatsPtr();
-                boost::shared_ptr<ParallelRenderArgsSetter> frameRenderArgs;
-                try {
-                    frameRenderArgs.reset(new ParallelRenderArgsSetter(tlsArgs));
-                } catch (...) {
-                    _imp->scheduler->notifyRenderFailure("Error caught while rendering");
-
-                    return;
+            // Call getRoD to know where to render
+            StatusEnum stat = activeInputToRender->getRegionOfDefinition_public(activeInputHash, time, scale, view, &rod);
+            if (stat == eStatusFailed) {
+                return std::string("Error caught while rendering");
+            }
 
-                }
 
-                // Get the hash now that we applied TLS
-                U64 activeInputHash;
-                bool gotHash = activeInputToRender->getRenderHash(time, tlsArgs->view, &activeInputHash);
-                assert(gotHash);
-                (void)gotHash;
-                
-                // Call getRoD to know where to render
-                StatusEnum stat = activeInputToRender->getRegionOfDefinition_public(activeInputHash, time, scale, viewsToRender[view], &rod);
-                if (stat == eStatusFailed) {
-                    _imp->scheduler->notifyRenderFailure("Error caught while rendering");
-
-                    return;
-                }
+            // Get layers to render
+            std::list<ImageComponents> components;
+            ImageBitDepthEnum imageDepth;
 
+            //Use needed components to figure out what we need to render
+            EffectInstance::ComponentsNeededMap neededComps;
+            bool processAll;
+            SequenceTime ptTime;
+            int ptView;
+            std::bitset<4> processChannels;
+            NodePtr ptInput;
+            activeInputToRender->getComponentsNeededAndProduced_public(true, true, time, view, &neededComps, &processAll, &ptTime, &ptView, &processChannels, &ptInput);
 
-                // Get layers to render
-                std::list<ImageComponents> components;
-                ImageBitDepthEnum imageDepth;
 
-                //Use needed components to figure out what we need to render
-                EffectInstance::ComponentsNeededMap neededComps;
-                bool processAll;
-                SequenceTime ptTime;
-                int ptView;
-                std::bitset<4> processChannels;
-                NodePtr ptInput;
-                activeInputToRender->getComponentsNeededAndProduced_public(true, true, time, viewsToRender[view], &neededComps, &processAll, &ptTime, &ptView, &processChannels, &ptInput);
+            //Retrieve bitdepth only
+            imageDepth = activeInputToRender->getBitDepth(-1);
+            components.clear();
 
+            EffectInstance::ComponentsNeededMap::iterator foundOutput = neededComps.find(-1);
+            if ( foundOutput != neededComps.end() ) {
+                for (std::size_t j = 0; j < foundOutput->second.size(); ++j) {
+                    components.push_back(foundOutput->second[j]);
+                }
+            }
 
-                //Retrieve bitdepth only
-                imageDepth = activeInputToRender->getBitDepth(-1);
-                components.clear();
+            // The render window is the RoD in pixel coordinates in our case
+            RectI renderWindow;
+            rod.toPixelEnclosing(scale, par, &renderWindow);
 
-                EffectInstance::ComponentsNeededMap::iterator foundOutput = neededComps.find(-1);
-                if ( foundOutput != neededComps.end() ) {
-                    for (std::size_t j = 0; j < foundOutput->second.size(); ++j) {
-                        components.push_back(foundOutput->second[j]);
-                    }
+            // Optimize roi
+            stat = frameRenderArgs->computeRequestPass(mipMapLevel, rod);
+            if (stat == eStatusFailed) {
+                return std::string("Error caught while rendering");
+            }
+
+            // Launch render
+            RenderingFlagSetter flagIsRendering( activeInputToRender->getNode() );
+            std::map<ImageComponents, ImagePtr> planes;
+            boost::scoped_ptr<EffectInstance::RenderRoIArgs> renderArgs( new EffectInstance::RenderRoIArgs(time, //< the time at which to render
+                                                                                                           scale, //< the scale at which to render
+                                                                                                           mipMapLevel, //< the mipmap level (redundant with the scale)
+                                                                                                           view, //< the view to render
+                                                                                                           false, //< byPassCache
+                                                                                                           renderWindow, //< the render window (in pixel coordinates)
+                                                                                                           rod, // < any precomputed rod ? in canonical coordinates
+                                                                                                           components,
+                                                                                                           imageDepth,
+                                                                                                           false,
+                                                                                                           activeInputToRender,
+                                                                                                           eStorageModeRAM,
+                                                                                                           time) );
+
+            EffectInstance::RenderRoIRetCode retCode = activeInputToRender->renderRoI(*renderArgs, &planes);
+
+            if (retCode != EffectInstance::eRenderRoIRetCodeOk) {
+                if (retCode == EffectInstance::eRenderRoIRetCodeAborted) {
+                    return std::string("Render aborted");
+                } else {
+                    return std::string("Error caught while rendering");
                 }
+            }
+        } catch (const std::exception& e) {
+            return std::string("Error while rendering: ") + e.what();
+        }
 
-                // The render window is the RoD in pixel coordinates in our case
-                RectI renderWindow;
-                rod.toPixelEnclosing(scale, par, &renderWindow);
+        return std::string();
+    } // renderViewInternal
 
-                // Optimize roi
-                stat = frameRenderArgs->computeRequestPass(mipMapLevel, rod);
-                if (stat == eStatusFailed) {
-                    _imp->scheduler->notifyRenderFailure("Error caught while rendering");
+    virtual void renderFrame(int time,
+                             const std::vector<ViewIdx>& viewsToRender,
+                             bool enableRenderStats)
+    {
+        OutputEffectInstancePtr output = _imp->output.lock();
 
-                    return;
-                }
+        if ( !output || viewsToRender.empty() ) {
+            _imp->scheduler->notifyRenderFailure("");
 
-                // Launch render
-                RenderingFlagSetter flagIsRendering( activeInputToRender->getNode() );
-                std::map<ImageComponents, ImagePtr> planes;
-                boost::scoped_ptr<EffectInstance::RenderRoIArgs> renderArgs( new EffectInstance::RenderRoIArgs(time, //< the time at which to render
-                                                                                                               scale, //< the scale at which to render
-                                                                                                               mipMapLevel, //< the mipmap level (redundant with the scale)
-                                                                                                               viewsToRender[view], //< the view to render
-                                                                                                               false, //< byPassCache
-                                                                                                               renderWindow, //< the render window (in pixel coordinates)
-                                                                                                               rod, // < any precomputed rod ? in canonical coordinates
-                                                                                                               components,
-                                                                                                               imageDepth,
-                                                                                                               false,
-                                                                                                               activeInputToRender,
-                                                                                                               eStorageModeRAM,
-                                                                                                               time) );
-
-                EffectInstance::RenderRoIRetCode retCode = activeInputToRender->renderRoI(*renderArgs, &planes);
-
-                if (retCode != EffectInstance::eRenderRoIRetCodeOk) {
-                    if (retCode == EffectInstance::eRenderRoIRetCodeAborted) {
-                        _imp->scheduler->notifyRenderFailure("Render aborted");
-                    } else {
-                        _imp->scheduler->notifyRenderFailure("Error caught while rendering");
-                    }
+            return;
+        }
 
-                    return;
-                }
+        AbortableThread* isAbortableThread = dynamic_cast<AbortableThread*>( QThread::currentThread() );
 
-                // If we need sequential rendering, pass the image to the output scheduler that will ensure the sequential ordering
-                _imp->scheduler->notifyFrameRendered(time, viewsToRender[view], viewsToRender, stats, eSchedulingPolicyFFA);
-            }
+        // Even if enableRenderStats is false, we at least profile the time spent rendering the frame when rendering with a Write node.
+        // Though we don't enable render stats for sequential renders (e.g: WriteFFMPEG) since this is 1 file.
+        RenderStatsPtr stats( new RenderStats(enableRenderStats) );
+
+        // Notify we start rendering a frame to Python
+        try {
+            _imp->scheduler->runBeforeFrameRenderCallback(time);
         } catch (const std::exception& e) {
-            _imp->scheduler->notifyRenderFailure( std::string("Error while rendering: ") + e.what() );
+            _imp->scheduler->notifyRenderFailure( e.what() );
+        }
+
+        EffectInstancePtr activeInputToRender = output;
+
+        // If the output is a Write node, actually write is the internal write node encoder
+        WriteNodePtr isWrite = toWriteNode(output);
+        if (isWrite) {
+            NodePtr embeddedWriter = isWrite->getEmbeddedWriter();
+            if (embeddedWriter) {
+                activeInputToRender = embeddedWriter->getEffectInstance();
+            }
+        }
+        assert(activeInputToRender);
+
+        // All the views of the frame share the same abort info: aborting the render aborts all of them
+        const bool isRenderDueToRenderInteraction = false;
+        AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
+        abortInfo->setPriority(eRenderPriorityBackground);
+        if (isAbortableThread) {
+            isAbortableThread->setAbortInfo(isRenderDueToRenderInteraction, abortInfo, activeInputToRender);
+        }
+
+        // Render the views concurrently: this thread renders the first view while the global thread pool renders the others.
+        // The images of view-invariant nodes are requested at view 0 by all views: with the trimap enabled, the first view
+        // to need one renders it while the others wait for it and then read it from the cache.
+        RenderViewArgs renderViewArgs;
+        renderViewArgs.time = time;
+        renderViewArgs.abortInfo = abortInfo;
+        renderViewArgs.activeInputToRender = activeInputToRender;
+        renderViewArgs.viewsRenderedConcurrently = viewsToRender.size() > 1;
+        renderViewArgs.stats = stats;
+        renderViewArgs.renderFrameThread = QThread::currentThread();
+        std::vector<QFuture<std::string> > otherViews;
+        for (std::size_t i = 1; i < viewsToRender.size(); ++i) {
+            otherViews.push_back( QtConcurrent::run(this, &DefaultRenderFrameRunnable::renderView, renderViewArgs, viewsToRender[i]) );
+        }
+        std::string error = renderView(renderViewArgs, viewsToRender[0]);
+        for (std::size_t i = 0; i < otherViews.size(); ++i) {
+            // If the pool did not start it yet, it is run in this thread
+            otherViews[i].waitForFinished();
+            std::string viewError = otherViews[i].result();
+            if ( error.empty() ) {
+                error = viewError;
+            }
+        }
+
+        // This writer no longer needs the images held for this frame, even if the render failed
+        SharedUpstreamImagesPtr sharedImages = output->getSharedUpstreamImages();
+        if (sharedImages) {
+            sharedImages->notifyFrameRendered(time);
+        }
+
+        if ( !error.empty() ) {
+            _imp->scheduler->notifyRenderFailure(error);
+
+            return;
+        }
+
+        // The frame is counted as rendered when its last view is notified
+        for (std::size_t i = 0; i < viewsToRender.size(); ++i) {
+            _imp->scheduler->notifyFrameRendered(time, viewsToRender[i], viewsToRender, stats, eSchedulingPolicyFFA);
         }
     } // renderFrame
 };
@@ -2445,6 +2579,7 @@ DefaultScheduler::processFrame(const BufferedFrames& /*frames*/)
 
     for (BufferedFrames::const_iterator it = frames.begin(); it != frames.end(); ++it) {
         AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
+        abortInfo->setPriority(eRenderPriorityBackground);
 
         setAbortInfo(isRenderDueToRenderInteraction, abortInfo, effect);
 
@@ -2462,6 +2597,7 @@ DefaultScheduler::processFrame(const BufferedFrames& /*frames*/)
         tlsArgs->isDoingRotoNeatRender = false;
         tlsArgs->isAnalysis = false;
         tlsArgs->draftMode = false;
+        tlsArgs->viewsRenderedConcurrently = false;
         tlsArgs->stats = it->stats;
         boost::shared_ptr<ParallelRenderArgsSetter> frameRenderArgs;
         try {
@@ -2596,51 +2732,10 @@ DefaultScheduler::aboutToStartRender()
         isWrite->onSequenceRenderStarted();
     }
 
-    std::string cb = effect->getNode()->getBeforeRenderCallback();
-    if ( !cb.empty() ) {
-        std::vector<std::string> args;
-        std::string error;
-        try {
-            NATRON_PYTHON_NAMESPACE::getFunctionArguments(cb, &error, &args);
-        } catch (const std::exception& e) {
-            effect->getApp()->appendToScriptEditor( std::string("Failed to run beforeRender callback: ")
-                                                    + e.what() );
-
-            return;
-        }
-
-        if ( !error.empty() ) {
-            effect->getApp()->appendToScriptEditor("Failed to run beforeRender callback: " + error);
-
-            return;
-        }
-
-        std::string signatureError;
-        signatureError.append("The beforeRender callback supports the following signature(s):\n");
-        signatureError.append("- callback(thisNode, app)");
-        if (args.size() != 2) {
-            effect->getApp()->appendToScriptEditor("Failed to run beforeRender callback: " + signatureError);
-
-            return;
-        }
-
-        if ( (args[0] != "thisNode") || (args[1] != "app") ) {
-            effect->getApp()->appendToScriptEditor("Failed to run beforeRender callback: " + signatureError);
-
-            return;
-        }
-
-
-        std::stringstream ss;
-        std::string appStr = effect->getApp()->getAppIDString();
-        std::string outputNodeName = appStr + "." + effect->getNode()->getFullyQualifiedName();
-        ss << cb << "(" << outputNodeName << ", " << appStr << ")";
-        std::string script = ss.str();
-        try {
-            runCallbackWithVariables( QString::fromUtf8( script.c_str() ) );
-        } catch (const std::exception &e) {
-            notifyRenderFailure( e.what() );
-        }
+    try {
+        runBeforeRenderCallback();
+    } catch (const std::exception &e) {
+        notifyRenderFailure( e.what() );
     }
 } // DefaultScheduler::aboutToStartRender
 
@@ -2654,6 +2749,12 @@ DefaultScheduler::onRenderStopped(bool aborted)
         effect->setKnobsFrozen(false);
     }
 
+    // Report all frames before the end of the render
+    RenderProgressReporter* reporter = appPTR->getRenderProgressReporter();
+    if (reporter) {
+        reporter->flush();
+    }
+
     {
         QString longText = QString::fromUtf8( effect->getScriptName_mt_safe().c_str() ) + tr(" ==> Rendering finished");
         appPTR->writeToOutputPipe(longText, QString::fromUtf8(kRenderingFinishedStringShort), true);
@@ -2661,57 +2762,10 @@ DefaultScheduler::onRenderStopped(bool aborted)
 
     effect->notifyRenderFinished();
 
-    std::string cb = effect->getNode()->getAfterRenderCallback();
-    if ( !cb.empty() ) {
-        std::vector<std::string> args;
-        std::string error;
-        try {
-            NATRON_PYTHON_NAMESPACE::getFunctionArguments(cb, &error, &args);
-        } catch (const std::exception& e) {
-            effect->getApp()->appendToScriptEditor( std::string("Failed to run afterRender callback: ")
-                                                    + e.what() );
-
-            return;
-        }
-
-        if ( !error.empty() ) {
-            effect->getApp()->appendToScriptEditor("Failed to run afterRender callback: " + error);
-
-            return;
-        }
-
-        std::string signatureError;
-        signatureError.append("The after render callback supports the following signature(s):\n");
-        signatureError.append("- callback(aborted, thisNode, app)");
-        if (args.size() != 3) {
-            effect->getApp()->appendToScriptEditor("Failed to run afterRender callback: " + signatureError);
-
-            return;
-        }
-
-        if ( (args[0] != "aborted") || (args[1] != "thisNode") || (args[2] != "app") ) {
-            effect->getApp()->appendToScriptEditor("Failed to run afterRender callback: " + signatureError);
-
-            return;
-        }
-
-
-        std::stringstream ss;
-        std::string appStr = effect->getApp()->getAppIDString();
-        std::string outputNodeName = appStr + "." + effect->getNode()->getFullyQualifiedName();
-        ss << cb << "(";
-        if (aborted) {
-            ss << "True, ";
-        } else {
-            ss << "False, ";
-        }
-        ss << outputNodeName << ", " << appStr << ")";
-        std::string script = ss.str();
-        try {
-            runCallbackWithVariables( QString::fromUtf8( script.c_str() ) );
-        } catch (...) {
-            //Ignore expcetions in callback since the render is finished anyway
-        }
+    try {
+        runAfterRenderCallback(aborted);
+    } catch (...) {
+        //Ignore expcetions in callback since the render is finished anyway
     }
 } // DefaultScheduler::onRenderStopped
 
@@ -2983,6 +3037,9 @@ struct RenderEnginePrivate
     PlaybackModeEnum pbMode;
     ViewerCurrentFrameRequestScheduler* currentFrameScheduler;
 
+    // Renders the frames around the playhead after each current frame render request, only for viewers
+    ViewerPrefetcher* prefetcher;
+
     // Only used on the main-thread
     boost::scoped_ptr<RenderEngineWatcher> engineWatcher;
     struct RefreshRequest
@@ -3007,6 +3064,7 @@ struct RenderEnginePrivate
         , pbModeMutex()
         , pbMode(ePlaybackModeLoop)
         , currentFrameScheduler(0)
+        , prefetcher(0)
         , refreshQueue()
     {
     }
@@ -3020,6 +3078,8 @@ RenderEngine::RenderEngine(const OutputEffectInstancePtr& output)
 
 RenderEngine::~RenderEngine()
 {
+    delete _imp->prefetcher;
+    _imp->prefetcher = 0;
     delete _imp->currentFrameScheduler;
     _imp->currentFrameScheduler = 0;
     delete _imp->scheduler;
@@ -3048,6 +3108,7 @@ RenderEngine::renderFrameRange(bool isBlocking,
                                RenderDirectionEnum forward)
 {
     setPlaybackAutoRestartEnabled(true);
+    abortPrefetch();
 
     {
         QMutexLocker k(&_imp->schedulerCreationLock);
@@ -3065,6 +3126,7 @@ RenderEngine::renderFromCurrentFrame(bool enableRenderStats,
                                      RenderDirectionEnum forward)
 {
     setPlaybackAutoRestartEnabled(true);
+    abortPrefetch();
 
     {
         QMutexLocker k(&_imp->schedulerCreationLock);
@@ -3143,6 +3205,20 @@ RenderEngine::renderCurrentFrameNow(bool enableRenderStats,
     }
 
     _imp->currentFrameScheduler->renderCurrentFrame(enableRenderStats, canAbort);
+
+    // Use the idle time to render the frames the user is likely to seek to next
+    if (!_imp->prefetcher) {
+        _imp->prefetcher = new ViewerPrefetcher(isViewer);
+    }
+    _imp->prefetcher->schedulePrefetch();
+}
+
+void
+RenderEngine::abortPrefetch()
+{
+    if (_imp->prefetcher) {
+        _imp->prefetcher->abortPrefetch();
+    }
 }
 
 void
@@ -3183,6 +3259,10 @@ RenderEngine::quitEngine(bool allowRestarts)
     if (_imp->currentFrameScheduler) {
         _imp->currentFrameScheduler->quitThread(allowRestarts);
     }
+
+    if (_imp->prefetcher) {
+        _imp->prefetcher->quitThread(allowRestarts);
+    }
 }
 
 void
@@ -3195,6 +3275,10 @@ RenderEngine::waitForEngineToQuit_not_main_thread()
     if (_imp->currentFrameScheduler) {
         _imp->currentFrameScheduler->waitForThreadToQuit_not_main_thread();
     }
+
+    if (_imp->prefetcher) {
+        _imp->prefetcher->waitForThreadToQuit_not_main_thread();
+    }
 }
 
 void
@@ -3217,6 +3301,10 @@ RenderEngine::waitForEngineToQuit_enforce_blocking()
     if (_imp->currentFrameScheduler) {
         _imp->currentFrameScheduler->waitForThreadToQuit_enforce_blocking();
     }
+
+    if (_imp->prefetcher) {
+        _imp->prefetcher->waitForThreadToQuit_enforce_blocking();
+    }
 }
 
 bool
@@ -3335,8 +3423,12 @@ RenderEngine::hasThreadsAlive() const
     if (_imp->currentFrameScheduler) {
         currentFrameSchedulerRunning = _imp->currentFrameScheduler->isRunning();
     }
+    bool prefetcherRunning = false;
+    if (_imp->prefetcher) {
+        prefetcherRunning = _imp->prefetcher->isRunning();
+    }
 
-    return schedulerRunning || currentFrameSchedulerRunning;
+    return schedulerRunning || currentFrameSchedulerRunning || prefetcherRunning;
 }
 
 bool
@@ -322,7 +322,22 @@ public:
      **/
     double getDesiredFPS() const;
 
-    void runCallbackWithVariables(const QString& callback);
+    /**
+     * @brief Returns how many frames may be rendered in parallel, at most optimalNThreads, so that the images
+     * of all of them fit in cacheMemory bytes. frameImagesMemory is the memory predicted for the images of a frame
+     * by the request pass, or 0 if it is not known yet in which case optimalNThreads is returned.
+     **/
+    static int getMaxParallelRendersForMemory(int optimalNThreads, double cacheMemory, U64 frameImagesMemory);
+
+    /**
+     * @brief Run the Python callbacks of the output node, passing thisNode and app after the given arguments.
+     * The callbacks are looked up and validated when they are first called or changed, then called directly.
+     * Errors are reported in the script editor. Throws if the callback raised an error.
+     **/
+    void runBeforeRenderCallback();
+    void runBeforeFrameRenderCallback(int frame);
+    void runAfterFrameRenderCallback(int frame);
+    void runAfterRenderCallback(bool aborted);
 
 private Q_SLOTS:
 
@@ -675,6 +690,12 @@ public:
      **/
     void renderCurrentFrameNow(bool enableRenderStats, bool canAbort);
 
+    /**
+     * @brief Aborts the speculative renders of the frames around the playhead, see ViewerPrefetcher.
+     * This should be called when something changes the images, such as a parameter. This is not blocking.
+     **/
+    void abortPrefetch();
+
     /**
      * @brief Whether the playback can be automatically restarted by a single render request
      **/
@@ -29,6 +29,9 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include <QtCore/QCoreApplication>
+#include <QtCore/QThread>
+
 #include "Engine/AppInstance.h"
 #include "Engine/AbortableRenderInfo.h"
 #include "Engine/AppManager.h"
@@ -36,10 +39,15 @@
 #include "Engine/Hash64.h"
 #include "Engine/EffectInstance.h"
 #include "Engine/Image.h"
+#include "Engine/KnobValuesSnapshot.h"
+#include "Engine/SharedUpstreamImages.h"
 #include "Engine/Node.h"
 #include "Engine/NodeGroup.h"
+#include "Engine/NonKeyParams.h"
 #include "Engine/GPUContextPool.h"
 #include "Engine/OSGLContext.h"
+#include "Engine/RenderPriorityScheduler.h"
+#include "Engine/RenderStats.h"
 #include "Engine/RotoContext.h"
 #include "Engine/RotoPaint.h"
 #include "Engine/RotoStrokeItem.h"
@@ -882,7 +890,23 @@ static void setNodeTLSInternal(const ParallelRenderArgsSetter::CtorArgsPtr& inAr
         tlsArgs->currentOpenGLSupport = glSupport;
         tlsArgs->doNanHandling = doNansHandling;
         tlsArgs->draftMode = inArgs->draftMode;
+        tlsArgs->viewsRenderedConcurrently = inArgs->viewsRenderedConcurrently;
         tlsArgs->stats = inArgs->stats;
+
+        // Capture the knobs values at the frames and views the node is rendered at, so that the render reads them without locking.
+        // Analysis changes the knobs while rendering, and the main thread reads the values displayed by the GUI: keep reading the knobs then.
+        if ( !inArgs->isAnalysis && ( QThread::currentThread() != qApp->thread() ) ) {
+            boost::shared_ptr<KnobValuesSnapshot> knobValues( new KnobValuesSnapshot() );
+            KnobsVec knobs = effect->getKnobs_mt_safe();
+            if ( frameViewHashes.empty() ) {
+                // The node is only reached through expressions
+                knobValues->captureKnobs(knobs, inArgs->time, inArgs->view);
+            }
+            for (FrameViewHashMap::const_iterator it = frameViewHashes.begin(); it != frameViewHashes.end(); ++it) {
+                knobValues->captureKnobs(knobs, it->first.time, it->first.view);
+            }
+            tlsArgs->knobValues = knobValues;
+        }
         effect->setParallelRenderArgsTLS(tlsArgs);
 
     }
@@ -940,9 +964,15 @@ ParallelRenderArgsSetter::ParallelRenderArgsSetter(const CtorArgsPtr& inArgs)
 , _treeRoot(inArgs->treeRoot)
 , _time(inArgs->time)
 , _view(inArgs->view)
+, _priorityRegistration()
+, _stats(inArgs->stats)
 {
     assert(inArgs->treeRoot);
 
+    if (inArgs->abortInfo) {
+        _priorityRegistration.reset( new RenderPriorityScheduler_RAII( appPTR->getRenderPriorityScheduler(), inArgs->abortInfo->getPriority() ) );
+    }
+
 
 
 
@@ -974,6 +1004,31 @@ ParallelRenderArgsSetter::computeRequestPass(unsigned int mipMapLevel, const Rec
     if (stat != eStatusOK) {
         return stat;
     }
+
+    // Predict the memory of the images of the frame from the final region of interest of each node.
+    // Images produced in several planes or at several mipmap levels are not accounted for, and the cache may already hold some of these images.
+    for (FrameRequestMap::const_iterator it = requestData.begin(); it != requestData.end(); ++it) {
+        EffectInstancePtr effect = it->first->getEffectInstance();
+        if (!effect) {
+            continue;
+        }
+        double par = effect->getAspectRatio(-1);
+        U64 pixelSize = (U64)effect->getComponents(-1).getNumComponents() * getSizeOfForBitDepth( effect->getBitDepth(-1) );
+        U64 nodeMemory = 0;
+        for (NodeFrameViewRequestData::const_iterator it2 = it->second->frames.begin(); it2 != it->second->frames.end(); ++it2) {
+            const RectD& roi = it2->second.finalData.finalRoi;
+            if ( roi.isNull() ) {
+                continue;
+            }
+            RectI pixelRoI;
+            roi.toPixelEnclosing(mipMapLevel, par, &pixelRoI);
+            nodeMemory += pixelRoI.area() * pixelSize;
+        }
+        if (_stats && nodeMemory) {
+            _stats->addPredictedImageMemoryForNode(it->first, nodeMemory);
+        }
+    }
+
     for (NodesList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
         {
             FrameRequestMap::const_iterator foundRequest = requestData.find(*it);
@@ -1005,6 +1060,8 @@ ParallelRenderArgsSetter::ParallelRenderArgsSetter(const boost::shared_ptr<std::
 , _treeRoot()
 , _time(0)
 , _view(0)
+, _priorityRegistration()
+, _stats()
 {
     bool isPainting = false;
     if (args && !args->empty()) {
@@ -1036,6 +1093,20 @@ ParallelRenderArgsSetter::ParallelRenderArgsSetter(const boost::shared_ptr<std::
     }
 }
 
+void
+ParallelRenderArgsSetter::setSharedUpstreamImages(const SharedUpstreamImagesPtr& images)
+{
+    for (NodesList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        if ( !images->isSharedNode(*it) ) {
+            continue;
+        }
+        ParallelRenderArgsPtr args = (*it)->getEffectInstance()->getParallelRenderArgsTLS();
+        if (args) {
+            args->sharedUpstreamImages = images;
+        }
+    }
+}
+
 ParallelRenderArgsSetter::~ParallelRenderArgsSetter()
 {
     for (NodesList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
@@ -1088,6 +1159,7 @@ ParallelRenderArgs::ParallelRenderArgs()
     , doNansHandling(true)
     , draftMode(false)
     , tilesSupported(false)
+    , viewsRenderedConcurrently(false)
 {
 }
 
@@ -1099,6 +1171,12 @@ ParallelRenderArgs::isCurrentFrameRenderNotAbortable() const
     return isRenderResponseToUserInteraction && ( !info || !info->canAbort() );
 }
 
+bool
+ParallelRenderArgs::isTrimapEnabled() const
+{
+    return viewsRenderedConcurrently || isCurrentFrameRenderNotAbortable();
+}
+
 bool
 ParallelRenderArgs::getFrameViewHash(double time, ViewIdx view, U64* hash) const
 {
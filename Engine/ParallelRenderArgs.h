@@ -156,6 +156,12 @@ public:
     ///Various stats local to the render of a frame
     RenderStatsPtr stats;
 
+    ///The values of the knobs of this node captured when the render of the frame started, or NULL if they are read as usual
+    KnobValuesSnapshotPtr knobValues;
+
+    ///When this node is upstream of several writers rendering together, holds its images until all the writers rendered the frame
+    SharedUpstreamImagesPtr sharedUpstreamImages;
+
     // Hash of this node for a frame/view pair
     FrameViewHashMap frameViewHash;
 
@@ -197,10 +203,21 @@ public:
     ///The support for tiles is local to a render and may change depending on GPU usage or other parameters
     bool tilesSupported : 1;
 
+    ///When true, the other views of the frame are rendered at the same time by other threads sharing the same abortInfo
+    bool viewsRenderedConcurrently : 1;
+
     ParallelRenderArgs();
 
     bool isCurrentFrameRenderNotAbortable() const;
 
+    /**
+     * @brief Whether the pixels being rendered are marked in the bitmap of the images (the trimap), so that threads needing the same
+     * pixels wait for them instead of rendering them again.
+     * This is only done when a thread cannot abort without the others also aborting: for renders that cannot be aborted
+     * and for the views of a frame rendered concurrently, which share view-invariant images.
+     **/
+    bool isTrimapEnabled() const;
+
     bool getFrameViewHash(double time, ViewIdx view, U64* hash) const;
 };
 
@@ -282,6 +299,11 @@ class ParallelRenderArgsSetter
     ViewIdx _view;
     boost::weak_ptr<OSGLContext> _openGLContext, _cpuOpenGLContext;
 
+    // Registers the render in the RenderPriorityScheduler while the tree is set up
+    boost::shared_ptr<RenderPriorityScheduler_RAII> _priorityRegistration;
+
+    RenderStatsPtr _stats;
+
 public:
 
     struct CtorArgs
@@ -302,6 +324,9 @@ public:
 
         bool isAnalysis;
         bool draftMode;
+
+        // True when the other views of the frame are rendered concurrently with the same abortInfo
+        bool viewsRenderedConcurrently;
         RenderStatsPtr stats;
     };
 
@@ -320,6 +345,11 @@ public:
 
     StatusEnum computeRequestPass(unsigned int mipMapLevel, const RectD& canonicalRoI);
 
+    /**
+     * @brief Gives the images holder to the nodes of the tree which are upstream of other writers rendering at the same time
+     **/
+    void setSharedUpstreamImages(const SharedUpstreamImagesPtr& images);
+
     virtual ~ParallelRenderArgsSetter();
 
 private:
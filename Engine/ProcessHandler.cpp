@@ -45,7 +45,8 @@
 NATRON_NAMESPACE_ENTER;
 
 ProcessHandler::ProcessHandler(const QString & projectPath,
-                               const OutputEffectInstancePtr& writer)
+                               const OutputEffectInstancePtr& writer,
+                               const QStringList& extraArgs)
     : _process(new QProcess)
     , _writer(writer)
     , _ipcServer(0)
@@ -92,6 +93,7 @@ ProcessHandler::ProcessHandler(const QString & projectPath,
 
     _processArgs << QString::fromUtf8("-b") << QString::fromUtf8("-w") << QString::fromUtf8( writer->getScriptName_mt_safe().c_str() );
     _processArgs << QString::fromUtf8("--IPCpipe") <<  tmpFileName;
+    _processArgs << extraArgs;
     _processArgs << projectPath;
 
     ///connect the useful slots of the process
@@ -156,47 +158,50 @@ ProcessHandler::onDataWrittenToSocket()
     ///always running in the main thread
     assert( QThread::currentThread() == qApp->thread() );
 
-    QString str = QString::fromUtf8( _bgProcessOutputSocket->readLine() );
-    while ( str.endsWith( QLatin1Char('\n') ) ) {
-        str.chop(1);
-    }
-    _processLog.append( QString::fromUtf8("Message received: ") + str + QLatin1Char('\n') );
-    if ( str.startsWith( QString::fromUtf8(kFrameRenderedStringShort) ) ) {
-        str = str.remove( QString::fromUtf8(kFrameRenderedStringShort) );
-
-        double progressPercent = 0.;
-        int foundProgress = str.lastIndexOf( QString::fromUtf8(kProgressChangedStringShort) );
-        if (foundProgress != -1) {
-            QString progressStr = str.mid(foundProgress);
-            progressStr.remove( QString::fromUtf8(kProgressChangedStringShort) );
-            progressPercent = progressStr.toDouble();
-            str = str.mid(0, foundProgress);
-        }
-        if ( !str.isEmpty() ) {
-            //The report does not have extended timer infos
-            Q_EMIT frameRendered(str.toInt(), progressPercent);
+    // Several messages may have been written since the last notification, e.g: when several frames are rendered in a row
+    while ( _bgProcessOutputSocket->canReadLine() ) {
+        QString str = QString::fromUtf8( _bgProcessOutputSocket->readLine() );
+        while ( str.endsWith( QLatin1Char('\n') ) ) {
+            str.chop(1);
         }
-    } else if ( str.startsWith( QString::fromUtf8(kRenderingFinishedStringShort) ) ) {
-        ///don't do anything
-    } else if ( str.startsWith( QString::fromUtf8(kBgProcessServerCreatedShort) ) ) {
-        str = str.remove( QString::fromUtf8(kBgProcessServerCreatedShort) );
-        ///the bg process wants us to create the pipe for its input
-        if (!_bgProcessInputSocket) {
-            _bgProcessInputSocket = new QLocalSocket();
-            QObject::connect( _bgProcessInputSocket, SIGNAL(connected()), this, SLOT(onInputPipeConnectionMade()) );
-            _bgProcessInputSocket->connectToServer(str, QLocalSocket::ReadWrite);
-        }
-    } else if ( str.startsWith( QString::fromUtf8(kRenderingStartedShort) ) ) {
-        ///if the user pressed cancel prior to the pipe being created, wait for it to be created and send the abort
-        ///message right away
-        if (_earlyCancel) {
-            _bgProcessInputSocket->waitForConnected(5000);
-            _earlyCancel = false;
-            onProcessCanceled();
+        _processLog.append( QString::fromUtf8("Message received: ") + str + QLatin1Char('\n') );
+        if ( str.startsWith( QString::fromUtf8(kFrameRenderedStringShort) ) ) {
+            str = str.remove( QString::fromUtf8(kFrameRenderedStringShort) );
+
+            double progressPercent = 0.;
+            int foundProgress = str.lastIndexOf( QString::fromUtf8(kProgressChangedStringShort) );
+            if (foundProgress != -1) {
+                QString progressStr = str.mid(foundProgress);
+                progressStr.remove( QString::fromUtf8(kProgressChangedStringShort) );
+                progressPercent = progressStr.toDouble();
+                str = str.mid(0, foundProgress);
+            }
+            if ( !str.isEmpty() ) {
+                //The report does not have extended timer infos
+                Q_EMIT frameRendered(str.toInt(), progressPercent);
+            }
+        } else if ( str.startsWith( QString::fromUtf8(kRenderingFinishedStringShort) ) ) {
+            ///don't do anything
+        } else if ( str.startsWith( QString::fromUtf8(kBgProcessServerCreatedShort) ) ) {
+            str = str.remove( QString::fromUtf8(kBgProcessServerCreatedShort) );
+            ///the bg process wants us to create the pipe for its input
+            if (!_bgProcessInputSocket) {
+                _bgProcessInputSocket = new QLocalSocket();
+                QObject::connect( _bgProcessInputSocket, SIGNAL(connected()), this, SLOT(onInputPipeConnectionMade()) );
+                _bgProcessInputSocket->connectToServer(str, QLocalSocket::ReadWrite);
+            }
+        } else if ( str.startsWith( QString::fromUtf8(kRenderingStartedShort) ) ) {
+            ///if the user pressed cancel prior to the pipe being created, wait for it to be created and send the abort
+            ///message right away
+            if (_earlyCancel) {
+                _bgProcessInputSocket->waitForConnected(5000);
+                _earlyCancel = false;
+                onProcessCanceled();
+            }
+        } else {
+            _processLog.append( QString::fromUtf8("Error: Unable to interpret message.\n") );
+            throw std::runtime_error("ProcessHandler::onDataWrittenToSocket() received erroneous message");
         }
-    } else {
-        _processLog.append( QString::fromUtf8("Error: Unable to interpret message.\n") );
-        throw std::runtime_error("ProcessHandler::onDataWrittenToSocket() received erroneous message");
     }
 }
 
@@ -249,6 +254,8 @@ ProcessHandler::onProcessError(QProcess::ProcessError err)
 {
     if (err == QProcess::FailedToStart) {
         Dialogs::errorDialog( _writer->getScriptName(), tr("The render process failed to start.").toStdString() );
+        // finished() is not emitted by QProcess in that case
+        Q_EMIT processFinished(1);
     } else if (err == QProcess::Crashed) {
         //@TODO: find out a way to get the backtrace
     }
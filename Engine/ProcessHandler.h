@@ -102,9 +102,11 @@ public:
     /**
      * @brief Starts a new process which will load the project specified by "projectPath".
      * The process will render using the effect specified by writer.
+     * @param extraArgs Additional command-line arguments given to the process, e.g: a frame range
      **/
     ProcessHandler(const QString & projectPath,
-                   const OutputEffectInstancePtr& writer);
+                   const OutputEffectInstancePtr& writer,
+                   const QStringList& extraArgs = QStringList());
 
     virtual ~ProcessHandler();
 
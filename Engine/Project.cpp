@@ -54,6 +54,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include <QtCore/QTimer>
 #include <QtCore/QThread>
 #include <QtCore/QDir>
+#include <QtCore/QFile>
 #include <QtCore/QTemporaryFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDebug>
@@ -138,6 +139,106 @@ generateUserFriendlyNatronVersionName()
     return ret;
 }
 
+// Number of journal records appended after a checkpoint before the next auto-save writes a new full checkpoint
+#define NATRON_AUTOSAVE_JOURNAL_MAX_RECORDS 50
+
+static QString
+getAutoSaveJournalFilePath(const QString& autoSaveFilePath)
+{
+    return autoSaveFilePath + QString::fromUtf8(NATRON_AUTOSAVE_JOURNAL_SUFFIX);
+}
+
+/**
+ * @brief Returns the node that is serialized in the project for the given node:
+ * nodes within a group are serialized by their top-level group.
+ **/
+static NodePtr
+getTopLevelNode(const NodePtr& node)
+{
+    NodePtr ret = node;
+    for (;;) {
+        NodeGroupPtr isGroup = toNodeGroup( ret->getGroup() );
+        if (!isGroup) {
+            return ret;
+        }
+        ret = isGroup->getNode();
+    }
+}
+
+/**
+ * @brief Replays the journal of the given auto-save onto its checkpoint: each journal record holds the latest
+ * serialization of the nodes that changed. A record that was only partially written (e.g: because of a crash
+ * while auto-saving) is ignored along with the following ones.
+ **/
+static void
+replayAutoSaveJournal(const QString& autoSaveFilePath,
+                      SERIALIZATION_NAMESPACE::ProjectSerialization* checkpoint)
+{
+    QString journalFilePath = getAutoSaveJournalFilePath(autoSaveFilePath);
+    QFileInfo journalInfo(journalFilePath);
+
+    if ( !journalInfo.exists() || ( journalInfo.lastModified() < QFileInfo(autoSaveFilePath).lastModified() ) ) {
+        // No journal or older than the checkpoint
+        return;
+    }
+
+    QFile journalFile(journalFilePath);
+    if ( !journalFile.open(QIODevice::ReadOnly) ) {
+        return;
+    }
+    QByteArray journal = journalFile.readAll();
+    journalFile.close();
+
+    // Each record is preceded by a "--- # <size>" line
+    int pos = 0;
+    int nRecords = 0;
+    while ( pos < journal.size() ) {
+        int endOfLine = journal.indexOf('\n', pos);
+        if (endOfLine == -1) {
+            break;
+        }
+        QByteArray header = journal.mid(pos, endOfLine - pos);
+        if ( !header.startsWith("--- # ") ) {
+            break;
+        }
+        bool ok;
+        int recordSize = header.mid(6).toInt(&ok);
+        if ( !ok || (recordSize < 0) || (endOfLine + 1 + recordSize > journal.size()) ) {
+            break;
+        }
+        std::string record( journal.constData() + endOfLine + 1, recordSize );
+        pos = endOfLine + 1 + recordSize;
+
+        try {
+            YAML::Node recordNode = YAML::Load(record);
+            const YAML::Node& nodesNode = recordNode["Nodes"];
+            for (std::size_t i = 0; i < nodesNode.size(); ++i) {
+                SERIALIZATION_NAMESPACE::NodeSerializationPtr state(new SERIALIZATION_NAMESPACE::NodeSerialization);
+                state->decode(nodesNode[i]);
+
+                bool found = false;
+                for (SERIALIZATION_NAMESPACE::NodeSerializationList::iterator it = checkpoint->_nodes.begin(); it != checkpoint->_nodes.end(); ++it) {
+                    if ( (*it)->_nodeScriptName == state->_nodeScriptName ) {
+                        *it = state;
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found) {
+                    checkpoint->_nodes.push_back(state);
+                }
+            }
+        } catch (const std::exception& e) {
+            qDebug() << "Failed to replay auto-save journal record:" << e.what();
+            break;
+        }
+        ++nRecords;
+    }
+    if (nRecords > 0) {
+        std::cout << QObject::tr("Restored %1 change(s) from the auto-save journal").arg(nRecords).toStdString() << std::endl;
+    }
+} // replayAutoSaveJournal
+
 Project::Project(const AppInstancePtr& appInstance)
     : KnobHolder(appInstance)
     , NodeCollection(appInstance)
@@ -185,6 +286,30 @@ public:
     }
 };
 
+/**
+ * @brief Decodes a binary encoded project from a memory mapping of the file, without reading it all:
+ * the nodes are decoded from the table of contents and their heavy payloads only when the nodes are restored.
+ * The mapping remains valid until the deferred payloads are decoded, see ProjectSerialization::decodeDeferredPayloads()
+ **/
+void
+readMappedBinaryProject(const QString& filePath,
+                        SERIALIZATION_NAMESPACE::ProjectSerialization* obj)
+{
+    boost::shared_ptr<QFile> file( new QFile(filePath) );
+
+    if ( !file->open(QIODevice::ReadOnly) ) {
+        throw std::runtime_error( file->errorString().toStdString() );
+    }
+    const qint64 size = file->size();
+    uchar* data = file->map(0, size);
+    if (!data) {
+        throw std::runtime_error( file->errorString().toStdString() );
+    }
+    // The reader owns the file so that the mapping lives as long as the reader and the deferred payloads referencing it
+    SERIALIZATION_NAMESPACE::BinaryReaderPtr reader( new SERIALIZATION_NAMESPACE::BinaryReader( (const char*)data, (std::size_t)size, file ) );
+    obj->decodeBinary(reader);
+}
+
 NATRON_NAMESPACE_ANONYMOUS_EXIT;
 
 bool
@@ -284,10 +409,12 @@ Project::loadProjectInternal(const QString & pathIn,
 
     bool ret = false;
     FStreamsSupport::ifstream ifile;
-    FStreamsSupport::open( &ifile, filePathOut.toStdString() );
+    // Open in binary mode: the project may be encoded with the binary serialization
+    FStreamsSupport::open( &ifile, filePathOut.toStdString(), std::ios_base::in | std::ios_base::binary );
     if (!ifile) {
         throw std::runtime_error( tr("Failed to open %1").arg(filePathOut).toStdString() );
     }
+    const bool isBinaryProject = SERIALIZATION_NAMESPACE::isBinaryEncoded(ifile);
 
 
     if ( (NATRON_VERSION_MAJOR == 1) && (NATRON_VERSION_MINOR == 0) && (NATRON_VERSION_REVISION == 0) ) {
@@ -315,7 +442,15 @@ Project::loadProjectInternal(const QString & pathIn,
     try {
         // We must keep this boolean for bakcward compatilbility, versinioning cannot help us in that case...
         _imp->lastProjectLoaded.reset(new SERIALIZATION_NAMESPACE::ProjectSerialization);
-        appPTR->loadProjectFromFileFunction(ifile, getApp(), _imp->lastProjectLoaded.get());
+        if (isBinaryProject) {
+            ifile.close();
+            readMappedBinaryProject(filePathOut, _imp->lastProjectLoaded.get());
+        } else {
+            appPTR->loadProjectFromFileFunction(ifile, getApp(), _imp->lastProjectLoaded.get());
+        }
+        if (isAutoSave && !isUntitledAutosave) {
+            replayAutoSaveJournal(filePathIn, _imp->lastProjectLoaded.get());
+        }
 
         {
             FlagSetter __raii_loadingProjectInternal__(true, &_imp->isLoadingProjectInternal, &_imp->isLoadingProjectMutex);
@@ -325,6 +460,10 @@ Project::loadProjectInternal(const QString & pathIn,
         if (!getApp()->isBackground()) {
             getApp()->loadProjectGui(isAutoSave, _imp->lastProjectLoaded);
         }
+
+        // The payloads of the nodes that were not restored (e.g: the plug-in is missing) must be decoded
+        // so that the project file gets unmapped
+        _imp->lastProjectLoaded->decodeDeferredPayloads();
     } catch (...) {
         const SERIALIZATION_NAMESPACE::ProjectBeingLoadedInfo& pInfo = getApp()->getProjectBeingLoadedInfo();
         if (pInfo.vMajor > NATRON_VERSION_MAJOR ||
@@ -443,6 +582,8 @@ Project::saveProject_imp(const QString & path,
         } else {
             qDebug() << "Save failure: " << e.what();
         }
+        QMutexLocker k(&_imp->autoSaveJournalMutex);
+        _imp->autoSaveNeedsCheckpoint = true;
     }
 
     {
@@ -550,6 +691,15 @@ Project::saveProjectInternal(const QString & path,
             _imp->natronVersion->setValue( generateUserFriendlyNatronVersionName() );
         }
 
+        if (updateProjectProperties && !isRenderSave) {
+            // The checkpoint includes every change made so far. A user save removes the last auto-save,
+            // hence the next auto-save must then be a checkpoint.
+            QMutexLocker k(&_imp->autoSaveJournalMutex);
+            _imp->autoSaveDirtyNodes.clear();
+            _imp->autoSaveNeedsCheckpoint = !autoSave;
+            _imp->autoSaveJournalRecords = 0;
+        }
+
         try {
             SERIALIZATION_NAMESPACE::ProjectSerialization projectSerializationObj;
             toSerialization(&projectSerializationObj);
@@ -619,13 +769,117 @@ Project::autoSave()
         return;
     }
 
+    if ( appendAutoSaveJournal() ) {
+        return;
+    }
+
     QString path = QString::fromUtf8( _imp->getProjectPath().c_str() );
     QString name = QString::fromUtf8( _imp->getProjectFilename().c_str() );
     saveProject_imp(path, name, true, true, 0);
 }
 
+bool
+Project::appendAutoSaveJournal()
+{
+    QString checkpointFilePath;
+    {
+        QMutexLocker l(&_imp->projectLock);
+        // Auto-saves of untitled projects are always written entirely
+        if (!_imp->hasProjectBeenSavedByUser) {
+            return false;
+        }
+        checkpointFilePath = _imp->lastAutoSaveFilePath;
+    }
+    if ( checkpointFilePath.isEmpty() || !QFile::exists(checkpointFilePath) ) {
+        return false;
+    }
+
+    {
+        QMutexLocker l(&_imp->isLoadingProjectMutex);
+        if (_imp->isLoadingProject) {
+            return true;
+        }
+    }
+    {
+        QMutexLocker l(&_imp->isSavingProjectMutex);
+        if (_imp->isSavingProject) {
+            return true;
+        }
+        _imp->isSavingProject = true;
+    }
+
+    NodesWList dirtyNodes;
+    bool ok;
+    {
+        QMutexLocker k(&_imp->autoSaveJournalMutex);
+        ok = !_imp->autoSaveNeedsCheckpoint && _imp->autoSaveJournalRecords < NATRON_AUTOSAVE_JOURNAL_MAX_RECORDS;
+        if (ok) {
+            dirtyNodes.swap(_imp->autoSaveDirtyNodes);
+        }
+    }
+
+    if (ok && !dirtyNodes.empty()) {
+        QString journalFilePath = getAutoSaveJournalFilePath(checkpointFilePath);
+        try {
+            YAML::Emitter em;
+            em << YAML::BeginMap;
+            em << YAML::Key << "Nodes" << YAML::Value << YAML::BeginSeq;
+            for (NodesWList::const_iterator it = dirtyNodes.begin(); it != dirtyNodes.end(); ++it) {
+                NodePtr node = it->lock();
+                if ( !node || !node->isActivated() || !node->isPersistent() ) {
+                    continue;
+                }
+                SERIALIZATION_NAMESPACE::NodeSerializationPtr state;
+                StubNodePtr isStub = toStubNode( node->getEffectInstance() );
+                if (isStub) {
+                    state = isStub->getNodeSerialization();
+                    if (!state) {
+                        continue;
+                    }
+                } else {
+                    state.reset(new SERIALIZATION_NAMESPACE::NodeSerialization);
+                    node->toSerialization( state.get() );
+                }
+                state->encode(em);
+            }
+            em << YAML::EndSeq;
+            em << YAML::EndMap;
+
+            FStreamsSupport::ofstream ofile;
+            FStreamsSupport::open( &ofile, journalFilePath.toStdString(), std::ios_base::out | std::ios_base::app | std::ios_base::binary );
+            if (!ofile) {
+                throw std::runtime_error( tr("Failed to open file ").toStdString() + journalFilePath.toStdString() );
+            }
+            ofile << "--- # " << em.size() << '\n';
+            ofile.write( em.c_str(), em.size() );
+            ofile.flush();
+            if (!ofile) {
+                throw std::runtime_error( tr("Failed to write to ").toStdString() + journalFilePath.toStdString() );
+            }
+        } catch (const std::exception & e) {
+            qDebug() << "Auto-save journal failure: " << e.what();
+            ok = false;
+        }
+
+        QMutexLocker k(&_imp->autoSaveJournalMutex);
+        if (ok) {
+            ++_imp->autoSaveJournalRecords;
+        } else {
+            // The journal may be corrupted, write a checkpoint instead
+            _imp->autoSaveNeedsCheckpoint = true;
+        }
+    }
+
+    {
+        QMutexLocker l(&_imp->isSavingProjectMutex);
+        _imp->isSavingProject = false;
+    }
+
+    return ok;
+} // appendAutoSaveJournal
+
 void
-Project::triggerAutoSave()
+Project::triggerAutoSave(const NodePtr& changedNode)
 {
     ///Should only be called in the main-thread, that is upon user interaction.
     assert( QThread::currentThread() == qApp->thread() );
@@ -645,6 +899,25 @@ Project::triggerAutoSave()
         }
     }
 
+    {
+        QMutexLocker k(&_imp->autoSaveJournalMutex);
+        if (!changedNode) {
+            _imp->autoSaveNeedsCheckpoint = true;
+        } else {
+            NodePtr topLevelNode = getTopLevelNode(changedNode);
+            bool found = false;
+            for (NodesWList::const_iterator it = _imp->autoSaveDirtyNodes.begin(); it != _imp->autoSaveDirtyNodes.end(); ++it) {
+                if (it->lock() == topLevelNode) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                _imp->autoSaveDirtyNodes.push_back(topLevelNode);
+            }
+        }
+    }
+
     _imp->autoSaveTimer->start( appPTR->getCurrentSettings()->getAutoSaveDelayMS() );
 }
 
@@ -704,7 +977,8 @@ Project::findAutoSaveForProject(const QString& projectPath,
         QString autosaveSuffix( QString::fromUtf8(".autosave") );
         searchStr.append(autosaveSuffix);
         int suffixPos = entry.indexOf(searchStr);
-        if ( (suffixPos == -1) || entry.contains( QString::fromUtf8("RENDER_SAVE") ) ) {
+        if ( (suffixPos == -1) || entry.contains( QString::fromUtf8("RENDER_SAVE") ) ||
+             entry.endsWith( QString::fromUtf8(NATRON_AUTOSAVE_JOURNAL_SUFFIX) ) ) {
             continue;
         }
         QString filename = projectPath + entry.left( suffixPos + ntpExt.size() );
@@ -1754,6 +2028,7 @@ Project::removeLastAutosave()
 
     if ( !filepath.isEmpty() ) {
         QFile::remove(filepath);
+        QFile::remove( getAutoSaveJournalFilePath(filepath) );
     }
 
     /*
@@ -1767,6 +2042,10 @@ Project::removeLastAutosave()
     if ( QFile::exists(autoSaveFilePath) ) {
         QFile::remove(autoSaveFilePath);
     }
+    QString journalFilePath = getAutoSaveJournalFilePath(autoSaveFilePath);
+    if ( QFile::exists(journalFilePath) ) {
+        QFile::remove(journalFilePath);
+    }
 }
 
 void
@@ -1917,6 +2196,12 @@ Project::doResetEnd(bool aboutToQuit)
             _imp->setProjectFilename(NATRON_PROJECT_UNTITLED);
             _imp->setProjectPath("");
             _imp->autoSaveTimer->stop();
+            {
+                QMutexLocker k(&_imp->autoSaveJournalMutex);
+                _imp->autoSaveDirtyNodes.clear();
+                _imp->autoSaveNeedsCheckpoint = true;
+                _imp->autoSaveJournalRecords = 0;
+            }
             _imp->additionalFormats.clear();
         }
         getApp()->removeAllKeyframesIndicators();
@@ -120,8 +120,11 @@ public:
 
     /**
      * @brief Same as autoSave() but the auto-save is run in a separate thread instead.
+     * @param changedNode If set, the change is local to this node: the next auto-save may then only append
+     * the node to the journal of the last auto-save instead of writing the whole project again.
+     * When not set, the next auto-save writes a full checkpoint of the project.
      **/
-    void triggerAutoSave();
+    void triggerAutoSave(const NodePtr& changedNode = NodePtr());
 
     /**
      * @brief Returns the path to where the auto save files are stored on disk.
@@ -407,6 +410,12 @@ private:
 
     QString saveProjectInternal(const QString & path, const QString & name, bool autosave, bool updateProjectProperties);
 
+    /**
+     * @brief Appends the nodes changed since the last auto-save to the journal of the last checkpoint.
+     * Returns false if a full checkpoint must be written instead.
+     **/
+    bool appendAutoSaveJournal();
+
 
 
     void doResetEnd(bool aboutToQuit);
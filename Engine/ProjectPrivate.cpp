@@ -93,6 +93,11 @@ ProjectPrivate::ProjectPrivate(Project* project)
     , isSavingProjectMutex()
     , isSavingProject(false)
     , autoSaveTimer( new QTimer() )
+    , autoSaveFutures()
+    , autoSaveJournalMutex()
+    , autoSaveDirtyNodes()
+    , autoSaveNeedsCheckpoint(true)
+    , autoSaveJournalRecords(0)
     , projectClosing(false)
     , tlsData( new TLSHolder<Project::ProjectTLSData>() )
 
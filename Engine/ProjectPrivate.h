@@ -105,6 +105,10 @@ public:
     bool isSavingProject; //< true when the project is saving
     boost::shared_ptr<QTimer> autoSaveTimer;
     std::list<boost::shared_ptr<QFutureWatcher<void> > > autoSaveFutures;
+    mutable QMutex autoSaveJournalMutex; //< protects autoSaveDirtyNodes, autoSaveNeedsCheckpoint & autoSaveJournalRecords
+    NodesWList autoSaveDirtyNodes; //< top-level nodes changed since the last auto-save
+    bool autoSaveNeedsCheckpoint; //< true if the next auto-save must write the whole project
+    int autoSaveJournalRecords; //< number of records appended to the journal since the last checkpoint
     mutable QMutex projectClosingMutex;
     bool projectClosing;
     boost::shared_ptr<TLSHolder<Project::ProjectTLSData> > tlsData;
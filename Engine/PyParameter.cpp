@@ -25,7 +25,12 @@
 #include "PyParameter.h"
 
 #include <cassert>
+#include <cmath>
+#include <cstring>
 #include <stdexcept>
+#include <vector>
+
+#include <boost/math/special_functions/fpclassify.hpp>
 
 #include "Engine/AppInstance.h"
 #include "Engine/EffectInstance.h"
@@ -692,6 +697,355 @@ AnimatedParam::setInterpolationAtTime(double time,
     return knob->setInterpolationAtTime(eCurveChangeReasonInternal, ViewSpec::current(), dimension, time, interpolation, &newKey);
 }
 
+namespace {
+template <typename T>
+void
+copyBufferElements(const void* data,
+                   Py_ssize_t n,
+                   std::vector<double>* values)
+{
+    const T* p = (const T*)data;
+
+    values->resize(n);
+    for (Py_ssize_t i = 0; i < n; ++i) {
+        (*values)[i] = (double)p[i];
+    }
+}
+
+/*
+ * Reads a 1-dimensional array of numbers: any object supporting the buffer protocol (numpy arrays,
+ * array.array in Python 3, memoryview...) is read directly, other objects must be sequences of numbers.
+ * On failure a Python exception is set and false is returned.
+ */
+bool
+readNumberArray(PyObject* obj,
+                const char* name,
+                std::vector<double>* values)
+{
+    if ( PyObject_CheckBuffer(obj) ) {
+        Py_buffer view;
+        if (PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+            return false;
+        }
+        const char* format = view.format ? view.format : "B";
+        const int one = 1;
+        const bool littleEndian = *(const char*)&one == 1;
+        if ( (*format == '@') || (*format == '=') || ( (*format == '<') && littleEndian ) || ( (*format == '>') && !littleEndian ) ) {
+            ++format;
+        }
+        bool ok = true;
+        if ( (view.ndim > 1) || (std::strlen(format) != 1) ) {
+            ok = false;
+        } else {
+            Py_ssize_t n = view.len / view.itemsize;
+            switch (*format) {
+            case 'd':
+                copyBufferElements<double>(view.buf, n, values);
+                break;
+            case 'f':
+                copyBufferElements<float>(view.buf, n, values);
+                break;
+            case 'b':
+                copyBufferElements<signed char>(view.buf, n, values);
+                break;
+            case 'B':
+                copyBufferElements<unsigned char>(view.buf, n, values);
+                break;
+            case 'h':
+                copyBufferElements<short>(view.buf, n, values);
+                break;
+            case 'H':
+                copyBufferElements<unsigned short>(view.buf, n, values);
+                break;
+            case 'i':
+                copyBufferElements<int>(view.buf, n, values);
+                break;
+            case 'I':
+                copyBufferElements<unsigned int>(view.buf, n, values);
+                break;
+            case 'l':
+                copyBufferElements<long>(view.buf, n, values);
+                break;
+            case 'L':
+                copyBufferElements<unsigned long>(view.buf, n, values);
+                break;
+            case 'q':
+                copyBufferElements<long long>(view.buf, n, values);
+                break;
+            case 'Q':
+                copyBufferElements<unsigned long long>(view.buf, n, values);
+                break;
+            default:
+                ok = false;
+                break;
+            }
+        }
+        if (!ok) {
+            PyErr_Format(PyExc_TypeError, "%s: expected a 1-dimensional array of numbers, got format '%s'", name, view.format ? view.format : "B");
+        }
+        PyBuffer_Release(&view);
+
+        return ok;
+    }
+
+    PyObject* seq = PySequence_Fast(obj, name);
+    if (!seq) {
+        return false;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    PyObject** items = PySequence_Fast_ITEMS(seq);
+    values->resize(n);
+    for (Py_ssize_t i = 0; i < n; ++i) {
+        (*values)[i] = PyFloat_AsDouble(items[i]);
+        if ( ( (*values)[i] == -1. ) && PyErr_Occurred() ) {
+            Py_DECREF(seq);
+
+            return false;
+        }
+    }
+    Py_DECREF(seq);
+
+    return true;
+}
+
+/*
+ * Returns a new array.array with the given type code holding size bytes of data, or NULL with a Python
+ * exception set on failure.
+ */
+PyObject*
+makeNumberArray(const char* typeCode,
+                const void* data,
+                std::size_t size)
+{
+    PyObject* arrayModule = PyImport_ImportModule("array");
+
+    if (!arrayModule) {
+        return 0;
+    }
+    PyObject* bytes = PyBytes_FromStringAndSize( (const char*)data, (Py_ssize_t)size );
+    PyObject* ret = 0;
+    if (bytes) {
+        ret = PyObject_CallMethod(arrayModule, (char*)"array", (char*)"sO", typeCode, bytes);
+        Py_DECREF(bytes);
+    }
+    Py_DECREF(arrayModule);
+
+    return ret;
+}
+
+bool
+isArrayArgument(PyObject* obj)
+{
+    return obj && obj != Py_None;
+}
+} // anon namespace
+
+bool
+AnimatedParam::setKeyFrames(PyObject* times,
+                            PyObject* values,
+                            PyObject* interpolations,
+                            PyObject* leftDerivatives,
+                            PyObject* rightDerivatives,
+                            int dimension)
+{
+    KnobIPtr knob = getInternalKnob();
+
+    if (!knob) {
+        PyErr_SetString(PyExc_RuntimeError, "setKeyFrames: the parameter no longer exists");
+
+        return false;
+    }
+    if ( (dimension < 0) || ( dimension >= knob->getDimension() ) ) {
+        PyErr_SetString(PyExc_IndexError, "setKeyFrames: invalid dimension");
+
+        return false;
+    }
+    CurvePtr curve = knob->getCurve(ViewSpec::current(), dimension);
+    if ( !curve || !knob->canAnimate() ) {
+        PyErr_SetString(PyExc_ValueError, "setKeyFrames: the parameter cannot be animated");
+
+        return false;
+    }
+
+    std::vector<double> keyTimes, keyValues, keyInterpolations, keyLeftDerivatives, keyRightDerivatives;
+    if ( !readNumberArray(times, "times", &keyTimes) || !readNumberArray(values, "values", &keyValues) ) {
+        return false;
+    }
+    const bool hasInterpolations = isArrayArgument(interpolations);
+    const bool hasDerivatives = isArrayArgument(leftDerivatives) || isArrayArgument(rightDerivatives);
+    if ( hasInterpolations && !readNumberArray(interpolations, "interpolations", &keyInterpolations) ) {
+        return false;
+    }
+    if ( isArrayArgument(leftDerivatives) && !readNumberArray(leftDerivatives, "leftDerivatives", &keyLeftDerivatives) ) {
+        return false;
+    }
+    if ( isArrayArgument(rightDerivatives) && !readNumberArray(rightDerivatives, "rightDerivatives", &keyRightDerivatives) ) {
+        return false;
+    }
+    // A single derivative array sets both derivatives
+    if ( keyLeftDerivatives.empty() ) {
+        keyLeftDerivatives = keyRightDerivatives;
+    } else if ( keyRightDerivatives.empty() ) {
+        keyRightDerivatives = keyLeftDerivatives;
+    }
+    const std::size_t nKeys = keyTimes.size();
+    if ( (keyValues.size() != nKeys) || ( hasInterpolations && (keyInterpolations.size() != nKeys) ) ||
+         ( hasDerivatives && ( (keyLeftDerivatives.size() != nKeys) || (keyRightDerivatives.size() != nKeys) ) ) ) {
+        PyErr_SetString(PyExc_ValueError, "setKeyFrames: all arrays must have the same length");
+
+        return false;
+    }
+
+    // Keys set by setValueAtTime are Smooth, keys with explicit derivatives are Free unless told otherwise
+    const KeyframeTypeEnum defaultInterpolation = hasDerivatives ? eKeyframeTypeFree : eKeyframeTypeSmooth;
+    const bool clampToIntegers = curve->areKeyFramesValuesClampedToIntegers();
+    const bool clampToBooleans = curve->areKeyFramesValuesClampedToBooleans();
+    KeyFrameSet keys = curve->getKeyFrames_mt_safe();
+    for (std::size_t i = 0; i < nKeys; ++i) {
+        double value = keyValues[i];
+        if ( (keyTimes[i] != keyTimes[i]) || boost::math::isinf(keyTimes[i]) || (value != value) || boost::math::isinf(value) ) { // check for NaN or infinity
+            PyErr_Format(PyExc_ValueError, "setKeyFrames: keyframe %d is not finite", (int)i);
+
+            return false;
+        }
+        if (clampToIntegers) {
+            value = std::floor(value + 0.5);
+        } else if (clampToBooleans) {
+            value = (bool)value;
+        }
+        KeyframeTypeEnum interpolation = defaultInterpolation;
+        if (hasInterpolations) {
+            int type = (int)keyInterpolations[i];
+            if ( (type < eKeyframeTypeConstant) || (type >= eKeyframeTypeNone) ) {
+                PyErr_Format(PyExc_ValueError, "setKeyFrames: invalid interpolation for keyframe %d", (int)i);
+
+                return false;
+            }
+            interpolation = (KeyframeTypeEnum)type;
+        }
+        KeyFrame k(keyTimes[i], value, hasDerivatives ? keyLeftDerivatives[i] : 0., hasDerivatives ? keyRightDerivatives[i] : 0., interpolation);
+        std::pair<KeyFrameSet::iterator, bool> ret = keys.insert(k);
+        if (!ret.second) {
+            keys.erase(ret.first);
+            keys.insert(k);
+        }
+    }
+
+    // Compute the automatic derivatives on a copy of the curve so the parameter is evaluated once when cloning it
+    Curve newCurve(*curve);
+    newCurve.setKeyframes(keys, true);
+    knob->cloneCurve(ViewSpec::all(), dimension, newCurve);
+
+    return true;
+}
+
+PyObject*
+AnimatedParam::getKeyFrames(int dimension) const
+{
+    KnobIPtr knob = getInternalKnob();
+
+    if (!knob) {
+        PyErr_SetString(PyExc_RuntimeError, "getKeyFrames: the parameter no longer exists");
+
+        return 0;
+    }
+    if ( (dimension < 0) || ( dimension >= knob->getDimension() ) ) {
+        PyErr_SetString(PyExc_IndexError, "getKeyFrames: invalid dimension");
+
+        return 0;
+    }
+    KeyFrameSet keys;
+    CurvePtr curve = knob->getCurve(ViewSpec::current(), dimension);
+    if (curve) {
+        keys = curve->getKeyFrames_mt_safe();
+    }
+    std::vector<double> keyTimes, keyValues, keyLeftDerivatives, keyRightDerivatives;
+    std::vector<int> keyInterpolations;
+    keyTimes.reserve( keys.size() );
+    keyValues.reserve( keys.size() );
+    keyInterpolations.reserve( keys.size() );
+    keyLeftDerivatives.reserve( keys.size() );
+    keyRightDerivatives.reserve( keys.size() );
+    for (KeyFrameSet::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+        keyTimes.push_back( it->getTime() );
+        keyValues.push_back( it->getValue() );
+        keyInterpolations.push_back( (int)it->getInterpolation() );
+        keyLeftDerivatives.push_back( it->getLeftDerivative() );
+        keyRightDerivatives.push_back( it->getRightDerivative() );
+    }
+
+    PyObject* ret = PyTuple_New(5);
+    if (!ret) {
+        return 0;
+    }
+    const std::size_t n = keys.size();
+    PyObject* arrays[5] = {
+        makeNumberArray("d", n ? &keyTimes[0] : 0, n * sizeof(double)),
+        makeNumberArray("d", n ? &keyValues[0] : 0, n * sizeof(double)),
+        makeNumberArray("i", n ? &keyInterpolations[0] : 0, n * sizeof(int)),
+        makeNumberArray("d", n ? &keyLeftDerivatives[0] : 0, n * sizeof(double)),
+        makeNumberArray("d", n ? &keyRightDerivatives[0] : 0, n * sizeof(double))
+    };
+    bool ok = true;
+    for (int i = 0; i < 5; ++i) {
+        if (!arrays[i]) {
+            ok = false;
+            arrays[i] = Py_None;
+            Py_INCREF(Py_None);
+        }
+        PyTuple_SET_ITEM(ret, i, arrays[i]);
+    }
+    if (!ok) {
+        Py_DECREF(ret);
+
+        return 0;
+    }
+
+    return ret;
+}
+
+PyObject*
+AnimatedParam::getValuesInRange(double first,
+                                double last,
+                                double increment,
+                                int dimension) const
+{
+    KnobIPtr knob = getInternalKnob();
+
+    if (!knob) {
+        PyErr_SetString(PyExc_RuntimeError, "getValuesInRange: the parameter no longer exists");
+
+        return 0;
+    }
+    if ( (dimension < 0) || ( dimension >= knob->getDimension() ) ) {
+        PyErr_SetString(PyExc_IndexError, "getValuesInRange: invalid dimension");
+
+        return 0;
+    }
+    if ( (increment <= 0.) || (last < first) ) {
+        PyErr_SetString(PyExc_ValueError, "getValuesInRange: invalid range");
+
+        return 0;
+    }
+
+    std::vector<double> samples( (std::size_t)std::floor( (last - first) / increment + 1e-9 ) + 1 );
+    CurvePtr curve = knob->getCurve(ViewSpec::current(), dimension, true);
+    if ( !knob->getExpression(dimension).empty() || !curve || !curve->isAnimated() ) {
+        // The expression is evaluated at each sample, this also handles non animated parameters
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            samples[i] = knob->getValueAtWithExpression(first + i * increment, ViewSpec::current(), dimension);
+        }
+    } else {
+        const bool clampToIntegers = curve->areKeyFramesValuesClampedToIntegers();
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            double v = curve->getValueAt(first + i * increment, false);
+            samples[i] = clampToIntegers ? std::floor(v + 0.5) : v;
+        }
+    }
+
+    return makeNumberArray( "d", &samples[0], samples.size() * sizeof(double) );
+}
+
 void
 Param::_addAsDependencyOf(int fromExprDimension,
                           Param* param,
@@ -303,6 +303,27 @@ public:
     QString getExpression(int dimension, bool* hasRetVariable) const;
 
     bool setInterpolationAtTime(double time, NATRON_NAMESPACE::KeyframeTypeEnum interpolation, int dimension = 0);
+
+    /**
+     * @brief Adds keyframes in bulk to the animation curve of the given dimension. All arrays are 1-dimensional arrays
+     * of the same length: any object supporting the buffer protocol (numpy arrays, array.array...) or a sequence of numbers.
+     * interpolations, leftDerivatives and rightDerivatives may be None. Keyframes existing at the given times are replaced.
+     * The curve is changed at once and the parameter is evaluated only once.
+     * On failure a Python exception is set and false is returned.
+     **/
+    bool setKeyFrames(PyObject* times, PyObject* values, PyObject* interpolations = 0, PyObject* leftDerivatives = 0, PyObject* rightDerivatives = 0, int dimension = 0);
+
+    /**
+     * @brief Returns a tuple of array.array (times, values, interpolations, leftDerivatives, rightDerivatives)
+     * with all the keyframes of the given dimension.
+     **/
+    PyObject* getKeyFrames(int dimension = 0) const;
+
+    /**
+     * @brief Returns an array.array of doubles with the values of the given dimension sampled from first to last (included)
+     * every increment frames.
+     **/
+    PyObject* getValuesInRange(double first, double last, double increment = 1., int dimension = 0) const;
 };
 
 /**
@@ -0,0 +1,264 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "PythonCallback.h"
+
+#include <vector>
+
+#include "Engine/AppManager.h"
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/**
+ * @brief Returns the names of the arguments of the function, like inspect.getargspec() does, without running any script.
+ **/
+bool
+getFunctionArguments(PyObject* function,
+                     std::vector<std::string>* args,
+                     std::string* error)
+{
+    // Methods forward the attribute to their function
+    PyObject* code = PyObject_GetAttrString(function, "__code__"); // new ref
+
+    if (!code) {
+        PyErr_Clear();
+        error->append("The callback is not a Python function.");
+
+        return false;
+    }
+
+    PyObject* argCountObj = PyObject_GetAttrString(code, "co_argcount"); // new ref
+    PyObject* flagsObj = PyObject_GetAttrString(code, "co_flags"); // new ref
+    PyObject* varNamesObj = PyObject_GetAttrString(code, "co_varnames"); // new ref
+    Py_DECREF(code);
+
+    bool ok = argCountObj && flagsObj && varNamesObj && PyTuple_Check(varNamesObj);
+    if (ok) {
+        long flags = PyLong_AsLong(flagsObj);
+        if ( flags & (CO_VARARGS | CO_VARKEYWORDS) ) {
+            error->append("Function contains variadic arguments which is unsupported.");
+            ok = false;
+        } else {
+            Py_ssize_t nArgs = (Py_ssize_t)PyLong_AsLong(argCountObj);
+            for (Py_ssize_t i = 0; i < nArgs && i < PyTuple_Size(varNamesObj); ++i) {
+                args->push_back( NATRON_PYTHON_NAMESPACE::PyStringToStdString( PyTuple_GetItem(varNamesObj, i) ) );
+            }
+        }
+    } else {
+        PyErr_Clear();
+        error->append("Could not get the arguments of the callback.");
+    }
+    Py_XDECREF(argCountObj);
+    Py_XDECREF(flagsObj);
+    Py_XDECREF(varNamesObj);
+
+    return ok;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
+struct PythonCallbackPrivate
+{
+    std::string callbackLabel;
+    std::string signature;
+    std::vector<std::string> signatureArgs;
+
+    std::string functionName;
+
+    // New reference on the function, or NULL if not set. Holding it also ensures another object cannot get its address
+    // if the function is redefined.
+    PyObject* function;
+
+    PythonCallbackPrivate(const std::string& callbackLabel,
+                          const std::string& signature)
+        : callbackLabel(callbackLabel)
+        , signature(signature)
+        , signatureArgs()
+        , functionName()
+        , function(0)
+    {
+        // Split "frame, thisNode, app"
+        std::string arg;
+        for (std::size_t i = 0; i <= signature.size(); ++i) {
+            if ( (i == signature.size()) || (signature[i] == ',') ) {
+                if ( !arg.empty() ) {
+                    signatureArgs.push_back(arg);
+                }
+                arg.clear();
+            } else if (signature[i] != ' ') {
+                arg.push_back(signature[i]);
+            }
+        }
+    }
+
+    void releaseFunction()
+    {
+        if (function) {
+            PythonGILLocker pgl;
+            Py_DECREF(function);
+            function = 0;
+        }
+        functionName.clear();
+    }
+};
+
+PythonCallback::PythonCallback(const std::string& callbackLabel,
+                               const std::string& signature)
+    : _imp( new PythonCallbackPrivate(callbackLabel, signature) )
+{
+}
+
+PythonCallback::~PythonCallback()
+{
+    // Python may already be finalized when the application quits
+    if ( Py_IsInitialized() ) {
+        _imp->releaseFunction();
+    }
+}
+
+bool
+PythonCallback::setFunction(const std::string& functionName,
+                            std::string* error)
+{
+#ifdef NATRON_RUN_WITHOUT_PYTHON
+
+    return false;
+#endif
+    PythonGILLocker pgl;
+    PyObject* function = getVariable(functionName);
+
+    if (!function) {
+        _imp->releaseFunction();
+        error->append(functionName + " does not seem to be defined");
+
+        return false;
+    }
+
+    if ( (function == _imp->function) && (functionName == _imp->functionName) ) {
+        // Already validated
+        Py_DECREF(function);
+
+        return true;
+    }
+
+    _imp->releaseFunction();
+
+    std::vector<std::string> args;
+    if ( !getFunctionArguments(function, &args, error) ) {
+        Py_DECREF(function);
+
+        return false;
+    }
+    if (args != _imp->signatureArgs) {
+        error->append("The " + _imp->callbackLabel + " callback supports the following signature(s):\n");
+        error->append("- callback(" + _imp->signature + ")");
+        Py_DECREF(function);
+
+        return false;
+    }
+
+    _imp->function = function;
+    _imp->functionName = functionName;
+
+    return true;
+} // PythonCallback::setFunction
+
+const std::string&
+PythonCallback::getFunctionName() const
+{
+    return _imp->functionName;
+}
+
+const std::string&
+PythonCallback::getCallbackLabel() const
+{
+    return _imp->callbackLabel;
+}
+
+bool
+PythonCallback::call(PyObject* args,
+                     std::string* error,
+                     std::string* output)
+{
+    if (!_imp->function) {
+        error->append("The " + _imp->callbackLabel + " callback is not set");
+
+        return false;
+    }
+
+    return NATRON_PYTHON_NAMESPACE::callPythonFunction(_imp->function, args, _imp->functionName, error, output);
+}
+
+void
+PythonCallback::invalidate()
+{
+    _imp->releaseFunction();
+}
+
+PyObject*
+PythonCallback::getVariable(const std::string& fullyQualifiedName)
+{
+#ifdef NATRON_RUN_WITHOUT_PYTHON
+
+    return 0;
+#endif
+    PythonGILLocker pgl;
+    PyObject* obj = NATRON_PYTHON_NAMESPACE::getMainModule();
+
+    Py_XINCREF(obj);
+    std::size_t start = 0;
+    while (obj) {
+        std::size_t foundDot = fullyQualifiedName.find('.', start);
+        std::string attrName = fullyQualifiedName.substr(start, foundDot == std::string::npos ? std::string::npos : foundDot - start);
+        PyObject* attr = attrName.empty() ? 0 : PyObject_GetAttrString( obj, attrName.c_str() ); // new ref
+        Py_DECREF(obj);
+        obj = attr;
+        if (foundDot == std::string::npos) {
+            break;
+        }
+        start = foundDot + 1;
+    }
+    if (!obj) {
+        PyErr_Clear();
+    }
+
+    return obj;
+}
+
+PyObject*
+PythonCallback::makeIntArgument(int value)
+{
+#if PY_MAJOR_VERSION >= 3
+
+    return PyLong_FromLong(value);
+#else
+
+    return PyInt_FromLong(value);
+#endif
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,101 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_PYTHONCALLBACK_H
+#define NATRON_ENGINE_PYTHONCALLBACK_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <string>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief A Python callback set by the user, e.g: the after frame render callback of a Write node.
+ * The function is looked up once and its signature validated when it is set, then it is called directly with a tuple of arguments
+ * instead of building and interpreting a script for each call.
+ *
+ * setFunction() may be called before each call: if the function name did not change and the function was not redefined
+ * since, it only costs an attribute lookup. A redefined function (e.g: the script defining it was run again) is validated again.
+ **/
+struct PythonCallbackPrivate;
+class PythonCallback
+{
+public:
+
+    /**
+     * @param callbackLabel The name of the callback in the error messages, e.g: "after frame render"
+     * @param signature The names of the arguments the function must take, e.g: "frame, thisNode, app"
+     **/
+    PythonCallback(const std::string& callbackLabel, const std::string& signature);
+
+    ~PythonCallback();
+
+    /**
+     * @brief Looks up the function with the given name, e.g: "myModule.myCallback", in the __main__ module and checks
+     * that it takes the arguments of the signature.
+     * Returns false and sets error if it is not defined or does not have the expected signature: the callback is then invalidated.
+     **/
+    bool setFunction(const std::string& functionName, std::string* error);
+
+    const std::string& getFunctionName() const;
+
+    const std::string& getCallbackLabel() const;
+
+    /**
+     * @brief Calls the function set by setFunction() with the given tuple of arguments, in the order of the signature.
+     * @see NATRON_PYTHON_NAMESPACE::callPythonFunction for error and output.
+     **/
+    bool call(PyObject* args, std::string* error, std::string* output);
+
+    /**
+     * @brief Releases the function, e.g: when the callback is removed.
+     **/
+    void invalidate();
+
+    /**
+     * @brief Returns a new reference on the Python object with the given fully qualified name, e.g: "app1.Write1",
+     * or NULL if it is not defined.
+     **/
+    static PyObject* getVariable(const std::string& fullyQualifiedName);
+
+    /**
+     * @brief Returns a new reference on a Python int, e.g: for the frame argument of a callback
+     **/
+    static PyObject* makeIntArgument(int value);
+
+private:
+
+    boost::scoped_ptr<PythonCallbackPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_PYTHONCALLBACK_H
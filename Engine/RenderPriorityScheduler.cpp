@@ -0,0 +1,230 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "RenderPriorityScheduler.h"
+
+#include <algorithm> // min, max
+#include <cassert>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+
+#include "Engine/AbortableRenderInfo.h"
+#include "Engine/AppManager.h"
+#include "Engine/Timer.h"
+
+NATRON_NAMESPACE_ENTER;
+
+struct RenderPrioritySchedulerPrivate
+{
+    // Number of frame renders and of tiles rendering for each class. They are atomic so that
+    // the common case, where no more urgent render is ongoing, does not take the lock.
+    QAtomicInt activeRenders[eRenderPriorityCount];
+    QAtomicInt activeTiles[eRenderPriorityCount];
+
+    // Protects maxTiles and is used with renderFinishedCond to wake-up the yielding renders
+    mutable QMutex lock;
+    QWaitCondition renderFinishedCond;
+
+    // User defined bound on the tiles of each class, 0 meaning the default bound
+    int maxTiles[eRenderPriorityCount];
+
+    RenderPrioritySchedulerPrivate()
+        : lock()
+        , renderFinishedCond()
+    {
+        for (int i = 0; i < eRenderPriorityCount; ++i) {
+            activeRenders[i] = 0;
+            activeTiles[i] = 0;
+            maxTiles[i] = 0;
+        }
+    }
+
+    bool hasMoreUrgentRender(RenderPriorityEnum priority) const
+    {
+        for (int i = 0; i < (int)priority; ++i) {
+            if ( (int)activeRenders[i] > 0 ) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static int getDefaultMaxTiles(RenderPriorityEnum priority)
+    {
+        int maxThreads = std::max(1, QThreadPool::globalInstance()->maxThreadCount() );
+
+        switch (priority) {
+        case eRenderPriorityInteractive:
+        case eRenderPriorityPlayback:
+        case eRenderPriorityCount:
+
+            return maxThreads;
+        case eRenderPriorityAnalysis:
+
+            return std::max(1, maxThreads / 2);
+        case eRenderPriorityBackground:
+        case eRenderPriorityPrefetch:
+            // Leave a thread to the viewer in GUI mode
+            if ( appPTR && !appPTR->isBackground() ) {
+                return std::max(1, maxThreads - 1);
+            }
+
+            return maxThreads;
+        case eRenderPriorityPreview:
+
+            return 1;
+        }
+
+        return maxThreads;
+    }
+};
+
+RenderPriorityScheduler::RenderPriorityScheduler()
+    : _imp( new RenderPrioritySchedulerPrivate() )
+{
+}
+
+RenderPriorityScheduler::~RenderPriorityScheduler()
+{
+}
+
+void
+RenderPriorityScheduler::setMaxConcurrentTiles(RenderPriorityEnum priority,
+                                               int maxTiles)
+{
+    assert(priority >= 0 && priority < eRenderPriorityCount);
+    QMutexLocker k(&_imp->lock);
+    _imp->maxTiles[priority] = std::max(0, maxTiles);
+}
+
+int
+RenderPriorityScheduler::getMaxConcurrentTiles(RenderPriorityEnum priority) const
+{
+    assert(priority >= 0 && priority < eRenderPriorityCount);
+    {
+        QMutexLocker k(&_imp->lock);
+        if (_imp->maxTiles[priority] > 0) {
+            return _imp->maxTiles[priority];
+        }
+    }
+
+    return RenderPrioritySchedulerPrivate::getDefaultMaxTiles(priority);
+}
+
+void
+RenderPriorityScheduler::registerRender(RenderPriorityEnum priority)
+{
+    assert(priority >= 0 && priority < eRenderPriorityCount);
+    _imp->activeRenders[priority].fetchAndAddOrdered(1);
+}
+
+void
+RenderPriorityScheduler::unregisterRender(RenderPriorityEnum priority)
+{
+    assert(priority >= 0 && priority < eRenderPriorityCount);
+    int prev = _imp->activeRenders[priority].fetchAndAddOrdered(-1);
+    assert(prev > 0);
+    Q_UNUSED(prev);
+
+    // Wake-up the less urgent renders that yielded to this one
+    QMutexLocker k(&_imp->lock);
+    _imp->renderFinishedCond.wakeAll();
+}
+
+int
+RenderPriorityScheduler::getActiveRendersCount(RenderPriorityEnum priority) const
+{
+    assert(priority >= 0 && priority < eRenderPriorityCount);
+
+    return (int)_imp->activeRenders[priority];
+}
+
+void
+RenderPriorityScheduler::beginTile(RenderPriorityEnum priority)
+{
+    assert(priority >= 0 && priority < eRenderPriorityCount);
+    _imp->activeTiles[priority].fetchAndAddOrdered(1);
+}
+
+void
+RenderPriorityScheduler::endTile(RenderPriorityEnum priority)
+{
+    assert(priority >= 0 && priority < eRenderPriorityCount);
+    _imp->activeTiles[priority].fetchAndAddOrdered(-1);
+}
+
+int
+RenderPriorityScheduler::getActiveTilesCount(RenderPriorityEnum priority) const
+{
+    assert(priority >= 0 && priority < eRenderPriorityCount);
+
+    return (int)_imp->activeTiles[priority];
+}
+
+bool
+RenderPriorityScheduler::canRenderTilesInParallel(RenderPriorityEnum priority) const
+{
+    // The bound is only checked when a render decides to spread its tiles: the tiles already dispatched
+    // in the thread pool are never blocked, which could dead-lock renders waiting on their inputs.
+    return getActiveTilesCount(priority) < getMaxConcurrentTiles(priority);
+}
+
+int
+RenderPriorityScheduler::yieldToMoreUrgentRenders(RenderPriorityEnum priority,
+                                                  const AbortableRenderInfoPtr& abortInfo)
+{
+    assert(priority >= 0 && priority < eRenderPriorityCount);
+    if ( !_imp->hasMoreUrgentRender(priority) ) {
+        return 0;
+    }
+    // A more urgent render may be waiting on the images this render is producing: yielding would only delay it more
+    if ( abortInfo && abortInfo->hasImagesBeingRendered() ) {
+        return 0;
+    }
+
+    TimeLapse timer;
+
+    // While this thread sleeps, let the thread pool start another thread for the more urgent render
+    QThreadPool::globalInstance()->releaseThread();
+    {
+        QMutexLocker k(&_imp->lock);
+        while ( _imp->hasMoreUrgentRender(priority) && ( !abortInfo || ( !abortInfo->isAborted() && !abortInfo->hasImagesBeingRendered() ) ) ) {
+            int elapsedMS = (int)(timer.getTimeSinceCreation() * 1000.);
+            if (elapsedMS >= NATRON_RENDER_PREEMPTION_MAX_WAIT_MS) {
+                break;
+            }
+            // Poll so that an abort is noticed even if no render finishes
+            _imp->renderFinishedCond.wait( &_imp->lock, std::min(NATRON_RENDER_PREEMPTION_POLL_MS, NATRON_RENDER_PREEMPTION_MAX_WAIT_MS - elapsedMS) );
+        }
+    }
+    QThreadPool::globalInstance()->reserveThread();
+
+    return std::max( 1, (int)(timer.getTimeSinceCreation() * 1000.) );
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,168 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_RenderPriorityScheduler_h
+#define Engine_RenderPriorityScheduler_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Global/Enums.h"
+#include "Engine/EngineFwd.h"
+
+// A render yielding to more urgent renders checks again whether it may continue at least this often
+#define NATRON_RENDER_PREEMPTION_POLL_MS 10
+
+// A render never yields for longer than this at a single tile boundary, so that a render holding a resource
+// that a more urgent render waits for cannot stall it forever
+#define NATRON_RENDER_PREEMPTION_MAX_WAIT_MS 500
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Arbitrates the global thread pool between the renders of different priority classes (see RenderPriorityEnum):
+ * interactive viewer renders, playback, analysis (e.g. tracking), renders on disk, node previews and the speculative
+ * renders of the frames around the playhead.
+ *
+ * All of them share QThreadPool::globalInstance(), which has no notion of priority. On top of it:
+ * - Each frame render registers its priority, taken from its AbortableRenderInfo, for the lifetime of its ParallelRenderArgsSetter.
+ * - A render only spreads its tiles over the thread pool while its class has less tiles rendering than its bound,
+ * otherwise its tiles are rendered in the calling thread. Renders on disk and speculative renders leave one thread to the viewer in GUI mode,
+ * analysis renders use half of the threads and previews a single one.
+ * - Before rendering a tile, a render yields while a render of a more urgent class is ongoing. This is cooperative:
+ * it happens at tile boundaries only and stops as soon as the render is aborted. A render producing images that other
+ * renders may wait on never yields, to avoid priority inversions.
+ *
+ * This class is MT-safe.
+ **/
+struct RenderPrioritySchedulerPrivate;
+class RenderPriorityScheduler
+{
+public:
+
+    RenderPriorityScheduler();
+
+    ~RenderPriorityScheduler();
+
+    /**
+     * @brief Sets the maximum number of tiles of the given class rendering concurrently in the thread pool.
+     * 0 restores the default bound, which depends on the size of the thread pool.
+     **/
+    void setMaxConcurrentTiles(RenderPriorityEnum priority, int maxTiles);
+    int getMaxConcurrentTiles(RenderPriorityEnum priority) const;
+
+    /**
+     * @brief Called when a frame render of the given class starts and finishes
+     **/
+    void registerRender(RenderPriorityEnum priority);
+    void unregisterRender(RenderPriorityEnum priority);
+    int getActiveRendersCount(RenderPriorityEnum priority) const;
+
+    /**
+     * @brief Called before and after rendering a tile of a render of the given class
+     **/
+    void beginTile(RenderPriorityEnum priority);
+    void endTile(RenderPriorityEnum priority);
+    int getActiveTilesCount(RenderPriorityEnum priority) const;
+
+    /**
+     * @brief Returns true if a render of the given class may render its tiles concurrently in the thread pool
+     **/
+    bool canRenderTilesInParallel(RenderPriorityEnum priority) const;
+
+    /**
+     * @brief Blocks while a render of a more urgent class than priority is ongoing, at most NATRON_RENDER_PREEMPTION_MAX_WAIT_MS.
+     * Returns immediately if abortInfo (which may be NULL) gets aborted, or if it has images marked as being rendered
+     * (see AbortableRenderInfo::hasImagesBeingRendered()): the more urgent render may be waiting on them.
+     * @returns The time spent waiting, in milliseconds, at least 1 if this render had to yield
+     **/
+    int yieldToMoreUrgentRenders(RenderPriorityEnum priority, const AbortableRenderInfoPtr& abortInfo);
+
+private:
+
+    boost::scoped_ptr<RenderPrioritySchedulerPrivate> _imp;
+};
+
+/**
+ * @brief Registers a frame render in the scheduler for its lifetime
+ **/
+class RenderPriorityScheduler_RAII
+{
+    RenderPriorityScheduler* _scheduler;
+    RenderPriorityEnum _priority;
+
+public:
+
+    RenderPriorityScheduler_RAII(RenderPriorityScheduler* scheduler,
+                                 RenderPriorityEnum priority)
+        : _scheduler(scheduler)
+        , _priority(priority)
+    {
+        if (_scheduler) {
+            _scheduler->registerRender(_priority);
+        }
+    }
+
+    ~RenderPriorityScheduler_RAII()
+    {
+        if (_scheduler) {
+            _scheduler->unregisterRender(_priority);
+        }
+    }
+};
+
+/**
+ * @brief Counts a tile as rendering in the scheduler for its lifetime
+ **/
+class RenderPrioritySchedulerTile_RAII
+{
+    RenderPriorityScheduler* _scheduler;
+    RenderPriorityEnum _priority;
+
+public:
+
+    RenderPrioritySchedulerTile_RAII(RenderPriorityScheduler* scheduler,
+                                     RenderPriorityEnum priority)
+        : _scheduler(scheduler)
+        , _priority(priority)
+    {
+        if (_scheduler) {
+            _scheduler->beginTile(_priority);
+        }
+    }
+
+    ~RenderPrioritySchedulerTile_RAII()
+    {
+        if (_scheduler) {
+            _scheduler->endTile(_priority);
+        }
+    }
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_RenderPriorityScheduler_h
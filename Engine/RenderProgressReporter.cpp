@@ -0,0 +1,332 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "RenderProgressReporter.h"
+
+#include <cstring> // strcmp
+#include <iostream>
+#include <vector>
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QMutex>
+#include <QtCore/QTextStream>
+#include <QtCore/QWaitCondition>
+CLANG_DIAG_ON(deprecated)
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/AppManager.h"
+#include "Engine/MetricsServer.h"
+#include "Engine/Timer.h"
+
+// Must be a power of 2
+#define NATRON_RENDER_PROGRESS_QUEUE_SIZE 4096
+
+// When updates are not coalesced, the queue is polled at this interval
+#define NATRON_RENDER_PROGRESS_POLL_INTERVAL_MS 50
+
+NATRON_NAMESPACE_ENTER;
+
+namespace {
+struct QueueCell
+{
+    // Position of the cell in the queue, see RenderProgressReporterPrivate::tryPush
+    QAtomicInt sequence;
+    RenderProgressRecord record;
+};
+}
+
+struct RenderProgressReporterPrivate
+{
+    int intervalMS;
+    RenderProgressReporter::OutputFormatEnum format;
+
+    // Bounded multi-producer single-consumer queue: each cell carries a sequence number telling
+    // whether it is free for the producer at that position or filled for the consumer.
+    std::vector<QueueCell> cells;
+    QAtomicInt enqueuePos;
+    int dequeuePos; // only accessed by the reporter thread
+
+    // Records of the current interval, only the latest one of each writer is printed. Only accessed by the reporter thread.
+    std::vector<RenderProgressRecord> pendingRecords;
+
+    // Protects the fields below, never locked by render threads
+    QMutex threadMutex;
+    QWaitCondition mustReportCond;
+    QWaitCondition flushedCond;
+    bool mustQuit;
+    int flushRequestID; // incremented by each call to flush()
+    int flushedID; // the last flush request for which all records were reported
+
+    RenderProgressReporterPrivate(int intervalMS,
+                                  RenderProgressReporter::OutputFormatEnum format)
+        : intervalMS(intervalMS)
+        , format(format)
+        , cells(NATRON_RENDER_PROGRESS_QUEUE_SIZE)
+        , enqueuePos()
+        , dequeuePos(0)
+        , pendingRecords()
+        , threadMutex()
+        , mustReportCond()
+        , flushedCond()
+        , mustQuit(false)
+        , flushRequestID(0)
+        , flushedID(0)
+    {
+        for (int i = 0; i < NATRON_RENDER_PROGRESS_QUEUE_SIZE; ++i) {
+            cells[i].sequence.fetchAndStoreRelease(i);
+        }
+    }
+
+    bool tryPush(const RenderProgressRecord& record);
+
+    bool tryPop(RenderProgressRecord* record);
+
+    // Reports all records in the queue and returns the number of records
+    int drainQueue();
+
+    void printPendingRecords();
+
+    void printRecord(const RenderProgressRecord& record);
+};
+
+RenderProgressReporter::RenderProgressReporter(int intervalMS,
+                                               OutputFormatEnum format)
+    : QThread()
+    , _imp( new RenderProgressReporterPrivate(intervalMS < 0 ? 0 : intervalMS, format) )
+{
+    setObjectName( QString::fromUtf8("RenderProgressReporter") );
+}
+
+RenderProgressReporter::~RenderProgressReporter()
+{
+    quitThread();
+}
+
+bool
+RenderProgressReporterPrivate::tryPush(const RenderProgressRecord& record)
+{
+    const int mask = NATRON_RENDER_PROGRESS_QUEUE_SIZE - 1;
+    int pos = enqueuePos.fetchAndAddAcquire(0);
+
+    for (;;) {
+        QueueCell& cell = cells[pos & mask];
+        int seq = cell.sequence.fetchAndAddAcquire(0);
+        int diff = seq - pos;
+        if (diff == 0) {
+            // The cell is free, claim the position
+            if ( enqueuePos.testAndSetRelaxed(pos, pos + 1) ) {
+                cell.record = record;
+                // Publish the record to the consumer
+                cell.sequence.fetchAndStoreRelease(pos + 1);
+
+                return true;
+            }
+            pos = enqueuePos.fetchAndAddAcquire(0);
+        } else if (diff < 0) {
+            // The consumer did not free that cell yet: the queue is full
+            return false;
+        } else {
+            // Another producer claimed this position
+            pos = enqueuePos.fetchAndAddAcquire(0);
+        }
+    }
+}
+
+bool
+RenderProgressReporterPrivate::tryPop(RenderProgressRecord* record)
+{
+    const int mask = NATRON_RENDER_PROGRESS_QUEUE_SIZE - 1;
+    QueueCell& cell = cells[dequeuePos & mask];
+    int seq = cell.sequence.fetchAndAddAcquire(0);
+
+    if (seq - (dequeuePos + 1) < 0) {
+        // Not published yet
+        return false;
+    }
+    *record = cell.record;
+    // Hand the cell back to the producers for the next lap
+    cell.sequence.fetchAndStoreRelease(dequeuePos + NATRON_RENDER_PROGRESS_QUEUE_SIZE);
+    ++dequeuePos;
+
+    return true;
+}
+
+// Forwards a record to the IPC pipe and to the metrics endpoint, if any
+static void
+forwardRecord(const RenderProgressRecord& record)
+{
+    QString shortMessage = QString::fromUtf8(kFrameRenderedStringShort) + QString::number(record.frame) + QString::fromUtf8(kProgressChangedStringShort) + QString::number(record.progress);
+
+    appPTR->writeToOutputPipe(QString(), shortMessage, false);
+
+    MetricsServer* metrics = appPTR->getMetricsServer();
+    if (metrics) {
+        metrics->onFrameRendered(record);
+    }
+}
+
+void
+RenderProgressReporterPrivate::printRecord(const RenderProgressRecord& record)
+{
+    QString message;
+    QTextStream ts(&message);
+
+    if (format == RenderProgressReporter::eOutputFormatJSON) {
+        QString writerName = QString::fromUtf8(record.writerName);
+        writerName.replace( QLatin1Char('\\'), QString::fromUtf8("\\\\") );
+        writerName.replace( QLatin1Char('"'), QString::fromUtf8("\\\"") );
+        ts << "{\"writer\":\"" << writerName << "\",\"frame\":" << record.frame;
+        ts << ",\"framesRendered\":" << record.nFramesRendered << ",\"framesTotal\":" << record.nFramesTotal;
+        ts << ",\"progress\":" << QString::number(record.progress, 'f', 4) << ",\"fps\":" << QString::number(record.fps, 'f', 2);
+        ts << ",\"timeRemaining\":" << QString::number(record.timeRemaining, 'f', 1) << "}";
+    } else {
+        ts << record.writerName << QCoreApplication::translate("RenderProgressReporter", " ==> Frame: ");
+        ts << record.frame << QCoreApplication::translate("RenderProgressReporter", ", Progress: ") << QString::number(record.progress * 100, 'f', 1) << "%, ";
+        ts << QString::number(record.fps, 'f', 1) << QCoreApplication::translate("RenderProgressReporter", " Fps, Time Remaining: ") << Timer::printAsTime(record.timeRemaining, true);
+    }
+    ts.flush();
+    std::cout << message.toStdString() << std::endl;
+}
+
+void
+RenderProgressReporterPrivate::printPendingRecords()
+{
+    for (std::vector<RenderProgressRecord>::const_iterator it = pendingRecords.begin(); it != pendingRecords.end(); ++it) {
+        printRecord(*it);
+    }
+    pendingRecords.clear();
+}
+
+int
+RenderProgressReporterPrivate::drainQueue()
+{
+    int nRecords = 0;
+    RenderProgressRecord record;
+
+    while ( tryPop(&record) ) {
+        ++nRecords;
+
+        // The process that launched us counts frames: every frame must be sent through the pipe
+        forwardRecord(record);
+
+        if (intervalMS == 0) {
+            printRecord(record);
+            continue;
+        }
+
+        // Only keep the latest update of each writer
+        bool found = false;
+        for (std::vector<RenderProgressRecord>::iterator it = pendingRecords.begin(); it != pendingRecords.end(); ++it) {
+            if (std::strcmp(it->writerName, record.writerName) == 0) {
+                *it = record;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            pendingRecords.push_back(record);
+        }
+    }
+
+    return nRecords;
+}
+
+void
+RenderProgressReporter::postFrameRendered(const RenderProgressRecord& record)
+{
+    if ( isRunning() && _imp->tryPush(record) ) {
+        return;
+    }
+
+    // The reporter is not running or cannot keep up: report synchronously so that no frame is lost for the pipe.
+    // This is the only path that allocates.
+    forwardRecord(record);
+    {
+        QMutexLocker k(&_imp->threadMutex);
+        _imp->printRecord(record);
+    }
+}
+
+void
+RenderProgressReporter::flush()
+{
+    if ( !isRunning() ) {
+        return;
+    }
+    QMutexLocker k(&_imp->threadMutex);
+    int requestID = ++_imp->flushRequestID;
+    _imp->mustReportCond.wakeOne();
+    while (_imp->flushedID < requestID && !_imp->mustQuit) {
+        _imp->flushedCond.wait(&_imp->threadMutex);
+    }
+}
+
+void
+RenderProgressReporter::quitThread()
+{
+    if ( !isRunning() ) {
+        return;
+    }
+    {
+        QMutexLocker k(&_imp->threadMutex);
+        _imp->mustQuit = true;
+        _imp->mustReportCond.wakeOne();
+    }
+    wait();
+}
+
+void
+RenderProgressReporter::run()
+{
+    const unsigned long waitMS = _imp->intervalMS > 0 ? _imp->intervalMS : NATRON_RENDER_PROGRESS_POLL_INTERVAL_MS;
+
+    for (;;) {
+        bool mustQuit;
+        int flushRequestID;
+        {
+            QMutexLocker k(&_imp->threadMutex);
+            if ( !_imp->mustQuit && (_imp->flushedID == _imp->flushRequestID) ) {
+                _imp->mustReportCond.wait(&_imp->threadMutex, waitMS);
+            }
+            mustQuit = _imp->mustQuit;
+            // Records posted before this request are in the queue now
+            flushRequestID = _imp->flushRequestID;
+        }
+
+        _imp->drainQueue();
+
+        QMutexLocker k(&_imp->threadMutex);
+        _imp->printPendingRecords();
+        _imp->flushedID = flushRequestID;
+        _imp->flushedCond.wakeAll();
+        if (mustQuit) {
+            return;
+        }
+    }
+}
+
+NATRON_NAMESPACE_EXIT;
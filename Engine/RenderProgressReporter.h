@@ -0,0 +1,110 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef RENDERPROGRESSREPORTER_H
+#define RENDERPROGRESSREPORTER_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QThread>
+CLANG_DIAG_ON(deprecated)
+
+#include "Engine/EngineFwd.h"
+
+#define NATRON_RENDER_PROGRESS_WRITER_NAME_SIZE 64
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief A frame rendered notification, as posted by the render threads.
+ * This is a plain structure so that posting it does not allocate.
+ **/
+struct RenderProgressRecord
+{
+    char writerName[NATRON_RENDER_PROGRESS_WRITER_NAME_SIZE];
+    int frame;
+    unsigned int nFramesRendered;
+    unsigned int nFramesTotal;
+    double progress; // between 0 and 1
+    double fps;
+    double timeRemaining; // in seconds
+};
+
+/**
+ * @brief Reports the progress of background renders out of the render threads.
+ * Render threads post a RenderProgressRecord to a bounded lock-free queue and return immediately. A single
+ * reporter thread drains the queue: it forwards each frame to the IPC pipe (if the process was launched by another one),
+ * and prints the progress to the standard output. Printed updates may be coalesced to at most one line per writer
+ * and per interval, either human readable or as JSON lines for farm wrappers.
+ **/
+struct RenderProgressReporterPrivate;
+class RenderProgressReporter
+    : public QThread
+{
+public:
+
+    enum OutputFormatEnum
+    {
+        eOutputFormatText = 0,
+        eOutputFormatJSON
+    };
+
+    /**
+     * @param intervalMS If 0, every frame is printed, otherwise only the latest update of each writer is printed every intervalMS
+     **/
+    RenderProgressReporter(int intervalMS, OutputFormatEnum format);
+
+    virtual ~RenderProgressReporter();
+
+    /**
+     * @brief Posts a record. This is lock-free and never allocates, it may be called from any thread.
+     * If the queue is full, the record is reported synchronously by the calling thread instead.
+     **/
+    void postFrameRendered(const RenderProgressRecord& record);
+
+    /**
+     * @brief Blocks until all records posted so far have been reported
+     **/
+    void flush();
+
+    /**
+     * @brief Reports the pending records and stops the reporter thread
+     **/
+    void quitThread();
+
+private:
+
+    virtual void run() OVERRIDE FINAL;
+
+    boost::scoped_ptr<RenderProgressReporterPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // RENDERPROGRESSREPORTER_H
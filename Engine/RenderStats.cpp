@@ -30,6 +30,7 @@
 
 #include <QtCore/QMutex>
 
+#include "Engine/Image.h"
 #include "Engine/Node.h"
 #include "Engine/Timer.h"
 #include "Engine/RectI.h"
@@ -65,6 +66,18 @@ struct NodeRenderStatsPrivate
     int nbCacheHit;
     int nbCacheHitButDownscaledImages;
 
+    //Decoding of the cached images that were stored compressed
+    int nbCacheDecodes;
+    double sumCacheCompressionRatios;
+    double totalTimeSpentDecoding;
+
+    //NaN or infinite values replaced in the output
+    int nbNonFiniteValues;
+
+    //Memory of the images predicted by the request pass and actually used
+    U64 predictedImageMemory;
+    U64 imageMemory;
+
     //Is tile support enabled for this render
     bool tileSupportEnabled;
 
@@ -88,6 +101,12 @@ struct NodeRenderStatsPrivate
         , nbCacheMisses(0)
         , nbCacheHit(0)
         , nbCacheHitButDownscaledImages(0)
+        , nbCacheDecodes(0)
+        , sumCacheCompressionRatios(0)
+        , totalTimeSpentDecoding(0)
+        , nbNonFiniteValues(0)
+        , predictedImageMemory(0)
+        , imageMemory(0)
         , tileSupportEnabled(false)
         , renderScaleSupportEnabled(false)
         , channelsEnabled()
@@ -127,6 +146,12 @@ NodeRenderStats::operator=(const NodeRenderStats& other)
     _imp->nbCacheMisses = other._imp->nbCacheMisses;
     _imp->nbCacheHit = other._imp->nbCacheHit;
     _imp->nbCacheHitButDownscaledImages = other._imp->nbCacheHitButDownscaledImages;
+    _imp->nbCacheDecodes = other._imp->nbCacheDecodes;
+    _imp->sumCacheCompressionRatios = other._imp->sumCacheCompressionRatios;
+    _imp->totalTimeSpentDecoding = other._imp->totalTimeSpentDecoding;
+    _imp->nbNonFiniteValues = other._imp->nbNonFiniteValues;
+    _imp->predictedImageMemory = other._imp->predictedImageMemory;
+    _imp->imageMemory = other._imp->imageMemory;
     _imp->tileSupportEnabled = other._imp->tileSupportEnabled;
     _imp->renderScaleSupportEnabled = other._imp->renderScaleSupportEnabled;
     for (int i = 0; i < 4; ++i) {
@@ -253,6 +278,61 @@ NodeRenderStats::getCacheAccessInfos(int* nbCacheMisses,
     *nbCacheHitButDownscaledImages = _imp->nbCacheHitButDownscaledImages;
 }
 
+void
+NodeRenderStats::addCacheDecodeInfo(double compressionRatio,
+                                    double timeSpent)
+{
+    ++_imp->nbCacheDecodes;
+    _imp->sumCacheCompressionRatios += compressionRatio;
+    _imp->totalTimeSpentDecoding += timeSpent;
+}
+
+void
+NodeRenderStats::getCacheDecodeInfos(int* nbDecodes,
+                                     double* averageCompressionRatio,
+                                     double* totalTimeSpentDecoding) const
+{
+    *nbDecodes = _imp->nbCacheDecodes;
+    *averageCompressionRatio = _imp->nbCacheDecodes > 0 ? _imp->sumCacheCompressionRatios / _imp->nbCacheDecodes : 1.;
+    *totalTimeSpentDecoding = _imp->totalTimeSpentDecoding;
+}
+
+void
+NodeRenderStats::addNonFiniteValues(int nbValues)
+{
+    _imp->nbNonFiniteValues += nbValues;
+}
+
+int
+NodeRenderStats::getNonFiniteValuesCount() const
+{
+    return _imp->nbNonFiniteValues;
+}
+
+void
+NodeRenderStats::addPredictedImageMemory(U64 bytes)
+{
+    _imp->predictedImageMemory += bytes;
+}
+
+U64
+NodeRenderStats::getPredictedImageMemory() const
+{
+    return _imp->predictedImageMemory;
+}
+
+void
+NodeRenderStats::addImageMemory(U64 bytes)
+{
+    _imp->imageMemory += bytes;
+}
+
+U64
+NodeRenderStats::getImageMemory() const
+{
+    return _imp->imageMemory;
+}
+
 void
 NodeRenderStats::setTilesSupported(bool tilesSupported)
 {
@@ -314,12 +394,26 @@ struct RenderStatsPrivate
     typedef std::map<NodeWPtr, NodeRenderStats > NodeInfosMap;
     NodeInfosMap nodeInfos;
 
+    //The first node that reported NaN or infinite values and the total number of values replaced in the frame
+    NodeWPtr firstNodeWithNonFiniteValues;
+    int nbNonFiniteValues;
+
+    //The memory of the images of the frame predicted by the request pass, and of the distinct images actually used.
+    //Weak pointers are ordered by their control block: an image allocated at the address of a freed one is still counted.
+    U64 predictedImagesMemory;
+    U64 imagesMemory;
+    std::set<ImageWPtr> imagesUsed;
 
     RenderStatsPrivate()
         : lock()
         , totalTimeSpentForFrameTimer()
         , doNodesProfiling(false)
         , nodeInfos()
+        , firstNodeWithNonFiniteValues()
+        , nbNonFiniteValues(0)
+        , predictedImagesMemory(0)
+        , imagesMemory(0)
+        , imagesUsed()
     {
     }
 
@@ -414,6 +508,19 @@ RenderStats::addCacheInfosForNode(const NodePtr& node,
     stats.addCacheAccessInfo(isCacheMiss, hasDownscaled);
 }
 
+void
+RenderStats::addCacheDecodeInfosForNode(const NodePtr& node,
+                                        double compressionRatio,
+                                        double timeSpent)
+{
+    QMutexLocker k(&_imp->lock);
+
+    assert(_imp->doNodesProfiling);
+
+    NodeRenderStats& stats = _imp->findOrCreateNodeStats(node);
+    stats.addCacheDecodeInfo(compressionRatio, timeSpent);
+}
+
 void
 RenderStats::addRenderInfosForNode(const NodePtr& node,
                                    const NodePtr& identity,
@@ -435,6 +542,77 @@ RenderStats::addRenderInfosForNode(const NodePtr& node,
     stats.addPlaneRendered(plane);
 }
 
+void
+RenderStats::addNonFiniteValuesForNode(const NodePtr& node,
+                                       int nbValues)
+{
+    QMutexLocker k(&_imp->lock);
+
+    if (_imp->nbNonFiniteValues == 0) {
+        _imp->firstNodeWithNonFiniteValues = node;
+    }
+    _imp->nbNonFiniteValues += nbValues;
+
+    if (_imp->doNodesProfiling) {
+        NodeRenderStats& stats = _imp->findOrCreateNodeStats(node);
+        stats.addNonFiniteValues(nbValues);
+    }
+}
+
+NodePtr
+RenderStats::getFirstNodeWithNonFiniteValues(int* nbValues) const
+{
+    QMutexLocker k(&_imp->lock);
+
+    *nbValues = _imp->nbNonFiniteValues;
+
+    return _imp->firstNodeWithNonFiniteValues.lock();
+}
+
+void
+RenderStats::addPredictedImageMemoryForNode(const NodePtr& node,
+                                            U64 bytes)
+{
+    QMutexLocker k(&_imp->lock);
+
+    _imp->predictedImagesMemory += bytes;
+
+    if (_imp->doNodesProfiling) {
+        NodeRenderStats& stats = _imp->findOrCreateNodeStats(node);
+        stats.addPredictedImageMemory(bytes);
+    }
+}
+
+void
+RenderStats::addImagesMemoryForNode(const NodePtr& node,
+                                    const std::map<ImageComponents, ImagePtr>& images)
+{
+    QMutexLocker k(&_imp->lock);
+
+    for (std::map<ImageComponents, ImagePtr>::const_iterator it = images.begin(); it != images.end(); ++it) {
+        if ( !it->second || !_imp->imagesUsed.insert( ImageWPtr(it->second) ).second ) {
+            continue;
+        }
+        U64 bytes = it->second->dataSize();
+        _imp->imagesMemory += bytes;
+
+        if (_imp->doNodesProfiling) {
+            NodeRenderStats& stats = _imp->findOrCreateNodeStats(node);
+            stats.addImageMemory(bytes);
+        }
+    }
+}
+
+void
+RenderStats::getImagesMemory(U64* predicted,
+                             U64* actual) const
+{
+    QMutexLocker k(&_imp->lock);
+
+    *predicted = _imp->predictedImagesMemory;
+    *actual = _imp->imagesMemory;
+}
+
 std::map<NodePtr, NodeRenderStats >
 RenderStats::getStats(double *totalTimeSpent) const
 {
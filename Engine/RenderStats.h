@@ -41,6 +41,7 @@
 
 #include "Global/GlobalDefines.h"
 
+#include "Engine/ImageComponents.h"
 #include "Engine/RectI.h"
 #include "Engine/RectD.h"
 #include "Engine/EngineFwd.h"
@@ -87,6 +88,28 @@ public:
     void addCacheAccessInfo(bool isCacheMiss, bool hasDownscaled);
     void getCacheAccessInfos(int* nbCacheMisses, int* nbCacheHits, int* nbCacheHitButDownscaledImages) const;
 
+    /**
+     * @brief Called when a cached image that was stored compressed (or as half-float) had to be decoded
+     * @param compressionRatio The size of the decoded image divided by the size it occupied in the cache
+     **/
+    void addCacheDecodeInfo(double compressionRatio, double timeSpent);
+    void getCacheDecodeInfos(int* nbDecodes, double* averageCompressionRatio, double* totalTimeSpentDecoding) const;
+
+    /**
+     * @brief Called when NaN or infinite values were replaced in the output of the node
+     **/
+    void addNonFiniteValues(int nbValues);
+    int getNonFiniteValuesCount() const;
+
+    /**
+     * @brief The memory of the images of the node predicted from the request pass, and the memory of the images it actually used
+     **/
+    void addPredictedImageMemory(U64 bytes);
+    U64 getPredictedImageMemory() const;
+
+    void addImageMemory(U64 bytes);
+    U64 getImageMemory() const;
+
     void setTilesSupported(bool tilesSupported);
     bool isTilesSupportEnabled() const;
 
@@ -136,12 +159,48 @@ public:
                               bool isCacheMiss,
                               bool hasDownscaled);
 
+    void addCacheDecodeInfosForNode(const NodePtr& node,
+                                    double compressionRatio,
+                                    double timeSpent);
+
     void addRenderInfosForNode(const NodePtr& node,
                                const NodePtr& identity,
                                const std::string& plane,
                                const RectI& rectangle,
                                double timeSpent);
 
+    /**
+     * @brief Called when nbValues NaN or infinite values were replaced in the output of the node.
+     * Unlike the other infos, this is recorded even if in-depth profiling is disabled so that the node producing them
+     * can be reported with the frame.
+     **/
+    void addNonFiniteValuesForNode(const NodePtr& node, int nbValues);
+
+    /**
+     * @brief Returns the first node of the frame whose output contained NaN or infinite values (upstream nodes
+     * finish rendering before their outputs) or NULL if there was none. The total number of values replaced
+     * in the frame is returned in nbValues.
+     **/
+    NodePtr getFirstNodeWithNonFiniteValues(int* nbValues) const;
+
+    /**
+     * @brief Called once the request pass of the frame is done with the memory predicted for the images of the node,
+     * see ParallelRenderArgsSetter::computeRequestPass()
+     **/
+    void addPredictedImageMemoryForNode(const NodePtr& node, U64 bytes);
+
+    /**
+     * @brief Called each time the node returns images from renderRoI(). Each image is counted once for the frame.
+     * Their total is the memory the frame needed for its images, to compare with the prediction of the request pass.
+     * Like the non-finite values, the totals of the frame are recorded even if in-depth profiling is disabled.
+     **/
+    void addImagesMemoryForNode(const NodePtr& node, const std::map<ImageComponents, ImagePtr>& images);
+
+    /**
+     * @brief Returns the memory predicted for the images of the frame and the memory they actually used
+     **/
+    void getImagesMemory(U64* predicted, U64* actual) const;
+
     std::map<NodePtr, NodeRenderStats > getStats(double *totalTimeSpent) const;
 
 private:
@@ -95,7 +95,7 @@ void
 RotoPaintInteract::autoSaveAndRedraw()
 {
     p->publicInterface->redrawOverlayInteract();
-    p->publicInterface->getApp()->triggerAutoSave();
+    p->publicInterface->getApp()->triggerAutoSave( p->publicInterface->getNode() );
 }
 
 void
@@ -386,9 +386,10 @@ Settings::initializeKnobsRendering()
 
     _convertNaNValues = AppManager::createKnob<KnobBool>( shared_from_this(), tr("Convert NaN values") );
     _convertNaNValues->setName("convertNaNs");
-    _convertNaNValues->setHintToolTip( tr("When activated, any pixel that is a Not-a-Number will be converted to 1 to avoid potential crashes from "
-                                          "downstream nodes. These values can be produced by faulty plug-ins when they use wrong arithmetic such as "
-                                          "division by zero. Disabling this option will keep the NaN(s) in the buffers: this may lead to an "
+    _convertNaNValues->setHintToolTip( tr("When activated, any pixel that is a Not-a-Number will be converted to 1 and any infinite value clamped to the "
+                                          "largest finite value to avoid potential crashes from downstream nodes. These values can be produced by faulty "
+                                          "plug-ins when they use wrong arithmetic such as division by zero. The first node that produced them in a frame "
+                                          "is reported in the Script Editor. Disabling this option will keep the NaN(s) in the buffers: this may lead to an "
                                           "undefined behavior.") );
     _renderingPage->addKnob(_convertNaNValues);
 
@@ -418,6 +419,24 @@ Settings::initializeKnobsRendering()
                                                                "transformations.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
     _activateTransformConcatenationSupport->setName("transformCatSupport");
     _renderingPage->addKnob(_activateTransformConcatenationSupport);
+
+    _mipMapFilter = AppManager::createKnob<KnobChoice>( shared_from_this(), tr("Downscale filter") );
+    _mipMapFilter->setName("mipMapFilter");
+    {
+        std::vector<std::string> entries;
+        std::vector<std::string> helps;
+        assert(entries.size() == (int)eMipMapFilterBox);
+        entries.push_back("Box");
+        helps.push_back( tr("Each pixel is the average of the 2x2 pixels it covers at the previous scale. This is the fastest.").toStdString() );
+        assert(entries.size() == (int)eMipMapFilterTent);
+        entries.push_back("Tent");
+        helps.push_back( tr("Each pixel is a weighted average of the 4x4 pixels around it at the previous scale. "
+                            "This produces less aliasing on fine details but is slower.").toStdString() );
+        _mipMapFilter->populateChoices(entries, helps);
+    }
+    _mipMapFilter->setHintToolTip( tr("Filter used to downscale the images rendered at full resolution by plug-ins that do not support "
+                                      "render scale, when rendering in proxy mode or when the viewer is zoomed out.") );
+    _renderingPage->addKnob(_mipMapFilter);
 }
 
 void
@@ -577,6 +596,16 @@ Settings::initializeKnobsProjectSetup()
                                                           " is enabled.") );
     _projectsPage->addKnob(_autoPreviewEnabledForNewProjects);
 
+    _maxPreviewRendersPerSecond = AppManager::createKnob<KnobInt>( shared_from_this(), tr("Maximum preview renders per second (0=\"unlimited\")") );
+    _maxPreviewRendersPerSecond->setName("maxPreviewRendersPerSecond");
+    _maxPreviewRendersPerSecond->setHintToolTip( tr("Node previews that cannot be made from an image already in the cache require a render "
+                                                    "of the tree upstream of the node. This limits how many of these renders may be launched "
+                                                    "each second so that they do not compete with the Viewer. Pending previews are coalesced "
+                                                    "and computed later on.") );
+    _maxPreviewRendersPerSecond->disableSlider();
+    _maxPreviewRendersPerSecond->setMinimum(0);
+    _projectsPage->addKnob(_maxPreviewRendersPerSecond);
+
 
     _fixPathsOnProjectPathChanged = AppManager::createKnob<KnobBool>( shared_from_this(), tr("Auto fix relative file-paths") );
     _fixPathsOnProjectPathChanged->setHintToolTip( tr("If checked, when a project-path changes (either the name or the value pointed to), %1 checks all file-path parameters in the project and tries to fix them.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
@@ -1115,6 +1144,14 @@ Settings::initializeKnobsViewers()
                                       " Hover each option with the mouse for a detailed description.") );
     _viewersTab->addKnob(_texturesMode);
 
+    _viewerCacheHalfFloat = AppManager::createKnob<KnobBool>( shared_from_this(), tr("Store 32bits textures as half-float in the cache") );
+    _viewerCacheHalfFloat->setName("viewerCacheHalfFloat");
+    _viewerCacheHalfFloat->setHintToolTip( tr("When the viewer textures bit depth is 32bits floating-point, the textures are stored "
+                                              "as 16bits half-float in the playback cache, so that twice as many frames fit in the cache. "
+                                              "Half-floats have a precision of 3 decimal digits, which is enough for display, "
+                                              "but values above 65504 are displayed as infinity.") );
+    _viewersTab->addKnob(_viewerCacheHalfFloat);
+
     _powerOf2Tiling = AppManager::createKnob<KnobInt>( shared_from_this(), tr("Viewer tile size is 2 to the power of...") );
     _powerOf2Tiling->setName("viewerTiling");
     _powerOf2Tiling->setHintToolTip( tr("The dimension of the viewer tiles is 2^n by 2^n (i.e. 256 by 256 pixels for n=8). "
@@ -1170,6 +1207,22 @@ Settings::initializeKnobsViewers()
     _autoProxyLevel->populateChoices(autoProxyChoices);
     _viewersTab->addKnob(_autoProxyLevel);
 
+    _viewerPrefetch = AppManager::createKnob<KnobBool>( shared_from_this(), tr("Prefetch the frames around the playhead") );
+    _viewerPrefetch->setName("viewerPrefetch");
+    _viewerPrefetch->setHintToolTip( tr("When checked, the viewer renders in the background the frames it is likely to display next, "
+                                        "in the direction and at the speed at which the timeline is scrubbed, so that they are "
+                                        "already in the playback cache when the user seeks to them. These renders have the lowest priority "
+                                        "and are interrupted as soon as a parameter changes.") );
+    _viewerPrefetch->setAddNewLine(false);
+    _viewersTab->addKnob(_viewerPrefetch);
+
+    _viewerPrefetchMemoryMB = AppManager::createKnob<KnobInt>( shared_from_this(), tr("Prefetch memory (MiB)") );
+    _viewerPrefetchMemoryMB->setName("viewerPrefetchMemory");
+    _viewerPrefetchMemoryMB->disableSlider();
+    _viewerPrefetchMemoryMB->setMinimum(0);
+    _viewerPrefetchMemoryMB->setHintToolTip( tr("The maximum size of the textures of the frames prefetched around the playhead in the playback cache (in MiB).") );
+    _viewersTab->addKnob(_viewerPrefetchMemoryMB);
+
     _maximumNodeViewerUIOpened = AppManager::createKnob<KnobInt>( shared_from_this(), tr("Max. opened node viewer interface") );
     _maximumNodeViewerUIOpened->setName("maxNodeUiOpened");
     _maximumNodeViewerUIOpened->setMinimum(1);
@@ -1314,6 +1367,24 @@ Settings::initializeKnobsCaching()
     _unreachableRAMLabel->setAsLabel();
     _cachingTab->addKnob(_unreachableRAMLabel);
 
+    _cacheEvictionPolicy = AppManager::createKnob<KnobChoice>( shared_from_this(), tr("Cache eviction policy") );
+    _cacheEvictionPolicy->setName("cacheEvictionPolicy");
+    {
+        std::vector<std::string> entries;
+        std::vector<std::string> helps;
+        assert(entries.size() == (int)eCacheEvictionPolicyLRU);
+        entries.push_back("Least Recently Used");
+        helps.push_back( tr("When the cache is full, the images that were not used for the longest time are removed first.").toStdString() );
+        assert(entries.size() == (int)eCacheEvictionPolicyCostAware);
+        entries.push_back("Render Cost Aware");
+        helps.push_back( tr("When the cache is full, the images that were the fastest to render relative to their size are removed first, "
+                            "so that expensive results (e.g. a large blur) are kept longer than cheap ones (e.g. the output of a Read node). "
+                            "Images that are accessed often are kept longer, and images that were not accessed for a long time are eventually removed.").toStdString() );
+        _cacheEvictionPolicy->populateChoices(entries, helps);
+    }
+    _cacheEvictionPolicy->setHintToolTip( tr("Select which images are removed first from the node cache when it is full.") );
+    _cachingTab->addKnob(_cacheEvictionPolicy);
+
     _maxViewerDiskCacheGB = AppManager::createKnob<KnobInt>( shared_from_this(), tr("Maximum playback disk cache size (GiB)") );
     _maxViewerDiskCacheGB->setName("maxViewerDiskCache");
     _maxViewerDiskCacheGB->disableSlider();
@@ -1330,6 +1401,14 @@ Settings::initializeKnobsCaching()
     _maxDiskCacheNodeGB->setHintToolTip( tr("The maximum size that may be used by the DiskCache node on disk (in GiB)") );
     _cachingTab->addKnob(_maxDiskCacheNodeGB);
 
+    _diskCacheCompression = AppManager::createKnob<KnobBool>( shared_from_this(), tr("Compress DiskCache node images") );
+    _diskCacheCompression->setName("diskCacheCompression");
+    _diskCacheCompression->setHintToolTip( tr("When checked, the images cached by the DiskCache node are compressed without loss "
+                                              "when they are written to disk and decompressed when they are read back. "
+                                              "More images fit in the maximum disk usage and less data is written to disk, "
+                                              "at the expense of some CPU time.") );
+    _cachingTab->addKnob(_diskCacheCompression);
+
 
     _diskCachePath = AppManager::createKnob<KnobPath>( shared_from_this(), tr("Disk cache path (empty = default)") );
     _diskCachePath->setName("diskCachePath");
@@ -1509,6 +1588,7 @@ Settings::setDefaultValues()
     _renderInSeparateProcess->setDefaultValue(false, 0);
     _queueRenders->setDefaultValue(false);
     _autoPreviewEnabledForNewProjects->setDefaultValue(true, 0);
+    _maxPreviewRendersPerSecond->setDefaultValue(0, 0);
     _firstReadSetProjectFormat->setDefaultValue(true);
     _fixPathsOnProjectPathChanged->setDefaultValue(true);
     _maxPanelsOpened->setDefaultValue(10, 0);
@@ -1516,10 +1596,12 @@ Settings::setDefaultValues()
     _renderOnEditingFinished->setDefaultValue(false);
     _activateRGBSupport->setDefaultValue(true);
     _activateTransformConcatenationSupport->setDefaultValue(true);
+    _mipMapFilter->setDefaultValue( (int)eMipMapFilterBox );
     _extraPluginPaths->setDefaultValue("", 0);
     _preferBundledPlugins->setDefaultValue(true);
     _loadBundledPlugins->setDefaultValue(true);
     _texturesMode->setDefaultValue(0, 0);
+    _viewerCacheHalfFloat->setDefaultValue(false);
     _powerOf2Tiling->setDefaultValue(8, 0);
     _checkerboardTileSize->setDefaultValue(5);
     _checkerboardColor1->setDefaultValue(0.5, 0);
@@ -1533,6 +1615,8 @@ Settings::setDefaultValues()
     _autoWipe->setDefaultValue(true);
     _autoProxyWhenScrubbingTimeline->setDefaultValue(true);
     _autoProxyLevel->setDefaultValue(1);
+    _viewerPrefetch->setDefaultValue(true);
+    _viewerPrefetchMemoryMB->setDefaultValue(512);
     _maximumNodeViewerUIOpened->setDefaultValue(2);
     _viewerKeys->setDefaultValue(true);
 
@@ -1542,8 +1626,10 @@ Settings::setDefaultValues()
     _aggressiveCaching->setDefaultValue(false);
     _maxRAMPercent->setDefaultValue(50, 0);
     _unreachableRAMPercent->setDefaultValue(5);
+    _cacheEvictionPolicy->setDefaultValue( (int)eCacheEvictionPolicyCostAware );
     _maxViewerDiskCacheGB->setDefaultValue(5, 0);
     _maxDiskCacheNodeGB->setDefaultValue(10, 0);
+    _diskCacheCompression->setDefaultValue(true);
     setCachingLabels();
     _autoScroll->setDefaultValue(false);
     _autoTurbo->setDefaultValue(false);
@@ -2096,6 +2182,9 @@ Settings::restoreSettings()
         if (_texturesMode) {
             _texturesMode->setSecret(true);
         }
+        if (_viewerCacheHalfFloat) {
+            _viewerCacheHalfFloat->setSecret(true);
+        }
     }
 
     _settingsExisted = false;
@@ -2244,6 +2333,14 @@ Settings::onKnobValueChanged(const KnobIPtr& k,
             appPTR->setApplicationsCachesMaximumMemoryPercent( getRamMaximumPercent() );
         }
         setCachingLabels();
+    } else if ( k == _cacheEvictionPolicy ) {
+        if (!_restoringSettings) {
+            appPTR->setApplicationsCachesEvictionPolicy( getCacheEvictionPolicy() );
+        }
+    } else if ( k == _diskCacheCompression ) {
+        if (!_restoringSettings) {
+            appPTR->setApplicationsCachesStorageCompression( isDiskCacheCompressionEnabled() );
+        }
     } else if ( k == _diskCachePath ) {
         appPTR->setDiskCacheLocation( QString::fromUtf8( _diskCachePath->getValue().c_str() ) );
     } else if ( k == _wipeDiskCache ) {
@@ -2255,7 +2352,7 @@ Settings::onKnobValueChanged(const KnobIPtr& k,
             QThreadPool::globalInstance()->setMaxThreadCount(1);
             appPTR->abortAnyProcessing();
         } else if (nbThreads == 0) {
-            QThreadPool::globalInstance()->setMaxThreadCount( QThread::idealThreadCount() );
+            QThreadPool::globalInstance()->setMaxThreadCount( appPTR->getHardwareIdealThreadCount() );
         } else {
             QThreadPool::globalInstance()->setMaxThreadCount(nbThreads);
         }
@@ -2296,10 +2393,14 @@ Settings::onKnobValueChanged(const KnobIPtr& k,
         appPTR->onViewerTileCacheSizeChanged();
     } else if ( k == _texturesMode &&  !_restoringSettings) {
          appPTR->onViewerTileCacheSizeChanged();
+    } else if ( k == _viewerCacheHalfFloat && !_restoringSettings) {
+        appPTR->onViewerTileCacheSizeChanged();
     } else if ( ( k == _hideOptionalInputsAutomatically ) && !_restoringSettings && (reason == eValueChangedReasonUserEdited) ) {
         appPTR->toggleAutoHideGraphInputs();
     } else if ( k == _autoProxyWhenScrubbingTimeline ) {
         _autoProxyLevel->setSecret( !_autoProxyWhenScrubbingTimeline->getValue() );
+    } else if ( k == _viewerPrefetch ) {
+        _viewerPrefetchMemoryMB->setSecret( !_viewerPrefetch->getValue() );
     } else if ( !_restoringSettings &&
                 ( ( k == _sunkenColor ) ||
                   ( k == _baseColor ) ||
@@ -2389,6 +2490,12 @@ Settings::getViewersBitDepth() const
     }
 }
 
+bool
+Settings::isViewerCacheHalfFloatEnabled() const
+{
+    return _viewerCacheHalfFloat->getValue();
+}
+
 int
 Settings::getViewerTilesPowerOf2() const
 {
@@ -2443,6 +2550,18 @@ Settings::getAutoProxyMipMapLevel() const
     return (unsigned int)_autoProxyLevel->getValue() + 1;
 }
 
+bool
+Settings::isViewerPrefetchEnabled() const
+{
+    return _viewerPrefetch->getValue();
+}
+
+U64
+Settings::getViewerPrefetchMemoryBudget() const
+{
+    return (U64)( _viewerPrefetchMemoryMB->getValue() ) * 1024 * 1024;
+}
+
 int
 Settings::getMaxOpenedNodesViewerContext() const
 {
@@ -2482,6 +2601,18 @@ Settings::getMaximumDiskCacheNodeSize() const
     return (U64)( _maxDiskCacheNodeGB->getValue() ) * std::pow(1024., 3.);
 }
 
+CacheEvictionPolicyEnum
+Settings::getCacheEvictionPolicy() const
+{
+    return (CacheEvictionPolicyEnum)_cacheEvictionPolicy->getValue();
+}
+
+bool
+Settings::isDiskCacheCompressionEnabled() const
+{
+    return _diskCacheCompression->getValue();
+}
+
 ///////////////////////////////////////////////////
 
 double
@@ -2520,6 +2651,12 @@ Settings::isAutoPreviewOnForNewProjects() const
     return _autoPreviewEnabledForNewProjects->getValue();
 }
 
+int
+Settings::getMaxPreviewRendersPerSecond() const
+{
+    return _maxPreviewRendersPerSecond->getValue();
+}
+
 int
 Settings::getDocumentationSource() const
 {
@@ -3015,6 +3152,12 @@ Settings::isTransformConcatenationEnabled() const
     return _activateTransformConcatenationSupport->getValue();
 }
 
+MipMapFilterEnum
+Settings::getMipMapFilter() const
+{
+    return (MipMapFilterEnum)_mipMapFilter->getValue();
+}
+
 bool
 Settings::useGlobalThreadPool() const
 {
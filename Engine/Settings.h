@@ -120,6 +120,10 @@ public:
 
     double getUnreachableRamPercent() const;
 
+    CacheEvictionPolicyEnum getCacheEvictionPolicy() const;
+
+    bool isDiskCacheCompressionEnabled() const;
+
     bool getColorPickerLinear() const;
 
     int getNumberOfThreads() const;
@@ -162,6 +166,8 @@ public:
 
     bool isAutoPreviewOnForNewProjects() const;
 
+    int getMaxPreviewRendersPerSecond() const;
+
     void getOpenFXPluginsSearchPaths(std::list<std::string>* paths) const;
 
     bool isRenderInSeparatedProcessEnabled() const;
@@ -242,6 +248,7 @@ public:
     ///////////////////////////////////////////////////////
     // "Viewers" pane
     ImageBitDepthEnum getViewersBitDepth() const;
+    bool isViewerCacheHalfFloatEnabled() const;
     int getViewerTilesPowerOf2() const;
     int getCheckerboardTileSize() const;
     void getCheckerboardColor1(double* r, double* g, double* b, double* a) const;
@@ -249,6 +256,8 @@ public:
     bool isAutoWipeEnabled() const;
     bool isAutoProxyEnabled() const;
     unsigned int getAutoProxyMipMapLevel() const;
+    bool isViewerPrefetchEnabled() const;
+    U64 getViewerPrefetchMemoryBudget() const;
     int getMaxOpenedNodesViewerContext() const;
     bool isViewerKeysEnabled() const;
     ///////////////////////////////////////////////////////
@@ -257,6 +266,8 @@ public:
 
     bool isTransformConcatenationEnabled() const;
 
+    MipMapFilterEnum getMipMapFilter() const;
+
     bool isMergeAutoConnectingToAInput() const;
 
     /**
@@ -444,6 +455,7 @@ private:
     KnobBoolPtr _pluginUseImageCopyForSource;
     KnobBoolPtr _activateRGBSupport;
     KnobBoolPtr _activateTransformConcatenationSupport;
+    KnobChoicePtr _mipMapFilter;
 
     // General/GPU rendering
     KnobPagePtr _gpuPage;
@@ -459,6 +471,7 @@ private:
     KnobPagePtr _projectsPage;
     KnobBoolPtr _firstReadSetProjectFormat;
     KnobBoolPtr _autoPreviewEnabledForNewProjects;
+    KnobIntPtr _maxPreviewRendersPerSecond;
     KnobBoolPtr _fixPathsOnProjectPathChanged;
     KnobBoolPtr _enableMappingFromDriveLettersToUNCShareNames;
 
@@ -506,16 +519,19 @@ private:
     ///10% seems a reasonable value.
     KnobIntPtr _unreachableRAMPercent;
     KnobStringPtr _unreachableRAMLabel;
+    KnobChoicePtr _cacheEvictionPolicy;
 
     ///The total disk space allowed for all Natron's caches
     KnobIntPtr _maxViewerDiskCacheGB;
     KnobIntPtr _maxDiskCacheNodeGB;
+    KnobBoolPtr _diskCacheCompression;
     KnobPathPtr _diskCachePath;
     KnobButtonPtr _wipeDiskCache;
 
     // Viewer
     KnobPagePtr _viewersTab;
     KnobChoicePtr _texturesMode;
+    KnobBoolPtr _viewerCacheHalfFloat;
     KnobIntPtr _powerOf2Tiling;
     KnobIntPtr _checkerboardTileSize;
     KnobColorPtr _checkerboardColor1;
@@ -523,6 +539,8 @@ private:
     KnobBoolPtr _autoWipe;
     KnobBoolPtr _autoProxyWhenScrubbingTimeline;
     KnobChoicePtr _autoProxyLevel;
+    KnobBoolPtr _viewerPrefetch;
+    KnobIntPtr _viewerPrefetchMemoryMB;
     KnobIntPtr _maximumNodeViewerUIOpened;
     KnobBoolPtr _viewerKeys;
 
@@ -0,0 +1,238 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "SharedUpstreamImages.h"
+
+#include <algorithm> // min, max
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <QtCore/QMutex>
+
+#include "Engine/Image.h"
+#include "Engine/Node.h"
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// The frames rendered by a writer, firstFrame <= lastFrame and frameStep >= 1
+struct WriterFrameRange
+{
+    int firstFrame;
+    int lastFrame;
+    int frameStep;
+};
+
+struct FrameImages
+{
+    std::set<ImagePtr> images;
+
+    // The number of writers which called notifyFrameRendered() for this frame
+    int nWritersDone;
+
+    FrameImages()
+        : images()
+        , nWritersDone(0)
+    {
+    }
+};
+
+typedef std::map<double, FrameImages> FrameImagesMap;
+
+void
+getUpstreamNodesRecursive(const NodePtr& node,
+                          std::set<const Node*>* visited)
+{
+    if ( !visited->insert( node.get() ).second ) {
+        return;
+    }
+    int nInputs = node->getMaxInputCount();
+    for (int i = 0; i < nInputs; ++i) {
+        NodePtr input = node->getInput(i);
+        if (input) {
+            getUpstreamNodesRecursive(input, visited);
+        }
+    }
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
+struct SharedUpstreamImagesPrivate
+{
+    std::size_t maxHeldBytes;
+
+    // Set before the renders start, then only read
+    std::vector<WriterFrameRange> writers;
+    std::map<const Node*, int> nWritersPerNode;
+
+    // Protects frames and heldBytes
+    mutable QMutex framesMutex;
+    FrameImagesMap frames;
+    std::size_t heldBytes;
+
+    SharedUpstreamImagesPrivate(std::size_t maxHeldBytes)
+        : maxHeldBytes(maxHeldBytes)
+        , writers()
+        , nWritersPerNode()
+        , framesMutex()
+        , frames()
+        , heldBytes(0)
+    {
+    }
+
+    int getNWritersRenderingFrame(double time) const
+    {
+        int ret = 0;
+
+        for (std::size_t i = 0; i < writers.size(); ++i) {
+            const WriterFrameRange& range = writers[i];
+            if ( (time < range.firstFrame) || (time > range.lastFrame) ) {
+                continue;
+            }
+            if ( std::fmod(time - range.firstFrame, (double)range.frameStep) == 0. ) {
+                ++ret;
+            }
+        }
+
+        return ret;
+    }
+
+    void releaseFrame(FrameImagesMap::iterator it)
+    {
+        for (std::set<ImagePtr>::const_iterator it2 = it->second.images.begin(); it2 != it->second.images.end(); ++it2) {
+            heldBytes -= (*it2)->dataSize();
+        }
+        frames.erase(it);
+    }
+};
+
+SharedUpstreamImages::SharedUpstreamImages(std::size_t maxHeldBytes)
+    : _imp( new SharedUpstreamImagesPrivate(maxHeldBytes) )
+{
+}
+
+SharedUpstreamImages::~SharedUpstreamImages()
+{
+}
+
+void
+SharedUpstreamImages::addWriter(const NodePtr& writer,
+                                int firstFrame,
+                                int lastFrame,
+                                int frameStep)
+{
+    // An unresolved range would make the writer count for every frame: the images of the frames it does not
+    // render would never be released. Such a writer does not hold images, the others still share theirs.
+    assert( (firstFrame != INT_MIN) && (lastFrame != INT_MAX) && (frameStep != INT_MIN) && (frameStep != INT_MAX) );
+    if ( (firstFrame != INT_MIN) && (lastFrame != INT_MAX) && (frameStep != INT_MIN) && (frameStep != INT_MAX) ) {
+        WriterFrameRange range;
+        range.firstFrame = std::min(firstFrame, lastFrame);
+        range.lastFrame = std::max(firstFrame, lastFrame);
+        // Writers render forward from the first frame, as AppInstance::startWritersRendering() validates it
+        range.frameStep = std::max(1, frameStep);
+        _imp->writers.push_back(range);
+    }
+
+    std::set<const Node*> upstreamNodes;
+    getUpstreamNodesRecursive(writer, &upstreamNodes);
+    for (std::set<const Node*>::const_iterator it = upstreamNodes.begin(); it != upstreamNodes.end(); ++it) {
+        ++_imp->nWritersPerNode[*it];
+    }
+}
+
+bool
+SharedUpstreamImages::isSharedNode(const NodePtr& node) const
+{
+    std::map<const Node*, int>::const_iterator found = _imp->nWritersPerNode.find( node.get() );
+
+    return found != _imp->nWritersPerNode.end() && found->second > 1;
+}
+
+void
+SharedUpstreamImages::holdImage(double time,
+                                const ImagePtr& image)
+{
+    if (!image) {
+        return;
+    }
+    std::size_t imageBytes = image->dataSize();
+    QMutexLocker k(&_imp->framesMutex);
+
+    if (_imp->heldBytes + imageBytes > _imp->maxHeldBytes) {
+        return;
+    }
+    if ( _imp->frames[time].images.insert(image).second ) {
+        _imp->heldBytes += imageBytes;
+    }
+}
+
+void
+SharedUpstreamImages::notifyFrameRendered(double time)
+{
+    QMutexLocker k(&_imp->framesMutex);
+    FrameImagesMap::iterator it = _imp->frames.insert( std::make_pair( time, FrameImages() ) ).first;
+
+    ++it->second.nWritersDone;
+    if ( it->second.nWritersDone >= _imp->getNWritersRenderingFrame(time) ) {
+        _imp->releaseFrame(it);
+    }
+}
+
+void
+SharedUpstreamImages::clear()
+{
+    QMutexLocker k(&_imp->framesMutex);
+
+    _imp->frames.clear();
+    _imp->heldBytes = 0;
+}
+
+std::size_t
+SharedUpstreamImages::getHeldImagesCount() const
+{
+    QMutexLocker k(&_imp->framesMutex);
+    std::size_t ret = 0;
+
+    for (FrameImagesMap::const_iterator it = _imp->frames.begin(); it != _imp->frames.end(); ++it) {
+        ret += it->second.images.size();
+    }
+
+    return ret;
+}
+
+std::size_t
+SharedUpstreamImages::getHeldBytes() const
+{
+    QMutexLocker k(&_imp->framesMutex);
+
+    return _imp->heldBytes;
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,96 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_SHAREDUPSTREAMIMAGES_H
+#define NATRON_ENGINE_SHAREDUPSTREAMIMAGES_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstddef>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief When several writers render together, the nodes upstream of more than one of them are rendered by the first writer
+ * reaching a frame and read from the cache by the others. This keeps a reference on the images of these shared nodes
+ * until all the writers rendering the frame are done with it, so that the cache cannot evict them in between.
+ *
+ * The writers are all added before the renders start, then the object is shared by their render threads.
+ * Images are no longer held once maxHeldBytes is reached: the writers then rely on the cache alone.
+ **/
+struct SharedUpstreamImagesPrivate;
+class SharedUpstreamImages
+{
+public:
+
+    SharedUpstreamImages(std::size_t maxHeldBytes);
+
+    ~SharedUpstreamImages();
+
+    /**
+     * @brief Adds a writer rendering the given frame range. The nodes upstream of it are marked as used by one more writer.
+     * The range must be the one actually rendered by the writer, resolved from the INT_MIN/INT_MAX defaults of a RenderWork.
+     **/
+    void addWriter(const NodePtr& writer, int firstFrame, int lastFrame, int frameStep);
+
+    /**
+     * @brief Returns true if the node is upstream of more than one writer
+     **/
+    bool isSharedNode(const NodePtr& node) const;
+
+    /**
+     * @brief Keeps a reference on the image, rendered for the frame of a writer at the given time, until all writers rendering
+     * that frame called notifyFrameRendered() for it.
+     * Only images of the cache stored in RAM are worth holding: the render only passes these.
+     **/
+    void holdImage(double time, const ImagePtr& image);
+
+    /**
+     * @brief Called by each writer once it is done with a frame, whether the render succeeded or not.
+     **/
+    void notifyFrameRendered(double time);
+
+    /**
+     * @brief Releases all the held images, e.g: when the renders are finished or aborted.
+     **/
+    void clear();
+
+    std::size_t getHeldImagesCount() const;
+
+    std::size_t getHeldBytes() const;
+
+private:
+
+    boost::scoped_ptr<SharedUpstreamImagesPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_SHAREDUPSTREAMIMAGES_H
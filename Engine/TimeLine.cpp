@@ -25,6 +25,7 @@
 #include "TimeLine.h"
 
 #include <cassert>
+#include <cstdlib> // abs
 #include <stdexcept>
 
 #ifndef NDEBUG
@@ -42,6 +43,11 @@ NATRON_NAMESPACE_ENTER;
 TimeLine::TimeLine(Project* project)
     : _project(project)
     , _currentFrame(1)
+    , _scrubTimer()
+    , _lastSeekTime(0.)
+    , _scrubDirection(0)
+    , _scrubVelocity(0.)
+    , _scrubStep(1)
 {
 }
 
@@ -66,6 +72,9 @@ TimeLine::seekFrame(SequenceTime frame,
     {
         QMutexLocker l(&_lock);
         if (_currentFrame != frame) {
+            if (reason != eTimelineChangeReasonPlaybackSeek) {
+                updateScrubMotion_locked(_currentFrame, frame);
+            }
             _currentFrame = frame;
             changed = true;
         }
@@ -111,6 +120,7 @@ TimeLine::onFrameChanged(SequenceTime frame)
     {
         QMutexLocker l(&_lock);
         if (_currentFrame != frame) {
+            updateScrubMotion_locked(_currentFrame, frame);
             _currentFrame = frame;
             changed = true;
         }
@@ -123,6 +133,50 @@ TimeLine::onFrameChanged(SequenceTime frame)
     }
 }
 
+void
+TimeLine::updateScrubMotion_locked(SequenceTime previousFrame,
+                                   SequenceTime frame)
+{
+    assert( !_lock.tryLock() );
+    double now = _scrubTimer.getTimeSinceCreation();
+    double dt = now - _lastSeekTime;
+    _lastSeekTime = now;
+
+    int delta = frame - previousFrame;
+    int direction = delta > 0 ? 1 : -1;
+    _scrubStep = std::abs(delta);
+
+    if ( (dt <= 0.) || (dt > NATRON_TIMELINE_SCRUB_TIMEOUT_S) ) {
+        // First seek of a new motion: we only know its direction
+        _scrubVelocity = 0.;
+    } else {
+        double velocity = std::abs(delta) / dt;
+        if (direction != _scrubDirection) {
+            _scrubVelocity = velocity;
+        } else {
+            // Smooth the velocity over the last seeks, the interval between 2 seeks depends on the mouse events
+            _scrubVelocity = (_scrubVelocity + velocity) / 2.;
+        }
+    }
+    _scrubDirection = direction;
+}
+
+void
+TimeLine::getScrubMotion(int* direction,
+                         double* framesPerSecond,
+                         int* step) const
+{
+    QMutexLocker l(&_lock);
+
+    *direction = _scrubDirection;
+    *step = _scrubStep;
+    if (_scrubTimer.getTimeSinceCreation() - _lastSeekTime > NATRON_TIMELINE_SCRUB_TIMEOUT_S) {
+        *framesPerSecond = 0.;
+    } else {
+        *framesPerSecond = _scrubVelocity;
+    }
+}
+
 NATRON_NAMESPACE_EXIT;
 
 NATRON_NAMESPACE_USING;
@@ -37,6 +37,10 @@ CLANG_DIAG_ON(deprecated)
 #include "Global/GlobalDefines.h"
 
 #include "Engine/EngineFwd.h"
+#include "Engine/Timer.h"
+
+// Seeks more than this number of seconds apart are not part of the same scrubbing motion
+#define NATRON_TIMELINE_SCRUB_TIMEOUT_S 0.5
 
 NATRON_NAMESPACE_ENTER;
 
@@ -71,6 +75,13 @@ public:
 
     void decrementCurrentFrame();
 
+    /**
+     * @brief Returns the motion of the current frame when the user scrubs the timeline: the direction (-1, 0 or 1)
+     * of the last seek, the velocity of the motion in frames per second and the number of frames between the last two seeks.
+     * The velocity is 0 if the user did not seek for more than NATRON_TIMELINE_SCRUB_TIMEOUT_S. Playback does not affect the motion.
+     **/
+    void getScrubMotion(int* direction, double* framesPerSecond, int* step) const;
+
 public Q_SLOTS:
 
 
@@ -86,9 +97,18 @@ Q_SIGNALS:
 
 private:
 
+    void updateScrubMotion_locked(SequenceTime previousFrame, SequenceTime frame);
+
     mutable QMutex _lock; // protects the following SequenceTime members
     Project* _project;
     SequenceTime _currentFrame;
+
+    // Scrubbing motion, protected by _lock
+    TimeLapse _scrubTimer;
+    double _lastSeekTime;
+    int _scrubDirection;
+    double _scrubVelocity;
+    int _scrubStep;
 };
 
 NATRON_NAMESPACE_EXIT;
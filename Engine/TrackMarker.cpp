@@ -1138,6 +1138,8 @@ TrackMarker::getMarkerImage(int time,
     }
 
     AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(false, 0);
+    // The marker image is displayed in the tracker interface
+    abortInfo->setPriority(eRenderPriorityInteractive);
     const bool isRenderUserInteraction = true;
     const bool isSequentialRender = false;
     AbortableThread* isAbortable = dynamic_cast<AbortableThread*>( QThread::currentThread() );
@@ -1159,6 +1161,7 @@ TrackMarker::getMarkerImage(int time,
     tlsArgs->isDoingRotoNeatRender = false;
     tlsArgs->isAnalysis = true;
     tlsArgs->draftMode = true;
+    tlsArgs->viewsRenderedConcurrently = false;
     tlsArgs->stats = RenderStatsPtr();
     boost::shared_ptr<ParallelRenderArgsSetter> frameRenderArgs;
     try {
@@ -341,6 +341,7 @@ TrackerFrameAccessor::GetImage(int /*clip*/,
     const bool isSequentialRender = false;
 
     AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(false, 0);
+    abortInfo->setPriority(eRenderPriorityAnalysis);
     AbortableThread* isAbortable = dynamic_cast<AbortableThread*>( QThread::currentThread() );
     if (isAbortable) {
         isAbortable->setAbortInfo( isRenderUserInteraction, abortInfo, node->getEffectInstance() );
@@ -360,6 +361,7 @@ TrackerFrameAccessor::GetImage(int /*clip*/,
     tlsArgs->isDoingRotoNeatRender = false;
     tlsArgs->isAnalysis = true;
     tlsArgs->draftMode = false;
+    tlsArgs->viewsRenderedConcurrently = false;
     tlsArgs->stats = RenderStatsPtr();
     boost::shared_ptr<ParallelRenderArgsSetter> frameRenderArgs;
     try {
@@ -31,6 +31,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 #include <cstddef>
 
 #include "Global/Enums.h"
@@ -60,9 +61,13 @@ public:
         unsigned char* ramBuffer; // a pointer to the RAM buffer held either by the cached frame or allocated by malloc()
         std::size_t bytesCount; // number of bytes in the texture
 
+        // Set when the cached frame stores half-floats (@see FrameEntry::isStoredAsHalfFloat()): ramBuffer is then this
+        // float buffer, which is converted from the cached data or to the cached data once rendered
+        boost::shared_ptr<std::vector<float> > floatBuffer;
+
 
         CachedTile()
-            : rect(), rectRounded(), cachedData(), isCached(false), ramBuffer(0), bytesCount(0) {}
+            : rect(), rectRounded(), cachedData(), isCached(false), ramBuffer(0), bytesCount(0), floatBuffer() {}
     };
 
     UpdateViewerParams()
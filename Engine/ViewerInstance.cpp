@@ -52,6 +52,7 @@ CLANG_DIAG_ON(deprecated)
 #include "Engine/AppInstance.h"
 #include "Engine/AppManager.h"
 #include "Engine/Cache.h"
+#include "Engine/CacheStorageCodec.h"
 #include "Engine/Image.h"
 #include "Engine/Log.h"
 #include "Engine/Lut.h"
@@ -583,6 +584,53 @@ ViewerInstance::renderViewer(ViewIdx view,
     return eViewerRenderRetCodeRender;
 } // ViewerInstance::renderViewer
 
+ViewerInstance::ViewerRenderRetCode
+ViewerInstance::prefetchFrame(SequenceTime time,
+                              ViewIdx view,
+                              const AbortableRenderInfoPtr& abortInfo,
+                              std::size_t* frameBytes)
+{
+    *frameBytes = 0;
+    if ( !getUiContext() ) {
+        return eViewerRenderRetCodeFail;
+    }
+
+    ViewerNodePtr viewerGroup = getViewerNodeGroup();
+    ViewerRenderRetCode ret = eViewerRenderRetCodeRedraw;
+    for (int i = 0; i < 2; ++i) {
+        if ( (i == 1) && (viewerGroup->getCurrentOperator() == eViewerCompositingOperatorNone) ) {
+            break;
+        }
+
+        // The render is sequential so that it does not interfere with the render ages of the textures displayed
+        ViewerArgs args;
+        ViewerRenderRetCode stat = getRenderViewerArgsAndCheckCache(time, true /*isSequential*/, view, i, NodePtr(), false /*isDoingRotoNeatRender*/, abortInfo, RenderStatsPtr(), &args);
+        if ( (stat != eViewerRenderRetCodeRender) || !args.params || args.params->isViewerPaused || !args.useViewerCache ) {
+            continue;
+        }
+
+        bool isCached = !args.mustComputeRoDAndLookupCache && ( args.params->nbCachedTile == (int)args.params->tiles.size() );
+        if (!isCached) {
+            if ( abortInfo->isAborted() ) {
+                return eViewerRenderRetCodeRedraw;
+            }
+            stat = renderViewer_internal(view, false /*singleThreaded*/, true /*isSequentialRender*/, NodePtr(), RotoStrokeItemPtr(), false /*isDoingRotoNeatRender*/,
+                                         boost::shared_ptr<ViewerCurrentFrameRequestSchedulerStartArgs>(), RenderStatsPtr(), args);
+            args.isRenderingFlag.reset();
+            if ( (stat != eViewerRenderRetCodeRender) || abortInfo->isAborted() ) {
+                return stat == eViewerRenderRetCodeFail ? eViewerRenderRetCodeFail : eViewerRenderRetCodeRedraw;
+            }
+        }
+
+        for (std::list<UpdateViewerParams::CachedTile>::const_iterator it = args.params->tiles.begin(); it != args.params->tiles.end(); ++it) {
+            *frameBytes += it->bytesCount;
+        }
+        ret = eViewerRenderRetCodeRender;
+    }
+
+    return ret;
+} // ViewerInstance::prefetchFrame
+
 
 static unsigned char*
 getTexPixel(int x,
@@ -647,6 +695,47 @@ copyAndSwap(const TextureRect& srcRect,
     return true;
 }
 
+/**
+ * @brief Returns the bit depth of the viewer cache entries holding textures of the given bit depth
+ **/
+static ImageBitDepthEnum
+getViewerCacheStorageBitDepth(ImageBitDepthEnum textureDepth)
+{
+    if ( (textureDepth == eImageBitDepthFloat) && appPTR->getCurrentSettings()->isViewerCacheHalfFloatEnabled() ) {
+        return eImageBitDepthHalf;
+    }
+
+    return textureDepth;
+}
+
+/**
+ * @brief Points the RAM buffer of the tile to its cached data. If the cached data is stored as half-float, the tile
+ * gets a float buffer instead, which is decoded from the cached data if decode is true.
+ **/
+static void
+setTileRAMBuffer(bool decode,
+                 UpdateViewerParams::CachedTile* tile)
+{
+    assert(tile->cachedData);
+    if ( !tile->cachedData->isStoredAsHalfFloat() ) {
+        tile->ramBuffer = tile->cachedData->data();
+
+        return;
+    }
+    std::size_t nValues = tile->bytesCount / sizeof(float);
+    tile->floatBuffer.reset( new std::vector<float>(nValues) );
+    if (decode) {
+        CacheStorageCodec::halfToFloatRow( (const unsigned short*)tile->cachedData->data(), &(*tile->floatBuffer)[0], nValues );
+    }
+    tile->ramBuffer = (unsigned char*)&(*tile->floatBuffer)[0];
+}
+
+static void
+decodeCachedTile(UpdateViewerParams::CachedTile* tile)
+{
+    setTileRAMBuffer(true, tile);
+}
+
 ViewerInstance::ViewerRenderRetCode
 ViewerInstance::getRenderViewerArgsAndCheckCache_public(SequenceTime time,
                                                         bool isSequential,
@@ -660,6 +749,7 @@ ViewerInstance::getRenderViewerArgsAndCheckCache_public(SequenceTime time,
                                                         ViewerArgs* outArgs)
 {
     AbortableRenderInfoPtr abortInfo = _imp->createNewRenderRequest(textureIndex, canAbort);
+    abortInfo->setPriority(isSequential ? eRenderPriorityPlayback : eRenderPriorityInteractive);
 
 
     ViewerRenderRetCode stat = getRenderViewerArgsAndCheckCache(time, isSequential, view, textureIndex, rotoPaintNode, isDoingRotoNeatRender, abortInfo, stats, outArgs);
@@ -903,6 +993,7 @@ ViewerInstance::getViewerRoIAndTexture(const RectD& rod,
         //bool tilesBboxSet = false;
 
         FrameEntryLocker entryLocker(_imp.get());
+        std::vector<UpdateViewerParams::CachedTile*> halfFloatTiles;
         for (std::list<UpdateViewerParams::CachedTile>::iterator it = outArgs->params->tiles.begin(); it != outArgs->params->tiles.end(); ++it) {
             if (!outArgs->params->frameViewHash) {
                 continue;
@@ -950,8 +1041,13 @@ ViewerInstance::getViewerRoIAndTexture(const RectD& rod,
                 // The data will be valid as long as the cachedFrame shared pointer use_count is gt 1
                 it->cachedData = foundCachedEntry;
                 it->isCached = true;
-                it->ramBuffer = foundCachedEntry->data();
-                assert(it->ramBuffer);
+                if ( foundCachedEntry->isStoredAsHalfFloat() ) {
+                    // decoded below
+                    halfFloatTiles.push_back(&*it);
+                } else {
+                    it->ramBuffer = foundCachedEntry->data();
+                    assert(it->ramBuffer);
+                }
                 ++outArgs->params->nbCachedTile;
             } else {
                 // Uncached tile, add it to the bbox
@@ -967,6 +1063,15 @@ ViewerInstance::getViewerRoIAndTexture(const RectD& rod,
             }
         }
 
+        // Convert the tiles stored as half-float in parallel
+        if ( !halfFloatTiles.empty() ) {
+            TimeLapse decodeTimer;
+            QtConcurrent::blockingMap(halfFloatTiles, decodeCachedTile);
+            if ( stats && stats->isInDepthProfilingEnabled() ) {
+                stats->addCacheDecodeInfosForNode( getNode(), (double)sizeof(float) / sizeof(unsigned short), decodeTimer.getTimeSinceCreation() );
+            }
+        }
+
         /*if ( outArgs->params->roi.contains(tilesBbox) ) {
             outArgs->params->roi = tilesBbox;
         }
@@ -1168,6 +1273,7 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
         tlsArgs->isDoingRotoNeatRender = isDoingRotoNeatRender;
         tlsArgs->isAnalysis = false;
         tlsArgs->draftMode = inArgs.draftModeEnabled;
+        tlsArgs->viewsRenderedConcurrently = false;
         tlsArgs->stats = stats;
         try {
             inArgs.frameArgs.reset( new ParallelRenderArgsSetter(tlsArgs) );
@@ -1573,7 +1679,7 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
 
 
 
-                    boost::shared_ptr<FrameParams> cachedFrameParams( new FrameParams(bounds , key.getBitDepth(), tileBounds, ImagePtr() ) );
+                    boost::shared_ptr<FrameParams> cachedFrameParams( new FrameParams(bounds , getViewerCacheStorageBitDepth(inArgs.params->depth), tileBounds, ImagePtr() ) );
                     bool cached = appPTR->getTextureOrCreate(key, cachedFrameParams, &entryLocker, &it->cachedData);
                     if (!it->cachedData) {
                         std::size_t size = cachedFrameParams->getStorageInfo().numComponents * cachedFrameParams->getStorageInfo().dataTypeSize * cachedFrameParams->getStorageInfo().bounds.area();
@@ -1589,7 +1695,7 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
                     } else {
                         // If the tile is cached and we got it that means rendering is done
                         entryLocker.lock(it->cachedData);
-                        it->ramBuffer = it->cachedData->data();
+                        setTileRAMBuffer(true, &*it);
                         it->isCached = true;
                         continue;
                     }
@@ -1601,7 +1707,7 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
                     ///Since it is used during the whole function scope it is guaranteed not to be freed before
                     ///The viewer is actually done with it.
                     /// @see Cache::clearInMemoryPortion and Cache::clearDiskPortion and LRUHashTable::evict
-                    it->ramBuffer = it->cachedData->data();
+                    setTileRAMBuffer(false, &*it);
                     assert(it->ramBuffer);
                     unCachedTiles.push_back(*it);
                 } // !it->isCached
@@ -1818,6 +1924,11 @@ renderFunctor(const RectI& roi,
     if ( (args.bitDepth == eImageBitDepthFloat) ) {
         // image is stored as linear, the OpenGL shader with do gamma/sRGB/Rec709 decompression, as well as gain and offset
         scaleToTexture32bits(roi, args, tile, (float*)tile.ramBuffer);
+        if (tile.floatBuffer) {
+            // the cached tile is stored as half-float
+            assert(tile.cachedData);
+            CacheStorageCodec::floatToHalfRow( &(*tile.floatBuffer)[0], (unsigned short*)tile.cachedData->data(), tile.floatBuffer->size() );
+        }
     } else {
         // texture is stored as sRGB/Rec709 compressed 8-bit RGBA
         scaleToTexture8bits(roi, args, viewer, tile, (U32*)tile.ramBuffer);
@@ -207,7 +207,17 @@ public:
                                      const boost::shared_ptr<ViewerCurrentFrameRequestSchedulerStartArgs>& request,
                                      const RenderStatsPtr& stats) WARN_UNUSED_RETURN;
 
-
+    /**
+     * @brief Renders the textures of the frame at the given time into the viewer cache, without displaying them.
+     * This is used to render speculatively the frames around the playhead, see ViewerPrefetcher.
+     * Nothing is rendered if the viewer does not use its cache for the current settings (user RoI, auto-contrast...).
+     * @param frameBytes Set to the size of the textures of the frame in the cache
+     * @returns eViewerRenderRetCodeRender if the textures of the frame are in the cache when returning
+     **/
+    ViewerRenderRetCode prefetchFrame(SequenceTime time,
+                                      ViewIdx view,
+                                      const AbortableRenderInfoPtr& abortInfo,
+                                      std::size_t* frameBytes) WARN_UNUSED_RETURN;
 
     void aboutToUpdateTextures();
 
@@ -0,0 +1,308 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "ViewerPrefetcher.h"
+
+#include <algorithm> // min, max, find
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QCoreApplication>
+
+#include "Engine/AbortableRenderInfo.h"
+#include "Engine/AppManager.h"
+#include "Engine/Settings.h"
+#include "Engine/TimeLine.h"
+#include "Engine/TLSHolder.h"
+#include "Engine/ViewIdx.h"
+#include "Engine/ViewerInstance.h"
+
+NATRON_NAMESPACE_ENTER;
+
+class ViewerPrefetcherStartArgs
+    : public GenericThreadStartArgs
+{
+public:
+
+    // Identifies the request, see ViewerPrefetcherPrivate::requestsCount
+    U64 request;
+    ViewIdx view;
+    std::vector<int> frames;
+    U64 memoryBudget;
+
+    // Shared by the renders of all the frames of the request
+    AbortableRenderInfoPtr abortInfo;
+
+    ViewerPrefetcherStartArgs()
+        : GenericThreadStartArgs()
+        , request(0)
+        , view(0)
+        , frames()
+        , memoryBudget(0)
+        , abortInfo()
+    {
+    }
+
+    virtual ~ViewerPrefetcherStartArgs()
+    {
+    }
+};
+
+typedef boost::shared_ptr<ViewerPrefetcherStartArgs> ViewerPrefetcherStartArgsPtr;
+
+struct ViewerPrefetcherPrivate
+{
+    boost::weak_ptr<ViewerInstance> viewer;
+
+    // Protects all the members below
+    mutable QMutex lock;
+
+    // Incremented by each request and abort: the thread stops processing a request as soon as a more recent one is posted
+    U64 requestsCount;
+
+    // The request being processed and the frame being rendered, if any
+    ViewerPrefetcherStartArgsPtr currentRequest;
+    int currentFrame;
+
+    ViewerPrefetcherPrivate(const ViewerInstancePtr& viewer)
+        : viewer(viewer)
+        , lock()
+        , requestsCount(0)
+        , currentRequest()
+        , currentFrame(0)
+    {
+    }
+};
+
+ViewerPrefetcher::ViewerPrefetcher(const ViewerInstancePtr& viewer)
+    : GenericSchedulerThread()
+    , _imp( new ViewerPrefetcherPrivate(viewer) )
+{
+    setThreadName("ViewerPrefetcher");
+}
+
+ViewerPrefetcher::~ViewerPrefetcher()
+{
+}
+
+void
+ViewerPrefetcher::getFramesToPrefetch(int currentFrame,
+                                      int firstFrame,
+                                      int lastFrame,
+                                      int direction,
+                                      double framesPerSecond,
+                                      int step,
+                                      int maxFrames,
+                                      std::vector<int>* frames)
+{
+    frames->clear();
+    if ( (maxFrames <= 0) || (firstFrame > lastFrame) ) {
+        return;
+    }
+
+    const int forward = direction < 0 ? -1 : 1;
+
+    // A single seek far away says nothing about the next one: only space the frames while scrubbing
+    int spacing = 1;
+    if ( (framesPerSecond > 0.) && (step > 1) ) {
+        spacing = std::min(step, lastFrame - firstFrame + 1);
+    }
+
+    // Share the frames between both sides of the playhead. When the direction is known, favor the frames ahead,
+    // all the more that the user scrubs fast, but keep some behind for the user scrubbing back and forth.
+    double aheadRatio = 0.5;
+    if (direction != 0) {
+        aheadRatio = 0.625 + 0.25 * std::min(1., framesPerSecond / NATRON_VIEWER_PREFETCH_FULL_LOOKAHEAD_FPS);
+    }
+    const int aheadCount = std::min( maxFrames, (int)std::ceil(maxFrames * aheadRatio) );
+    const int behindCount = maxFrames - aheadCount;
+
+    int aheadIndex = 1;
+    int behindIndex = 1;
+    frames->reserve(maxFrames);
+    while ( (int)frames->size() < maxFrames ) {
+        int aheadFrame = currentFrame + forward * aheadIndex * spacing;
+        int behindFrame = currentFrame - forward * behindIndex * spacing;
+        bool aheadInRange = (aheadFrame >= firstFrame) && (aheadFrame <= lastFrame);
+        bool behindInRange = (behindFrame >= firstFrame) && (behindFrame <= lastFrame);
+        if (!aheadInRange && !behindInRange) {
+            break;
+        }
+
+        // When a side reaches the end of the range, the other side gets its share
+        bool aheadAllowed = aheadInRange && ( (aheadIndex <= aheadCount) || !behindInRange );
+        bool behindAllowed = behindInRange && ( (behindIndex <= behindCount) || !aheadInRange );
+
+        // Interleave both sides: the i-th frame of a side comes when (i - 1/2) / count of this side is the lowest,
+        // so that with 3 times more frames ahead than behind, a frame behind comes every 3 frames ahead.
+        bool takeAhead = aheadAllowed && ( !behindAllowed || ( (2 * aheadIndex - 1) * behindCount <= (2 * behindIndex - 1) * aheadCount ) );
+        if (takeAhead) {
+            frames->push_back(aheadFrame);
+            ++aheadIndex;
+        } else {
+            frames->push_back(behindFrame);
+            ++behindIndex;
+        }
+    }
+} // ViewerPrefetcher::getFramesToPrefetch
+
+void
+ViewerPrefetcher::schedulePrefetch()
+{
+    assert( QThread::currentThread() == qApp->thread() );
+
+    ViewerInstancePtr viewer = _imp->viewer.lock();
+    if ( !viewer || !viewer->getNode() || !viewer->isViewerUIVisible() || viewer->isDoingPartialUpdates() ) {
+        return;
+    }
+    SettingsPtr settings = appPTR->getCurrentSettings();
+    if ( !settings->isViewerPrefetchEnabled() || (settings->getNumberOfThreads() == -1) ) {
+        return;
+    }
+
+    ViewerPrefetcherStartArgsPtr args(new ViewerPrefetcherStartArgs);
+    args->memoryBudget = settings->getViewerPrefetchMemoryBudget();
+    if (args->memoryBudget == 0) {
+        return;
+    }
+    args->view = viewer->getRenderViewsCount() > 0 ? viewer->getCurrentView() : ViewIdx(0);
+
+    TimeLinePtr timeline = viewer->getTimeline();
+    int direction, step;
+    double framesPerSecond;
+    timeline->getScrubMotion(&direction, &framesPerSecond, &step);
+    int firstFrame, lastFrame;
+    viewer->getTimelineBounds(&firstFrame, &lastFrame);
+    getFramesToPrefetch(timeline->currentFrame(), firstFrame, lastFrame, direction, framesPerSecond, step, NATRON_VIEWER_PREFETCH_MAX_FRAMES, &args->frames);
+    if ( args->frames.empty() ) {
+        return;
+    }
+
+    // The abort info must be created on the main-thread, which handles the timer that it starts when aborted
+    args->abortInfo = AbortableRenderInfo::create(true /*canAbort*/, 0 /*age*/);
+    args->abortInfo->setPriority(eRenderPriorityPrefetch);
+
+    {
+        QMutexLocker k(&_imp->lock);
+        args->request = ++_imp->requestsCount;
+
+        // Keep rendering the current frame if it is still around the playhead, the thread will switch to this request after it.
+        if ( _imp->currentRequest && ( std::find(args->frames.begin(), args->frames.end(), _imp->currentFrame) == args->frames.end() ) ) {
+            _imp->currentRequest->abortInfo->setAborted();
+        }
+    }
+
+    startTask(args);
+} // ViewerPrefetcher::schedulePrefetch
+
+void
+ViewerPrefetcher::abortPrefetch()
+{
+    {
+        QMutexLocker k(&_imp->lock);
+        // Discard the requests that are already queued
+        ++_imp->requestsCount;
+    }
+    abortThreadedTask(false);
+}
+
+void
+ViewerPrefetcher::onAbortRequested(bool /*keepOldestRender*/)
+{
+    QMutexLocker k(&_imp->lock);
+
+    if (_imp->currentRequest) {
+        _imp->currentRequest->abortInfo->setAborted();
+    }
+}
+
+GenericSchedulerThread::TaskQueueBehaviorEnum
+ViewerPrefetcher::tasksQueueBehaviour() const
+{
+    return eTaskQueueBehaviorSkipToMostRecent;
+}
+
+GenericSchedulerThread::ThreadStateEnum
+ViewerPrefetcher::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
+{
+    ViewerPrefetcherStartArgsPtr args = boost::dynamic_pointer_cast<ViewerPrefetcherStartArgs>(inArgs);
+
+    assert(args);
+    ViewerInstancePtr viewer = _imp->viewer.lock();
+    if (!args || !viewer) {
+        return eThreadStateActive;
+    }
+
+    ThreadStateEnum state = eThreadStateActive;
+    U64 cachedBytes = 0;
+    for (std::vector<int>::const_iterator it = args->frames.begin(); it != args->frames.end(); ++it) {
+        state = resolveState();
+        if ( (state == eThreadStateAborted) || (state == eThreadStateStopped) ) {
+            break;
+        }
+        {
+            QMutexLocker k(&_imp->lock);
+            if ( (_imp->requestsCount != args->request) || args->abortInfo->isAborted() ) {
+                // A more recent request was posted or this one was aborted
+                break;
+            }
+            _imp->currentRequest = args;
+            _imp->currentFrame = *it;
+        }
+
+        std::size_t frameBytes = 0;
+        ViewerInstance::ViewerRenderRetCode stat;
+        try {
+            stat = viewer->prefetchFrame(*it, args->view, args->abortInfo, &frameBytes);
+        } catch (...) {
+            stat = ViewerInstance::eViewerRenderRetCodeFail;
+        }
+
+        {
+            QMutexLocker k(&_imp->lock);
+            _imp->currentRequest.reset();
+        }
+
+        // The other frames would most likely fail the same way, let the current frame render report the error
+        if (stat == ViewerInstance::eViewerRenderRetCodeFail) {
+            break;
+        }
+
+        // Frames that were already cached count too: they are part of what the budget keeps around the playhead
+        cachedBytes += frameBytes;
+        if (cachedBytes >= args->memoryBudget) {
+            break;
+        }
+    }
+
+    ///This thread is done, clean-up its TLS
+    appPTR->getAppTLS()->cleanupTLSForThread();
+
+    return state;
+} // ViewerPrefetcher::threadLoopOnce
+
+NATRON_NAMESPACE_EXIT;
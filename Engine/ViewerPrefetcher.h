@@ -0,0 +1,106 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_ViewerPrefetcher_h
+#define Engine_ViewerPrefetcher_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <vector>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Engine/GenericSchedulerThread.h"
+#include "Engine/EngineFwd.h"
+
+// The maximum number of frames rendered speculatively around the playhead, the memory budget usually stops the prefetch before
+#define NATRON_VIEWER_PREFETCH_MAX_FRAMES 64
+
+// Scrubbing velocity (in frames per second) above which the frames ahead of the playhead are favored the most
+#define NATRON_VIEWER_PREFETCH_FULL_LOOKAHEAD_FPS 24.
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Renders speculatively into the viewer cache the frames around the playhead that the viewer is likely to display next,
+ * so that scrubbing the timeline back and forth hits the cache.
+ * The frames are predicted from the direction and velocity of the scrubbing reported by the TimeLine, see getFramesToPrefetch().
+ * They are rendered one at a time in this thread with the eRenderPriorityPrefetch priority, so that they yield the thread pool to
+ * any other render, until the textures rendered reach the memory budget set in the preferences.
+ * A render is aborted as soon as its frame is no longer around the playhead or a parameter changes.
+ **/
+struct ViewerPrefetcherPrivate;
+class ViewerPrefetcher
+    : public GenericSchedulerThread
+{
+public:
+
+    ViewerPrefetcher(const ViewerInstancePtr& viewer);
+
+    virtual ~ViewerPrefetcher();
+
+    /**
+     * @brief Schedules the render of the frames around the current frame of the timeline.
+     * This should be called after each render request of the current frame. Must be called on the main-thread.
+     **/
+    void schedulePrefetch();
+
+    /**
+     * @brief Aborts the ongoing speculative render and discards the scheduled ones, e.g. because a parameter changed.
+     * This is not blocking.
+     **/
+    void abortPrefetch();
+
+    /**
+     * @brief Returns in frames the frames around currentFrame to render, in the order in which they are likely to be displayed.
+     * The frames in the scrubbing direction come first, and more of them are returned when scrubbing fast, but frames in the
+     * other direction are always returned too, for the user scrubbing back and forth. While scrubbing, the frames are spaced by
+     * the step between two seeks. currentFrame itself is not returned, nor frames outside of [firstFrame, lastFrame].
+     * @param direction The direction of the scrubbing (-1, 0 or 1), see TimeLine::getScrubMotion
+     * @param framesPerSecond The velocity of the scrubbing, 0 if the user is not scrubbing
+     * @param step The number of frames between the last two seeks
+     **/
+    static void getFramesToPrefetch(int currentFrame,
+                                    int firstFrame,
+                                    int lastFrame,
+                                    int direction,
+                                    double framesPerSecond,
+                                    int step,
+                                    int maxFrames,
+                                    std::vector<int>* frames);
+
+private:
+
+    virtual TaskQueueBehaviorEnum tasksQueueBehaviour() const OVERRIDE FINAL;
+    virtual ThreadStateEnum threadLoopOnce(const ThreadStartArgsPtr& inArgs) OVERRIDE FINAL WARN_UNUSED_RETURN;
+    virtual void onAbortRequested(bool keepOldestRender) OVERRIDE FINAL;
+
+    boost::scoped_ptr<ViewerPrefetcherPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_ViewerPrefetcher_h
@@ -491,6 +491,30 @@ enum StorageModeEnum
     eStorageModeGLTex //< will be allocated as an OpenGL texture
 };
 
+enum CacheEvictionPolicyEnum
+{
+    eCacheEvictionPolicyLRU = 0, //< evict the least recently used entries first
+    eCacheEvictionPolicyCostAware //< evict the entries with the lowest render time per byte first, aging with accesses
+};
+
+enum MipMapFilterEnum
+{
+    eMipMapFilterBox = 0, //< each level is the average of 2x2 pixels of the previous level
+    eMipMapFilterTent //< each level is filtered with the separable weights 1 3 3 1 over 4x4 pixels of the previous level
+};
+
+// The priority classes of the renders sharing the thread pool, from the most urgent to the least urgent
+enum RenderPriorityEnum
+{
+    eRenderPriorityInteractive = 0, //< viewer renders in response to a user interaction
+    eRenderPriorityPlayback, //< viewer playback
+    eRenderPriorityAnalysis, //< tracking and other analysis renders
+    eRenderPriorityBackground, //< renders on disk
+    eRenderPriorityPreview, //< node previews
+    eRenderPriorityPrefetch, //< speculative viewer renders of the frames around the playhead
+    eRenderPriorityCount
+};
+
 enum OrientationEnum
 {
     eOrientationHorizontal = 0x1,
@@ -97,6 +97,7 @@ namespace NATRON_PYTHON_NAMESPACE { }
 #define NATRON_PROJECT_FILE_EXT "ntp"
 #define NATRON_PROJECT_FILE_MIME_TYPE "application/vnd.natron.project"
 #define NATRON_PROJECT_UNTITLED "Untitled." NATRON_PROJECT_FILE_EXT
+#define NATRON_AUTOSAVE_JOURNAL_SUFFIX ".journal"
 #define NATRON_CACHE_FILE_EXT "ntc"
 #define NATRON_LAYOUT_FILE_EXT "nl"
 #define NATRON_LAYOUT_FILE_MIME_TYPE "application/vnd.natron.layout"
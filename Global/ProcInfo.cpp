@@ -22,6 +22,7 @@
 #include <sstream>
 #include <iostream>
 #include <cstring> // for std::memcpy, std::memset, std::strcmp
+#include <algorithm> // min, max
 
 
 #if defined(__NATRON_WIN32__)
@@ -31,9 +32,16 @@
 #ifdef __NATRON_UNIX__
 #include <unistd.h>
 #include <sys/stat.h>
+#include <sys/resource.h> // setpriority
+#include <cerrno>
+#endif
+
+#ifdef __NATRON_LINUX__
+#include <sched.h> // sched_setaffinity
 #endif
 
 #include <QtCore/QDir>
+#include <QtCore/QFile>
 #include <QtCore/QStringList>
 #include <QtCore/QDebug>
 
@@ -473,4 +481,183 @@ ProcInfo::checkIfProcessIsRunning(const char* /*processAbsoluteFilePath*/,
 #endif // if 0
 } // ProcInfo::checkIfProcessIsRunning
 
+int
+ProcInfo::getNUMANodesCount()
+{
+#ifdef __NATRON_LINUX__
+    QDir nodesDir( QString::fromUtf8("/sys/devices/system/node") );
+    QStringList entries = nodesDir.entryList(QStringList() << QString::fromUtf8("node*"), QDir::Dirs | QDir::NoDotAndDotDot);
+    int nNodes = 0;
+    Q_FOREACH(const QString &entry, entries) {
+        bool ok;
+        entry.mid(4).toInt(&ok);
+        if (ok) {
+            ++nNodes;
+        }
+    }
+
+    return nNodes > 0 ? nNodes : 1;
+#else
+
+    return 1;
+#endif
+}
+
+#ifdef __NATRON_LINUX__
+/**
+ * @brief Fills cpus with the CPUs of the given NUMA node and returns their count, or 0 if the node does not exist.
+ **/
+static int
+getNUMANodeCPUs(int node,
+                cpu_set_t* cpus)
+{
+    CPU_ZERO(cpus);
+    // The CPUs of the node are listed as ranges, e.g: 0-7,16-23
+    QFile cpuListFile( QString::fromUtf8("/sys/devices/system/node/node%1/cpulist").arg(node) );
+    if ( !cpuListFile.open(QIODevice::ReadOnly) ) {
+        return 0;
+    }
+    QStringList ranges = QString::fromUtf8( cpuListFile.readAll() ).trimmed().split( QLatin1Char(',') );
+    Q_FOREACH(const QString &range, ranges) {
+        if ( range.isEmpty() ) {
+            continue;
+        }
+        int dashPos = range.indexOf( QLatin1Char('-') );
+        bool firstOk, lastOk;
+        int first = ( dashPos == -1 ? range : range.left(dashPos) ).toInt(&firstOk);
+        int last = ( dashPos == -1 ? range : range.mid(dashPos + 1) ).toInt(&lastOk);
+        if (!firstOk || !lastOk) {
+            continue;
+        }
+        for (int i = first; i <= last && i < CPU_SETSIZE; ++i) {
+            CPU_SET(i, cpus);
+        }
+    }
+
+    return CPU_COUNT(cpus);
+}
+
+#endif
+
+int
+ProcInfo::getNUMANodeCPUsCount(int node)
+{
+#ifdef __NATRON_LINUX__
+    cpu_set_t cpus;
+
+    return getNUMANodeCPUs(node, &cpus);
+#else
+    Q_UNUSED(node);
+
+    return 0;
+#endif
+}
+
+bool
+ProcInfo::bindCurrentProcessToNUMANode(int node)
+{
+#ifdef __NATRON_LINUX__
+    cpu_set_t cpus;
+    if (getNUMANodeCPUs(node, &cpus) == 0) {
+        return false;
+    }
+
+    return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#else
+    Q_UNUSED(node);
+
+    return false;
+#endif
+}
+
+bool
+ProcInfo::setCurrentProcessPriority(int priority)
+{
+    priority = std::max( -20, std::min(priority, 19) );
+#if defined(__NATRON_WIN32__)
+    DWORD priorityClass;
+    if (priority <= -15) {
+        priorityClass = HIGH_PRIORITY_CLASS;
+    } else if (priority < 0) {
+        priorityClass = ABOVE_NORMAL_PRIORITY_CLASS;
+    } else if (priority == 0) {
+        priorityClass = NORMAL_PRIORITY_CLASS;
+    } else if (priority < 15) {
+        priorityClass = BELOW_NORMAL_PRIORITY_CLASS;
+    } else {
+        priorityClass = IDLE_PRIORITY_CLASS;
+    }
+
+    return SetPriorityClass(GetCurrentProcess(), priorityClass) != 0;
+#elif defined(__NATRON_LINUX__)
+    // On Linux the nice value is a per-thread attribute: PRIO_PROCESS with who = 0 only affects the calling thread.
+    // Apply it to every thread of the process. Threads created afterwards inherit it from their creator.
+    QDir tasksDir( QString::fromUtf8("/proc/self/task") );
+    QStringList tids = tasksDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    if ( tids.isEmpty() ) {
+        return setpriority(PRIO_PROCESS, 0, priority) == 0;
+    }
+    bool ret = true;
+    Q_FOREACH(const QString &tidStr, tids) {
+        bool ok;
+        int tid = tidStr.toInt(&ok);
+        if (!ok) {
+            continue;
+        }
+        // ESRCH: the thread exited in the meantime
+        if ( (setpriority(PRIO_PROCESS, tid, priority) != 0) && (errno != ESRCH) ) {
+            ret = false;
+        }
+    }
+
+    return ret;
+#elif defined(__NATRON_UNIX__)
+
+    return setpriority(PRIO_PROCESS, 0, priority) == 0;
+#else
+
+    return false;
+#endif
+}
+
+int
+ProcInfo::getCurrentProcessPriority()
+{
+#if defined(__NATRON_WIN32__)
+    switch ( GetPriorityClass( GetCurrentProcess() ) ) {
+    case HIGH_PRIORITY_CLASS:
+    case REALTIME_PRIORITY_CLASS:
+
+        return -15;
+    case ABOVE_NORMAL_PRIORITY_CLASS:
+
+        return -5;
+    case BELOW_NORMAL_PRIORITY_CLASS:
+
+        return 5;
+    case IDLE_PRIORITY_CLASS:
+
+        return 19;
+    default:
+
+        return 0;
+    }
+#elif defined(__NATRON_UNIX__)
+    // -1 is a valid priority, errno tells whether it failed
+    errno = 0;
+#if defined(__NATRON_LINUX__)
+    // The nice value is per-thread on Linux: report the one of the main thread, whose id is the process id,
+    // rather than the one of the calling thread
+    int priority = getpriority( PRIO_PROCESS, getpid() );
+#else
+    int priority = getpriority(PRIO_PROCESS, 0);
+#endif
+
+    return errno == 0 ? priority : 0;
+#else
+
+    return 0;
+#endif
+}
+
 NATRON_NAMESPACE_EXIT;
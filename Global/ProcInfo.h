@@ -48,6 +48,38 @@ QString applicationDirPath(const char* argv0Param);
  **/
 bool checkIfProcessIsRunning(const char* processAbsoluteFilePath, Q_PID pid);
 
+/**
+ * @brief Returns the number of NUMA nodes of the machine, or 1 if it cannot be determined.
+ **/
+int getNUMANodesCount();
+
+/**
+ * @brief Returns the number of CPUs of the given NUMA node, or 0 if not supported on this platform or if the node does not exist.
+ **/
+int getNUMANodeCPUsCount(int node);
+
+/**
+ * @brief Restricts the calling thread, and the threads it creates afterwards, to the CPUs of the given NUMA node.
+ * Memory is then allocated on that node by the default first-touch policy of the system.
+ * This should be called early, before any thread pool is created.
+ * Returns false if not supported on this platform or if the node does not exist.
+ **/
+bool bindCurrentProcessToNUMANode(int node);
+
+/**
+ * @brief Changes the scheduling priority of the current process. priority is a nice value between -20 (highest) and 19 (lowest).
+ * On Windows it is mapped to the closest priority class. On Linux, where the priority is per-thread, it is applied
+ * to all threads of the process.
+ * Returns false if the priority could not be changed, e.g. raising it without the required privileges.
+ **/
+bool setCurrentProcessPriority(int priority);
+
+/**
+ * @brief Returns the scheduling priority of the current process as a nice value, see setCurrentProcessPriority().
+ * On Linux this is the priority of the main thread.
+ **/
+int getCurrentProcessPriority();
+
 #ifdef Q_OS_MAC
 QString applicationFileName_mac();
 #endif
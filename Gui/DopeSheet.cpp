@@ -996,6 +996,47 @@ DopeSheet::onKeyframeSetOrRemoved()
 
 ////////////////////////// DSKnob //////////////////////////
 
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+void
+addKeyFramesSnapshot(const KnobGuiPtr& knobGui,
+                     int dimension,
+                     std::vector<KeyFramesSnapshotPtr>* snapshots)
+{
+    CurvePtr curve = knobGui->getCurve(ViewIdx(0), dimension);
+
+    if (curve) {
+        snapshots->push_back( curve->getKeyFramesSnapshot() );
+    }
+}
+
+/*
+ * Gathers in keyTimes the sorted times of the keyframes of the snapshots, unless they are the ones keyTimes
+ * was already gathered from: a curve makes a new snapshot only when it changes, and the cached snapshots
+ * are kept alive so that a new one cannot be allocated at the same address.
+ */
+void
+refreshKeyTimes(const std::vector<KeyFramesSnapshotPtr>& snapshots,
+                std::vector<KeyFramesSnapshotPtr>* cachedSnapshots,
+                std::vector<double>* keyTimes)
+{
+    if (snapshots == *cachedSnapshots) {
+        return;
+    }
+    keyTimes->clear();
+    for (std::vector<KeyFramesSnapshotPtr>::const_iterator it = snapshots.begin(); it != snapshots.end(); ++it) {
+        for (KeyFramesSnapshot::const_iterator kIt = (*it)->begin(); kIt != (*it)->end(); ++kIt) {
+            keyTimes->push_back( kIt->getTime() );
+        }
+    }
+    std::sort( keyTimes->begin(), keyTimes->end() );
+    keyTimes->erase( std::unique( keyTimes->begin(), keyTimes->end() ), keyTimes->end() );
+    *cachedSnapshots = snapshots;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
 class DSKnobPrivate
 {
 public:
@@ -1007,13 +1048,19 @@ public:
     QTreeWidgetItem *nameItem;
     KnobGuiWPtr knobGui;
     KnobIWPtr knob;
+
+    // The snapshots keyTimes was gathered from
+    mutable std::vector<KeyFramesSnapshotPtr> keyTimesSnapshots;
+    mutable std::vector<double> keyTimes;
 };
 
 DSKnobPrivate::DSKnobPrivate()
     : dimension(-2),
     nameItem(0),
     knobGui(),
-    knob()
+    knob(),
+    keyTimesSnapshots(),
+    keyTimes()
 {}
 
 DSKnobPrivate::~DSKnobPrivate()
@@ -1118,6 +1165,27 @@ DSKnob::getDimension() const
     return _imp->dimension;
 }
 
+const std::vector<double>&
+DSKnob::getKeyTimes() const
+{
+    KnobGuiPtr knobGui = getKnobGui();
+    std::vector<KeyFramesSnapshotPtr> snapshots;
+
+    if (knobGui) {
+        if ( isMultiDimRoot() ) {
+            int nDims = knobGui->getKnob()->getDimension();
+            for (int i = 0; i < nDims; ++i) {
+                addKeyFramesSnapshot(knobGui, i, &snapshots);
+            }
+        } else {
+            addKeyFramesSnapshot(knobGui, _imp->dimension, &snapshots);
+        }
+    }
+    refreshKeyTimes(snapshots, &_imp->keyTimesSnapshots, &_imp->keyTimes);
+
+    return _imp->keyTimes;
+}
+
 ////////////////////////// DopeSheetSelectionModel //////////////////////////
 
 class DopeSheetSelectionModelPrivate
@@ -1343,6 +1411,17 @@ DopeSheetSelectionModel::keyframeIsSelected(const DSKnobPtr &dsKnob,
     return false;
 }
 
+void
+DopeSheetSelectionModel::getSelectedKeyframeTimes(std::map<const DSKnob *, std::set<double> >* times) const
+{
+    for (DSKeyPtrList::const_iterator it = _imp->selectedKeyframes.begin(); it != _imp->selectedKeyframes.end(); ++it) {
+        DSKnobPtr knobContext = (*it)->context.lock();
+        if (knobContext) {
+            (*times)[knobContext.get()].insert( (*it)->key.getTime() );
+        }
+    }
+}
+
 std::list<boost::weak_ptr<DSNode> >::iterator
 DopeSheetSelectionModel::isRangeNodeSelected(const DSNodePtr& node)
 {
@@ -1422,6 +1501,10 @@ public:
     QTreeWidgetItem *nameItem;
     DSTreeItemKnobMap itemKnobMap;
     bool isSelected;
+
+    // The snapshots keyTimes was gathered from
+    mutable std::vector<KeyFramesSnapshotPtr> keyTimesSnapshots;
+    mutable std::vector<double> keyTimes;
 };
 
 DSNodePrivate::DSNodePrivate()
@@ -1430,7 +1513,9 @@ DSNodePrivate::DSNodePrivate()
     nodeGui(),
     nameItem(0),
     itemKnobMap(),
-    isSelected(false)
+    isSelected(false),
+    keyTimesSnapshots(),
+    keyTimes()
 {}
 
 DSNodePrivate::~DSNodePrivate()
@@ -1581,6 +1666,26 @@ DSNode::getItemKnobMap() const
     return _imp->itemKnobMap;
 }
 
+const std::vector<double>&
+DSNode::getKeyTimes() const
+{
+    std::vector<KeyFramesSnapshotPtr> snapshots;
+
+    for (DSTreeItemKnobMap::const_iterator it = _imp->itemKnobMap.begin(); it != _imp->itemKnobMap.end(); ++it) {
+        // The root contexts of multidim knobs would only add the keyframes of their dimensions again
+        if ( it->second->isMultiDimRoot() ) {
+            continue;
+        }
+        KnobGuiPtr knobGui = it->second->getKnobGui();
+        if (knobGui) {
+            addKeyFramesSnapshot(knobGui, it->second->getDimension(), &snapshots);
+        }
+    }
+    refreshKeyTimes(snapshots, &_imp->keyTimesSnapshots, &_imp->keyTimes);
+
+    return _imp->keyTimes;
+}
+
 DopeSheetItemType
 DSNode::getItemType() const
 {
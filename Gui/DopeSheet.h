@@ -27,6 +27,10 @@
 
 #include "Global/Macros.h"
 
+#include <map>
+#include <set>
+#include <vector>
+
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
@@ -144,6 +148,12 @@ public:
 
     const DSTreeItemKnobMap& getItemKnobMap() const;
 
+    /**
+     * @brief Returns the sorted times of the keyframes of all the knobs of the node, drawn in the node row.
+     * They are only gathered again when one of the curves changed.
+     **/
+    const std::vector<double>& getKeyTimes() const;
+
     DopeSheetItemType getItemType() const;
 
     bool isTimeNode() const;
@@ -233,6 +243,12 @@ public:
     bool isMultiDimRoot() const;
     int getDimension() const;
 
+    /**
+     * @brief Returns the sorted times of the keyframes of the dimension of this context, or of all the
+     * dimensions for the root context of a multidim knob. They are only gathered again when a curve changed.
+     **/
+    const std::vector<double>& getKeyTimes() const;
+
 private:
     boost::scoped_ptr<DSKnobPrivate> _imp;
 };
@@ -452,6 +468,12 @@ public:
 
     bool keyframeIsSelected(const DSKnobPtr &dsKnob, const KeyFrame &keyframe) const;
 
+    /**
+     * @brief Returns the times of the selected keyframes of each knob context, so that many keyframes can be
+     * tested without going through the whole selection for each of them.
+     **/
+    void getSelectedKeyframeTimes(std::map<const DSKnob *, std::set<double> >* times) const;
+
     DSKeyPtrList::iterator keyframeIsSelected(const DopeSheetKey &key) const;
 
     bool rangeIsSelected(const DSNodePtr& node) const;
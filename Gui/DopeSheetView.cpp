@@ -26,7 +26,9 @@
 
 #include <algorithm> // min, max
 #include <limits>
+#include <set>
 #include <stdexcept>
+#include <vector>
 
 // Qt includes
 #include <QApplication>
@@ -217,6 +219,13 @@ public:
     void drawRange(const DSNodePtr &dsNode) const;
     void drawKeyframes(const DSNodePtr &dsNode) const;
 
+    void drawMasterKeyframes(const std::vector<double>& keyTimes,
+                             const std::set<double>& selectedTimes,
+                             double rowCenterY,
+                             bool drawSelectedTime,
+                             double selectedTime,
+                             const QColor& textColor) const;
+
     void drawTexturedKeyframe(DopeSheetViewPrivate::KeyframeTexture textureType,
                               bool drawTime,
                               double time,
@@ -696,13 +705,17 @@ std::vector<DopeSheetKey> DopeSheetViewPrivate::isNearByKeyframe(const DSKnobPtr
         endDim = dim + 1;
     }
 
+    // Only the keyframes around the mouse need to be tested
+    double leftTime = zoomContext.toZoomCoordinates(widgetCoords.x() - DISTANCE_ACCEPTANCE_FROM_KEYFRAME, 0).x();
+    double rightTime = zoomContext.toZoomCoordinates(widgetCoords.x() + DISTANCE_ACCEPTANCE_FROM_KEYFRAME, 0).x();
+
     for (int i = startDim; i < endDim; ++i) {
-        KeyFrameSet keyframes = knob->getCurve(ViewIdx(0), i)->getKeyFrames_mt_safe();
+        KeyFramesSnapshotPtr keyframes = knob->getCurve(ViewIdx(0), i)->getKeyFramesSnapshot();
+        KeyFramesSnapshot::const_iterator first, last;
+        keyframes->getKeyFramesInRange(leftTime, rightTime, &first, &last);
 
-        for (KeyFrameSet::const_iterator kIt = keyframes.begin();
-             kIt != keyframes.end();
-             ++kIt) {
-            KeyFrame kf = (*kIt);
+        for (KeyFramesSnapshot::const_iterator kIt = first; kIt != last; ++kIt) {
+            const KeyFrame& kf = (*kIt);
             QPointF keyframeWidgetPos = zoomContext.toWidgetCoordinates(kf.getTime(), 0);
 
             if (std::abs( widgetCoords.x() - keyframeWidgetPos.x() ) < DISTANCE_ACCEPTANCE_FROM_KEYFRAME) {
@@ -727,6 +740,9 @@ std::vector<DopeSheetKey> DopeSheetViewPrivate::isNearByKeyframe(DSNodePtr dsNod
 {
     std::vector<DopeSheetKey> ret;
     const DSTreeItemKnobMap& dsKnobs = dsNode->getItemKnobMap();
+    // Only the keyframes around the mouse need to be tested
+    double leftTime = zoomContext.toZoomCoordinates(widgetCoords.x() - DISTANCE_ACCEPTANCE_FROM_KEYFRAME, 0).x();
+    double rightTime = zoomContext.toZoomCoordinates(widgetCoords.x() + DISTANCE_ACCEPTANCE_FROM_KEYFRAME, 0).x();
 
     for (DSTreeItemKnobMap::const_iterator it = dsKnobs.begin(); it != dsKnobs.end(); ++it) {
         DSKnobPtr dsKnob = (*it).second;
@@ -738,12 +754,12 @@ std::vector<DopeSheetKey> DopeSheetViewPrivate::isNearByKeyframe(DSNodePtr dsNod
             continue;
         }
 
-        KeyFrameSet keyframes = knobGui->getCurve(ViewIdx(0), dim)->getKeyFrames_mt_safe();
+        KeyFramesSnapshotPtr keyframes = knobGui->getCurve(ViewIdx(0), dim)->getKeyFramesSnapshot();
+        KeyFramesSnapshot::const_iterator first, last;
+        keyframes->getKeyFramesInRange(leftTime, rightTime, &first, &last);
 
-        for (KeyFrameSet::const_iterator kIt = keyframes.begin();
-             kIt != keyframes.end();
-             ++kIt) {
-            KeyFrame kf = (*kIt);
+        for (KeyFramesSnapshot::const_iterator kIt = first; kIt != last; ++kIt) {
+            const KeyFrame& kf = (*kIt);
             QPointF keyframeWidgetPos = zoomContext.toWidgetCoordinates(kf.getTime(), 0);
 
             if (std::abs( widgetCoords.x() - keyframeWidgetPos.x() ) < DISTANCE_ACCEPTANCE_FROM_KEYFRAME) {
@@ -1275,8 +1291,16 @@ DopeSheetViewPrivate::drawKeyframes(const DSNodePtr &dsNode) const
         const DSTreeItemKnobMap& knobItems = dsNode->getItemKnobMap();
         double kfTimeSelected;
         int hasSingleKfTimeSelected = model->getSelectionModel()->hasSingleKeyFrameTimeSelected(&kfTimeSelected);
-        std::map<double, bool> nodeKeytimes;
-        std::map<DSKnob *, std::map<double, bool> > knobsKeytimes;
+        std::map<const DSKnob *, std::set<double> > selectedTimes;
+        model->getSelectionModel()->getSelectedKeyframeTimes(&selectedTimes);
+
+        // The times of the selected keyframes of each knob and of the node, drawn selected in their rows
+        std::set<double> nodeSelectedTimes;
+        std::map<const DSKnob *, std::set<double> > knobsSelectedTimes;
+
+        // Only the keyframes in the visible range are drawn
+        double leftTime = zoomContext.left();
+        double rightTime = zoomContext.right();
 
         for (DSTreeItemKnobMap::const_iterator it = knobItems.begin();
              it != knobItems.end();
@@ -1295,121 +1319,103 @@ DopeSheetViewPrivate::drawKeyframes(const DSNodePtr &dsNode) const
                 continue;
             }
 
-            KeyFrameSet keyframes = dsKnob->getKnobGui()->getCurve(ViewIdx(0), dim)->getKeyFrames_mt_safe();
-
-            for (KeyFrameSet::const_iterator kIt = keyframes.begin();
-                 kIt != keyframes.end();
-                 ++kIt) {
-                KeyFrame kf = (*kIt);
-                double keyTime = kf.getTime();
-
-                // Clip keyframes horizontally //TODO Clip vertically too
-                if ( ( keyTime < zoomContext.left() ) || ( keyTime > zoomContext.right() ) ) {
-                    continue;
+            std::map<const DSKnob *, std::set<double> >::const_iterator foundSelected = selectedTimes.find( dsKnob.get() );
+            if ( foundSelected != selectedTimes.end() ) {
+                nodeSelectedTimes.insert( foundSelected->second.begin(), foundSelected->second.end() );
+                DSKnobPtr rootDSKnob = model->mapNameItemToDSKnob( knobTreeItem->parent() );
+                if (rootDSKnob) {
+                    knobsSelectedTimes[rootDSKnob.get()].insert( foundSelected->second.begin(), foundSelected->second.end() );
                 }
+            }
 
-                double rowCenterYWidget = hierarchyView->visualItemRect( dsKnob->getTreeItem() ).center().y();
-                RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(keyTime, rowCenterYWidget);
-                bool kfSelected = model->getSelectionModel()->keyframeIsSelected(dsKnob, kf);
-
-                // Draw keyframe in the knob dim row only if it's visible
-                bool drawInDimRow = hierarchyView->itemIsVisibleFromOutside(knobTreeItem);
-
-                if (drawInDimRow) {
-                    DopeSheetViewPrivate::KeyframeTexture texType = kfTextureFromKeyframeType( kf.getInterpolation(),
-                                                                                               kfSelected || selectionRect.intersects(zoomKfRect) );
+            // Draw keyframe in the knob dim row only if it's visible
+            bool drawInDimRow = hierarchyView->itemIsVisibleFromOutside(knobTreeItem);
+            if (!drawInDimRow) {
+                continue;
+            }
 
-                    if (texType != DopeSheetViewPrivate::kfTextureNone) {
-                        drawTexturedKeyframe(texType, hasSingleKfTimeSelected && kfSelected,
-                                             kfTimeSelected, selectionColor, zoomKfRect);
-                    }
-                }
+            CurvePtr curve = dsKnob->getKnobGui()->getCurve(ViewIdx(0), dim);
+            if (!curve) {
+                continue;
+            }
 
-                // Fill the knob times map
-                {
-                    DSKnobPtr rootDSKnob = model->mapNameItemToDSKnob( knobTreeItem->parent() );
-                    if (rootDSKnob) {
-                        assert(rootDSKnob);
-                        const std::map<double, bool>& map = knobsKeytimes[rootDSKnob.get()];
-                        bool knobTimeExists = ( map.find(keyTime) != map.end() );
-
-                        if (!knobTimeExists) {
-                            knobsKeytimes[rootDSKnob.get()][keyTime] = kfSelected;
-                        } else {
-                            bool knobTimeIsSelected = knobsKeytimes[rootDSKnob.get()][keyTime];
-
-                            if (!knobTimeIsSelected && kfSelected) {
-                                knobsKeytimes[rootDSKnob.get()][keyTime] = true;
-                            }
-                        }
-                    }
-                }
+            // Clip keyframes horizontally //TODO Clip vertically too
+            KeyFramesSnapshotPtr keyframes = curve->getKeyFramesSnapshot();
+            KeyFramesSnapshot::const_iterator first, last;
+            keyframes->getKeyFramesInRange(leftTime, rightTime, &first, &last);
 
-                // Fill the node times map
-                bool nodeTimeExists = ( nodeKeytimes.find(keyTime) != nodeKeytimes.end() );
+            double rowCenterYWidget = hierarchyView->visualItemRect(knobTreeItem).center().y();
 
-                if (!nodeTimeExists) {
-                    nodeKeytimes[keyTime] = kfSelected;
-                } else {
-                    bool nodeTimeIsSelected = nodeKeytimes[keyTime];
+            for (KeyFramesSnapshot::const_iterator kIt = first; kIt != last; ++kIt) {
+                const KeyFrame& kf = (*kIt);
+                double keyTime = kf.getTime();
+                RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(keyTime, rowCenterYWidget);
+                bool kfSelected = foundSelected != selectedTimes.end() && foundSelected->second.count(keyTime);
+                DopeSheetViewPrivate::KeyframeTexture texType = kfTextureFromKeyframeType( kf.getInterpolation(),
+                                                                                           kfSelected || selectionRect.intersects(zoomKfRect) );
 
-                    if (!nodeTimeIsSelected && kfSelected) {
-                        nodeKeytimes[keyTime] = true;
-                    }
+                if (texType != DopeSheetViewPrivate::kfTextureNone) {
+                    drawTexturedKeyframe(texType, hasSingleKfTimeSelected && kfSelected,
+                                         kfTimeSelected, selectionColor, zoomKfRect);
                 }
             }
         }
 
         // Draw master keys in knob root section
-        for (std::map<DSKnob *, std::map<double, bool> >::const_iterator it = knobsKeytimes.begin();
-             it != knobsKeytimes.end();
+        for (DSTreeItemKnobMap::const_iterator it = knobItems.begin();
+             it != knobItems.end();
              ++it) {
-            QTreeWidgetItem *knobRootItem = (*it).first->getTreeItem();
-            std::map<double, bool> knobTimes = (*it).second;
-
-            for (std::map<double, bool>::const_iterator mIt = knobTimes.begin();
-                 mIt != knobTimes.end();
-                 ++mIt) {
-                double time = (*mIt).first;
-                bool drawSelected = (*mIt).second;
-                bool drawInKnobRootRow = hierarchyView->itemIsVisibleFromOutside(knobRootItem);
-
-                if (drawInKnobRootRow) {
-                    double newCenterY = hierarchyView->visualItemRect(knobRootItem).center().y();
-                    RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(time, newCenterY);
-                    DopeSheetViewPrivate::KeyframeTexture textureType = (drawSelected)
-                                                                        ? DopeSheetViewPrivate::kfTextureMasterSelected
-                                                                        : DopeSheetViewPrivate::kfTextureMaster;
-
-                    drawTexturedKeyframe(textureType, hasSingleKfTimeSelected && drawSelected,
-                                         kfTimeSelected, selectionColor, zoomKfRect);
-                }
+            DSKnobPtr dsKnob = (*it).second;
+            QTreeWidgetItem *knobRootItem = dsKnob->getTreeItem();
+
+            if ( !dsKnob->isMultiDimRoot() || knobRootItem->isHidden() || !hierarchyView->itemIsVisibleFromOutside(knobRootItem) ) {
+                continue;
             }
+
+            const std::set<double>& knobSelectedTimes = knobsSelectedTimes[dsKnob.get()];
+            double newCenterY = hierarchyView->visualItemRect(knobRootItem).center().y();
+            drawMasterKeyframes(dsKnob->getKeyTimes(), knobSelectedTimes, newCenterY, hasSingleKfTimeSelected, kfTimeSelected, selectionColor);
         }
 
         // Draw master keys in node section
-        for (std::map<double, bool>::const_iterator it = nodeKeytimes.begin();
-             it != nodeKeytimes.end();
-             ++it) {
-            double time = (*it).first;
-            bool drawSelected = (*it).second;
-            QTreeWidgetItem *nodeItem = dsNode->getTreeItem();
-            bool drawInNodeRow = hierarchyView->itemIsVisibleFromOutside(nodeItem);
-
-            if (drawInNodeRow) {
-                double newCenterY = hierarchyView->visualItemRect(nodeItem).center().y();
-                RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(time, newCenterY);
-                DopeSheetViewPrivate::KeyframeTexture textureType = (drawSelected)
-                                                                    ? DopeSheetViewPrivate::kfTextureMasterSelected
-                                                                    : DopeSheetViewPrivate::kfTextureMaster;
-
-                drawTexturedKeyframe(textureType, hasSingleKfTimeSelected && drawSelected,
-                                     kfTimeSelected, selectionColor, zoomKfRect);
-            }
+        QTreeWidgetItem *nodeItem = dsNode->getTreeItem();
+        bool drawInNodeRow = hierarchyView->itemIsVisibleFromOutside(nodeItem);
+
+        if (drawInNodeRow) {
+            double newCenterY = hierarchyView->visualItemRect(nodeItem).center().y();
+            drawMasterKeyframes(dsNode->getKeyTimes(), nodeSelectedTimes, newCenterY, hasSingleKfTimeSelected, kfTimeSelected, selectionColor);
         }
     }
 } // DopeSheetViewPrivate::drawKeyframes
 
+/**
+ * @brief DopeSheetViewPrivate::drawMasterKeyframes
+ *
+ * Draws the master keyframes at the given sorted times which are in the visible range, in the row centered on rowCenterY.
+ */
+void
+DopeSheetViewPrivate::drawMasterKeyframes(const std::vector<double>& keyTimes,
+                                          const std::set<double>& selectedTimes,
+                                          double rowCenterY,
+                                          bool drawSelectedTime,
+                                          double selectedTime,
+                                          const QColor& textColor) const
+{
+    std::vector<double>::const_iterator first = std::lower_bound( keyTimes.begin(), keyTimes.end(), zoomContext.left() );
+    std::vector<double>::const_iterator last = std::upper_bound( first, keyTimes.end(), zoomContext.right() );
+
+    for (std::vector<double>::const_iterator it = first; it != last; ++it) {
+        bool drawSelected = selectedTimes.find(*it) != selectedTimes.end();
+        RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(*it, rowCenterY);
+        DopeSheetViewPrivate::KeyframeTexture textureType = (drawSelected)
+                                                            ? DopeSheetViewPrivate::kfTextureMasterSelected
+                                                            : DopeSheetViewPrivate::kfTextureMaster;
+
+        drawTexturedKeyframe(textureType, drawSelectedTime && drawSelected,
+                             selectedTime, textColor, zoomKfRect);
+    }
+}
+
 void
 DopeSheetViewPrivate::drawTexturedKeyframe(DopeSheetViewPrivate::KeyframeTexture textureType,
                                            bool drawTime,
@@ -2127,14 +2133,14 @@ DopeSheetViewPrivate::computeGroupRange(const DSNodePtr& group)
                 continue;
             } else {
                 for (int i = 0; i < knob->getDimension(); ++i) {
-                    KeyFrameSet keyframes = knob->getCurve(ViewIdx(0), i)->getKeyFrames_mt_safe();
+                    KeyFramesSnapshotPtr keyframes = knob->getCurve(ViewIdx(0), i)->getKeyFramesSnapshot();
 
-                    if ( keyframes.empty() ) {
+                    if ( keyframes->empty() ) {
                         continue;
                     }
 
-                    times.insert( keyframes.begin()->getTime() );
-                    times.insert( keyframes.rbegin()->getTime() );
+                    times.insert( keyframes->getKeyFrames().front().getTime() );
+                    times.insert( keyframes->getKeyFrames().back().getTime() );
                 }
             }
         }
@@ -2299,13 +2305,15 @@ DopeSheetViewPrivate::createSelectionFromRect(const RectD &zoomCoordsRect,
                 continue;
             }
 
-            KeyFrameSet keyframes = dsKnob->getKnobGui()->getCurve(ViewIdx(0), dim)->getKeyFrames_mt_safe();
+            KeyFramesSnapshotPtr keyframes = dsKnob->getKnobGui()->getCurve(ViewIdx(0), dim)->getKeyFramesSnapshot();
+            double y = hierarchyView->visualItemRect( dsKnob->getTreeItem() ).center().y();
+            // Only the keyframes whose bounding rect may intersect the selection rectangle need to be tested
+            double keyWidth = getKeyFrameBoundingRectZoomCoords(0, y).width();
+            KeyFramesSnapshot::const_iterator first, last;
+            keyframes->getKeyFramesInRange(zoomCoordsRect.x1 - keyWidth, zoomCoordsRect.x2 + keyWidth, &first, &last);
 
-            for (KeyFrameSet::const_iterator kIt = keyframes.begin();
-                 kIt != keyframes.end();
-                 ++kIt) {
-                KeyFrame kf = (*kIt);
-                double y = hierarchyView->visualItemRect( dsKnob->getTreeItem() ).center().y();
+            for (KeyFramesSnapshot::const_iterator kIt = first; kIt != last; ++kIt) {
+                const KeyFrame& kf = (*kIt);
                 RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(kf.getTime(), y);
 
                 if ( zoomCoordsRect.intersects(zoomKfRect) ) {
@@ -2606,14 +2614,14 @@ std::pair<double, double> DopeSheetView::getKeyframeRange() const
             const DSKnobPtr& dsKnob = (*itKnob).second;
 
             for (int i = 0; i < dsKnob->getKnobGui()->getKnob()->getDimension(); ++i) {
-                KeyFrameSet keyframes = dsKnob->getKnobGui()->getCurve(ViewIdx(0), i)->getKeyFrames_mt_safe();
+                KeyFramesSnapshotPtr keyframes = dsKnob->getKnobGui()->getCurve(ViewIdx(0), i)->getKeyFramesSnapshot();
 
-                if ( keyframes.empty() ) {
+                if ( keyframes->empty() ) {
                     continue;
                 }
 
-                dimFirstKeys.push_back( keyframes.begin()->getTime() );
-                dimLastKeys.push_back( keyframes.rbegin()->getTime() );
+                dimFirstKeys.push_back( keyframes->getKeyFrames().front().getTime() );
+                dimLastKeys.push_back( keyframes->getKeyFrames().back().getTime() );
             }
         }
 
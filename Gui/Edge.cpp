@@ -84,6 +84,9 @@ struct EdgePrivate
     bool isMask;
     QPointF middlePoint; //updated only when dest && source are valid
 
+    // The graph whose spatial index holds the edge, see Edge::refreshSpatialIndex()
+    NodeGraph* graph;
+
 
     EdgePrivate(Edge* publicInterface,
                 int inputNb,
@@ -107,6 +110,7 @@ struct EdgePrivate
         , enoughSpaceToShowLabel(true)
         , isMask(false)
         , middlePoint()
+        , graph(NULL)
     {
     }
 
@@ -170,6 +174,10 @@ Edge::Edge(const NodeGuiPtr & src,
 
 Edge::~Edge()
 {
+    if (_imp->graph) {
+        _imp->graph->removeEdgeFromSpatialIndex(this);
+    }
+
     NodeGuiPtr dst = _imp->dest.lock();
 
     if (dst) {
@@ -595,8 +603,42 @@ Edge::initLine()
 
     _imp->arrowHead.clear();
     _imp->arrowHead << arrowIntersect << arrowP1 << arrowP2;
+
+    refreshSpatialIndex();
 } // initLine
 
+QRectF
+Edge::boundingRectWithArrowHead() const
+{
+    return boundingRect() | _imp->arrowHead.boundingRect() | childrenBoundingRect();
+}
+
+void
+Edge::discardGraphPointer()
+{
+    _imp->graph = NULL;
+}
+
+void
+Edge::refreshSpatialIndex()
+{
+    NodeGuiPtr node = _imp->dest.lock();
+
+    if (!node) {
+        node = _imp->source.lock();
+    }
+    NodeGraph* graph = node ? node->getDagGui() : NULL;
+    if (graph != _imp->graph) {
+        if (_imp->graph) {
+            _imp->graph->removeEdgeFromSpatialIndex(this);
+        }
+        _imp->graph = graph;
+    }
+    if (graph) {
+        graph->refreshEdgeInSpatialIndex(this);
+    }
+}
+
 QPainterPath
 Edge::shape() const
 {
@@ -677,6 +719,7 @@ Edge::dragSource(const QPointF & src)
     if (_imp->label) {
         _imp->label->setPos( QPointF( ( ( line().p1().x() + src.x() ) / 2. ) - 5, ( ( line().p1().y() + src.y() ) / 2. ) - 5 ) );
     }
+    refreshSpatialIndex();
 }
 
 void
@@ -696,6 +739,7 @@ Edge::dragDest(const QPointF & dst)
                                             std::sin(a - ARROW_HEAD_ANGLE / 2) * arrowSize);
     _imp->arrowHead.clear();
     _imp->arrowHead << line().p1() << arrowP1 << arrowP2;
+    refreshSpatialIndex();
 }
 
 void
@@ -766,6 +810,11 @@ Edge::paint(QPainter *painter,
 
     painter->drawLine( line() );
 
+    if ( _imp->graph && _imp->graph->isLowLevelOfDetail() ) {
+        // The arrow head and the bend point would only be a few pixels wide
+        return;
+    }
+
     myPen.setStyle(Qt::SolidLine);
     painter->setPen(myPen);
 
@@ -120,9 +120,22 @@ public:
 
     bool computeVisibility(bool hovered) const;
 
+    /**
+     * @brief The bounding rectangle of the line, its arrow head and its label, in item coordinates.
+     **/
+    QRectF boundingRectWithArrowHead() const;
+
+    /**
+     * @brief Called when the graph of the edge is destroyed: the edge no longer updates its spatial index.
+     **/
+    void discardGraphPointer();
+
 private:
 
     virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *options, QWidget *parent = 0) OVERRIDE FINAL;
+
+    void refreshSpatialIndex();
+
     boost::scoped_ptr<EdgePrivate> _imp;
 };
 
@@ -303,6 +303,7 @@ HEADERS += \
     NodeCreationDialog.h \
     NodeGraph.h \
     NodeGraphPrivate.h \
+    NodeGraphSpatialIndex.h \
     NodeGraphTextItem.h \
     NodeGraphRectItem.h \
     NodeGraphUndoRedo.h \
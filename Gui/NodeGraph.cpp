@@ -213,6 +213,46 @@ NodeGraph::isDoingNavigatorRender() const
     return _imp->isDoingPreviewRender;
 }
 
+bool
+NodeGraph::isLowLevelOfDetail() const
+{
+    return _imp->lowLevelOfDetail;
+}
+
+void
+NodeGraph::refreshNodeInSpatialIndex(NodeGui* node)
+{
+    assert(node);
+    QRectF bbox = node->boundingRect() | node->childrenBoundingRect();
+    _imp->nodesIndex.insert( node, node->mapRectToItem(_imp->_nodeRoot, bbox) );
+}
+
+void
+NodeGraph::refreshEdgeInSpatialIndex(Edge* edge)
+{
+    assert(edge);
+    _imp->edgesIndex.insert( edge, edge->mapRectToItem( _imp->_nodeRoot, edge->boundingRectWithArrowHead() ) );
+}
+
+void
+NodeGraph::removeNodeFromSpatialIndex(NodeGui* node)
+{
+    _imp->nodesIndex.remove(node);
+}
+
+void
+NodeGraph::removeEdgeFromSpatialIndex(Edge* edge)
+{
+    _imp->edgesIndex.remove(edge);
+}
+
+void
+NodeGraph::getNodesIntersecting(const QRectF& rect,
+                                std::set<NodeGui*>* nodes) const
+{
+    _imp->nodesIndex.getItemsIntersecting(_imp->_nodeRoot->mapFromScene(rect).boundingRect(), nodes);
+}
+
 const std::list< NodeGuiPtr > &
 NodeGraph::getSelectedNodes() const
 {
@@ -302,6 +342,11 @@ NodeGraph::paintEvent(QPaintEvent* e)
         updateNavigator();
         _imp->_refreshOverlays = false;
     }
+
+    // Read by the items while they are painted, instead of each of them mapping its size to the viewport
+    double zoomFactor = transform().mapRect( QRectF(0, 0, 1, 1) ).width();
+    _imp->lowLevelOfDetail = zoomFactor < NATRON_NODEGRAPH_LOW_DETAIL_ZOOM;
+
     QGraphicsView::paintEvent(e);
 
     if (drawLockedMode) {
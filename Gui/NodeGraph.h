@@ -177,6 +177,27 @@ public:
 
     bool isDoingNavigatorRender() const;
 
+    /**
+     * @brief True when the view is zoomed out so much that the text, previews and arrow heads
+     * are not painted, only the shapes of the nodes and edges.
+     **/
+    bool isLowLevelOfDetail() const;
+
+    /**
+     * @brief Updates the bounding rectangle of the node or edge in the index used to find the items
+     * under the mouse or in the viewport. Must be called each time the item moves or changes size.
+     **/
+    void refreshNodeInSpatialIndex(NodeGui* node);
+    void refreshEdgeInSpatialIndex(Edge* edge);
+
+    void removeNodeFromSpatialIndex(NodeGui* node);
+    void removeEdgeFromSpatialIndex(Edge* edge);
+
+    /**
+     * @brief Adds to nodes the nodes whose bounding rectangle intersects rect, in scene coordinates.
+     **/
+    void getNodesIntersecting(const QRectF& rect, std::set<NodeGui*>* nodes) const;
+
 public Q_SLOTS:
     
     bool pasteClipboard(const QPointF& pos = QPointF(INT_MIN, INT_MIN));
@@ -25,6 +25,7 @@
 #include "NodeGraph.h"
 #include "NodeGraphPrivate.h"
 
+#include <set>
 #include <stdexcept>
 
 GCC_DIAG_UNUSED_PRIVATE_FIELD_OFF
@@ -33,6 +34,7 @@ CLANG_DIAG_OFF(uninitialized)
 #include <QMouseEvent>
 #include <QtCore/QString>
 #include <QAction>
+#include <QPainterPath>
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 GCC_DIAG_UNUSED_PRIVATE_FIELD_ON
@@ -53,47 +55,42 @@ GCC_DIAG_UNUSED_PRIVATE_FIELD_ON
 #include "Global/QtCompat.h"
 
 NATRON_NAMESPACE_ENTER;
-static NodeGuiPtr
-isNodeGuiChild(QGraphicsItem* item)
-{
-    NodeGui* n = dynamic_cast<NodeGui*>(item);
-
-    if (n) {
-        return n->shared_from_this();
-    }
-    QGraphicsItem* parent = item->parentItem();
-    if (parent) {
-        return isNodeGuiChild(parent);
-    } else {
-        return NodeGuiPtr();
-    }
-}
 
-static Edge*
-isEdgeChild(QGraphicsItem* item)
+// Whether the item or one of its visible children intersects the path, in scene coordinates.
+static bool
+itemOrChildrenCollide(QGraphicsItem* item,
+                      const QPainterPath& scenePath)
 {
-    Edge* n = dynamic_cast<Edge*>(item);
-
-    if (n) {
-        return n;
+    if ( !item->isVisible() ) {
+        return false;
+    }
+    if ( item->collidesWithPath(item->mapFromScene(scenePath), Qt::IntersectsItemShape) ) {
+        return true;
     }
-    QGraphicsItem* parent = item->parentItem();
-    if (parent) {
-        return isEdgeChild(parent);
-    } else {
-        return 0;
+    QList<QGraphicsItem*> children = item->childItems();
+    for (QList<QGraphicsItem*>::Iterator it = children.begin(); it != children.end(); ++it) {
+        if ( itemOrChildrenCollide(*it, scenePath) ) {
+            return true;
+        }
     }
+
+    return false;
 }
 
 void
 NodeGraph::getNodesWithinViewportRect(const QRect& rect,
                                       std::set<NodeGuiPtr>* nodes) const
 {
-    QList<QGraphicsItem*> selectedItems = items(rect, Qt::IntersectsItemShape);
-    for (QList<QGraphicsItem*>::Iterator it = selectedItems.begin(); it != selectedItems.end(); ++it) {
-        NodeGuiPtr n = isNodeGuiChild(*it);
-        if (n) {
-            nodes->insert(n);
+    QPolygonF scenePoly = mapToScene(rect);
+    QPainterPath scenePath;
+
+    scenePath.addPolygon(scenePoly);
+
+    std::set<NodeGui*> candidates;
+    _imp->nodesIndex.getItemsIntersecting(_imp->_nodeRoot->mapFromScene(scenePoly).boundingRect(), &candidates);
+    for (std::set<NodeGui*>::iterator it = candidates.begin(); it != candidates.end(); ++it) {
+        if ( itemOrChildrenCollide(*it, scenePath) ) {
+            nodes->insert( (*it)->shared_from_this() );
         }
     }
 }
@@ -111,17 +108,30 @@ NodeGraph::hasItemNearbyMouse(const QPoint& mousePosViewport,
                         mousePosViewport.y() - tolerance / 2.,
                         tolerance,
                         tolerance);
-    QList<QGraphicsItem*> selectedItems = items(toleranceRect, Qt::IntersectsItemShape);
+    QPolygonF scenePoly = mapToScene(toleranceRect);
+    QPainterPath scenePath;
+    scenePath.addPolygon(scenePoly);
+    QRectF indexRect = _imp->_nodeRoot->mapFromScene(scenePoly).boundingRect();
+
+    // Only the items around the mouse are tested against their shape
     std::set<Edge*> edges;
-    std::set<NodeGuiPtr> nodes;
-    for (QList<QGraphicsItem*>::Iterator it = selectedItems.begin(); it != selectedItems.end(); ++it) {
-        Edge* isEdge = isEdgeChild(*it);
-        if (isEdge) {
-            edges.insert(isEdge);
+    {
+        std::set<Edge*> candidates;
+        _imp->edgesIndex.getItemsIntersecting(indexRect, &candidates);
+        for (std::set<Edge*>::iterator it = candidates.begin(); it != candidates.end(); ++it) {
+            if ( itemOrChildrenCollide(*it, scenePath) ) {
+                edges.insert(*it);
+            }
         }
-        NodeGuiPtr n = isNodeGuiChild(*it);
-        if (n) {
-            nodes.insert(n);
+    }
+    std::set<NodeGuiPtr> nodes;
+    {
+        std::set<NodeGui*> candidates;
+        _imp->nodesIndex.getItemsIntersecting(indexRect, &candidates);
+        for (std::set<NodeGui*>::iterator it = candidates.begin(); it != candidates.end(); ++it) {
+            if ( itemOrChildrenCollide(*it, scenePath) ) {
+                nodes.insert( (*it)->shared_from_this() );
+            }
         }
     }
 
@@ -191,6 +191,7 @@ NodeGraph::moveToTrash(const NodeGuiPtr& node)
         if ( *it == node ) {
             _imp->_nodesTrash.push_back(*it);
             _imp->_nodes.erase(it);
+            _imp->nodesIndex.remove( node.get() );
             break;
         }
     }
@@ -205,6 +206,7 @@ NodeGraph::restoreFromTrash(const NodeGuiPtr& node)
         if ( *it == node ) {
             _imp->_nodes.push_back(*it);
             _imp->_nodesTrash.erase(it);
+            refreshNodeInSpatialIndex( node.get() );
             break;
         }
     }
@@ -25,6 +25,7 @@
 #include "NodeGraphPrivate.h"
 #include "NodeGraph.h"
 
+#include <set>
 #include <stdexcept>
 
 #include "Engine/Node.h"
@@ -92,6 +93,10 @@ NodeGraphPrivate::NodeGraphPrivate(NodeGraph* p,
     , lastSelectedViewer(0)
     , isDoingPreviewRender(false)
     , autoScrollTimer()
+    , refreshRenderStateTimer()
+    , nodesIndex()
+    , edgesIndex()
+    , lowLevelOfDetail(false)
 {
     appPTR->getIcon(NATRON_PIXMAP_LOCKED, &unlockIcon);
 }
@@ -120,17 +125,24 @@ NodeGraphPrivate::editSelectionFromSelectionRectangle(bool addToSelection)
     }
 
     const QRectF& selection = _selectionRect;
+    std::set<NodeGui*> candidates;
 
-    for (NodesGuiList::iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
+    nodesIndex.getItemsIntersecting(_nodeRoot->mapFromScene(selection).boundingRect(), &candidates);
+    for (std::set<NodeGui*>::iterator it = candidates.begin(); it != candidates.end(); ++it) {
+        if ( !(*it)->isVisible() ) {
+            // Nodes in the trash are hidden
+            continue;
+        }
         QRectF bbox = (*it)->mapToScene( (*it)->boundingRect() ).boundingRect();
         if ( selection.contains(bbox) ) {
-            NodesGuiList::iterator foundInSel = std::find(_selection.begin(), _selection.end(), *it);
+            NodeGuiPtr node = (*it)->shared_from_this();
+            NodesGuiList::iterator foundInSel = std::find(_selection.begin(), _selection.end(), node);
             if ( foundInSel != _selection.end() ) {
                 continue;
             }
 
-            _selection.push_back(*it);
-            (*it)->setUserSelected(true);
+            _selection.push_back(node);
+            node->setUserSelected(true);
         }
     }
 }
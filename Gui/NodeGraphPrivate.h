@@ -46,6 +46,7 @@ CLANG_DIAG_OFF(uninitialized)
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
+#include "Gui/NodeGraphSpatialIndex.h"
 #include "Gui/NodeGraphUndoRedo.h" // NodeGuiPtr
 #include "Gui/GuiFwd.h"
 
@@ -59,6 +60,9 @@ CLANG_DIAG_ON(uninitialized)
 #define NATRON_NAVIGATOR_BASE_HEIGHT 0.2
 #define NATRON_NAVIGATOR_BASE_WIDTH 0.2
 
+// Below this zoom factor of the view, the node graph only paints the shapes of the nodes and edges
+#define NATRON_NODEGRAPH_LOW_DETAIL_ZOOM 0.4
+
 #define NATRON_SCENE_MAX 1e6
 #define NATRON_SCENE_MIN 0
 
@@ -206,6 +210,14 @@ public:
     QTimer autoScrollTimer;
     QTimer refreshRenderStateTimer;
 
+    ///The nodes and edges of the graph by their bounding rectangle in _nodeRoot coordinates, which do not change
+    ///when the view is panned or zoomed.
+    NodeGraphSpatialIndex<NodeGui*> nodesIndex;
+    NodeGraphSpatialIndex<Edge*> edgesIndex;
+
+    ///True when the view is zoomed out below NATRON_NODEGRAPH_LOW_DETAIL_ZOOM, updated in paintEvent
+    bool lowLevelOfDetail;
+
 
     NodeGraphPrivate(NodeGraph* p,
                      const NodeCollectionPtr& group);
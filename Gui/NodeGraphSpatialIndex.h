@@ -0,0 +1,272 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_GUI_NODEGRAPHSPATIALINDEX_H
+#define NATRON_GUI_NODEGRAPHSPATIALINDEX_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <QtCore/QRectF>
+
+#include "Gui/GuiFwd.h"
+
+// Size of a cell of the grid, in node graph coordinates: a default node is 80x30
+#define NATRON_NODEGRAPH_INDEX_CELL_SIZE 256.
+
+// Items covering more cells than this (large backdrops, long edges) are not split across cells
+// but kept in a separate set tested against every query
+#define NATRON_NODEGRAPH_INDEX_MAX_CELLS_PER_ITEM 64
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief A uniform grid indexing the bounding rectangles of the items of the node graph, so that finding the items
+ * under the mouse or in the viewport does not test every node and edge of the graph.
+ * The index is updated incrementally: moving an item only updates the few cells it leaves and enters.
+ * The rectangles must all be in the same coordinates, which should not change when the view is panned or zoomed.
+ * This is not thread-safe: it is only used from the main thread.
+ **/
+template <typename ITEM>
+class NodeGraphSpatialIndex
+{
+    struct IndexedItem
+    {
+        ITEM item;
+        QRectF rect;
+
+        // The cells covered by the item, inclusive. Unused for oversized items.
+        int x1, y1, x2, y2;
+        bool oversized;
+    };
+
+    typedef std::pair<int, int> Cell;
+
+    // The rectangles are copied in the cells so that a query does not look up the items
+    typedef std::map<Cell, std::vector<IndexedItem> > CellsMap;
+    typedef std::map<ITEM, IndexedItem> ItemsMap;
+
+    double _cellSize;
+    CellsMap _cells;
+    ItemsMap _items;
+    std::vector<IndexedItem> _oversizedItems;
+
+public:
+
+    explicit NodeGraphSpatialIndex(double cellSize = NATRON_NODEGRAPH_INDEX_CELL_SIZE)
+        : _cellSize(cellSize)
+        , _cells()
+        , _items()
+        , _oversizedItems()
+    {
+    }
+
+    /**
+     * @brief Inserts the item in the index with the given bounding rectangle, or moves it there if it was already indexed.
+     **/
+    void insert(const ITEM& item,
+                const QRectF& rect)
+    {
+        IndexedItem indexed;
+
+        indexed.item = item;
+        indexed.rect = rect.normalized();
+        getCells(indexed.rect, &indexed.x1, &indexed.y1, &indexed.x2, &indexed.y2);
+        indexed.oversized = ( (double)(indexed.x2 - indexed.x1 + 1) * (double)(indexed.y2 - indexed.y1 + 1) ) > NATRON_NODEGRAPH_INDEX_MAX_CELLS_PER_ITEM;
+
+        typename ItemsMap::iterator found = _items.find(item);
+        if ( found != _items.end() ) {
+            // Moving within the same cells only updates the rectangles, which is the common case while dragging a node
+            removeFromCells(found->second);
+            found->second = indexed;
+        } else {
+            _items.insert( std::make_pair(item, indexed) );
+        }
+        addToCells(indexed);
+    }
+
+    /**
+     * @brief Removes the item from the index. Returns false if it was not indexed.
+     **/
+    bool remove(const ITEM& item)
+    {
+        typename ItemsMap::iterator found = _items.find(item);
+
+        if ( found == _items.end() ) {
+            return false;
+        }
+        removeFromCells(found->second);
+        _items.erase(found);
+
+        return true;
+    }
+
+    void clear()
+    {
+        _cells.clear();
+        _items.clear();
+        _oversizedItems.clear();
+    }
+
+    bool contains(const ITEM& item) const
+    {
+        return _items.find(item) != _items.end();
+    }
+
+    std::size_t size() const
+    {
+        return _items.size();
+    }
+
+    /**
+     * @brief Adds to items all the indexed items whose bounding rectangle intersects rect, borders included.
+     **/
+    void getItemsIntersecting(const QRectF& rect,
+                              std::set<ITEM>* items) const
+    {
+        QRectF r = rect.normalized();
+        int x1, y1, x2, y2;
+
+        getCells(r, &x1, &y1, &x2, &y2);
+
+        if ( (double)(x2 - x1 + 1) * (double)(y2 - y1 + 1) > (double)_cells.size() ) {
+            // Zoomed out: there are less cells occupied than cells in the rectangle
+            for (typename CellsMap::const_iterator it = _cells.begin(); it != _cells.end(); ++it) {
+                if ( (it->first.first >= x1) && (it->first.first <= x2) && (it->first.second >= y1) && (it->first.second <= y2) ) {
+                    getItemsInCell(it->first, it->second, r, x1, y1, items);
+                }
+            }
+        } else {
+            for (int x = x1; x <= x2; ++x) {
+                // Cells are sorted by column, then by row
+                typename CellsMap::const_iterator it = _cells.lower_bound( Cell(x, y1) );
+                for (; it != _cells.end() && it->first.first == x && it->first.second <= y2; ++it) {
+                    getItemsInCell(it->first, it->second, r, x1, y1, items);
+                }
+            }
+        }
+        for (typename std::vector<IndexedItem>::const_iterator it = _oversizedItems.begin(); it != _oversizedItems.end(); ++it) {
+            if ( rectsOverlap(it->rect, r) ) {
+                items->insert(it->item);
+            }
+        }
+    }
+
+private:
+
+    static bool rectsOverlap(const QRectF& a,
+                             const QRectF& b)
+    {
+        // Unlike QRectF::intersects(), a horizontal or vertical line still intersects
+        return a.left() <= b.right() && b.left() <= a.right() && a.top() <= b.bottom() && b.top() <= a.bottom();
+    }
+
+    static void getItemsInCell(const Cell& cell,
+                               const std::vector<IndexedItem>& cellItems,
+                               const QRectF& rect,
+                               int rectX1,
+                               int rectY1,
+                               std::set<ITEM>* items)
+    {
+        for (typename std::vector<IndexedItem>::const_iterator it = cellItems.begin(); it != cellItems.end(); ++it) {
+            // An item covering several cells of the rectangle is only reported by the first of them
+            if ( ( cell.first == std::max(it->x1, rectX1) ) && ( cell.second == std::max(it->y1, rectY1) ) && rectsOverlap(it->rect, rect) ) {
+                items->insert(it->item);
+            }
+        }
+    }
+
+    void getCells(const QRectF& rect,
+                  int* x1,
+                  int* y1,
+                  int* x2,
+                  int* y2) const
+    {
+        *x1 = (int)std::floor(rect.left() / _cellSize);
+        *y1 = (int)std::floor(rect.top() / _cellSize);
+        *x2 = (int)std::floor(rect.right() / _cellSize);
+        *y2 = (int)std::floor(rect.bottom() / _cellSize);
+    }
+
+    void addToCells(const IndexedItem& indexed)
+    {
+        if (indexed.oversized) {
+            _oversizedItems.push_back(indexed);
+
+            return;
+        }
+        for (int x = indexed.x1; x <= indexed.x2; ++x) {
+            for (int y = indexed.y1; y <= indexed.y2; ++y) {
+                _cells[Cell(x, y)].push_back(indexed);
+            }
+        }
+    }
+
+    static void removeFromVector(const ITEM& item,
+                                 std::vector<IndexedItem>* indexedItems)
+    {
+        for (std::size_t i = 0; i < indexedItems->size(); ++i) {
+            if ( (*indexedItems)[i].item == item ) {
+                // The order of the items in a cell does not matter
+                (*indexedItems)[i] = indexedItems->back();
+                indexedItems->pop_back();
+
+                return;
+            }
+        }
+        assert(false);
+    }
+
+    void removeFromCells(const IndexedItem& indexed)
+    {
+        if (indexed.oversized) {
+            removeFromVector(indexed.item, &_oversizedItems);
+
+            return;
+        }
+        for (int x = indexed.x1; x <= indexed.x2; ++x) {
+            for (int y = indexed.y1; y <= indexed.y2; ++y) {
+                typename CellsMap::iterator found = _cells.find( Cell(x, y) );
+                assert( found != _cells.end() );
+                if ( found != _cells.end() ) {
+                    removeFromVector(indexed.item, &found->second);
+                    if ( found->second.empty() ) {
+                        _cells.erase(found);
+                    }
+                }
+            }
+        }
+    }
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_GUI_NODEGRAPHSPATIALINDEX_H
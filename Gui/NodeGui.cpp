@@ -26,6 +26,7 @@
 
 #include <cassert>
 #include <algorithm> // min, max
+#include <set>
 #include <stdexcept>
 
 #include <boost/scoped_array.hpp>
@@ -204,6 +205,9 @@ NodeGui::NodeGui(QGraphicsItem *parent)
 
 NodeGui::~NodeGui()
 {
+    if (_graph) {
+        _graph->removeNodeFromSpatialIndex(this);
+    }
 }
 
 void
@@ -712,6 +716,12 @@ void
 NodeGui::discardGraphPointer()
 {
     _graph = 0;
+    for (InputEdges::iterator it = _inputEdges.begin(); it != _inputEdges.end(); ++it) {
+        (*it)->discardGraphPointer();
+    }
+    if (_outputEdge) {
+        _outputEdge->discardGraphPointer();
+    }
 }
 
 void
@@ -947,12 +957,15 @@ NodeGui::refreshPositionEnd(double x,
 {
     setPos(x, y);
     if (_graph) {
+        _graph->refreshNodeInSpatialIndex(this);
+
         QRectF bbox = mapRectToScene( boundingRect() );
-        const NodesGuiList & allNodes = _graph->getAllActiveNodes();
+        std::set<NodeGui*> nearbyNodes;
+        _graph->getNodesIntersecting(bbox, &nearbyNodes);
 
-        for (NodesGuiList::const_iterator it = allNodes.begin(); it != allNodes.end(); ++it) {
-            if ( (*it)->isVisible() && (it->get() != this) && (*it)->intersects(bbox) ) {
-                setAboveItem((*it).get());
+        for (std::set<NodeGui*>::const_iterator it = nearbyNodes.begin(); it != nearbyNodes.end(); ++it) {
+            if ( (*it)->isVisible() && (*it != this) && (*it)->intersects(bbox) ) {
+                setAboveItem(*it);
             }
         }
     }
@@ -2711,6 +2724,9 @@ NodeGui::setScale_natron(double scale)
     if (_outputEdge) {
         _outputEdge->setScale(scale);
     }
+    if (_graph) {
+        _graph->refreshNodeInSpatialIndex(this);
+    }
     refreshEdges();
     const NodesWList & outputs = getNode()->getGuiOutputs();
     for (NodesWList::const_iterator it = outputs.begin(); it != outputs.end(); ++it) {
@@ -24,7 +24,9 @@
 
 #include "PreviewThread.h"
 
+#include <algorithm> // min, max
 #include <list>
+#include <map>
 #include <vector>
 #include <stdexcept>
 #include <cstring> // for std::memcpy, std::memset
@@ -35,7 +37,10 @@
 #include "Gui/GuiDefines.h"
 #include "Gui/NodeGui.h"
 
+#include "Engine/AppManager.h"
 #include "Engine/Node.h"
+#include "Engine/Settings.h"
+#include "Engine/Timer.h"
 
 
 NATRON_NAMESPACE_ENTER;
@@ -63,8 +68,28 @@ struct PreviewThreadPrivate
 {
     std::vector<unsigned int> data;
 
+    // For each node that has a request in the queue, the most recent time requested.
+    // Requests for a node that is already queued only update the time, so that scrubbing
+    // the timeline does not pile up previews for frames that are no longer displayed.
+    // Weak pointers are ordered by their control block, so a node allocated at the address
+    // of a deleted one never matches its entry.
+    // The map is cleared whenever the queue is dropped (abort or quit), otherwise the
+    // nodes that had a request in the dropped queue would never get a preview again.
+    typedef std::map<NodeGuiWPtr, double> PendingRequestsMap;
+    PendingRequestsMap pendingRequests;
+    QMutex pendingRequestsMutex;
+
+    // Time (in seconds since the creation of the thread) at which the last previews that
+    // required a render were launched, used to enforce the renders per second budget.
+    std::list<double> recentRenders;
+    TimeLapse clock;
+
     PreviewThreadPrivate()
         : data( NATRON_PREVIEW_HEIGHT * NATRON_PREVIEW_WIDTH * sizeof(unsigned int) )
+        , pendingRequests()
+        , pendingRequestsMutex()
+        , recentRenders()
+        , clock()
     {
     }
 };
@@ -90,7 +115,69 @@ PreviewThread::appendToQueue(const NodeGuiPtr& node,
 
     r->node = node;
     r->time = time;
-    startTask(r);
+
+    {
+        QMutexLocker k(&_imp->pendingRequestsMutex);
+        PreviewThreadPrivate::PendingRequestsMap::iterator found = _imp->pendingRequests.find(r->node);
+        if ( found != _imp->pendingRequests.end() ) {
+            // A request for this node is already queued, just make it compute the most recent time
+            found->second = time;
+
+            return;
+        }
+        _imp->pendingRequests.insert( std::make_pair(r->node, time) );
+    }
+    if ( !startTask(r) ) {
+        QMutexLocker k(&_imp->pendingRequestsMutex);
+        _imp->pendingRequests.erase(r->node);
+    }
+}
+
+void
+PreviewThread::clearPendingRequests()
+{
+    QMutexLocker k(&_imp->pendingRequestsMutex);
+
+    _imp->pendingRequests.clear();
+}
+
+void
+PreviewThread::onAbortRequested(bool /*keepOldestRender*/)
+{
+    clearPendingRequests();
+}
+
+void
+PreviewThread::onQuitRequested(bool /*allowRestarts*/)
+{
+    clearPendingRequests();
+}
+
+GenericSchedulerThread::ThreadStateEnum
+PreviewThread::waitForRenderBudget()
+{
+    const int maxRendersPerSecond = appPTR->getCurrentSettings()->getMaxPreviewRendersPerSecond();
+
+    if (maxRendersPerSecond <= 0) {
+        _imp->recentRenders.clear();
+
+        return eThreadStateActive;
+    }
+    for (;;) {
+        const double now = _imp->clock.getTimeSinceCreation();
+        while ( !_imp->recentRenders.empty() && (now - _imp->recentRenders.front() >= 1.) ) {
+            _imp->recentRenders.pop_front();
+        }
+        if ( (int)_imp->recentRenders.size() < maxRendersPerSecond ) {
+            return eThreadStateActive;
+        }
+        ThreadStateEnum state = resolveState();
+        if (state != eThreadStateActive) {
+            return state;
+        }
+        int msToWait = std::max( 1, (int)( ( 1. - (now - _imp->recentRenders.front()) ) * 1000 ) );
+        msleep( std::min(msToWait, 50) );
+    }
 }
 
 GenericSchedulerThread::ThreadStateEnum
@@ -100,6 +187,24 @@ PreviewThread::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
 
     assert(args);
 
+    // Previews are never more important than what the user is looking at in the Viewer
+    setPriority(QThread::LowPriority);
+
+    // While waiting for the budget, requests for the same node keep being coalesced
+    ThreadStateEnum state = waitForRenderBudget();
+
+    double time = args->time;
+    {
+        QMutexLocker k(&_imp->pendingRequestsMutex);
+        PreviewThreadPrivate::PendingRequestsMap::iterator found = _imp->pendingRequests.find(args->node);
+        if ( found != _imp->pendingRequests.end() ) {
+            time = found->second;
+            _imp->pendingRequests.erase(found);
+        }
+    }
+    if (state != eThreadStateActive) {
+        return state;
+    }
 
     NodeGuiPtr node = args->node.lock();
     if (node) {
@@ -120,8 +225,12 @@ PreviewThread::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
 #endif
         NodePtr internalNode = node->getNode();
         if (internalNode) {
-            bool ok = internalNode->makePreviewImage( args->time, &w, &h, &_imp->data.front() );
+            bool renderedFromCache = false;
+            bool ok = internalNode->makePreviewImage( time, &w, &h, &_imp->data.front(), &renderedFromCache );
             Q_UNUSED(ok);
+            if (!renderedFromCache) {
+                _imp->recentRenders.push_back( _imp->clock.getTimeSinceCreation() );
+            }
             node->copyPreviewImageBuffer(_imp->data, w, h);
         }
 
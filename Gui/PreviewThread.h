@@ -60,6 +60,22 @@ private:
     }
 
     virtual ThreadStateEnum threadLoopOnce(const ThreadStartArgsPtr& inArgs) OVERRIDE FINAL WARN_UNUSED_RETURN;
+
+    /**
+     * @brief The queued requests are dropped by the scheduler when aborting or quitting:
+     * forget them as well so that the next request of these nodes is queued again.
+     **/
+    virtual void onAbortRequested(bool keepOldestRender) OVERRIDE FINAL;
+    virtual void onQuitRequested(bool allowRestarts) OVERRIDE FINAL;
+
+    void clearPendingRequests();
+
+    /**
+     * @brief Blocks until the number of preview renders launched in the last second is below the budget
+     * set in the preferences. Returns something else than eThreadStateActive if the thread was aborted or must quit.
+     **/
+    ThreadStateEnum waitForRenderBudget();
+
     boost::scoped_ptr<PreviewThreadPrivate> _imp;
 };
 
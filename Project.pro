@@ -58,7 +58,7 @@ ceres.depends = glog gflags
 libmv.depends = gflags ceres
 openMVG.depends = ceres
 Serialization.depends = yaml-cpp
-Engine.depends = libmv openMVG HostSupport libtess ceres Serialization
+Engine.depends = libmv openMVG HostSupport libtess ceres Serialization qhttpserver
 Renderer.depends = Engine
 Gui.depends = Engine qhttpserver
 Tests.depends = Gui Engine
@@ -26,6 +26,7 @@
 #error "NATRON_BOOST_SERIALIZATION_COMPAT should be defined when compiling ProjectConverter to allow with projects older than Natron 2.2"
 #endif
 
+#include <sstream>
 #include <string>
 
 #include <QtCore/QString>
@@ -54,6 +55,11 @@
 #include "Serialization/NodeGuiSerialization.h"
 #include "Serialization/ProjectGuiSerialization.h"
 #include "Serialization/SerializationCompat.h"
+#include "Serialization/BinarySerialization.h"
+
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
+#include <yaml-cpp/yaml.h>
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
 NATRON_NAMESPACE_USING
 
@@ -330,7 +336,11 @@ printUsage(const std::string& programName)
                               "              The original file(s) will be renamed with the .bak extension.\n"
                               "              If not set the converted file(s) will have the same name as \n"
                               "              the input file with the \"-converted\" suffix before the file\n"
-                              "              extension. When the -o option is set, this option has no effect.\n\n").arg(QString::fromUtf8(programName.c_str()));
+                              "              extension. When the -o option is set, this option has no effect.\n\n"
+                              "-b: Optional: Encode the file(s), which must already be in the 2.2 format,\n"
+                              "              to the binary format instead of upgrading them. The\n"
+                              "              conversion is lossless.\n\n"
+                              "-y: Optional: Decode binary encoded file(s) back to YAML.\n\n").arg(QString::fromUtf8(programName.c_str()));
     std::cout << msg.toStdString() << std::endl;
 } // printUsage
 
@@ -344,9 +354,22 @@ static QStringList::iterator hasToken(QStringList &localArgs, const QString& tok
     return localArgs.end();
 } // hasToken
 
-static void parseArgs(const QStringList& appArgs, QString* inputPath, QString* outputPath, bool* replaceOriginal, bool* recurse)
+enum EncodingConversionEnum
+{
+    // Upgrade projects made with Natron 2.1.3 and older
+    eEncodingConversionUpgrade,
+
+    // YAML to binary
+    eEncodingConversionToBinary,
+
+    // Binary to YAML
+    eEncodingConversionToYAML
+};
+
+static void parseArgs(const QStringList& appArgs, QString* inputPath, QString* outputPath, bool* replaceOriginal, bool* recurse, EncodingConversionEnum* encoding)
 {
     *recurse = false;
+    *encoding = eEncodingConversionUpgrade;
     *replaceOriginal = false;
     QStringList localArgs = appArgs;
     {
@@ -392,6 +415,18 @@ static void parseArgs(const QStringList& appArgs, QString* inputPath, QString* o
         }
 
     }
+    {
+        bool toBinary = hasToken(localArgs, QLatin1String("-b")) != localArgs.end();
+        bool toYAML = hasToken(localArgs, QLatin1String("-y")) != localArgs.end();
+        if (toBinary && toYAML) {
+            throw std::invalid_argument(QString::fromUtf8("-b and -y switches cannot be used together").toStdString());
+        }
+        if (toBinary) {
+            *encoding = eEncodingConversionToBinary;
+        } else if (toYAML) {
+            *encoding = eEncodingConversionToYAML;
+        }
+    }
 } // parseArgs
 
 
@@ -446,6 +481,52 @@ static void tryReadAndConvertOlderProject(const QString& filename, const QString
 
 } // tryReadAndConvertOlderProject
 
+/**
+ * @brief Converts a file in the 2.2 format between its YAML and binary encodings. This does not need to
+ * load the project, only the serialization tree is converted.
+ * Upon failure an exception is thrown.
+ **/
+static void convertEncoding(const QString& filename, const QString& outFileName, EncodingConversionEnum encoding)
+{
+    FStreamsSupport::ifstream ifile;
+    FStreamsSupport::open(&ifile, filename.toStdString(), std::ios_base::in | std::ios_base::binary);
+    if (!ifile) {
+        QString message = QString::fromUtf8("Could not open %1").arg(filename);
+        throw std::invalid_argument(message.toStdString());
+    }
+
+    // Convert to a buffer first so that a decoding error does not leave a truncated output file
+    std::stringstream converted;
+    try {
+        std::stringstream yaml;
+        if ( SERIALIZATION_NAMESPACE::isBinaryEncoded(ifile) ) {
+            // Quoted scalars are emitted quoted
+            SERIALIZATION_NAMESPACE::BinaryReader reader(ifile);
+            YAML::Emitter em;
+            reader.getRoot().emit(em);
+            yaml << em.c_str();
+        } else {
+            yaml << ifile.rdbuf();
+        }
+        if (encoding == eEncodingConversionToBinary) {
+            SERIALIZATION_NAMESPACE::writeBinaryFromYAML(yaml, converted);
+        } else {
+            converted << yaml.rdbuf();
+        }
+    } catch (const std::exception& e) {
+        QString message = QString::fromUtf8("Could not decode %1: %2").arg(filename).arg(QString::fromUtf8(e.what()));
+        throw std::invalid_argument(message.toStdString());
+    }
+
+    FStreamsSupport::ofstream ofile;
+    FStreamsSupport::open(&ofile, outFileName.toStdString(), std::ios_base::out | std::ios_base::binary);
+    if (!ofile) {
+        QString message = QString::fromUtf8("Could not open %1").arg(outFileName);
+        throw std::invalid_argument(message.toStdString());
+    }
+    ofile << converted.rdbuf();
+} // convertEncoding
+
 struct ProcessData
 {
     std::list<std::string> bakFiles;
@@ -453,7 +534,7 @@ struct ProcessData
 };
 
 
-static void convertFile(const QString& filename, const QString& outputFilePathArgs, bool replaceOriginal, ProcessData* data)
+static void convertFile(const QString& filename, const QString& outputFilePathArgs, bool replaceOriginal, EncodingConversionEnum encoding, ProcessData* data)
 {
 
     if (!QFile::exists(filename)) {
@@ -501,7 +582,9 @@ static void convertFile(const QString& filename, const QString& outputFilePathAr
     }
 
 
-    if (isProjectFile) {
+    if (encoding != eEncodingConversionUpgrade) {
+        convertEncoding(filename, outFileName, encoding);
+    } else if (isProjectFile) {
         tryReadAndConvertOlderProject(filename, outFileName);
     } else if (isWorkspaceFile) {
         boost::shared_ptr<SERIALIZATION_NAMESPACE::WorkspaceSerialization> workspace;
@@ -554,7 +637,7 @@ static void convertFile(const QString& filename, const QString& outputFilePathAr
 
 } // convertFile
 
-static bool convertDirectory(const QString& dirPath, bool replaceOriginal, bool recurse, unsigned int recursionLevel, ProcessData* data)
+static bool convertDirectory(const QString& dirPath, bool replaceOriginal, bool recurse, unsigned int recursionLevel, EncodingConversionEnum encoding, ProcessData* data)
 {
     QDir originalDir(dirPath);
     if (!originalDir.exists()) {
@@ -573,7 +656,7 @@ static bool convertDirectory(const QString& dirPath, bool replaceOriginal, bool
             QDir subDir(absoluteOriginalFilePath);
             if (subDir.exists()) {
                 if (recurse) {
-                    didSomething |= convertDirectory(absoluteOriginalFilePath, replaceOriginal, recurse, recursionLevel + 1, data);
+                    didSomething |= convertDirectory(absoluteOriginalFilePath, replaceOriginal, recurse, recursionLevel + 1, encoding, data);
                 }
                 continue;
             }
@@ -581,7 +664,7 @@ static bool convertDirectory(const QString& dirPath, bool replaceOriginal, bool
 
         if (it->endsWith(QLatin1String(".ntp")) || it->endsWith(QLatin1String(".nl"))) {
             try {
-                convertFile(absoluteOriginalFilePath, QString(),replaceOriginal, data);
+                convertFile(absoluteOriginalFilePath, QString(),replaceOriginal, encoding, data);
             } catch (const std::exception& e) {
                 std::cerr << QString::fromUtf8("Error: %1").arg(QString::fromUtf8(e.what())).toStdString() << std::endl;
                 continue;
@@ -654,8 +737,9 @@ int main(int argc, char *argv[])
     // Parse app args
     QString inputPath, outputPath;
     bool recurse, replaceOriginal;
+    EncodingConversionEnum encoding;
     try {
-        parseArgs(arguments, &inputPath, &outputPath, &replaceOriginal, &recurse);
+        parseArgs(arguments, &inputPath, &outputPath, &replaceOriginal, &recurse, &encoding);
     } catch (const std::exception &e) {
         std::cerr << QString::fromUtf8("Error while parsing command line arguments: %1").arg(QString::fromUtf8(e.what())).toStdString() << std::endl;
         printUsage(arguments[0].toStdString());
@@ -673,9 +757,9 @@ int main(int argc, char *argv[])
     try {
 
         if (isDir) {
-            convertDirectory(inputPath, replaceOriginal, recurse, 0, &convertData);
+            convertDirectory(inputPath, replaceOriginal, recurse, 0, encoding, &convertData);
         } else {
-            convertFile(inputPath, outputPath, replaceOriginal, &convertData);
+            convertFile(inputPath, outputPath, replaceOriginal, encoding, &convertData);
         }
     } catch (const std::exception& e) {
         cleanupCreatedFiles(convertData);
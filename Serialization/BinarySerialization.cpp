@@ -0,0 +1,755 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#include "BinarySerialization.h"
+
+#include <cstring> // memcmp
+#include <iterator>
+
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
+#include <yaml-cpp/yaml.h>
+#include <yaml-cpp/eventhandler.h>
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
+
+#include "Serialization/ProjectSerialization.h"
+
+SERIALIZATION_NAMESPACE_ENTER
+
+namespace {
+
+enum BinaryTagEnum
+{
+    eBinaryTagNull = 0,
+    eBinaryTagScalar,
+    eBinaryTagSequence,
+    eBinaryTagMap
+};
+
+// Size of the tag + style of a value
+#define kBinaryValueHeaderSize 2
+// Size of the count + byte size of a container
+#define kBinaryContainerHeaderSize 12
+// magic + version + flags + root offset + toc offset
+#define kBinaryFileHeaderSize (NATRON_BINARY_SERIALIZATION_MAGIC_SIZE + 4 + 4 + 8 + 8)
+
+void
+appendU8(std::string* buf,
+         unsigned char v)
+{
+    buf->push_back( (char)v );
+}
+
+void
+appendU32(std::string* buf,
+          boost::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) {
+        buf->push_back( (char)( (v >> (8 * i) ) & 0xff ) );
+    }
+}
+
+void
+appendU64(std::string* buf,
+          boost::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) {
+        buf->push_back( (char)( (v >> (8 * i) ) & 0xff ) );
+    }
+}
+
+void
+patchU32(std::string* buf,
+         std::size_t offset,
+         boost::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) {
+        (*buf)[offset + i] = (char)( (v >> (8 * i) ) & 0xff );
+    }
+}
+
+void
+patchU64(std::string* buf,
+         std::size_t offset,
+         boost::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) {
+        (*buf)[offset + i] = (char)( (v >> (8 * i) ) & 0xff );
+    }
+}
+
+void
+appendString(std::string* buf,
+             const std::string& str)
+{
+    appendU32(buf, (boost::uint32_t)str.size());
+    buf->append(str);
+}
+
+// Style of a scalar that was quoted in the YAML
+#define kBinaryScalarQuoted 1
+
+/**
+ * @brief Writes the binary encoding of a tree that is given value by value, either from the events of the YAML
+ * parser or by walking a YAML::Node. The size of the containers are patched when they end.
+ * When the root is a project, the offset of each of its top-level nodes is recorded in the table of contents.
+ **/
+class BinaryEncoder
+{
+    struct Container
+    {
+        bool isMap;
+        std::size_t countOffset;
+        std::size_t start;
+        boost::uint32_t nValues;
+
+        // For maps: the last key if it was a scalar
+        std::string lastKey;
+
+        // Index in the table of contents of this container if it is a node of the project
+        int tocIndex;
+    };
+
+    std::string _buf;
+    std::size_t _tocOffsetPos;
+    std::vector<Container> _stack;
+    std::vector<BinaryReader::TOCEntry> _toc;
+    bool _hasRoot;
+
+public:
+
+    BinaryEncoder()
+        : _buf()
+        , _tocOffsetPos(0)
+        , _stack()
+        , _toc()
+        , _hasRoot(false)
+    {
+        _buf.append(NATRON_BINARY_SERIALIZATION_MAGIC, NATRON_BINARY_SERIALIZATION_MAGIC_SIZE);
+        appendU32(&_buf, NATRON_BINARY_SERIALIZATION_VERSION);
+        appendU32(&_buf, 0);
+        // The root value follows the header
+        appendU64(&_buf, kBinaryFileHeaderSize);
+        _tocOffsetPos = _buf.size();
+        appendU64(&_buf, 0);
+    }
+
+    void scalar(const std::string& value,
+                bool quoted)
+    {
+        int tocIndex = beginValue();
+        appendU8(&_buf, eBinaryTagScalar);
+        appendU8(&_buf, quoted ? kBinaryScalarQuoted : 0);
+        appendString(&_buf, value);
+        endTOCEntry(tocIndex);
+        endValue(&value);
+    }
+
+    void null()
+    {
+        int tocIndex = beginValue();
+        appendU8(&_buf, eBinaryTagNull);
+        appendU8(&_buf, 0);
+        endTOCEntry(tocIndex);
+        endValue(0);
+    }
+
+    void beginContainer(bool isMap,
+                        YAML::EmitterStyle::value style)
+    {
+        int tocIndex = beginValue();
+        appendU8(&_buf, isMap ? eBinaryTagMap : eBinaryTagSequence);
+        appendU8(&_buf, (unsigned char)style);
+        Container c;
+        c.isMap = isMap;
+        c.countOffset = _buf.size();
+        appendU32(&_buf, 0);
+        appendU64(&_buf, 0);
+        c.start = _buf.size();
+        c.nValues = 0;
+        c.tocIndex = tocIndex;
+        _stack.push_back(c);
+    }
+
+    void endContainer()
+    {
+        if ( _stack.empty() ) {
+            throw std::runtime_error("Unbalanced container in binary serialization");
+        }
+        const Container& c = _stack.back();
+        if ( c.isMap && (c.nValues % 2 != 0) ) {
+            throw std::runtime_error("Map key without value in binary serialization");
+        }
+        patchU32(&_buf, c.countOffset, c.isMap ? c.nValues / 2 : c.nValues);
+        patchU64(&_buf, c.countOffset + 4, _buf.size() - c.start);
+        endTOCEntry(c.tocIndex);
+        _stack.pop_back();
+        endValue(0);
+    }
+
+    void write(std::ostream& stream)
+    {
+        if ( !_hasRoot || !_stack.empty() ) {
+            throw std::runtime_error("Incomplete binary serialization");
+        }
+        patchU64(&_buf, _tocOffsetPos, _buf.size());
+        appendU32(&_buf, (boost::uint32_t)_toc.size());
+        for (std::vector<BinaryReader::TOCEntry>::const_iterator it = _toc.begin(); it != _toc.end(); ++it) {
+            appendString(&_buf, it->name);
+            appendU64(&_buf, it->offset);
+            appendU64(&_buf, it->size);
+        }
+
+        stream.write( _buf.data(), _buf.size() );
+        if (!stream) {
+            throw std::runtime_error("Failed to write binary serialization");
+        }
+    }
+
+private:
+
+    bool isMapValue(const Container& c) const
+    {
+        return c.isMap && (c.nValues % 2 == 1);
+    }
+
+    /*
+     * Called before a value is written, returns the index of the entry in the table of contents
+     * if the value is a node of the project, i.e: an item of the "Nodes" sequence of the root map.
+     */
+    int beginValue()
+    {
+        if ( _stack.empty() ) {
+            if (_hasRoot) {
+                throw std::runtime_error("Only 1 document can be encoded in binary serialization");
+            }
+            _hasRoot = true;
+
+            return -1;
+        }
+        if ( (_stack.size() == 2) && !_stack[1].isMap && isMapValue(_stack[0]) && (_stack[0].lastKey == "Nodes") ) {
+            BinaryReader::TOCEntry entry;
+            entry.offset = _buf.size();
+            entry.size = 0;
+            _toc.push_back(entry);
+
+            return (int)_toc.size() - 1;
+        }
+
+        return -1;
+    }
+
+    void endTOCEntry(int tocIndex)
+    {
+        if (tocIndex != -1) {
+            BinaryReader::TOCEntry& entry = _toc[tocIndex];
+            entry.size = _buf.size() - entry.offset;
+        }
+    }
+
+    void endValue(const std::string* scalarValue)
+    {
+        if ( _stack.empty() ) {
+            return;
+        }
+        Container& c = _stack.back();
+        if ( c.isMap && !isMapValue(c) ) {
+            // This was a key
+            c.lastKey = scalarValue ? *scalarValue : std::string();
+        } else if ( scalarValue && isMapValue(c) && (c.tocIndex != -1) && (c.lastKey == "ScriptName") ) {
+            _toc[c.tocIndex].name = *scalarValue;
+        }
+        ++c.nValues;
+    }
+};
+
+void
+encodeNode(const YAML::Node& node,
+           BinaryEncoder* encoder)
+{
+    switch ( node.Type() ) {
+    case YAML::NodeType::Scalar:
+        // The parser gives the "!" tag to quoted scalars
+        encoder->scalar( node.Scalar(), node.Tag() == "!" );
+        break;
+    case YAML::NodeType::Sequence:
+        encoder->beginContainer( false, node.Style() );
+        for (YAML::const_iterator it = node.begin(); it != node.end(); ++it) {
+            encodeNode(*it, encoder);
+        }
+        encoder->endContainer();
+        break;
+    case YAML::NodeType::Map:
+        encoder->beginContainer( true, node.Style() );
+        for (YAML::const_iterator it = node.begin(); it != node.end(); ++it) {
+            encodeNode(it->first, encoder);
+            encodeNode(it->second, encoder);
+        }
+        encoder->endContainer();
+        break;
+    case YAML::NodeType::Null:
+    case YAML::NodeType::Undefined:
+        encoder->null();
+        break;
+    }
+}
+
+/**
+ * @brief Encodes the events of the YAML parser as they come
+ **/
+class BinaryEncoderEventHandler
+    : public YAML::EventHandler
+{
+    BinaryEncoder* _encoder;
+
+public:
+
+    BinaryEncoderEventHandler(BinaryEncoder* encoder)
+        : _encoder(encoder)
+    {
+    }
+
+    virtual ~BinaryEncoderEventHandler()
+    {
+    }
+
+    virtual void OnDocumentStart(const YAML::Mark& /*mark*/) OVERRIDE FINAL
+    {
+    }
+
+    virtual void OnDocumentEnd() OVERRIDE FINAL
+    {
+    }
+
+    virtual void OnNull(const YAML::Mark& /*mark*/,
+                        YAML::anchor_t /*anchor*/) OVERRIDE FINAL
+    {
+        _encoder->null();
+    }
+
+    virtual void OnAlias(const YAML::Mark& /*mark*/,
+                         YAML::anchor_t /*anchor*/) OVERRIDE FINAL
+    {
+        throw std::runtime_error("YAML aliases are not supported by the binary serialization");
+    }
+
+    virtual void OnScalar(const YAML::Mark& /*mark*/,
+                          const std::string& tag,
+                          YAML::anchor_t /*anchor*/,
+                          const std::string& value) OVERRIDE FINAL
+    {
+        _encoder->scalar(value, tag == "!");
+    }
+
+    virtual void OnSequenceStart(const YAML::Mark& /*mark*/,
+                                 const std::string& /*tag*/,
+                                 YAML::anchor_t /*anchor*/,
+                                 YAML::EmitterStyle::value style) OVERRIDE FINAL
+    {
+        _encoder->beginContainer(false, style);
+    }
+
+    virtual void OnSequenceEnd() OVERRIDE FINAL
+    {
+        _encoder->endContainer();
+    }
+
+    virtual void OnMapStart(const YAML::Mark& /*mark*/,
+                            const std::string& /*tag*/,
+                            YAML::anchor_t /*anchor*/,
+                            YAML::EmitterStyle::value style) OVERRIDE FINAL
+    {
+        _encoder->beginContainer(true, style);
+    }
+
+    virtual void OnMapEnd() OVERRIDE FINAL
+    {
+        _encoder->endContainer();
+    }
+};
+
+} // anon namespace
+
+bool
+isBinaryEncoded(std::istream& stream)
+{
+    char magic[NATRON_BINARY_SERIALIZATION_MAGIC_SIZE];
+    std::istream::pos_type pos = stream.tellg();
+
+    stream.read(magic, NATRON_BINARY_SERIALIZATION_MAGIC_SIZE);
+    bool ret = stream.gcount() == NATRON_BINARY_SERIALIZATION_MAGIC_SIZE &&
+               std::memcmp(magic, NATRON_BINARY_SERIALIZATION_MAGIC, NATRON_BINARY_SERIALIZATION_MAGIC_SIZE) == 0;
+    stream.clear();
+    stream.seekg(pos);
+
+    return ret;
+}
+
+void
+writeBinaryNode(std::ostream& stream,
+                const YAML::Node& node)
+{
+    BinaryEncoder encoder;
+
+    encodeNode(node, &encoder);
+    encoder.write(stream);
+}
+
+void
+writeBinaryFromYAML(std::istream& yamlStream,
+                    std::ostream& stream)
+{
+    BinaryEncoder encoder;
+    BinaryEncoderEventHandler handler(&encoder);
+    YAML::Parser parser(yamlStream);
+
+    if ( !parser.HandleNextDocument(handler) ) {
+        // Empty document
+        encoder.null();
+    }
+    encoder.write(stream);
+}
+
+YAML::Node
+readBinaryNode(std::istream& stream)
+{
+    BinaryReader reader(stream);
+
+    return reader.getRoot().toNode();
+}
+
+void
+decodeBinary(const BinaryReaderPtr& reader,
+             ProjectSerialization* obj)
+{
+    obj->decodeBinary(reader);
+}
+
+BinaryReader::BinaryReader(const char* data,
+                           std::size_t size,
+                           const boost::shared_ptr<void>& bufferOwner)
+    : _ownedBuffer()
+    , _bufferOwner(bufferOwner)
+    , _data(data)
+    , _size(size)
+    , _rootOffset(0)
+    , _toc()
+{
+    readHeader();
+}
+
+BinaryReader::BinaryReader(std::istream& stream)
+    : _ownedBuffer( (std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>() )
+    , _bufferOwner()
+    , _data(0)
+    , _size(0)
+    , _rootOffset(0)
+    , _toc()
+{
+    _data = _ownedBuffer.data();
+    _size = _ownedBuffer.size();
+    readHeader();
+}
+
+void
+BinaryReader::readHeader()
+{
+    if ( (_size < kBinaryFileHeaderSize) || (std::memcmp(_data, NATRON_BINARY_SERIALIZATION_MAGIC, NATRON_BINARY_SERIALIZATION_MAGIC_SIZE) != 0) ) {
+        throw std::invalid_argument("Not a binary serialization");
+    }
+    std::size_t offset = NATRON_BINARY_SERIALIZATION_MAGIC_SIZE;
+    boost::uint32_t version = readU32(offset);
+    if (version > NATRON_BINARY_SERIALIZATION_VERSION) {
+        throw std::invalid_argument("Binary serialization was made with a more recent version");
+    }
+    offset += 8; // version + flags
+    _rootOffset = (std::size_t)readU64(offset);
+    offset += 8;
+    std::size_t tocOffset = (std::size_t)readU64(offset);
+    checkRange(_rootOffset, kBinaryValueHeaderSize);
+
+    boost::uint32_t nEntries = readU32(tocOffset);
+    tocOffset += 4;
+    _toc.resize(nEntries);
+    for (boost::uint32_t i = 0; i < nEntries; ++i) {
+        boost::uint32_t nameLen = readU32(tocOffset);
+        tocOffset += 4;
+        checkRange(tocOffset, nameLen);
+        _toc[i].name.assign(_data + tocOffset, nameLen);
+        tocOffset += nameLen;
+        _toc[i].offset = readU64(tocOffset);
+        tocOffset += 8;
+        _toc[i].size = readU64(tocOffset);
+        tocOffset += 8;
+        checkRange( (std::size_t)_toc[i].offset, (std::size_t)_toc[i].size );
+    }
+} // readHeader
+
+void
+BinaryReader::checkRange(std::size_t offset,
+                         std::size_t size) const
+{
+    if ( (offset > _size) || (size > _size - offset) ) {
+        throw std::out_of_range("Corrupted binary serialization");
+    }
+}
+
+boost::uint32_t
+BinaryReader::readU32(std::size_t offset) const
+{
+    checkRange(offset, 4);
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(_data + offset);
+
+    return (boost::uint32_t)p[0] | ( (boost::uint32_t)p[1] << 8 ) | ( (boost::uint32_t)p[2] << 16 ) | ( (boost::uint32_t)p[3] << 24 );
+}
+
+boost::uint64_t
+BinaryReader::readU64(std::size_t offset) const
+{
+    return (boost::uint64_t)readU32(offset) | ( (boost::uint64_t)readU32(offset + 4) << 32 );
+}
+
+BinaryReader::Value
+BinaryReader::getRoot() const
+{
+    return Value(this, _rootOffset);
+}
+
+BinaryReader::Value
+BinaryReader::getEntry(std::size_t index) const
+{
+    if ( index >= _toc.size() ) {
+        return Value();
+    }
+
+    return Value(this, (std::size_t)_toc[index].offset);
+}
+
+YAML::NodeType::value
+BinaryReader::Value::getType() const
+{
+    if (!_reader) {
+        return YAML::NodeType::Undefined;
+    }
+    _reader->checkRange(_offset, kBinaryValueHeaderSize);
+    switch ( (unsigned char)_reader->_data[_offset] ) {
+    case eBinaryTagNull:
+        return YAML::NodeType::Null;
+    case eBinaryTagScalar:
+        return YAML::NodeType::Scalar;
+    case eBinaryTagSequence:
+        return YAML::NodeType::Sequence;
+    case eBinaryTagMap:
+        return YAML::NodeType::Map;
+    default:
+        throw std::invalid_argument("Corrupted binary serialization");
+    }
+}
+
+std::size_t
+BinaryReader::Value::size() const
+{
+    YAML::NodeType::value type = getType();
+
+    if ( (type != YAML::NodeType::Sequence) && (type != YAML::NodeType::Map) ) {
+        return 0;
+    }
+
+    return _reader->readU32(_offset + kBinaryValueHeaderSize);
+}
+
+std::string
+BinaryReader::Value::getScalar() const
+{
+    if (getType() != YAML::NodeType::Scalar) {
+        throw YAML::InvalidNode();
+    }
+    std::size_t len = _reader->readU32(_offset + kBinaryValueHeaderSize);
+    _reader->checkRange(_offset + kBinaryValueHeaderSize + 4, len);
+
+    return std::string(_reader->_data + _offset + kBinaryValueHeaderSize + 4, len);
+}
+
+bool
+BinaryReader::Value::isQuotedScalar() const
+{
+    if (getType() != YAML::NodeType::Scalar) {
+        return false;
+    }
+
+    return (unsigned char)_reader->_data[_offset + 1] == kBinaryScalarQuoted;
+}
+
+std::size_t
+BinaryReader::Value::getEncodedSize() const
+{
+    switch ( getType() ) {
+    case YAML::NodeType::Scalar:
+        return kBinaryValueHeaderSize + 4 + _reader->readU32(_offset + kBinaryValueHeaderSize);
+    case YAML::NodeType::Sequence:
+    case YAML::NodeType::Map:
+        return kBinaryValueHeaderSize + kBinaryContainerHeaderSize + (std::size_t)_reader->readU64(_offset + kBinaryValueHeaderSize + 4);
+    case YAML::NodeType::Null:
+    case YAML::NodeType::Undefined:
+        break;
+    }
+
+    return kBinaryValueHeaderSize;
+}
+
+BinaryReader::Value
+BinaryReader::Value::at(std::size_t index) const
+{
+    if ( (getType() != YAML::NodeType::Sequence) || ( index >= size() ) ) {
+        return Value();
+    }
+    std::size_t offset = _offset + kBinaryValueHeaderSize + kBinaryContainerHeaderSize;
+    for (std::size_t i = 0; i < index; ++i) {
+        offset += Value(_reader, offset).getEncodedSize();
+    }
+
+    return Value(_reader, offset);
+}
+
+BinaryReader::Value
+BinaryReader::Value::find(const std::string& key) const
+{
+    if (getType() != YAML::NodeType::Map) {
+        return Value();
+    }
+    std::size_t nPairs = size();
+    std::size_t offset = _offset + kBinaryValueHeaderSize + kBinaryContainerHeaderSize;
+    for (std::size_t i = 0; i < nPairs; ++i) {
+        Value k(_reader, offset);
+        offset += k.getEncodedSize();
+        if ( (k.getType() == YAML::NodeType::Scalar) && (k.getScalar() == key) ) {
+            return Value(_reader, offset);
+        }
+        offset += Value(_reader, offset).getEncodedSize();
+    }
+
+    return Value();
+}
+
+std::vector<BinaryReader::Value>
+BinaryReader::Value::getChildren() const
+{
+    std::vector<Value> ret;
+    YAML::NodeType::value type = getType();
+
+    if ( (type != YAML::NodeType::Sequence) && (type != YAML::NodeType::Map) ) {
+        return ret;
+    }
+    std::size_t n = type == YAML::NodeType::Map ? size() * 2 : size();
+    ret.reserve(n);
+    std::size_t offset = _offset + kBinaryValueHeaderSize + kBinaryContainerHeaderSize;
+    for (std::size_t i = 0; i < n; ++i) {
+        Value child(_reader, offset);
+        ret.push_back(child);
+        offset += child.getEncodedSize();
+    }
+
+    return ret;
+}
+
+YAML::Node
+BinaryReader::Value::toNode() const
+{
+    YAML::NodeType::value type = getType();
+    YAML::EmitterStyle::value style = (YAML::EmitterStyle::value)(unsigned char)_reader->_data[_offset + 1];
+
+    switch (type) {
+    case YAML::NodeType::Scalar: {
+        YAML::Node ret( getScalar() );
+        // Same tags as the YAML parser gives
+        ret.SetTag( isQuotedScalar() ? "!" : "?" );
+
+        return ret;
+    }
+    case YAML::NodeType::Sequence: {
+        YAML::Node ret(YAML::NodeType::Sequence);
+        ret.SetStyle(style);
+        std::size_t n = size();
+        std::size_t offset = _offset + kBinaryValueHeaderSize + kBinaryContainerHeaderSize;
+        for (std::size_t i = 0; i < n; ++i) {
+            Value item(_reader, offset);
+            ret.push_back( item.toNode() );
+            offset += item.getEncodedSize();
+        }
+
+        return ret;
+    }
+    case YAML::NodeType::Map: {
+        YAML::Node ret(YAML::NodeType::Map);
+        ret.SetStyle(style);
+        std::size_t n = size();
+        std::size_t offset = _offset + kBinaryValueHeaderSize + kBinaryContainerHeaderSize;
+        for (std::size_t i = 0; i < n; ++i) {
+            Value k(_reader, offset);
+            offset += k.getEncodedSize();
+            Value v(_reader, offset);
+            offset += v.getEncodedSize();
+            ret.force_insert( k.toNode(), v.toNode() );
+        }
+
+        return ret;
+    }
+    case YAML::NodeType::Null:
+    case YAML::NodeType::Undefined:
+        break;
+    }
+
+    return YAML::Node(YAML::NodeType::Null);
+} // toNode
+
+void
+BinaryReader::Value::emit(YAML::Emitter& em) const
+{
+    YAML::NodeType::value type = getType();
+
+    switch (type) {
+    case YAML::NodeType::Scalar:
+        if ( isQuotedScalar() ) {
+            em << YAML::DoubleQuoted;
+        }
+        em << getScalar();
+        break;
+    case YAML::NodeType::Sequence:
+    case YAML::NodeType::Map: {
+        if ( (YAML::EmitterStyle::value)(unsigned char)_reader->_data[_offset + 1] == YAML::EmitterStyle::Flow ) {
+            em << YAML::Flow;
+        }
+        const bool isMap = type == YAML::NodeType::Map;
+        em << (isMap ? YAML::BeginMap : YAML::BeginSeq);
+        std::vector<Value> children = getChildren();
+        for (std::size_t i = 0; i < children.size(); ++i) {
+            if (isMap) {
+                em << ( (i % 2 == 0) ? YAML::Key : YAML::Value );
+            }
+            children[i].emit(em);
+        }
+        em << (isMap ? YAML::EndMap : YAML::EndSeq);
+        break;
+    }
+    case YAML::NodeType::Null:
+    case YAML::NodeType::Undefined:
+        em << YAML::Null;
+        break;
+    }
+} // emit
+
+SERIALIZATION_NAMESPACE_EXIT
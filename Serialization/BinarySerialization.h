@@ -0,0 +1,314 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_BinarySerialization_h
+#define Engine_BinarySerialization_h
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#endif
+
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
+#include <yaml-cpp/emitter.h>
+#include <yaml-cpp/node/impl.h>
+#include <yaml-cpp/node/parse.h>
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
+
+#include "Serialization/SerializationFwd.h"
+
+/*
+ * Binary encoding of the serialization objects.
+ *
+ * The binary format encodes exactly the same tree as the YAML format (maps, sequences and scalars,
+ * scalars being kept as their YAML text along with whether they were quoted) so that conversion
+ * between the 2 is lossless.
+ * All integers are little-endian, the file can be used directly from a memory mapping.
+ *
+ * Layout:
+ *  - Header: 8 bytes magic, u32 format version, u32 flags, u64 offset of the root value, u64 offset of the table of contents
+ *  - Values: u8 tag, u8 style then
+ *      - Scalar: u32 length followed by the bytes. The style is 1 if the scalar was quoted in the YAML, 0 otherwise
+ *      - Sequence: u32 number of items, u64 size in bytes of the items followed by the items
+ *      - Map: u32 number of pairs, u64 size in bytes of the pairs followed by key/value pairs
+ *  - Table of contents: u32 number of entries, then for each entry u32 name length, name, u64 offset, u64 size
+ *
+ * Since every container is prefixed by its size, a reader can jump over any sub-tree without
+ * decoding it: heavy payloads (roto strokes, tracks keyframes...) are only decoded when they are accessed.
+ * When the root is a project, the table of contents lists each top-level node by its script-name.
+ */
+#define NATRON_BINARY_SERIALIZATION_MAGIC "NTBINSER"
+#define NATRON_BINARY_SERIALIZATION_MAGIC_SIZE 8
+#define NATRON_BINARY_SERIALIZATION_VERSION 1
+
+SERIALIZATION_NAMESPACE_ENTER
+
+/**
+ * @brief Returns true if the stream starts with the binary serialization magic number.
+ * The stream position is left unchanged.
+ **/
+bool isBinaryEncoded(std::istream& stream);
+
+/**
+ * @brief Encodes the given YAML tree to the stream in binary format.
+ * Scalars that were quoted when the tree was loaded (their tag is "!") are marked as quoted.
+ **/
+void writeBinaryNode(std::ostream& stream, const YAML::Node& node);
+
+/**
+ * @brief Encodes the YAML document read from yamlStream to the stream in binary format.
+ * The document is encoded as it is parsed, without building a YAML::Node tree.
+ * Upon failure an exception is thrown.
+ **/
+void writeBinaryFromYAML(std::istream& yamlStream, std::ostream& stream);
+
+/**
+ * @brief Decodes the whole binary encoded stream to a YAML tree. Upon failure an exception is thrown.
+ **/
+YAML::Node readBinaryNode(std::istream& stream);
+
+/**
+ * @brief Random access to a binary encoded buffer. The buffer is not copied: it may be the content
+ * of a memory mapped file, in which case the object owning the mapping can be given to the reader so
+ * that it remains valid as long as the reader, or any BinaryPayload referencing it, is alive.
+ * Values are only decoded when requested with toNode().
+ **/
+class BinaryReader
+{
+public:
+
+    /**
+     * @brief Lightweight handle onto a value of the buffer
+     **/
+    class Value
+    {
+        friend class BinaryReader;
+
+        const BinaryReader* _reader;
+        std::size_t _offset;
+
+        Value(const BinaryReader* reader,
+              std::size_t offset)
+            : _reader(reader)
+            , _offset(offset)
+        {
+        }
+
+    public:
+
+        Value()
+            : _reader(0)
+            , _offset(0)
+        {
+        }
+
+        bool isValid() const
+        {
+            return _reader != 0;
+        }
+
+        YAML::NodeType::value getType() const;
+
+        /**
+         * @brief Number of items of a sequence or pairs of a map, 0 otherwise
+         **/
+        std::size_t size() const;
+
+        /**
+         * @brief Returns the scalar text
+         **/
+        std::string getScalar() const;
+
+        /**
+         * @brief Returns true if the scalar was quoted in the YAML it was encoded from
+         **/
+        bool isQuotedScalar() const;
+
+        /**
+         * @brief Returns the i'th item of a sequence, skipping over the previous items without decoding them
+         **/
+        Value at(std::size_t index) const;
+
+        /**
+         * @brief Returns the value associated to the given scalar key in a map, or an invalid value
+         **/
+        Value find(const std::string& key) const;
+
+        /**
+         * @brief Returns the items of a sequence, or the keys and values of a map interleaved (key, value, key, ...),
+         * without decoding them.
+         **/
+        std::vector<Value> getChildren() const;
+
+        /**
+         * @brief Decodes this value and its children to a YAML tree.
+         * Quoted scalars get the "!" tag, like when loading YAML.
+         **/
+        YAML::Node toNode() const;
+
+        /**
+         * @brief Writes this value and its children to the emitter, quoting the scalars that were quoted
+         **/
+        void emit(YAML::Emitter& em) const;
+
+        /**
+         * @brief Returns the total size in bytes of the encoded value, including its children
+         **/
+        std::size_t getEncodedSize() const;
+    };
+
+    struct TOCEntry
+    {
+        std::string name;
+        boost::uint64_t offset;
+        boost::uint64_t size;
+    };
+
+    /**
+     * @brief Reads the header and the table of contents. Throws an exception if the buffer is invalid.
+     * @param bufferOwner Optionally the object owning the buffer, e.g: the memory mapped file.
+     **/
+    BinaryReader(const char* data, std::size_t size, const boost::shared_ptr<void>& bufferOwner = boost::shared_ptr<void>());
+
+    /**
+     * @brief Reads the whole stream in a buffer owned by the reader. Throws an exception if the content is invalid.
+     **/
+    explicit BinaryReader(std::istream& stream);
+
+    Value getRoot() const;
+
+    const std::vector<TOCEntry>& getTableOfContents() const
+    {
+        return _toc;
+    }
+
+    /**
+     * @brief Returns the value referenced by the given table of contents entry
+     **/
+    Value getEntry(std::size_t index) const;
+
+private:
+
+    friend class Value;
+
+    void readHeader();
+
+    void checkRange(std::size_t offset, std::size_t size) const;
+
+    boost::uint32_t readU32(std::size_t offset) const;
+
+    boost::uint64_t readU64(std::size_t offset) const;
+
+    std::string _ownedBuffer;
+    boost::shared_ptr<void> _bufferOwner;
+    const char* _data;
+    std::size_t _size;
+    std::size_t _rootOffset;
+    std::vector<TOCEntry> _toc;
+};
+
+/**
+ * @brief A value of a binary buffer that is decoded only when it is needed, e.g: the Roto shapes of a node.
+ * It holds a reference on the reader, and thus on the buffer.
+ **/
+class BinaryPayload
+{
+public:
+
+    BinaryPayload(const BinaryReaderPtr& reader,
+                  const BinaryReader::Value& value)
+        : _reader(reader)
+        , _value(value)
+    {
+    }
+
+    /**
+     * @brief Decodes the payload into the given serialization object
+     **/
+    template <typename T>
+    void decode(T* obj) const
+    {
+        obj->decode( _value.toNode() );
+    }
+
+    std::size_t getEncodedSize() const
+    {
+        return _value.getEncodedSize();
+    }
+
+private:
+
+    BinaryReaderPtr _reader;
+    BinaryReader::Value _value;
+};
+
+/**
+ * @brief Decodes the root of the reader into the given serialization object
+ **/
+template <typename T>
+void decodeBinary(const BinaryReaderPtr& reader, T* obj)
+{
+    obj->decode( reader->getRoot().toNode() );
+}
+
+/**
+ * @brief Projects are decoded node by node from the table of contents and the Roto and Tracks payloads
+ * of the nodes are only decoded when accessed, see ProjectSerialization::decodeBinary
+ **/
+void decodeBinary(const BinaryReaderPtr& reader, ProjectSerialization* obj);
+
+/**
+ * @brief Write any serialization object to a binary encoded file.
+ * The serialization objects only know how to write to a YAML::Emitter: its output is encoded
+ * as it is parsed, see writeBinaryFromYAML.
+ **/
+template <typename T>
+void writeBinary(std::ostream& stream, const T& obj)
+{
+    YAML::Emitter em;
+    obj.encode(em);
+    std::istringstream yamlStream( em.c_str() );
+    writeBinaryFromYAML(yamlStream, stream);
+}
+
+/**
+ * @brief Read any serialization object from a binary encoded file. Upon failure an exception is thrown.
+ **/
+template <typename T>
+void readBinary(std::istream& stream, T* obj)
+{
+    if (!obj) {
+        throw std::invalid_argument("Invalid serialization object");
+    }
+    BinaryReaderPtr reader( new BinaryReader(stream) );
+    decodeBinary(reader, obj);
+}
+
+SERIALIZATION_NAMESPACE_EXIT
+
+#endif // Engine_BinarySerialization_h
@@ -118,14 +118,16 @@ NodeSerialization::encode(YAML::Emitter& em) const
         em << YAML::EndSeq;
     }
 
-    if (_rotoContext) {
+    boost::shared_ptr<RotoContextSerialization> rotoContext = getRotoContext();
+    if (rotoContext) {
         em << YAML::Key << "Roto" << YAML::Value;
-        _rotoContext->encode(em);
+        rotoContext->encode(em);
     }
 
-    if (_trackerContext) {
+    boost::shared_ptr<TrackerContextSerialization> trackerContext = getTrackerContext();
+    if (trackerContext) {
         em << YAML::Key << "Tracks" << YAML::Value;
-        _trackerContext->encode(em);
+        trackerContext->encode(em);
     }
 
      // Only serialize clone stuff for non pyplug/non presets
@@ -326,6 +328,79 @@ NodeSerialization::decode(const YAML::Node& node)
 
 } // NodeSerialization::decode
 
+void
+NodeSerialization::decodeBinary(const BinaryReaderPtr& reader,
+                                const BinaryReader::Value& value)
+{
+    if (value.getType() != YAML::NodeType::Map) {
+        throw YAML::InvalidNode();
+    }
+
+    // Everything but the children and the Roto and Tracks payloads is small: decode it with decode()
+    YAML::Node node(YAML::NodeType::Map);
+    BinaryReader::Value childrenValue;
+    std::vector<BinaryReader::Value> pairs = value.getChildren();
+    for (std::size_t i = 0; i + 1 < pairs.size(); i += 2) {
+        std::string key;
+        if (pairs[i].getType() == YAML::NodeType::Scalar) {
+            key = pairs[i].getScalar();
+        }
+        if (key == "Roto") {
+            _rotoContextPayload.reset( new BinaryPayload(reader, pairs[i + 1]) );
+        } else if (key == "Tracks") {
+            _trackerContextPayload.reset( new BinaryPayload(reader, pairs[i + 1]) );
+        } else if (key == "Children") {
+            childrenValue = pairs[i + 1];
+        } else {
+            node.force_insert( pairs[i].toNode(), pairs[i + 1].toNode() );
+        }
+    }
+    decode(node);
+
+    if ( childrenValue.isValid() ) {
+        std::vector<BinaryReader::Value> children = childrenValue.getChildren();
+        for (std::size_t i = 0; i < children.size(); ++i) {
+            NodeSerializationPtr s(new NodeSerialization);
+            s->decodeBinary(reader, children[i]);
+            _children.push_back(s);
+        }
+    }
+} // NodeSerialization::decodeBinary
+
+boost::shared_ptr<RotoContextSerialization>
+NodeSerialization::getRotoContext() const
+{
+    if (_rotoContextPayload) {
+        _rotoContext.reset(new RotoContextSerialization);
+        _rotoContextPayload->decode( _rotoContext.get() );
+        _rotoContextPayload.reset();
+    }
+
+    return _rotoContext;
+}
+
+boost::shared_ptr<TrackerContextSerialization>
+NodeSerialization::getTrackerContext() const
+{
+    if (_trackerContextPayload) {
+        _trackerContext.reset(new TrackerContextSerialization);
+        _trackerContextPayload->decode( _trackerContext.get() );
+        _trackerContextPayload.reset();
+    }
+
+    return _trackerContext;
+}
+
+void
+NodeSerialization::decodeDeferredPayloads() const
+{
+    getRotoContext();
+    getTrackerContext();
+    for (NodeSerializationList::const_iterator it = _children.begin(); it != _children.end(); ++it) {
+        (*it)->decodeDeferredPayloads();
+    }
+}
+
 
 SERIALIZATION_NAMESPACE_EXIT
 
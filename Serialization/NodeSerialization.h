@@ -21,6 +21,7 @@
 
 #include <climits>
 
+#include "Serialization/BinarySerialization.h"
 #include "Serialization/KnobSerialization.h"
 #include "Serialization/TrackerSerialization.h"
 #include "Serialization/RotoContextSerialization.h"
@@ -76,6 +77,8 @@ public:
     , _nodeColor()
     , _overlayColor()
     , _viewerUIKnobsOrder()
+    , _rotoContextPayload()
+    , _trackerContextPayload()
     {
         _nodePositionCoords[0] = _nodePositionCoords[1] = INT_MIN;
         _nodeSize[0] = _nodeSize[1] = -1;
@@ -137,10 +140,12 @@ public:
     // Serialization of inputs, this is a map of the input label to the script-name (not full) of the input node
     std::map<std::string, std::string> _inputs;
 
-    // If this node has a Roto context, this is its serialization
-    boost::shared_ptr<RotoContextSerialization> _rotoContext;
+    // If this node has a Roto context, this is its serialization.
+    // When decoded from a binary project, use getRotoContext() which decodes it on first access
+    mutable boost::shared_ptr<RotoContextSerialization> _rotoContext;
     // If this node has a Tracker context, this is its serialization
-    boost::shared_ptr<TrackerContextSerialization> _trackerContext;
+    // When decoded from a binary project, use getTrackerContext() which decodes it on first access
+    mutable boost::shared_ptr<TrackerContextSerialization> _trackerContext;
 
     // The serialization of the pages created by the user
     std::list<boost::shared_ptr<GroupKnobSerialization> > _userPages;
@@ -163,10 +168,36 @@ public:
     // Ordering of the knobs in the viewer UI for this node
     std::list<std::string> _viewerUIKnobsOrder;
 
+    // The encoded Roto and Tracks of a node decoded from a binary project, until they are accessed
+    mutable BinaryPayloadPtr _rotoContextPayload;
+    mutable BinaryPayloadPtr _trackerContextPayload;
+
+    /**
+     * @brief Returns the serialization of the Roto context, decoding it first if decodeBinary() deferred it
+     **/
+    boost::shared_ptr<RotoContextSerialization> getRotoContext() const;
+
+    /**
+     * @brief Returns the serialization of the Tracker context, decoding it first if decodeBinary() deferred it
+     **/
+    boost::shared_ptr<TrackerContextSerialization> getTrackerContext() const;
+
+    /**
+     * @brief Decodes the payloads deferred by decodeBinary() for this node and its children, after
+     * which the binary buffer is no longer referenced
+     **/
+    void decodeDeferredPayloads() const;
+
     virtual void encode(YAML::Emitter& em) const OVERRIDE;
 
     virtual void decode(const YAML::Node& node) OVERRIDE;
 
+    /**
+     * @brief Same as decode() from a value of a binary encoded project, without decoding it to YAML first.
+     * The Roto and Tracks payloads, which may be large, are kept encoded until they are accessed.
+     **/
+    void decodeBinary(const BinaryReaderPtr& reader, const BinaryReader::Value& value);
+
     template<class Archive>
     void serialize(Archive & ar, const unsigned int version);
 };
@@ -166,6 +166,51 @@ ProjectSerialization::decode(const YAML::Node& node)
 
 } // ProjectSerialization::decode
 
+void
+ProjectSerialization::decodeBinary(const BinaryReaderPtr& reader)
+{
+    BinaryReader::Value root = reader->getRoot();
+    if (root.getType() != YAML::NodeType::Map) {
+        throw YAML::InvalidNode();
+    }
+
+    // Everything but the nodes is small: decode it with decode()
+    YAML::Node node(YAML::NodeType::Map);
+    BinaryReader::Value nodesValue;
+    std::vector<BinaryReader::Value> pairs = root.getChildren();
+    for (std::size_t i = 0; i + 1 < pairs.size(); i += 2) {
+        if ( (pairs[i].getType() == YAML::NodeType::Scalar) && (pairs[i].getScalar() == "Nodes") ) {
+            nodesValue = pairs[i + 1];
+        } else {
+            node.force_insert( pairs[i].toNode(), pairs[i + 1].toNode() );
+        }
+    }
+    decode(node);
+
+    if ( !nodesValue.isValid() ) {
+        return;
+    }
+
+    // Jump to each node with the table of contents
+    const std::vector<BinaryReader::TOCEntry>& toc = reader->getTableOfContents();
+    if ( toc.size() != nodesValue.size() ) {
+        throw YAML::InvalidNode();
+    }
+    for (std::size_t i = 0; i < toc.size(); ++i) {
+        NodeSerializationPtr ns(new NodeSerialization);
+        ns->decodeBinary( reader, reader->getEntry(i) );
+        _nodes.push_back(ns);
+    }
+} // ProjectSerialization::decodeBinary
+
+void
+ProjectSerialization::decodeDeferredPayloads() const
+{
+    for (NodeSerializationList::const_iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
+        (*it)->decodeDeferredPayloads();
+    }
+}
+
 SERIALIZATION_NAMESPACE_EXIT
 
 
@@ -130,6 +130,18 @@ public:
 
     virtual void decode(const YAML::Node& node) OVERRIDE;
 
+    /**
+     * @brief Decodes a binary encoded project without decoding it to YAML first: each node is decoded
+     * from its entry in the table of contents and the Roto and Tracks payloads of the nodes are kept
+     * encoded until they are accessed.
+     **/
+    void decodeBinary(const BinaryReaderPtr& reader);
+
+    /**
+     * @brief Decodes the payloads of the nodes that were not accessed after decodeBinary(), after which
+     * the binary buffer (e.g: the memory mapped project file) is no longer referenced.
+     **/
+    void decodeDeferredPayloads() const;
 
     template<class Archive>
     void serialize(Archive & ar, const unsigned int version);
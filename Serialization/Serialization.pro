@@ -47,6 +47,7 @@ INCLUDEPATH += $$PWD/../libs/SequenceParsing
 
 HEADERS += \
     BezierSerialization.h \
+    BinarySerialization.h \
     BezierCPSerialization.h \
     CacheSerialization.h \
     CacheSerializationImpl.h \
@@ -86,6 +87,7 @@ SOURCES += \
     KnobSerialization.cpp \
     BezierCPSerialization.cpp \
     BezierSerialization.cpp \
+    BinarySerialization.cpp \
     CurveSerialization.cpp \
     FormatSerialization.cpp \
     FrameKeySerialization.cpp \
@@ -450,6 +450,8 @@ void NATRON_NAMESPACE::Curve::serialize(Archive & ar, const unsigned int version
 {
     QMutexLocker k(&_imp->_lock);
     ar & ::boost::serialization::make_nvp("KeyFrameSet", _imp->keyFrames);
+    // When loading, the keyframes were replaced
+    _imp->onKeyFramesChanged();
 }
 
 
@@ -32,6 +32,8 @@
 SERIALIZATION_NAMESPACE_ENTER;
 
 class BezierSerialization;
+class BinaryPayload;
+class BinaryReader;
 class CurveSerialization;
 class ImageComponentsSerialization;
 class ImageKeySerialization;
@@ -63,6 +65,8 @@ class WindowSerialization;
 class WorkspaceSerialization;
 
 typedef boost::shared_ptr<BezierSerialization> BezierSerializationPtr;
+typedef boost::shared_ptr<BinaryPayload> BinaryPayloadPtr;
+typedef boost::shared_ptr<const BinaryReader> BinaryReaderPtr;
 typedef boost::shared_ptr<CurveSerialization> CurveSerializationPtr;
 typedef boost::shared_ptr<GroupKnobSerialization> GroupKnobSerializationPtr;
 typedef boost::shared_ptr<KnobSerialization> KnobSerializationPtr;
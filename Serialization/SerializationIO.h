@@ -32,6 +32,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
 #include "Serialization/SerializationFwd.h"
+#include "Serialization/BinarySerialization.h"
 #include "Serialization/WorkspaceSerialization.h"
 #include "Serialization/ProjectSerialization.h"
 #include "Serialization/NodeSerialization.h"
@@ -52,6 +53,7 @@ void write(std::ostream& stream, const T& obj)
 
 /**
  * @brief Read any serialization object from a YAML encoded file. Upon failure an exception is thrown.
+ * Files written with writeBinary() are detected and decoded as well.
  **/
 template <typename T>
 void read(std::istream& stream, T* obj)
@@ -59,6 +61,11 @@ void read(std::istream& stream, T* obj)
     if (!obj) {
         throw std::invalid_argument("Invalid serialization object");
     }
+    if ( isBinaryEncoded(stream) ) {
+        readBinary(stream, obj);
+
+        return;
+    }
     YAML::Node node = YAML::Load(stream);
     obj->decode(node);
 }
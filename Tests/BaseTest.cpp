@@ -26,6 +26,14 @@
 
 #include "BaseTest.h"
 
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
 #include <QtCore/QFile>
 
 #include "Engine/CreateNodeArgs.h"
@@ -35,9 +43,20 @@
 #include "Engine/AppInstance.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/EffectInstance.h"
+#include "Engine/OutputEffectInstance.h"
+#include "Engine/OutputSchedulerThread.h"
+#include "Engine/ParallelRenderArgs.h"
 #include "Engine/Plugin.h"
+#include "Engine/PythonCallback.h"
+#include "Engine/RenderStats.h"
+#include "Engine/AbortableRenderInfo.h"
+#include "Engine/Cache.h"
 #include "Engine/Curve.h"
 #include "Engine/CLArgs.h"
+#include "Engine/Image.h"
+#include "Engine/SharedUpstreamImages.h"
+#include "Engine/Timer.h"
+#include "Engine/TLSHolder.h"
 #include "Engine/ViewIdx.h"
 
 NATRON_NAMESPACE_USING
@@ -262,6 +281,371 @@ TEST_F(BaseTest, GenerateDot)
     QFile::remove(filePath);
 }
 
+///Returns the number of cache misses of the given node in a render statistics file written by a writer, or -1 if not found
+static int
+readCacheMissesFromStatsFile(const QString& statsFilePath,
+                             const std::string& nodeName)
+{
+    std::ifstream ifile( statsFilePath.toStdString().c_str() );
+    std::string line;
+    bool inNodeSection = false;
+
+    while ( std::getline(ifile, line) ) {
+        if (line.compare(0, 8, "--------") == 0) {
+            inNodeSection = line.find(" " + nodeName + "-") != std::string::npos;
+        } else if ( inNodeSection && (line.compare(0, 15, "Nb cache miss: ") == 0) ) {
+            return std::atoi( line.c_str() + 15 );
+        }
+    }
+
+    return -1;
+}
+
+///High level test: render 2 writers fed by the same generator together
+TEST_F(BaseTest, MultipleWritersRender)
+{
+    NodePtr generator = createNode(_generatorPluginID);
+    NodePtr writers[2];
+    writers[0] = createNode(_writeOIIOPluginID);
+    writers[1] = createNode(_writeOIIOPluginID);
+    ASSERT_TRUE(generator && writers[0] && writers[1]);
+
+    KnobIPtr frameRange = getApp()->getProject()->getKnobByName("frameRange");
+    ASSERT_TRUE(frameRange);
+    KnobIntPtr knob = toKnobInt(frameRange);
+    ASSERT_TRUE(knob);
+    knob->setValue(1, ViewSpec::all(), 0);
+    knob->setValue(3, ViewSpec::all(), 1);
+
+    Format f(0, 0, 200, 200, "toto", 1.);
+    getApp()->getProject()->setOrAddProjectFormat(f);
+
+    const QString& binPath = appPTR->getApplicationBinaryPath();
+    // The statistics files are named after the output files without their extension
+    QString filePaths[2] = {
+        binPath + QString::fromUtf8("/test_multiple_writers_a.#.jpg"),
+        binPath + QString::fromUtf8("/test_multiple_writers_b.#.png")
+    };
+    std::list<AppInstance::RenderWork> works;
+    for (int i = 0; i < 2; ++i) {
+        writers[i]->setOutputFilesForWriter( filePaths[i].toStdString() );
+        connectNodes(generator, writers[i], 0, true);
+
+        AppInstance::RenderWork w;
+        w.writer = toOutputEffectInstance( writers[i]->getEffectInstance() );
+        assert(w.writer);
+        w.firstFrame = INT_MIN;
+        w.lastFrame = INT_MAX;
+        w.frameStep = INT_MIN;
+        w.useRenderStats = true;
+        works.push_back(w);
+    }
+
+    ///The generator is rendered once per frame and its images are held until both writers rendered the frame:
+    ///the writer that comes second reads the image from the cache
+    getApp()->startWritersRendering(false, works);
+
+    for (std::list<AppInstance::RenderWork>::const_iterator it = works.begin(); it != works.end(); ++it) {
+        EXPECT_FALSE( it->writer->getSharedUpstreamImages() );
+    }
+    const std::string generatorName = generator->getScriptName_mt_safe();
+    for (int frame = 1; frame <= 3; ++frame) {
+        int nGeneratorCacheMisses = 0;
+        for (int i = 0; i < 2; ++i) {
+            QString framePath = filePaths[i];
+            framePath.replace( QChar::fromLatin1('#'), QString::number(frame) );
+            EXPECT_TRUE( QFile::exists(framePath) );
+            QFile::remove(framePath);
+
+            QString statsPath = framePath;
+            statsPath.replace( statsPath.lastIndexOf( QChar::fromLatin1('.') ), statsPath.size(), QString::fromUtf8("-stats.txt") );
+            int nCacheMisses = readCacheMissesFromStatsFile(statsPath, generatorName);
+            EXPECT_GE(nCacheMisses, 0) << statsPath.toStdString();
+            nGeneratorCacheMisses += std::max(0, nCacheMisses);
+            QFile::remove(statsPath);
+        }
+        EXPECT_EQ(1, nGeneratorCacheMisses) << "frame " << frame;
+    }
+}
+
+///The images held for a frame are released as soon as the writers rendering that frame, and only them, are done with it
+TEST_F(BaseTest, SharedUpstreamImagesWriterRanges)
+{
+    NodePtr generator = createNode(_generatorPluginID);
+    NodePtr writers[2];
+    writers[0] = createNode(_writeOIIOPluginID);
+    writers[1] = createNode(_writeOIIOPluginID);
+    ASSERT_TRUE(generator && writers[0] && writers[1]);
+    connectNodes(generator, writers[0], 0, true);
+    connectNodes(generator, writers[1], 0, true);
+
+    // The first writer renders the frames 1 to 3, the second one every other frame from 2 to 6
+    const int firstFrames[2] = { 1, 2 };
+    const int lastFrames[2] = { 3, 6 };
+    const int frameSteps[2] = { 1, 2 };
+    SharedUpstreamImages sharedImages(1024 * 1024 * 1024);
+    for (int i = 0; i < 2; ++i) {
+        sharedImages.addWriter(writers[i], firstFrames[i], lastFrames[i], frameSteps[i]);
+    }
+    EXPECT_TRUE( sharedImages.isSharedNode(generator) );
+    EXPECT_FALSE( sharedImages.isSharedNode(writers[0]) );
+
+    for (int frame = 1; frame <= 6; ++frame) {
+        std::vector<int> frameWriters;
+        for (int i = 0; i < 2; ++i) {
+            if ( (frame >= firstFrames[i]) && (frame <= lastFrames[i]) && ( (frame - firstFrames[i]) % frameSteps[i] == 0 ) ) {
+                frameWriters.push_back(i);
+            }
+        }
+        if ( frameWriters.empty() ) {
+            continue;
+        }
+        // The first writer reaching the frame renders the generator image
+        ImagePtr image( new Image(ImageComponents::getRGBAComponents(), RectD(0, 0, 16, 16), RectI(0, 0, 16, 16), 0, 1., eImageBitDepthFloat,
+                                  eImagePremultiplicationPremultiplied, eImageFieldingOrderNone) );
+        sharedImages.holdImage(frame, image);
+        EXPECT_EQ( 1u, sharedImages.getHeldImagesCount() ) << "frame " << frame;
+        for (std::size_t i = 0; i < frameWriters.size(); ++i) {
+            sharedImages.notifyFrameRendered(frame);
+            // The image is kept until the last writer rendering the frame is done with it
+            std::size_t expectedHeldImages = (i + 1 < frameWriters.size()) ? 1 : 0;
+            EXPECT_EQ( expectedHeldImages, sharedImages.getHeldImagesCount() ) << "frame " << frame;
+        }
+        EXPECT_EQ( 0u, sharedImages.getHeldBytes() );
+    }
+}
+
+///Removing the entries of a plugin from the cache (e.g when a node is deleted) keeps the eviction policy:
+///with the cost aware eviction, a cheap entry is evicted before an expensive one that is less recently used.
+TEST_F(BaseTest, CacheEvictionPolicyAfterPluginRemoval)
+{
+    ImageCache cache("CacheEvictionTest", NATRON_CACHE_VERSION, 1024 * 1024 * 1024, 1.);
+
+    cache.setEvictionPolicy(eCacheEvictionPolicyCostAware);
+
+    ImageParamsPtr params = Image::makeParams(RectD(0, 0, 16, 16), 1., 0, ImageComponents::getRGBAComponents(), eImageBitDepthFloat,
+                                              eImagePremultiplicationPremultiplied, eImageFieldingOrderNone);
+    const ImageKey removedKey("RemovedPlugin", 1, 0, ViewIdx(0), false);
+    const ImageKey expensiveKey("KeptPlugin", 2, 0, ViewIdx(0), false);
+    const ImageKey cheapKey("KeptPlugin", 3, 0, ViewIdx(0), false);
+    const ImageKey newKey("KeptPlugin", 4, 0, ViewIdx(0), false);
+    {
+        ImagePtr removed, expensive, cheap;
+        cache.getOrCreate(removedKey, params, 0, &removed);
+        cache.getOrCreate(expensiveKey, params, 0, &expensive);
+        cache.getOrCreate(cheapKey, params, 0, &cheap);
+        ASSERT_TRUE(removed && expensive && cheap);
+        // The removed image is not allocated, so that the memory size of the cache does not depend on when the deleter thread frees it
+        expensive->allocateMemory();
+        cheap->allocateMemory();
+        expensive->addRenderCost(10.);
+        cheap->addRenderCost(0.001);
+    }
+
+    cache.removeAllEntriesForPluginPublic("RemovedPlugin", true);
+    std::list<ImagePtr> found;
+    EXPECT_FALSE( cache.get(removedKey, &found) );
+
+    // Only the 2 remaining images fit: creating a new one evicts one of them
+    cache.setMaximumCacheSize( (U64)(cache.getMemoryCacheSize() * 0.75 / NATRON_CACHE_LIMIT_PERCENT) );
+    cache.setMaximumInMemorySize(1.);
+    {
+        ImagePtr newImage;
+        cache.getOrCreate(newKey, params, 0, &newImage);
+    }
+    EXPECT_TRUE( cache.get(expensiveKey, &found) );
+    found.clear();
+    EXPECT_FALSE( cache.get(cheapKey, &found) );
+
+    cache.waitForDeleterThread();
+}
+
+///The request pass predicts the memory of the images of a frame from the region of interest of each node:
+///for a generator feeding a writer, one image of the project format per node. The number of frames rendered in parallel
+///is then limited so that the images of all of them fit in the cache.
+TEST_F(BaseTest, PredictedImagesMemory)
+{
+    NodePtr generator = createNode(_generatorPluginID);
+    NodePtr writer = createNode(_writeOIIOPluginID);
+
+    ASSERT_TRUE(generator && writer);
+
+    Format f(0, 0, 200, 200, "toto", 1.);
+    getApp()->getProject()->setOrAddProjectFormat(f);
+    connectNodes(generator, writer, 0, true);
+
+    RenderStatsPtr stats( new RenderStats(false) );
+    EffectInstancePtr writerEffect = writer->getEffectInstance();
+    {
+        ParallelRenderArgsSetter::CtorArgsPtr tlsArgs(new ParallelRenderArgsSetter::CtorArgs);
+        tlsArgs->time = 1;
+        tlsArgs->view = ViewIdx(0);
+        tlsArgs->isRenderUserInteraction = false;
+        tlsArgs->isSequential = true;
+        tlsArgs->abortInfo = AbortableRenderInfo::create(true, 0);
+        tlsArgs->treeRoot = writer;
+        tlsArgs->textureIndex = 0;
+        tlsArgs->timeline = getApp()->getTimeLine();
+        tlsArgs->activeRotoPaintNode = NodePtr();
+        tlsArgs->activeRotoDrawableItem = RotoDrawableItemPtr();
+        tlsArgs->isDoingRotoNeatRender = false;
+        tlsArgs->isAnalysis = false;
+        tlsArgs->draftMode = false;
+        tlsArgs->viewsRenderedConcurrently = false;
+        tlsArgs->stats = stats;
+        ParallelRenderArgsSetter frameRenderArgs(tlsArgs);
+
+        U64 nodeHash;
+        RectD rod;
+        ASSERT_TRUE( writerEffect->getRenderHash(1, ViewIdx(0), &nodeHash) );
+        ASSERT_NE( eStatusFailed, writerEffect->getRegionOfDefinition_public(nodeHash, 1, RenderScale(1.), ViewIdx(0), &rod) );
+        ASSERT_NE( eStatusFailed, frameRenderArgs.computeRequestPass(0, rod) );
+    }
+    appPTR->getAppTLS()->cleanupTLSForThread();
+
+    U64 expectedMemory = 0;
+    NodePtr nodes[2] = {generator, writer};
+    for (int i = 0; i < 2; ++i) {
+        EffectInstancePtr effect = nodes[i]->getEffectInstance();
+        expectedMemory += (U64)f.area() * effect->getComponents(-1).getNumComponents() * getSizeOfForBitDepth( effect->getBitDepth(-1) );
+    }
+    U64 predicted, actual;
+    stats->getImagesMemory(&predicted, &actual);
+    EXPECT_EQ(expectedMemory, predicted);
+    EXPECT_EQ(0u, actual);
+
+    // The images of 3 frames fit in the cache, not those of 4
+    EXPECT_EQ( 3, OutputSchedulerThread::getMaxParallelRendersForMemory(8, predicted * 3.5, predicted) );
+    EXPECT_EQ( 8, OutputSchedulerThread::getMaxParallelRendersForMemory(8, predicted * 100., predicted) );
+    // At least one frame is rendered even if its images do not fit
+    EXPECT_EQ( 1, OutputSchedulerThread::getMaxParallelRendersForMemory(8, predicted * 0.5, predicted) );
+    // Nothing rendered yet: no limit
+    EXPECT_EQ( 8, OutputSchedulerThread::getMaxParallelRendersForMemory(8, predicted, 0) );
+}
+
+///Benchmark: render 10 frames of a JoinViews whose views are both taken from the left view of the generator by a OneView node.
+///The views are rendered concurrently and the generator, view-invariant through the OneView, is rendered once per frame:
+///rendering the 2 views should take about as long as rendering the left view only.
+TEST_F(BaseTest, MultiViewRender)
+{
+    const int nFrames = 10;
+    KnobIPtr frameRange = getApp()->getProject()->getKnobByName("frameRange");
+    ASSERT_TRUE(frameRange);
+    KnobIntPtr knob = toKnobInt(frameRange);
+    ASSERT_TRUE(knob);
+    knob->setValue(1, ViewSpec::all(), 0);
+    knob->setValue(nFrames, ViewSpec::all(), 1);
+
+    Format f(0, 0, 2048, 1556, "2K", 1.);
+    getApp()->getProject()->setOrAddProjectFormat(f);
+
+    const QString& binPath = appPTR->getApplicationBinaryPath();
+    double renderTime[2];
+    for (int nViews = 1; nViews <= 2; ++nViews) {
+        std::vector<std::string> views;
+        views.push_back("Left");
+        if (nViews == 2) {
+            views.push_back("Right");
+        }
+        getApp()->getProject()->createProjectViews(views);
+
+        NodePtr generator = createNode(_generatorPluginID);
+        NodePtr oneView = createNode( QString::fromUtf8(PLUGINID_NATRON_ONEVIEW) );
+        NodePtr joinViews = createNode( QString::fromUtf8(PLUGINID_NATRON_JOINVIEWS) );
+        NodePtr writer = createNode(_writeOIIOPluginID);
+        ASSERT_TRUE(generator && oneView && joinViews && writer);
+        ASSERT_EQ( nViews, joinViews->getMaxInputCount() );
+
+        connectNodes(generator, oneView, 0, true);
+        for (int i = 0; i < nViews; ++i) {
+            connectNodes(oneView, joinViews, i, true);
+        }
+        connectNodes(joinViews, writer, 0, true);
+
+        QString filePath = binPath + QString::fromUtf8("/test_multiview_%V.###.jpg");
+        writer->setOutputFilesForWriter( filePath.toStdString() );
+
+        std::list<AppInstance::RenderWork> works;
+        AppInstance::RenderWork w;
+        w.writer = toOutputEffectInstance( writer->getEffectInstance() );
+        assert(w.writer);
+        w.firstFrame = INT_MIN;
+        w.lastFrame = INT_MAX;
+        w.frameStep = INT_MIN;
+        w.useRenderStats = false;
+        works.push_back(w);
+
+        // The nodes are new: nothing is read from the cache of the previous iteration
+        TimeLapse timer;
+        getApp()->startWritersRendering(false, works);
+        renderTime[nViews - 1] = timer.getTimeSinceCreation();
+
+        for (int i = 0; i < nViews; ++i) {
+            for (int frame = 1; frame <= nFrames; ++frame) {
+                QString framePath = binPath + QString::fromUtf8("/test_multiview_%1.%2.jpg").arg( QString::fromUtf8( views[i].c_str() ) ).arg( frame, 3, 10, QChar::fromLatin1('0') );
+                EXPECT_TRUE( QFile::exists(framePath) );
+                QFile::remove(framePath);
+            }
+        }
+    }
+    std::cout << nFrames << " frames: 1 view " << renderTime[0] << " s, 2 views " << renderTime[1] << " s" << std::endl;
+}
+
+///Benchmark: the overhead of calling a trivial after frame render callback for a 10000 frames render.
+///Interpreting a script for each frame, which also inspects the signature of the function, is compared with
+///calling the function looked up once with a tuple of arguments.
+TEST_F(BaseTest, PythonCallbackOverhead)
+{
+    const int nFrames = 10000;
+    std::string error;
+    ASSERT_TRUE( NATRON_PYTHON_NAMESPACE::interpretPythonScript("def trivialFrameCallback(frame, thisNode, app):\n    pass\n", &error, 0) );
+
+    NodePtr writer = createNode(_writeOIIOPluginID);
+    ASSERT_TRUE(writer);
+    std::string appID = getApp()->getAppIDString();
+    std::string nodeName = appID + "." + writer->getFullyQualifiedName();
+
+    TimeLapse scriptTimer;
+    for (int frame = 1; frame <= nFrames; ++frame) {
+        std::vector<std::string> args;
+        NATRON_PYTHON_NAMESPACE::getFunctionArguments("trivialFrameCallback", &error, &args);
+        ASSERT_EQ( (std::size_t)3, args.size() );
+
+        std::stringstream ss;
+        ss << "trivialFrameCallback(" << frame << ", " << nodeName << ", " << appID << ")\n";
+        ASSERT_TRUE( NATRON_PYTHON_NAMESPACE::interpretPythonScript(ss.str(), &error, 0) );
+    }
+    double scriptTime = scriptTimer.getTimeSinceCreation();
+
+    TimeLapse callTimer;
+    {
+        PythonGILLocker pgl;
+        PythonCallback callback("after frame render", "frame, thisNode, app");
+        PyObject* thisNode = PythonCallback::getVariable(nodeName);
+        PyObject* app = PythonCallback::getVariable(appID);
+        ASSERT_TRUE(thisNode && app);
+        for (int frame = 1; frame <= nFrames; ++frame) {
+            ASSERT_TRUE( callback.setFunction("trivialFrameCallback", &error) );
+
+            PyObject* args = PyTuple_New(3);
+            PyTuple_SET_ITEM( args, 0, PythonCallback::makeIntArgument(frame) );
+            Py_INCREF(thisNode);
+            PyTuple_SET_ITEM(args, 1, thisNode);
+            Py_INCREF(app);
+            PyTuple_SET_ITEM(args, 2, app);
+            bool ok = callback.call(args, &error, 0);
+            Py_DECREF(args);
+            ASSERT_TRUE(ok);
+        }
+        Py_DECREF(thisNode);
+        Py_DECREF(app);
+    }
+    double callTime = callTimer.getTimeSinceCreation();
+
+    std::cout << nFrames << " callbacks: interpreted scripts " << scriptTime << " s, direct calls " << callTime << " s" << std::endl;
+    EXPECT_LT(callTime, scriptTime);
+}
+
 TEST_F(BaseTest, SetValues)
 {
     NodePtr generator = createNode(_generatorPluginID);
@@ -0,0 +1,207 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <sstream>
+#include <gtest/gtest.h>
+
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
+#include <yaml-cpp/yaml.h>
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
+
+#include "Serialization/BinarySerialization.h"
+#include "Serialization/ProjectSerialization.h"
+#include "Serialization/RectISerialization.h"
+#include "Serialization/SerializationIO.h"
+
+NATRON_NAMESPACE_USING
+
+static const char* kTestProject =
+    "Nodes:\n"
+    "  - PluginID: net.sf.openfx.BlurPlugin\n"
+    "    ScriptName: Blur1\n"
+    "    Params: [{ScriptName: size, Value: [3.5, 2]}]\n"
+    "  - {PluginID: fr.inria.built-in.RotoPaint, ScriptName: RotoPaint1, Points: [[0, 1, 2], [3, 4, 5]], Roto: {}}\n"
+    "  - {PluginID: fr.inria.built-in.Text, ScriptName: Text1, Params: [{ScriptName: text, Value: \"123\"}]}\n"
+    "Frame: 12\n"
+    "NatronVersion: {Version: [2, 3, 0], Branch: master, Commit: abc, OS: Linux, Bits: 64}\n";
+
+// yaml-cpp does not preserve the order of map keys, compare the trees structurally
+static bool
+isSameTree(const YAML::Node& a,
+           const YAML::Node& b)
+{
+    if ( a.Type() != b.Type() ) {
+        return false;
+    }
+    switch ( a.Type() ) {
+    case YAML::NodeType::Scalar:
+        return a.Scalar() == b.Scalar();
+    case YAML::NodeType::Sequence:
+        if ( a.size() != b.size() ) {
+            return false;
+        }
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if ( !isSameTree(a[i], b[i]) ) {
+                return false;
+            }
+        }
+
+        return true;
+    case YAML::NodeType::Map:
+        if ( a.size() != b.size() ) {
+            return false;
+        }
+        for (YAML::const_iterator it = a.begin(); it != a.end(); ++it) {
+            const std::string& key = it->first.Scalar();
+            if ( !b[key] || !isSameTree(it->second, b[key]) ) {
+                return false;
+            }
+        }
+
+        return true;
+    default:
+        return true;
+    }
+}
+
+TEST(BinarySerialization,
+     RoundTrip)
+{
+    YAML::Node original = YAML::Load(kTestProject);
+    std::stringstream ss;
+
+    SERIALIZATION_NAMESPACE::writeBinaryNode(ss, original);
+    ASSERT_TRUE( SERIALIZATION_NAMESPACE::isBinaryEncoded(ss) );
+
+    YAML::Node decoded = SERIALIZATION_NAMESPACE::readBinaryNode(ss);
+    EXPECT_TRUE( isSameTree(original, decoded) ) << "Binary encoding must be lossless";
+    EXPECT_EQ( std::string("!"), decoded["Nodes"][2]["Params"][0]["Value"].Tag() ) << "Quoted scalars must remain quoted";
+    EXPECT_EQ( std::string("?"), decoded["Frame"].Tag() );
+
+    // Going through YAML text again must not change anything either
+    YAML::Emitter em;
+    em << decoded;
+    EXPECT_TRUE( isSameTree( original, YAML::Load( em.c_str() ) ) );
+
+    std::stringstream yaml(kTestProject);
+    EXPECT_FALSE( SERIALIZATION_NAMESPACE::isBinaryEncoded(yaml) );
+}
+
+TEST(BinarySerialization,
+     LazyAccess)
+{
+    std::stringstream ss;
+
+    SERIALIZATION_NAMESPACE::writeBinaryNode( ss, YAML::Load(kTestProject) );
+    std::string buf = ss.str();
+
+    SERIALIZATION_NAMESPACE::BinaryReader reader( buf.data(), buf.size() );
+    const std::vector<SERIALIZATION_NAMESPACE::BinaryReader::TOCEntry>& toc = reader.getTableOfContents();
+    ASSERT_EQ( (std::size_t)3, toc.size() );
+    EXPECT_EQ( std::string("Blur1"), toc[0].name );
+    EXPECT_EQ( std::string("RotoPaint1"), toc[1].name );
+    EXPECT_EQ( std::string("Text1"), toc[2].name );
+
+    EXPECT_EQ( std::string("4"), reader.getEntry(1).find("Points").at(1).at(1).getScalar() );
+    EXPECT_EQ( std::string("12"), reader.getRoot().find("Frame").getScalar() );
+    EXPECT_FALSE( reader.getRoot().find("DoesNotExist").isValid() );
+
+    // Corrupted buffers must be rejected
+    EXPECT_THROW( SERIALIZATION_NAMESPACE::BinaryReader( buf.data(), 10 ), std::exception );
+}
+
+TEST(BinarySerialization,
+     SerializationObject)
+{
+    SERIALIZATION_NAMESPACE::RectISerialization rect;
+
+    rect.x1 = -3;
+    rect.y1 = 4;
+    rect.x2 = 1920;
+    rect.y2 = 1080;
+
+    std::stringstream ss;
+    SERIALIZATION_NAMESPACE::writeBinary(ss, rect);
+
+    // read() detects the binary encoding
+    SERIALIZATION_NAMESPACE::RectISerialization decoded;
+    SERIALIZATION_NAMESPACE::read(ss, &decoded);
+    EXPECT_EQ(rect.x1, decoded.x1);
+    EXPECT_EQ(rect.y1, decoded.y1);
+    EXPECT_EQ(rect.x2, decoded.x2);
+    EXPECT_EQ(rect.y2, decoded.y2);
+}
+
+TEST(BinarySerialization,
+     QuotedScalars)
+{
+    // Encode straight from the YAML text, then emit back to YAML
+    YAML::Emitter em;
+    em << YAML::BeginMap;
+    em << YAML::Key << "Number" << YAML::Value << 123;
+    em << YAML::Key << "String" << YAML::Value << YAML::DoubleQuoted << "123";
+    em << YAML::EndMap;
+
+    std::stringstream yaml( em.c_str() );
+    std::stringstream ss;
+    SERIALIZATION_NAMESPACE::writeBinaryFromYAML(yaml, ss);
+    std::string buf = ss.str();
+
+    SERIALIZATION_NAMESPACE::BinaryReader reader( buf.data(), buf.size() );
+    EXPECT_FALSE( reader.getRoot().find("Number").isQuotedScalar() );
+    EXPECT_TRUE( reader.getRoot().find("String").isQuotedScalar() );
+
+    YAML::Emitter converted;
+    reader.getRoot().emit(converted);
+    EXPECT_EQ( std::string( em.c_str() ), std::string( converted.c_str() ) );
+}
+
+TEST(BinarySerialization,
+     DeferredProjectDecoding)
+{
+    std::stringstream ss;
+
+    SERIALIZATION_NAMESPACE::writeBinaryNode( ss, YAML::Load(kTestProject) );
+
+    SERIALIZATION_NAMESPACE::ProjectSerialization project;
+    SERIALIZATION_NAMESPACE::read(ss, &project);
+    ASSERT_EQ( (std::size_t)3, project._nodes.size() );
+    EXPECT_EQ( 12, project._timelineCurrent );
+
+    SERIALIZATION_NAMESPACE::NodeSerializationPtr roto = *(++project._nodes.begin());
+    EXPECT_EQ( std::string("RotoPaint1"), roto->_nodeScriptName );
+    EXPECT_TRUE(roto->_rotoContextPayload) << "The Roto payload must not be decoded before it is accessed";
+    EXPECT_FALSE(roto->_rotoContext);
+    EXPECT_TRUE( roto->getRotoContext() );
+    EXPECT_FALSE(roto->_rotoContextPayload);
+
+    // Decoding the remaining payloads releases the buffer
+    project.decodeDeferredPayloads();
+    for (SERIALIZATION_NAMESPACE::NodeSerializationList::const_iterator it = project._nodes.begin(); it != project._nodes.end(); ++it) {
+        EXPECT_FALSE( (*it)->_rotoContextPayload );
+        EXPECT_FALSE( (*it)->_trackerContextPayload );
+    }
+}
@@ -0,0 +1,246 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include "Engine/LRUHashTable.h"
+
+NATRON_NAMESPACE_USING
+
+namespace {
+// One access of a cache trace: the key of the image, its size and the time it takes to render it
+struct TraceAccess
+{
+    unsigned long long key;
+    std::size_t size;
+    double cost;
+};
+
+struct TraceEntry
+{
+    std::size_t size;
+    double cost;
+
+    std::size_t getSizeInBytesFromParams() const
+    {
+        return size;
+    }
+
+    double getRenderCost() const
+    {
+        return cost;
+    }
+};
+
+typedef boost::shared_ptr<TraceEntry> TraceEntryPtr;
+typedef BoostLRUHashTable<unsigned long long, TraceEntryPtr> TraceContainer;
+
+struct ReplayResults
+{
+    int nMisses;
+    double recomputeTime; // total render time of the misses
+};
+
+// Replays the trace through a container holding at most capacity bytes
+ReplayResults
+replayTrace(const std::vector<TraceAccess>& trace,
+            std::size_t capacity,
+            bool costAware)
+{
+    TraceContainer container;
+
+    container.setCostAwareEvictionEnabled(costAware);
+
+    ReplayResults results;
+    results.nMisses = 0;
+    results.recomputeTime = 0.;
+    std::size_t cacheSize = 0;
+    for (std::vector<TraceAccess>::const_iterator it = trace.begin(); it != trace.end(); ++it) {
+        if ( container(it->key) != container.end() ) {
+            continue;
+        }
+        ++results.nMisses;
+        results.recomputeTime += it->cost;
+        while ( cacheSize + it->size > capacity ) {
+            std::pair<unsigned long long, TraceEntryPtr> evicted = container.evict();
+            if (!evicted.second) {
+                break;
+            }
+            cacheSize -= evicted.second->size;
+        }
+        TraceEntryPtr entry(new TraceEntry);
+        entry->size = it->size;
+        entry->cost = it->cost;
+        container.insert(it->key, entry);
+        cacheSize += it->size;
+    }
+
+    return results;
+}
+
+/*
+ * A compositing session: Read1 -> Defocus -> Grade -> Merge(B) <- Read2 (A), played in a loop over 50 frames
+ * while the Grade is being tweaked, so that the Grade and Merge results change at each loop but the Defocus
+ * results could be reused if they were kept in the cache.
+ */
+void
+makeCompositingTrace(std::vector<TraceAccess>* trace)
+{
+    const std::size_t imageSize = 1920 * 1080 * 4 * sizeof(float);
+    const int nFrames = 50;
+    const int nLoops = 10;
+
+    for (int loop = 0; loop < nLoops; ++loop) {
+        for (int f = 0; f < nFrames; ++f) {
+            TraceAccess read1 = { 1000000ULL + f, imageSize, 0.005 };
+            TraceAccess defocus = { 2000000ULL + f, imageSize, 4. };
+            TraceAccess grade = { 3000000ULL + loop * 1000 + f, imageSize, 0.02 };
+            TraceAccess read2 = { 4000000ULL + f, imageSize, 0.005 };
+            TraceAccess merge = { 5000000ULL + loop * 1000 + f, imageSize, 0.05 };
+            trace->push_back(read1);
+            trace->push_back(defocus);
+            trace->push_back(grade);
+            trace->push_back(read2);
+            trace->push_back(merge);
+        }
+    }
+}
+
+/*
+ * Loads a trace recorded in a text file, one access per line: "key sizeInBytes renderTimeInSeconds"
+ */
+bool
+loadTraceFile(const char* filename,
+              std::vector<TraceAccess>* trace)
+{
+    std::ifstream ifile(filename);
+
+    if ( !ifile.is_open() ) {
+        return false;
+    }
+    TraceAccess access;
+    while (ifile >> access.key >> access.size >> access.cost) {
+        trace->push_back(access);
+    }
+
+    return !trace->empty();
+}
+} // anon namespace
+
+TEST(CacheEviction, EvictsEntriesNotInUse) {
+    TraceContainer container;
+
+    container.setCostAwareEvictionEnabled(true);
+
+    TraceEntryPtr cheap(new TraceEntry);
+    cheap->size = 100;
+    cheap->cost = 0.001;
+    TraceEntryPtr expensive(new TraceEntry);
+    expensive->size = 100;
+    expensive->cost = 1.;
+    container.insert(1, cheap);
+    container.insert(2, expensive);
+    expensive.reset();
+
+    // The cheap entry is used elsewhere: only the expensive one may be evicted
+    std::pair<unsigned long long, TraceEntryPtr> evicted = container.evict();
+    EXPECT_EQ(2ULL, evicted.first);
+    ASSERT_TRUE(evicted.second);
+    EXPECT_EQ(1., evicted.second->cost);
+
+    evicted = container.evict();
+    EXPECT_FALSE(evicted.second);
+
+    cheap.reset();
+    evicted = container.evict();
+    EXPECT_EQ(1ULL, evicted.first);
+}
+
+TEST(CacheEviction, CostIsReevaluatedAfterInsertion) {
+    TraceContainer container;
+
+    container.setCostAwareEvictionEnabled(true);
+
+    // Entries are inserted before being rendered
+    TraceEntryPtr first(new TraceEntry);
+    first->size = 100;
+    first->cost = 0.;
+    TraceEntryPtr second(new TraceEntry);
+    second->size = 100;
+    second->cost = 0.;
+    container.insert(1, first);
+    container.insert(2, second);
+    first->cost = 2.;
+    second->cost = 0.01;
+    first.reset();
+    second.reset();
+
+    EXPECT_EQ( 2ULL, container.evict().first );
+    EXPECT_EQ( 1ULL, container.evict().first );
+}
+
+// Replays access traces through both eviction policies and reports the time spent re-rendering evicted entries.
+// Set NATRON_CACHE_TRACE_FILE to replay a recorded trace in addition to the built-in one.
+TEST(CacheEviction, ReplayBenchmark) {
+    std::vector<TraceAccess> trace;
+
+    makeCompositingTrace(&trace);
+
+    // Room for 100 images, the 50 Defocus results fit
+    const std::size_t capacity = 100 * trace.front().size;
+    ReplayResults lru = replayTrace(trace, capacity, false);
+    ReplayResults costAware = replayTrace(trace, capacity, true);
+    std::cout << "Compositing trace (" << trace.size() << " accesses): LRU " << lru.nMisses << " misses, "
+              << lru.recomputeTime << "s re-rendering; cost aware " << costAware.nMisses << " misses, "
+              << costAware.recomputeTime << "s re-rendering" << std::endl;
+    EXPECT_LT(costAware.recomputeTime, lru.recomputeTime);
+
+    const char* traceFile = std::getenv("NATRON_CACHE_TRACE_FILE");
+    if (traceFile) {
+        std::vector<TraceAccess> recordedTrace;
+        ASSERT_TRUE( loadTraceFile(traceFile, &recordedTrace) ) << traceFile;
+        std::size_t totalSize = 0;
+        for (std::vector<TraceAccess>::const_iterator it = recordedTrace.begin(); it != recordedTrace.end(); ++it) {
+            totalSize += it->size;
+        }
+        // Replay with caches holding a fraction of all the accessed data
+        for (int percent = 5; percent <= 40; percent *= 2) {
+            std::size_t recordedCapacity = totalSize / 100 * percent;
+            lru = replayTrace(recordedTrace, recordedCapacity, false);
+            costAware = replayTrace(recordedTrace, recordedCapacity, true);
+            std::cout << traceFile << " (" << percent << "% of the accessed data): LRU " << lru.nMisses << " misses, "
+                      << lru.recomputeTime << "s re-rendering; cost aware " << costAware.nMisses << " misses, "
+                      << costAware.recomputeTime << "s re-rendering" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,117 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Engine/CacheStorageCodec.h"
+
+NATRON_NAMESPACE_USING
+using namespace NATRON_NAMESPACE::CacheStorageCodec;
+
+TEST(CacheStorageCodec, HalfRoundTrip) {
+    // Every half that is not a NaN converts to a float and back to itself
+    for (int i = 0; i < 0x10000; ++i) {
+        unsigned short h = (unsigned short)i;
+        float f = halfToFloat(h);
+        if (f != f) {
+            EXPECT_NE( floatToHalf(f), floatToHalf(0.f) );
+            continue;
+        }
+        EXPECT_EQ( h, floatToHalf(f) ) << i;
+    }
+
+    EXPECT_EQ( 1.f, halfToFloat( floatToHalf(1.f) ) );
+    EXPECT_EQ( 65504.f, halfToFloat( floatToHalf(65504.f) ) );
+    EXPECT_TRUE( std::isinf( halfToFloat( floatToHalf(1e6f) ) ) );
+    EXPECT_EQ( 0.f, halfToFloat( floatToHalf(1e-10f) ) );
+
+    // Relative error of normalized values is at most half an ulp: 2^-11
+    for (int i = 0; i < 100000; ++i) {
+        float f = std::pow(2.f, -14.f + 29.f * i / 100000.f);
+        EXPECT_LE(std::fabs(halfToFloat( floatToHalf(f) ) - f) / f, 1.f / 2048.f) << f;
+    }
+}
+
+TEST(CacheStorageCodec, LosslessRoundTrip) {
+    // A smooth float RGBA gradient, similar to a rendered image
+    const int width = 1024;
+    const int height = 512;
+    std::vector<float> image(width * height * 4);
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float* p = &image[(y * width + x) * 4];
+            p[0] = x / (float)width;
+            p[1] = y / (float)height;
+            p[2] = 0.5f;
+            p[3] = 1.f;
+        }
+    }
+    std::size_t size = image.size() * sizeof(float);
+    std::vector<char> compressed;
+    ASSERT_TRUE( compressBuffer( (const char*)&image[0], size, sizeof(float), 4, &compressed ) );
+    EXPECT_LT( compressed.size(), size );
+    ASSERT_EQ( size, getDecompressedSize( &compressed[0], compressed.size() ) );
+    std::vector<float> decompressed(image.size());
+    ASSERT_TRUE( decompressBuffer( &compressed[0], compressed.size(), (char*)&decompressed[0], size ) );
+    EXPECT_EQ( 0, std::memcmp( &image[0], &decompressed[0], size ) );
+    std::cout << "Float RGBA gradient: compression ratio " << (double)size / compressed.size() << std::endl;
+
+    // 8-bit data with runs and noise, the size is not a multiple of the block size nor of the pixel size
+    std::vector<char> bytes(3 * NATRON_CACHE_CODEC_BLOCK_SIZE + 1001);
+    std::srand(1);
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = (i / 5000) % 2 ? (char)(std::rand() & 0xff) : (char)(i / 10000);
+    }
+    ASSERT_TRUE( compressBuffer( &bytes[0], bytes.size(), 1, 4, &compressed ) );
+    std::vector<char> decompressedBytes( bytes.size() );
+    ASSERT_TRUE( decompressBuffer( &compressed[0], compressed.size(), &decompressedBytes[0], bytes.size() ) );
+    EXPECT_TRUE(bytes == decompressedBytes);
+
+    // Corrupted buffers are rejected
+    compressed[compressed.size() / 2] ^= 0x5a;
+    compressed.resize(compressed.size() - 1);
+    EXPECT_EQ( 0U, getDecompressedSize( &compressed[0], compressed.size() ) );
+    EXPECT_FALSE( decompressBuffer( &compressed[0], compressed.size(), &decompressedBytes[0], bytes.size() ) );
+}
+
+TEST(CacheStorageCodec, IncompressibleData) {
+    std::vector<char> noise(100000);
+
+    std::srand(2);
+    for (std::size_t i = 0; i < noise.size(); ++i) {
+        noise[i] = (char)(std::rand() & 0xff);
+    }
+    std::vector<char> compressed;
+    EXPECT_FALSE( compressBuffer( &noise[0], noise.size(), 1, 4, &compressed ) );
+    EXPECT_TRUE( compressed.empty() );
+}
@@ -124,3 +124,38 @@ TEST(Curve, Basic)
 }
 
 
+
+TEST(Curve, KeyFramesSnapshot)
+{
+    Curve c;
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE( c.addKeyFrame( KeyFrame(i * 10., i) ) );
+    }
+
+    // The snapshot is shared until the curve changes
+    KeyFramesSnapshotPtr s1 = c.getKeyFramesSnapshot();
+    EXPECT_EQ( s1, c.getKeyFramesSnapshot() );
+    EXPECT_EQ( c.getKeyFramesVersion(), s1->getVersion() );
+    ASSERT_EQ( 10, (int)s1->getKeyFrames().size() );
+
+    KeyFramesSnapshot::const_iterator first, last;
+    s1->getKeyFramesInRange(15., 50., &first, &last);
+    ASSERT_EQ( 4, (int)(last - first) );
+    EXPECT_EQ( 20., first->getTime() );
+    EXPECT_EQ( 50., (last - 1)->getTime() );
+    s1->getKeyFramesInRange(91., 100., &first, &last);
+    EXPECT_TRUE(first == last);
+
+    U64 version = c.getKeyFramesVersion();
+    EXPECT_FALSE( c.addKeyFrame( KeyFrame(10., 42.) ) );
+    KeyFramesSnapshotPtr s2 = c.getKeyFramesSnapshot();
+    EXPECT_NE(s1, s2);
+    EXPECT_GT(c.getKeyFramesVersion(), version);
+    EXPECT_EQ( 1., s1->getKeyFrames()[1].getValue() ); // the previous snapshot is left untouched
+    EXPECT_EQ( 42., s2->getKeyFrames()[1].getValue() );
+
+    c.clearKeyFrames();
+    EXPECT_TRUE( c.getKeyFramesSnapshot()->empty() );
+    EXPECT_EQ( 10, (int)s2->getKeyFrames().size() );
+}
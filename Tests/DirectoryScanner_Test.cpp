@@ -0,0 +1,230 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifndef __NATRON_WIN32__
+#include <sys/types.h>
+#include <utime.h>
+#endif
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QString>
+
+#include "Engine/DirectoryScanner.h"
+#include "Engine/Timer.h"
+
+NATRON_NAMESPACE_USING
+
+namespace {
+// A directory in the temporary location, removed with its files when the test ends
+class TemporaryDirectory
+{
+    QDir _dir;
+    QStringList _files;
+
+public:
+
+    TemporaryDirectory(const QString& name)
+        : _dir( QDir::temp() )
+        , _files()
+    {
+        _dir.mkdir(name);
+        _dir.cd(name);
+    }
+
+    ~TemporaryDirectory()
+    {
+        for (int i = 0; i < _files.size(); ++i) {
+            if ( !QFile::remove(_files[i]) ) {
+                _dir.rmdir(_files[i]);
+            }
+        }
+        QString path = _dir.absolutePath();
+        _dir.cdUp();
+        _dir.rmdir(path);
+    }
+
+    std::string getPath() const
+    {
+        return _dir.absolutePath().toStdString();
+    }
+
+    void createFile(const QString& name)
+    {
+        QFile file( _dir.absoluteFilePath(name) );
+
+        file.open(QIODevice::WriteOnly);
+        _files << file.fileName();
+    }
+
+    void createDir(const QString& name)
+    {
+        _dir.mkdir(name);
+        _files << _dir.absoluteFilePath(name);
+    }
+};
+
+QString
+getFrameFileName(const char* prefix,
+                 int frame,
+                 const char* suffix)
+{
+    return QString::fromUtf8(prefix) + QString::number(frame).rightJustified( 4, QChar::fromLatin1('0') ) + QString::fromUtf8(suffix);
+}
+} // anon namespace
+
+TEST(DirectoryScanner, FilePatternSignature) {
+    EXPECT_EQ( std::string("plate_v/./.exr"), DirectoryScanner::getFilePatternSignature("plate_v2.0001.exr") );
+    EXPECT_EQ( DirectoryScanner::getFilePatternSignature("plate_v2.0001.exr"), DirectoryScanner::getFilePatternSignature("plate_v2.1234.exr") );
+    // Frames without padding
+    EXPECT_EQ( DirectoryScanner::getFilePatternSignature("test_9.png"), DirectoryScanner::getFilePatternSignature("test_10.png") );
+    EXPECT_NE( DirectoryScanner::getFilePatternSignature("test_1.png"), DirectoryScanner::getFilePatternSignature("test_1.jpg") );
+    EXPECT_EQ( std::string("readme.txt"), DirectoryScanner::getFilePatternSignature("readme.txt") );
+}
+
+TEST(DirectoryScanner, ListAndGroup) {
+    TemporaryDirectory dir( QString::fromUtf8("NatronUnitTestDirectoryScanner") );
+
+    for (int i = 1; i <= 100; ++i) {
+        dir.createFile( getFrameFileName("plate.", i, ".exr") );
+    }
+    for (int i = 1; i <= 10; ++i) {
+        dir.createFile( getFrameFileName("Other_", i, ".dpx") );
+    }
+    dir.createFile( QString::fromUtf8("readme.txt") );
+    dir.createFile( QString::fromUtf8(".hidden") );
+    dir.createDir( QString::fromUtf8("subdir") );
+
+    DirectoryContentPtr content = DirectoryScanner::scanDirectory( dir.getPath() + "/" );
+    ASSERT_TRUE(content);
+    EXPECT_EQ( dir.getPath(), content->getPath() );
+
+    const std::vector<DirectoryContent::Entry>& entries = content->getEntries();
+    ASSERT_EQ( 113, (int)entries.size() );
+    // Sorted case-insensitively
+    EXPECT_EQ( std::string(".hidden"), entries[0].name );
+    EXPECT_TRUE(entries[0].isHidden);
+    EXPECT_EQ( std::string("Other_0001.dpx"), entries[1].name );
+    EXPECT_EQ( std::string("plate.0001.exr"), entries[11].name );
+    EXPECT_EQ( std::string("subdir"), entries[112].name );
+    EXPECT_TRUE(entries[112].isDir);
+    EXPECT_FALSE(entries[111].isDir);
+
+    // .hidden, Other_, plate. and readme.txt
+    const std::vector<std::vector<std::size_t> >& groups = content->getFileGroups();
+    ASSERT_EQ( 4, (int)groups.size() );
+    EXPECT_EQ( 10, (int)groups[1].size() );
+    EXPECT_EQ( 100, (int)groups[2].size() );
+    EXPECT_EQ( std::string("plate.0100.exr"), entries[groups[2].back()].name );
+
+    std::vector<std::string> files;
+    content->getFilesStartingWith("PLATE.", &files);
+    EXPECT_EQ( 100, (int)files.size() );
+    files.clear();
+    content->getFilesStartingWith("", &files);
+    // Neither the directory nor the hidden file
+    EXPECT_EQ( 111, (int)files.size() );
+    files.clear();
+    content->getFilesStartingWith("plates", &files);
+    EXPECT_TRUE( files.empty() );
+
+    EXPECT_FALSE( DirectoryScanner::scanDirectory( dir.getPath() + "/subdir/missing" ) );
+}
+
+TEST(DirectoryScanner, Cache) {
+    TemporaryDirectory dir( QString::fromUtf8("NatronUnitTestDirectoryScannerCache") );
+    DirectoryScanner scanner;
+
+    dir.createFile( QString::fromUtf8("a.0001.exr") );
+    DirectoryContentPtr content = scanner.getDirectoryContent( dir.getPath() );
+    ASSERT_TRUE(content);
+    EXPECT_EQ( 1, (int)content->getEntries().size() );
+
+    // Modified right after being listed: the modification time may be the same, but the new file is seen
+    dir.createFile( QString::fromUtf8("a.0002.exr") );
+    content = scanner.getDirectoryContent( dir.getPath() );
+    ASSERT_TRUE(content);
+    EXPECT_EQ( 2, (int)content->getEntries().size() );
+
+#ifndef __NATRON_WIN32__
+    // A directory which was not modified for a while is only listed once
+    struct utimbuf times;
+    times.actime = times.modtime = time(NULL) - 3600;
+    ASSERT_EQ( 0, utime(dir.getPath().c_str(), &times) );
+    content = scanner.getDirectoryContent( dir.getPath() );
+    EXPECT_EQ( content, scanner.getDirectoryContent( dir.getPath() ) );
+    EXPECT_EQ( content, scanner.getDirectoryContent( dir.getPath() + "/" ) );
+
+    dir.createFile( QString::fromUtf8("a.0003.exr") );
+    DirectoryContentPtr modifiedContent = scanner.getDirectoryContent( dir.getPath() );
+    EXPECT_NE(content, modifiedContent);
+    EXPECT_EQ( 3, (int)modifiedContent->getEntries().size() );
+
+    scanner.clear();
+    ASSERT_EQ( 0, utime(dir.getPath().c_str(), &times) );
+    content = scanner.getDirectoryContent( dir.getPath() );
+    EXPECT_NE(content, modifiedContent);
+    EXPECT_EQ( 3, (int)content->getEntries().size() );
+#endif
+}
+
+// Reports the time to list a directory holding a large sequence with QDir, which reads the attributes of every file,
+// and with the scanner
+TEST(DirectoryScanner, Benchmark) {
+    TemporaryDirectory dir( QString::fromUtf8("NatronUnitTestDirectoryScannerBenchmark") );
+    const int nFrames = 20000;
+
+    for (int i = 1; i <= nFrames; ++i) {
+        dir.createFile( getFrameFileName("plate.", i, ".exr") );
+    }
+
+    TimeLapse qdirTimer;
+    QFileInfoList infos = QDir( QString::fromUtf8( dir.getPath().c_str() ) ).entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot, QDir::Name | QDir::IgnoreCase | QDir::DirsFirst);
+    qint64 totalSize = 0;
+    for (int i = 0; i < infos.size(); ++i) {
+        totalSize += infos[i].size();
+    }
+    double qdirTime = qdirTimer.getTimeSinceCreation();
+
+    TimeLapse scannerTimer;
+    DirectoryContentPtr content = DirectoryScanner::scanDirectory( dir.getPath() );
+    double scannerTime = scannerTimer.getTimeSinceCreation();
+
+    ASSERT_TRUE(content);
+    EXPECT_EQ( nFrames, infos.size() );
+    EXPECT_EQ( nFrames, (int)content->getEntries().size() );
+    EXPECT_EQ( 1, (int)content->getFileGroups().size() );
+    EXPECT_EQ( 0, totalSize );
+    std::cout << nFrames << " files: QDir " << qdirTime * 1000. << " ms, scanner " << scannerTime * 1000. << " ms" << std::endl;
+}
@@ -0,0 +1,749 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cfloat>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Engine/Image.h"
+#include "Engine/ImageKernels.h"
+
+NATRON_NAMESPACE_USING
+using namespace NATRON_NAMESPACE::ImageKernels;
+
+namespace {
+// A packed image of the given bounds, as Image stores them
+template <typename PIX>
+struct TestImage
+{
+    int x1, y1, x2, y2;
+    int nComps;
+    std::vector<PIX> data;
+
+    TestImage(int x1_,
+              int y1_,
+              int x2_,
+              int y2_,
+              int nComps_)
+        : x1(x1_), y1(y1_), x2(x2_), y2(y2_), nComps(nComps_), data( (x2_ - x1_) * (y2_ - y1_) * nComps_ ) {}
+
+    PIX* pixelAt(int x,
+                 int y)
+    {
+        if ( (x < x1) || (x >= x2) || (y < y1) || (y >= y2) ) {
+            return 0;
+        }
+
+        return &data[( (y - y1) * (x2 - x1) + (x - x1) ) * nComps];
+    }
+
+    const PIX* pixelAt(int x,
+                       int y) const
+    {
+        return const_cast<TestImage*>(this)->pixelAt(x, y);
+    }
+};
+
+template <typename PIX>
+PIX
+randomValue(int maxValue)
+{
+    if (maxValue == 1) {
+        return (PIX)( ( std::rand() % 2001 ) / 1000. - 0.5 ); // including values out of [0,1]
+    }
+
+    return (PIX)(std::rand() % (maxValue + 1));
+}
+
+template <typename PIX>
+void
+fillRandom(TestImage<PIX>* img,
+           int maxValue)
+{
+    for (std::size_t i = 0; i < img->data.size(); ++i) {
+        img->data[i] = randomValue<PIX>(maxValue);
+    }
+}
+
+template <typename PIX>
+PIX
+clampIfInt(float v,
+           int maxValue)
+{
+    if (maxValue == 1) {
+        return (PIX)v;
+    }
+
+    return (PIX)std::min(std::max(0.f, v), (float)maxValue);
+}
+
+// The per-pixel implementation of Image::applyMaskMix the kernels replace
+template <typename PIX>
+void
+referenceMaskMix(TestImage<PIX>* dstImg,
+                 const TestImage<PIX>* srcImg,
+                 const TestImage<PIX>* maskImg,
+                 bool masked,
+                 bool maskInvert,
+                 float mix,
+                 int maxValue)
+{
+    int dstNComps = dstImg->nComps;
+    int srcNComps = srcImg ? srcImg->nComps : 0;
+
+    for (int y = dstImg->y1; y < dstImg->y2; ++y) {
+        for (int x = dstImg->x1; x < dstImg->x2; ++x) {
+            PIX* dst_pixels = dstImg->pixelAt(x, y);
+            const PIX* src_pixels = srcImg ? srcImg->pixelAt(x, y) : 0;
+            float alpha = mix;
+            if (masked) {
+                const PIX* maskPixels = maskImg ? maskImg->pixelAt(x, y) : 0;
+                float maskScale;
+                if (maskPixels == 0) {
+                    maskScale = maskInvert ? 1.f : 0.f;
+                } else {
+                    maskScale = *maskPixels / float(maxValue);
+                    if (maskInvert) {
+                        maskScale = 1.f - maskScale;
+                    }
+                }
+                alpha = mix * maskScale;
+            }
+            if (src_pixels) {
+                for (int c = 0; c < dstNComps; ++c) {
+                    if (c < srcNComps) {
+                        float v = float(dst_pixels[c]) * alpha + (1.f - alpha) * float(src_pixels[c]);
+                        dst_pixels[c] = clampIfInt<PIX>(v, maxValue);
+                    }
+                }
+            } else {
+                for (int c = 0; c < dstNComps; ++c) {
+                    float v = float(dst_pixels[c]) * alpha;
+                    dst_pixels[c] = clampIfInt<PIX>(v, maxValue);
+                }
+            }
+        }
+    }
+}
+
+// The per-pixel implementation of Image::copyUnProcessedChannels the kernels replace
+template <typename PIX>
+void
+referenceCopyChannels(TestImage<PIX>* dstImg,
+                      const TestImage<PIX>* srcImg,
+                      bool doR,
+                      bool doG,
+                      bool doB,
+                      bool doA,
+                      int maxValue)
+{
+    int dstNComps = dstImg->nComps;
+    int srcNComps = srcImg ? srcImg->nComps : 0;
+
+    doR = doR && (dstNComps >= 2);
+    doG = doG && (dstNComps >= 2);
+    doB = doB && (dstNComps >= 3);
+    doA = doA && (dstNComps == 1 || dstNComps == 4);
+    for (int y = dstImg->y1; y < dstImg->y2; ++y) {
+        for (int x = dstImg->x1; x < dstImg->x2; ++x) {
+            PIX* dst_pixels = dstImg->pixelAt(x, y);
+            const PIX* src_pixels = srcImg ? srcImg->pixelAt(x, y) : 0;
+            PIX srcA = src_pixels ? maxValue : 0;
+            if ( ( (srcNComps == 1) || (srcNComps == 4) ) && src_pixels ) {
+                srcA = src_pixels[srcNComps - 1];
+            }
+            if (doR) {
+                dst_pixels[0] = (!src_pixels || 0 >= srcNComps) ? 0 : src_pixels[0];
+            }
+            if (doG) {
+                dst_pixels[1] = (!src_pixels || 1 >= srcNComps) ? 0 : src_pixels[1];
+            }
+            if (doB) {
+                dst_pixels[2] = (!src_pixels || 2 >= srcNComps) ? 0 : src_pixels[2];
+            }
+            if (doA) {
+                dst_pixels[dstNComps - 1] = srcA;
+            }
+        }
+    }
+}
+
+// Applies the row kernels to dstImg the way Image does: each row is cut in runs where the source and the mask are available or not
+template <typename PIX>
+void
+applyRowKernels(TestImage<PIX>* dstImg,
+                const TestImage<PIX>* srcImg,
+                const TestImage<PIX>* maskImg,
+                bool doCopy,
+                bool doR,
+                bool doG,
+                bool doB,
+                bool doA,
+                bool doMaskMix,
+                bool masked,
+                bool maskInvert,
+                float mix)
+{
+    int srcNComps = srcImg ? srcImg->nComps : 0;
+
+    for (int y = dstImg->y1; y < dstImg->y2; ++y) {
+        bool srcRow = srcImg && y >= srcImg->y1 && y < srcImg->y2;
+        bool maskRow = masked && maskImg && y >= maskImg->y1 && y < maskImg->y2;
+        int x = dstImg->x1;
+        while (x < dstImg->x2) {
+            int xEnd = dstImg->x2;
+            if (srcRow) {
+                xEnd = getRunEnd(x, xEnd, srcImg->x1, srcImg->x2);
+            }
+            if (maskRow) {
+                xEnd = getRunEnd(x, xEnd, maskImg->x1, maskImg->x2);
+            }
+            PIX* dst = dstImg->pixelAt(x, y);
+            const PIX* src = srcRow ? srcImg->pixelAt(x, y) : 0;
+            const PIX* mask = maskRow ? maskImg->pixelAt(x, y) : 0;
+            if (doCopy) {
+                copyChannelsRow(dst, dstImg->nComps, src, srcNComps, doR, doG, doB, doA, xEnd - x);
+            }
+            if (doMaskMix) {
+                maskMixRow(dst, dstImg->nComps, src, srcNComps, mask, masked, maskInvert, mix, xEnd - x);
+            }
+            x = xEnd;
+        }
+    }
+}
+
+template <typename PIX>
+void
+checkKernelsForDepth(int maxValue)
+{
+    std::srand(3);
+    for (int dstNComps = 1; dstNComps <= 4; ++dstNComps) {
+        for (int srcNComps = 0; srcNComps <= 4; ++srcNComps) {
+            // The source and the mask only partially overlap the destination
+            TestImage<PIX> dst(0, 0, 37, 5, dstNComps);
+            TestImage<PIX> src(3, 1, 30, 5, srcNComps ? srcNComps : 1);
+            TestImage<PIX> mask(-2, 0, 21, 4, 1);
+            fillRandom(&src, maxValue);
+            fillRandom(&mask, maxValue);
+            const TestImage<PIX>* srcPtr = srcNComps ? &src : 0;
+            for (int config = 0; config < 16; ++config) {
+                bool masked = (config & 1) != 0;
+                bool maskInvert = (config & 2) != 0;
+                bool withMask = (config & 4) != 0;
+                bool doR = (config & 8) != 0;
+                float mix = (config % 3) * 0.4f;
+                fillRandom(&dst, maxValue);
+                TestImage<PIX> expected = dst;
+                referenceCopyChannels(&expected, srcPtr, doR, !doR, true, maskInvert, maxValue);
+                referenceMaskMix(&expected, srcPtr, withMask ? &mask : 0, masked, maskInvert, mix, maxValue);
+                applyRowKernels(&dst, srcPtr, withMask ? &mask : 0, true, doR, !doR, true, maskInvert, true, masked, maskInvert, mix);
+                EXPECT_TRUE( std::memcmp( &dst.data[0], &expected.data[0], dst.data.size() * sizeof(PIX) ) == 0 )
+                    << "dstNComps=" << dstNComps << " srcNComps=" << srcNComps << " config=" << config;
+            }
+        }
+    }
+}
+
+// The per-pixel 2x2 halving of the pixels [0, 2 * n) of two rows of an image, as each mipmap level was built
+template <typename PIX>
+void
+referenceHalveRows(PIX* dst,
+                   const PIX* row0,
+                   const PIX* row1,
+                   int nComps,
+                   int n)
+{
+    const int sum = row1 ? 4 : 2;
+
+    for (int x = 0; x < n; ++x) {
+        for (int k = 0; k < nComps; ++k) {
+            const PIX a = row0[2 * x * nComps + k];
+            const PIX b = row0[(2 * x + 1) * nComps + k];
+            const PIX c = row1 ? row1[2 * x * nComps + k] : 0;
+            const PIX d = row1 ? row1[(2 * x + 1) * nComps + k] : 0;
+            dst[x * nComps + k] = (a + b + c + d) / sum;
+        }
+    }
+}
+
+template <typename PIX>
+void
+checkHalveRowBoxForDepth(int maxValue)
+{
+    std::srand(6);
+    for (int nComps = 1; nComps <= 4; ++nComps) {
+        for (int n = 0; n < 13; ++n) {
+            TestImage<PIX> src(0, 0, 2 * n, 2, nComps);
+            fillRandom(&src, maxValue);
+            const PIX* row0 = n ? src.pixelAt(0, 0) : 0;
+            const PIX* row1 = n ? src.pixelAt(0, 1) : 0;
+            for (int twoRows = 0; twoRows < 2; ++twoRows) {
+                std::vector<PIX> expected(n * nComps + 1), result(n * nComps + 1);
+                if (n) {
+                    referenceHalveRows(&expected[0], row0, twoRows ? row1 : 0, nComps, n);
+                }
+                halveRowBox(&result[0], row0, twoRows ? row1 : 0, nComps, n);
+                EXPECT_TRUE( std::memcmp( &expected[0], &result[0], expected.size() * sizeof(PIX) ) == 0 ) << "nComps " << nComps << " n " << n;
+            }
+        }
+    }
+}
+
+// An RGBA image of the given depth and bounds filled with the pixels of data
+template <typename PIX>
+ImagePtr
+createImage(const TestImage<PIX>& data,
+            ImageBitDepthEnum depth,
+            unsigned int mipMapLevel,
+            const RectD& rod)
+{
+    RectI bounds(data.x1, data.y1, data.x2, data.y2);
+    ImagePtr img( new Image(ImageComponents::getRGBAComponents(), rod, bounds, mipMapLevel, 1., depth,
+                            eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, true /*useBitmap*/) );
+    {
+        Image::WriteAccess acc = img->getWriteRights();
+        for (int y = data.y1; y < data.y2; ++y) {
+            std::memcpy( acc.pixelAt(data.x1, y), data.pixelAt(data.x1, y), (data.x2 - data.x1) * 4 * sizeof(PIX) );
+        }
+    }
+    img->markForRendered(bounds);
+
+    return img;
+}
+
+template <typename PIX>
+TestImage<PIX>
+readImage(const Image& img,
+          const RectI& rect)
+{
+    TestImage<PIX> ret(rect.x1, rect.y1, rect.x2, rect.y2, 4);
+    Image::ReadAccess acc = img.getReadRights();
+
+    for (int y = rect.y1; y < rect.y2; ++y) {
+        std::memcpy( ret.pixelAt(rect.x1, y), acc.pixelAt(rect.x1, y), rect.width() * 4 * sizeof(PIX) );
+    }
+
+    return ret;
+}
+
+template <typename PIX>
+struct BoxSum
+{
+    typedef int type;
+};
+
+template <>
+struct BoxSum<float>
+{
+    typedef float type;
+};
+
+// One level of the mipmap of the pixels of src within sampleBounds, as it was built per pixel:
+// the box filter averages the 2x2 pixels under each pixel, the tent filter weights the 4x4 pixels around by 1 3 3 1.
+// The weights of the pixels outside of sampleBounds are ignored.
+template <typename PIX>
+TestImage<PIX>
+referenceHalve(const TestImage<PIX>& src,
+               const RectI& sampleBounds,
+               const RectI& dstRect,
+               MipMapFilterEnum filter)
+{
+    static const float weights[4] = { 1.f, 3.f, 3.f, 1.f };
+    TestImage<PIX> dst(dstRect.x1, dstRect.y1, dstRect.x2, dstRect.y2, src.nComps);
+
+    for (int y = dstRect.y1; y < dstRect.y2; ++y) {
+        for (int x = dstRect.x1; x < dstRect.x2; ++x) {
+            for (int c = 0; c < src.nComps; ++c) {
+                if (filter == eMipMapFilterBox) {
+                    // integers are summed as int, like the kernels do after integral promotion
+                    typename BoxSum<PIX>::type sum = 0;
+                    int count = 0;
+                    for (int sy = 2 * y; sy < 2 * y + 2; ++sy) {
+                        for (int sx = 2 * x; sx < 2 * x + 2; ++sx) {
+                            if ( sampleBounds.contains(sx, sy) ) {
+                                sum += src.pixelAt(sx, sy)[c];
+                                ++count;
+                            }
+                        }
+                    }
+                    dst.pixelAt(x, y)[c] = sum / count;
+                } else {
+                    double sum = 0., sumWeights = 0.;
+                    for (int ky = 0; ky < 4; ++ky) {
+                        for (int kx = 0; kx < 4; ++kx) {
+                            if ( sampleBounds.contains(2 * x - 1 + kx, 2 * y - 1 + ky) ) {
+                                sum += weights[kx] * weights[ky] * src.pixelAt(2 * x - 1 + kx, 2 * y - 1 + ky)[c];
+                                sumWeights += weights[kx] * weights[ky];
+                            }
+                        }
+                    }
+                    dst.pixelAt(x, y)[c] = (PIX)(sum / sumWeights);
+                }
+            }
+        }
+    }
+
+    return dst;
+}
+
+// The mipmap of roi built level by level, each level keeping all the pixels that can be computed
+template <typename PIX>
+TestImage<PIX>
+referenceDownscale(const TestImage<PIX>& src,
+                   const RectI& roi,
+                   unsigned int levels,
+                   MipMapFilterEnum filter)
+{
+    RectI bounds(src.x1, src.y1, src.x2, src.y2);
+    TestImage<PIX> level = src;
+    RectI levelRoI = roi;
+    // The box filter reads the pixels of the image for the first level then those of the previous level's roi,
+    // the tent filter reads all the pixels of the image (they are all rendered)
+    RectI sampleBounds = bounds;
+
+    for (unsigned int i = 1; i <= levels; ++i) {
+        RectI dstRect = (filter == eMipMapFilterBox) ? levelRoI.downscalePowerOfTwoSmallestEnclosing(1) : sampleBounds.downscalePowerOfTwoSmallestEnclosing(1);
+        level = referenceHalve(level, sampleBounds, dstRect, filter);
+        levelRoI = levelRoI.downscalePowerOfTwoSmallestEnclosing(1);
+        sampleBounds = (filter == eMipMapFilterBox) ? levelRoI : dstRect;
+    }
+
+    return level;
+}
+
+template <typename PIX>
+void
+checkDownscaleMipMapForDepth(ImageBitDepthEnum depth,
+                             int maxValue)
+{
+    std::srand(8);
+    // Odd bounds and rois, including negative coordinates
+    const RectI bounds(-7, -3, 93, 58);
+    const RectI rois[3] = { bounds, RectI(-5, -2, 61, 41), RectI(3, 1, 4, 30) };
+    const RectD rod(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+    TestImage<PIX> srcData(bounds.x1, bounds.y1, bounds.x2, bounds.y2, 4);
+
+    fillRandom(&srcData, maxValue);
+    ImagePtr src = createImage(srcData, depth, 0, rod);
+    for (int r = 0; r < 3; ++r) {
+        for (unsigned int levels = 1; levels <= 3; ++levels) {
+            const RectI lastLevelRoI = rois[r].downscalePowerOfTwoSmallestEnclosing(levels);
+            TestImage<PIX> expected = referenceDownscale(srcData, rois[r], levels, eMipMapFilterBox);
+            ImagePtr dst( new Image(ImageComponents::getRGBAComponents(), rod, lastLevelRoI, levels, 1., depth,
+                                    eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, true) );
+            src->downscaleMipMap(rod, rois[r], 0, levels, true, dst.get(), eMipMapFilterBox);
+            TestImage<PIX> result = readImage<PIX>(*dst, lastLevelRoI);
+            for (int y = lastLevelRoI.y1; y < lastLevelRoI.y2; ++y) {
+                EXPECT_TRUE( std::memcmp( result.pixelAt(lastLevelRoI.x1, y), expected.pixelAt(lastLevelRoI.x1, y), lastLevelRoI.width() * 4 * sizeof(PIX) ) == 0 )
+                    << "roi " << r << " levels " << levels << " row " << y;
+            }
+            // all the source pixels are rendered
+            EXPECT_TRUE( dst->getMinimalRect(lastLevelRoI).isNull() ) << "roi " << r << " levels " << levels;
+        }
+    }
+}
+
+double
+benchmarkSeconds(std::clock_t start,
+                 std::clock_t end)
+{
+    return std::max<double>(1, end - start) / CLOCKS_PER_SEC;
+}
+} // anon namespace
+
+TEST(ImageKernels, MatchPerPixelImplementation) {
+    checkKernelsForDepth<float>(1);
+    checkKernelsForDepth<unsigned short>(65535);
+    checkKernelsForDepth<unsigned char>(255);
+}
+
+TEST(ImageKernels, HalveRowBox) {
+    checkHalveRowBoxForDepth<float>(1);
+    checkHalveRowBoxForDepth<unsigned short>(65535);
+    checkHalveRowBoxForDepth<unsigned char>(255);
+}
+
+TEST(ImageKernels, DownscaleMipMap) {
+    checkDownscaleMipMapForDepth<float>(eImageBitDepthFloat, 1);
+    checkDownscaleMipMapForDepth<unsigned short>(eImageBitDepthShort, 65535);
+    checkDownscaleMipMapForDepth<unsigned char>(eImageBitDepthByte, 255);
+}
+
+// With the tent filter, tiles downscaled separately must give the same image as a single downscale: the filter
+// reads the rendered pixels around each tile
+TEST(ImageKernels, DownscaleMipMapTentTiles) {
+    std::srand(9);
+    const RectI bounds(-7, -3, 93, 58);
+    const RectD rod(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+    TestImage<float> srcData(bounds.x1, bounds.y1, bounds.x2, bounds.y2, 4);
+
+    fillRandom(&srcData, 1);
+    ImagePtr src = createImage(srcData, eImageBitDepthFloat, 0, rod);
+    for (unsigned int levels = 1; levels <= 3; ++levels) {
+        const RectI dstBounds = bounds.downscalePowerOfTwoSmallestEnclosing(levels);
+        ImagePtr whole( new Image(ImageComponents::getRGBAComponents(), rod, dstBounds, levels, 1., eImageBitDepthFloat,
+                                  eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false) );
+        ImagePtr tiled( new Image(ImageComponents::getRGBAComponents(), rod, dstBounds, levels, 1., eImageBitDepthFloat,
+                                  eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false) );
+        src->downscaleMipMap(rod, bounds, 0, levels, false, whole.get(), eMipMapFilterTent);
+
+        // Tiles aligned on the pixels of the last level, as rendered
+        const int tileSize = 24 << levels >> 2;
+        const RectI aligned = bounds.roundPowerOfTwoSmallestEnclosing(levels);
+        for (int y = aligned.y1; y < aligned.y2; y += tileSize) {
+            for (int x = aligned.x1; x < aligned.x2; x += tileSize) {
+                RectI tile;
+                if ( RectI(x, y, x + tileSize, y + tileSize).intersect(bounds, &tile) ) {
+                    src->downscaleMipMap(rod, tile, 0, levels, false, tiled.get(), eMipMapFilterTent);
+                }
+            }
+        }
+
+        TestImage<float> expected = referenceDownscale(srcData, bounds, levels, eMipMapFilterTent);
+        TestImage<float> wholeData = readImage<float>(*whole, dstBounds);
+        TestImage<float> tiledData = readImage<float>(*tiled, dstBounds);
+        for (std::size_t i = 0; i < wholeData.data.size(); ++i) {
+            EXPECT_NEAR(wholeData.data[i], expected.data[i], 1e-5f) << "levels " << levels << " element " << i;
+            EXPECT_NEAR(tiledData.data[i], wholeData.data[i], 1e-6f) << "levels " << levels << " element " << i;
+        }
+    }
+}
+
+// Each pixel of the source is replicated 2^levels times, the last row and column up to the end of the output
+TEST(ImageKernels, UpscaleMipMap) {
+    std::srand(10);
+    const RectI srcBounds(-3, -2, 17, 11);
+    for (unsigned int levels = 1; levels <= 3; ++levels) {
+        const int scale = 1 << levels;
+        const RectD rod(srcBounds.x1 * scale, srcBounds.y1 * scale, srcBounds.x2 * scale, srcBounds.y2 * scale);
+        TestImage<float> srcData(srcBounds.x1, srcBounds.y1, srcBounds.x2, srcBounds.y2, 4);
+        fillRandom(&srcData, 1);
+        ImagePtr src = createImage(srcData, eImageBitDepthFloat, levels, rod);
+
+        // The output is a bit smaller than the upscaled source, and does not end on a source pixel boundary
+        const RectI dstBounds(srcBounds.x1 * scale, srcBounds.y1 * scale, srcBounds.x2 * scale - 3, srcBounds.y2 * scale - 5);
+        ImagePtr dst( new Image(ImageComponents::getRGBAComponents(), rod, dstBounds, 0, 1., eImageBitDepthFloat,
+                                eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, false) );
+        src->upscaleMipMap(srcBounds, levels, 0, dst.get());
+
+        TestImage<float> result = readImage<float>(*dst, dstBounds);
+        for (int y = dstBounds.y1; y < dstBounds.y2; ++y) {
+            for (int x = dstBounds.x1; x < dstBounds.x2; ++x) {
+                const int sx = std::min( srcBounds.x1 + (x - dstBounds.x1) / scale, srcBounds.x2 - 1 );
+                const int sy = std::min( srcBounds.y1 + (y - dstBounds.y1) / scale, srcBounds.y2 - 1 );
+                EXPECT_TRUE( std::memcmp( result.pixelAt(x, y), srcData.pixelAt(sx, sy), 4 * sizeof(float) ) == 0 ) << "levels " << levels << " at " << x << "," << y;
+            }
+        }
+    }
+}
+
+TEST(ImageKernels, Premult) {
+    std::vector<float> pix(4 * 7), expected;
+
+    std::srand(4);
+    for (std::size_t i = 0; i < pix.size(); ++i) {
+        pix[i] = randomValue<float>(1);
+    }
+    pix[3] = 0.f;
+    expected = pix;
+    for (int i = 0; i < 7; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            expected[i * 4 + c] = expected[i * 4 + c] * expected[i * 4 + 3];
+        }
+    }
+    std::vector<float> premult = pix;
+    premultRow(&premult[0], 7);
+    EXPECT_TRUE(premult == expected);
+
+    expected = pix;
+    for (int i = 0; i < 7; ++i) {
+        if (expected[i * 4 + 3] != 0) {
+            for (int c = 0; c < 3; ++c) {
+                expected[i * 4 + c] = expected[i * 4 + c] / expected[i * 4 + 3];
+            }
+        }
+    }
+    std::vector<float> unpremult = pix;
+    unpremultRow(&unpremult[0], 7);
+    EXPECT_TRUE(unpremult == expected);
+}
+
+TEST(ImageKernels, SanitizeNonFinite) {
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    // 11 values, so that both the vector and the scalar paths see replaced values
+    float pix[11] = { 0.5f, nan, -inf, 2.f, -3.f, inf, FLT_MAX, 0.f, nan, -inf, 1e-40f };
+    const float expected[11] = { 0.5f, 1.f, -FLT_MAX, 2.f, -3.f, FLT_MAX, FLT_MAX, 0.f, 1.f, -FLT_MAX, 1e-40f };
+
+    EXPECT_EQ( 5, sanitizeNonFiniteRow(pix, 11) );
+    for (int i = 0; i < 11; ++i) {
+        EXPECT_EQ(expected[i], pix[i]);
+    }
+    // A clean row is left untouched
+    EXPECT_EQ( 0, sanitizeNonFiniteRow(pix, 11) );
+}
+
+// A tile rendered by an effect producing NaN and infinite values, entirely masked out or mixed to 0:
+// the original pixels must be restored, the values being replaced before they are mixed
+TEST(ImageKernels, MaskMixNonFinite) {
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const RectI bounds(-2, -1, 11, 4);
+    const RectD rod(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+    TestImage<float> originalData(bounds.x1, bounds.y1, bounds.x2, bounds.y2, 4);
+    TestImage<float> renderedData(bounds.x1, bounds.y1, bounds.x2, bounds.y2, 4);
+
+    std::srand(11);
+    fillRandom(&originalData, 1);
+    for (std::size_t i = 0; i < renderedData.data.size(); ++i) {
+        renderedData.data[i] = (i % 5 == 0) ? ( (i % 2) ? inf : -inf ) : nan;
+    }
+    ImagePtr original = createImage(originalData, eImageBitDepthFloat, 0, rod);
+    ImagePtr mask( new Image(ImageComponents::getAlphaComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+                             eImagePremultiplicationOpaque, eImageFieldingOrderNone, false) );
+    {
+        Image::WriteAccess acc = mask->getWriteRights();
+        for (int y = bounds.y1; y < bounds.y2; ++y) {
+            std::fill( (float*)acc.pixelAt(bounds.x1, y), (float*)acc.pixelAt(bounds.x1, y) + bounds.width(), 0.f );
+        }
+    }
+
+    // Masked, with and without the alpha channel copied from the original, then unmasked with a mix of 0
+    for (int pass = 0; pass < 3; ++pass) {
+        std::bitset<4> processChannels;
+        processChannels.set();
+        if (pass == 1) {
+            processChannels[3] = false;
+        }
+        const bool masked = pass < 2;
+        ImagePtr rendered = createImage(renderedData, eImageBitDepthFloat, 0, rod);
+        int nbNonFiniteValues = 0;
+        rendered->copyUnProcessedChannelsAndApplyMaskMix(bounds, eImagePremultiplicationPremultiplied, eImagePremultiplicationPremultiplied,
+                                                         processChannels, original, true, true, masked ? mask.get() : 0, masked, false,
+                                                         masked ? 1.f : 0.f, &nbNonFiniteValues);
+        EXPECT_EQ( (int)renderedData.data.size(), nbNonFiniteValues ) << "pass " << pass;
+        TestImage<float> result = readImage<float>(*rendered, bounds);
+        EXPECT_TRUE( std::memcmp( &originalData.data[0], &result.data[0], originalData.data.size() * sizeof(float) ) == 0 ) << "pass " << pass;
+    }
+}
+
+// Reports the time spent by the host after the render of a 4K RGBA float tile, when the effect did not
+// process the red channel and is masked and mixed: channel copy then mask/mix per pixel, against the fused row kernels.
+TEST(ImageKernels, PostRenderBenchmark) {
+    const int width = 3840;
+    const int height = 2160;
+    TestImage<float> original(0, 0, width, height, 4);
+    TestImage<float> mask(0, 0, width, height, 1);
+    TestImage<float> rendered(0, 0, width, height, 4);
+
+    std::srand(5);
+    fillRandom(&original, 1);
+    fillRandom(&mask, 1);
+    fillRandom(&rendered, 1);
+
+    TestImage<float> before = rendered;
+    std::clock_t start = std::clock();
+    referenceCopyChannels(&before, &original, true, false, false, false, 1);
+    referenceMaskMix(&before, &original, &mask, true, false, 0.7f, 1);
+    std::clock_t beforeEnd = std::clock();
+
+    TestImage<float> after = rendered;
+    std::clock_t afterStart = std::clock();
+    applyRowKernels(&after, &original, &mask, true, true, false, false, false, true, true, false, 0.7f);
+    std::clock_t afterEnd = std::clock();
+
+    double beforeTime = benchmarkSeconds(start, beforeEnd);
+    double afterTime = benchmarkSeconds(afterStart, afterEnd);
+    std::cout << "4K RGBA float copy + mask/mix: per pixel " << beforeTime * 1000. << " ms, row kernels "
+              << afterTime * 1000. << " ms (" << beforeTime / afterTime << "x)" << std::endl;
+    EXPECT_TRUE( std::memcmp( &before.data[0], &after.data[0], before.data.size() * sizeof(float) ) == 0 );
+
+    // Unmasked mix only
+    before = rendered;
+    start = std::clock();
+    referenceMaskMix(&before, &original, (const TestImage<float>*)0, false, false, 0.5f, 1);
+    beforeEnd = std::clock();
+    after = rendered;
+    afterStart = std::clock();
+    applyRowKernels(&after, &original, (const TestImage<float>*)0, false, false, false, false, false, true, false, false, 0.5f);
+    afterEnd = std::clock();
+    beforeTime = benchmarkSeconds(start, beforeEnd);
+    afterTime = benchmarkSeconds(afterStart, afterEnd);
+    std::cout << "4K RGBA float mix: per pixel " << beforeTime * 1000. << " ms, row kernels "
+              << afterTime * 1000. << " ms (" << beforeTime / afterTime << "x)" << std::endl;
+    EXPECT_TRUE( std::memcmp( &before.data[0], &after.data[0], before.data.size() * sizeof(float) ) == 0 );
+}
+
+// Reports the time spent building the 4 first mipmap levels of a 4K RGBA float image, level by level
+// with the per-pixel halving against the row kernels
+TEST(ImageKernels, MipMapBenchmark) {
+    const int width = 3840;
+    const int height = 2160;
+    const int levels = 4;
+    TestImage<float> src(0, 0, width, height, 4);
+
+    std::srand(7);
+    fillRandom(&src, 1);
+
+    std::vector<TestImage<float> > before, after;
+    std::clock_t start = std::clock();
+    const TestImage<float>* level = &src;
+    before.reserve(levels);
+    for (int i = 0; i < levels; ++i) {
+        before.push_back( TestImage<float>(0, 0, level->x2 / 2, level->y2 / 2, 4) );
+        for (int y = 0; y < before.back().y2; ++y) {
+            referenceHalveRows(before.back().pixelAt(0, y), level->pixelAt(0, 2 * y), level->pixelAt(0, 2 * y + 1), 4, before.back().x2);
+        }
+        level = &before.back();
+    }
+    std::clock_t beforeEnd = std::clock();
+
+    std::clock_t afterStart = std::clock();
+    level = &src;
+    after.reserve(levels);
+    for (int i = 0; i < levels; ++i) {
+        after.push_back( TestImage<float>(0, 0, level->x2 / 2, level->y2 / 2, 4) );
+        for (int y = 0; y < after.back().y2; ++y) {
+            halveRowBox(after.back().pixelAt(0, y), level->pixelAt(0, 2 * y), level->pixelAt(0, 2 * y + 1), 4, after.back().x2);
+        }
+        level = &after.back();
+    }
+    std::clock_t afterEnd = std::clock();
+
+    double beforeTime = benchmarkSeconds(start, beforeEnd);
+    double afterTime = benchmarkSeconds(afterStart, afterEnd);
+    std::cout << "4K RGBA float 4 mipmap levels: per pixel " << beforeTime * 1000. << " ms, row kernels "
+              << afterTime * 1000. << " ms (" << beforeTime / afterTime << "x)" << std::endl;
+    EXPECT_TRUE( std::memcmp( &before.back().data[0], &after.back().data[0], after.back().data.size() * sizeof(float) ) == 0 );
+}
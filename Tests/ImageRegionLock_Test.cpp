@@ -0,0 +1,279 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <iostream>
+#include <list>
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+#include "Engine/Image.h"
+#include "Engine/ImageRegionLock.h"
+#include "Engine/Timer.h"
+
+#define TILES_X 8
+#define TILES_Y 4
+#define N_THREADS (TILES_X * TILES_Y)
+
+NATRON_NAMESPACE_USING
+
+namespace {
+// Locks a region of an ImageRegionLock from another thread, then releases it
+class RegionLockTask
+    : public QRunnable
+{
+    ImageRegionLock* _lock;
+    RectI _region;
+    QAtomicInt* _acquired;
+
+public:
+
+    RegionLockTask(ImageRegionLock* lock,
+                   const RectI& region,
+                   QAtomicInt* acquired)
+        : QRunnable()
+        , _lock(lock)
+        , _region(region)
+        , _acquired(acquired)
+    {
+        setAutoDelete(true);
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        U64 id = _lock->lockForWrite(_region);
+
+        _acquired->fetchAndAddOrdered(1);
+        _lock->unlock(id);
+    }
+};
+
+RectI
+getTile(const RectI& bounds,
+        int index)
+{
+    int w = bounds.width() / TILES_X;
+    int h = bounds.height() / TILES_Y;
+    int x = bounds.x1 + (index % TILES_X) * w;
+    int y = bounds.y1 + (index / TILES_X) * h;
+
+    return RectI(x, y, x + w, y + h);
+}
+
+ImagePtr
+createImage(const RectI& bounds)
+{
+    RectD rod(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+
+    return ImagePtr( new Image(ImageComponents::getRGBAComponents(), rod, bounds, 0, 1., eImageBitDepthFloat,
+                               eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, true /*useBitmap*/) );
+}
+
+// Stands for the render of a tile: writes its pixels and marks them rendered in the bitmap, many times
+class TileRender
+    : public QRunnable
+{
+    Image* _image;
+    RectI _tile;
+    float _value;
+    int _iterations;
+
+    // When set, the whole image is locked for each write, as when it only had a single lock
+    QReadWriteLock* _imageLock;
+
+public:
+
+    TileRender(Image* image,
+               const RectI& tile,
+               float value,
+               int iterations,
+               QReadWriteLock* imageLock)
+        : QRunnable()
+        , _image(image)
+        , _tile(tile)
+        , _value(value)
+        , _iterations(iterations)
+        , _imageLock(imageLock)
+    {
+        setAutoDelete(true);
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        for (int i = 0; i < _iterations; ++i) {
+            if (_imageLock) {
+                _imageLock->lockForWrite();
+            }
+            _image->clearBitmap(_tile);
+            _image->fillZero(_tile);
+            _image->fill(_tile, _value, _value, _value, 1.);
+            _image->markForRendered(_tile);
+            if (_imageLock) {
+                _imageLock->unlock();
+            }
+        }
+    }
+};
+
+// Grows the image while the tiles are rendered
+class ImageResize
+    : public QRunnable
+{
+    Image* _image;
+
+public:
+
+    ImageResize(Image* image)
+        : QRunnable()
+        , _image(image)
+    {
+        setAutoDelete(true);
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        for (int i = 1; i <= 4; ++i) {
+            QThread::yieldCurrentThread();
+            RectI bounds = _image->getBounds();
+            bounds.x2 += 16;
+            bounds.y2 += 16;
+            _image->ensureBounds(OSGLContextPtr(), bounds);
+        }
+    }
+};
+
+// Renders all the tiles of the image in N_THREADS threads and returns the time it took in seconds
+double
+renderTiles(Image* image,
+            int iterations,
+            QReadWriteLock* imageLock,
+            bool resize)
+{
+    QThreadPool pool;
+
+    pool.setMaxThreadCount(N_THREADS + 1);
+    RectI bounds = image->getBounds();
+    TimeLapse timer;
+    for (int i = 0; i < N_THREADS; ++i) {
+        pool.start( new TileRender(image, getTile(bounds, i), (float)(i + 1), iterations, imageLock) );
+    }
+    if (resize) {
+        pool.start( new ImageResize(image) );
+    }
+    pool.waitForDone();
+
+    return timer.getTimeSinceCreation();
+}
+} // anon namespace
+
+TEST(ImageRegionLock, DisjointRegionsDoNotWait) {
+    ImageRegionLock lock;
+    QThreadPool pool;
+    QAtomicInt acquired(0);
+
+    U64 id = lock.lockForWrite( RectI(0, 0, 100, 100) );
+
+    pool.start( new RegionLockTask(&lock, RectI(100, 0, 200, 100), &acquired) );
+    ASSERT_TRUE( pool.waitForDone(10000) );
+    EXPECT_EQ(1, (int)acquired);
+
+    // An intersecting region waits until the first one is released
+    pool.start( new RegionLockTask(&lock, RectI(50, 50, 150, 150), &acquired) );
+    QThread::yieldCurrentThread();
+    EXPECT_FALSE( pool.waitForDone(100) );
+    EXPECT_EQ(1, (int)acquired);
+    lock.unlock(id);
+    ASSERT_TRUE( pool.waitForDone(10000) );
+    EXPECT_EQ(2, (int)acquired);
+    EXPECT_EQ( 0, lock.getLockedRegionsCount() );
+}
+
+TEST(ImageRegionLock, RecursiveForTheSameThread) {
+    ImageRegionLock lock;
+    RectI region(0, 0, 100, 100);
+
+    // None of these block: the thread holds the regions itself
+    U64 write = lock.lockForWrite(region);
+    U64 read = lock.lockForRead(region);
+    U64 write2 = lock.lockForWrite( RectI(50, 50, 150, 150) );
+
+    EXPECT_EQ( 3, lock.getLockedRegionsCount() );
+    EXPECT_EQ( (U64)0, lock.lockForWrite( RectI() ) );
+    lock.unlock(write2);
+    lock.unlock(read);
+    lock.unlock(write);
+    EXPECT_EQ( 0, lock.getLockedRegionsCount() );
+}
+
+// N_THREADS threads write their own tile of the same image, while another thread grows the image:
+// each tile must end up with the value of its thread and marked rendered.
+TEST(ImageRegionLock, ConcurrentTilesStress) {
+    RectI bounds(0, 0, 512, 256);
+    ImagePtr image = createImage(bounds);
+
+    renderTiles(image.get(), 50, 0, true);
+
+    EXPECT_TRUE( image->getBounds().contains(bounds) );
+    Image::ReadAccess acc( image.get() );
+    for (int i = 0; i < N_THREADS; ++i) {
+        RectI tile = getTile(bounds, i);
+        std::list<RectI> rest;
+        image->getRestToRender(tile, rest);
+        EXPECT_TRUE( rest.empty() );
+        int nWrong = 0;
+        for (int y = tile.y1; y < tile.y2; ++y) {
+            const float* pix = (const float*)acc.pixelAt(tile.x1, y);
+            for (int x = 0; x < tile.width() * 4; x += 4) {
+                if ( (pix[x] != (float)(i + 1)) || (pix[x + 3] != 1.f) ) {
+                    ++nWrong;
+                }
+            }
+        }
+        EXPECT_EQ(0, nWrong) << "tile " << i;
+    }
+}
+
+// Reports the time for N_THREADS threads to write their tile of the same image, with a single lock for
+// the whole image and with the region locks.
+TEST(ImageRegionLock, ConcurrentTilesBenchmark) {
+    RectI bounds(0, 0, 2048, 1024);
+    ImagePtr image = createImage(bounds);
+    QReadWriteLock imageLock;
+    const int iterations = 20;
+
+    renderTiles(image.get(), 1, 0, false); // warm-up
+    double wholeImageTime = renderTiles(image.get(), iterations, &imageLock, false);
+    double regionTime = renderTiles(image.get(), iterations, 0, false);
+
+    std::cout << N_THREADS << " threads writing 2K RGBA float tiles: whole image lock " << wholeImageTime * 1000. << " ms, region locks "
+              << regionTime * 1000. << " ms (x" << wholeImageTime / regionTime << ")" << std::endl;
+    EXPECT_GT(regionTime, 0.);
+}
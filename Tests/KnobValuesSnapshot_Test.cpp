@@ -0,0 +1,67 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Engine/KnobValuesSnapshot.h"
+
+NATRON_NAMESPACE_USING
+
+TEST(KnobValuesSnapshot, CapturedTimesAndViews) {
+    // The knobs are only used as keys
+    int knobs[2];
+    const KnobI* knob1 = reinterpret_cast<const KnobI*>(&knobs[0]);
+    const KnobI* knob2 = reinterpret_cast<const KnobI*>(&knobs[1]);
+    KnobValuesSnapshot snapshot;
+
+    std::vector<double> values(2);
+    values[0] = 1.;
+    values[1] = 2.;
+    snapshot.setValues( knob1, 10., ViewIdx(0), values );
+    values[0] = 3.;
+    values[1] = 4.;
+    // A temporal effect also renders its input at the previous frame
+    snapshot.setValues( knob1, 9., ViewIdx(0), values );
+    snapshot.setValues( knob2, 10., ViewIdx(1), std::vector<double>(1, 5.) );
+    EXPECT_EQ( 3, (int)snapshot.getNKnobValues() );
+
+    double value = 0.;
+    EXPECT_TRUE( snapshot.getValue(knob1, 10., ViewIdx(0), 1, &value) );
+    EXPECT_EQ(2., value);
+    EXPECT_TRUE( snapshot.getValue(knob1, 9., ViewIdx(0), 0, &value) );
+    EXPECT_EQ(3., value);
+    EXPECT_TRUE( snapshot.getValue(knob2, 10., ViewIdx(1), 0, &value) );
+    EXPECT_EQ(5., value);
+
+    // Anything which was not captured is read from the knob
+    EXPECT_FALSE( snapshot.getValue(knob1, 10.5, ViewIdx(0), 0, &value) );
+    EXPECT_FALSE( snapshot.getValue(knob1, 10., ViewIdx(1), 0, &value) );
+    EXPECT_FALSE( snapshot.getValue(knob2, 10., ViewIdx(1), 1, &value) );
+    EXPECT_FALSE( snapshot.getValue(knob2, 10., ViewIdx(1), -1, &value) );
+    EXPECT_FALSE( snapshot.getValue(knob2, 9., ViewIdx(0), 0, &value) );
+}
@@ -24,9 +24,18 @@
 
 #include "Global/Macros.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <vector>
+
 #include <gtest/gtest.h>
+
 #include "Engine/Lut.h"
+#include "Engine/LutKernels.h"
 
 NATRON_NAMESPACE_USING
 using namespace NATRON_NAMESPACE::Color;
@@ -51,3 +60,202 @@ TEST(Lut, IntConversions) {
         EXPECT_EQ( i, uint8xxToChar( charToUint8xx(i) ) );
     }
 }
+
+static const Lut*
+getBuiltinLut(int i)
+{
+    switch (i) {
+    case 0:
+        return LutManager::sRGBLut();
+    case 1:
+        return LutManager::Rec709Lut();
+    case 2:
+        return LutManager::CineonLut();
+    case 3:
+        return LutManager::Gamma1_8Lut();
+    case 4:
+        return LutManager::Gamma2_2Lut();
+    case 5:
+        return LutManager::PanalogLut();
+    case 6:
+        return LutManager::ViperLogLut();
+    case 7:
+        return LutManager::REDLogLut();
+    case 8:
+        return LutManager::AlexaV3LogCLut();
+    case 9:
+        return LutManager::SLog1Lut();
+    case 10:
+        return LutManager::SLog2Lut();
+    default:
+        return 0;
+    }
+}
+
+// The row functions must match the scalar transfer functions, see LutKernels.h
+TEST(Lut, RowFunctionsAccuracy) {
+    const int n = 100003; // not a multiple of the vector size
+    std::vector<float> input(n), rowOutput(n);
+
+    for (int l = 0; getBuiltinLut(l); ++l) {
+        const Lut* lut = getBuiltinLut(l);
+
+        // [0,1] then values above 1 (HDR)
+        for (int range = 0; range < 2; ++range) {
+            // ViperLog is undefined at 0
+            const float first = range == 1 ? 1.f : (lut->getName() == "ViperLog" ? 1e-6f : 0.f);
+            const float last = range == 1 ? 4.f : 1.f;
+            const float maxError = range == 1 ? NATRON_LUT_KERNELS_MAX_ERROR_ABOVE_1 : NATRON_LUT_KERNELS_MAX_ERROR;
+            for (int i = 0; i < n; ++i) {
+                input[i] = first + (last - first) * i / (float)(n - 1);
+            }
+
+            lut->toColorSpaceFloatFromLinearFloat(&input[0], &rowOutput[0], n);
+            for (int i = 0; i < n; ++i) {
+                float expected = lut->toColorSpaceFloatFromLinearFloat(input[i]);
+                EXPECT_LE(std::fabs(rowOutput[i] - expected) / std::max(1.f, std::fabs(expected)), maxError) << lut->getName() << " to " << input[i];
+            }
+
+            lut->fromColorSpaceFloatToLinearFloat(&input[0], &rowOutput[0], n);
+            for (int i = 0; i < n; ++i) {
+                float expected = lut->fromColorSpaceFloatToLinearFloat(input[i]);
+                EXPECT_LE(std::fabs(rowOutput[i] - expected) / std::max(1.f, std::fabs(expected)), maxError) << lut->getName() << " from " << input[i];
+            }
+        }
+
+        // in place conversion
+        for (int i = 0; i < n; ++i) {
+            input[i] = i / (float)(n - 1);
+        }
+        rowOutput = input;
+        lut->toColorSpaceFloatFromLinearFloat(&rowOutput[0], &rowOutput[0], n);
+        EXPECT_LE(std::fabs( rowOutput[n / 2] - lut->toColorSpaceFloatFromLinearFloat(input[n / 2]) ), NATRON_LUT_KERNELS_MAX_ERROR) << lut->getName();
+    }
+}
+
+// NaN must go through the row functions like through the scalar ones, whatever its position in the vector
+TEST(Lut, RowFunctionsNaN) {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const int n = 7;
+    float input[n] = { 0.5f, nan, 0.f, 2.f, 0.25f, 1.f, nan };
+    float output[n];
+
+    for (int l = 0; getBuiltinLut(l); ++l) {
+        const Lut* lut = getBuiltinLut(l);
+
+        lut->toColorSpaceFloatFromLinearFloat(input, output, n);
+        for (int i = 0; i < n; ++i) {
+            EXPECT_EQ( (bool)(input[i] != input[i]), (bool)(output[i] != output[i]) ) << lut->getName() << " to " << input[i];
+        }
+        EXPECT_NE( lut->toColorSpaceFloatFromLinearFloat(nan), lut->toColorSpaceFloatFromLinearFloat(nan) ) << lut->getName();
+
+        lut->fromColorSpaceFloatToLinearFloat(input, output, n);
+        for (int i = 0; i < n; ++i) {
+            EXPECT_EQ( (bool)(input[i] != input[i]), (bool)(output[i] != output[i]) ) << lut->getName() << " from " << input[i];
+        }
+    }
+}
+
+// Compares a value of a row function to the scalar one: NaN and infinities must be the same,
+// finite values are compared like in RowFunctionsAccuracy. Around the overflow threshold, the row function
+// may round to inf where the scalar one gives a finite value close to FLT_MAX, and conversely.
+static bool
+rowMatchesScalar(float row,
+                 float expected,
+                 float maxError)
+{
+    const bool rowIsNaN = row != row;
+    const bool expectedIsNaN = expected != expected;
+
+    if (rowIsNaN || expectedIsNaN) {
+        return rowIsNaN == expectedIsNaN;
+    }
+    const bool rowIsInf = std::fabs(row) > std::numeric_limits<float>::max();
+    const bool expectedIsInf = std::fabs(expected) > std::numeric_limits<float>::max();
+    if (rowIsInf || expectedIsInf) {
+        if ( (row > 0) != (expected > 0) ) {
+            return false;
+        }
+
+        return (rowIsInf && expectedIsInf) || std::fabs(rowIsInf ? expected : row) >= std::numeric_limits<float>::max() * (1.f - maxError);
+    }
+
+    return std::fabs(row - expected) / std::max(1.f, std::fabs(expected)) <= maxError;
+}
+
+// Negative and large HDR values: logs of non-positive values are -inf or NaN and the powers overflow to inf,
+// like the scalar functions. See LutKernels.h for the SLog deviation above 3e35, which is not tested.
+TEST(Lut, RowFunctionsOutOfRange) {
+    const float inf = std::numeric_limits<float>::infinity();
+    const int n = 20003;
+
+    for (int range = 0; range < 2; ++range) {
+        std::vector<float> input;
+        float maxError;
+        if (range == 0) {
+            // from -1000 to -0.001
+            for (int i = 0; i < n; ++i) {
+                input.push_back( -1000.f * std::pow( 1e-6f, i / (float)(n - 1) ) );
+            }
+            input.push_back(-0.f);
+            input.push_back(0.f);
+            input.push_back( -std::numeric_limits<float>::min() );
+            input.push_back(-1e-40f); // denormal
+            input.push_back(-0.01079775161f); // 0 in the Cineon log
+            input.push_back(-inf);
+            maxError = NATRON_LUT_KERNELS_MAX_ERROR;
+        } else {
+            // from 4 to 4e9: every "from" function overflows in this range
+            for (int i = 0; i < n; ++i) {
+                input.push_back( 4.f * std::pow( 1e9f, i / (float)(n - 1) ) );
+            }
+            input.push_back(1e20f);
+            input.push_back(1e30f);
+            input.push_back(inf);
+            maxError = NATRON_LUT_KERNELS_MAX_ERROR_HDR;
+        }
+        std::vector<float> rowOutput( input.size() );
+
+        for (int l = 0; getBuiltinLut(l); ++l) {
+            const Lut* lut = getBuiltinLut(l);
+
+            lut->toColorSpaceFloatFromLinearFloat( &input[0], &rowOutput[0], (int)input.size() );
+            for (std::size_t i = 0; i < input.size(); ++i) {
+                float expected = lut->toColorSpaceFloatFromLinearFloat(input[i]);
+                EXPECT_TRUE( rowMatchesScalar(rowOutput[i], expected, maxError) ) << lut->getName() << " to " << input[i] << ": " << rowOutput[i] << " instead of " << expected;
+            }
+
+            lut->fromColorSpaceFloatToLinearFloat( &input[0], &rowOutput[0], (int)input.size() );
+            for (std::size_t i = 0; i < input.size(); ++i) {
+                float expected = lut->fromColorSpaceFloatToLinearFloat(input[i]);
+                EXPECT_TRUE( rowMatchesScalar(rowOutput[i], expected, maxError) ) << lut->getName() << " from " << input[i] << ": " << rowOutput[i] << " instead of " << expected;
+            }
+        }
+    }
+}
+
+// Reports the throughput of the row functions against the scalar ones
+TEST(Lut, RowFunctionsThroughput) {
+    const int n = 1 << 20;
+    std::vector<float> input(n), output(n);
+
+    for (int i = 0; i < n; ++i) {
+        input[i] = i / (float)(n - 1);
+    }
+
+    for (int l = 0; getBuiltinLut(l); ++l) {
+        const Lut* lut = getBuiltinLut(l);
+        std::clock_t start = std::clock();
+        for (int i = 0; i < n; ++i) {
+            output[i] = lut->toColorSpaceFloatFromLinearFloat(input[i]);
+        }
+        std::clock_t scalarEnd = std::clock();
+        lut->toColorSpaceFloatFromLinearFloat(&input[0], &output[0], n);
+        std::clock_t rowEnd = std::clock();
+
+        double scalarMPixPerSec = n / ( 1e6 * std::max<double>(1, scalarEnd - start) / CLOCKS_PER_SEC );
+        double rowMPixPerSec = n / ( 1e6 * std::max<double>(1, rowEnd - scalarEnd) / CLOCKS_PER_SEC );
+        std::cout << lut->getName() << ": scalar " << scalarMPixPerSec << " Mvalues/s, row " << rowMPixPerSec << " Mvalues/s" << std::endl;
+        EXPECT_GT(rowMPixPerSec, 0.);
+    }
+}
@@ -0,0 +1,271 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
+
+#include "Engine/MultiThreadTeam.h"
+#include "Engine/Timer.h"
+
+NATRON_NAMESPACE_USING
+
+namespace {
+// Counts how many times each task ran and which threads took part in the job
+class CountingJob
+    : public MultiThreadTeamJob
+{
+public:
+
+    std::vector<QAtomicInt> runs;
+    QMutex threadsMutex;
+    std::set<QThread*> preparedThreads;
+    QAtomicInt finishedThreads;
+
+    CountingJob(unsigned int nTasks)
+        : MultiThreadTeamJob()
+        , runs(nTasks)
+        , threadsMutex()
+        , preparedThreads()
+        , finishedThreads()
+    {
+    }
+
+    virtual void prepareThread(QThread* thread) OVERRIDE FINAL
+    {
+        QMutexLocker k(&threadsMutex);
+
+        preparedThreads.insert(thread);
+    }
+
+    virtual void runTask(unsigned int taskIndex,
+                         unsigned int nTasks) OVERRIDE FINAL
+    {
+        EXPECT_EQ( runs.size(), nTasks );
+        runs[taskIndex].fetchAndAddOrdered(1);
+    }
+
+    virtual void finishThread() OVERRIDE FINAL
+    {
+        finishedThreads.fetchAndAddOrdered(1);
+    }
+
+    int getNTasksNotRunOnce() const
+    {
+        int ret = 0;
+
+        for (std::size_t i = 0; i < runs.size(); ++i) {
+            if ( (int)runs[i] != 1 ) {
+                ++ret;
+            }
+        }
+
+        return ret;
+    }
+};
+
+// Each task runs a job on the same team, as a plug-in calling the multi-thread suite from a spawned thread
+class NestedJob
+    : public MultiThreadTeamJob
+{
+    MultiThreadTeam* _team;
+
+public:
+
+    QAtomicInt nestedTasks;
+
+    NestedJob(MultiThreadTeam* team)
+        : MultiThreadTeamJob()
+        , _team(team)
+        , nestedTasks()
+    {
+    }
+
+    virtual void runTask(unsigned int /*taskIndex*/,
+                         unsigned int /*nTasks*/) OVERRIDE FINAL
+    {
+        CountingJob nested(10);
+
+        _team->run(&nested, 10, _team->getNThreads());
+        EXPECT_EQ( 0, nested.getNTasksNotRunOnce() );
+        nestedTasks.fetchAndAddOrdered(10);
+    }
+};
+
+// A minimal task, as a plug-in processing a small tile
+class EmptyJob
+    : public MultiThreadTeamJob
+{
+public:
+
+    QAtomicInt sum;
+
+    EmptyJob()
+        : MultiThreadTeamJob()
+        , sum()
+    {
+    }
+
+    virtual void runTask(unsigned int taskIndex,
+                         unsigned int /*nTasks*/) OVERRIDE FINAL
+    {
+        sum.fetchAndAddRelaxed(taskIndex);
+    }
+};
+
+QAtomicInt threadPoolSum;
+
+int
+threadPoolTask(unsigned int taskIndex)
+{
+    threadPoolSum.fetchAndAddRelaxed(taskIndex);
+
+    return 0;
+}
+} // anon namespace
+
+TEST(MultiThreadTeam, AllTasksRunOnce) {
+    MultiThreadTeam team(8);
+
+    EXPECT_EQ( 8u, team.getNThreads() );
+    // Back to back jobs of varying sizes, as a plug-in processing several passes
+    for (int i = 0; i < 500; ++i) {
+        unsigned int nTasks = 1 + (i * 7) % 40;
+        unsigned int nThreads = 1 + i % 10;
+        CountingJob job(nTasks);
+        team.run(&job, nTasks, nThreads);
+        EXPECT_EQ( 0, job.getNTasksNotRunOnce() );
+        // The calling thread takes part in the job, without being prepared nor finished
+        unsigned int nTeamThreads = std::min( std::min(nTasks, nThreads), team.getNThreads() );
+        EXPECT_EQ( std::max(1u, nTeamThreads) - 1, job.preparedThreads.size() );
+        EXPECT_EQ( (int)job.preparedThreads.size(), (int)job.finishedThreads );
+    }
+}
+
+TEST(MultiThreadTeam, StableThreads) {
+    MultiThreadTeam team(4);
+    CountingJob job1(100), job2(100);
+
+    team.run(&job1, 100, 4);
+    // Let the threads of the team go to sleep
+    QThread::msleep(50);
+    team.run(&job2, 100, 4);
+    EXPECT_EQ(job1.preparedThreads, job2.preparedThreads);
+    EXPECT_EQ( 3, (int)job2.preparedThreads.size() );
+    EXPECT_TRUE( job1.preparedThreads.find( QThread::currentThread() ) == job1.preparedThreads.end() );
+}
+
+TEST(MultiThreadTeam, NestedRunDoesNotDeadlock) {
+    MultiThreadTeam team(4);
+    NestedJob job(&team);
+
+    team.run(&job, 16, 4);
+    EXPECT_EQ( 160, (int)job.nestedTasks );
+}
+
+TEST(MultiThreadTeam, Pool) {
+    MultiThreadTeamPool pool(16);
+    MultiThreadTeamPtr team1 = pool.acquireTeam(4);
+    MultiThreadTeamPtr team2 = pool.acquireTeam(2);
+
+    EXPECT_NE(team1, team2);
+    EXPECT_EQ( 4u, team1->getNThreads() );
+    pool.releaseTeam(team1);
+    pool.releaseTeam(team2);
+    // The smallest team large enough is reused
+    EXPECT_EQ( team2, pool.acquireTeam(2) );
+    EXPECT_EQ( team1, pool.acquireTeam(3) );
+    MultiThreadTeamPtr team3 = pool.acquireTeam(8);
+    EXPECT_EQ( 8u, team3->getNThreads() );
+    pool.releaseTeam(team3);
+    pool.clear();
+}
+
+TEST(MultiThreadTeam, PoolThreadsBound) {
+    MultiThreadTeamPool pool(6);
+    MultiThreadTeamPtr team1 = pool.acquireTeam(4);
+    MultiThreadTeamPtr team2 = pool.acquireTeam(4);
+
+    EXPECT_EQ( 4u, team1->getNThreads() );
+    EXPECT_EQ( 4u, team2->getNThreads() );
+    EXPECT_EQ( 6, pool.getNThreads() );
+    // No thread left: the team runs its jobs in the calling thread
+    MultiThreadTeamPtr team3 = pool.acquireTeam(4);
+    EXPECT_EQ( 1u, team3->getNThreads() );
+    CountingJob job(20);
+    team3->run(&job, 20, 4);
+    EXPECT_EQ( 0, job.getNTasksNotRunOnce() );
+    pool.releaseTeam(team1);
+    pool.releaseTeam(team2);
+    pool.releaseTeam(team3);
+    EXPECT_EQ( 6, pool.getNThreads() );
+    // The idle teams are stopped to make room for a larger one
+    MultiThreadTeamPtr team4 = pool.acquireTeam(7);
+    EXPECT_EQ( 7u, team4->getNThreads() );
+    EXPECT_EQ( 6, pool.getNThreads() );
+    pool.releaseTeam(team4);
+    pool.clear();
+    EXPECT_EQ( 0, pool.getNThreads() );
+}
+
+// Reports the latency of a fork-join call with nearly empty tasks, as the multi-thread suite used to run it with
+// QtConcurrent on the global thread pool and with a team.
+TEST(MultiThreadTeam, LatencyBenchmark) {
+    const int iterations = 200;
+
+    for (unsigned int nThreads = 1; nThreads <= 64; nThreads *= 2) {
+        std::vector<unsigned int> threadIndexes(nThreads);
+        for (unsigned int i = 0; i < nThreads; ++i) {
+            threadIndexes[i] = i;
+        }
+        TimeLapse threadPoolTimer;
+        for (int i = 0; i < iterations; ++i) {
+            QFuture<int> future = QtConcurrent::mapped(threadIndexes, threadPoolTask);
+            future.waitForFinished();
+        }
+        double threadPoolTime = threadPoolTimer.getTimeSinceCreation();
+
+        MultiThreadTeam team(nThreads);
+        EmptyJob job;
+        TimeLapse teamTimer;
+        for (int i = 0; i < iterations; ++i) {
+            team.run(&job, nThreads, nThreads);
+        }
+        double teamTime = teamTimer.getTimeSinceCreation();
+
+        EXPECT_EQ( (int)threadPoolSum, (int)job.sum );
+        threadPoolSum.fetchAndStoreOrdered(0);
+        std::cout << nThreads << " threads: thread pool " << threadPoolTime * 1e6 / iterations << " us/call, team "
+                  << teamTime * 1e6 / iterations << " us/call" << std::endl;
+    }
+}
@@ -0,0 +1,263 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QRectF>
+
+#include "Engine/Timer.h"
+
+#include "Gui/NodeGraphSpatialIndex.h"
+
+// A synthetic graph of GRAPH_SIZE x GRAPH_SIZE nodes, each connected to its left neighbour
+#define GRAPH_SIZE 100
+#define NODE_WIDTH 80.
+#define NODE_HEIGHT 30.
+#define NODE_SPACING_X 150.
+#define NODE_SPACING_Y 100.
+
+NATRON_NAMESPACE_USING
+
+namespace {
+// The items of the graph are numbered: nodes first, then edges
+struct SyntheticGraph
+{
+    std::vector<QRectF> rects;
+
+    SyntheticGraph()
+        : rects()
+    {
+        for (int y = 0; y < GRAPH_SIZE; ++y) {
+            for (int x = 0; x < GRAPH_SIZE; ++x) {
+                rects.push_back( QRectF(x * NODE_SPACING_X, y * NODE_SPACING_Y, NODE_WIDTH, NODE_HEIGHT) );
+            }
+        }
+        int nNodes = (int)rects.size();
+        for (int i = 0; i < nNodes; ++i) {
+            if ( (i % GRAPH_SIZE) != 0 ) {
+                rects.push_back( getEdgeRect(rects[i - 1], rects[i]) );
+            }
+        }
+    }
+
+    static QRectF getEdgeRect(const QRectF& source,
+                              const QRectF& dest)
+    {
+        return QRectF( source.center(), dest.center() ).normalized().adjusted(-2, -2, 2, 2);
+    }
+
+    void getItemsIntersecting(const QRectF& rect,
+                              std::set<int>* items) const
+    {
+        for (std::size_t i = 0; i < rects.size(); ++i) {
+            const QRectF& r = rects[i];
+            if ( (r.left() <= rect.right()) && (rect.left() <= r.right()) && (r.top() <= rect.bottom()) && (rect.top() <= r.bottom()) ) {
+                items->insert( (int)i );
+            }
+        }
+    }
+};
+
+// Deterministic pseudo-random numbers, so that a failure can be reproduced
+class Random
+{
+    unsigned int _state;
+
+public:
+
+    Random()
+        : _state(12345)
+    {
+    }
+
+    double get(double max)
+    {
+        _state = _state * 1103515245u + 12345u;
+
+        return ( (_state >> 8) & 0xFFFF ) / 65535. * max;
+    }
+};
+
+void
+fillIndex(const SyntheticGraph& graph,
+          NodeGraphSpatialIndex<int>* index)
+{
+    for (std::size_t i = 0; i < graph.rects.size(); ++i) {
+        index->insert( (int)i, graph.rects[i] );
+    }
+}
+
+QRectF
+getRandomViewport(Random& random,
+                  double size)
+{
+    double graphWidth = GRAPH_SIZE * NODE_SPACING_X;
+    double graphHeight = GRAPH_SIZE * NODE_SPACING_Y;
+
+    return QRectF(random.get(graphWidth) - size / 2., random.get(graphHeight) - size / 2., size, size * 0.6);
+}
+} // anon namespace
+
+TEST(NodeGraphSpatialIndex, MatchesLinearScan) {
+    SyntheticGraph graph;
+    NodeGraphSpatialIndex<int> index;
+
+    fillIndex(graph, &index);
+    ASSERT_EQ( graph.rects.size(), index.size() );
+
+    Random random;
+    // From the mouse tolerance rectangle to a view showing the whole graph
+    double sizes[] = { 10., 500., 3000., GRAPH_SIZE * NODE_SPACING_X * 2. };
+    for (int s = 0; s < 4; ++s) {
+        for (int i = 0; i < 50; ++i) {
+            QRectF viewport = getRandomViewport(random, sizes[s]);
+            std::set<int> expected, found;
+            graph.getItemsIntersecting(viewport, &expected);
+            index.getItemsIntersecting(viewport, &found);
+            EXPECT_EQ(expected, found);
+        }
+    }
+}
+
+// Nodes are moved one by one as when dragged, and their edges follow
+TEST(NodeGraphSpatialIndex, IncrementalMoves) {
+    SyntheticGraph graph;
+    NodeGraphSpatialIndex<int> index;
+
+    fillIndex(graph, &index);
+
+    Random random;
+    const int nNodes = GRAPH_SIZE * GRAPH_SIZE;
+    for (int i = 0; i < 2000; ++i) {
+        int node = (int)random.get(nNodes - 1);
+        // Mostly small moves within the same cells, sometimes a jump across the graph
+        double distance = (i % 10 == 0) ? 5000. : 20.;
+        graph.rects[node].translate(random.get(distance) - distance / 2., random.get(distance) - distance / 2.);
+        index.insert(node, graph.rects[node]);
+
+        int column = node % GRAPH_SIZE;
+        int row = node / GRAPH_SIZE;
+        if (column > 0) {
+            // Edge from the left neighbour
+            int edge = nNodes + row * (GRAPH_SIZE - 1) + column - 1;
+            graph.rects[edge] = SyntheticGraph::getEdgeRect(graph.rects[node - 1], graph.rects[node]);
+            index.insert(edge, graph.rects[edge]);
+        }
+        if (column < GRAPH_SIZE - 1) {
+            // Edge to the right neighbour
+            int edge = nNodes + row * (GRAPH_SIZE - 1) + column;
+            graph.rects[edge] = SyntheticGraph::getEdgeRect(graph.rects[node], graph.rects[node + 1]);
+            index.insert(edge, graph.rects[edge]);
+        }
+    }
+    EXPECT_EQ( graph.rects.size(), index.size() );
+
+    for (int i = 0; i < 200; ++i) {
+        QRectF viewport = getRandomViewport(random, 1000.);
+        std::set<int> expected, found;
+        graph.getItemsIntersecting(viewport, &expected);
+        index.getItemsIntersecting(viewport, &found);
+        EXPECT_EQ(expected, found);
+    }
+}
+
+TEST(NodeGraphSpatialIndex, RemoveAndOversizedItems) {
+    NodeGraphSpatialIndex<int> index;
+
+    index.insert( 0, QRectF(0, 0, 80, 30) );
+    // A backdrop covering far more cells than NATRON_NODEGRAPH_INDEX_MAX_CELLS_PER_ITEM
+    index.insert( 1, QRectF(-10000, -10000, 20000, 20000) );
+    // A horizontal line has no area but is still found
+    index.insert( 2, QRectF(500, 500, 300, 0) );
+
+    std::set<int> found;
+    index.getItemsIntersecting(QRectF(600, 490, 10, 20), &found);
+    EXPECT_EQ( 2, (int)found.size() );
+    EXPECT_TRUE( found.count(1) && found.count(2) );
+
+    found.clear();
+    index.getItemsIntersecting(QRectF(40, 10, 1, 1), &found);
+    EXPECT_EQ( 2, (int)found.size() );
+    EXPECT_TRUE( found.count(0) && found.count(1) );
+
+    EXPECT_TRUE( index.remove(1) );
+    EXPECT_FALSE( index.remove(1) );
+    EXPECT_FALSE( index.contains(1) );
+
+    // The backdrop shrinks back into regular cells
+    index.insert( 1, QRectF(-20000, -20000, 10, 10) );
+    found.clear();
+    index.getItemsIntersecting(QRectF(40, 10, 1, 1), &found);
+    EXPECT_EQ( 1, (int)found.size() );
+    EXPECT_TRUE( found.count(0) );
+    EXPECT_EQ( 3, (int)index.size() );
+
+    index.clear();
+    found.clear();
+    index.getItemsIntersecting(QRectF(-1e6, -1e6, 2e6, 2e6), &found);
+    EXPECT_TRUE( found.empty() );
+}
+
+// Reports the time to find the items under the mouse and in the viewport of the 10k nodes graph
+// with the index and by testing every item, as QGraphicsScene does without an index.
+TEST(NodeGraphSpatialIndex, Benchmark) {
+    SyntheticGraph graph;
+    NodeGraphSpatialIndex<int> index;
+
+    fillIndex(graph, &index);
+
+    const int nQueries = 1000;
+    std::vector<QRectF> queries;
+    Random random;
+    for (int i = 0; i < nQueries; ++i) {
+        queries.push_back( getRandomViewport(random, (i % 2) ? 10. : 2000.) );
+    }
+
+    std::size_t nLinear = 0, nIndex = 0;
+    TimeLapse linearTimer;
+    for (int i = 0; i < nQueries; ++i) {
+        std::set<int> items;
+        graph.getItemsIntersecting(queries[i], &items);
+        nLinear += items.size();
+    }
+    double linearTime = linearTimer.getTimeSinceCreation();
+
+    TimeLapse indexTimer;
+    for (int i = 0; i < nQueries; ++i) {
+        std::set<int> items;
+        index.getItemsIntersecting(queries[i], &items);
+        nIndex += items.size();
+    }
+    double indexTime = indexTimer.getTimeSinceCreation();
+
+    EXPECT_EQ(nLinear, nIndex);
+    std::cout << graph.rects.size() << " nodes and edges, " << nQueries << " queries: linear scan " << linearTime * 1000.
+              << " ms, spatial index " << indexTime * 1000. << " ms" << std::endl;
+}
@@ -0,0 +1,225 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <iostream>
+#include <list>
+#include <map>
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+#include "BaseTest.h"
+
+#include "Engine/AbortableRenderInfo.h"
+#include "Engine/AppInstance.h"
+#include "Engine/AppManager.h"
+#include "Engine/EffectInstance.h"
+#include "Engine/Format.h"
+#include "Engine/Image.h"
+#include "Engine/Node.h"
+#include "Engine/ParallelRenderArgs.h"
+#include "Engine/Project.h"
+#include "Engine/RenderPriorityScheduler.h"
+#include "Engine/Timer.h"
+#include "Engine/TLSHolder.h"
+#include "Engine/ViewIdx.h"
+
+NATRON_NAMESPACE_USING
+
+namespace {
+// Renders the full frame of the node at the given time with renderRoI, as a render of the given class would,
+// and returns the time it took in seconds or a negative value if the render failed
+double
+renderFrame(const NodePtr& node,
+            RenderPriorityEnum priority,
+            double time)
+{
+    EffectInstancePtr effect = node->getEffectInstance();
+    AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
+
+    abortInfo->setPriority(priority);
+    TimeLapse timer;
+    bool ok = false;
+    {
+        ParallelRenderArgsSetter::CtorArgsPtr tlsArgs(new ParallelRenderArgsSetter::CtorArgs);
+        tlsArgs->time = time;
+        tlsArgs->view = ViewIdx(0);
+        tlsArgs->isRenderUserInteraction = priority == eRenderPriorityInteractive;
+        tlsArgs->isSequential = false;
+        tlsArgs->abortInfo = abortInfo;
+        tlsArgs->treeRoot = node;
+        tlsArgs->textureIndex = 0;
+        tlsArgs->timeline = node->getApp()->getTimeLine();
+        tlsArgs->activeRotoPaintNode = NodePtr();
+        tlsArgs->activeRotoDrawableItem = RotoDrawableItemPtr();
+        tlsArgs->isDoingRotoNeatRender = false;
+        tlsArgs->isAnalysis = false;
+        tlsArgs->draftMode = false;
+        tlsArgs->viewsRenderedConcurrently = false;
+        tlsArgs->stats = RenderStatsPtr();
+        ParallelRenderArgsSetter frameRenderArgs(tlsArgs);
+
+        U64 nodeHash;
+        RectD rod;
+        if ( effect->getRenderHash(time, ViewIdx(0), &nodeHash) &&
+             (effect->getRegionOfDefinition_public(nodeHash, time, RenderScale(1.), ViewIdx(0), &rod) != eStatusFailed) &&
+             (frameRenderArgs.computeRequestPass(0, rod) != eStatusFailed) ) {
+            RectI renderWindow;
+            rod.toPixelEnclosing(0, effect->getAspectRatio(-1), &renderWindow);
+            std::list<ImageComponents> components;
+            components.push_back( ImageComponents::getRGBAComponents() );
+            // Bypass the cache so that every frame is rendered
+            EffectInstance::RenderRoIArgs args(time, RenderScale(1.), 0, ViewIdx(0), true, renderWindow, rod, components,
+                                               eImageBitDepthFloat, false, effect, eStorageModeRAM, time);
+            std::map<ImageComponents, ImagePtr> planes;
+            ok = effect->renderRoI(args, &planes) == EffectInstance::eRenderRoIRetCodeOk;
+        }
+    }
+    appPTR->getAppTLS()->cleanupTLSForThread();
+
+    return ok ? timer.getTimeSinceCreation() : -1.;
+}
+
+// A render on disk rendering frames of the node until it is stopped
+class BackgroundRender
+    : public QRunnable
+{
+    NodePtr _node;
+    QAtomicInt* _stop;
+    QAtomicInt* _running;
+
+public:
+
+    BackgroundRender(const NodePtr& node,
+                     QAtomicInt* stop,
+                     QAtomicInt* running)
+        : QRunnable()
+        , _node(node)
+        , _stop(stop)
+        , _running(running)
+    {
+        setAutoDelete(true);
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _running->fetchAndAddOrdered(1);
+        int frame = 0;
+        while ( (int)*_stop == 0 ) {
+            renderFrame(_node, eRenderPriorityBackground, ++frame);
+        }
+        _running->fetchAndAddOrdered(-1);
+    }
+};
+
+// Returns the average time of an interactive frame render of the node, while nBackgroundRenders renders on disk
+// of the same node occupy the thread pool
+double
+measureInteractiveLatency(const NodePtr& node,
+                          int nBackgroundRenders)
+{
+    QAtomicInt stop(0), running(0);
+
+    for (int i = 0; i < nBackgroundRenders; ++i) {
+        QThreadPool::globalInstance()->start( new BackgroundRender(node, &stop, &running) );
+    }
+    while ( (int)running < nBackgroundRenders ) {
+        QThread::yieldCurrentThread();
+    }
+
+    const int nFrames = 5;
+    double total = 0.;
+    for (int i = 0; i < nFrames; ++i) {
+        total += renderFrame(node, eRenderPriorityInteractive, 1);
+    }
+
+    stop.fetchAndAddOrdered(1);
+    QThreadPool::globalInstance()->waitForDone();
+
+    return total / nFrames;
+}
+} // anon namespace
+
+TEST(RenderPriorityScheduler, YieldsToMoreUrgentRenders) {
+    RenderPriorityScheduler scheduler;
+
+    EXPECT_EQ( 0, scheduler.yieldToMoreUrgentRenders( eRenderPriorityBackground, AbortableRenderInfoPtr() ) );
+    {
+        RenderPriorityScheduler_RAII registration(&scheduler, eRenderPriorityPlayback);
+        EXPECT_EQ( 1, scheduler.getActiveRendersCount(eRenderPriorityPlayback) );
+        // Never yield to the same or a less urgent class
+        EXPECT_EQ( 0, scheduler.yieldToMoreUrgentRenders( eRenderPriorityInteractive, AbortableRenderInfoPtr() ) );
+        EXPECT_EQ( 0, scheduler.yieldToMoreUrgentRenders( eRenderPriorityPlayback, AbortableRenderInfoPtr() ) );
+        // The wait is bounded even if the urgent render never finishes
+        int waited = scheduler.yieldToMoreUrgentRenders( eRenderPriorityPreview, AbortableRenderInfoPtr() );
+        EXPECT_GE(waited, NATRON_RENDER_PREEMPTION_MAX_WAIT_MS);
+        // A render producing images that the urgent render may wait on does not yield
+        AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
+        abortInfo->setPriority(eRenderPriorityBackground);
+        {
+            AbortableRenderInfoImagesBeingRendered_RAII imagesBeingRendered(abortInfo);
+            EXPECT_TRUE( abortInfo->hasImagesBeingRendered() );
+            EXPECT_EQ( 0, scheduler.yieldToMoreUrgentRenders(eRenderPriorityBackground, abortInfo) );
+        }
+        EXPECT_FALSE( abortInfo->hasImagesBeingRendered() );
+        EXPECT_GT(scheduler.yieldToMoreUrgentRenders(eRenderPriorityBackground, abortInfo), 0);
+    }
+    EXPECT_EQ( 0, scheduler.getActiveRendersCount(eRenderPriorityPlayback) );
+
+    scheduler.setMaxConcurrentTiles(eRenderPriorityBackground, 2);
+    {
+        RenderPrioritySchedulerTile_RAII tile1(&scheduler, eRenderPriorityBackground);
+        EXPECT_TRUE( scheduler.canRenderTilesInParallel(eRenderPriorityBackground) );
+        RenderPrioritySchedulerTile_RAII tile2(&scheduler, eRenderPriorityBackground);
+        EXPECT_FALSE( scheduler.canRenderTilesInParallel(eRenderPriorityBackground) );
+        EXPECT_TRUE( scheduler.canRenderTilesInParallel(eRenderPriorityInteractive) );
+    }
+    EXPECT_TRUE( scheduler.canRenderTilesInParallel(eRenderPriorityBackground) );
+}
+
+// Reports the time to render an interactive frame of a generator with renderRoI alone, then while renders on disk
+// of the same generator occupy all the threads of the pool and yield to it at tile boundaries.
+TEST_F(BaseTest, RenderPriorityInteractiveLatencyBenchmark) {
+    NodePtr generator = createNode(_generatorPluginID);
+
+    ASSERT_TRUE(generator);
+    Format f(0, 0, 1920, 1080, "HD", 1.);
+    getApp()->getProject()->setOrAddProjectFormat(f);
+
+    int nThreads = QThreadPool::globalInstance()->maxThreadCount();
+    ASSERT_GT(renderFrame(generator, eRenderPriorityInteractive, 1), 0.); // warm-up
+    double idle = renderFrame(generator, eRenderPriorityInteractive, 1);
+    double preempted = measureInteractiveLatency(generator, nThreads);
+
+    std::cout << "Interactive renderRoI over " << nThreads << " threads: idle " << idle * 1000.
+              << " ms, with renders on disk " << preempted * 1000. << " ms" << std::endl;
+    EXPECT_GT(idle, 0.);
+    EXPECT_GT(preempted, 0.);
+}
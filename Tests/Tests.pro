@@ -49,12 +49,23 @@ SOURCES += \
     google-test/src/gtest_main.cc \
     google-mock/src/gmock-all.cc \
     BaseTest.cpp \
+    BinarySerialization_Test.cpp \
+    CacheEviction_Test.cpp \
+    CacheStorageCodec_Test.cpp \
+    DirectoryScanner_Test.cpp \
     Hash64_Test.cpp \
     Image_Test.cpp \
+    ImageKernels_Test.cpp \
+    ImageRegionLock_Test.cpp \
+    KnobValuesSnapshot_Test.cpp \
     Lut_Test.cpp \
+    MultiThreadTeam_Test.cpp \
+    NodeGraphSpatialIndex_Test.cpp \
     KnobFile_Test.cpp \
     Curve_Test.cpp \
+    RenderPriorityScheduler_Test.cpp \
     Tracker_Test.cpp \
+    ViewerPrefetcher_Test.cpp \
     wmain.cpp
 
 HEADERS += \
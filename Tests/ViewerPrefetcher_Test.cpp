@@ -0,0 +1,124 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Engine/ViewerPrefetcher.h"
+
+NATRON_NAMESPACE_USING
+
+static int
+countFramesBefore(const std::vector<int>& frames,
+                  int frame)
+{
+    int ret = 0;
+
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        if (frames[i] < frame) {
+            ++ret;
+        }
+    }
+
+    return ret;
+}
+
+TEST(ViewerPrefetcher, AlternatesAroundThePlayheadWhenIdle)
+{
+    std::vector<int> frames;
+
+    ViewerPrefetcher::getFramesToPrefetch(50, 1, 100, 0, 0., 1, 6, &frames);
+    int expected[] = { 51, 49, 52, 48, 53, 47 };
+    ASSERT_EQ( 6, (int)frames.size() );
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_EQ(expected[i], frames[i]);
+    }
+}
+
+TEST(ViewerPrefetcher, FavorsTheScrubbingDirection)
+{
+    std::vector<int> slow, fast;
+
+    ViewerPrefetcher::getFramesToPrefetch(50, 1, 100, -1, 0., 1, 16, &slow);
+    ViewerPrefetcher::getFramesToPrefetch(50, 1, 100, -1, 100., 1, 16, &fast);
+    ASSERT_EQ( 16, (int)slow.size() );
+    ASSERT_EQ( 16, (int)fast.size() );
+
+    // Scrubbing backward: the next frame back comes first
+    EXPECT_EQ(49, slow[0]);
+    EXPECT_EQ(49, fast[0]);
+
+    int slowAhead = countFramesBefore(slow, 50);
+    int fastAhead = countFramesBefore(fast, 50);
+    EXPECT_GT(slowAhead, 8);
+    EXPECT_GT(fastAhead, slowAhead);
+
+    // Frames behind are kept for the user scrubbing back and forth
+    EXPECT_LT(fastAhead, 16);
+    EXPECT_NE( fast.end(), std::find(fast.begin(), fast.end(), 51) );
+}
+
+TEST(ViewerPrefetcher, FollowsTheScrubbingStep)
+{
+    std::vector<int> frames;
+
+    // While scrubbing by steps of 5 frames, the frames are spaced the same way
+    ViewerPrefetcher::getFramesToPrefetch(50, 1, 100, 1, 30., 5, 4, &frames);
+    ASSERT_FALSE( frames.empty() );
+    EXPECT_EQ(55, frames[0]);
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        EXPECT_EQ(0, (frames[i] - 50) % 5);
+    }
+
+    // A single jump does not space the frames
+    ViewerPrefetcher::getFramesToPrefetch(50, 1, 100, 1, 0., 40, 4, &frames);
+    ASSERT_FALSE( frames.empty() );
+    EXPECT_EQ(51, frames[0]);
+}
+
+TEST(ViewerPrefetcher, StaysInTheFrameRange)
+{
+    std::vector<int> frames;
+
+    ViewerPrefetcher::getFramesToPrefetch(98, 1, 100, 1, 100., 1, 10, &frames);
+    ASSERT_EQ( 10, (int)frames.size() );
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        EXPECT_GE(frames[i], 1);
+        EXPECT_LE(frames[i], 100);
+        EXPECT_NE(98, frames[i]);
+    }
+    // No duplicates
+    std::vector<int> sorted = frames;
+    std::sort( sorted.begin(), sorted.end() );
+    EXPECT_EQ( sorted.end(), std::adjacent_find( sorted.begin(), sorted.end() ) );
+
+    ViewerPrefetcher::getFramesToPrefetch(1, 1, 1, 1, 0., 1, 10, &frames);
+    EXPECT_TRUE( frames.empty() );
+    ViewerPrefetcher::getFramesToPrefetch(50, 1, 100, 1, 0., 1, 0, &frames);
+    EXPECT_TRUE( frames.empty() );
+}